@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include "conn_supervisor.h"
+
+// Broker health probe: a bare TCP connect to the broker port with a timeout.
+// It does not speak MQTT; it only tells the supervisor whether failing back to
+// a preferred broker has a chance to succeed. Blocking for at most timeout_ms.
+bool conn_probe_broker(const char *uri, uint32_t timeout_ms) {
+    char host[64];
+    char port_str[6];
+    uint16_t port;
+
+    if (!conn_parse_broker_uri(uri, host, sizeof(host), &port)) {
+        return false;
+    }
+    snprintf(port_str, sizeof(port_str), "%u", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0 || res == NULL) {
+        return false;
+    }
+
+    bool reachable = false;
+    int sock = socket(res->ai_family, res->ai_socktype, 0);
+    if (sock >= 0) {
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+        if (connect(sock, res->ai_addr, res->ai_addrlen) == 0) {
+            reachable = true;
+        } else if (errno == EINPROGRESS) {
+            fd_set write_fds;
+            FD_ZERO(&write_fds);
+            FD_SET(sock, &write_fds);
+            struct timeval tv = {
+                .tv_sec = timeout_ms / 1000,
+                .tv_usec = (timeout_ms % 1000) * 1000,
+            };
+            if (select(sock + 1, NULL, &write_fds, NULL, &tv) > 0) {
+                int so_error = 0;
+                socklen_t len = sizeof(so_error);
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &so_error, &len);
+                reachable = (so_error == 0);
+            }
+        }
+        close(sock);
+    }
+    freeaddrinfo(res);
+    return reachable;
+}
@@ -0,0 +1,359 @@
+#include <string.h>
+#include <stdlib.h>
+#include "conn_supervisor.h"
+
+#define CONN_BACKOFF_MAX_SHIFT 16
+
+static uint32_t next_random(conn_supervisor_t *sup) {
+    // xorshift32: good enough to decorrelate reconnect storms, no libc state involved.
+    uint32_t x = sup->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sup->rng_state = x;
+    return x;
+}
+
+// "Equal jitter" exponential backoff: half of the exponential step is fixed so
+// retries never collapse to zero, the other half is random to spread clients.
+static uint32_t jittered_backoff_ms(conn_supervisor_t *sup, uint8_t attempt) {
+    uint8_t shift = attempt > CONN_BACKOFF_MAX_SHIFT ? CONN_BACKOFF_MAX_SHIFT : attempt;
+    uint64_t step = (uint64_t)sup->cfg.backoff_base_ms << shift;
+    if (step > sup->cfg.backoff_cap_ms) {
+        step = sup->cfg.backoff_cap_ms;
+    }
+    uint32_t half = (uint32_t)(step / 2);
+    return half + (next_random(sup) % (half + 1));
+}
+
+static void arm_deadline(conn_supervisor_t *sup, uint32_t now_ms, uint32_t delay_ms) {
+    sup->deadline_ms = now_ms + delay_ms;
+    sup->deadline_armed = true;
+}
+
+static void disarm_deadline(conn_supervisor_t *sup) {
+    sup->deadline_armed = false;
+}
+
+static void begin_outage(conn_supervisor_t *sup, uint32_t now_ms) {
+    if (!sup->stats.in_outage) {
+        sup->stats.in_outage = true;
+        sup->stats.current_outage_start_ms = now_ms;
+    }
+}
+
+static void end_outage(conn_supervisor_t *sup, uint32_t now_ms) {
+    if (!sup->stats.in_outage) {
+        return;
+    }
+    uint32_t duration_ms = now_ms - sup->stats.current_outage_start_ms;
+    sup->stats.in_outage = false;
+    sup->stats.outage_count++;
+    sup->stats.last_outage_ms = duration_ms;
+    sup->stats.total_outage_ms += duration_ms;
+    if (duration_ms > sup->stats.max_outage_ms) {
+        sup->stats.max_outage_ms = duration_ms;
+    }
+}
+
+static uint8_t pick_next_broker(const conn_supervisor_t *sup) {
+    // First healthy broker after the active one (wrapping), else simply the next one.
+    for (uint8_t step = 1; step < sup->broker_count; step++) {
+        uint8_t idx = (sup->active_broker + step) % sup->broker_count;
+        if (sup->brokers[idx].healthy) {
+            return idx;
+        }
+    }
+    return (sup->active_broker + 1) % sup->broker_count;
+}
+
+static uint32_t start_wifi(conn_supervisor_t *sup, uint32_t now_ms) {
+    sup->state = CONN_STATE_WIFI_CONNECTING;
+    arm_deadline(sup, now_ms, sup->cfg.wifi_connect_timeout_ms);
+    return CONN_ACT_WIFI_CONNECT;
+}
+
+static uint32_t start_mqtt(conn_supervisor_t *sup, uint32_t now_ms) {
+    sup->state = CONN_STATE_MQTT_CONNECTING;
+    arm_deadline(sup, now_ms, sup->cfg.mqtt_connect_timeout_ms);
+    return CONN_ACT_MQTT_START;
+}
+
+static uint32_t wifi_failure(conn_supervisor_t *sup, uint32_t now_ms) {
+    uint32_t actions = CONN_ACT_NONE;
+    if (sup->broker_count > 0 && (sup->state == CONN_STATE_MQTT_CONNECTING ||
+        sup->state == CONN_STATE_MQTT_BACKOFF || sup->state == CONN_STATE_ONLINE)) {
+        actions |= CONN_ACT_MQTT_STOP;
+    }
+    if (sup->state == CONN_STATE_ONLINE) {
+        begin_outage(sup, now_ms);
+        actions |= CONN_ACT_NOTIFY_OFFLINE;
+    }
+    sup->probe_in_flight = false;
+    sup->state = CONN_STATE_WIFI_BACKOFF;
+    arm_deadline(sup, now_ms, jittered_backoff_ms(sup, sup->wifi_attempt));
+    if (sup->wifi_attempt < UINT8_MAX) {
+        sup->wifi_attempt++;
+    }
+    return actions;
+}
+
+static uint32_t mqtt_failure(conn_supervisor_t *sup, uint32_t now_ms) {
+    conn_broker_t *broker = &sup->brokers[sup->active_broker];
+    uint32_t actions = CONN_ACT_MQTT_STOP;
+
+    broker->consecutive_failures++;
+    broker->total_failures++;
+    if (broker->consecutive_failures >= sup->cfg.failover_after_failures) {
+        broker->healthy = false;
+    }
+    sup->probe_in_flight = false;
+
+    if (sup->broker_count > 1 && broker->consecutive_failures >= sup->cfg.failover_after_failures) {
+        sup->active_broker = pick_next_broker(sup);
+        sup->brokers[sup->active_broker].consecutive_failures = 0;
+        sup->stats.failovers++;
+        sup->cycle_failovers++;
+        if (sup->cycle_failovers < sup->broker_count) {
+            // Fast failover: the next broker is tried immediately, no backoff.
+            sup->mqtt_attempt = 0;
+            return actions | start_mqtt(sup, now_ms);
+        }
+        // Every broker failed in a row: back off before starting another round.
+        sup->cycle_failovers = 0;
+    }
+
+    sup->state = CONN_STATE_MQTT_BACKOFF;
+    arm_deadline(sup, now_ms, jittered_backoff_ms(sup, sup->mqtt_attempt));
+    if (sup->mqtt_attempt < UINT8_MAX) {
+        sup->mqtt_attempt++;
+    }
+    return actions;
+}
+
+static uint32_t handle_timeout(conn_supervisor_t *sup, uint32_t now_ms) {
+    if (!sup->deadline_armed || (int32_t)(now_ms - sup->deadline_ms) < 0) {
+        return CONN_ACT_NONE; // Spurious wake-up
+    }
+    disarm_deadline(sup);
+
+    switch (sup->state) {
+    case CONN_STATE_WIFI_CONNECTING:
+    case CONN_STATE_WAIT_IP:
+        return wifi_failure(sup, now_ms);
+    case CONN_STATE_WIFI_BACKOFF:
+        return start_wifi(sup, now_ms);
+    case CONN_STATE_MQTT_CONNECTING:
+        return mqtt_failure(sup, now_ms);
+    case CONN_STATE_MQTT_BACKOFF:
+        return start_mqtt(sup, now_ms);
+    case CONN_STATE_ONLINE:
+        if (sup->active_broker == 0) {
+            return CONN_ACT_NONE;
+        }
+        // Running on a fallback broker: probe the preferred ones in turn. A probe
+        // still in flight at this point never answered and is simply superseded.
+        arm_deadline(sup, now_ms, sup->cfg.probe_interval_ms);
+        if (sup->probe_broker + 1 >= sup->active_broker) {
+            sup->probe_broker = 0;
+        } else {
+            sup->probe_broker++;
+        }
+        sup->probe_in_flight = true;
+        return CONN_ACT_PROBE_BROKER;
+    default:
+        return CONN_ACT_NONE;
+    }
+}
+
+void conn_supervisor_init(conn_supervisor_t *sup, const conn_supervisor_config_t *cfg,
+                          const char *const *broker_uris, size_t broker_count, uint32_t seed) {
+    memset(sup, 0, sizeof(*sup));
+    sup->cfg = *cfg;
+    if (sup->cfg.failover_after_failures == 0) {
+        sup->cfg.failover_after_failures = 1;
+    }
+    if (broker_count > CONN_MAX_BROKERS) {
+        broker_count = CONN_MAX_BROKERS;
+    }
+    for (size_t i = 0; i < broker_count; i++) {
+        sup->brokers[i].uri = broker_uris[i];
+        sup->brokers[i].healthy = true;
+    }
+    sup->broker_count = (uint8_t)broker_count;
+    sup->rng_state = seed ? seed : 0x9E3779B9u;
+    sup->state = CONN_STATE_IDLE;
+    sup->probe_broker = UINT8_MAX; // First probe wraps to broker 0
+}
+
+uint32_t conn_supervisor_handle(conn_supervisor_t *sup, const conn_event_t *event, uint32_t now_ms) {
+    switch (event->id) {
+    case CONN_EVT_START:
+        if (sup->state == CONN_STATE_IDLE) {
+            return start_wifi(sup, now_ms);
+        }
+        return CONN_ACT_NONE;
+
+    case CONN_EVT_WIFI_CONNECTED:
+        if (sup->state == CONN_STATE_WIFI_CONNECTING || sup->state == CONN_STATE_WIFI_BACKOFF) {
+            sup->state = CONN_STATE_WAIT_IP;
+            arm_deadline(sup, now_ms, sup->cfg.ip_timeout_ms);
+        }
+        return CONN_ACT_NONE;
+
+    case CONN_EVT_GOT_IP:
+        if (sup->state == CONN_STATE_WIFI_CONNECTING || sup->state == CONN_STATE_WAIT_IP ||
+            sup->state == CONN_STATE_WIFI_BACKOFF) {
+            sup->wifi_attempt = 0;
+            if (sup->broker_count == 0) {
+                // Network-only mode (e.g. master running its own broker): IP is enough.
+                sup->state = CONN_STATE_ONLINE;
+                disarm_deadline(sup);
+                end_outage(sup, now_ms);
+                return CONN_ACT_NOTIFY_ONLINE;
+            }
+            return start_mqtt(sup, now_ms);
+        }
+        return CONN_ACT_NONE; // DHCP renewal while MQTT is already handled
+
+    case CONN_EVT_WIFI_DISCONNECTED:
+    case CONN_EVT_LOST_IP:
+        if (sup->state == CONN_STATE_IDLE || sup->state == CONN_STATE_WIFI_BACKOFF) {
+            return CONN_ACT_NONE; // Already waiting to retry
+        }
+        return wifi_failure(sup, now_ms);
+
+    case CONN_EVT_MQTT_CONNECTED:
+        if (sup->state != CONN_STATE_MQTT_CONNECTING && sup->state != CONN_STATE_MQTT_BACKOFF) {
+            return CONN_ACT_NONE;
+        }
+        sup->state = CONN_STATE_ONLINE;
+        sup->mqtt_attempt = 0;
+        sup->cycle_failovers = 0;
+        sup->brokers[sup->active_broker].consecutive_failures = 0;
+        sup->brokers[sup->active_broker].healthy = true;
+        sup->brokers[sup->active_broker].last_success_ms = now_ms;
+        end_outage(sup, now_ms);
+        if (sup->active_broker != 0) {
+            arm_deadline(sup, now_ms, sup->cfg.probe_interval_ms);
+        } else {
+            disarm_deadline(sup);
+        }
+        return CONN_ACT_NOTIFY_ONLINE;
+
+    case CONN_EVT_MQTT_ERROR:
+        // Errors while online are always followed by MQTT_EVENT_DISCONNECTED.
+        if (sup->state != CONN_STATE_MQTT_CONNECTING) {
+            return CONN_ACT_NONE;
+        }
+        return mqtt_failure(sup, now_ms);
+
+    case CONN_EVT_MQTT_DISCONNECTED:
+        if (sup->state == CONN_STATE_ONLINE) {
+            begin_outage(sup, now_ms);
+            return mqtt_failure(sup, now_ms) | CONN_ACT_NOTIFY_OFFLINE;
+        }
+        if (sup->state == CONN_STATE_MQTT_CONNECTING) {
+            return mqtt_failure(sup, now_ms);
+        }
+        return CONN_ACT_NONE;
+
+    case CONN_EVT_PROBE_OK:
+        sup->probe_in_flight = false;
+        if (event->broker_index >= sup->broker_count) {
+            return CONN_ACT_NONE;
+        }
+        sup->brokers[event->broker_index].healthy = true;
+        if (sup->state == CONN_STATE_ONLINE && event->broker_index < sup->active_broker) {
+            // Fail back to the preferred broker. The switch is a (short) outage too.
+            begin_outage(sup, now_ms);
+            sup->active_broker = event->broker_index;
+            sup->brokers[sup->active_broker].consecutive_failures = 0;
+            sup->stats.failovers++;
+            sup->mqtt_attempt = 0;
+            return CONN_ACT_MQTT_STOP | CONN_ACT_NOTIFY_OFFLINE | start_mqtt(sup, now_ms);
+        }
+        return CONN_ACT_NONE;
+
+    case CONN_EVT_PROBE_FAIL:
+        sup->probe_in_flight = false;
+        if (event->broker_index < sup->broker_count) {
+            sup->brokers[event->broker_index].healthy = false;
+        }
+        return CONN_ACT_NONE;
+
+    case CONN_EVT_TIMEOUT:
+        return handle_timeout(sup, now_ms);
+    }
+    return CONN_ACT_NONE;
+}
+
+uint32_t conn_supervisor_ms_until_deadline(const conn_supervisor_t *sup, uint32_t now_ms) {
+    if (!sup->deadline_armed) {
+        return CONN_NO_DEADLINE;
+    }
+    int32_t remaining = (int32_t)(sup->deadline_ms - now_ms);
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+const char *conn_supervisor_active_uri(const conn_supervisor_t *sup) {
+    return sup->broker_count ? sup->brokers[sup->active_broker].uri : NULL;
+}
+
+const char *conn_supervisor_probe_uri(const conn_supervisor_t *sup) {
+    return sup->probe_broker < sup->broker_count ? sup->brokers[sup->probe_broker].uri : NULL;
+}
+
+bool conn_supervisor_is_online(const conn_supervisor_t *sup) {
+    return sup->state == CONN_STATE_ONLINE;
+}
+
+void conn_supervisor_get_stats(const conn_supervisor_t *sup, uint32_t now_ms, conn_outage_stats_t *out) {
+    *out = sup->stats;
+    if (sup->stats.in_outage) {
+        uint32_t ongoing_ms = now_ms - sup->stats.current_outage_start_ms;
+        out->total_outage_ms += ongoing_ms;
+        if (ongoing_ms > out->max_outage_ms) {
+            out->max_outage_ms = ongoing_ms;
+        }
+    }
+}
+
+const char *conn_state_name(conn_state_t state) {
+    switch (state) {
+    case CONN_STATE_IDLE:            return "IDLE";
+    case CONN_STATE_WIFI_CONNECTING: return "WIFI_CONNECTING";
+    case CONN_STATE_WIFI_BACKOFF:    return "WIFI_BACKOFF";
+    case CONN_STATE_WAIT_IP:         return "WAIT_IP";
+    case CONN_STATE_MQTT_CONNECTING: return "MQTT_CONNECTING";
+    case CONN_STATE_MQTT_BACKOFF:    return "MQTT_BACKOFF";
+    case CONN_STATE_ONLINE:          return "ONLINE";
+    }
+    return "UNKNOWN";
+}
+
+bool conn_parse_broker_uri(const char *uri, char *host, size_t host_len, uint16_t *port) {
+    if (uri == NULL || host == NULL || host_len == 0 || port == NULL) {
+        return false;
+    }
+    const char *p = strstr(uri, "://");
+    bool tls = strncmp(uri, "mqtts", 5) == 0;
+    p = p ? p + 3 : uri;
+
+    size_t len = strcspn(p, ":/");
+    if (len == 0 || len >= host_len) {
+        return false;
+    }
+    memcpy(host, p, len);
+    host[len] = '\0';
+
+    *port = tls ? 8883 : 1883;
+    if (p[len] == ':') {
+        long value = strtol(p + len + 1, NULL, 10);
+        if (value <= 0 || value > 65535) {
+            return false;
+        }
+        *port = (uint16_t)value;
+    }
+    return true;
+}
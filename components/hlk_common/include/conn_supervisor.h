@@ -0,0 +1,143 @@
+#ifndef CONN_SUPERVISOR_H
+#define CONN_SUPERVISOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Connection supervisor shared by the master and slave firmwares.
+//
+// One state machine owns the whole Wi-Fi -> IP -> MQTT chain. It is driven by
+// the Wi-Fi/IP/MQTT events (forwarded by the esp_event handlers) and by its own
+// deadline, and answers every event with a mask of actions the firmware must
+// execute (connect Wi-Fi, (re)start the MQTT client, probe a broker...).
+// The module is plain C with no ESP-IDF dependency so it can be unit tested on
+// a host; time is always passed in by the caller (esp_log_timestamp()).
+
+#define CONN_MAX_BROKERS 4
+#define CONN_NO_DEADLINE UINT32_MAX
+
+typedef enum {
+    CONN_STATE_IDLE = 0,
+    CONN_STATE_WIFI_CONNECTING,
+    CONN_STATE_WIFI_BACKOFF,
+    CONN_STATE_WAIT_IP,
+    CONN_STATE_MQTT_CONNECTING,
+    CONN_STATE_MQTT_BACKOFF,
+    CONN_STATE_ONLINE,
+} conn_state_t;
+
+typedef enum {
+    CONN_EVT_START = 0,
+    CONN_EVT_WIFI_CONNECTED,
+    CONN_EVT_WIFI_DISCONNECTED,
+    CONN_EVT_GOT_IP,
+    CONN_EVT_LOST_IP,
+    CONN_EVT_MQTT_CONNECTED,
+    CONN_EVT_MQTT_DISCONNECTED,
+    CONN_EVT_MQTT_ERROR,
+    CONN_EVT_PROBE_OK,
+    CONN_EVT_PROBE_FAIL,
+    CONN_EVT_TIMEOUT,
+} conn_event_id_t;
+
+typedef struct {
+    conn_event_id_t id;
+    uint8_t broker_index; // Only meaningful for CONN_EVT_PROBE_OK / CONN_EVT_PROBE_FAIL
+} conn_event_t;
+
+// Actions returned by conn_supervisor_handle(). Execute them in bit order:
+// MQTT_STOP must run before MQTT_START when both are set (broker failover).
+#define CONN_ACT_NONE           0u
+#define CONN_ACT_WIFI_CONNECT   (1u << 0)
+#define CONN_ACT_MQTT_STOP      (1u << 1)
+#define CONN_ACT_MQTT_START     (1u << 2) // Connect to conn_supervisor_active_uri()
+#define CONN_ACT_PROBE_BROKER   (1u << 3) // Probe conn_supervisor_probe_uri()
+#define CONN_ACT_NOTIFY_ONLINE  (1u << 4)
+#define CONN_ACT_NOTIFY_OFFLINE (1u << 5)
+
+typedef struct {
+    uint32_t backoff_base_ms;         // First retry delay
+    uint32_t backoff_cap_ms;          // Upper bound of the exponential delay
+    uint32_t wifi_connect_timeout_ms; // STA_START/connect -> STA_CONNECTED
+    uint32_t ip_timeout_ms;           // STA_CONNECTED -> GOT_IP
+    uint32_t mqtt_connect_timeout_ms; // MQTT start -> MQTT_EVENT_CONNECTED
+    uint8_t  failover_after_failures; // Consecutive failures before moving to the next broker
+    uint32_t probe_interval_ms;       // While on a fallback broker, how often to probe preferred ones
+} conn_supervisor_config_t;
+
+#define CONN_SUPERVISOR_DEFAULT_CONFIG() {  \
+    .backoff_base_ms = 500,                 \
+    .backoff_cap_ms = 30000,                \
+    .wifi_connect_timeout_ms = 10000,       \
+    .ip_timeout_ms = 10000,                 \
+    .mqtt_connect_timeout_ms = 8000,        \
+    .failover_after_failures = 2,           \
+    .probe_interval_ms = 60000,             \
+}
+
+typedef struct {
+    const char *uri;
+    uint16_t consecutive_failures;
+    uint32_t total_failures;
+    uint32_t last_success_ms;
+    bool healthy;
+} conn_broker_t;
+
+typedef struct {
+    uint32_t outage_count;
+    uint32_t last_outage_ms;
+    uint32_t max_outage_ms;
+    uint64_t total_outage_ms;
+    uint32_t failovers;
+    uint32_t current_outage_start_ms;
+    bool in_outage;
+} conn_outage_stats_t;
+
+typedef struct {
+    conn_supervisor_config_t cfg;
+    conn_state_t state;
+    conn_broker_t brokers[CONN_MAX_BROKERS];
+    uint8_t broker_count;
+    uint8_t active_broker;
+    uint8_t probe_broker;
+    uint8_t wifi_attempt;  // Exponent of the Wi-Fi backoff
+    uint8_t mqtt_attempt;  // Exponent of the MQTT backoff
+    uint8_t cycle_failovers; // Failovers since the last successful connection
+    bool probe_in_flight;
+    uint32_t deadline_ms;
+    bool deadline_armed;
+    uint32_t rng_state;
+    conn_outage_stats_t stats;
+} conn_supervisor_t;
+
+// Initializes the supervisor with an ordered broker list (index 0 = preferred).
+// With broker_count == 0 only Wi-Fi/IP is supervised and GOT_IP means ONLINE.
+// `seed` feeds the backoff jitter (use esp_random() on target).
+void conn_supervisor_init(conn_supervisor_t *sup, const conn_supervisor_config_t *cfg,
+                          const char *const *broker_uris, size_t broker_count, uint32_t seed);
+
+// Feeds one event and returns the CONN_ACT_* mask the caller must execute.
+uint32_t conn_supervisor_handle(conn_supervisor_t *sup, const conn_event_t *event, uint32_t now_ms);
+
+// Milliseconds until the supervisor expects a CONN_EVT_TIMEOUT, or CONN_NO_DEADLINE.
+uint32_t conn_supervisor_ms_until_deadline(const conn_supervisor_t *sup, uint32_t now_ms);
+
+const char *conn_supervisor_active_uri(const conn_supervisor_t *sup);
+const char *conn_supervisor_probe_uri(const conn_supervisor_t *sup);
+bool conn_supervisor_is_online(const conn_supervisor_t *sup);
+
+// Copies the outage statistics, folding the ongoing outage (if any) into the snapshot.
+void conn_supervisor_get_stats(const conn_supervisor_t *sup, uint32_t now_ms, conn_outage_stats_t *out);
+
+const char *conn_state_name(conn_state_t state);
+
+// Extracts host and port from "mqtt[s]://host[:port][/...]" for the broker health probe.
+// Returns false if the URI cannot be parsed. Default ports: 1883 (mqtt), 8883 (mqtts).
+bool conn_parse_broker_uri(const char *uri, char *host, size_t host_len, uint16_t *port);
+
+// TCP reachability probe of a broker URI (POSIX sockets, works on lwIP and Linux).
+// Blocks the caller for at most timeout_ms.
+bool conn_probe_broker(const char *uri, uint32_t timeout_ms);
+
+#endif // CONN_SUPERVISOR_H
@@ -0,0 +1,58 @@
+#ifndef MQTT5_PROPS_H
+#define MQTT5_PROPS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// MQTT 5 property block helpers (OASIS MQTT 5.0, section 2.2.2).
+//
+// Used by the embedded broker to resolve topic aliases and forward properties,
+// and by the master to read the radar user properties. Decoding only: on target
+// the slaves encode their properties through esp-mqtt.
+
+// Property identifiers used by this project
+#define MQTT5_PROP_PAYLOAD_FORMAT     0x01
+#define MQTT5_PROP_MESSAGE_EXPIRY     0x02
+#define MQTT5_PROP_TOPIC_ALIAS_MAX    0x22
+#define MQTT5_PROP_TOPIC_ALIAS        0x23
+#define MQTT5_PROP_MAXIMUM_QOS        0x24
+#define MQTT5_PROP_RETAIN_AVAILABLE   0x25
+#define MQTT5_PROP_USER               0x26
+
+// User property keys of a radar sample. One character on purpose: a user
+// property costs 5 bytes of framing plus key and value, so module id 1 takes
+// 7 bytes against 17 for the pretty-printed "id_module" JSON field.
+#define RADAR_PROP_MODULE_ID "m"
+#define RADAR_PROP_SEQUENCE  "s"
+
+typedef struct {
+    uint8_t id;
+    uint32_t value;        // Byte, two/four byte integer and varint properties
+    const uint8_t *data;   // Strings and binary data (user property: key)
+    size_t data_len;
+    const uint8_t *data2;  // User property value
+    size_t data2_len;
+} mqtt5_prop_t;
+
+// Variable byte integer (1..4 bytes). encode returns the bytes written; decode
+// returns the bytes consumed, 0 if `len` is too short, or -1 if malformed.
+size_t mqtt5_varint_encode(uint8_t *out, uint32_t value);
+int mqtt5_varint_decode(const uint8_t *in, size_t len, uint32_t *value);
+
+// Iterates a property block (without its length prefix). Returns 1 with the
+// next property in `prop`, 0 at the end of the block, -1 if malformed or if
+// the identifier is unknown (its size cannot be skipped).
+int mqtt5_prop_next(const uint8_t *props, size_t len, size_t *offset, mqtt5_prop_t *prop);
+
+// Checks that the whole block parses. Packets with a malformed block must be rejected.
+bool mqtt5_props_valid(const uint8_t *props, size_t len);
+
+// Finds the first user property named `key`. The value is not NUL terminated.
+bool mqtt5_props_find_user(const uint8_t *props, size_t len, const char *key,
+                           const uint8_t **value, size_t *value_len);
+
+// Same, parsed as a decimal unsigned integer. False if absent or not a number.
+bool mqtt5_props_find_user_u32(const uint8_t *props, size_t len, const char *key, uint32_t *value);
+
+#endif // MQTT5_PROPS_H
@@ -0,0 +1,41 @@
+#ifndef RADAR_POSTURE_H
+#define RADAR_POSTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Posture reported by a radar module. Carried as one byte on the UDP wire and
+// in the master queues; the JSON payloads use the names ("STANDING", ...).
+typedef enum {
+    RADAR_POSTURE_UNKNOWN = 0,
+    RADAR_POSTURE_STANDING,
+    RADAR_POSTURE_SITTING,
+    RADAR_POSTURE_LYING,
+    RADAR_POSTURE_MOVING,
+    RADAR_POSTURE_STILL,
+    RADAR_POSTURE_COUNT,
+} radar_posture_t;
+
+#define RADAR_POSTURE_BIT(p) (1u << (p))
+
+// Postures a fall can start from (the previous sample before a quick transition to LYING).
+#define RADAR_POSTURE_UPRIGHT_OR_MOVING_MASK \
+    (RADAR_POSTURE_BIT(RADAR_POSTURE_STANDING) | RADAR_POSTURE_BIT(RADAR_POSTURE_SITTING) | \
+     RADAR_POSTURE_BIT(RADAR_POSTURE_MOVING) | RADAR_POSTURE_BIT(RADAR_POSTURE_STILL))
+
+static inline bool radar_posture_is_upright_or_moving(radar_posture_t posture) {
+    return (unsigned)posture < RADAR_POSTURE_COUNT &&
+           (RADAR_POSTURE_BIT(posture) & RADAR_POSTURE_UPRIGHT_OR_MOVING_MASK) != 0;
+}
+
+// Combines the postures of two sensors seeing the same person. The most
+// critical one wins: LYING > MOVING > SITTING > STANDING. Anything else
+// (STILL, UNKNOWN, out of range) gives STILL. The master fuses postures with
+// posture_hmm.c; this rule stays as the baseline of its benchmark.
+radar_posture_t radar_posture_fuse(radar_posture_t a, radar_posture_t b);
+
+// Posture code <-> string used by the JSON payloads. Unknown names map to RADAR_POSTURE_UNKNOWN.
+radar_posture_t radar_posture_from_string(const char *posture);
+const char *radar_posture_name(radar_posture_t posture);
+
+#endif // RADAR_POSTURE_H
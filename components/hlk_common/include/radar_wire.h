@@ -0,0 +1,98 @@
+#ifndef RADAR_WIRE_H
+#define RADAR_WIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "radar_posture.h"
+
+// Compact binary radar sample used by the direct slave -> master UDP transport.
+//
+// Layout (little endian, 28 bytes, vs ~140 bytes for the JSON payload):
+//   0  u16 magic        RADAR_WIRE_MAGIC
+//   2  u8  version      RADAR_WIRE_VERSION
+//   3  u8  module_id
+//   4  u32 sequence     Monotonic per module, survives reboots (see slave NVS)
+//   8  u32 timestamp_ms Slave clock (esp_log_timestamp())
+//  12  u16 distance_mm  Detection distance (main target)
+//  14  u8  posture      radar_posture_t
+//  15  u8  signal       0..100
+//  16  u16 moving_mm    LD2410 moving target, 0 = none
+//  18  u16 static_mm    LD2410 static target, 0 = none
+//  20  u8[8] tag        SipHash-2-4 of the header with the shared 128-bit key
+//
+// Version 1 packets (24 bytes: no target distances, tag at 16) are still
+// accepted and decode with moving_mm = static_mm = 0.
+
+#define RADAR_WIRE_MAGIC       0x4C44u // "DL" on the wire: HLK-LD2410 sample
+#define RADAR_WIRE_VERSION     2
+#define RADAR_WIRE_HEADER_LEN  20
+#define RADAR_WIRE_TAG_LEN     8
+#define RADAR_WIRE_PACKET_LEN  (RADAR_WIRE_HEADER_LEN + RADAR_WIRE_TAG_LEN)
+#define RADAR_WIRE_V1_HEADER_LEN 16
+#define RADAR_WIRE_V1_PACKET_LEN (RADAR_WIRE_V1_HEADER_LEN + RADAR_WIRE_TAG_LEN)
+#define RADAR_WIRE_KEY_LEN     16
+#define RADAR_WIRE_DEFAULT_PORT 47800
+
+typedef struct {
+    uint8_t module_id;
+    uint32_t sequence;
+    uint32_t timestamp_ms;
+    uint16_t distance_mm;
+    uint16_t moving_mm;
+    uint16_t static_mm;
+    uint8_t posture;  // radar_posture_t
+    uint8_t signal;
+} radar_wire_sample_t;
+
+typedef enum {
+    RADAR_WIRE_OK = 0,
+    RADAR_WIRE_ERR_LENGTH,
+    RADAR_WIRE_ERR_MAGIC,
+    RADAR_WIRE_ERR_VERSION,
+    RADAR_WIRE_ERR_AUTH,
+} radar_wire_status_t;
+
+// Serializes and authenticates `sample` into `out` (RADAR_WIRE_PACKET_LEN bytes).
+size_t radar_wire_encode(const radar_wire_sample_t *sample, const uint8_t key[RADAR_WIRE_KEY_LEN],
+                         uint8_t out[RADAR_WIRE_PACKET_LEN]);
+
+// Verifies the tag (constant time) and parses a version 1 or 2 packet. `sample` is only written on success.
+radar_wire_status_t radar_wire_decode(const uint8_t *packet, size_t len, const uint8_t key[RADAR_WIRE_KEY_LEN],
+                                      radar_wire_sample_t *sample);
+
+// Sliding anti-replay window (64 sequences, as in IPsec/DTLS). One per module on the receiver.
+typedef struct {
+    uint32_t highest;
+    uint64_t bitmap; // bit i set = (highest - i) already accepted
+    bool initialized;
+} radar_wire_replay_t;
+
+typedef enum {
+    RADAR_REPLAY_ACCEPT = 0,
+    RADAR_REPLAY_DUPLICATE,
+    RADAR_REPLAY_TOO_OLD,
+    RADAR_REPLAY_RESYNC, // Accepted: the window restarted (radar_wire_replay_check_resync())
+} radar_replay_result_t;
+
+// Checks `sequence` against the window and records it when accepted.
+// `lost` (optional) receives the number of sequences skipped by a forward jump.
+radar_replay_result_t radar_wire_replay_check(radar_wire_replay_t *window, uint32_t sequence, uint32_t *lost);
+
+// A slave whose sequence restarts (NVS erased, module replaced or reflashed
+// under the same id) sends sequences far behind the window. One more than
+// RADAR_WIRE_RESYNC_GAP behind is taken as such a restart, not as a replay;
+// the slave reserves its sequences in NVS blocks of this size, so a normal
+// reboot always resumes ahead of the window.
+#define RADAR_WIRE_RESYNC_GAP  4096u
+
+// As radar_wire_replay_check(), but a sequence more than RADAR_WIRE_RESYNC_GAP
+// behind restarts the window there and is accepted (RADAR_REPLAY_RESYNC).
+// Tradeoff: an authenticated packet captured more than RADAR_WIRE_RESYNC_GAP
+// sequences ago is accepted once replayed, and resyncs the window to it.
+radar_replay_result_t radar_wire_replay_check_resync(radar_wire_replay_t *window, uint32_t sequence, uint32_t *lost);
+
+// SipHash-2-4 (64-bit output) of `data` with a 128-bit key.
+uint64_t hlk_siphash24(const uint8_t key[16], const void *data, size_t len);
+
+#endif // RADAR_WIRE_H
@@ -0,0 +1,164 @@
+#include <string.h>
+#include "mqtt5_props.h"
+
+// Value encoding of each property identifier (MQTT 5.0 table 2-4).
+typedef enum {
+    PROP_TYPE_INVALID = 0,
+    PROP_TYPE_BYTE,
+    PROP_TYPE_U16,
+    PROP_TYPE_U32,
+    PROP_TYPE_VARINT,
+    PROP_TYPE_BINARY,  // UTF-8 string and binary data share the u16-length layout
+    PROP_TYPE_PAIR,    // UTF-8 string pair (user property)
+} prop_type_t;
+
+static prop_type_t prop_type(uint8_t id) {
+    switch (id) {
+    case 0x01: case 0x17: case 0x19: case 0x24: case 0x25: case 0x28: case 0x29: case 0x2A:
+        return PROP_TYPE_BYTE;
+    case 0x13: case 0x21: case 0x22: case 0x23:
+        return PROP_TYPE_U16;
+    case 0x02: case 0x11: case 0x18: case 0x27:
+        return PROP_TYPE_U32;
+    case 0x0B:
+        return PROP_TYPE_VARINT;
+    case 0x03: case 0x08: case 0x09: case 0x12: case 0x15: case 0x16: case 0x1A: case 0x1C: case 0x1F:
+        return PROP_TYPE_BINARY;
+    case 0x26:
+        return PROP_TYPE_PAIR;
+    default:
+        return PROP_TYPE_INVALID;
+    }
+}
+
+size_t mqtt5_varint_encode(uint8_t *out, uint32_t value) {
+    size_t n = 0;
+    do {
+        uint8_t byte = value % 128;
+        value /= 128;
+        if (value > 0) {
+            byte |= 0x80;
+        }
+        out[n++] = byte;
+    } while (value > 0 && n < 4);
+    return n;
+}
+
+int mqtt5_varint_decode(const uint8_t *in, size_t len, uint32_t *value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (i >= len) {
+            return 0;
+        }
+        result |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *value = result;
+            return (int)i + 1;
+        }
+    }
+    return -1;
+}
+
+static bool take_binary(const uint8_t *props, size_t len, size_t *offset, const uint8_t **data, size_t *data_len) {
+    if (*offset + 2 > len) {
+        return false;
+    }
+    size_t n = ((size_t)props[*offset] << 8) | props[*offset + 1];
+    if (*offset + 2 + n > len) {
+        return false;
+    }
+    *data = props + *offset + 2;
+    *data_len = n;
+    *offset += 2 + n;
+    return true;
+}
+
+int mqtt5_prop_next(const uint8_t *props, size_t len, size_t *offset, mqtt5_prop_t *prop) {
+    size_t o = *offset;
+    if (o >= len) {
+        return 0;
+    }
+    memset(prop, 0, sizeof(*prop));
+    prop->id = props[o++]; // Identifiers above 127 would be multi-byte varints; none are defined
+    switch (prop_type(prop->id)) {
+    case PROP_TYPE_BYTE:
+        if (o + 1 > len) return -1;
+        prop->value = props[o];
+        o += 1;
+        break;
+    case PROP_TYPE_U16:
+        if (o + 2 > len) return -1;
+        prop->value = ((uint32_t)props[o] << 8) | props[o + 1];
+        o += 2;
+        break;
+    case PROP_TYPE_U32:
+        if (o + 4 > len) return -1;
+        prop->value = ((uint32_t)props[o] << 24) | ((uint32_t)props[o + 1] << 16) |
+                      ((uint32_t)props[o + 2] << 8) | props[o + 3];
+        o += 4;
+        break;
+    case PROP_TYPE_VARINT: {
+        int used = mqtt5_varint_decode(props + o, len - o, &prop->value);
+        if (used <= 0) return -1;
+        o += (size_t)used;
+        break;
+    }
+    case PROP_TYPE_BINARY:
+        if (!take_binary(props, len, &o, &prop->data, &prop->data_len)) return -1;
+        break;
+    case PROP_TYPE_PAIR:
+        if (!take_binary(props, len, &o, &prop->data, &prop->data_len) ||
+            !take_binary(props, len, &o, &prop->data2, &prop->data2_len)) {
+            return -1;
+        }
+        break;
+    default:
+        return -1;
+    }
+    *offset = o;
+    return 1;
+}
+
+bool mqtt5_props_valid(const uint8_t *props, size_t len) {
+    size_t offset = 0;
+    mqtt5_prop_t prop;
+    int status;
+    while ((status = mqtt5_prop_next(props, len, &offset, &prop)) > 0) {
+    }
+    return status == 0;
+}
+
+bool mqtt5_props_find_user(const uint8_t *props, size_t len, const char *key,
+                           const uint8_t **value, size_t *value_len) {
+    size_t key_len = strlen(key);
+    size_t offset = 0;
+    mqtt5_prop_t prop;
+    while (mqtt5_prop_next(props, len, &offset, &prop) > 0) {
+        if (prop.id == MQTT5_PROP_USER && prop.data_len == key_len && memcmp(prop.data, key, key_len) == 0) {
+            *value = prop.data2;
+            *value_len = prop.data2_len;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool mqtt5_props_find_user_u32(const uint8_t *props, size_t len, const char *key, uint32_t *value) {
+    const uint8_t *text;
+    size_t text_len;
+    if (!mqtt5_props_find_user(props, len, key, &text, &text_len) || text_len == 0 || text_len > 10) {
+        return false;
+    }
+    uint64_t result = 0;
+    for (size_t i = 0; i < text_len; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (uint64_t)(text[i] - '0');
+    }
+    if (result > UINT32_MAX) {
+        return false;
+    }
+    *value = (uint32_t)result;
+    return true;
+}
@@ -0,0 +1,44 @@
+#include <string.h>
+#include "radar_posture.h"
+
+static const char *const posture_names[RADAR_POSTURE_COUNT] = {
+    [RADAR_POSTURE_UNKNOWN]  = "UNKNOWN",
+    [RADAR_POSTURE_STANDING] = "STANDING",
+    [RADAR_POSTURE_SITTING]  = "SITTING",
+    [RADAR_POSTURE_LYING]    = "LYING",
+    [RADAR_POSTURE_MOVING]   = "MOVING",
+    [RADAR_POSTURE_STILL]    = "STILL",
+};
+
+// Fusion priority, higher wins. STILL and UNKNOWN share the lowest rank.
+static const uint8_t fusion_rank[RADAR_POSTURE_COUNT] = {
+    [RADAR_POSTURE_UNKNOWN]  = 0,
+    [RADAR_POSTURE_STILL]    = 0,
+    [RADAR_POSTURE_STANDING] = 1,
+    [RADAR_POSTURE_SITTING]  = 2,
+    [RADAR_POSTURE_MOVING]   = 3,
+    [RADAR_POSTURE_LYING]    = 4,
+};
+
+radar_posture_t radar_posture_fuse(radar_posture_t a, radar_posture_t b) {
+    uint8_t rank_a = (unsigned)a < RADAR_POSTURE_COUNT ? fusion_rank[a] : 0;
+    uint8_t rank_b = (unsigned)b < RADAR_POSTURE_COUNT ? fusion_rank[b] : 0;
+    radar_posture_t best = rank_a >= rank_b ? a : b;
+    return (rank_a | rank_b) == 0 ? RADAR_POSTURE_STILL : best;
+}
+
+radar_posture_t radar_posture_from_string(const char *posture) {
+    if (posture == NULL) {
+        return RADAR_POSTURE_UNKNOWN;
+    }
+    for (int i = 1; i < RADAR_POSTURE_COUNT; i++) {
+        if (strcmp(posture, posture_names[i]) == 0) {
+            return (radar_posture_t)i;
+        }
+    }
+    return RADAR_POSTURE_UNKNOWN;
+}
+
+const char *radar_posture_name(radar_posture_t posture) {
+    return (unsigned)posture < RADAR_POSTURE_COUNT ? posture_names[posture] : posture_names[RADAR_POSTURE_UNKNOWN];
+}
@@ -0,0 +1,176 @@
+#include <string.h>
+#include "radar_wire.h"
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND                                                        \
+    do {                                                                \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);   \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                        \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                        \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);   \
+    } while (0)
+
+uint64_t hlk_siphash24(const uint8_t key[16], const void *data, size_t len) {
+    const uint8_t *in = (const uint8_t *)data;
+    uint64_t k0 = get_u64(key);
+    uint64_t k1 = get_u64(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+    uint64_t b = ((uint64_t)len) << 56;
+    const uint8_t *end = in + (len - (len % 8));
+
+    for (; in != end; in += 8) {
+        uint64_t m = get_u64(in);
+        v3 ^= m;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= m;
+    }
+    switch (len & 7) {
+    case 7: b |= ((uint64_t)in[6]) << 48; /* fall through */
+    case 6: b |= ((uint64_t)in[5]) << 40; /* fall through */
+    case 5: b |= ((uint64_t)in[4]) << 32; /* fall through */
+    case 4: b |= ((uint64_t)in[3]) << 24; /* fall through */
+    case 3: b |= ((uint64_t)in[2]) << 16; /* fall through */
+    case 2: b |= ((uint64_t)in[1]) << 8;  /* fall through */
+    case 1: b |= ((uint64_t)in[0]);       break;
+    case 0: break;
+    }
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+size_t radar_wire_encode(const radar_wire_sample_t *sample, const uint8_t key[RADAR_WIRE_KEY_LEN],
+                         uint8_t out[RADAR_WIRE_PACKET_LEN]) {
+    put_u16(out, RADAR_WIRE_MAGIC);
+    out[2] = RADAR_WIRE_VERSION;
+    out[3] = sample->module_id;
+    put_u32(out + 4, sample->sequence);
+    put_u32(out + 8, sample->timestamp_ms);
+    put_u16(out + 12, sample->distance_mm);
+    out[14] = sample->posture;
+    out[15] = sample->signal;
+    put_u16(out + 16, sample->moving_mm);
+    put_u16(out + 18, sample->static_mm);
+
+    uint64_t tag = hlk_siphash24(key, out, RADAR_WIRE_HEADER_LEN);
+    put_u32(out + RADAR_WIRE_HEADER_LEN, (uint32_t)tag);
+    put_u32(out + RADAR_WIRE_HEADER_LEN + 4, (uint32_t)(tag >> 32));
+    return RADAR_WIRE_PACKET_LEN;
+}
+
+radar_wire_status_t radar_wire_decode(const uint8_t *packet, size_t len, const uint8_t key[RADAR_WIRE_KEY_LEN],
+                                      radar_wire_sample_t *sample) {
+    if (len != RADAR_WIRE_PACKET_LEN && len != RADAR_WIRE_V1_PACKET_LEN) {
+        return RADAR_WIRE_ERR_LENGTH;
+    }
+    if (get_u16(packet) != RADAR_WIRE_MAGIC) {
+        return RADAR_WIRE_ERR_MAGIC;
+    }
+    size_t header_len;
+    if (packet[2] == RADAR_WIRE_VERSION) {
+        header_len = RADAR_WIRE_HEADER_LEN;
+    } else if (packet[2] == 1) {
+        header_len = RADAR_WIRE_V1_HEADER_LEN;
+    } else {
+        return RADAR_WIRE_ERR_VERSION;
+    }
+    if (len != header_len + RADAR_WIRE_TAG_LEN) {
+        return RADAR_WIRE_ERR_LENGTH;
+    }
+
+    uint64_t expected = hlk_siphash24(key, packet, header_len);
+    uint64_t received = get_u64(packet + header_len);
+    if ((expected ^ received) != 0) { // Single 64-bit compare: no early exit on partial match
+        return RADAR_WIRE_ERR_AUTH;
+    }
+
+    sample->module_id = packet[3];
+    sample->sequence = get_u32(packet + 4);
+    sample->timestamp_ms = get_u32(packet + 8);
+    sample->distance_mm = get_u16(packet + 12);
+    sample->posture = packet[14] < RADAR_POSTURE_COUNT ? packet[14] : RADAR_POSTURE_UNKNOWN;
+    sample->signal = packet[15];
+    sample->moving_mm = header_len > 16 ? get_u16(packet + 16) : 0;
+    sample->static_mm = header_len > 16 ? get_u16(packet + 18) : 0;
+    return RADAR_WIRE_OK;
+}
+
+radar_replay_result_t radar_wire_replay_check(radar_wire_replay_t *window, uint32_t sequence, uint32_t *lost) {
+    if (lost) {
+        *lost = 0;
+    }
+    if (!window->initialized) {
+        window->initialized = true;
+        window->highest = sequence;
+        window->bitmap = 1;
+        return RADAR_REPLAY_ACCEPT;
+    }
+
+    if (sequence > window->highest) {
+        uint32_t shift = sequence - window->highest;
+        if (lost) {
+            *lost = shift - 1;
+        }
+        window->bitmap = shift >= 64 ? 0 : window->bitmap << shift;
+        window->bitmap |= 1;
+        window->highest = sequence;
+        return RADAR_REPLAY_ACCEPT;
+    }
+
+    uint32_t offset = window->highest - sequence;
+    if (offset >= 64) {
+        return RADAR_REPLAY_TOO_OLD;
+    }
+    uint64_t bit = (uint64_t)1 << offset;
+    if (window->bitmap & bit) {
+        return RADAR_REPLAY_DUPLICATE;
+    }
+    window->bitmap |= bit; // Late (reordered) packet inside the window
+    return RADAR_REPLAY_ACCEPT;
+}
+
+radar_replay_result_t radar_wire_replay_check_resync(radar_wire_replay_t *window, uint32_t sequence, uint32_t *lost) {
+    radar_replay_result_t result = radar_wire_replay_check(window, sequence, lost);
+    if (result == RADAR_REPLAY_TOO_OLD && window->highest - sequence > RADAR_WIRE_RESYNC_GAP) {
+        window->initialized = false;
+        radar_wire_replay_check(window, sequence, NULL);
+        return RADAR_REPLAY_RESYNC;
+    }
+    return result;
+}
@@ -0,0 +1,377 @@
+// Alert outbox (alert_outbox.c) against a broker that goes away: the
+// embedded broker (mqtt_broker.c) on the loopback, stopped while alerts are
+// in flight and started again.
+//
+//   1. master side: alert_outbox_t and an mqtt_lite QoS 1 client, driven as
+//      AlertManager_task drives esp-mqtt: alert_outbox_take_due() published,
+//      PUBACKs to alert_outbox_ack(), alert_outbox_reset() on connection,
+//      the blob saved whenever the outbox changed (the NVS copy);
+//   2. subscriber on the alert topic, counting the alerts by their "id" and
+//      dropping the copies;
+//   3. each round: an alert is raised and published, then the broker is
+//      killed. Even rounds: before it has read the PUBLISH. Odd rounds: after
+//      it forwarded it, and the master reboots before reading the PUBACK
+//      (outbox reloaded from the blob, the alert published again under the
+//      same id). Two more alerts are raised during the outage, then the
+//      broker restarts and the subscriber comes back before the master;
+//   4. alerts raised / received / copies dropped / lost, publishes per
+//      alert, latency from the alert to its PUBACK (wall clock, 1 s
+//      resolution, for alerts delivered after a reboot).
+//
+// Exits with 1 if an alert is lost.
+//
+// Usage: bench_alert_outbox [-n rounds]
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "alert_outbox.h"
+#include "bench_common.h"
+#include "mqtt_broker.h"
+#include "mqtt_lite.h"
+
+#define BENCH_PORT      18850
+#define ALERT_TOPIC     "home/room1/alert" // As in main.c
+#define OUTAGE_MS       400
+#define CONNECT_RETRY_MS 50
+#define MAX_ALERTS      1024
+
+// Shorter than main.c: rounds of a fraction of a second
+static const alert_outbox_config_t outbox_config = {
+    .retry_base_ms = 100,
+    .retry_max_ms = 1000,
+    .ack_timeout_ms = 500,
+};
+
+typedef struct {
+    mqtt_broker_t broker;
+    pthread_t thread;
+    atomic_bool stop, pause, paused;
+} broker_ctx_t;
+
+typedef struct {
+    pthread_t thread;
+    atomic_bool stop, subscribed;
+    atomic_int sock;
+    atomic_uint received[MAX_ALERTS + 1]; // By alert id
+} subscriber_t;
+
+typedef struct {
+    alert_outbox_t outbox;
+    mqtt_lite_t client;
+    bool connected;
+    uint32_t next_connect_ms;
+    uint8_t blob[ALERT_OUTBOX_BLOB_MAX]; // NVS
+    size_t blob_len;
+    uint32_t publishes, reboots;
+} master_t;
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(bench_now_ns() / 1000000ull);
+}
+
+static void sleep_ms(uint32_t ms) {
+    usleep(ms * 1000u);
+}
+
+// --- Broker -----------------------------------------------------------------
+
+static void on_publish(const mqtt_broker_message_t *msg, void *arg) {
+    (void)msg;
+    (void)arg;
+}
+
+static void *broker_thread(void *arg) {
+    broker_ctx_t *ctx = arg;
+    while (!atomic_load(&ctx->stop)) {
+        if (atomic_load(&ctx->pause)) {
+            atomic_store(&ctx->paused, true);
+            sleep_ms(1);
+            continue;
+        }
+        atomic_store(&ctx->paused, false);
+        mqtt_broker_poll(&ctx->broker, 10, now_ms());
+    }
+    return NULL;
+}
+
+static bool start_broker(broker_ctx_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    mqtt_broker_config_t cfg = { .port = BENCH_PORT, .max_clients = 4, .on_publish = on_publish, .ctx = ctx };
+    if (mqtt_broker_start(&ctx->broker, &cfg) < 0) {
+        perror("mqtt_broker_start");
+        return false;
+    }
+    pthread_create(&ctx->thread, NULL, broker_thread, ctx);
+    return true;
+}
+
+// Stops polling: what clients send now stays unread
+static void pause_broker(broker_ctx_t *ctx) {
+    atomic_store(&ctx->pause, true);
+    while (!atomic_load(&ctx->paused)) {
+        sleep_ms(1);
+    }
+}
+
+// Sockets closed with whatever they had not read
+static void kill_broker(broker_ctx_t *ctx) {
+    atomic_store(&ctx->stop, true);
+    pthread_join(ctx->thread, NULL);
+    mqtt_broker_stop(&ctx->broker);
+}
+
+// --- Subscriber -------------------------------------------------------------
+
+static void *subscriber_thread(void *arg) {
+    subscriber_t *sub = arg;
+    static uint8_t buf[1024];
+    while (!atomic_load(&sub->stop)) {
+        mqtt_lite_t c;
+        if (mqtt_lite_connect(&c, "127.0.0.1", BENCH_PORT, "alert_subscriber", 60) < 0 ||
+            mqtt_lite_subscribe(&c, ALERT_TOPIC, 0) < 0) {
+            sleep_ms(CONNECT_RETRY_MS);
+            continue;
+        }
+        atomic_store(&sub->sock, c.sock);
+        atomic_store(&sub->subscribed, true);
+        for (;;) {
+            uint8_t type, flags;
+            int len = mqtt_lite_read_packet(&c, &type, &flags, buf, sizeof(buf));
+            if (len < 0) {
+                break; // Broker gone, or stopping
+            }
+            char topic[64];
+            const uint8_t *payload;
+            size_t payload_len;
+            if (type != MQTT_LITE_PUBLISH ||
+                mqtt_lite_parse_publish(buf, (size_t)len, flags, topic, sizeof(topic), &payload, &payload_len,
+                                        NULL) < 0) {
+                continue;
+            }
+            char text[256];
+            snprintf(text, sizeof(text), "%.*s", (int)payload_len, (const char *)payload);
+            unsigned id;
+            if (sscanf(text, "{\"id\": %u,", &id) == 1 && id <= MAX_ALERTS) {
+                atomic_fetch_add(&sub->received[id], 1);
+            }
+        }
+        atomic_store(&sub->subscribed, false);
+        close(c.sock);
+    }
+    return NULL;
+}
+
+// --- Master -----------------------------------------------------------------
+
+static void master_init(master_t *m) {
+    memset(m, 0, sizeof(*m));
+    alert_outbox_init(&m->outbox, &outbox_config);
+}
+
+static void master_disconnect(master_t *m) {
+    close(m->client.sock);
+    m->connected = false;
+    m->next_connect_ms = now_ms() + CONNECT_RETRY_MS;
+}
+
+static void master_persist(master_t *m) {
+    if (m->outbox.dirty) {
+        m->blob_len = alert_outbox_save(&m->outbox, m->blob, sizeof(m->blob));
+    }
+}
+
+static uint32_t master_raise(master_t *m, uint8_t room) {
+    AlertMessage alert = { .alert_timestamp = now_ms(), .type = ALERT_TYPE_FALL_DETECTED, .room = room };
+    uint32_t id = alert_outbox_push(&m->outbox, &alert, now_ms(), (uint32_t)time(NULL));
+    master_persist(m);
+    return id;
+}
+
+static void master_publish_due(master_t *m) {
+    alert_outbox_entry_t entry;
+    char description[ALERT_DESCRIPTION_MAX], payload[ALERT_PAYLOAD_MAX];
+    while (m->connected && alert_outbox_take_due(&m->outbox, now_ms(), &entry)) {
+        alert_describe(&entry.alert, description, sizeof(description));
+        alert_payload(&entry.alert, entry.id, description, payload, sizeof(payload));
+        uint16_t packet_id = 0;
+        int sent = mqtt_lite_publish(&m->client, ALERT_TOPIC, payload, strlen(payload), 1, &packet_id);
+        alert_outbox_sent(&m->outbox, entry.id, sent < 0 ? -1 : packet_id, now_ms(), (uint32_t)time(NULL));
+        m->publishes++;
+        if (sent < 0) {
+            master_disconnect(m);
+        }
+    }
+}
+
+// One pass of the master loop: connection, PUBACKs, due publishes, NVS copy
+static void master_step(master_t *m) {
+    if (!m->connected && (int32_t)(now_ms() - m->next_connect_ms) >= 0) {
+        if (mqtt_lite_connect(&m->client, "127.0.0.1", BENCH_PORT, "esp32_master_controller_1", 60) == 0) {
+            m->connected = true;
+            alert_outbox_reset(&m->outbox, now_ms());
+        } else {
+            m->next_connect_ms = now_ms() + CONNECT_RETRY_MS;
+        }
+    }
+    while (m->connected) {
+        struct pollfd pfd = { .fd = m->client.sock, .events = POLLIN };
+        if (poll(&pfd, 1, 0) <= 0) {
+            break;
+        }
+        uint8_t type, flags, body[64];
+        int len = mqtt_lite_read_packet(&m->client, &type, &flags, body, sizeof(body));
+        if (len < 0) {
+            master_disconnect(m);
+        } else if (type == MQTT_LITE_PUBACK && len >= 2) {
+            alert_outbox_ack(&m->outbox, (int32_t)((body[0] << 8) | body[1]), now_ms(), (uint32_t)time(NULL), NULL,
+                             NULL);
+        }
+    }
+    master_publish_due(m);
+    master_persist(m);
+}
+
+// Power cut: the socket dropped unread, the outbox back from the NVS copy
+static void master_reboot(master_t *m) {
+    close(m->client.sock);
+    m->connected = false;
+    alert_outbox_stats_t stats = m->outbox.stats; // Kept across reboots for the report only
+    alert_outbox_init(&m->outbox, &outbox_config);
+    if (!alert_outbox_load(&m->outbox, m->blob, m->blob_len, now_ms())) {
+        fprintf(stderr, "outbox blob rejected at reboot\n");
+    }
+    stats.restored += m->outbox.stats.restored;
+    m->outbox.stats = stats;
+    m->reboots++;
+}
+
+// --- Rounds -----------------------------------------------------------------
+
+static bool wait_for(atomic_bool *flag, uint32_t timeout_ms) {
+    uint32_t start = now_ms();
+    while (!atomic_load(flag) && now_ms() - start < timeout_ms) {
+        sleep_ms(1);
+    }
+    return atomic_load(flag);
+}
+
+// Master loop until its outbox is empty
+static bool drain(master_t *m, uint32_t timeout_ms) {
+    uint32_t start = now_ms();
+    while (alert_outbox_count(&m->outbox) > 0 && now_ms() - start < timeout_ms) {
+        master_step(m);
+        sleep_ms(1);
+    }
+    return alert_outbox_count(&m->outbox) == 0;
+}
+
+int main(int argc, char **argv) {
+    int rounds = 20;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            rounds = atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-n rounds]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rounds < 2 || rounds * 3 > MAX_ALERTS) {
+        rounds = rounds < 2 ? 2 : MAX_ALERTS / 3;
+    }
+    printf("CPUs: %ld, %d rounds, broker down %d ms per round, ack timeout %u ms, retry %u..%u ms\n\n",
+           sysconf(_SC_NPROCESSORS_ONLN), rounds, OUTAGE_MS, outbox_config.ack_timeout_ms,
+           outbox_config.retry_base_ms, outbox_config.retry_max_ms);
+
+    static broker_ctx_t broker;
+    static subscriber_t sub;
+    static master_t master;
+    master_init(&master);
+    if (!start_broker(&broker)) {
+        return 1;
+    }
+    pthread_create(&sub.thread, NULL, subscriber_thread, &sub);
+    wait_for(&sub.subscribed, 2000);
+
+    uint32_t raised = 0, stuck_rounds = 0;
+    for (int r = 0; r < rounds; r++) {
+        bool reboot = r % 2 == 1;
+        while (!master.connected) {
+            master_step(&master);
+            sleep_ms(1);
+        }
+        // The alert in flight when the broker dies
+        uint32_t id = master_raise(&master, (uint8_t)r);
+        raised++;
+        if (!reboot) {
+            pause_broker(&broker);
+            master_step(&master);
+        } else {
+            master_publish_due(&master);
+            uint32_t start = now_ms();
+            while (atomic_load(&sub.received[id]) == 0 && now_ms() - start < 1000) {
+                sleep_ms(1);
+            }
+        }
+        kill_broker(&broker);
+        if (reboot) {
+            master_reboot(&master);
+        }
+
+        // Outage: two more alerts, the master retrying its connection
+        uint32_t down_start = now_ms();
+        int outage_alerts = 0;
+        while (now_ms() - down_start < OUTAGE_MS) {
+            if (now_ms() - down_start >= (uint32_t)(outage_alerts + 1) * OUTAGE_MS / 3 && outage_alerts < 2) {
+                master_raise(&master, (uint8_t)r);
+                raised++;
+                outage_alerts++;
+            }
+            master_step(&master);
+            sleep_ms(1);
+        }
+
+        // Back: the subscriber first (a persistent session would keep its
+        // subscription across the outage; the embedded broker has none)
+        if (!start_broker(&broker) || !wait_for(&sub.subscribed, 2000)) {
+            fprintf(stderr, "broker or subscriber did not come back\n");
+            return 1;
+        }
+        if (!drain(&master, 5000)) {
+            stuck_rounds++;
+        }
+    }
+    // Last deliveries of the subscriber
+    sleep_ms(100);
+
+    uint32_t once = 0, copies = 0, lost = 0;
+    for (uint32_t id = 1; id <= raised; id++) {
+        unsigned n = atomic_load(&sub.received[id]);
+        once += n >= 1;
+        copies += n > 1 ? n - 1 : 0;
+        lost += n == 0;
+    }
+    const alert_outbox_stats_t *stats = &master.outbox.stats;
+    printf("%10s %10s %14s %8s %12s %10s %10s %16s %14s\n", "raised", "received", "copies dropped", "lost",
+           "publishes", "reboots", "restored", "latency mean ms", "latency max ms");
+    printf("%10u %10u %14u %8u %12u %10u %10u %16.1f %14u\n", raised, once, copies, lost, master.publishes,
+           master.reboots, stats->restored,
+           stats->latency_count ? (double)stats->latency_sum_ms / stats->latency_count : 0.0, stats->latency_max_ms);
+    printf("\n%u of %u alerts delivered once the broker was back%s, %u round(s) not drained in time\n", once, raised,
+           lost ? "" : " (all)", stuck_rounds);
+
+    atomic_store(&sub.stop, true);
+    shutdown(atomic_load(&sub.sock), SHUT_RDWR);
+    kill_broker(&broker);
+    pthread_join(sub.thread, NULL);
+    return lost == 0 && stuck_rounds == 0 ? 0 : 1;
+}
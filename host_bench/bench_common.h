@@ -0,0 +1,50 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Small helpers shared by the host benchmarks: monotonic clock and latency summaries.
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    size_t count;
+    double p50_us, p99_us, max_us, mean_us;
+} bench_latency_t;
+
+// Sorts `samples_ns` in place and summarizes it.
+static inline bench_latency_t bench_summarize(uint64_t *samples_ns, size_t count) {
+    bench_latency_t r = { .count = count };
+    if (count == 0) {
+        return r;
+    }
+    qsort(samples_ns, count, sizeof(uint64_t), bench_cmp_u64);
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += (double)samples_ns[i];
+    }
+    r.mean_us = sum / (double)count / 1000.0;
+    r.p50_us = samples_ns[count / 2] / 1000.0;
+    r.p99_us = samples_ns[(count * 99) / 100] / 1000.0;
+    r.max_us = samples_ns[count - 1] / 1000.0;
+    return r;
+}
+
+static inline void bench_print_latency(const char *label, const bench_latency_t *r) {
+    printf("  %-28s n=%-7zu p50=%8.1f us  p99=%8.1f us  max=%8.1f us  mean=%8.1f us\n",
+           label, r->count, r->p50_us, r->p99_us, r->max_us, r->mean_us);
+}
+
+#endif // BENCH_COMMON_H
@@ -0,0 +1,116 @@
+// Cost per fused output of the sliding-window fall features
+// (fall_features.c), updated incrementally, against a full pass over the
+// window for every output (what a naive version would do), at 5 to 50
+// outputs per second.
+//
+// One person walking, sitting and falling, with posture probabilities
+// swinging over a few outputs. Reports per rate:
+//   - samples in the window (bounded by FALL_FEATURE_CAPACITY);
+//   - ns per output, add + get, incremental and full pass.
+//
+// Usage: bench_fall_features [-n outputs]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "fall_features.h"
+
+static uint32_t rng_state = 9090;
+
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static void generate(FusedData *outputs, size_t count, uint32_t period_ms) {
+    int16_t x = 2000, y = 2000;
+    uint8_t lying = 0;
+    for (size_t i = 0; i < count; i++) {
+        FusedData *d = &outputs[i];
+        memset(d, 0, sizeof(*d));
+        d->timestamp = 1000 + (uint32_t)i * period_ms + rng_next() % (period_ms / 2 + 1);
+        if (rng_next() % 200 == 0) {
+            lying = lying ? 0 : 1;
+        }
+        x = (int16_t)(x + (int)(rng_next() % 41) - 20);
+        y = (int16_t)(y + (int)(rng_next() % 41) - 20);
+        d->x_mm = x;
+        d->y_mm = y;
+        uint8_t p = (uint8_t)(lying ? 70 + rng_next() % 30 : rng_next() % 20);
+        d->posture_pct[RADAR_POSTURE_LYING] = p;
+        d->posture_pct[RADAR_POSTURE_STANDING] = (uint8_t)(100 - p);
+        d->posture = p > 50 ? RADAR_POSTURE_LYING : RADAR_POSTURE_STANDING;
+    }
+}
+
+// Full pass over the window for every output: same statistics, O(window)
+static void full_pass(const fall_features_t *ff, fall_feature_values_t *out) {
+    int16_t peak = 0;
+    double sx = 0, sy = 0, sxx = 0, syy = 0;
+    for (int k = 0; k < ff->count; k++) {
+        const fall_feature_sample_t *s = &ff->samples[(ff->head + k) % FALL_FEATURE_CAPACITY];
+        peak = s->descent_mm_s > peak ? s->descent_mm_s : peak;
+        sx += s->x_mm;
+        sy += s->y_mm;
+        sxx += (double)s->x_mm * s->x_mm;
+        syy += (double)s->y_mm * s->y_mm;
+    }
+    double n = ff->count ? ff->count : 1;
+    double var = sxx / n - (sx / n) * (sx / n) + syy / n - (sy / n) * (sy / n);
+    out->peak_descent_mm_s = (uint16_t)peak;
+    out->position_std_mm = (uint16_t)sqrt(var > 0 ? var : 0);
+    out->samples = ff->count;
+}
+
+static volatile uint32_t sink;
+
+int main(int argc, char **argv) {
+    size_t count = 2000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    FusedData *outputs = malloc(count * sizeof(FusedData));
+
+    printf("fall_features: %zu outputs, window %d ms, at most %d samples, fall_features_t is %zu B\n", count,
+           FALL_FEATURE_WINDOW_MS, FALL_FEATURE_CAPACITY, sizeof(fall_features_t));
+    printf("  outputs/s  samples  ns/output     ns/output\n");
+    printf("                      incremental   full pass\n");
+    static const uint32_t periods_ms[] = { 200, 100, 40, 20 };
+    for (size_t p = 0; p < sizeof(periods_ms) / sizeof(periods_ms[0]); p++) {
+        rng_state = 9090;
+        generate(outputs, count, periods_ms[p]);
+        uint64_t best_inc = UINT64_MAX, best_full = UINT64_MAX;
+        fall_features_t ff;
+        fall_feature_values_t f;
+        for (int rep = 0; rep < 3; rep++) {
+            fall_features_init(&ff);
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < count; i++) {
+                fall_features_add(&ff, &outputs[i]);
+                fall_features_get(&ff, outputs[i].timestamp, &f);
+                sink += f.peak_descent_mm_s + f.position_std_mm;
+            }
+            uint64_t elapsed = bench_now_ns() - t0;
+            best_inc = elapsed < best_inc ? elapsed : best_inc;
+
+            fall_features_init(&ff);
+            t0 = bench_now_ns();
+            for (size_t i = 0; i < count; i++) {
+                fall_features_add(&ff, &outputs[i]);
+                full_pass(&ff, &f);
+                sink += f.peak_descent_mm_s + f.position_std_mm;
+            }
+            elapsed = bench_now_ns() - t0;
+            best_full = elapsed < best_full ? elapsed : best_full;
+        }
+        printf("  %9u  %7u  %11.1f  %10.1f\n", 1000 / periods_ms[p], f.samples, (double)best_inc / (double)count,
+               (double)best_full / (double)count);
+    }
+    free(outputs);
+    return 0;
+}
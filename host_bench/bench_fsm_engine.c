@@ -0,0 +1,175 @@
+// Per-event dispatch cost of the fall rules on the state-machine engine
+// (fsm_engine.c + fall_rules.c), against the former hand-coded rule of
+// FallDetector_task, for 1 to 4096 independent instances.
+//
+// Each instance is one person: postures change every 0.3 to 10 s, with falls
+// (fast transition to LYING held 10 to 40 s). Events are spread over the
+// instances at random, as outputs of different rooms and tracks interleave
+// on the fusion output queue. Reports per instance count:
+//   - ns per event, engine and hand-coded rule (same decisions: checked);
+//   - ns per instance for a timer tick of the engine;
+//   - bytes of state per instance.
+//
+// Usage: bench_fsm_engine [-n events]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "fall_rules.h"
+
+typedef struct {
+    uint16_t instance;
+    fsm_event_t event;
+} bench_event_t;
+
+// Former FallTrackState of main.c: previous output and potential fall start
+typedef struct {
+    FusedData previous_data;
+    bool previous_data_valid;
+    uint32_t potential_fall_start_time_ms;
+    bool in_potential_fall_state;
+} legacy_state_t;
+
+static uint32_t rng_state = 2468;
+
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// Hand-coded rule (FallDetector_task before the engine). Returns 1 on a confirmation.
+static int legacy_process(legacy_state_t *st, const FusedData *current) {
+    int confirmed = 0;
+    bool is_lying = current->posture == RADAR_POSTURE_LYING;
+    if (st->previous_data_valid && is_lying &&
+        radar_posture_is_upright_or_moving((radar_posture_t)st->previous_data.posture) &&
+        current->timestamp - st->previous_data.timestamp < FALL_TRANSITION_MAX_MS) {
+        st->in_potential_fall_state = true;
+        st->potential_fall_start_time_ms = current->timestamp;
+    }
+    if (st->in_potential_fall_state) {
+        if (!is_lying) {
+            st->in_potential_fall_state = false;
+        } else if (current->timestamp - st->potential_fall_start_time_ms >= LYING_CONFIRMATION_DURATION_S * 1000u) {
+            confirmed = 1;
+            st->in_potential_fall_state = false;
+        }
+    }
+    st->previous_data = *current;
+    st->previous_data_valid = true;
+    return confirmed;
+}
+
+// Events of `instances` people, in time order, about 10 per second each
+static void generate(bench_event_t *events, size_t count, int instances) {
+    uint32_t *posture_until = calloc((size_t)instances, sizeof(uint32_t));
+    uint8_t *posture = calloc((size_t)instances, 1);
+    uint32_t now = 1000;
+    for (size_t i = 0; i < count; i++) {
+        now += 1 + rng_next() % (200 / (uint32_t)(instances < 20 ? instances : 20));
+        int k = (int)(rng_next() % (uint32_t)instances);
+        if (now >= posture_until[k]) {
+            uint32_t r = rng_next() % 100;
+            if (posture[k] != RADAR_POSTURE_LYING && radar_posture_is_upright_or_moving((radar_posture_t)posture[k]) && r < 10) {
+                posture[k] = RADAR_POSTURE_LYING;
+                posture_until[k] = now + 10000 + rng_next() % 30000;
+            } else {
+                posture[k] = (uint8_t)(RADAR_POSTURE_STANDING + rng_next() % 5);
+                posture_until[k] = now + 300 + rng_next() % 9700;
+            }
+        }
+        events[i].instance = (uint16_t)k;
+        events[i].event.now_ms = now;
+        events[i].event.posture = posture[k];
+        events[i].event.speed_mm_s = posture[k] == RADAR_POSTURE_MOVING ? (uint16_t)(500 + rng_next() % 800) : (uint16_t)(rng_next() % 200);
+    }
+    free(posture_until);
+    free(posture);
+}
+
+static volatile int sink;
+
+int main(int argc, char **argv) {
+    size_t count = 4000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    const fsm_table_t *table = fall_rules_table();
+    if (!fall_rules_init()) {
+        fprintf(stderr, "fall rule table rejected\n");
+        return 1;
+    }
+    bench_event_t *events = malloc(count * sizeof(bench_event_t));
+
+    printf("fsm_engine: %zu events, %u fall rules, %zu B per instance (hand-coded rule: %zu B)\n", count,
+           table->rule_count, sizeof(fsm_instance_t), sizeof(legacy_state_t));
+    printf("  instances  ns/event  ns/event    ns/tick     falls   same\n");
+    printf("             engine    hand-coded  /instance   found   decisions\n");
+    static const int sizes[] = { 1, 16, 80, 512, 4096 };
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++) {
+        int instances = sizes[n];
+        rng_state = 2468;
+        generate(events, count, instances);
+        fsm_instance_t *fsm = malloc((size_t)instances * sizeof(fsm_instance_t));
+        legacy_state_t *legacy = malloc((size_t)instances * sizeof(legacy_state_t));
+
+        uint64_t best_engine = UINT64_MAX, best_legacy = UINT64_MAX, best_tick = UINT64_MAX;
+        size_t confirms = 0;
+        for (int rep = 0; rep < 3; rep++) {
+            for (int k = 0; k < instances; k++) {
+                fsm_instance_init(&fsm[k], FALL_STATE_WATCHING, 0);
+            }
+            confirms = 0;
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < count; i++) {
+                confirms += fsm_dispatch(table, &fsm[events[i].instance], &events[i].event) == FALL_ACTION_CONFIRM;
+            }
+            uint64_t elapsed = bench_now_ns() - t0;
+            best_engine = elapsed < best_engine ? elapsed : best_engine;
+
+            // One tick of every instance, as the task does every FALL_TICK_MS
+            uint32_t now = events[count - 1].event.now_ms;
+            t0 = bench_now_ns();
+            for (int tick = 0; tick < 100; tick++) {
+                for (int k = 0; k < instances; k++) {
+                    sink += fsm_tick(table, &fsm[k], now, ZONE_FALL_NORMAL);
+                }
+            }
+            elapsed = (bench_now_ns() - t0) / 100;
+            best_tick = elapsed < best_tick ? elapsed : best_tick;
+
+            memset(legacy, 0, (size_t)instances * sizeof(legacy_state_t));
+            t0 = bench_now_ns();
+            for (size_t i = 0; i < count; i++) {
+                FusedData data = { .timestamp = events[i].event.now_ms, .posture = events[i].event.posture };
+                sink += legacy_process(&legacy[events[i].instance], &data);
+            }
+            elapsed = bench_now_ns() - t0;
+            best_legacy = elapsed < best_legacy ? elapsed : best_legacy;
+        }
+
+        // Decisions (not timed): the engine without the speed guard must match the hand-coded rule
+        size_t same = 0;
+        for (int k = 0; k < instances; k++) {
+            fsm_instance_init(&fsm[k], FALL_STATE_WATCHING, 0);
+        }
+        memset(legacy, 0, (size_t)instances * sizeof(legacy_state_t));
+        for (size_t i = 0; i < count; i++) {
+            fsm_event_t event = events[i].event;
+            event.speed_mm_s = 0;
+            FusedData data = { .timestamp = event.now_ms, .posture = event.posture };
+            int a = fsm_dispatch(table, &fsm[events[i].instance], &event) == FALL_ACTION_CONFIRM;
+            same += a == legacy_process(&legacy[events[i].instance], &data);
+        }
+        printf("  %9d  %8.1f  %10.1f  %9.1f  %7zu   %5.1f %%\n", instances, (double)best_engine / (double)count,
+               (double)best_legacy / (double)count, (double)best_tick / instances, confirms, 100.0 * same / count);
+        free(fsm);
+        free(legacy);
+    }
+    free(events);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Per-message cost of the fusion core (fusion_engine.c) with 1 to 64 radar
+// modules. Modules are spread over rooms of 4 (a single room below 4 modules)
+// and send round robin, one sample every 50 ms each.
+// The cost per message should not grow with the number of modules or rooms:
+// a message only touches the slot table of its own room.
+//
+// Usage: bench_fusion_engine [-n messages]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "fusion_engine.h"
+
+#define MODULES_PER_ROOM 4
+#define SAMPLE_PERIOD_MS 50
+#define SYNC_WINDOW_MS   500 // SENSOR_SYNC_WINDOW_MS of master_firmware/main/main.c
+
+static fusion_engine_t engine;
+static volatile uint32_t sink;
+
+typedef struct {
+    uint64_t elapsed_ns;
+    uint32_t fused;
+    uint32_t expired;
+} run_result_t;
+
+static void setup(int modules) {
+    fusion_engine_init(&engine, SYNC_WINDOW_MS, FUSION_DEFAULT_QUORUM);
+    for (int id = 1; id <= modules; id++) {
+        char room[FUSION_ROOM_NAME_LEN];
+        snprintf(room, sizeof(room), "room%d", (id - 1) / MODULES_PER_ROOM);
+        if (fusion_engine_assign(&engine, id, room) < 0) {
+            fprintf(stderr, "assign %d failed\n", id);
+            exit(1);
+        }
+    }
+}
+
+static run_result_t run(int modules, const uint8_t *postures, size_t messages) {
+    run_result_t r = { 0 };
+    fusion_set_t set;
+    setup(modules);
+
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < messages; i++) {
+        RadarMessage msg = {
+            .timestamp = (uint32_t)(i / (size_t)modules) * SAMPLE_PERIOD_MS,
+            .distance_mm = 2500,
+            .module_id = (uint8_t)(1 + i % (size_t)modules),
+            .posture = postures[i],
+            .signal = 80,
+        };
+        if (fusion_engine_update(&engine, &msg, msg.timestamp + 5, &set) == FUSION_FUSED) {
+            r.fused++;
+            sink += set.posture;
+        }
+    }
+    r.elapsed_ns = bench_now_ns() - t0;
+    for (int i = 0; i < engine.room_count; i++) {
+        r.expired += engine.rooms[i].expired_count;
+    }
+    return r;
+}
+
+int main(int argc, char **argv) {
+    size_t messages = 4000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            messages = strtoull(argv[++i], NULL, 10);
+        }
+    }
+
+    uint8_t *postures = malloc(messages);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < messages; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        postures[i] = (uint8_t)(1 + (seed >> 16) % (RADAR_POSTURE_COUNT - 1));
+    }
+
+    static const int counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    printf("fusion_engine: %zu messages per run, rooms of %d modules, quorum %d, window %d ms\n",
+           messages, MODULES_PER_ROOM, FUSION_DEFAULT_QUORUM, SYNC_WINDOW_MS);
+    printf("  modules  rooms   ns/msg   fused sets  expired\n");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        int modules = counts[c];
+        run(modules, postures, messages / 10); // Warm up
+        run_result_t best = { .elapsed_ns = UINT64_MAX };
+        for (int rep = 0; rep < 3; rep++) {
+            run_result_t r = run(modules, postures, messages);
+            if (r.elapsed_ns < best.elapsed_ns) {
+                best = r;
+            }
+        }
+        printf("  %7d  %5d  %7.2f  %11u  %7u\n", modules, engine.room_count,
+               (double)best.elapsed_ns / (double)messages, best.fused, best.expired);
+    }
+    printf("  (1 module: below the quorum, every sample fused alone in degraded mode; fusion_engine_t is %zu B)\n",
+           sizeof(fusion_engine_t));
+    free(postures);
+    return 0;
+}
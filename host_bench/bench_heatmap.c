@@ -0,0 +1,134 @@
+// Occupancy heatmap (heatmap.c): cost of an update against the grid size,
+// vs decaying every cell at each update, and cost of the binary export.
+//
+//   1. grids of 16 x 16 (4 m at 250 mm, the master), 64 x 64 and 128 x 128
+//      cells (32 m, the int16 mm limit); 20 Hz outputs of a person walking
+//      around, with a half-life of 60 s so that the cells are rescaled every
+//      16 minutes of simulated time. ns per update, rescales included;
+//   2. the same stream with an eager decay: every cell multiplied by the
+//      decay since the previous update, then the time added. Checks that both
+//      grids end with the same values (largest cell difference over the
+//      total);
+//   3. export at 1, 4 and 16 cells per tile side: bytes and us per export.
+//
+// Usage: bench_heatmap [-n updates]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "heatmap.h"
+
+#define STEP_MS      50
+#define HALF_LIFE_MS 60000
+#define MAX_SIDE     128
+
+static volatile uint32_t sink;
+
+static float lazy_cells[MAX_SIDE * MAX_SIDE];
+static float eager_cells[MAX_SIDE * MAX_SIDE];
+static uint8_t export_buf[HEATMAP_EXPORT_HEADER_LEN + MAX_SIDE * MAX_SIDE];
+
+// Person walking in a loop around the room, pausing now and then
+static void position_at(uint32_t i, int side_mm, int16_t *x, int16_t *y) {
+    float t = (float)i * STEP_MS / 1000.0f;
+    float r = 0.35f * (float)side_mm * (0.6f + 0.4f * sinf(t * 0.05f));
+    *x = (int16_t)(0.5f * (float)side_mm + r * cosf(t * 0.2f));
+    *y = (int16_t)(0.5f * (float)side_mm + r * sinf(t * 0.13f));
+}
+
+static void run_grid(int side, uint32_t updates) {
+    const uint16_t cell = 250;
+    int side_mm = side * cell;
+    heatmap_t hm;
+    heatmap_init(&hm, lazy_cells, MAX_SIDE * MAX_SIDE, 0, 0, (int16_t)side_mm, (int16_t)side_mm, cell, HALF_LIFE_MS,
+                 0);
+    uint32_t cells = (uint32_t)hm.cols * hm.rows;
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 1; i <= updates; i++) {
+        int16_t x, y;
+        position_at(i, side_mm, &x, &y);
+        heatmap_add(&hm, x, y, STEP_MS, i * STEP_MS);
+    }
+    double lazy_ns = (double)(bench_now_ns() - t0) / updates;
+    unsigned rescales = atomic_load(&hm.rescales) / 2;
+
+    // Eager decay, fewer updates when the grid is large
+    uint32_t eager_updates = updates / (cells / 256 + 1);
+    memset(eager_cells, 0, cells * sizeof(float));
+    const float step_decay = exp2f(-(float)STEP_MS / HALF_LIFE_MS);
+    t0 = bench_now_ns();
+    for (uint32_t i = 1; i <= eager_updates; i++) {
+        int16_t x, y;
+        position_at(i, side_mm, &x, &y);
+        for (uint32_t c = 0; c < cells; c++) {
+            eager_cells[c] *= step_decay;
+        }
+        eager_cells[(y / cell) * hm.cols + x / cell] += STEP_MS;
+    }
+    double eager_ns = (double)(bench_now_ns() - t0) / eager_updates;
+
+    // Same values when both saw the same stream
+    heatmap_init(&hm, lazy_cells, MAX_SIDE * MAX_SIDE, 0, 0, (int16_t)side_mm, (int16_t)side_mm, cell, HALF_LIFE_MS,
+                 0);
+    for (uint32_t i = 1; i <= eager_updates; i++) {
+        int16_t x, y;
+        position_at(i, side_mm, &x, &y);
+        heatmap_add(&hm, x, y, STEP_MS, i * STEP_MS);
+    }
+    double worst = 0.0;
+    float total = 0.0f;
+    for (uint32_t c = 0; c < cells; c++) {
+        total += eager_cells[c];
+    }
+    for (int r = 0; r < hm.rows; r++) {
+        for (int c = 0; c < hm.cols; c++) {
+            float lazy = heatmap_cell_ms(&hm, c, r, eager_updates * STEP_MS);
+            double diff = fabs((double)lazy - eager_cells[r * hm.cols + c]) / (total > 0.0f ? total : 1.0f);
+            worst = diff > worst ? diff : worst;
+        }
+    }
+
+    printf("  %3d x %-3d %8u B %10u %12.1f %12.1f %14.2e\n", hm.cols, hm.rows, (unsigned)(cells * sizeof(float)),
+           rescales, lazy_ns, eager_ns, worst);
+
+    for (int tile = 1; tile <= 16; tile *= 4) {
+        int len = 0;
+        uint32_t runs = 2000000u / cells + 1;
+        t0 = bench_now_ns();
+        for (uint32_t k = 0; k < runs; k++) {
+            len = heatmap_export(&hm, 0, (uint8_t)tile, eager_updates * STEP_MS, export_buf, sizeof(export_buf));
+            sink += export_buf[HEATMAP_EXPORT_HEADER_LEN];
+        }
+        printf("  %-9s export, tiles of %2d: %6d bytes, %9.2f us\n", "", tile, len,
+               (double)(bench_now_ns() - t0) / runs / 1000.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t updates = 2000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            updates = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n updates]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (updates == 0) {
+        updates = 1;
+    }
+    printf("CPUs: %ld, %u updates at %d Hz (%.1f h simulated), half-life %d s\n\n", sysconf(_SC_NPROCESSORS_ONLN),
+           updates, 1000 / STEP_MS, (double)updates * STEP_MS / 3.6e6, HALF_LIFE_MS / 1000);
+    printf("  %-9s %10s %10s %12s %12s %14s\n", "grid", "RAM", "rescales", "lazy ns", "eager ns", "max rel diff");
+    static const int sides[] = { 16, 64, 128 };
+    for (size_t i = 0; i < sizeof(sides) / sizeof(sides[0]); i++) {
+        run_grid(sides[i], updates);
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Long immobility monitor (inactivity_monitor.c): cost of the streaming
+// update and of the timer check, vs rescanning a window of history at every
+// tick.
+//
+//   1. 16 rooms (FUSION_MAX_ROOMS), one person each, fused outputs at 5 Hz:
+//      sitting still (position and speed noise) for 2 to 50 min, then
+//      walking for 20 s; in every fourth room the person ends up lying on
+//      the floor for an hour once a day (the slow collapse);
+//   2. streaming: inactivity_update() per output, inactivity_check() per
+//      room every second. ns per output, ns per check, alerts per level;
+//   3. rescan: the outputs of the last window (30 min, 2 h) kept per room,
+//      and scanned back from the newest to the last motion every second.
+//      ns per check and RAM per room.
+//
+// Usage: bench_inactivity_monitor [-n hours]
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "inactivity_monitor.h"
+
+#define ROOMS        16
+#define STEP_MS      200
+#define OUTPUTS_PER_S (1000 / STEP_MS)
+
+static volatile uint32_t sink;
+
+static const inactivity_config_t cfg = {
+    .level_s = { 30 * 60, 60 * 60, 120 * 60 },
+    .motion_speed_mm_s = 200,
+    .motion_mm = 300,
+    .lying_pct = 25,
+    .night_pct = 200,
+    .night_start_min = 22 * 60,
+    .night_end_min = 7 * 60,
+    .absent_ms = 5 * 60 * 1000,
+};
+
+static uint32_t rng_state = 4747;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+// Person of one room: still, walking or lying until `until_ms`
+typedef struct {
+    uint32_t until_ms;
+    uint32_t collapsed_days;  // Days + 1 of the last collapse
+    bool walking, lying;
+    int16_t x_mm, y_mm;
+} person_t;
+
+static FusedData next_output(person_t *p, int room, uint32_t now_ms) {
+    if ((int32_t)(now_ms - p->until_ms) >= 0) {
+        uint32_t day = now_ms / 86400000u;
+        p->lying = room % 4 == 0 && p->collapsed_days != day + 1 && now_ms % 86400000u >= 2u * 3600000u;
+        p->collapsed_days = p->lying ? day + 1 : p->collapsed_days;
+        p->walking = !p->walking && !p->lying;
+        p->until_ms = now_ms + (p->lying ? 3600000u
+                                : p->walking ? 20000u : (uint32_t)(120000.0f + rng_uniform() * 2880000.0f));
+    }
+    FusedData d = { 0 };
+    d.timestamp = now_ms;
+    d.room = (uint8_t)room;
+    d.track_id = 1;
+    d.occupants = 1;
+    d.sigma_cm = 25;
+    if (p->walking) {
+        p->x_mm = (int16_t)(500 + (int)(rng_uniform() * 3000));
+        p->y_mm = (int16_t)(500 + (int)(rng_uniform() * 3000));
+        d.vx_mm_s = 800;
+        d.posture = RADAR_POSTURE_MOVING;
+    } else {
+        d.vx_mm_s = (int16_t)(rng_uniform() * 80.0f - 40.0f);
+        d.posture = p->lying ? RADAR_POSTURE_LYING : RADAR_POSTURE_SITTING;
+    }
+    d.x_mm = (int16_t)(p->x_mm + (int)(rng_uniform() * 60.0f) - 30);
+    d.y_mm = (int16_t)(p->y_mm + (int)(rng_uniform() * 60.0f) - 30);
+    d.vy_mm_s = (int16_t)(rng_uniform() * 80.0f - 40.0f);
+    return d;
+}
+
+// Rescan baseline: window of outputs per room, newest at head - 1
+typedef struct {
+    FusedData *outputs;
+    uint32_t capacity, head, count;
+} history_t;
+
+static bool is_motion(const FusedData *d, const FusedData *newest) {
+    int32_t vx = d->vx_mm_s, vy = d->vy_mm_s;
+    int32_t dx = (int32_t)d->x_mm - newest->x_mm, dy = (int32_t)d->y_mm - newest->y_mm;
+    return d->posture == RADAR_POSTURE_MOVING || d->posture != newest->posture ||
+           vx * vx + vy * vy >= (int32_t)cfg.motion_speed_mm_s * cfg.motion_speed_mm_s ||
+           dx * dx + dy * dy >= (int32_t)cfg.motion_mm * cfg.motion_mm;
+}
+
+static uint32_t rescan_still_ms(const history_t *h, uint32_t now_ms) {
+    if (h->count == 0) {
+        return 0;
+    }
+    const FusedData *newest = &h->outputs[(h->head + h->capacity - 1) % h->capacity];
+    for (uint32_t i = 1; i < h->count; i++) {
+        const FusedData *d = &h->outputs[(h->head + h->capacity - 1 - i) % h->capacity];
+        if (is_motion(d, newest)) {
+            return now_ms - d->timestamp;
+        }
+    }
+    return now_ms - h->outputs[(h->head + h->capacity - h->count) % h->capacity].timestamp;
+}
+
+static void run_streaming(uint32_t hours) {
+    static inactivity_room_t rooms[ROOMS];
+    person_t people[ROOMS];
+    memset(people, 0, sizeof(people));
+    rng_state = 4747;
+    for (int r = 0; r < ROOMS; r++) {
+        inactivity_room_init(&rooms[r]);
+        people[r].x_mm = 2000;
+        people[r].y_mm = 2000;
+    }
+    uint32_t alerts[INACTIVITY_LEVELS + 1] = { 0 }, cleared = 0;
+    uint64_t update_ns = 0, check_ns = 0, outputs = 0, checks = 0;
+    FusedData second[ROOMS * OUTPUTS_PER_S];
+    for (uint32_t s = 1; s <= hours * 3600u; s++) {
+        for (int k = 0; k < OUTPUTS_PER_S; k++) {
+            for (int r = 0; r < ROOMS; r++) {
+                second[k * ROOMS + r] = next_output(&people[r], r, s * 1000u + (uint32_t)k * STEP_MS);
+            }
+        }
+        uint64_t t0 = bench_now_ns();
+        for (int i = 0; i < ROOMS * OUTPUTS_PER_S; i++) {
+            const FusedData *d = &second[i];
+            uint16_t weight = inactivity_weight_pct(&cfg, 0, d->posture, -1);
+            cleared += inactivity_update(&cfg, &rooms[d->room], d, weight) != 0;
+        }
+        uint64_t t1 = bench_now_ns();
+        for (int r = 0; r < ROOMS; r++) {
+            alerts[inactivity_check(&cfg, &rooms[r], s * 1000u + 1000u)]++;
+        }
+        update_ns += t1 - t0;
+        check_ns += bench_now_ns() - t1;
+        outputs += ROOMS * OUTPUTS_PER_S;
+        checks += ROOMS;
+    }
+    printf("  streaming: %zu B per room, %.1f ns per output, %.1f ns per room check\n",
+           sizeof(inactivity_room_t), (double)update_ns / outputs, (double)check_ns / checks);
+    printf("             alerts level 1/2/3: %u/%u/%u, %u ended by motion\n", alerts[1], alerts[2], alerts[3],
+           cleared);
+}
+
+static void run_rescan(uint32_t hours, uint32_t window_s) {
+    static history_t hist[ROOMS];
+    person_t people[ROOMS];
+    memset(people, 0, sizeof(people));
+    rng_state = 4747;
+    uint32_t capacity = window_s * OUTPUTS_PER_S;
+    for (int r = 0; r < ROOMS; r++) {
+        hist[r].outputs = calloc(capacity, sizeof(FusedData));
+        hist[r].capacity = capacity;
+        hist[r].head = hist[r].count = 0;
+        people[r].x_mm = 2000;
+        people[r].y_mm = 2000;
+    }
+    uint64_t check_ns = 0, checks = 0;
+    for (uint32_t s = 1; s <= hours * 3600u; s++) {
+        for (int k = 0; k < OUTPUTS_PER_S; k++) {
+            for (int r = 0; r < ROOMS; r++) {
+                history_t *h = &hist[r];
+                h->outputs[h->head] = next_output(&people[r], r, s * 1000u + (uint32_t)k * STEP_MS);
+                h->head = (h->head + 1) % h->capacity;
+                h->count += h->count < h->capacity;
+            }
+        }
+        uint64_t t0 = bench_now_ns();
+        for (int r = 0; r < ROOMS; r++) {
+            sink += rescan_still_ms(&hist[r], s * 1000u + 1000u);
+        }
+        check_ns += bench_now_ns() - t0;
+        checks += ROOMS;
+    }
+    printf("  rescan %3u min: %8zu B per room, %.1f ns per room check\n", window_s / 60,
+           (size_t)capacity * sizeof(FusedData), (double)check_ns / checks);
+    for (int r = 0; r < ROOMS; r++) {
+        free(hist[r].outputs);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t hours = 6;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            hours = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n hours]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (hours == 0) {
+        hours = 1;
+    }
+    printf("CPUs: %ld, %d rooms, %d outputs/s each, %u h simulated\n\n", sysconf(_SC_NPROCESSORS_ONLN), ROOMS,
+           OUTPUTS_PER_S, hours);
+    run_streaming(hours);
+    run_rescan(hours, 30 * 60);
+    run_rescan(hours, 120 * 60);
+    return 0;
+}
@@ -0,0 +1,293 @@
+// Bytes per radar sample on the slave -> broker -> master MQTT path, MQTT 3.1.1
+// against MQTT 5 with a topic alias and the module id / sequence carried as user
+// properties (slave SLAVE_MQTT_PROTOCOL_V5). Each variant publishes QoS 1 like
+// the slave and is received by an MQTT 5 subscriber, which checks the resolved
+// topic and properties, so the numbers are for a working exchange, not just an
+// encoder. Without --broker the master's embedded broker (mqtt_broker.c, MQTT 5
+// capable) runs in-process as the local broker.
+//
+// Usage: bench_mqtt5_bytes [-n samples] [--broker host:port]
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "bench_common.h"
+#include "mqtt5_props.h"
+#include "mqtt_broker.h"
+#include "mqtt_lite.h"
+
+#define BENCH_PORT       18831
+#define BENCH_TOPIC      "home/room1/radar1"
+#define BENCH_MODULE_ID  1
+#define IPV4_TCP_HEADERS 40
+#define IDLE_TIMEOUT_MS  2000
+
+typedef enum {
+    VARIANT_V311 = 0,     // Current slave: 3.1.1, full topic, pretty-printed JSON with id_module
+    VARIANT_V5_TOPIC,     // MQTT 5, same packet content
+    VARIANT_V5_ALIAS,     // MQTT 5, topic alias after the first publish
+    VARIANT_V5_ALIAS_COMPACT, // MQTT 5, alias + compact JSON still carrying id_module, no sequence
+    VARIANT_V5_ALIAS_PROPS, // MQTT 5, alias + "m"/"s" user properties + compact JSON (slave V5 mode)
+    VARIANT_COUNT,
+} variant_t;
+
+static const char *const variant_names[VARIANT_COUNT] = {
+    "MQTT 3.1.1, full topic, JSON (current)",
+    "MQTT 5, full topic, JSON",
+    "MQTT 5, topic alias, JSON",
+    "MQTT 5, topic alias, compact JSON with id_module",
+    "MQTT 5, topic alias + user props, compact JSON",
+};
+
+typedef struct {
+    mqtt_lite_t *sub;
+    variant_t variant;
+    size_t expected;
+    size_t received;
+    size_t bad;           // Wrong topic or missing/incorrect properties
+    size_t delivered_bytes;
+} sub_ctx_t;
+
+typedef struct {
+    mqtt_broker_t broker;
+    atomic_bool stop;
+} broker_ctx_t;
+
+static void set_recv_timeout(int sock, int ms) {
+    struct timeval tv = { .tv_sec = ms / 1000, .tv_usec = (ms % 1000) * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static size_t packet_size(size_t remaining) {
+    uint8_t varint[4];
+    return 1 + mqtt_lite_encode_length(varint, (uint32_t)remaining) + remaining;
+}
+
+// Same layout as the slave's format_radar_json() (MQTT 3.1.1 mode)
+static int format_pretty(char *out, size_t cap, uint32_t timestamp) {
+    return snprintf(out, cap,
+                    "{\n"
+                    "  \"id_module\": %d,\n"
+                    "  \"timestamp\": %u,\n"
+                    "  \"distance_m\": %.2f,\n"
+                    "  \"posture\": \"%s\",\n"
+                    "  \"signal\": %d\n"
+                    "}",
+                    BENCH_MODULE_ID, timestamp, 2.5, "STANDING", 80);
+}
+
+// Same layout as the slave's format_radar_json_compact() (MQTT 5 mode)
+static int format_compact(char *out, size_t cap, uint32_t timestamp) {
+    return snprintf(out, cap, "{\"timestamp\":%u,\"distance_m\":%.2f,\"posture\":\"%s\",\"signal\":%d}",
+                    timestamp, 2.5, "STANDING", 80);
+}
+
+static int format_compact_with_id(char *out, size_t cap, uint32_t timestamp) {
+    return snprintf(out, cap,
+                    "{\"id_module\":%d,\"timestamp\":%u,\"distance_m\":%.2f,\"posture\":\"%s\",\"signal\":%d}",
+                    BENCH_MODULE_ID, timestamp, 2.5, "STANDING", 80);
+}
+
+static void *subscriber(void *arg) {
+    sub_ctx_t *ctx = arg;
+    uint8_t body[1024];
+    while (ctx->received < ctx->expected) {
+        uint8_t type, flags;
+        int len = mqtt_lite_read_packet(ctx->sub, &type, &flags, body, sizeof(body));
+        if (len < 0) {
+            break; // Idle timeout: the remaining samples were lost
+        }
+        if (type != MQTT_LITE_PUBLISH) {
+            continue;
+        }
+        ctx->delivered_bytes += packet_size((size_t)len);
+        char topic[64];
+        const uint8_t *props, *payload;
+        size_t props_len, payload_len;
+        if (mqtt_lite_parse_publish_v5(body, (size_t)len, flags, topic, sizeof(topic), &props, &props_len,
+                                       &payload, &payload_len, NULL) < 0 || strcmp(topic, BENCH_TOPIC) != 0) {
+            ctx->bad++;
+        } else if (ctx->variant == VARIANT_V5_ALIAS_PROPS) {
+            uint32_t module_id, sequence;
+            if (!mqtt5_props_find_user_u32(props, props_len, RADAR_PROP_MODULE_ID, &module_id) ||
+                !mqtt5_props_find_user_u32(props, props_len, RADAR_PROP_SEQUENCE, &sequence) ||
+                module_id != BENCH_MODULE_ID || sequence != ctx->received) {
+                ctx->bad++;
+            }
+        }
+        ctx->received++;
+    }
+    return NULL;
+}
+
+static bool run_variant(const char *host, uint16_t port, variant_t variant, size_t samples, size_t *baseline) {
+    mqtt_lite_t sub, pub;
+    if (mqtt_lite_connect_v5(&sub, host, port, "bench-master", 60) < 0) {
+        return false;
+    }
+    if (mqtt_lite_subscribe(&sub, "home/+/+", 0) < 0) {
+        mqtt_lite_close(&sub);
+        return false;
+    }
+    int rc = variant == VARIANT_V311 ? mqtt_lite_connect(&pub, host, port, "bench-slave", 60)
+                                     : mqtt_lite_connect_v5(&pub, host, port, "bench-slave", 60);
+    if (rc < 0) {
+        mqtt_lite_close(&sub);
+        return false;
+    }
+    bool use_alias = variant >= VARIANT_V5_ALIAS;
+    if (use_alias && pub.topic_alias_max == 0) {
+        printf("%s: broker does not allow topic aliases, skipped\n", variant_names[variant]);
+        mqtt_lite_close(&pub);
+        mqtt_lite_close(&sub);
+        return true;
+    }
+    set_recv_timeout(sub.sock, IDLE_TIMEOUT_MS);
+    set_recv_timeout(pub.sock, IDLE_TIMEOUT_MS);
+
+    sub_ctx_t ctx = { .sub = &sub, .variant = variant, .expected = samples };
+    pthread_t thread;
+    pthread_create(&thread, NULL, subscriber, &ctx);
+
+    size_t publish_bytes = 0, puback_bytes = 0, sent = 0;
+    for (size_t i = 0; i < samples; i++) {
+        char json[256];
+        uint32_t timestamp = (uint32_t)(100000 + i * 100);
+        int len;
+        if (variant == VARIANT_V5_ALIAS_PROPS) {
+            len = format_compact(json, sizeof(json), timestamp);
+        } else if (variant == VARIANT_V5_ALIAS_COMPACT) {
+            len = format_compact_with_id(json, sizeof(json), timestamp);
+        } else {
+            len = format_pretty(json, sizeof(json), timestamp);
+        }
+        int written;
+        if (variant == VARIANT_V311) {
+            written = mqtt_lite_publish(&pub, BENCH_TOPIC, json, (size_t)len, 1, NULL);
+        } else {
+            uint8_t props[64];
+            size_t props_len = 0;
+            if (variant == VARIANT_V5_ALIAS_PROPS) {
+                char id[4], seq[24];
+                snprintf(id, sizeof(id), "%d", BENCH_MODULE_ID);
+                snprintf(seq, sizeof(seq), "%zu", i);
+                props_len += mqtt_lite_put_user_property(props, RADAR_PROP_MODULE_ID, id);
+                props_len += mqtt_lite_put_user_property(props + props_len, RADAR_PROP_SEQUENCE, seq);
+            }
+            // Like the slave: the topic goes out once with the alias, then only the alias
+            const char *topic = (use_alias && i > 0) ? "" : BENCH_TOPIC;
+            written = mqtt_lite_publish_v5(&pub, topic, use_alias ? 1 : 0, props, props_len,
+                                           json, (size_t)len, 1, NULL);
+        }
+        if (written < 0) {
+            break;
+        }
+        uint8_t type, flags, ack[8];
+        int ack_len = mqtt_lite_read_packet(&pub, &type, &flags, ack, sizeof(ack));
+        if (ack_len < 0 || type != MQTT_LITE_PUBACK) {
+            break;
+        }
+        publish_bytes += (size_t)written;
+        puback_bytes += packet_size((size_t)ack_len);
+        sent++;
+    }
+    pthread_join(thread, NULL);
+
+    // Averages include the first publish of an alias run, which still carries the topic
+    size_t per_publish = sent ? publish_bytes / sent : 0;
+    size_t per_puback = sent ? puback_bytes / sent : 0;
+    size_t per_delivery = ctx.received ? ctx.delivered_bytes / ctx.received : 0;
+    // One segment per packet in the worst case (TCP_NODELAY, 1 sample per publish)
+    size_t uplink_ip = per_publish + per_puback + 2 * IPV4_TCP_HEADERS;
+    if (variant == VARIANT_V311) {
+        *baseline = per_publish;
+    }
+    printf("%s\n", variant_names[variant]);
+    printf("  sent=%zu delivered=%zu bad=%zu\n", sent, ctx.received, ctx.bad);
+    printf("  PUBLISH %zu B/sample (%+.1f%% vs 3.1.1), PUBACK %zu B, with IP/TCP headers %zu B\n",
+           per_publish, *baseline ? 100.0 * ((double)per_publish - (double)*baseline) / (double)*baseline : 0.0,
+           per_puback, uplink_ip);
+    printf("  broker -> MQTT 5 subscriber: %zu B/sample\n", per_delivery);
+
+    mqtt_lite_close(&pub);
+    mqtt_lite_close(&sub);
+    return sent == samples && ctx.received == samples && ctx.bad == 0;
+}
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(bench_now_ns() / 1000000ull);
+}
+
+static void *broker_thread(void *arg) {
+    broker_ctx_t *ctx = arg;
+    while (!atomic_load(&ctx->stop)) {
+        mqtt_broker_poll(&ctx->broker, 10, now_ms());
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    size_t samples = 2000;
+    const char *host = "127.0.0.1";
+    uint16_t port = BENCH_PORT;
+    bool external = false;
+    static char host_buf[64];
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            samples = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--broker") == 0 && i + 1 < argc) {
+            const char *arg = argv[++i];
+            const char *colon = strrchr(arg, ':');
+            size_t host_len = colon ? (size_t)(colon - arg) : strlen(arg);
+            if (host_len >= sizeof(host_buf)) {
+                fprintf(stderr, "host name too long\n");
+                return 2;
+            }
+            memcpy(host_buf, arg, host_len);
+            host_buf[host_len] = '\0';
+            host = host_buf;
+            port = colon ? (uint16_t)atoi(colon + 1) : 1883;
+            external = true;
+        } else {
+            fprintf(stderr, "usage: %s [-n samples] [--broker host:port]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static broker_ctx_t broker_ctx;
+    pthread_t thread;
+    if (!external) {
+        mqtt_broker_config_t cfg = { .port = port, .max_clients = MQTT_BROKER_MAX_CLIENTS };
+        if (mqtt_broker_start(&broker_ctx.broker, &cfg) < 0) {
+            perror("mqtt_broker_start");
+            return 1;
+        }
+        pthread_create(&thread, NULL, broker_thread, &broker_ctx);
+    }
+
+    printf("== Bytes per radar sample, QoS 1, %zu samples, broker %s:%u (%s) ==\n", samples, host, port,
+           external ? "external" : "embedded mqtt_broker.c");
+    size_t baseline = 0;
+    bool ok = true;
+    for (int v = 0; v < VARIANT_COUNT; v++) {
+        if (!run_variant(host, port, (variant_t)v, samples, &baseline)) {
+            printf("%s: FAILED\n", variant_names[v]);
+            ok = false;
+        }
+    }
+
+    if (!external) {
+        printf("broker: publishes_in=%u (v5 %u) alias_hits=%u protocol_errors=%u\n",
+               broker_ctx.broker.stats.publishes_in, broker_ctx.broker.stats.publishes_in_v5,
+               broker_ctx.broker.stats.alias_hits, broker_ctx.broker.stats.protocol_errors);
+        atomic_store(&broker_ctx.stop, true);
+        pthread_join(thread, NULL);
+        mqtt_broker_stop(&broker_ctx.broker);
+    }
+    return ok ? 0 : 1;
+}
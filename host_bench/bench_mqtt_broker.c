@@ -0,0 +1,269 @@
+// Capacity benchmark of the master's embedded MQTT broker (master_firmware/main/mqtt_broker.c)
+// built for the host. Measures:
+//   1. how many concurrent clients are accepted and the CONNECT round trip,
+//   2. ingest rate (PUBLISH -> on_publish callback, i.e. radar_data_queue) with
+//      1..N concurrent slave publishers, QoS 0 and QoS 1,
+//   3. fan-out rate to a subscriber (alert/monitoring clients).
+// Host numbers are an upper bound: on the ESP32 the lwIP stack and the 240 MHz core
+// dominate. --serve runs the broker alone so other harnesses (bench_udp_transport)
+// can use it as their MQTT broker.
+//
+// Usage: bench_mqtt_broker [-n msgs_per_publisher] [--serve port]
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "bench_common.h"
+#include "mqtt_broker.h"
+#include "mqtt_lite.h"
+
+#define BENCH_PORT 18830
+
+typedef struct {
+    mqtt_broker_t broker;
+    atomic_bool stop;
+    atomic_uint_fast64_t callbacks;
+    uint64_t last_callback_ns;
+    size_t parsed;
+} broker_ctx_t;
+
+static void on_publish(const mqtt_broker_message_t *msg, void *arg) {
+    broker_ctx_t *ctx = arg;
+    // Cost of what the master does per sample: locate the fields in the JSON
+    if (msg->payload_len > 0 && memchr(msg->payload, '}', msg->payload_len) != NULL) {
+        ctx->parsed++;
+    }
+    ctx->callbacks++;
+    ctx->last_callback_ns = bench_now_ns();
+}
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(bench_now_ns() / 1000000ull);
+}
+
+static void *broker_thread(void *arg) {
+    broker_ctx_t *ctx = arg;
+    while (!atomic_load(&ctx->stop)) {
+        mqtt_broker_poll(&ctx->broker, 10, now_ms());
+    }
+    return NULL;
+}
+
+static bool start_broker(broker_ctx_t *ctx, uint16_t port, uint8_t max_clients, pthread_t *thread) {
+    memset(ctx, 0, sizeof(*ctx));
+    mqtt_broker_config_t cfg = { .port = port, .max_clients = max_clients, .on_publish = on_publish, .ctx = ctx };
+    if (mqtt_broker_start(&ctx->broker, &cfg) < 0) {
+        perror("mqtt_broker_start");
+        return false;
+    }
+    pthread_create(thread, NULL, broker_thread, ctx);
+    return true;
+}
+
+static void stop_broker(broker_ctx_t *ctx, pthread_t thread) {
+    atomic_store(&ctx->stop, true);
+    pthread_join(thread, NULL);
+    mqtt_broker_stop(&ctx->broker);
+}
+
+// --- 1. Connection capacity ----------------------------------------------
+
+static void bench_connections(uint8_t max_clients) {
+    broker_ctx_t ctx;
+    pthread_t thread;
+    if (!start_broker(&ctx, BENCH_PORT, max_clients, &thread)) {
+        return;
+    }
+    mqtt_lite_t clients[MQTT_BROKER_MAX_CLIENTS + 4];
+    uint64_t connect_ns[MQTT_BROKER_MAX_CLIENTS + 4];
+    size_t accepted = 0;
+    for (size_t i = 0; i < sizeof(clients) / sizeof(clients[0]); i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "slave-%zu", i);
+        uint64_t t0 = bench_now_ns();
+        if (mqtt_lite_connect(&clients[accepted], "127.0.0.1", BENCH_PORT, id, 60) < 0) {
+            continue; // Refused: broker full
+        }
+        connect_ns[accepted++] = bench_now_ns() - t0;
+    }
+    bench_latency_t lat = bench_summarize(connect_ns, accepted);
+    printf("connections (max_clients=%u): %zu accepted, %u rejected, RAM %zu B/client (%zu B for the broker)\n",
+           max_clients, accepted, ctx.broker.stats.connections_rejected, sizeof(mqtt_broker_client_t),
+           sizeof(mqtt_broker_t) - (MQTT_BROKER_MAX_CLIENTS - max_clients) * sizeof(mqtt_broker_client_t));
+    bench_print_latency("CONNECT -> CONNACK", &lat);
+    for (size_t i = 0; i < accepted; i++) {
+        mqtt_lite_close(&clients[i]);
+    }
+    stop_broker(&ctx, thread);
+}
+
+// --- 2./3. Publish throughput -------------------------------------------
+
+typedef struct {
+    int index;
+    size_t messages;
+    uint8_t qos;
+    uint64_t *ack_ns; // QoS 1: PUBLISH -> PUBACK round trip per message
+    bool ok;
+} publisher_t;
+
+static void *publisher_thread(void *arg) {
+    publisher_t *p = arg;
+    mqtt_lite_t c;
+    char id[32];
+    snprintf(id, sizeof(id), "radar-%d", p->index);
+    if (mqtt_lite_connect(&c, "127.0.0.1", BENCH_PORT, id, 60) < 0) {
+        return NULL;
+    }
+    char topic[32];
+    snprintf(topic, sizeof(topic), "home/room%d/radar%d", p->index / 2 + 1, p->index % 2 + 1);
+    for (size_t i = 0; i < p->messages; i++) {
+        char json[160];
+        int len = snprintf(json, sizeof(json),
+                           "{\"module_id\":%d,\"timestamp\":%zu,\"distance\":%.2f,\"posture\":\"%s\",\"signal\":%d}",
+                           p->index + 1, i, 2.5, "STANDING", 80);
+        uint64_t t0 = bench_now_ns();
+        if (mqtt_lite_publish(&c, topic, json, (size_t)len, p->qos, NULL) < 0) {
+            break;
+        }
+        if (p->qos) {
+            uint8_t type, flags, buf[8];
+            if (mqtt_lite_read_packet(&c, &type, &flags, buf, sizeof(buf)) < 0 || type != MQTT_LITE_PUBACK) {
+                break;
+            }
+            p->ack_ns[i] = bench_now_ns() - t0;
+        }
+    }
+    p->ok = true;
+    mqtt_lite_close(&c);
+    return NULL;
+}
+
+typedef struct {
+    mqtt_lite_t c;
+    size_t received;
+} subscriber_t;
+
+static void *subscriber_thread(void *arg) {
+    subscriber_t *s = arg;
+    uint8_t body[512];
+    for (;;) {
+        uint8_t type, flags;
+        if (mqtt_lite_read_packet(&s->c, &type, &flags, body, sizeof(body)) < 0) {
+            break; // Receive timeout once the publishers are done
+        }
+        if (type == MQTT_LITE_PUBLISH) {
+            s->received++;
+        }
+    }
+    return NULL;
+}
+
+static void bench_publish(int publishers, size_t messages, uint8_t qos, bool with_subscriber) {
+    broker_ctx_t ctx;
+    pthread_t thread;
+    if (!start_broker(&ctx, BENCH_PORT, MQTT_BROKER_MAX_CLIENTS, &thread)) {
+        return;
+    }
+
+    subscriber_t sub = { 0 };
+    pthread_t sub_thread;
+    if (with_subscriber) {
+        if (mqtt_lite_connect(&sub.c, "127.0.0.1", BENCH_PORT, "monitor", 60) < 0 ||
+            mqtt_lite_subscribe(&sub.c, "home/#", 0) < 0) {
+            fprintf(stderr, "subscriber setup failed\n");
+            stop_broker(&ctx, thread);
+            return;
+        }
+        struct timeval tv = { .tv_sec = 1 };
+        setsockopt(sub.c.sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        pthread_create(&sub_thread, NULL, subscriber_thread, &sub);
+    }
+
+    publisher_t pubs[MQTT_BROKER_MAX_CLIENTS];
+    pthread_t threads[MQTT_BROKER_MAX_CLIENTS];
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < publishers; i++) {
+        pubs[i] = (publisher_t){ .index = i, .messages = messages, .qos = qos,
+                                 .ack_ns = qos ? calloc(messages, sizeof(uint64_t)) : NULL };
+        pthread_create(&threads[i], NULL, publisher_thread, &pubs[i]);
+    }
+    for (int i = 0; i < publishers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    // Let the broker drain what is still in the socket buffers
+    size_t expected = (size_t)publishers * messages;
+    uint64_t deadline = bench_now_ns() + 2000000000ull;
+    while (ctx.callbacks < expected && bench_now_ns() < deadline) {
+    }
+    if (with_subscriber) {
+        pthread_join(sub_thread, NULL);
+        mqtt_lite_close(&sub.c);
+    }
+    stop_broker(&ctx, thread);
+
+    double seconds = (ctx.last_callback_ns - start) / 1e9;
+    printf("publish qos%u, %d publisher(s)%s: %llu/%zu ingested, %.0f msg/s",
+           qos, publishers, with_subscriber ? " + 1 subscriber" : "",
+           (unsigned long long)ctx.callbacks, expected, seconds > 0 ? ctx.callbacks / seconds : 0.0);
+    if (with_subscriber) {
+        printf(", %zu delivered (%u dropped)", sub.received, ctx.broker.stats.deliveries_dropped);
+    }
+    printf("\n");
+    if (qos) {
+        uint64_t *all = calloc(expected, sizeof(uint64_t));
+        size_t n = 0;
+        for (int i = 0; i < publishers; i++) {
+            for (size_t m = 0; m < messages; m++) {
+                if (pubs[i].ack_ns[m]) all[n++] = pubs[i].ack_ns[m];
+            }
+            free(pubs[i].ack_ns);
+        }
+        bench_latency_t lat = bench_summarize(all, n);
+        bench_print_latency("PUBLISH -> PUBACK", &lat);
+        free(all);
+    }
+}
+
+static int serve(uint16_t port) {
+    broker_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    mqtt_broker_config_t cfg = { .port = port, .max_clients = MQTT_BROKER_MAX_CLIENTS, .on_publish = on_publish, .ctx = &ctx };
+    if (mqtt_broker_start(&ctx.broker, &cfg) < 0) {
+        perror("mqtt_broker_start");
+        return 1;
+    }
+    printf("embedded broker listening on port %u (Ctrl-C to stop)\n", port);
+    for (;;) {
+        mqtt_broker_poll(&ctx.broker, 1000, now_ms());
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t messages = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            messages = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            return serve((uint16_t)atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [-n msgs_per_publisher] [--serve port]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("== Embedded MQTT broker capacity (MQTT_BROKER_MAX_CLIENTS=%d) ==\n", MQTT_BROKER_MAX_CLIENTS);
+    bench_connections(8);
+    bench_connections(MQTT_BROKER_MAX_CLIENTS);
+    for (int p = 1; p <= MQTT_BROKER_MAX_CLIENTS / 2; p *= 2) {
+        bench_publish(p, messages, 0, false);
+    }
+    bench_publish(2, messages, 0, true);
+    bench_publish(2, messages / 10, 1, false);
+    return 0;
+}
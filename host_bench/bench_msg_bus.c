@@ -0,0 +1,232 @@
+// Fused stream with several consumers: reference-counted blocks on a bus
+// (msg_pool.c, msg_bus.c) vs one copying ring per consumer (spsc_ring.c of
+// the message itself, what FallDetector_task had alone).
+//
+//   1. RAM: ring slots, pool blocks and the batches held by the consumers,
+//      counted for the ESP32 (4-byte pointers), 1 to 4 consumers and three
+//      message sizes (FusedData, 128 and 512 bytes). The pool is sized so that
+//      nothing is dropped: one ring of distinct messages plus a batch in the
+//      hands of every consumer;
+//   2. CPU, one thread: publish one message, then every consumer pops, reads
+//      and (bus) releases it. ns per message published;
+//   3. three threads, one producer and two consumers: the producer waits for
+//      room instead of dropping; checks that every block comes back and that
+//      no consumer sees a block rewritten under it.
+//
+// Usage: bench_msg_bus [-n messages]
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "msg_bus.h"
+#include "msg_pool.h"
+#include "pipeline_msgs.h"
+
+#define RING_SIZE      16 // FUSED_RING_SIZE
+#define BATCH          8  // PIPELINE_BATCH
+#define MAX_CONSUMERS  4
+#define MAX_MSG_SIZE   512
+#define TARGET_PTR     4  // sizeof(void *) on the ESP32
+#define POOL_BLOCKS(consumers) (RING_SIZE + (consumers) * BATCH)
+
+static volatile uint32_t sink;
+
+static const size_t msg_sizes[] = { sizeof(FusedData), 128, MAX_MSG_SIZE };
+#define NUM_SIZES (sizeof(msg_sizes) / sizeof(msg_sizes[0]))
+
+static uint8_t copy_slots[MAX_CONSUMERS][RING_SIZE * MAX_MSG_SIZE];
+static void *ptr_slots[MAX_CONSUMERS][RING_SIZE];
+static uint64_t pool_storage[MSG_POOL_STORAGE_LEN(MAX_MSG_SIZE, POOL_BLOCKS(MAX_CONSUMERS)) / sizeof(uint64_t) + 1];
+
+static void print_ram(void) {
+    printf("RAM for one stream (bytes, ESP32 pointers; copy: rings + batches, bus: pool + pointer rings + batches)\n");
+    printf("  %-10s", "consumers");
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        printf("  %4zu B copy %8s", msg_sizes[s], "bus");
+    }
+    printf("\n");
+    for (int k = 1; k <= MAX_CONSUMERS; k++) {
+        printf("  %-10d", k);
+        for (size_t s = 0; s < NUM_SIZES; s++) {
+            size_t size = msg_sizes[s];
+            size_t copy = (size_t)k * (RING_SIZE + BATCH) * size;
+            size_t bus = MSG_POOL_STORAGE_LEN(size, POOL_BLOCKS(k)) + (size_t)k * (RING_SIZE + BATCH) * TARGET_PTR;
+            printf("  %11zu %8zu", copy, bus);
+        }
+        printf("\n");
+    }
+}
+
+// --- 2. CPU, one thread ---
+
+static double run_copy(int consumers, size_t size, uint32_t messages) {
+    spsc_ring_t rings[MAX_CONSUMERS];
+    for (int c = 0; c < consumers; c++) {
+        spsc_ring_init(&rings[c], copy_slots[c], size, RING_SIZE);
+    }
+    uint8_t msg[MAX_MSG_SIZE] = { 0 }, out[MAX_MSG_SIZE];
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < messages; i++) {
+        msg[0] = (uint8_t)i;
+        for (int c = 0; c < consumers; c++) {
+            spsc_ring_push(&rings[c], msg);
+        }
+        for (int c = 0; c < consumers; c++) {
+            spsc_ring_pop_batch(&rings[c], out, 1);
+            sink += out[0];
+        }
+    }
+    return (double)(bench_now_ns() - t0) / messages;
+}
+
+static double run_bus(int consumers, size_t size, uint32_t messages) {
+    msg_pool_t pool;
+    msg_pool_init(&pool, pool_storage, sizeof(pool_storage), size, POOL_BLOCKS(consumers));
+    spsc_ring_t rings[MAX_CONSUMERS];
+    msg_bus_t bus;
+    msg_bus_init(&bus, &pool);
+    for (int c = 0; c < consumers; c++) {
+        spsc_ring_init(&rings[c], ptr_slots[c], sizeof(void *), RING_SIZE);
+        msg_bus_subscribe(&bus, &rings[c], NULL, NULL);
+    }
+    uint8_t msg[MAX_MSG_SIZE] = { 0 };
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < messages; i++) {
+        msg[0] = (uint8_t)i;
+        uint8_t *block = msg_pool_alloc(&pool);
+        memcpy(block, msg, size); // The one copy: the producer fills the block
+        msg_bus_publish(&bus, block);
+        for (int c = 0; c < consumers; c++) {
+            uint8_t *got;
+            spsc_ring_pop_batch(&rings[c], &got, 1);
+            sink += got[0];
+            msg_pool_release(&pool, got);
+        }
+    }
+    return (double)(bench_now_ns() - t0) / messages;
+}
+
+// --- 3. Three threads ---
+
+typedef struct {
+    msg_pool_t pool;
+    msg_bus_t bus;
+    spsc_ring_t rings[2];
+    uint32_t messages;
+    atomic_uint received[2];
+    atomic_uint errors;
+} stress_t;
+
+typedef struct {
+    stress_t *st;
+    int index;
+} consumer_arg_t;
+
+static void *stress_consumer(void *arg) {
+    consumer_arg_t *ca = (consumer_arg_t *)arg;
+    stress_t *st = ca->st;
+    FusedData *batch[BATCH];
+    uint32_t expected = 0;
+    while (expected < st->messages) {
+        uint32_t n = spsc_ring_pop_batch(&st->rings[ca->index], batch, BATCH);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            // A block handed out twice would show another sequence or a torn copy
+            uint32_t ts = batch[i]->timestamp;
+            if (ts != expected || batch[i]->x_mm != (int16_t)ts || batch[i]->range_mm != (uint16_t)~ts) {
+                atomic_fetch_add(&st->errors, 1);
+            }
+            expected = ts + 1;
+            msg_pool_release(&st->pool, batch[i]);
+        }
+    }
+    atomic_store(&st->received[ca->index], expected);
+    return NULL;
+}
+
+static void run_stress(uint32_t messages) {
+    static stress_t st;
+    static void *slots[2][RING_SIZE];
+    static uint64_t storage[MSG_POOL_STORAGE_LEN(sizeof(FusedData), POOL_BLOCKS(2)) / sizeof(uint64_t)];
+    memset(&st, 0, sizeof(st));
+    st.messages = messages;
+    msg_pool_init(&st.pool, storage, sizeof(storage), sizeof(FusedData), POOL_BLOCKS(2));
+    msg_bus_init(&st.bus, &st.pool);
+    for (int c = 0; c < 2; c++) {
+        spsc_ring_init(&st.rings[c], slots[c], sizeof(void *), RING_SIZE);
+        msg_bus_subscribe(&st.bus, &st.rings[c], NULL, NULL);
+    }
+    pthread_t threads[2];
+    consumer_arg_t args[2] = { { &st, 0 }, { &st, 1 } };
+    uint64_t t0 = bench_now_ns();
+    for (int c = 0; c < 2; c++) {
+        pthread_create(&threads[c], NULL, stress_consumer, &args[c]);
+    }
+    for (uint32_t i = 0; i < messages; i++) {
+        FusedData *msg;
+        // Room in the pool and in both rings, so that nothing is dropped
+        while (spsc_ring_count(&st.rings[0]) == RING_SIZE || spsc_ring_count(&st.rings[1]) == RING_SIZE ||
+               (msg = msg_pool_alloc(&st.pool)) == NULL) {
+            sched_yield();
+        }
+        memset(msg, 0, sizeof(*msg));
+        msg->timestamp = i;
+        msg->x_mm = (int16_t)i;
+        msg->range_mm = (uint16_t)~i;
+        msg_bus_publish(&st.bus, msg);
+    }
+    for (int c = 0; c < 2; c++) {
+        pthread_join(threads[c], NULL);
+    }
+    double seconds = (double)(bench_now_ns() - t0) / 1e9;
+    msg_pool_stats_t ps;
+    msg_pool_get_stats(&st.pool, &ps);
+    printf("Producer + 2 consumer threads, %u FusedData: %.2f M messages/s, %u errors, "
+           "pool %u/%u in use at the end (peak %u), %u allocations refused while full\n",
+           messages, messages / seconds / 1e6, atomic_load(&st.errors), ps.in_use, ps.count, ps.peak, ps.exhausted);
+}
+
+int main(int argc, char **argv) {
+    uint32_t messages = 1000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            messages = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n messages]\n", argv[0]);
+            return 1;
+        }
+    }
+    printf("CPUs: %ld, ring %d slots, batches of %d\n\n", sysconf(_SC_NPROCESSORS_ONLN), RING_SIZE, BATCH);
+    print_ram();
+
+    printf("\nCPU, one thread (ns per message published, all consumers included)\n");
+    printf("  %-10s", "consumers");
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        printf("  %4zu B copy %8s", msg_sizes[s], "bus");
+    }
+    printf("\n");
+    for (int k = 1; k <= MAX_CONSUMERS; k++) {
+        printf("  %-10d", k);
+        for (size_t s = 0; s < NUM_SIZES; s++) {
+            double copy = run_copy(k, msg_sizes[s], messages);
+            double bus = run_bus(k, msg_sizes[s], messages);
+            printf("  %11.1f %8.1f", copy, bus);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    run_stress(messages);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Cost per fused set of the people tracker (multi_tracker.c) with 1 to 4
+// people and 2 to 8 sensors, and how well it keeps them apart.
+//
+// 4 x 4 m rooms, sensors on the walls, people walking at up to 1 m/s with
+// random turns and pauses, one fused set every 200 ms with 5 cm of range
+// noise. As on the LD2410, each sensor reports one moving and one static
+// target: with more people than that, every sensor sees its own pair of
+// them. Reports per configuration:
+//   - ns per step (mean over the run) and the p99 / max of individually
+//     timed steps: the association is exhaustive per sensor, so the worst
+//     case must stay close to the mean;
+//   - mean confirmed tracks vs people, births and ghosts (dropped tentative
+//     tracks) per minute, RMS error of the closest confirmed track.
+//
+// Usage: bench_multi_tracker [-n steps]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "multi_tracker.h"
+
+#define STEP_MS    200
+#define MAX_PEOPLE MTT_MAX_TRACKS
+
+static const trilat_bounds_t room_bounds = { 0.0f, 0.0f, 4.0f, 4.0f };
+
+// Wall positions, in the order sensors are added
+static const trilat_point_t wall_sensors[TRILAT_MAX_SENSORS] = {
+    { 0.0f, 0.0f }, { 4.0f, 0.0f }, { 4.0f, 4.0f }, { 0.0f, 4.0f },
+    { 2.0f, 0.0f }, { 4.0f, 2.0f }, { 2.0f, 4.0f }, { 0.0f, 2.0f },
+};
+
+typedef struct {
+    float x, y, vx, vy, tvx, tvy;
+} person_t;
+
+static uint32_t rng_state = 4242;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+static float rng_gauss(void) {
+    return sqrtf(-2.0f * logf(rng_uniform())) * cosf(6.2831853f * rng_uniform());
+}
+
+static void walk(person_t *p, float dt) {
+    bool near_wall = p->x < 0.5f || p->x > 3.5f || p->y < 0.5f || p->y > 3.5f;
+    if (near_wall || rng_uniform() < 0.04f) {
+        float speed = rng_uniform() < 0.3f ? 0.0f : 0.3f + 0.7f * rng_uniform();
+        float heading = near_wall ? atan2f(2.0f - p->y, 2.0f - p->x) + 0.8f * (rng_uniform() - 0.5f)
+                                  : 6.2831853f * rng_uniform();
+        p->tvx = speed * cosf(heading);
+        p->tvy = speed * sinf(heading);
+    }
+    float dvx = p->tvx - p->vx, dvy = p->tvy - p->vy, dv = hypotf(dvx, dvy);
+    float scale = dv > 1.5f * dt ? 1.5f * dt / dv : 1.0f;
+    p->vx += dvx * scale;
+    p->vy += dvy * scale;
+    p->x += p->vx * dt;
+    p->y += p->vy * dt;
+}
+
+static uint16_t range_mm(const person_t *p, int k) {
+    float r = hypotf(p->x - wall_sensors[k].x, p->y - wall_sensors[k].y) + 0.05f * rng_gauss();
+    return r <= 0.0f ? 1 : (uint16_t)(r * 1000.0f + 0.5f);
+}
+
+// Scans of a whole run, generated once per configuration (not timed)
+static void generate(mtt_scan_t *scans, person_t *truth, size_t steps, int people, int sensors) {
+    person_t p[MAX_PEOPLE];
+    for (int i = 0; i < people; i++) {
+        memset(&p[i], 0, sizeof(p[i]));
+        p[i].x = 0.8f + 2.4f * rng_uniform();
+        p[i].y = 0.8f + 2.4f * rng_uniform();
+    }
+    for (size_t s = 0; s < steps; s++) {
+        mtt_scan_t *scan = &scans[s];
+        mtt_scan_init(scan);
+        for (int i = 0; i < people; i++) {
+            walk(&p[i], STEP_MS / 1000.0f);
+            truth[s * MAX_PEOPLE + i] = p[i];
+        }
+        for (int k = 0; k < sensors; k++) {
+            const person_t *moving = &p[k % people], *still = &p[(k + 1) % people];
+            uint16_t m = range_mm(moving, k);
+            uint16_t st = people > 1 ? range_mm(still, k) : 0;
+            mtt_scan_add(scan, k, m, m, st, RADAR_POSTURE_MOVING, 80);
+        }
+    }
+}
+
+static volatile int sink;
+
+int main(int argc, char **argv) {
+    size_t steps = 100000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            steps = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    mtt_scan_t *scans = malloc(steps * sizeof(mtt_scan_t));
+    person_t *truth = malloc(steps * MAX_PEOPLE * sizeof(person_t));
+    uint64_t *step_ns = malloc(steps * sizeof(uint64_t));
+    static trilat_geometry_t g;
+    static mtt_room_t room;
+
+    printf("multi_tracker: %zu sets per configuration, %d ms period, range noise 5 cm, mtt_room_t is %zu B\n",
+           steps, STEP_MS, sizeof(mtt_room_t));
+    printf("  people sensors  ns/step  p99 ns  max ns  tracks  births/min  ghosts/min  rms err\n");
+    const int sensor_counts[] = { 2, 3, 4, 8 };
+    for (int people = 1; people <= MAX_PEOPLE; people++) {
+        for (size_t c = 0; c < sizeof(sensor_counts) / sizeof(sensor_counts[0]); c++) {
+            int sensors = sensor_counts[c];
+            generate(scans, truth, steps, people, sensors);
+            trilat_geometry_init(&g, &room_bounds, TRILAT_DEFAULT_RANGE_SIGMA_M);
+            for (int k = 0; k < sensors; k++) {
+                trilat_geometry_set_sensor(&g, k, wall_sensors[k].x, wall_sensors[k].y);
+            }
+
+            uint64_t best = UINT64_MAX;
+            for (int rep = 0; rep < 3; rep++) {
+                mtt_room_init(&room, KALMAN_DEFAULT_ACCEL_SIGMA);
+                uint64_t t0 = bench_now_ns();
+                for (size_t s = 0; s < steps; s++) {
+                    sink += mtt_room_step(&room, &g, (uint32_t)s * STEP_MS, &scans[s]);
+                }
+                uint64_t elapsed = bench_now_ns() - t0;
+                best = elapsed < best ? elapsed : best;
+            }
+
+            // Steps timed one by one, and accuracy
+            mtt_room_init(&room, KALMAN_DEFAULT_ACCEL_SIGMA);
+            double tracks = 0.0, err2 = 0.0;
+            size_t err_n = 0;
+            for (size_t s = 0; s < steps; s++) {
+                uint64_t t0 = bench_now_ns();
+                int confirmed = mtt_room_step(&room, &g, (uint32_t)s * STEP_MS, &scans[s]);
+                step_ns[s] = bench_now_ns() - t0;
+                tracks += confirmed;
+                for (int i = 0; i < people; i++) {
+                    const person_t *p = &truth[s * MAX_PEOPLE + i];
+                    float closest = INFINITY;
+                    for (int t = 0; t < MTT_MAX_TRACKS; t++) {
+                        const mtt_track_t *tr = &room.tracks[t];
+                        float d = hypotf(tr->kf.s[0] - p->x, tr->kf.s[1] - p->y);
+                        if (tr->id != 0 && tr->confirmed && d < closest) {
+                            closest = d;
+                        }
+                    }
+                    if (closest < 1.0f) { // Person tracked
+                        err2 += closest * closest;
+                        err_n++;
+                    }
+                }
+            }
+            bench_latency_t lat = bench_summarize(step_ns, steps);
+            double minutes = steps * STEP_MS / 60000.0;
+            printf("  %6d %7d  %7.0f  %6.0f  %6.0f  %6.2f  %10.1f  %10.1f  %4.0f mm\n", people, sensors,
+                   (double)best / (double)steps, lat.p99_us * 1000.0, lat.max_us * 1000.0, tracks / (double)steps,
+                   room.births / minutes, room.ghosts / minutes,
+                   err_n ? 1000.0 * sqrt(err2 / (double)err_n) : 0.0);
+        }
+    }
+    printf("  (each sensor reports 2 targets: with 3-4 people, 2 sensors cannot see everybody)\n");
+    free(scans);
+    free(truth);
+    free(step_ns);
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Queue item size and per-message CPU of the master pipeline
+// (radar_data_queue -> FusionEngine -> fusion_output_queue -> FallDetector),
+// string postures (before) vs enum postures and integer millimetres (pipeline_msgs.h).
+//
+// FreeRTOS queues copy each item in on send and out on receive; the simulated
+// queue below does the same two memcpy(). Per radar sample the run covers what
+// the tasks do besides logging: fill the RadarMessage, one radar_data_queue hop,
+// posture fusion and one fusion_output_queue hop every second sample (a pair of
+// sensors), and the FallDetector posture checks. JSON parsing is identical in
+// both versions and left out.
+//
+// Usage: bench_pipeline_msgs [-n samples]
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "pipeline_msgs.h"
+
+// Queue lengths of master_firmware/main/main.c
+#define RADAR_DATA_QUEUE_SIZE    10
+#define FUSION_OUTPUT_QUEUE_SIZE 10
+#define ALERT_QUEUE_SIZE         5
+
+// --- Message layouts before pipeline_msgs.h ---
+typedef struct {
+    int module_id;
+    uint32_t timestamp;
+    float distance_m;
+    char posture[16];
+    int signal;
+    bool has_sequence;
+    uint32_t sequence;
+} LegacyRadarMessage;
+
+typedef struct {
+    float x, y;
+    char final_posture[16];
+    uint32_t timestamp;
+} LegacyFusedData;
+
+typedef struct {
+    int type;
+    char description[64];
+    uint32_t alert_timestamp;
+} LegacyAlertMessage;
+
+// Minimal stand-in for a FreeRTOS queue: copy in, copy out.
+typedef struct {
+    uint8_t *storage;
+    size_t item_size, length, head;
+} sim_queue_t;
+
+static void sim_queue_init(sim_queue_t *q, size_t item_size, size_t length) {
+    q->storage = calloc(length, item_size);
+    q->item_size = item_size;
+    q->length = length;
+    q->head = 0;
+}
+
+static inline void sim_queue_hop(sim_queue_t *q, const void *in, void *out) {
+    uint8_t *slot = q->storage + q->head * q->item_size;
+    memcpy(slot, in, q->item_size);
+    memcpy(out, slot, q->item_size);
+    q->head = (q->head + 1) % q->length;
+}
+
+static volatile uint32_t sink;
+
+static uint64_t run_legacy(const radar_posture_t *postures, size_t samples) {
+    static const char *const names[RADAR_POSTURE_COUNT] = { "UNKNOWN", "STANDING", "SITTING", "LYING", "MOVING", "STILL" };
+    sim_queue_t radar_q, fusion_q;
+    sim_queue_init(&radar_q, sizeof(LegacyRadarMessage), RADAR_DATA_QUEUE_SIZE);
+    sim_queue_init(&fusion_q, sizeof(LegacyFusedData), FUSION_OUTPUT_QUEUE_SIZE);
+    LegacyRadarMessage sensor[2];
+    LegacyFusedData previous = { .final_posture = "STANDING" }, current;
+    uint32_t falls = 0;
+
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < samples; i++) {
+        LegacyRadarMessage msg;
+        msg.module_id = 1 + (int)(i & 1);
+        msg.timestamp = (uint32_t)i * 50;
+        msg.distance_m = 2.5f;
+        msg.signal = 80;
+        msg.has_sequence = false;
+        msg.sequence = (uint32_t)i;
+        strncpy(msg.posture, names[postures[i]], sizeof(msg.posture) - 1);
+        msg.posture[sizeof(msg.posture) - 1] = '\0';
+        sim_queue_hop(&radar_q, &msg, &sensor[i & 1]);
+        if ((i & 1) == 0) {
+            continue;
+        }
+
+        LegacyFusedData fused = { .x = 1.0f, .y = 1.5f, .timestamp = sensor[1].timestamp };
+        const char *p1 = sensor[0].posture, *p2 = sensor[1].posture;
+        if (strcmp(p1, "LYING") == 0 || strcmp(p2, "LYING") == 0) {
+            strcpy(fused.final_posture, "LYING");
+        } else if (strcmp(p1, "MOVING") == 0 || strcmp(p2, "MOVING") == 0) {
+            strcpy(fused.final_posture, "MOVING");
+        } else if (strcmp(p1, "SITTING") == 0 || strcmp(p2, "SITTING") == 0) {
+            strcpy(fused.final_posture, "SITTING");
+        } else if (strcmp(p1, "STANDING") == 0 || strcmp(p2, "STANDING") == 0) {
+            strcpy(fused.final_posture, "STANDING");
+        } else {
+            strcpy(fused.final_posture, "STILL");
+        }
+        sim_queue_hop(&fusion_q, &fused, &current);
+
+        bool was_upright_or_moving = strcmp(previous.final_posture, "STANDING") == 0 ||
+                                     strcmp(previous.final_posture, "SITTING") == 0 ||
+                                     strcmp(previous.final_posture, "MOVING") == 0 ||
+                                     strcmp(previous.final_posture, "STILL") == 0;
+        if (was_upright_or_moving && strcmp(current.final_posture, "LYING") == 0) {
+            falls++;
+        }
+        previous = current;
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+    sink = falls;
+    free(radar_q.storage);
+    free(fusion_q.storage);
+    return elapsed;
+}
+
+static uint64_t run_enum(const radar_posture_t *postures, size_t samples) {
+    sim_queue_t radar_q, fusion_q;
+    sim_queue_init(&radar_q, sizeof(RadarMessage), RADAR_DATA_QUEUE_SIZE);
+    sim_queue_init(&fusion_q, sizeof(FusedData), FUSION_OUTPUT_QUEUE_SIZE);
+    RadarMessage sensor[2];
+    FusedData previous = { .posture = RADAR_POSTURE_STANDING }, current;
+    uint32_t falls = 0;
+
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < samples; i++) {
+        RadarMessage msg = {
+            .timestamp = (uint32_t)i * 50,
+            .sequence = (uint32_t)i,
+            .distance_mm = pipeline_distance_mm(2.5f),
+            .module_id = (uint8_t)(1 + (i & 1)),
+            .posture = (uint8_t)postures[i],
+            .signal = 80,
+        };
+        sim_queue_hop(&radar_q, &msg, &sensor[i & 1]);
+        if ((i & 1) == 0) {
+            continue;
+        }
+
+        FusedData fused = {
+            .timestamp = sensor[1].timestamp,
+            .x_mm = pipeline_position_mm(1.0f),
+            .y_mm = pipeline_position_mm(1.5f),
+            .posture = (uint8_t)radar_posture_fuse((radar_posture_t)sensor[0].posture, (radar_posture_t)sensor[1].posture),
+        };
+        sim_queue_hop(&fusion_q, &fused, &current);
+
+        if (radar_posture_is_upright_or_moving((radar_posture_t)previous.posture) &&
+            current.posture == RADAR_POSTURE_LYING) {
+            falls++;
+        }
+        previous = current;
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+    sink = falls;
+    free(radar_q.storage);
+    free(fusion_q.storage);
+    return elapsed;
+}
+
+static void print_sizes(void) {
+    size_t legacy[3] = { sizeof(LegacyRadarMessage), sizeof(LegacyFusedData), sizeof(LegacyAlertMessage) };
+    size_t now[3] = { sizeof(RadarMessage), sizeof(FusedData), sizeof(AlertMessage) };
+    size_t lengths[3] = { RADAR_DATA_QUEUE_SIZE, FUSION_OUTPUT_QUEUE_SIZE, ALERT_QUEUE_SIZE };
+    const char *names[3] = { "radar_data_queue", "fusion_output_queue", "alert_queue" };
+    size_t legacy_total = 0, now_total = 0;
+
+    printf("Queue items (bytes) and queue storage (length x item, control block excluded)\n");
+    for (int i = 0; i < 3; i++) {
+        printf("  %-20s item %3zu -> %3zu   storage %4zu -> %4zu B\n", names[i], legacy[i], now[i],
+               legacy[i] * lengths[i], now[i] * lengths[i]);
+        legacy_total += legacy[i] * lengths[i];
+        now_total += now[i] * lengths[i];
+    }
+    printf("  %-20s                    total   %4zu -> %4zu B (-%.0f%%)\n", "", legacy_total, now_total,
+           100.0 * (double)(legacy_total - now_total) / (double)legacy_total);
+}
+
+int main(int argc, char **argv) {
+    size_t samples = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            samples = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    samples &= ~(size_t)1; // Whole sensor pairs
+
+    print_sizes();
+
+    // Realistic mix: mostly STANDING/SITTING/STILL, some MOVING, rare LYING
+    static const radar_posture_t mix[] = {
+        RADAR_POSTURE_STANDING, RADAR_POSTURE_STANDING, RADAR_POSTURE_SITTING, RADAR_POSTURE_SITTING,
+        RADAR_POSTURE_STILL, RADAR_POSTURE_STILL, RADAR_POSTURE_MOVING, RADAR_POSTURE_LYING,
+    };
+    radar_posture_t *postures = malloc(samples * sizeof(radar_posture_t));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        postures[i] = mix[(seed >> 16) % (sizeof(mix) / sizeof(mix[0]))];
+    }
+
+    // Warm up, then keep the best of 3 runs of each
+    run_legacy(postures, samples / 10);
+    run_enum(postures, samples / 10);
+    uint64_t legacy_ns = UINT64_MAX, enum_ns = UINT64_MAX;
+    for (int r = 0; r < 3; r++) {
+        uint64_t a = run_legacy(postures, samples), b = run_enum(postures, samples);
+        legacy_ns = a < legacy_ns ? a : legacy_ns;
+        enum_ns = b < enum_ns ? b : enum_ns;
+    }
+
+    printf("Per radar sample (%zu samples, queue copies + fusion + fall checks)\n", samples);
+    printf("  string postures  %6.2f ns\n", (double)legacy_ns / (double)samples);
+    printf("  enum postures    %6.2f ns (-%.0f%%)\n", (double)enum_ns / (double)samples,
+           100.0 * (double)(legacy_ns - enum_ns) / (double)legacy_ns);
+    free(postures);
+    return 0;
+}
@@ -0,0 +1,480 @@
+// End-to-end latency of the master pipeline under synthetic load, its tasks
+// on one core or split over two, with 1 or 2 room shards (main.c,
+// pipeline_shard.c).
+//
+// One thread per master task, pinned and prioritized like it (SCHED_FIFO,
+// FreeRTOS priorities: network 2, router and fusion 3, fall 4, HTTP server 5,
+// the ESP-IDF default):
+//   - network: paces the samples of R rooms x 2 modules at 20 Hz (one person
+//     walking per room) and burns what a sample costs on the network side
+//     (lwIP, MQTT, JSON parse; -w us of work) before queuing it;
+//   - HTTP: a status page every 500 ms (-p us of work);
+//   - router: room of the sample, then the queue of its shard, without waiting;
+//   - per shard, FusionEngine (posture classifier, fusion_engine_update(),
+//     people tracker on fused sets, under the shard lock) and FallDetector
+//     (motion features, fall rules).
+// Bounded queues (mutex + condition variable) stand in for the rings between
+// the tasks, with their sizes (bench_spsc_ring compares the two). Placement: everything on CPU 0 ("1 core"), or the
+// network side on CPU 0 and the shards where pipeline_shards_init() puts
+// them ("2 cores": CPU 1; "spread": both cores in turn). Two-core runs need
+// 2 CPUs and are skipped otherwise; without SCHED_FIFO (no privilege) the
+// threads share the CPUs under the default scheduler, which the report says.
+//
+// Reports per configuration the latency, from the arrival of a sample to the
+// end of its fusion and to the end of the fall rules of the outputs of its
+// fused set (p50, p99, max), and the samples dropped on full shard queues.
+// Host microseconds: on the ESP32 every stage costs more, so compare the
+// configurations, not the absolute values.
+//
+// Usage: bench_pipeline_shards [-n samples] [-r rooms] [-w network_us] [-p page_us]
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_common.h"
+#include "fall_features.h"
+#include "fall_rules.h"
+#include "fusion_engine.h"
+#include "multi_tracker.h"
+#include "pipeline_shard.h"
+#include "posture_nn.h"
+
+#define MODULES_PER_ROOM   2
+#define SAMPLE_INTERVAL_MS 50  // 20 Hz per module
+#define PAGE_INTERVAL_MS   500
+#define RADAR_QUEUE_SIZE   16  // RADAR_RING_SIZE, SHARD_RADAR_RING_SIZE
+#define OUTPUT_QUEUE_SIZE  16  // FUSED_RING_SIZE
+
+// FreeRTOS priorities of main.c, ESP-IDF httpd default
+enum { PRIO_NETWORK = 2, PRIO_FUSION = 3, PRIO_FALL = 4, PRIO_HTTP = 5 };
+
+static const trilat_bounds_t room_bounds = { 0.0f, 0.0f, 4.0f, 4.0f };
+static const trilat_point_t room_sensors[MODULES_PER_ROOM] = { { 0.0f, 0.0f }, { 4.0f, 0.0f } };
+
+static uint32_t rng_state = 2024;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+// --- Work and queues ---
+
+static double iterations_per_us;
+static volatile uint32_t sink;
+
+static void burn(double us) {
+    uint32_t x = sink;
+    for (uint64_t i = (uint64_t)(us * iterations_per_us); i > 0; i--) {
+        x = x * 1664525u + 1013904223u;
+    }
+    sink = x;
+}
+
+static void calibrate(void) {
+    iterations_per_us = 100.0;
+    uint64_t best = UINT64_MAX;
+    for (int rep = 0; rep < 3; rep++) {
+        uint64_t t0 = bench_now_ns();
+        burn(100000.0); // 1e7 iterations
+        uint64_t elapsed = bench_now_ns() - t0;
+        best = elapsed < best ? elapsed : best;
+    }
+    iterations_per_us = 1e7 / ((double)best / 1000.0);
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *items;
+    size_t item_size, capacity, head, count;
+    bool closed;
+} queue_t;
+
+static void queue_init(queue_t *q, size_t item_size, size_t capacity) {
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->items = malloc(item_size * capacity);
+    q->item_size = item_size;
+    q->capacity = capacity;
+}
+
+static void queue_free(queue_t *q) {
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+    free(q->items);
+}
+
+// Like xQueueSend: `wait` blocks while the queue is full, else fails at once
+static bool queue_push(queue_t *q, const void *item, bool wait) {
+    pthread_mutex_lock(&q->lock);
+    while (wait && q->count == q->capacity) {
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    bool ok = q->count < q->capacity;
+    if (ok) {
+        memcpy(q->items + ((q->head + q->count) % q->capacity) * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// Blocks for an item; false once the queue is closed and empty
+static bool queue_pop(queue_t *q, void *item) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    bool ok = q->count > 0;
+    if (ok) {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+static void queue_close(queue_t *q) {
+    pthread_mutex_lock(&q->lock);
+    q->closed = true;
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// --- Pipeline state (main.c) ---
+
+typedef struct {
+    RadarMessage msg;
+    uint64_t arrival_ns;
+} sample_item_t;
+
+typedef struct {
+    FusedData data;
+    uint64_t arrival_ns; // Of the sample that completed the fused set
+} output_item_t;
+
+typedef struct {
+    fsm_instance_t fsm;
+    fall_features_t features;
+} person_state_t;
+
+typedef struct {
+    int index;
+    queue_t samples, outputs;
+    pthread_mutex_t rooms_lock;
+    posture_nn_t nn;
+    uint64_t *fusion_ns, *fall_ns; // Latencies, written by the shard's threads only
+    size_t fusion_count, fall_count;
+} shard_t;
+
+typedef struct {
+    size_t samples;
+    int rooms;
+    double network_us, page_us;
+} load_t;
+
+static fusion_engine_t engine;
+static trilat_geometry_t geometry[FUSION_MAX_ROOMS];
+static mtt_room_t people[FUSION_MAX_ROOMS];
+static person_state_t fall_state[FUSION_MAX_ROOMS][MTT_MAX_TRACKS + 1];
+static pipeline_shards_t plan;
+static shard_t shards[PIPELINE_MAX_SHARDS];
+static queue_t radar_queue;
+static const load_t *load;
+static volatile bool network_done;
+static bool use_fifo;
+
+static void *router_thread(void *arg) {
+    (void)arg;
+    sample_item_t item;
+    while (queue_pop(&radar_queue, &item)) {
+        int room = fusion_engine_room_of(&engine, item.msg.module_id);
+        if (room < 0) {
+            continue;
+        }
+        int s = pipeline_shard_of_room(&plan, room);
+        pipeline_shard_note(&plan, s, queue_push(&shards[s].samples, &item, false));
+    }
+    for (int s = 0; s < plan.shard_count; s++) {
+        queue_close(&shards[s].samples);
+    }
+    return NULL;
+}
+
+static void *fusion_thread(void *arg) {
+    shard_t *shard = arg;
+    sample_item_t item;
+    fusion_set_t set;
+    while (queue_pop(&shard->samples, &item)) {
+        pthread_mutex_lock(&shard->rooms_lock);
+        RadarMessage *msg = &item.msg;
+        int8_t features[POSTURE_NN_FEATURES];
+        uint8_t pct[RADAR_POSTURE_COUNT];
+        posture_nn_features(msg, fusion_engine_history(&engine, msg->module_id, 0),
+                            fusion_engine_history(&engine, msg->module_id, FUSION_HISTORY_LEN - 1), features);
+        msg->posture = (uint8_t)posture_nn_classify(&shard->nn, features, pct);
+        if (fusion_engine_update(&engine, msg, msg->timestamp, &set) == FUSION_FUSED) {
+            mtt_scan_t scan;
+            mtt_scan_init(&scan);
+            int n = 0;
+            for (uint8_t mask = set.slot_mask; mask; mask &= (uint8_t)(mask - 1)) {
+                const fusion_reading_t *r = &set.readings[n++];
+                mtt_scan_add(&scan, __builtin_ctz(mask), r->distance_mm, r->moving_mm, r->static_mm,
+                             (radar_posture_t)r->posture, r->signal);
+            }
+            mtt_room_step(&people[set.room], &geometry[set.room], set.timestamp, &scan);
+            output_item_t out = { .arrival_ns = item.arrival_ns };
+            out.data.room = set.room;
+            out.data.timestamp = set.timestamp;
+            out.data.posture = (uint8_t)set.posture;
+            memcpy(out.data.posture_pct, set.posture_pct, sizeof(out.data.posture_pct));
+            out.data.track_id = FUSED_TRACK_NONE;
+            for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+                const mtt_track_t *t = &people[set.room].tracks[i];
+                if (t->id != 0 && t->confirmed) {
+                    out.data.track_id = t->id;
+                    out.data.x_mm = pipeline_position_mm(t->kf.s[0]);
+                    out.data.y_mm = pipeline_position_mm(t->kf.s[1]);
+                    queue_push(&shard->outputs, &out, true);
+                }
+            }
+            if (out.data.track_id == FUSED_TRACK_NONE) {
+                queue_push(&shard->outputs, &out, true);
+            }
+        }
+        pthread_mutex_unlock(&shard->rooms_lock);
+        shard->fusion_ns[shard->fusion_count++] = bench_now_ns() - item.arrival_ns;
+    }
+    queue_close(&shard->outputs);
+    return NULL;
+}
+
+static void *fall_thread(void *arg) {
+    shard_t *shard = arg;
+    const fsm_table_t *rules = fall_rules_table();
+    output_item_t item;
+    while (queue_pop(&shard->outputs, &item)) {
+        person_state_t *st = &fall_state[item.data.room][item.data.track_id % (MTT_MAX_TRACKS + 1)];
+        if (!st->fsm.has_event) {
+            fsm_instance_init(&st->fsm, FALL_STATE_WATCHING, item.data.timestamp);
+            fall_features_init(&st->features);
+        }
+        fall_feature_values_t values;
+        fall_features_add(&st->features, &item.data);
+        fall_features_get(&st->features, item.data.timestamp, &values);
+        fsm_event_t event = fall_event_from(&item.data, &values, ZONE_FALL_NORMAL);
+        sink += fsm_dispatch(rules, &st->fsm, &event);
+        shard->fall_ns[shard->fall_count++] = bench_now_ns() - item.arrival_ns;
+    }
+    return NULL;
+}
+
+static void sleep_until(uint64_t t_ns) {
+    struct timespec ts = { .tv_sec = (time_t)(t_ns / 1000000000ull), .tv_nsec = (long)(t_ns % 1000000000ull) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+// One person walking per room; each module reports its range to it
+static void *network_thread(void *arg) {
+    (void)arg;
+    float x[FUSION_MAX_ROOMS], y[FUSION_MAX_ROOMS], vx[FUSION_MAX_ROOMS] = { 0 }, vy[FUSION_MAX_ROOMS] = { 0 };
+    for (int r = 0; r < load->rooms; r++) {
+        x[r] = 1.0f + 2.0f * rng_uniform();
+        y[r] = 1.0f + 2.0f * rng_uniform();
+    }
+    int modules = load->rooms * MODULES_PER_ROOM;
+    uint64_t period_ns = SAMPLE_INTERVAL_MS * 1000000ull / (uint64_t)modules, start = bench_now_ns();
+    for (size_t i = 0; i < load->samples; i++) {
+        uint64_t arrival = start + i * period_ns;
+        sleep_until(arrival);
+        int m = (int)(i % (size_t)modules), r = m / MODULES_PER_ROOM, k = m % MODULES_PER_ROOM;
+        if (k == 0) {
+            if (rng_uniform() < 0.05f) {
+                vx[r] = rng_uniform() - 0.5f;
+                vy[r] = rng_uniform() - 0.5f;
+            }
+            x[r] = fminf(fmaxf(x[r] + vx[r] * SAMPLE_INTERVAL_MS / 1000.0f, 0.3f), 3.7f);
+            y[r] = fminf(fmaxf(y[r] + vy[r] * SAMPLE_INTERVAL_MS / 1000.0f, 0.3f), 3.7f);
+        }
+        uint16_t range = (uint16_t)(1000.0f * hypotf(x[r] - room_sensors[k].x, y[r] - room_sensors[k].y));
+        sample_item_t item = { .arrival_ns = arrival };
+        item.msg = (RadarMessage){ .module_id = (uint8_t)(m + 1), .distance_mm = range, .moving_mm = range,
+                                   .static_mm = range, .signal = 60, .flags = RADAR_MSG_HAS_TARGETS,
+                                   .timestamp = (uint32_t)((arrival - start) / 1000000ull) };
+        burn(load->network_us);
+        queue_push(&radar_queue, &item, true);
+    }
+    network_done = true;
+    queue_close(&radar_queue);
+    return NULL;
+}
+
+static void *http_thread(void *arg) {
+    (void)arg;
+    for (uint64_t next = bench_now_ns(); !network_done; next += PAGE_INTERVAL_MS * 1000000ull) {
+        sleep_until(next);
+        burn(load->page_us);
+    }
+    return NULL;
+}
+
+static void start(pthread_t *thread, void *(*fn)(void *), void *arg, int cpu, int priority) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    if (use_fifo) {
+        struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + priority };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    if (pthread_create(thread, &attr, fn, arg) != 0) {
+        fprintf(stderr, "pthread_create failed\n");
+        exit(1);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+static void run(const char *name, int shard_count, int cores, int shard_cores, const posture_nn_t *nn) {
+    pipeline_shards_init(&plan, shard_count, cores, 0, shard_cores);
+    fusion_engine_init(&engine, 500, MODULES_PER_ROOM);
+    for (int r = 0; r < load->rooms; r++) {
+        char room_name[FUSION_ROOM_NAME_LEN];
+        snprintf(room_name, sizeof(room_name), "room%d", r);
+        trilat_geometry_init(&geometry[r], &room_bounds, TRILAT_DEFAULT_RANGE_SIGMA_M);
+        for (int k = 0; k < MODULES_PER_ROOM; k++) {
+            fusion_engine_assign(&engine, r * MODULES_PER_ROOM + k + 1, room_name);
+            trilat_geometry_set_sensor(&geometry[r], k, room_sensors[k].x, room_sensors[k].y);
+        }
+        mtt_room_init(&people[r], KALMAN_DEFAULT_ACCEL_SIGMA);
+    }
+    memset(fall_state, 0, sizeof(fall_state));
+    queue_init(&radar_queue, sizeof(sample_item_t), RADAR_QUEUE_SIZE);
+    for (int s = 0; s < plan.shard_count; s++) {
+        shard_t *shard = &shards[s];
+        shard->index = s;
+        queue_init(&shard->samples, sizeof(sample_item_t), RADAR_QUEUE_SIZE);
+        queue_init(&shard->outputs, sizeof(output_item_t), OUTPUT_QUEUE_SIZE);
+        pthread_mutex_init(&shard->rooms_lock, NULL);
+        shard->nn = *nn;
+        shard->fusion_ns = malloc(load->samples * sizeof(uint64_t));
+        shard->fall_ns = malloc(load->samples * MTT_MAX_TRACKS * sizeof(uint64_t));
+        shard->fusion_count = shard->fall_count = 0;
+    }
+    network_done = false;
+
+    pthread_t network, http, router, fusion[PIPELINE_MAX_SHARDS], fall[PIPELINE_MAX_SHARDS];
+    for (int s = 0; s < plan.shard_count; s++) {
+        start(&fall[s], fall_thread, &shards[s], plan.core[s], PRIO_FALL);
+        start(&fusion[s], fusion_thread, &shards[s], plan.core[s], PRIO_FUSION);
+    }
+    start(&router, router_thread, NULL, 0, PRIO_FUSION);
+    start(&http, http_thread, NULL, 0, PRIO_HTTP);
+    start(&network, network_thread, NULL, 0, PRIO_NETWORK);
+    pthread_join(network, NULL);
+    pthread_join(http, NULL);
+    pthread_join(router, NULL);
+
+    size_t fusion_total = 0, fall_total = 0;
+    uint64_t *fusion_all = malloc(load->samples * sizeof(uint64_t));
+    uint64_t *fall_all = malloc(load->samples * MTT_MAX_TRACKS * sizeof(uint64_t));
+    uint32_t dropped = 0;
+    for (int s = 0; s < plan.shard_count; s++) {
+        pthread_join(fusion[s], NULL);
+        pthread_join(fall[s], NULL);
+        memcpy(fusion_all + fusion_total, shards[s].fusion_ns, shards[s].fusion_count * sizeof(uint64_t));
+        memcpy(fall_all + fall_total, shards[s].fall_ns, shards[s].fall_count * sizeof(uint64_t));
+        fusion_total += shards[s].fusion_count;
+        fall_total += shards[s].fall_count;
+        dropped += plan.dropped[s];
+        queue_free(&shards[s].samples);
+        queue_free(&shards[s].outputs);
+        pthread_mutex_destroy(&shards[s].rooms_lock);
+        free(shards[s].fusion_ns);
+        free(shards[s].fall_ns);
+    }
+    queue_free(&radar_queue);
+
+    char label[64];
+    bench_latency_t fusion_latency = bench_summarize(fusion_all, fusion_total);
+    bench_latency_t fall_latency = bench_summarize(fall_all, fall_total);
+    printf("%s, %d shard%s (cores", name, plan.shard_count, plan.shard_count > 1 ? "s" : "");
+    for (int s = 0; s < plan.shard_count; s++) {
+        printf(" %u", plan.core[s]);
+    }
+    printf("), %u dropped\n", dropped);
+    snprintf(label, sizeof(label), "sample -> fused");
+    bench_print_latency(label, &fusion_latency);
+    snprintf(label, sizeof(label), "sample -> fall rules");
+    bench_print_latency(label, &fall_latency);
+    free(fusion_all);
+    free(fall_all);
+}
+
+int main(int argc, char **argv) {
+    load_t l = { .samples = 4000, .rooms = 8, .network_us = 300.0, .page_us = 20000.0 };
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) {
+            l.samples = strtoull(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "-r") == 0) {
+            l.rooms = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-w") == 0) {
+            l.network_us = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "-p") == 0) {
+            l.page_us = atof(argv[i + 1]);
+        }
+    }
+    l.rooms = l.rooms < 1 ? 1 : l.rooms > FUSION_MAX_ROOMS ? FUSION_MAX_ROOMS : l.rooms;
+    load = &l;
+
+    posture_nn_t nn;
+    if (posture_nn_load(&nn, posture_nn_default_model, posture_nn_default_model_len) != POSTURE_NN_OK) {
+        fprintf(stderr, "default posture model rejected\n");
+        return 1;
+    }
+    if (!fall_rules_init()) { // As app_main: before the fall threads share it
+        fprintf(stderr, "fall rule table rejected\n");
+        return 1;
+    }
+    cpu_set_t cpus;
+    sched_getaffinity(0, sizeof(cpus), &cpus);
+    int cpu_count = CPU_COUNT(&cpus);
+    struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) };
+    use_fifo = sched_setscheduler(0, SCHED_FIFO, &param) == 0;
+    if (use_fifo) {
+        param.sched_priority = 0;
+        sched_setscheduler(0, SCHED_OTHER, &param);
+    }
+    calibrate();
+
+    double rate = l.rooms * MODULES_PER_ROOM * 1000.0 / SAMPLE_INTERVAL_MS;
+    printf("pipeline shards: %zu samples, %d rooms x %d modules at %d Hz (%.0f samples/s), %.0f us of network work per "
+           "sample, %.0f us status page every %d ms; CPUs: %d, %s\n",
+           l.samples, l.rooms, MODULES_PER_ROOM, 1000 / SAMPLE_INTERVAL_MS, rate, l.network_us, l.page_us,
+           PAGE_INTERVAL_MS, cpu_count, use_fifo ? "SCHED_FIFO priorities" : "default scheduler (no SCHED_FIFO)");
+    run("1 core", 1, 1, 1, &nn);
+    run("1 core", 2, 1, 1, &nn);
+    if (cpu_count < 2) {
+        printf("2 cores: skipped, a single CPU available\n");
+        return 0;
+    }
+    run("2 cores", 1, 2, 1, &nn);
+    run("2 cores", 2, 2, 1, &nn);
+    run("2 cores spread", 2, 2, 2, &nn);
+    return 0;
+}
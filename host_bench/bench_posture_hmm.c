@@ -0,0 +1,175 @@
+// Cost per fused set of the posture filter (posture_hmm.c) with 1 to 4
+// sensors, and what it buys over the former priority rule
+// (radar_posture_fuse(): LYING > MOVING > SITTING > STANDING).
+//
+// One person, one fused set every 100 ms. The person stands, walks, sits
+// and, now and then, falls and lies for 10 to 60 s before getting up. Each
+// sensor has its own signal (40..90) and range (1..6 m): it reports the true
+// posture with a probability that grows with both, otherwise a random one
+// (not the confusion matrix the filter assumes), plus isolated LYING
+// glitches (2 % of the frames). Reports per sensor count:
+//   - ns per set (votes + filter step);
+//   - sets with a wrong posture, for the priority rule and the filter;
+//   - false LYING transitions per hour: output going from an upright posture
+//     to LYING while the person is not lying (each arms the fall detector);
+//   - falls reported, and the mean delay to LYING in sets.
+//
+// Usage: bench_posture_hmm [-n sets]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "posture_hmm.h"
+
+#define STEP_MS     100
+#define MAX_SENSORS 4
+#define GLITCH_RATE 0.02f
+
+typedef struct {
+    uint8_t truth;
+    uint8_t reported[MAX_SENSORS];
+    float weight[MAX_SENSORS];
+} set_t;
+
+static uint32_t rng_state = 3131;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+static radar_posture_t random_posture(void) {
+    return (radar_posture_t)(RADAR_POSTURE_STANDING + (int)(rng_uniform() * (RADAR_POSTURE_COUNT - 1)) % (RADAR_POSTURE_COUNT - 1));
+}
+
+// Posture script: segments of 3 to 20 s, a fall once every ~10 segments
+static void generate(set_t *sets, size_t count, int sensors) {
+    radar_posture_t posture = RADAR_POSTURE_STANDING;
+    size_t left = 0;
+    uint8_t signal[MAX_SENSORS];
+    uint16_t range_mm[MAX_SENSORS];
+    for (size_t i = 0; i < count; i++) {
+        if (left == 0) {
+            if (posture == RADAR_POSTURE_LYING) {
+                posture = RADAR_POSTURE_SITTING; // Getting up
+            } else if (posture != RADAR_POSTURE_SITTING && rng_uniform() < 0.1f) {
+                posture = RADAR_POSTURE_LYING;   // Fall
+            } else {
+                static const radar_posture_t daily[] = { RADAR_POSTURE_STANDING, RADAR_POSTURE_MOVING,
+                                                         RADAR_POSTURE_SITTING, RADAR_POSTURE_STILL };
+                posture = daily[(int)(rng_uniform() * 4) % 4];
+            }
+            float seconds = posture == RADAR_POSTURE_LYING ? 10.0f + 50.0f * rng_uniform() : 3.0f + 17.0f * rng_uniform();
+            left = (size_t)(seconds * 1000 / STEP_MS);
+            for (int k = 0; k < sensors; k++) { // The person moved: new geometry
+                signal[k] = (uint8_t)(40 + 50 * rng_uniform());
+                range_mm[k] = (uint16_t)(1000 + 5000 * rng_uniform());
+            }
+        }
+        left--;
+        set_t *s = &sets[i];
+        s->truth = (uint8_t)posture;
+        for (int k = 0; k < sensors; k++) {
+            s->weight[k] = posture_vote_weight(signal[k], range_mm[k]);
+            float correct = 0.5f + 0.45f * s->weight[k];
+            s->reported[k] = (uint8_t)(rng_uniform() < correct ? posture : random_posture());
+            if (rng_uniform() < GLITCH_RATE) {
+                s->reported[k] = RADAR_POSTURE_LYING;
+            }
+        }
+    }
+}
+
+typedef struct {
+    size_t wrong, false_falls, falls, reported_falls, delay_sets;
+} score_t;
+
+// Scores an output sequence: errors, false LYING transitions, fall delays
+static void score(score_t *sc, const set_t *s, radar_posture_t out, radar_posture_t *prev, long *fall_start, size_t i) {
+    bool truth_lying = s->truth == RADAR_POSTURE_LYING;
+    sc->wrong += out != s->truth;
+    if (truth_lying && *fall_start == -1) {
+        *fall_start = (long)i;
+        sc->falls++;
+    } else if (!truth_lying) {
+        *fall_start = -1;
+    }
+    if (out == RADAR_POSTURE_LYING && radar_posture_is_upright_or_moving(*prev)) {
+        if (!truth_lying) {
+            sc->false_falls++;
+        } else if (*fall_start >= 0) {
+            sc->reported_falls++;
+            sc->delay_sets += i - (size_t)*fall_start;
+            *fall_start = -2; // Counted once
+        }
+    }
+    *prev = out;
+}
+
+static volatile int sink;
+
+int main(int argc, char **argv) {
+    size_t count = 2000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    set_t *sets = malloc(count * sizeof(set_t));
+    double hours = count * STEP_MS / 3600000.0;
+
+    printf("posture_hmm: %zu sets (%.0f h at %d ms), %.0f %% LYING glitches per sensor, posture_hmm_t is %zu B\n",
+           count, hours, STEP_MS, GLITCH_RATE * 100, sizeof(posture_hmm_t));
+    printf("  sensors  ns/set   wrong sets      false LYING/h      falls reported    delay (sets)\n");
+    printf("                    prio    hmm     prio     hmm       prio     hmm       prio   hmm\n");
+    for (int sensors = 1; sensors <= MAX_SENSORS; sensors++) {
+        rng_state = 3131;
+        generate(sets, count, sensors);
+
+        uint64_t best = UINT64_MAX;
+        for (int rep = 0; rep < 3; rep++) {
+            posture_hmm_t hmm;
+            posture_hmm_init(&hmm);
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < count; i++) {
+                posture_votes_t votes;
+                posture_votes_init(&votes);
+                for (int k = 0; k < sensors; k++) {
+                    posture_votes_add(&votes, (radar_posture_t)sets[i].reported[k], sets[i].weight[k]);
+                }
+                sink += posture_hmm_step(&hmm, &votes);
+            }
+            uint64_t elapsed = bench_now_ns() - t0;
+            best = elapsed < best ? elapsed : best;
+        }
+
+        // Accuracy (not timed)
+        score_t prio = { 0 }, filt = { 0 };
+        radar_posture_t prev_prio = RADAR_POSTURE_STANDING, prev_filt = RADAR_POSTURE_STANDING;
+        long start_prio = -1, start_filt = -1;
+        posture_hmm_t hmm;
+        posture_hmm_init(&hmm);
+        for (size_t i = 0; i < count; i++) {
+            const set_t *s = &sets[i];
+            radar_posture_t fused = RADAR_POSTURE_UNKNOWN;
+            posture_votes_t votes;
+            posture_votes_init(&votes);
+            for (int k = 0; k < sensors; k++) {
+                fused = radar_posture_fuse(fused, (radar_posture_t)s->reported[k]);
+                posture_votes_add(&votes, (radar_posture_t)s->reported[k], s->weight[k]);
+            }
+            score(&prio, s, fused, &prev_prio, &start_prio, i);
+            score(&filt, s, posture_hmm_step(&hmm, &votes), &prev_filt, &start_filt, i);
+        }
+        printf("  %7d  %6.0f   %4.1f %%  %4.1f %%   %7.0f  %6.1f     %4zu/%-4zu %4zu      %4.1f  %4.1f\n", sensors,
+               (double)best / (double)count, 100.0 * prio.wrong / count, 100.0 * filt.wrong / count,
+               prio.false_falls / hours, filt.false_falls / hours, prio.reported_falls, prio.falls, filt.reported_falls,
+               prio.reported_falls ? (double)prio.delay_sets / prio.reported_falls : 0.0,
+               filt.reported_falls ? (double)filt.delay_sets / filt.reported_falls : 0.0);
+    }
+    free(sets);
+    return 0;
+}
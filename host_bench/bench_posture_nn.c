@@ -0,0 +1,217 @@
+// Cost per inference of the master posture classifier (posture_nn.c) and
+// its RAM and flash footprint, against a float reference over the same
+// weights: the network without activation quantization (each layer output
+// kept as a float, ReLU, no rounding nor saturation). The host vectorizes
+// both; the master's ESP32 (Xtensa LX6) has no SIMD, a single-precision
+// FPU only, and runs the engine's unrolled kernel (POSTURE_NN_UNROLL), so
+// measure there with the boot self-benchmark.
+//
+// Networks: the compiled-in default model (posture_nn_model.c) and random
+// 14-W-5 and 14-W-W-5 networks with W up to POSTURE_NN_MAX_WIDTH. Inputs:
+// feature vectors of random LD2410-like samples (posture_nn_features()).
+// Reports per network:
+//   - blob bytes (flash);
+//   - ns per inference: engine, engine + softmax, float;
+//   - decisions agreeing with the float reference.
+// RAM is sizeof(posture_nn_t) whatever the network (static arena).
+//
+// Usage: bench_posture_nn [-n inferences]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "posture_nn.h"
+
+static uint32_t rng_state = 1414;
+
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static int32_t rng_range(int32_t lo, int32_t hi) {
+    return lo + (int32_t)(rng_next() % (uint32_t)(hi - lo + 1));
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    memcpy(p, &v, 4); // Little-endian host
+}
+
+// Random network with the given widths (features first, classes last)
+static size_t build_blob(uint8_t *blob, const int *widths, int layer_count) {
+    size_t n = POSTURE_NN_HEADER_LEN;
+    for (int l = 0; l < layer_count; l++) {
+        int in = widths[l], out = widths[l + 1];
+        blob[n] = (uint8_t)in;
+        blob[n + 1] = (uint8_t)out;
+        blob[n + 2] = l < layer_count - 1 ? POSTURE_NN_RELU : 0;
+        blob[n + 3] = 0;
+        n += POSTURE_NN_LAYER_LEN;
+        for (int o = 0; o < out; o++, n += 4) {
+            put32(blob + n, (uint32_t)rng_range(-2000, 2000));
+        }
+        for (int o = 0; o < out; o++, n += 4) {
+            put32(blob + n, (uint32_t)rng_range(1 << 30, INT32_MAX));
+        }
+        for (int o = 0; o < out; o++) {
+            blob[n + o] = (uint8_t)(l < layer_count - 1 ? rng_range(7, 8) : rng_range(1, 3)); // Few saturations
+        }
+        n += (out + 3) & ~3;
+        for (int i = 0; i < in * out; i++) {
+            blob[n + i] = (uint8_t)rng_range(-127, 127);
+        }
+        n += (in * out + 3) & ~3;
+    }
+    put32(blob, POSTURE_NN_MAGIC);
+    blob[4] = POSTURE_NN_VERSION;
+    blob[5] = 0;
+    blob[6] = (uint8_t)layer_count;
+    blob[7] = POSTURE_NN_FEATURES;
+    put32(blob + 8, (uint32_t)(n - POSTURE_NN_HEADER_LEN));
+    put32(blob + 12, posture_nn_crc32(blob + POSTURE_NN_HEADER_LEN, n - POSTURE_NN_HEADER_LEN));
+    const float out_scale = 0.01f;
+    memcpy(blob + 16, &out_scale, sizeof(out_scale));
+    return n;
+}
+
+static int float_infer(const posture_nn_t *nn, const int8_t *features) {
+    float buf[2][POSTURE_NN_MAX_WIDTH];
+    float x[POSTURE_NN_MAX_WIDTH];
+    for (int i = 0; i < POSTURE_NN_FEATURES; i++) {
+        x[i] = features[i];
+    }
+    const float *in_x = x;
+    for (int l = 0; l < nn->layer_count; l++) {
+        const posture_nn_layer_t *layer = &nn->layers[l];
+        float *y = buf[l & 1];
+        for (int o = 0; o < layer->out; o++) {
+            float acc = (float)layer->bias[o];
+            for (int i = 0; i < layer->in; i++) {
+                acc += layer->weights[o * layer->in + i] * in_x[i];
+            }
+            acc *= ldexpf((float)layer->mult[o], -(31 + layer->shift[o]));
+            y[o] = layer->relu && acc < 0.0f ? 0.0f : acc;
+        }
+        in_x = y;
+    }
+    int best = 0;
+    for (int c = 1; c < POSTURE_NN_CLASSES; c++) {
+        best = in_x[c] > in_x[best] ? c : best;
+    }
+    return best;
+}
+
+// Features of random samples: one module, a person at 0.5..6 m, walking now and then
+static void generate(int8_t (*features)[POSTURE_NN_FEATURES], size_t count) {
+    fusion_reading_t history[FUSION_HISTORY_LEN] = { 0 };
+    int kept = 0;
+    int32_t d = 3000, v = 0;
+    uint32_t t = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (rng_next() % 50 == 0) {
+            v = rng_next() % 2 ? rng_range(-1200, 1200) : 0;
+        }
+        t += (uint32_t)rng_range(80, 125);
+        d += v / 10;
+        if (d < 500 || d > 6000) {
+            v = -v;
+            d = d < 500 ? 500 : 6000;
+        }
+        RadarMessage msg = { .timestamp = t, .distance_mm = (uint16_t)(d + rng_range(-40, 40)),
+                             .signal = (uint8_t)rng_range(20, 90), .flags = RADAR_MSG_HAS_TARGETS };
+        msg.moving_mm = v != 0 || rng_next() % 3 == 0 ? (uint16_t)(d + rng_range(-80, 80)) : 0;
+        msg.static_mm = rng_next() % 10 < 8 ? (uint16_t)(d + rng_range(-60, 60)) : 0;
+        posture_nn_features(&msg, kept ? &history[0] : NULL, kept ? &history[kept - 1] : NULL, features[k]);
+        memmove(&history[1], &history[0], sizeof(history[0]) * (FUSION_HISTORY_LEN - 1));
+        history[0] = (fusion_reading_t){ .timestamp = t, .distance_mm = msg.distance_mm, .moving_mm = msg.moving_mm,
+                                         .static_mm = msg.static_mm, .signal = msg.signal };
+        kept = kept < FUSION_HISTORY_LEN ? kept + 1 : kept;
+    }
+}
+
+static volatile int sink;
+
+typedef int (*infer_fn)(posture_nn_t *nn, const int8_t *features);
+
+static int engine_infer(posture_nn_t *nn, const int8_t *features) {
+    int16_t logits[POSTURE_NN_CLASSES];
+    return posture_nn_infer(nn, features, logits);
+}
+
+static int engine_classify(posture_nn_t *nn, const int8_t *features) {
+    uint8_t pct[RADAR_POSTURE_COUNT];
+    return posture_nn_classify(nn, features, pct);
+}
+
+static int float_fn(posture_nn_t *nn, const int8_t *features) {
+    return float_infer(nn, features);
+}
+
+static double time_ns(infer_fn fn, posture_nn_t *nn, int8_t (*features)[POSTURE_NN_FEATURES], size_t count) {
+    uint64_t best = UINT64_MAX;
+    for (int rep = 0; rep < 3; rep++) {
+        uint64_t t0 = bench_now_ns();
+        for (size_t i = 0; i < count; i++) {
+            sink += fn(nn, features[i]);
+        }
+        uint64_t elapsed = bench_now_ns() - t0;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)count;
+}
+
+static void run(const char *name, const uint8_t *blob, size_t len, int8_t (*features)[POSTURE_NN_FEATURES], size_t count) {
+    posture_nn_t nn;
+    posture_nn_status_t status = posture_nn_load(&nn, blob, len);
+    if (status != POSTURE_NN_OK) {
+        printf("  %-12s load failed: %s\n", name, posture_nn_status_name(status));
+        return;
+    }
+    size_t agree = 0;
+    for (size_t i = 0; i < count; i++) {
+        agree += engine_infer(&nn, features[i]) == RADAR_POSTURE_STANDING + float_infer(&nn, features[i]);
+    }
+    printf("  %-12s %6u  %10.1f %9.1f %7.1f   %5.1f %%\n", name, (unsigned)nn.blob_len,
+           time_ns(engine_infer, &nn, features, count),
+           time_ns(engine_classify, &nn, features, count), time_ns(float_fn, &nn, features, count),
+           100.0 * agree / count);
+}
+
+int main(int argc, char **argv) {
+    size_t count = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        }
+    }
+    int8_t (*features)[POSTURE_NN_FEATURES] = malloc(count * sizeof(*features));
+    generate(features, count);
+    static uint32_t storage[2048]; // 4-byte aligned blobs
+
+    printf("posture_nn: %zu inferences, posture_nn_t is %zu B (arena %zu B), %d features\n", count,
+           sizeof(posture_nn_t), sizeof(((posture_nn_t *)0)->arena), POSTURE_NN_FEATURES);
+    printf("  network      blob B  ns: engine  +softmax   float   agree with float\n");
+    run("default", posture_nn_default_model, posture_nn_default_model_len, features, count);
+    static const int shapes[][5] = {
+        { 2, 8 }, { 2, 16 }, { 2, 32 }, { 3, 16, 16 }, { 3, 32, 32 },
+    };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        int layer_count = shapes[s][0], widths[POSTURE_NN_MAX_LAYERS + 1] = { POSTURE_NN_FEATURES };
+        char name[32];
+        int n = snprintf(name, sizeof(name), "%d", POSTURE_NN_FEATURES);
+        for (int l = 1; l < layer_count; l++) {
+            widths[l] = shapes[s][l];
+            n += snprintf(name + n, sizeof(name) - n, "-%d", widths[l]);
+        }
+        widths[layer_count] = POSTURE_NN_CLASSES;
+        snprintf(name + n, sizeof(name) - n, "-%d", POSTURE_NN_CLASSES);
+        memset(storage, 0, sizeof(storage));
+        size_t len = build_blob((uint8_t *)storage, widths, layer_count);
+        run(name, (const uint8_t *)storage, len, features, count);
+    }
+    free(features);
+    return 0;
+}
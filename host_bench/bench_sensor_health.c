@@ -0,0 +1,197 @@
+// Sensor health (sensor_health.c): cost of the streaming statistics per
+// sample vs recomputing them over a window of the last samples.
+//
+//   1. 64 modules (MODULE_REGISTRY_MAX_MODULES) at 10 samples/s: a person
+//      moving around, 2 % of error frames and 1 % of lost samples; module 7
+//      freezes for 2 min every hour, module 13 loses its signal for 5 min;
+//   2. streaming: sensor_health_update() per sample. ns per sample, bytes per
+//      module, degraded/restored transitions;
+//   3. window: the last 100 / 600 samples kept per module, mean, variance,
+//      rates and stuck run recomputed from them at every sample. ns per
+//      sample and bytes per module.
+//
+// Usage: bench_sensor_health [-n minutes]
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "sensor_health.h"
+
+#define MODULES        64
+#define SAMPLES_PER_S  10
+
+static volatile float sink;
+
+static const sensor_health_config_t cfg = {
+    .alpha = 0.02f,
+    .warmup_samples = 50,
+    .stuck_samples = 600,
+    .max_error_rate = 0.2f,
+    .max_drop_rate = 0.3f,
+    .min_signal = 10.0f,
+    .max_distance_std_mm = 1500.0f,
+    .degraded_below = 50,
+    .restored_above = 70,
+};
+
+static uint32_t rng_state = 4848;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+// Next sample of module `m` at second `s`; *lost set when it is lost on the way
+static RadarMessage next_sample(int m, uint32_t s, bool *lost) {
+    RadarMessage msg = { 0 };
+    msg.module_id = (uint8_t)(m + 1);
+    msg.timestamp = s * 1000u;
+    *lost = rng_uniform() < 0.01f;
+    if (m == 7 && s % 3600u < 120u) {
+        msg.distance_mm = msg.static_mm = 1730;
+        msg.signal = 42;
+        msg.posture = RADAR_POSTURE_SITTING;
+        return msg;
+    }
+    if (rng_uniform() < 0.02f) {
+        return msg; // Error frame: posture UNKNOWN
+    }
+    msg.distance_mm = (uint16_t)(800 + rng_uniform() * 3000.0f);
+    msg.moving_mm = msg.distance_mm;
+    msg.signal = (uint8_t)(m == 13 && s % 3600u >= 1800u && s % 3600u < 2100u ? rng_uniform() * 4.0f
+                                                                               : 30.0f + rng_uniform() * 50.0f);
+    msg.posture = RADAR_POSTURE_STANDING;
+    return msg;
+}
+
+static void run_streaming(uint32_t minutes) {
+    static sensor_health_t health[MODULES];
+    uint32_t lost[MODULES] = { 0 };
+    rng_state = 4848;
+    for (int m = 0; m < MODULES; m++) {
+        sensor_health_init(&health[m]);
+    }
+    uint32_t degraded = 0, restored = 0;
+    uint64_t ns = 0, samples = 0;
+    for (uint32_t s = 0; s < minutes * 60u; s++) {
+        for (int k = 0; k < SAMPLES_PER_S; k++) {
+            for (int m = 0; m < MODULES; m++) {
+                bool dropped;
+                RadarMessage msg = next_sample(m, s, &dropped);
+                if (dropped) {
+                    lost[m]++;
+                    continue;
+                }
+                uint64_t t0 = bench_now_ns();
+                bool changed = sensor_health_update(&cfg, &health[m], &msg, lost[m]);
+                ns += bench_now_ns() - t0;
+                samples++;
+                degraded += changed && health[m].degraded;
+                restored += changed && !health[m].degraded;
+            }
+        }
+    }
+    printf("  streaming: %zu B per module, %.1f ns per sample, %u degraded / %u restored\n",
+           sizeof(sensor_health_t), (double)ns / samples, degraded, restored);
+}
+
+// Window baseline: the last samples of a module, each with its loss count
+typedef struct {
+    RadarMessage *samples;
+    uint32_t *lost;
+    uint32_t capacity, head, count;
+} window_t;
+
+static void window_stats(const window_t *w) {
+    float sum = 0.0f, sum_sq = 0.0f, signal = 0.0f;
+    uint32_t targets = 0, errors = 0, missing = 0, run = 0;
+    bool run_open = true;
+    const RadarMessage *newest = &w->samples[(w->head + w->capacity - 1) % w->capacity];
+    for (uint32_t i = 0; i < w->count; i++) {
+        uint32_t slot = (w->head + w->capacity - 1 - i) % w->capacity;
+        const RadarMessage *msg = &w->samples[slot];
+        missing += w->lost[slot];
+        if (msg->posture == RADAR_POSTURE_UNKNOWN) {
+            errors++;
+            continue;
+        }
+        run_open = run_open && msg->distance_mm == newest->distance_mm && msg->signal == newest->signal;
+        run += run_open;
+        if (msg->distance_mm != 0) {
+            sum += msg->distance_mm;
+            sum_sq += (float)msg->distance_mm * msg->distance_mm;
+            signal += msg->signal;
+            targets++;
+        }
+    }
+    float mean = targets ? sum / targets : 0.0f;
+    sink = mean + (targets ? sum_sq / targets - mean * mean : 0.0f) + signal + (float)errors / w->count +
+           (float)missing / (w->count + missing) + (float)run;
+}
+
+static void run_window(uint32_t minutes, uint32_t capacity) {
+    static window_t windows[MODULES];
+    uint32_t pending[MODULES] = { 0 };
+    rng_state = 4848;
+    for (int m = 0; m < MODULES; m++) {
+        windows[m].samples = calloc(capacity, sizeof(RadarMessage));
+        windows[m].lost = calloc(capacity, sizeof(uint32_t));
+        windows[m].capacity = capacity;
+        windows[m].head = windows[m].count = 0;
+    }
+    uint64_t ns = 0, samples = 0;
+    for (uint32_t s = 0; s < minutes * 60u; s++) {
+        for (int k = 0; k < SAMPLES_PER_S; k++) {
+            for (int m = 0; m < MODULES; m++) {
+                bool dropped;
+                RadarMessage msg = next_sample(m, s, &dropped);
+                if (dropped) {
+                    pending[m]++;
+                    continue;
+                }
+                window_t *w = &windows[m];
+                uint64_t t0 = bench_now_ns();
+                w->samples[w->head] = msg;
+                w->lost[w->head] = pending[m];
+                w->head = (w->head + 1) % w->capacity;
+                w->count += w->count < w->capacity;
+                window_stats(w);
+                ns += bench_now_ns() - t0;
+                pending[m] = 0;
+                samples++;
+            }
+        }
+    }
+    printf("  window %4u: %6zu B per module, %.1f ns per sample\n", capacity,
+           (size_t)capacity * (sizeof(RadarMessage) + sizeof(uint32_t)), (double)ns / samples);
+    for (int m = 0; m < MODULES; m++) {
+        free(windows[m].samples);
+        free(windows[m].lost);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t minutes = 60;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            minutes = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n minutes]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (minutes == 0) {
+        minutes = 1;
+    }
+    printf("CPUs: %ld, %d modules, %d samples/s each, %u min simulated\n\n", sysconf(_SC_NPROCESSORS_ONLN), MODULES,
+           SAMPLES_PER_S, minutes);
+    run_streaming(minutes);
+    run_window(minutes, 100);
+    run_window(minutes, 600);
+    return 0;
+}
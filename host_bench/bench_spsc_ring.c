@@ -0,0 +1,325 @@
+// Stage boundary of the master pipeline: lock-free SPSC ring (spsc_ring.c)
+// vs a FreeRTOS-style queue, with RadarMessage items (20 bytes).
+//
+// The queue stands in for xQueueSend/xQueueReceive: every item is copied in
+// and out under a lock (the FreeRTOS critical section), and a blocked side
+// waits on a condition variable. The ring copies without a lock; its consumer
+// sleeps on a semaphore posted by the producer only when it parked (the task
+// notification of main.c).
+//
+//   1. one thread, push then pop: cost of the copies and of the lock alone;
+//   2. two threads, producer and consumer (CPUs 0 and 1 when there are two):
+//      throughput, the producer waiting for room instead of dropping so that
+//      both carry every item; the ring is drained one item or a batch at a time;
+//   3. two threads, one item every 200 us to a sleeping consumer: latency from
+//      the push to the consumer holding the item (wake-up included).
+//
+// The same comparison runs on the target, with the real FreeRTOS queue, at
+// boot (SPSC_SELF_BENCH_ITEMS in main.c), also under QEMU.
+//
+// Usage: bench_spsc_ring [-n items] [-b batch] [-l latency_samples]
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "pipeline_msgs.h"
+#include "spsc_ring.h"
+
+#define RING_SIZE       16 // SHARD_RADAR_RING_SIZE
+#define LATENCY_GAP_US  200
+#define MAX_BATCH       64
+
+// --- FreeRTOS-style queue ---
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+    RadarMessage items[RING_SIZE];
+    size_t head, count;
+} queue_t;
+
+static void queue_init(queue_t *q) {
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+static void queue_free(queue_t *q) {
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+}
+
+// xQueueSend(q, item, portMAX_DELAY)
+static void queue_send(queue_t *q, const RadarMessage *item) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == RING_SIZE) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->items[(q->head + q->count) % RING_SIZE] = *item;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// xQueueReceive(q, item, portMAX_DELAY)
+static void queue_receive(queue_t *q, RadarMessage *item) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    *item = q->items[q->head];
+    q->head = (q->head + 1) % RING_SIZE;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// --- Ring with a sleeping consumer (HotRing of main.c) ---
+
+typedef struct {
+    spsc_ring_t ring;
+    RadarMessage slots[RING_SIZE];
+    sem_t wake; // The consumer's task notification
+} hot_ring_t;
+
+static void hot_ring_init(hot_ring_t *hr) {
+    spsc_ring_init(&hr->ring, hr->slots, sizeof(RadarMessage), RING_SIZE);
+    sem_init(&hr->wake, 0, 0);
+}
+
+// Waits for room instead of dropping: every item is carried
+static void hot_ring_send(hot_ring_t *hr, const RadarMessage *item) {
+    while (!spsc_ring_push(&hr->ring, item)) {
+        sched_yield();
+    }
+    if (spsc_ring_take_sleeper(&hr->ring)) {
+        sem_post(&hr->wake);
+    }
+}
+
+static uint32_t hot_ring_receive(hot_ring_t *hr, RadarMessage *items, uint32_t max) {
+    for (;;) {
+        uint32_t n = spsc_ring_pop_batch(&hr->ring, items, max);
+        if (n > 0) {
+            return n;
+        }
+        if (spsc_ring_park(&hr->ring)) {
+            sem_wait(&hr->wake);
+        }
+        spsc_ring_unpark(&hr->ring);
+    }
+}
+
+// --- Threads ---
+
+typedef struct {
+    bool use_ring;
+    uint32_t batch;
+    size_t items;
+    int cpu;
+    bool paced;               // One item every LATENCY_GAP_US, stamped
+    queue_t *queue;
+    hot_ring_t *ring;
+    uint64_t *sent_ns;        // Paced: push time of each item
+    uint64_t *latency_ns;     // Paced: push -> received
+    size_t out_of_order;
+} side_t;
+
+static int cpu_count;
+
+static void pin(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpu_count, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void sleep_until(uint64_t t_ns) {
+    struct timespec ts = { (time_t)(t_ns / 1000000000ull), (long)(t_ns % 1000000000ull) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void *producer_thread(void *arg) {
+    side_t *p = (side_t *)arg;
+    pin(p->cpu);
+    RadarMessage msg = { 0 };
+    msg.module_id = 1;
+    uint64_t next_ns = bench_now_ns();
+    for (size_t i = 0; i < p->items; i++) {
+        msg.sequence = (uint32_t)i;
+        if (p->paced) {
+            next_ns += LATENCY_GAP_US * 1000ull;
+            sleep_until(next_ns);
+            p->sent_ns[i] = bench_now_ns();
+        }
+        if (p->use_ring) {
+            hot_ring_send(p->ring, &msg);
+        } else {
+            queue_send(p->queue, &msg);
+        }
+    }
+    return NULL;
+}
+
+static void *consumer_thread(void *arg) {
+    side_t *c = (side_t *)arg;
+    pin(c->cpu);
+    RadarMessage batch[MAX_BATCH];
+    size_t received = 0;
+    while (received < c->items) {
+        uint32_t n = 1;
+        if (c->use_ring) {
+            n = hot_ring_receive(c->ring, batch, c->batch);
+        } else {
+            queue_receive(c->queue, &batch[0]);
+        }
+        uint64_t now_ns = c->paced ? bench_now_ns() : 0;
+        for (uint32_t i = 0; i < n; i++, received++) {
+            c->out_of_order += batch[i].sequence != (uint32_t)received;
+            if (c->paced) {
+                c->latency_ns[received] = now_ns - c->sent_ns[received];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Runs a producer and a consumer; returns the elapsed time
+static uint64_t run_pair(side_t *side) {
+    queue_t queue;
+    hot_ring_t ring;
+    queue_init(&queue);
+    hot_ring_init(&ring);
+    side->queue = &queue;
+    side->ring = &ring;
+    side_t producer = *side, consumer = *side;
+    producer.cpu = 0;
+    consumer.cpu = 1;
+    pthread_t pt, ct;
+    uint64_t start_ns = bench_now_ns();
+    pthread_create(&ct, NULL, consumer_thread, &consumer);
+    pthread_create(&pt, NULL, producer_thread, &producer);
+    pthread_join(pt, NULL);
+    pthread_join(ct, NULL);
+    uint64_t elapsed_ns = bench_now_ns() - start_ns;
+    side->out_of_order = consumer.out_of_order;
+    queue_free(&queue);
+    sem_destroy(&ring.wake);
+    return elapsed_ns;
+}
+
+static volatile uint32_t sink;
+
+static void bench_single_thread(size_t items, uint32_t batch) {
+    queue_t queue;
+    hot_ring_t ring;
+    queue_init(&queue);
+    hot_ring_init(&ring);
+    RadarMessage msg = { 0 }, out[MAX_BATCH];
+
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < items; i++) {
+        msg.sequence = (uint32_t)i;
+        queue_send(&queue, &msg);
+        queue_receive(&queue, &out[0]);
+        sink += out[0].sequence;
+    }
+    uint64_t t1 = bench_now_ns();
+    for (size_t i = 0; i < items; i++) {
+        msg.sequence = (uint32_t)i;
+        spsc_ring_push(&ring.ring, &msg);
+        spsc_ring_pop_batch(&ring.ring, out, 1);
+        sink += out[0].sequence;
+    }
+    uint64_t t2 = bench_now_ns();
+    for (size_t i = 0; i < items; i += batch) {
+        for (uint32_t j = 0; j < batch; j++) {
+            msg.sequence = (uint32_t)(i + j);
+            spsc_ring_push(&ring.ring, &msg);
+        }
+        sink += spsc_ring_pop_batch(&ring.ring, out, batch);
+    }
+    uint64_t t3 = bench_now_ns();
+
+    printf("1. One thread, push + pop (%zu items)\n", items);
+    printf("  %-28s %7.1f ns/item\n", "queue (lock)", (double)(t1 - t0) / items);
+    printf("  %-28s %7.1f ns/item\n", "ring", (double)(t2 - t1) / items);
+    char label[40];
+    snprintf(label, sizeof(label), "ring, batches of %u", batch);
+    printf("  %-28s %7.1f ns/item\n", label, (double)(t3 - t2) / items);
+    queue_free(&queue);
+    sem_destroy(&ring.wake);
+}
+
+static void bench_throughput(size_t items, uint32_t batch) {
+    printf("\n2. Two threads, throughput (%zu items, CPUs %s)\n", items, cpu_count >= 2 ? "0 -> 1" : "0 -> 0");
+    struct { const char *label; bool use_ring; uint32_t batch; } runs[] = {
+        { "queue (lock)", false, 1 },
+        { "ring, one at a time", true, 1 },
+        { "ring, batches", true, batch },
+    };
+    for (size_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+        side_t side = { .use_ring = runs[r].use_ring, .batch = runs[r].batch, .items = items };
+        uint64_t elapsed_ns = run_pair(&side);
+        char label[40];
+        snprintf(label, sizeof(label), runs[r].batch > 1 ? "%s of %u" : "%s", runs[r].label, runs[r].batch);
+        printf("  %-28s %7.2f M items/s  %7.1f ns/item  out of order: %zu\n", label,
+               items * 1e3 / (double)elapsed_ns, (double)elapsed_ns / items, side.out_of_order);
+    }
+}
+
+static void bench_wakeup(size_t samples) {
+    printf("\n3. Two threads, one item every %d us to a sleeping consumer (%zu items)\n", LATENCY_GAP_US, samples);
+    uint64_t *sent = malloc(samples * sizeof(uint64_t));
+    uint64_t *latency = malloc(samples * sizeof(uint64_t));
+    for (int use_ring = 0; use_ring < 2; use_ring++) {
+        side_t side = { .use_ring = use_ring, .batch = 1, .items = samples, .paced = true,
+                        .sent_ns = sent, .latency_ns = latency };
+        run_pair(&side);
+        bench_latency_t r = bench_summarize(latency, samples);
+        bench_print_latency(use_ring ? "ring + semaphore" : "queue (lock + condition)", &r);
+    }
+    free(sent);
+    free(latency);
+}
+
+int main(int argc, char **argv) {
+    size_t items = 2000000, latency_samples = 5000;
+    uint32_t batch = 8; // PIPELINE_BATCH
+    int opt;
+    while ((opt = getopt(argc, argv, "n:b:l:")) != -1) {
+        switch (opt) {
+        case 'n': items = strtoul(optarg, NULL, 10); break;
+        case 'b': batch = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'l': latency_samples = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "Usage: %s [-n items] [-b batch] [-l latency_samples]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (batch < 1 || batch > RING_SIZE) {
+        batch = batch < 1 ? 1 : RING_SIZE;
+    }
+    items -= items % batch;
+    cpu_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count < 1) {
+        cpu_count = 1;
+    }
+    printf("SPSC ring vs locked queue, %zu-byte items, %d slots, CPUs: %d\n\n", sizeof(RadarMessage), RING_SIZE,
+           cpu_count);
+    bench_single_thread(items, batch);
+    bench_throughput(items, batch);
+    bench_wakeup(latency_samples);
+    return sink == 0xFFFFFFFFu;
+}
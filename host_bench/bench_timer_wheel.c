@@ -0,0 +1,171 @@
+// Module watchdog (timer_wheel.c): deadlines re-armed at each sample vs the
+// former scan of every module every WATCHDOG_CHECK_INTERVAL_S.
+//
+//   1. 16 to 512 modules at 10 samples/s each (jitter +-20 ms), 5 s timeout;
+//      every module goes silent for 5 to 20 s at random instants (about once
+//      a minute each), so offline transitions keep happening;
+//   2. wheel: timer_wheel_arm() per sample, the watchdog woken at the earliest
+//      deadline (timer_wheel_next_deadline(), capped at the timeout). ns per
+//      sample, watchdog ns per simulated second, wakes per second;
+//   3. scan: all modules checked every 2 s, as Watchdog_task did, and every
+//      32 ms (the resolution of the wheel). Watchdog ns per simulated second;
+//   4. both: delay between the deadline (last sample + timeout) and the
+//      offline detection, mean and max.
+//
+// Usage: bench_timer_wheel [-n seconds]
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "timer_wheel.h"
+
+#define MAX_MODULES   512
+#define PERIOD_MS     100
+#define TIMEOUT_MS    5000
+#define WHEEL_SHIFT   5 // As in main.c: 32 ms slots
+#define BATCH         16
+
+static uint32_t rng_state = 4949;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+typedef struct {
+    uint32_t next_sample_ms;
+    uint32_t silent_until_ms;   // Sends nothing before this
+    uint32_t last_seen_ms;
+    bool offline;
+} module_sim_t;
+
+typedef struct {
+    uint64_t arm_ns, watchdog_ns, samples, wakes, detections;
+    double delay_sum_ms;
+    uint32_t delay_max_ms;
+} result_t;
+
+// Next sample of the module, or the end of a silence starting now
+static void schedule_next(module_sim_t *m, uint32_t now_ms) {
+    if (rng_uniform() < 1.0f / 600.0f) { // ~ once a minute at 10 Hz
+        m->silent_until_ms = now_ms + 5000u + (uint32_t)(rng_uniform() * 15000.0f);
+        m->next_sample_ms = m->silent_until_ms;
+    } else {
+        m->next_sample_ms = now_ms + PERIOD_MS - 20u + (uint32_t)(rng_uniform() * 40.0f);
+    }
+}
+
+static void note_detection(result_t *r, const module_sim_t *m, uint32_t now_ms) {
+    uint32_t delay = now_ms - (m->last_seen_ms + TIMEOUT_MS + 1);
+    r->delay_sum_ms += delay;
+    r->delay_max_ms = delay > r->delay_max_ms ? delay : r->delay_max_ms;
+    r->detections++;
+}
+
+// scan_ms 0: wheel
+static result_t run(int modules, uint32_t seconds, uint32_t scan_ms) {
+    const bool wheel_mode = scan_ms == 0;
+    static module_sim_t sim[MAX_MODULES];
+    static timer_wheel_entry_t timers[MAX_MODULES];
+    static timer_wheel_t wheel;
+    result_t r = { 0 };
+    rng_state = 4949;
+    timer_wheel_init(&wheel, timers, (uint16_t)modules, WHEEL_SHIFT, 0);
+    for (int i = 0; i < modules; i++) {
+        sim[i] = (module_sim_t){ .next_sample_ms = (uint32_t)(rng_uniform() * PERIOD_MS) };
+    }
+    uint32_t wake_ms = TIMEOUT_MS;
+    uint16_t due[BATCH];
+
+    for (uint32_t now = 0; now < seconds * 1000u; now++) {
+        for (int i = 0; i < modules; i++) {
+            module_sim_t *m = &sim[i];
+            if (m->next_sample_ms != now) {
+                continue;
+            }
+            m->last_seen_ms = now;
+            m->offline = false;
+            if (wheel_mode) {
+                uint64_t t0 = bench_now_ns();
+                timer_wheel_arm(&wheel, (uint16_t)i, now + TIMEOUT_MS + 1);
+                r.arm_ns += bench_now_ns() - t0;
+            }
+            r.samples++;
+            schedule_next(m, now);
+        }
+
+        if (wheel_mode && now == wake_ms) {
+            uint64_t t0 = bench_now_ns();
+            size_t count;
+            do {
+                count = timer_wheel_expire(&wheel, now, due, BATCH);
+                for (size_t k = 0; k < count; k++) {
+                    sim[due[k]].offline = true;
+                    note_detection(&r, &sim[due[k]], now);
+                }
+            } while (count == BATCH);
+            uint32_t next;
+            wake_ms = now + TIMEOUT_MS;
+            if (timer_wheel_next_deadline(&wheel, &next) && (int32_t)(next - wake_ms) < 0) {
+                wake_ms = (int32_t)(next - now) <= 0 ? now + 1 : next;
+            }
+            r.watchdog_ns += bench_now_ns() - t0;
+            r.wakes++;
+        } else if (!wheel_mode && now % scan_ms == 0 && now > 0) {
+            uint64_t t0 = bench_now_ns();
+            for (int i = 0; i < modules; i++) {
+                module_sim_t *m = &sim[i];
+                if (!m->offline && now - m->last_seen_ms > TIMEOUT_MS) {
+                    m->offline = true;
+                    note_detection(&r, m, now);
+                }
+            }
+            r.watchdog_ns += bench_now_ns() - t0;
+            r.wakes++;
+        }
+    }
+    return r;
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = 300;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            seconds = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (seconds < 30) {
+        seconds = 30;
+    }
+    uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < 1000000; i++) {
+        bench_now_ns();
+    }
+    double clock_ns = (double)(bench_now_ns() - t0) / 1e6;
+    printf("CPUs: %ld, %d samples/s per module, timeout %d ms, %u s simulated\n", sysconf(_SC_NPROCESSORS_ONLN),
+           1000 / PERIOD_MS, TIMEOUT_MS, seconds);
+    printf("Clock read: %.1f ns, included once in ns/sample\n\n", clock_ns);
+    printf("%8s %10s %10s %14s %8s %16s %14s %16s\n", "modules", "mode", "ns/sample", "watchdog ns/s", "wakes/s",
+           "delay mean (ms)", "delay max (ms)", "offline events");
+    for (int modules = 16; modules <= MAX_MODULES; modules *= 2) {
+        static const uint32_t modes[] = { 2000, 32, 0 };
+        for (int mode = 0; mode < 3; mode++) {
+            result_t r = run(modules, seconds, modes[mode]);
+            char name[24];
+            snprintf(name, sizeof(name), modes[mode] ? "scan %ums" : "wheel", modes[mode]);
+            printf("%8d %10s %10.1f %14.0f %8.2f %16.1f %14u %16llu\n", modules, name,
+                   modes[mode] ? 0.0 : (double)r.arm_ns / r.samples, (double)r.watchdog_ns / seconds,
+                   (double)r.wakes / seconds, r.detections ? r.delay_sum_ms / r.detections : 0.0, r.delay_max_ms,
+                   (unsigned long long)r.detections);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Cost and accuracy of the position solver (trilateration.c) as run by
+// mtt_room_step() (multi_tracker.c) on every fused sample.
+//
+// Sensors sit on the walls of a 4 x 4 m room. For 2 to 8 sensors the run
+// solves positions of random ground-truth points with Gaussian range noise
+// spread over 16 rooms, one geometry per room as on the master, and reports:
+//   - ns per solve with the geometry precomputed (the firmware path);
+//   - ns per solve when the geometry is rebuilt before each solve, i.e. what
+//     the precomputation saves;
+//   - RMS position error against the ground truth, and the mean predicted
+//     standard deviation sqrt(cov_xx + cov_yy) and GDOP.
+//
+// Usage: bench_trilateration [-n solves] [-s range_sigma_m]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "trilateration.h"
+
+#define ROOMS 16
+
+static const trilat_bounds_t room_bounds = { 0.0f, 0.0f, 4.0f, 4.0f };
+
+// Wall positions, in the order sensors are added
+static const trilat_point_t wall_sensors[TRILAT_MAX_SENSORS] = {
+    { 0.0f, 0.0f }, { 4.0f, 0.0f }, { 4.0f, 4.0f }, { 0.0f, 4.0f },
+    { 2.0f, 0.0f }, { 4.0f, 2.0f }, { 2.0f, 4.0f }, { 0.0f, 2.0f },
+};
+
+typedef struct {
+    trilat_point_t truth;
+    float ranges[TRILAT_MAX_SENSORS];
+} sample_t;
+
+static uint32_t rng_state = 12345;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+static float rng_gauss(void) {
+    return sqrtf(-2.0f * logf(rng_uniform())) * cosf(6.2831853f * rng_uniform());
+}
+
+static void build_geometry(trilat_geometry_t *g, int sensors, float sigma) {
+    trilat_geometry_init(g, &room_bounds, sigma);
+    for (int k = 0; k < sensors; k++) {
+        trilat_geometry_set_sensor(g, k, wall_sensors[k].x, wall_sensors[k].y);
+    }
+}
+
+static volatile float sink;
+
+int main(int argc, char **argv) {
+    size_t solves = 1000000;
+    float sigma = TRILAT_DEFAULT_RANGE_SIGMA_M;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            solves = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            sigma = strtof(argv[++i], NULL);
+        }
+    }
+
+    // Ground truth 0.3 m away from the walls (the sensors' own positions are degenerate)
+    sample_t *samples = malloc(solves * sizeof(sample_t));
+    for (size_t i = 0; i < solves; i++) {
+        samples[i].truth.x = 0.3f + 3.4f * rng_uniform();
+        samples[i].truth.y = 0.3f + 3.4f * rng_uniform();
+        for (int k = 0; k < TRILAT_MAX_SENSORS; k++) {
+            float dx = samples[i].truth.x - wall_sensors[k].x, dy = samples[i].truth.y - wall_sensors[k].y;
+            float r = sqrtf(dx * dx + dy * dy) + sigma * rng_gauss();
+            samples[i].ranges[k] = r > 0.0f ? r : 0.0f;
+        }
+    }
+
+    static trilat_geometry_t rooms[ROOMS];
+    printf("trilateration: %zu solves, 4 x 4 m rooms, range noise %.2f m (1 sigma), %d rooms\n", solves, sigma, ROOMS);
+    printf("  sensors  ns/solve  ns/solve(rebuilt)  iters  rms err  pred sigma   GDOP  ambiguous\n");
+    for (int sensors = 2; sensors <= TRILAT_MAX_SENSORS; sensors++) {
+        uint8_t mask = (uint8_t)((1u << sensors) - 1);
+        trilat_result_t r;
+
+        // Firmware path: geometry built once per room
+        for (int room = 0; room < ROOMS; room++) {
+            build_geometry(&rooms[room], sensors, sigma);
+        }
+        uint64_t best = UINT64_MAX;
+        for (int rep = 0; rep < 3; rep++) {
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < solves; i++) {
+                trilat_solve(&rooms[i % ROOMS], mask, samples[i].ranges, NULL, &r);
+                sink += r.p.x;
+            }
+            uint64_t elapsed = bench_now_ns() - t0;
+            best = elapsed < best ? elapsed : best;
+        }
+
+        // Geometry rebuilt before every solve
+        uint64_t best_rebuilt = UINT64_MAX;
+        for (int rep = 0; rep < 3; rep++) {
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < solves; i++) {
+                trilat_geometry_t *g = &rooms[i % ROOMS];
+                build_geometry(g, sensors, sigma);
+                trilat_solve(g, mask, samples[i].ranges, NULL, &r);
+                sink += r.p.x;
+            }
+            uint64_t elapsed = bench_now_ns() - t0;
+            best_rebuilt = elapsed < best_rebuilt ? elapsed : best_rebuilt;
+        }
+
+        // Accuracy (not timed)
+        double err2 = 0.0, pred = 0.0, gdop = 0.0, iters = 0.0;
+        size_t ambiguous = 0, solved = 0;
+        for (size_t i = 0; i < solves; i++) {
+            if (!trilat_solve(&rooms[i % ROOMS], mask, samples[i].ranges, NULL, &r)) {
+                continue;
+            }
+            double dx = r.p.x - samples[i].truth.x, dy = r.p.y - samples[i].truth.y;
+            err2 += dx * dx + dy * dy;
+            pred += sqrt(r.cov_xx + r.cov_yy);
+            gdop += r.gdop;
+            iters += r.iterations;
+            ambiguous += (r.flags & TRILAT_FLAG_AMBIGUOUS) != 0;
+            solved++;
+        }
+        printf("  %7d  %8.1f  %17.1f  %5.2f  %5.0f mm  %7.0f mm  %5.2f  %8.1f%%\n", sensors,
+               (double)best / (double)solves, (double)best_rebuilt / (double)solves, iters / (double)solved,
+               1000.0 * sqrt(err2 / (double)solved), 1000.0 * pred / (double)solved, gdop / (double)solved,
+               100.0 * (double)ambiguous / (double)solved);
+    }
+    printf("  (2 sensors on one wall: the mirror solution is outside, no ambiguity; GDOP grows near the wall)\n");
+    free(samples);
+    return 0;
+}
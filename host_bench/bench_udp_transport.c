@@ -0,0 +1,290 @@
+// Loopback comparison of the two slave -> master radar transports:
+//   udp : 24-byte radar_wire packet sent directly to the receiver (slave RADAR_TRANSPORT_UDP)
+//   mqtt: JSON payload published to a broker and delivered to a subscriber (current path)
+// The receiving side does what the master does per sample (decode/authenticate +
+// anti-replay for UDP, JSON parsing for MQTT). The MQTT run needs a broker on
+// --broker (default 127.0.0.1:1883) and is skipped when none answers.
+//
+// Usage: bench_udp_transport [-n samples] [-r rate_per_s] [--broker host:port]
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "mqtt_lite.h"
+#include "radar_wire.h"
+
+#define BENCH_UDP_PORT   (RADAR_WIRE_DEFAULT_PORT + 1) // Do not collide with a local master
+#define BENCH_TOPIC      "home/room1/radar1"
+#define IDLE_TIMEOUT_MS  2000
+#define IPV4_UDP_HEADERS 28
+#define IPV4_TCP_HEADERS 40
+
+static const uint8_t bench_key[RADAR_WIRE_KEY_LEN] = {
+    0x6b, 0x65, 0x79, 0x2d, 0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x2d, 0x6d, 0x65, 0x21, 0x21, 0x21
+};
+
+typedef struct {
+    size_t samples;
+    uint64_t *send_ns;    // Indexed by sequence
+    uint64_t *latency_ns; // Filled by the receiver
+    size_t received;
+    size_t rejected;
+    uint64_t last_rx_ns;
+    int sock;
+    mqtt_lite_t *mqtt;
+} run_ctx_t;
+
+typedef struct {
+    const char *name;
+    size_t wire_bytes_per_sample; // Application payload + transport framing, excluding IP/L4 headers
+    size_t ip_bytes_per_sample;   // Including IPv4 + UDP/TCP headers
+    size_t sent;
+    size_t received;
+    double seconds;
+    bench_latency_t latency;
+} run_result_t;
+
+static void set_recv_timeout(int sock, int ms) {
+    struct timeval tv = { .tv_sec = ms / 1000, .tv_usec = (ms % 1000) * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static void pace(uint64_t start_ns, size_t i, unsigned rate) {
+    if (rate == 0) {
+        return;
+    }
+    uint64_t target = start_ns + (uint64_t)i * 1000000000ull / rate;
+    while (bench_now_ns() < target) {
+        // Busy wait: nanosleep granularity is too coarse for high rates
+    }
+}
+
+// --- UDP path -------------------------------------------------------------
+
+static void *udp_receiver(void *arg) {
+    run_ctx_t *ctx = arg;
+    radar_wire_replay_t window = { 0 };
+    uint8_t packet[RADAR_WIRE_PACKET_LEN + 8];
+    while (ctx->received < ctx->samples) {
+        ssize_t len = recv(ctx->sock, packet, sizeof(packet), 0);
+        if (len < 0) {
+            break; // Idle timeout: remaining samples are lost
+        }
+        uint64_t now = bench_now_ns();
+        radar_wire_sample_t s;
+        if (radar_wire_decode(packet, (size_t)len, bench_key, &s) != RADAR_WIRE_OK ||
+            radar_wire_replay_check(&window, s.sequence, NULL) != RADAR_REPLAY_ACCEPT || s.sequence >= ctx->samples) {
+            ctx->rejected++;
+            continue;
+        }
+        ctx->latency_ns[ctx->received++] = now - ctx->send_ns[s.sequence];
+        ctx->last_rx_ns = now;
+    }
+    return NULL;
+}
+
+static run_result_t run_udp(size_t samples, unsigned rate) {
+    run_result_t res = { .name = "udp (radar_wire)" };
+    run_ctx_t ctx = { .samples = samples };
+    ctx.send_ns = calloc(samples, sizeof(uint64_t));
+    ctx.latency_ns = calloc(samples, sizeof(uint64_t));
+
+    ctx.sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(ctx.sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(BENCH_UDP_PORT),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (bind(ctx.sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    set_recv_timeout(ctx.sock, IDLE_TIMEOUT_MS);
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, udp_receiver, &ctx);
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < samples; i++) {
+        pace(start, i, rate);
+        radar_wire_sample_t s = {
+            .module_id = 1, .sequence = (uint32_t)i, .timestamp_ms = (uint32_t)(i * 100),
+            .distance_mm = 2500, .posture = RADAR_POSTURE_STANDING, .signal = 80,
+        };
+        uint8_t packet[RADAR_WIRE_PACKET_LEN];
+        size_t len = radar_wire_encode(&s, bench_key, packet);
+        ctx.send_ns[i] = bench_now_ns();
+        if (sendto(tx, packet, len, 0, (struct sockaddr *)&addr, sizeof(addr)) == (ssize_t)len) {
+            res.sent++;
+        }
+    }
+    pthread_join(thread, NULL);
+
+    res.received = ctx.received;
+    res.seconds = ctx.received ? (ctx.last_rx_ns - start) / 1e9 : 0;
+    res.wire_bytes_per_sample = RADAR_WIRE_PACKET_LEN;
+    res.ip_bytes_per_sample = RADAR_WIRE_PACKET_LEN + IPV4_UDP_HEADERS;
+    res.latency = bench_summarize(ctx.latency_ns, ctx.received);
+    close(tx);
+    close(ctx.sock);
+    free(ctx.send_ns);
+    free(ctx.latency_ns);
+    return res;
+}
+
+// --- MQTT path ------------------------------------------------------------
+
+static void *mqtt_receiver(void *arg) {
+    run_ctx_t *ctx = arg;
+    uint8_t body[1024];
+    char topic[128];
+    while (ctx->received < ctx->samples) {
+        uint8_t type, flags;
+        int len = mqtt_lite_read_packet(ctx->mqtt, &type, &flags, body, sizeof(body));
+        if (len < 0) {
+            break;
+        }
+        if (type != MQTT_LITE_PUBLISH) {
+            continue;
+        }
+        uint64_t now = bench_now_ns();
+        const uint8_t *payload;
+        size_t payload_len;
+        if (mqtt_lite_parse_publish(body, (size_t)len, flags, topic, sizeof(topic), &payload, &payload_len, NULL) < 0) {
+            ctx->rejected++;
+            continue;
+        }
+        // Same field extraction the master performs on the JSON payload
+        char json[256];
+        size_t n = payload_len < sizeof(json) - 1 ? payload_len : sizeof(json) - 1;
+        memcpy(json, payload, n);
+        json[n] = '\0';
+        const char *ts = strstr(json, "\"timestamp\":");
+        unsigned long seq = ts ? strtoul(ts + 12, NULL, 10) : ULONG_MAX;
+        if (seq >= ctx->samples) {
+            ctx->rejected++;
+            continue;
+        }
+        ctx->latency_ns[ctx->received++] = now - ctx->send_ns[seq];
+        ctx->last_rx_ns = now;
+    }
+    return NULL;
+}
+
+static bool run_mqtt(const char *host, uint16_t port, size_t samples, unsigned rate, run_result_t *res) {
+    memset(res, 0, sizeof(*res));
+    res->name = "mqtt (JSON via broker)";
+    mqtt_lite_t sub, pub;
+    if (mqtt_lite_connect(&sub, host, port, "bench-master", 60) < 0) {
+        return false;
+    }
+    if (mqtt_lite_subscribe(&sub, "home/+/+", 0) < 0 || mqtt_lite_connect(&pub, host, port, "bench-slave", 60) < 0) {
+        mqtt_lite_close(&sub);
+        return false;
+    }
+    set_recv_timeout(sub.sock, IDLE_TIMEOUT_MS);
+
+    run_ctx_t ctx = { .samples = samples, .mqtt = &sub };
+    ctx.send_ns = calloc(samples, sizeof(uint64_t));
+    ctx.latency_ns = calloc(samples, sizeof(uint64_t));
+    pthread_t thread;
+    pthread_create(&thread, NULL, mqtt_receiver, &ctx);
+
+    size_t wire_bytes = 0;
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < samples; i++) {
+        pace(start, i, rate);
+        // Same format as the slave's format_radar_json(); timestamp carries the sequence
+        char json[256];
+        int len = snprintf(json, sizeof(json),
+                           "{\"module_id\":%d,\"timestamp\":%zu,\"distance\":%.2f,\"posture\":\"%s\",\"signal\":%d}",
+                           1, i, 2.5, "STANDING", 80);
+        ctx.send_ns[i] = bench_now_ns();
+        int written = mqtt_lite_publish(&pub, BENCH_TOPIC, json, (size_t)len, 0, NULL);
+        if (written > 0) {
+            res->sent++;
+            wire_bytes += (size_t)written;
+        }
+    }
+    pthread_join(thread, NULL);
+
+    res->received = ctx.received;
+    res->seconds = ctx.received ? (ctx.last_rx_ns - start) / 1e9 : 0;
+    res->wire_bytes_per_sample = res->sent ? wire_bytes / res->sent : 0;
+    // Two TCP hops (slave -> broker -> master); headers amortize with coalescing,
+    // this is the worst case of one segment per sample on each hop.
+    res->ip_bytes_per_sample = 2 * (res->wire_bytes_per_sample + IPV4_TCP_HEADERS);
+    res->latency = bench_summarize(ctx.latency_ns, ctx.received);
+    mqtt_lite_close(&pub);
+    mqtt_lite_close(&sub);
+    free(ctx.send_ns);
+    free(ctx.latency_ns);
+    return true;
+}
+
+static void print_result(const run_result_t *r) {
+    printf("%s\n", r->name);
+    printf("  sent=%zu received=%zu loss=%.2f%%  throughput=%.0f samples/s\n", r->sent, r->received,
+           r->sent ? 100.0 * (double)(r->sent - r->received) / (double)r->sent : 0.0,
+           r->seconds > 0 ? r->received / r->seconds : 0.0);
+    printf("  bytes/sample: %zu on the wire (payload+framing), %zu with IP headers\n",
+           r->wire_bytes_per_sample, r->ip_bytes_per_sample);
+    bench_print_latency("end-to-end latency", &r->latency);
+}
+
+int main(int argc, char **argv) {
+    size_t samples = 20000;
+    unsigned rate = 0;
+    char broker_host[64] = "127.0.0.1";
+    uint16_t broker_port = 1883;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            samples = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rate = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--broker") == 0 && i + 1 < argc) {
+            const char *arg = argv[++i];
+            const char *colon = strchr(arg, ':');
+            size_t host_len = colon ? (size_t)(colon - arg) : strlen(arg);
+            if (host_len >= sizeof(broker_host)) host_len = sizeof(broker_host) - 1;
+            memcpy(broker_host, arg, host_len);
+            broker_host[host_len] = '\0';
+            if (colon) broker_port = (uint16_t)atoi(colon + 1);
+        } else {
+            fprintf(stderr, "usage: %s [-n samples] [-r rate_per_s] [--broker host:port]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (rate) {
+        printf("== Radar transport benchmark: %zu samples paced at %u/s ==\n", samples, rate);
+    } else {
+        printf("== Radar transport benchmark: %zu samples, unpaced ==\n", samples);
+    }
+
+    run_result_t udp = run_udp(samples, rate);
+    print_result(&udp);
+
+    run_result_t mqtt;
+    if (run_mqtt(broker_host, broker_port, samples, rate, &mqtt)) {
+        print_result(&mqtt);
+        if (mqtt.latency.count && udp.latency.count) {
+            printf("udp vs mqtt: p50 latency x%.1f lower, %.1fx fewer bytes/sample\n",
+                   mqtt.latency.p50_us / udp.latency.p50_us,
+                   (double)mqtt.ip_bytes_per_sample / (double)udp.ip_bytes_per_sample);
+        }
+    } else {
+        printf("mqtt (JSON via broker)\n  skipped: no MQTT broker reachable on %s:%u\n", broker_host, broker_port);
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Zone classification: uniform grid (zone_engine_classify()) vs a
+// point-in-polygon test of every zone of the room (zone_engine_classify_linear()).
+//
+//   1. 50, 200 and 500 random polygons (3 to 8 vertices, 0.3 to 1.5 m across,
+//      overlapping) on a 20 x 20 m floor, the largest the int16 mm coordinates
+//      and the 255 x 255 cells allow at 100 mm;
+//   2. grids of 1000, 500, 250 and 100 mm cells: time to bind the room, arena
+//      words, entries per cell, and classifications per second of random
+//      positions, both ways, with the zones matched per position;
+//   3. every position is classified both ways and the results compared.
+//
+// Usage: bench_zone_engine [-n positions]
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "zone_engine.h"
+
+#define FLOOR_MM   20000
+#define MAX_ZONES  500
+#define ARENA_WORDS (1u << 20)
+
+static volatile uint32_t sink;
+
+static zone_def_t zones[MAX_ZONES];
+static uint16_t arena[ARENA_WORDS];
+static int16_t positions[2][1 << 20];
+
+static uint32_t rng_state = 4545;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f;
+}
+
+// Star-shaped polygon around a random centre: angles in order, random radii
+// (concave from 4 vertices on)
+static void random_zone(zone_def_t *z) {
+    int n = 3 + (int)(rng_uniform() * 6) % 6;
+    float cx = 800.0f + rng_uniform() * (FLOOR_MM - 1600), cy = 800.0f + rng_uniform() * (FLOOR_MM - 1600);
+    float r_max = 150.0f + rng_uniform() * 600.0f;
+    memset(z, 0, sizeof(*z));
+    z->room = "floor";
+    z->name = "z";
+    z->vertex_count = (uint8_t)n;
+    for (int i = 0; i < n; i++) {
+        float a = 6.2831853f * ((float)i + 0.8f * rng_uniform()) / (float)n;
+        float r = r_max * (0.4f + 0.6f * rng_uniform());
+        z->vertices[i].x_mm = (int16_t)(cx + r * cosf(a));
+        z->vertices[i].y_mm = (int16_t)(cy + r * sinf(a));
+    }
+}
+
+typedef struct {
+    bool bound;
+    double bind_ms;
+    uint32_t arena_words;
+    double entries_per_cell;
+    double grid_per_s, linear_per_s;
+    double hits_per_position;
+    uint32_t mismatches;
+} run_result_t;
+
+static run_result_t run(uint16_t zone_count, uint16_t cell_mm, uint32_t count) {
+    run_result_t r = { 0 };
+    zone_engine_t ze;
+    if (!zone_engine_init(&ze, zones, zone_count, arena, ARENA_WORDS, 0, 0, FLOOR_MM, FLOOR_MM, cell_mm)) {
+        return r;
+    }
+    uint64_t t0 = bench_now_ns();
+    int bound = zone_engine_bind_room(&ze, 0, "floor");
+    r.bind_ms = (double)(bench_now_ns() - t0) / 1e6;
+    if (bound != zone_count) {
+        return r;
+    }
+    r.bound = true;
+    r.arena_words = ze.arena_used;
+    uint32_t cells = (uint32_t)ze.grids[0].cols * ze.grids[0].rows;
+    r.entries_per_cell = (double)(ze.arena_used - cells - 1) / cells;
+
+    uint16_t hits[ZONE_MAX_HITS], check[ZONE_MAX_HITS];
+    uint64_t total_hits = 0;
+    t0 = bench_now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        int n = zone_engine_classify(&ze, 0, positions[0][i], positions[1][i], hits, ZONE_MAX_HITS);
+        total_hits += (uint32_t)n;
+        sink += n > 0 ? hits[0] : 0;
+    }
+    r.grid_per_s = count / ((double)(bench_now_ns() - t0) / 1e9);
+
+    uint32_t linear_count = count / 10 > 0 ? count / 10 : 1; // Slow: a tenth of the positions
+    t0 = bench_now_ns();
+    for (uint32_t i = 0; i < linear_count; i++) {
+        int n = zone_engine_classify_linear(&ze, 0, positions[0][i], positions[1][i], hits, ZONE_MAX_HITS);
+        sink += n > 0 ? hits[0] : 0;
+    }
+    r.linear_per_s = linear_count / ((double)(bench_now_ns() - t0) / 1e9);
+    r.hits_per_position = (double)total_hits / count;
+
+    for (uint32_t i = 0; i < count; i++) {
+        int ng = zone_engine_classify(&ze, 0, positions[0][i], positions[1][i], hits, ZONE_MAX_HITS);
+        int nl = zone_engine_classify_linear(&ze, 0, positions[0][i], positions[1][i], check, ZONE_MAX_HITS);
+        // Same zones in the same (table) order
+        r.mismatches += ng != nl || memcmp(hits, check, (size_t)ng * sizeof(hits[0])) != 0;
+    }
+    return r;
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = 200000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n') {
+            count = (uint32_t)strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n positions]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count == 0 || count > (1u << 20)) {
+        count = 1u << 20;
+    }
+    for (int i = 0; i < MAX_ZONES; i++) {
+        random_zone(&zones[i]);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        positions[0][i] = (int16_t)(rng_uniform() * (FLOOR_MM - 1));
+        positions[1][i] = (int16_t)(rng_uniform() * (FLOOR_MM - 1));
+    }
+
+    static const uint16_t zone_counts[] = { 50, 200, 500 };
+    static const uint16_t cell_sizes[] = { 1000, 500, 250, 100 };
+    printf("CPUs: %ld, %u random positions on a %d x %d m floor\n\n", sysconf(_SC_NPROCESSORS_ONLN), count,
+           FLOOR_MM / 1000, FLOOR_MM / 1000);
+    printf("  %-6s %-8s %9s %12s %13s %6s %14s %14s %8s %11s\n", "zones", "cell mm", "bind ms", "arena words",
+           "entries/cell", "hits", "grid /s", "linear /s", "speedup", "mismatches");
+    for (size_t z = 0; z < sizeof(zone_counts) / sizeof(zone_counts[0]); z++) {
+        for (size_t c = 0; c < sizeof(cell_sizes) / sizeof(cell_sizes[0]); c++) {
+            run_result_t r = run(zone_counts[z], cell_sizes[c], count);
+            if (!r.bound) {
+                printf("  %-6u %-8u  grid refused (more than 65535 entries or arena too small)\n", zone_counts[z],
+                       cell_sizes[c]);
+                continue;
+            }
+            printf("  %-6u %-8u %9.2f %12u %13.2f %6.3f %14.0f %14.0f %7.1fx %11u\n", zone_counts[z], cell_sizes[c],
+                   r.bind_ms, r.arena_words, r.entries_per_cell, r.hits_per_position, r.grid_per_s, r.linear_per_s,
+                   r.grid_per_s / r.linear_per_s, r.mismatches);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "mqtt_lite.h"
+#include "mqtt5_props.h"
+
+size_t mqtt_lite_encode_length(uint8_t *out, uint32_t len) {
+    size_t n = 0;
+    do {
+        uint8_t byte = len % 128;
+        len /= 128;
+        if (len > 0) {
+            byte |= 0x80;
+        }
+        out[n++] = byte;
+    } while (len > 0 && n < 4);
+    return n;
+}
+
+int mqtt_lite_send_raw(mqtt_lite_t *c, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t w = send(c->sock, p, len, MSG_NOSIGNAL);
+        if (w <= 0) {
+            return -1;
+        }
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+static int recv_all(int sock, uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t r = recv(sock, buf, len, 0);
+        if (r <= 0) {
+            return -1;
+        }
+        buf += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+static size_t put_string(uint8_t *out, const char *s) {
+    size_t len = strlen(s);
+    out[0] = (uint8_t)(len >> 8);
+    out[1] = (uint8_t)len;
+    memcpy(out + 2, s, len);
+    return len + 2;
+}
+
+static int connect_level(mqtt_lite_t *c, const char *host, uint16_t port, const char *client_id,
+                         uint16_t keepalive_s, uint8_t level) {
+    c->sock = -1;
+    c->next_packet_id = 1;
+    c->protocol_level = level;
+    c->topic_alias_max = 0;
+    if (strlen(client_id) > 64) {
+        return -1;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) {
+        return -1;
+    }
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0 || connect(sock, res->ai_addr, res->ai_addrlen) < 0) {
+        if (sock >= 0) close(sock);
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Same as esp-mqtt: no Nagle delay
+    c->sock = sock;
+
+    uint8_t body[128];
+    size_t n = put_string(body, "MQTT");
+    body[n++] = level; // 4 = 3.1.1, 5 = MQTT 5
+    body[n++] = 0x02;  // Clean session / clean start
+    body[n++] = (uint8_t)(keepalive_s >> 8);
+    body[n++] = (uint8_t)keepalive_s;
+    if (level == 5) {
+        body[n++] = 0; // No CONNECT properties
+    }
+    n += put_string(body + n, client_id);
+
+    uint8_t packet[160];
+    packet[0] = MQTT_LITE_CONNECT << 4;
+    size_t h = 1 + mqtt_lite_encode_length(packet + 1, (uint32_t)n);
+    if (h + n > sizeof(packet)) {
+        mqtt_lite_close(c);
+        return -1;
+    }
+    memcpy(packet + h, body, n);
+    if (mqtt_lite_send_raw(c, packet, h + n) < 0) {
+        mqtt_lite_close(c);
+        return -1;
+    }
+
+    uint8_t type, flags, ack[64];
+    int ack_len = mqtt_lite_read_packet(c, &type, &flags, ack, sizeof(ack));
+    if (ack_len < 2 || type != MQTT_LITE_CONNACK || ack[1] != 0) {
+        mqtt_lite_close(c);
+        return -1;
+    }
+    if (level == 5) {
+        uint32_t props_len;
+        int used = mqtt5_varint_decode(ack + 2, (size_t)ack_len - 2, &props_len);
+        if (used <= 0 || 2 + (size_t)used + props_len > (size_t)ack_len) {
+            mqtt_lite_close(c);
+            return -1;
+        }
+        const uint8_t *props = ack + 2 + used;
+        size_t offset = 0;
+        mqtt5_prop_t prop;
+        while (mqtt5_prop_next(props, props_len, &offset, &prop) > 0) {
+            if (prop.id == MQTT5_PROP_TOPIC_ALIAS_MAX) {
+                c->topic_alias_max = (uint16_t)prop.value;
+            }
+        }
+    }
+    return 0;
+}
+
+int mqtt_lite_connect(mqtt_lite_t *c, const char *host, uint16_t port, const char *client_id, uint16_t keepalive_s) {
+    return connect_level(c, host, port, client_id, keepalive_s, 4);
+}
+
+int mqtt_lite_connect_v5(mqtt_lite_t *c, const char *host, uint16_t port, const char *client_id, uint16_t keepalive_s) {
+    return connect_level(c, host, port, client_id, keepalive_s, 5);
+}
+
+int mqtt_lite_subscribe(mqtt_lite_t *c, const char *topic_filter, uint8_t qos) {
+    uint8_t body[256];
+    if (strlen(topic_filter) > 200) {
+        return -1;
+    }
+    uint16_t id = c->next_packet_id++;
+    size_t n = 0;
+    body[n++] = (uint8_t)(id >> 8);
+    body[n++] = (uint8_t)id;
+    if (c->protocol_level == 5) {
+        body[n++] = 0; // No SUBSCRIBE properties
+    }
+    n += put_string(body + n, topic_filter);
+    body[n++] = qos;
+
+    uint8_t packet[264];
+    packet[0] = (MQTT_LITE_SUBSCRIBE << 4) | 0x02;
+    size_t h = 1 + mqtt_lite_encode_length(packet + 1, (uint32_t)n);
+    if (h + n > sizeof(packet)) {
+        return -1;
+    }
+    memcpy(packet + h, body, n);
+    if (mqtt_lite_send_raw(c, packet, h + n) < 0) {
+        return -1;
+    }
+
+    uint8_t type, flags, ack[8];
+    int len = mqtt_lite_read_packet(c, &type, &flags, ack, sizeof(ack));
+    size_t reason = c->protocol_level == 5 ? 3 : 2; // MQTT 5 inserts an (empty) property length
+    return (len > (int)reason && type == MQTT_LITE_SUBACK && ack[reason] < 0x80) ? 0 : -1;
+}
+
+int mqtt_lite_publish(mqtt_lite_t *c, const char *topic, const void *payload, size_t len, uint8_t qos,
+                      uint16_t *packet_id) {
+    uint8_t packet[1024];
+    size_t topic_len = strlen(topic);
+    size_t body_len = 2 + topic_len + (qos ? 2 : 0) + len;
+    if (body_len + 5 > sizeof(packet)) {
+        return -1;
+    }
+    packet[0] = (uint8_t)((MQTT_LITE_PUBLISH << 4) | (qos << 1));
+    size_t n = 1 + mqtt_lite_encode_length(packet + 1, (uint32_t)body_len);
+    n += put_string(packet + n, topic);
+    if (qos) {
+        uint16_t id = c->next_packet_id++;
+        if (c->next_packet_id == 0) c->next_packet_id = 1;
+        packet[n++] = (uint8_t)(id >> 8);
+        packet[n++] = (uint8_t)id;
+        if (packet_id) *packet_id = id;
+    }
+    memcpy(packet + n, payload, len);
+    n += len;
+    return mqtt_lite_send_raw(c, packet, n) < 0 ? -1 : (int)n;
+}
+
+size_t mqtt_lite_put_user_property(uint8_t *out, const char *key, const char *value) {
+    out[0] = MQTT5_PROP_USER;
+    size_t n = 1 + put_string(out + 1, key);
+    return n + put_string(out + n, value);
+}
+
+int mqtt_lite_publish_v5(mqtt_lite_t *c, const char *topic, uint16_t topic_alias,
+                         const uint8_t *user_props, size_t user_props_len,
+                         const void *payload, size_t len, uint8_t qos, uint16_t *packet_id) {
+    uint8_t packet[1024];
+    size_t topic_len = strlen(topic);
+    size_t props_len = (topic_alias ? 3 : 0) + user_props_len;
+    uint8_t props_header[4];
+    size_t props_header_len = mqtt5_varint_encode(props_header, (uint32_t)props_len);
+    size_t body_len = 2 + topic_len + (qos ? 2 : 0) + props_header_len + props_len + len;
+    if (body_len + 5 > sizeof(packet)) {
+        return -1;
+    }
+    packet[0] = (uint8_t)((MQTT_LITE_PUBLISH << 4) | (qos << 1));
+    size_t n = 1 + mqtt_lite_encode_length(packet + 1, (uint32_t)body_len);
+    n += put_string(packet + n, topic);
+    if (qos) {
+        uint16_t id = c->next_packet_id++;
+        if (c->next_packet_id == 0) c->next_packet_id = 1;
+        packet[n++] = (uint8_t)(id >> 8);
+        packet[n++] = (uint8_t)id;
+        if (packet_id) *packet_id = id;
+    }
+    memcpy(packet + n, props_header, props_header_len);
+    n += props_header_len;
+    if (topic_alias) {
+        packet[n++] = MQTT5_PROP_TOPIC_ALIAS;
+        packet[n++] = (uint8_t)(topic_alias >> 8);
+        packet[n++] = (uint8_t)topic_alias;
+    }
+    if (user_props_len) {
+        memcpy(packet + n, user_props, user_props_len);
+        n += user_props_len;
+    }
+    memcpy(packet + n, payload, len);
+    n += len;
+    return mqtt_lite_send_raw(c, packet, n) < 0 ? -1 : (int)n;
+}
+
+int mqtt_lite_read_packet(mqtt_lite_t *c, uint8_t *type, uint8_t *flags, uint8_t *buf, size_t cap) {
+    uint8_t header;
+    if (recv_all(c->sock, &header, 1) < 0) {
+        return -1;
+    }
+    uint32_t len = 0, mult = 1;
+    for (int i = 0; i < 4; i++) {
+        uint8_t b;
+        if (recv_all(c->sock, &b, 1) < 0) {
+            return -1;
+        }
+        len += (b & 0x7F) * mult;
+        mult *= 128;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    if (len > cap || (len > 0 && recv_all(c->sock, buf, len) < 0)) {
+        return -1;
+    }
+    *type = header >> 4;
+    *flags = header & 0x0F;
+    return (int)len;
+}
+
+int mqtt_lite_parse_publish(const uint8_t *body, size_t len, uint8_t flags, char *topic, size_t topic_cap,
+                            const uint8_t **payload, size_t *payload_len, uint16_t *packet_id) {
+    if (len < 2) {
+        return -1;
+    }
+    size_t topic_len = ((size_t)body[0] << 8) | body[1];
+    size_t offset = 2 + topic_len;
+    uint8_t qos = (flags >> 1) & 0x03;
+    if (offset + (qos ? 2 : 0) > len || topic_len + 1 > topic_cap) {
+        return -1;
+    }
+    memcpy(topic, body + 2, topic_len);
+    topic[topic_len] = '\0';
+    if (qos) {
+        if (packet_id) *packet_id = (uint16_t)((body[offset] << 8) | body[offset + 1]);
+        offset += 2;
+    }
+    *payload = body + offset;
+    *payload_len = len - offset;
+    return 0;
+}
+
+int mqtt_lite_parse_publish_v5(const uint8_t *body, size_t len, uint8_t flags, char *topic, size_t topic_cap,
+                               const uint8_t **props, size_t *props_len,
+                               const uint8_t **payload, size_t *payload_len, uint16_t *packet_id) {
+    const uint8_t *rest;
+    size_t rest_len;
+    if (mqtt_lite_parse_publish(body, len, flags, topic, topic_cap, &rest, &rest_len, packet_id) < 0) {
+        return -1;
+    }
+    uint32_t block_len;
+    int used = mqtt5_varint_decode(rest, rest_len, &block_len);
+    if (used <= 0 || (size_t)used + block_len > rest_len) {
+        return -1;
+    }
+    *props = rest + used;
+    *props_len = block_len;
+    *payload = rest + used + block_len;
+    *payload_len = rest_len - (size_t)used - block_len;
+    return 0;
+}
+
+void mqtt_lite_close(mqtt_lite_t *c) {
+    if (c->sock >= 0) {
+        uint8_t disconnect[2] = { MQTT_LITE_DISCONNECT << 4, 0 };
+        send(c->sock, disconnect, sizeof(disconnect), MSG_NOSIGNAL);
+        close(c->sock);
+        c->sock = -1;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef MQTT_LITE_H
+#define MQTT_LITE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal blocking MQTT 3.1.1 / 5.0 client for the host benchmarks (QoS 0/1, no TLS).
+// Only what the harnesses need: CONNECT, SUBSCRIBE, PUBLISH, PUBACK, PINGREQ, plus
+// MQTT 5 topic aliases and user properties on PUBLISH.
+// Returns 0 on success and -1 on socket/protocol errors unless stated otherwise.
+
+#define MQTT_LITE_CONNECT     1
+#define MQTT_LITE_CONNACK     2
+#define MQTT_LITE_PUBLISH     3
+#define MQTT_LITE_PUBACK      4
+#define MQTT_LITE_SUBSCRIBE   8
+#define MQTT_LITE_SUBACK      9
+#define MQTT_LITE_PINGREQ     12
+#define MQTT_LITE_PINGRESP    13
+#define MQTT_LITE_DISCONNECT  14
+
+typedef struct {
+    int sock;
+    uint16_t next_packet_id;
+    uint8_t protocol_level;   // 4 or 5
+    uint16_t topic_alias_max; // From the MQTT 5 CONNACK, 0 = aliases not allowed
+} mqtt_lite_t;
+
+int mqtt_lite_connect(mqtt_lite_t *c, const char *host, uint16_t port, const char *client_id, uint16_t keepalive_s);
+// Same with protocol level 5 (empty CONNECT properties).
+int mqtt_lite_connect_v5(mqtt_lite_t *c, const char *host, uint16_t port, const char *client_id, uint16_t keepalive_s);
+int mqtt_lite_subscribe(mqtt_lite_t *c, const char *topic_filter, uint8_t qos);
+
+// Sends a PUBLISH. For QoS 1 the packet id is returned through `packet_id` (may be NULL)
+// and the PUBACK must be consumed with mqtt_lite_read_packet(). Returns the number of
+// bytes written on the TCP stream, or -1.
+int mqtt_lite_publish(mqtt_lite_t *c, const char *topic, const void *payload, size_t len, uint8_t qos,
+                      uint16_t *packet_id);
+
+// MQTT 5 PUBLISH. `topic` may be "" when `topic_alias` was set by an earlier publish;
+// `topic_alias` 0 sends no alias. `user_props` is a raw property block built with
+// mqtt_lite_put_user_property() (may be NULL). Returns the bytes written, or -1.
+int mqtt_lite_publish_v5(mqtt_lite_t *c, const char *topic, uint16_t topic_alias,
+                         const uint8_t *user_props, size_t user_props_len,
+                         const void *payload, size_t len, uint8_t qos, uint16_t *packet_id);
+
+// Appends one user property (id 0x26, key, value) at `out`. Returns the bytes written.
+size_t mqtt_lite_put_user_property(uint8_t *out, const char *key, const char *value);
+
+// Reads one control packet. `type` receives the packet type (high nibble), `flags` the low
+// nibble; the variable header and payload are copied into `buf`. Returns the remaining
+// length, or -1 on error / if it does not fit.
+int mqtt_lite_read_packet(mqtt_lite_t *c, uint8_t *type, uint8_t *flags, uint8_t *buf, size_t cap);
+
+// Splits a PUBLISH body read by mqtt_lite_read_packet() into topic and payload.
+// Returns 0 on success; `topic` is NUL terminated.
+int mqtt_lite_parse_publish(const uint8_t *body, size_t len, uint8_t flags, char *topic, size_t topic_cap,
+                            const uint8_t **payload, size_t *payload_len, uint16_t *packet_id);
+
+// MQTT 5 variant: also returns the property block of the PUBLISH.
+int mqtt_lite_parse_publish_v5(const uint8_t *body, size_t len, uint8_t flags, char *topic, size_t topic_cap,
+                               const uint8_t **props, size_t *props_len,
+                               const uint8_t **payload, size_t *payload_len, uint16_t *packet_id);
+
+// Encodes the MQTT "remaining length" varint. Returns the number of bytes written (1..4).
+size_t mqtt_lite_encode_length(uint8_t *out, uint32_t len);
+
+int mqtt_lite_send_raw(mqtt_lite_t *c, const void *data, size_t len);
+void mqtt_lite_close(mqtt_lite_t *c);
+
+#endif // MQTT_LITE_H
@@ -0,0 +1,301 @@
+#include <string.h>
+#include "alert_outbox.h"
+
+#define BLOB_MAGIC   0xA10B
+#define BLOB_VERSION 1
+
+// Blob layout, little-endian as in memory on the ESP32
+typedef struct {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint32_t next_id;
+    uint32_t boot;
+} blob_header_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t boot;
+    uint32_t created_unix;
+    AlertMessage alert;
+} blob_entry_t;
+
+_Static_assert(sizeof(blob_header_t) == 12 && sizeof(blob_entry_t) == 28, "ALERT_OUTBOX_BLOB_MAX out of date");
+
+void alert_outbox_init(alert_outbox_t *outbox, const alert_outbox_config_t *cfg) {
+    memset(outbox, 0, sizeof(*outbox));
+    outbox->cfg = cfg;
+    outbox->next_id = 1;
+    outbox->boot = 1;
+    for (int i = 0; i < ALERT_OUTBOX_EARLY_ACKS; i++) {
+        outbox->early_acks[i].msg_id = -1;
+    }
+}
+
+static inline bool older(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+// Delay before the next retry of `entry`, doubled at each one
+static uint32_t next_backoff_ms(const alert_outbox_config_t *cfg, alert_outbox_entry_t *entry) {
+    uint32_t delay = cfg->retry_base_ms;
+    for (uint8_t i = 0; i < entry->backoff_step && delay < cfg->retry_max_ms; i++) {
+        delay *= 2;
+    }
+    if (entry->backoff_step < UINT8_MAX) {
+        entry->backoff_step++;
+    }
+    return delay < cfg->retry_max_ms ? delay : cfg->retry_max_ms;
+}
+
+static void release(alert_outbox_t *outbox, alert_outbox_entry_t *entry) {
+    memset(entry, 0, sizeof(*entry));
+    outbox->dirty = true;
+}
+
+uint8_t alert_outbox_rank(AlertType type) {
+    switch (type) {
+        case ALERT_TYPE_FALL_DETECTED:  return 3;
+        case ALERT_TYPE_INACTIVITY:     return 2;
+        case ALERT_TYPE_MODULE_OFFLINE:
+        case ALERT_TYPE_ROOM_DEGRADED:
+        case ALERT_TYPE_SENSOR_DEGRADED: return 1;
+        default:                        return 0;
+    }
+}
+
+uint32_t alert_outbox_push(alert_outbox_t *outbox, const AlertMessage *alert, uint32_t now_ms, uint32_t now_unix) {
+    // Free slot, or else the oldest alert of the lowest rank
+    alert_outbox_entry_t *slot = NULL, *victim = NULL;
+    uint8_t victim_rank = 0;
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY && slot == NULL; i++) {
+        alert_outbox_entry_t *e = &outbox->entries[i];
+        uint8_t rank = alert_outbox_rank((AlertType)e->alert.type);
+        if (e->state == ALERT_OUTBOX_FREE) {
+            slot = e;
+        } else if (victim == NULL || rank < victim_rank || (rank == victim_rank && older(e->id, victim->id))) {
+            victim = e;
+            victim_rank = rank;
+        }
+    }
+    if (slot == NULL) {
+        outbox->stats.dropped++;
+        if (victim_rank > alert_outbox_rank((AlertType)alert->type)) {
+            return 0;
+        }
+        slot = victim;
+    }
+    *slot = (alert_outbox_entry_t){
+        .alert = *alert,
+        .id = outbox->next_id,
+        .boot = outbox->boot,
+        .created_unix = now_unix,
+        .due_ms = now_ms,
+        .msg_id = -1,
+        .state = ALERT_OUTBOX_PENDING,
+    };
+    outbox->next_id = outbox->next_id == UINT32_MAX ? 1 : outbox->next_id + 1;
+    outbox->stats.queued++;
+    outbox->dirty = true;
+    return slot->id;
+}
+
+bool alert_outbox_take_due(alert_outbox_t *outbox, uint32_t now_ms, alert_outbox_entry_t *entry) {
+    alert_outbox_entry_t *due = NULL;
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state == ALERT_OUTBOX_IN_FLIGHT && !older(now_ms, e->due_ms)) {
+            // No PUBACK in time: the backoff starts from the ack deadline
+            e->state = ALERT_OUTBOX_PENDING;
+            e->due_ms += next_backoff_ms(outbox->cfg, e);
+        }
+        if (e->state == ALERT_OUTBOX_PENDING && !older(now_ms, e->due_ms) &&
+            (due == NULL || older(e->id, due->id))) {
+            due = e;
+        }
+    }
+    if (due == NULL) {
+        return false;
+    }
+    outbox->stats.retries += due->attempts > 0;
+    due->attempts++;
+    due->state = ALERT_OUTBOX_IN_FLIGHT;
+    due->msg_id = -1;
+    due->due_ms = now_ms + outbox->cfg->ack_timeout_ms;
+    *entry = *due;
+    return true;
+}
+
+static alert_outbox_entry_t *find_in_flight(alert_outbox_t *outbox, uint32_t id) {
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state == ALERT_OUTBOX_IN_FLIGHT && e->id == id) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+// msg_id >= 0: alerts whose packet id is not known yet (-1) never match
+static alert_outbox_entry_t *find_published(alert_outbox_t *outbox, int32_t msg_id) {
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state == ALERT_OUTBOX_IN_FLIGHT && e->msg_id == msg_id) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t deliver(alert_outbox_t *outbox, alert_outbox_entry_t *entry, uint32_t now_ms, uint32_t now_unix) {
+    uint32_t latency = ALERT_OUTBOX_LATENCY_UNKNOWN;
+    if (entry->boot == outbox->boot) {
+        latency = now_ms - entry->alert.alert_timestamp;
+    } else if (entry->created_unix != 0 && now_unix >= entry->created_unix &&
+               now_unix - entry->created_unix < ALERT_OUTBOX_LATENCY_UNKNOWN / 1000u) {
+        latency = (now_unix - entry->created_unix) * 1000u;
+    }
+    alert_outbox_stats_t *stats = &outbox->stats;
+    stats->delivered++;
+    if (latency != ALERT_OUTBOX_LATENCY_UNKNOWN) {
+        stats->latency_last_ms = latency;
+        stats->latency_max_ms = latency > stats->latency_max_ms ? latency : stats->latency_max_ms;
+        stats->latency_sum_ms += latency;
+        stats->latency_count++;
+    }
+    release(outbox, entry);
+    return latency;
+}
+
+bool alert_outbox_sent(alert_outbox_t *outbox, uint32_t id, int32_t msg_id, uint32_t now_ms, uint32_t now_unix) {
+    alert_outbox_entry_t *entry = find_in_flight(outbox, id);
+    if (entry == NULL || entry->msg_id >= 0) {
+        return false;
+    }
+    if (msg_id < 0) {
+        entry->state = ALERT_OUTBOX_PENDING;
+        entry->due_ms = now_ms + next_backoff_ms(outbox->cfg, entry);
+        return false;
+    }
+    entry->msg_id = msg_id;
+    for (int i = 0; i < ALERT_OUTBOX_EARLY_ACKS; i++) {
+        if (outbox->early_acks[i].msg_id == msg_id &&
+            now_ms - outbox->early_acks[i].at_ms <= outbox->cfg->ack_timeout_ms) {
+            outbox->early_acks[i].msg_id = -1;
+            deliver(outbox, entry, now_ms, now_unix);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool alert_outbox_ack(alert_outbox_t *outbox, int32_t msg_id, uint32_t now_ms, uint32_t now_unix, uint32_t *id,
+                      uint32_t *latency_ms) {
+    if (msg_id < 0) {
+        return false;
+    }
+    alert_outbox_entry_t *entry = find_published(outbox, msg_id);
+    if (entry == NULL) {
+        // Maybe an alert whose alert_outbox_sent() is still to come
+        outbox->early_acks[outbox->early_ack_next].msg_id = msg_id;
+        outbox->early_acks[outbox->early_ack_next].at_ms = now_ms;
+        outbox->early_ack_next = (uint8_t)((outbox->early_ack_next + 1) % ALERT_OUTBOX_EARLY_ACKS);
+        return false;
+    }
+    if (id != NULL) {
+        *id = entry->id;
+    }
+    uint32_t latency = deliver(outbox, entry, now_ms, now_unix);
+    if (latency_ms != NULL) {
+        *latency_ms = latency;
+    }
+    return true;
+}
+
+void alert_outbox_reset(alert_outbox_t *outbox, uint32_t now_ms) {
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state != ALERT_OUTBOX_FREE) {
+            e->state = ALERT_OUTBOX_PENDING;
+            e->due_ms = now_ms;
+            e->msg_id = -1;
+            e->backoff_step = 0;
+        }
+    }
+    for (int i = 0; i < ALERT_OUTBOX_EARLY_ACKS; i++) {
+        outbox->early_acks[i].msg_id = -1;
+    }
+}
+
+bool alert_outbox_next_due(const alert_outbox_t *outbox, uint32_t *due_ms) {
+    bool any = false;
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        const alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state != ALERT_OUTBOX_FREE && (!any || older(e->due_ms, *due_ms))) {
+            *due_ms = e->due_ms;
+            any = true;
+        }
+    }
+    return any;
+}
+
+size_t alert_outbox_count(const alert_outbox_t *outbox) {
+    size_t count = 0;
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        count += outbox->entries[i].state != ALERT_OUTBOX_FREE;
+    }
+    return count;
+}
+
+size_t alert_outbox_save(alert_outbox_t *outbox, uint8_t *buf, size_t cap) {
+    if (cap < ALERT_OUTBOX_BLOB_MAX) {
+        return 0;
+    }
+    blob_header_t header = { .magic = BLOB_MAGIC, .version = BLOB_VERSION, .next_id = outbox->next_id,
+                             .boot = outbox->boot };
+    size_t len = sizeof(header);
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        const alert_outbox_entry_t *e = &outbox->entries[i];
+        if (e->state == ALERT_OUTBOX_FREE) {
+            continue;
+        }
+        blob_entry_t be = { .id = e->id, .boot = e->boot, .created_unix = e->created_unix, .alert = e->alert };
+        memcpy(buf + len, &be, sizeof(be));
+        len += sizeof(be);
+        header.count++;
+    }
+    memcpy(buf, &header, sizeof(header));
+    outbox->dirty = false;
+    return len;
+}
+
+bool alert_outbox_load(alert_outbox_t *outbox, const uint8_t *buf, size_t len, uint32_t now_ms) {
+    blob_header_t header;
+    if (len < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, buf, sizeof(header));
+    if (header.magic != BLOB_MAGIC || header.version != BLOB_VERSION || header.count > ALERT_OUTBOX_CAPACITY ||
+        len != sizeof(header) + header.count * sizeof(blob_entry_t) || header.next_id == 0) {
+        return false;
+    }
+    // A boot number the restored alerts were not created in: their
+    // alert_timestamp is on the clock of an earlier boot
+    outbox->boot = header.boot + 1;
+    outbox->next_id = header.next_id;
+    for (int i = 0; i < header.count; i++) {
+        blob_entry_t be;
+        memcpy(&be, buf + sizeof(header) + i * sizeof(be), sizeof(be));
+        outbox->entries[i] = (alert_outbox_entry_t){
+            .alert = be.alert,
+            .id = be.id,
+            .boot = be.boot,
+            .created_unix = be.created_unix,
+            .due_ms = now_ms,
+            .msg_id = -1,
+            .state = ALERT_OUTBOX_PENDING,
+        };
+    }
+    outbox->stats.restored += header.count;
+    return true;
+}
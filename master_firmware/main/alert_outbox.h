@@ -0,0 +1,138 @@
+#ifndef ALERT_OUTBOX_H
+#define ALERT_OUTBOX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pipeline_msgs.h"
+
+// Alerts for the upstream broker, kept until their PUBACK: an alert raised
+// while the broker is unreachable is published once it comes back, and one
+// raised just before a reboot is published after it.
+//
+// - Each alert gets an id, unique across reboots (the next id is persisted
+//   with the alerts): QoS 1 delivers at least once, a subscriber drops the
+//   copies of an id it has already seen.
+// - Published again when no PUBACK came within `ack_timeout_ms`, or when the
+//   publish itself failed, after a backoff doubling from `retry_base_ms` up
+//   to `retry_max_ms`. A new connection publishes everything left at once.
+// - A PUBACK is matched by packet id. One seen before alert_outbox_sent()
+//   recorded the id (the network task may get it first) is kept a short
+//   while and matched then.
+// - Only the alerts that need the guarantee are kept: alert_outbox_rank()
+//   is 0 for informational ones (zone events, the end of a condition), which
+//   the caller publishes best-effort. Full: the oldest alert of the lowest
+//   rank goes (falls last), or the new one if it ranks below them all.
+// - Delivery latency: alert creation (alert_timestamp, boot clock) to the
+//   PUBACK. For an alert created before a reboot, from the wall clocks of
+//   both ends when both were set, unknown otherwise.
+//
+// alert_outbox_save() writes the alerts and the next id to a blob (NVS on
+// the master) and alert_outbox_load() restores it at boot; retry state is
+// not persisted, a restored alert is due at once.
+//
+// Plain C, no locking: the caller serializes access (alert_outbox_mutex).
+
+#define ALERT_OUTBOX_CAPACITY        16
+#define ALERT_OUTBOX_EARLY_ACKS      4
+#define ALERT_OUTBOX_LATENCY_UNKNOWN UINT32_MAX
+
+typedef enum {
+    ALERT_OUTBOX_FREE,
+    ALERT_OUTBOX_PENDING,   // Waiting for `due_ms` (or a connection)
+    ALERT_OUTBOX_IN_FLIGHT  // Published, waiting for its PUBACK until `due_ms`
+} alert_outbox_state_t;
+
+typedef struct {
+    uint32_t retry_base_ms;  // Delay before the first retry, doubled at each attempt
+    uint32_t retry_max_ms;
+    uint32_t ack_timeout_ms; // Published without PUBACK for this long: retried
+} alert_outbox_config_t;
+
+typedef struct {
+    AlertMessage alert;
+    uint32_t id;            // 0: free slot
+    uint32_t boot;          // Boot the alert was created in (clock of alert_timestamp)
+    uint32_t created_unix;  // Wall clock at creation, s, 0 if not set
+    // Not persisted
+    uint32_t due_ms;
+    int32_t msg_id;         // IN_FLIGHT: packet id of the last publish, -1 not known yet
+    uint16_t attempts;      // Publishes of the alert since boot
+    uint8_t backoff_step;   // Retries since the last connection
+    uint8_t state;          // alert_outbox_state_t
+} alert_outbox_entry_t;
+
+typedef struct {
+    uint32_t queued, delivered;
+    uint32_t retries;          // Publishes after the first one of an alert
+    uint32_t dropped;          // Pushed out of a full outbox
+    uint32_t restored;         // Loaded from the blob at boot
+    uint32_t latency_last_ms, latency_max_ms;
+    uint32_t latency_count;    // Deliveries with a known latency
+    uint64_t latency_sum_ms;
+} alert_outbox_stats_t;
+
+typedef struct {
+    const alert_outbox_config_t *cfg;
+    alert_outbox_entry_t entries[ALERT_OUTBOX_CAPACITY];
+    uint32_t next_id;
+    uint32_t boot;
+    struct {
+        int32_t msg_id;        // -1: empty
+        uint32_t at_ms;
+    } early_acks[ALERT_OUTBOX_EARLY_ACKS];
+    uint8_t early_ack_next;
+    bool dirty;                // Persisted content changed since alert_outbox_save()
+    alert_outbox_stats_t stats;
+} alert_outbox_t;
+
+// Blob of alert_outbox_save(): 12-byte header, 28 bytes per alert
+#define ALERT_OUTBOX_BLOB_MAX (12 + 28 * ALERT_OUTBOX_CAPACITY)
+
+void alert_outbox_init(alert_outbox_t *outbox, const alert_outbox_config_t *cfg);
+
+// Rank of an alert type in the outbox: fall 3, inactivity 2, module
+// offline, room or sensor degraded 1; 0 for the informational types, not
+// worth a slot nor an NVS write.
+uint8_t alert_outbox_rank(AlertType type);
+
+// Adds `alert`, due at once. `now_unix`: wall clock, 0 if not set. Returns
+// its id, 0 if the outbox is full of alerts ranking higher (`alert` is
+// dropped).
+uint32_t alert_outbox_push(alert_outbox_t *outbox, const AlertMessage *alert, uint32_t now_ms, uint32_t now_unix);
+
+// Oldest alert due at `now_ms` (pending, or in flight past its ack timeout):
+// copied to `entry` and marked in flight. False if none. Call only while
+// connected, then alert_outbox_sent() with the result of the publish.
+bool alert_outbox_take_due(alert_outbox_t *outbox, uint32_t now_ms, alert_outbox_entry_t *entry);
+
+// Packet id of the publish of alert `id`, or a negative value if it failed
+// (retried after the backoff). Ignored if the alert is no longer in flight.
+// True when its PUBACK had already come: the alert is delivered.
+bool alert_outbox_sent(alert_outbox_t *outbox, uint32_t id, int32_t msg_id, uint32_t now_ms, uint32_t now_unix);
+
+// PUBACK of `msg_id`. True when it delivered an alert: its id and latency
+// (ALERT_OUTBOX_LATENCY_UNKNOWN if not known) are written to `id` and
+// `latency_ms` (may be NULL).
+bool alert_outbox_ack(alert_outbox_t *outbox, int32_t msg_id, uint32_t now_ms, uint32_t now_unix, uint32_t *id,
+                      uint32_t *latency_ms);
+
+// New connection: every alert left is due at once, backoff restarted;
+// PUBACKs of the previous connection will not come.
+void alert_outbox_reset(alert_outbox_t *outbox, uint32_t now_ms);
+
+// Earliest `due_ms` of the alerts left, false if the outbox is empty.
+bool alert_outbox_next_due(const alert_outbox_t *outbox, uint32_t *due_ms);
+
+size_t alert_outbox_count(const alert_outbox_t *outbox);
+
+// Writes the alerts and the next id to `buf` (at least ALERT_OUTBOX_BLOB_MAX
+// bytes) and clears `dirty`. Returns the blob length, 0 if `cap` is too small.
+size_t alert_outbox_save(alert_outbox_t *outbox, uint8_t *buf, size_t cap);
+
+// Restores a blob of alert_outbox_save() into an outbox just initialized:
+// the next boot, the alerts due at once. False, outbox left empty, if the
+// blob is not valid.
+bool alert_outbox_load(alert_outbox_t *outbox, const uint8_t *buf, size_t len, uint32_t now_ms);
+
+#endif // ALERT_OUTBOX_H
@@ -0,0 +1,149 @@
+#include <math.h>
+#include <string.h>
+#include "fall_features.h"
+
+// Height of the body centre per posture, mm
+static const int16_t posture_height_mm[RADAR_POSTURE_COUNT] = {
+    [RADAR_POSTURE_UNKNOWN] = -1,  [RADAR_POSTURE_STANDING] = 1300, [RADAR_POSTURE_SITTING] = 800,
+    [RADAR_POSTURE_LYING] = 200,   [RADAR_POSTURE_MOVING] = 1300,   [RADAR_POSTURE_STILL] = 1000,
+};
+
+void fall_features_init(fall_features_t *ff) {
+    memset(ff, 0, sizeof(*ff));
+    ff->last_height_mm = -1;
+}
+
+int16_t fall_features_height_mm(const FusedData *data) {
+    uint32_t total = 0, weighted = 0;
+    for (int s = RADAR_POSTURE_STANDING; s < RADAR_POSTURE_COUNT; s++) {
+        total += data->posture_pct[s];
+        weighted += (uint32_t)data->posture_pct[s] * (uint32_t)posture_height_mm[s];
+    }
+    if (total > 0) {
+        return (int16_t)(weighted / total);
+    }
+    return data->posture < RADAR_POSTURE_COUNT ? posture_height_mm[data->posture] : -1;
+}
+
+// Timestamp of a sample of the window, which ends at last_ms
+static uint32_t sample_ms(const fall_features_t *ff, int slot) {
+    return ff->last_ms - (uint16_t)((uint16_t)ff->last_ms - ff->samples[slot].t16);
+}
+
+static void evict_oldest(fall_features_t *ff) {
+    const fall_feature_sample_t *s = &ff->samples[ff->head];
+    ff->sum_x -= s->x_mm;
+    ff->sum_y -= s->y_mm;
+    ff->sum_xx -= (int64_t)s->x_mm * s->x_mm;
+    ff->sum_yy -= (int64_t)s->y_mm * s->y_mm;
+    if (ff->peak_count > 0 && ff->peak[ff->peak_head] == ff->head) {
+        ff->peak_head = (uint8_t)((ff->peak_head + 1) % FALL_FEATURE_CAPACITY);
+        ff->peak_count--;
+    }
+    ff->head = (uint8_t)((ff->head + 1) % FALL_FEATURE_CAPACITY);
+    ff->count--;
+}
+
+void fall_features_add(fall_features_t *ff, const FusedData *data) {
+    uint32_t t = data->timestamp;
+    if (ff->count > 0 && t - ff->last_ms > FALL_FEATURE_WINDOW_MS) {
+        // Gap: nothing left in the window, the upright history stays
+        uint32_t last_upright_ms = ff->last_upright_ms;
+        bool seen_upright = ff->seen_upright;
+        fall_features_init(ff);
+        ff->last_upright_ms = last_upright_ms;
+        ff->seen_upright = seen_upright;
+    }
+    while (ff->count > 0 &&
+           (ff->count == FALL_FEATURE_CAPACITY || t - sample_ms(ff, ff->head) > FALL_FEATURE_WINDOW_MS)) {
+        evict_oldest(ff);
+    }
+
+    int16_t height = fall_features_height_mm(data);
+    int32_t descent = 0;
+    if (ff->count > 0 && height >= 0 && ff->last_height_mm >= 0) {
+        uint32_t dt = t - ff->last_height_ms;
+        descent = (int32_t)(ff->last_height_mm - height) * 1000 / (int32_t)(dt > 0 ? dt : 1);
+        descent = descent > INT16_MAX ? INT16_MAX : (descent < INT16_MIN ? INT16_MIN : descent);
+    }
+
+    int slot = (ff->head + ff->count) % FALL_FEATURE_CAPACITY;
+    fall_feature_sample_t *s = &ff->samples[slot];
+    s->t16 = (uint16_t)t;
+    s->x_mm = data->x_mm;
+    s->y_mm = data->y_mm;
+    s->descent_mm_s = (int16_t)descent;
+    ff->count++;
+    ff->sum_x += s->x_mm;
+    ff->sum_y += s->y_mm;
+    ff->sum_xx += (int64_t)s->x_mm * s->x_mm;
+    ff->sum_yy += (int64_t)s->y_mm * s->y_mm;
+
+    // Sliding maximum: samples with a lower descent than the new one can
+    // never be the peak again
+    while (ff->peak_count > 0) {
+        int back = (ff->peak_head + ff->peak_count - 1) % FALL_FEATURE_CAPACITY;
+        if (ff->samples[ff->peak[back]].descent_mm_s > s->descent_mm_s) {
+            break;
+        }
+        ff->peak_count--;
+    }
+    ff->peak[(ff->peak_head + ff->peak_count) % FALL_FEATURE_CAPACITY] = (uint8_t)slot;
+    ff->peak_count++;
+
+    if (height >= 0) {
+        ff->last_height_mm = height;
+        ff->last_height_ms = t;
+    }
+    if (radar_posture_is_upright_or_moving((radar_posture_t)data->posture)) {
+        ff->last_upright_ms = t;
+        ff->seen_upright = true;
+    }
+    ff->last_ms = t;
+}
+
+// Speed between two samples of the window, mm/s (0 if simultaneous)
+static float speed_between(const fall_features_t *ff, int a, int b) {
+    uint32_t dt = sample_ms(ff, b) - sample_ms(ff, a);
+    if (dt == 0) {
+        return 0.0f;
+    }
+    float dx = (float)(ff->samples[b].x_mm - ff->samples[a].x_mm);
+    float dy = (float)(ff->samples[b].y_mm - ff->samples[a].y_mm);
+    return sqrtf(dx * dx + dy * dy) * 1000.0f / (float)dt;
+}
+
+static uint16_t clamp_u16(float v) {
+    return (uint16_t)(v < 0.0f ? 0.0f : (v > (float)UINT16_MAX ? (float)UINT16_MAX : v + 0.5f));
+}
+
+void fall_features_get(const fall_features_t *ff, uint32_t now_ms, fall_feature_values_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->since_upright_ms = ff->seen_upright ? now_ms - ff->last_upright_ms : UINT32_MAX;
+    if (ff->count == 0 || now_ms - ff->last_ms > FALL_FEATURE_WINDOW_MS) {
+        return;
+    }
+    out->samples = ff->count;
+
+    // n^2 * (var(x) + var(y)), exact in int64 (n <= 32, 16-bit coordinates):
+    // no double, which the ESP32 FPU does not do, on every fused sample
+    int64_t n = ff->count;
+    int64_t n2_var = (n * ff->sum_xx - ff->sum_x * ff->sum_x) + (n * ff->sum_yy - ff->sum_y * ff->sum_y);
+    out->position_std_mm = clamp_u16(sqrtf((float)(n2_var > 0 ? n2_var : 0) / (float)(n * n)));
+
+    int16_t peak = ff->samples[ff->peak[ff->peak_head]].descent_mm_s;
+    out->peak_descent_mm_s = (uint16_t)(peak > 0 ? peak : 0);
+
+    int oldest = ff->head;
+    int newest = (ff->head + ff->count - 1) % FALL_FEATURE_CAPACITY;
+    out->speed_mm_s = clamp_u16(speed_between(ff, oldest, newest));
+    if (ff->count >= 3) {
+        int mid = (ff->head + ff->count / 2) % FALL_FEATURE_CAPACITY;
+        uint32_t half_ms = (sample_ms(ff, newest) - sample_ms(ff, oldest)) / 2;
+        if (half_ms > 0) {
+            float accel = (speed_between(ff, mid, newest) - speed_between(ff, oldest, mid)) * 1000.0f / (float)half_ms;
+            accel = accel > INT16_MAX ? INT16_MAX : (accel < INT16_MIN ? INT16_MIN : accel);
+            out->accel_mm_s2 = (int16_t)accel;
+        }
+    }
+}
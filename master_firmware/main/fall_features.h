@@ -0,0 +1,74 @@
+#ifndef FALL_FEATURES_H
+#define FALL_FEATURES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pipeline_msgs.h"
+
+// Sliding-window motion statistics of one person (room, track) for the fall
+// rules, over the fused outputs of the last FALL_FEATURE_WINDOW_MS:
+// - velocity and acceleration of the position: displacement between the
+//   oldest and newest samples, and change of speed between the two halves
+//   of the window;
+// - peak descent rate: the radar sees no height, so each output gets a body
+//   height from its posture probabilities (posture_pct, e.g. 1.3 m standing,
+//   0.2 m lying) and the descent rate is its drop per second between two
+//   outputs. The peak over the window survives sample gaps and jitter that
+//   defeat a comparison of two consecutive outputs;
+// - variance of the position (x and y);
+// - time since the last upright or moving posture.
+//
+// Every statistic is updated in O(1) per sample: running sums for the
+// variance, a monotonic deque for the peak, the ring for the endpoints. At
+// most FALL_FEATURE_CAPACITY samples: above ~10 outputs per second the
+// window gets shorter than FALL_FEATURE_WINDOW_MS.
+//
+// Fixed-size state, no allocation. Plain C, no locking: owned by the
+// FallDetector task, one per fall rule instance.
+
+#define FALL_FEATURE_WINDOW_MS 3000
+#define FALL_FEATURE_CAPACITY  32
+
+typedef struct {
+    uint16_t t16;          // Low 16 bits of the timestamp (window < 65 s)
+    int16_t x_mm, y_mm;
+    int16_t descent_mm_s;  // Height drop rate since the previous sample with a height
+} fall_feature_sample_t;
+
+typedef struct {
+    fall_feature_sample_t samples[FALL_FEATURE_CAPACITY];
+    uint8_t peak[FALL_FEATURE_CAPACITY]; // Deque of sample slots, decreasing descent
+    uint8_t head, count;                 // Oldest sample, samples in the window
+    uint8_t peak_head, peak_count;
+    int64_t sum_x, sum_y, sum_xx, sum_yy;
+    uint32_t last_ms;
+    uint32_t last_upright_ms;
+    uint32_t last_height_ms;
+    int16_t last_height_mm;
+    bool seen_upright;
+} fall_features_t;
+
+typedef struct {
+    uint16_t speed_mm_s;        // Displacement over the window / its duration
+    int16_t accel_mm_s2;        // Speed of the second half minus the first, per second
+    uint16_t peak_descent_mm_s; // 0 when the height only rose
+    uint16_t position_std_mm;   // sqrt(var(x) + var(y))
+    uint32_t since_upright_ms;  // UINT32_MAX if never upright
+    uint8_t samples;
+} fall_feature_values_t;
+
+void fall_features_init(fall_features_t *ff);
+
+// Adds a fused output (timestamps in order). A gap longer than the window
+// empties it first.
+void fall_features_add(fall_features_t *ff, const FusedData *data);
+
+// Statistics of the window ending at the last sample; none (samples = 0)
+// once `now_ms` is a window past it. since_upright_ms is counted to `now_ms`.
+void fall_features_get(const fall_features_t *ff, uint32_t now_ms, fall_feature_values_t *out);
+
+// Body height of a fused output, from posture_pct (posture alone if empty),
+// -1 if unknown.
+int16_t fall_features_height_mm(const FusedData *data);
+
+#endif // FALL_FEATURES_H
@@ -0,0 +1,64 @@
+#include <stdlib.h>
+#include "fall_rules.h"
+
+#define LYING   RADAR_POSTURE_BIT(RADAR_POSTURE_LYING)
+#define UPRIGHT RADAR_POSTURE_UPRIGHT_OR_MOVING_MASK
+#define NOT_LYING (0xFFu & ~LYING)
+
+// Zone policy (context) masks
+#define SUPPRESSED     FSM_CONTEXT_BIT(ZONE_FALL_SUPPRESS)
+#define ESCALATED      FSM_CONTEXT_BIT(ZONE_FALL_ESCALATE)
+#define NOT_SUPPRESSED (FSM_CONTEXT_BIT(ZONE_FALL_NORMAL) | ESCALATED)
+
+// Sorted by state; within a state, the first matching rule wins.
+static const fsm_rule_t fall_rules[] = {
+    // from                  to                    trigger       action                  posture    prev       zone            min speed               max speed     min descent            in state (ms)                          gap (ms)
+    { FALL_STATE_WATCHING,  FALL_STATE_SUSPECTED, FSM_ON_EVENT, FALL_ACTION_SUSPECT,    LYING,     UPRIGHT,   NOT_SUPPRESSED, 0,                      FSM_NO_LIMIT, 0,                     0,                                     FALL_TRANSITION_MAX_MS },
+    { FALL_STATE_WATCHING,  FALL_STATE_SUSPECTED, FSM_ON_EVENT, FALL_ACTION_SUSPECT,    LYING,     NOT_LYING, NOT_SUPPRESSED, 0,                      FSM_NO_LIMIT, FALL_MIN_DESCENT_MM_S, 0,                                     0 },
+    { FALL_STATE_WATCHING,  FALL_STATE_WATCHING,  FSM_ON_EVENT, FALL_ACTION_SUPPRESSED, LYING,     NOT_LYING, SUPPRESSED,     0,                      FSM_NO_LIMIT, 0,                     0,                                     0 },
+    { FALL_STATE_WATCHING,  FALL_STATE_WATCHING,  FSM_ON_EVENT, FALL_ACTION_SLOW_LYING, LYING,     UPRIGHT,   FSM_ANY,        0,                      FSM_NO_LIMIT, 0,                     0,                                     0 },
+    { FALL_STATE_SUSPECTED, FALL_STATE_WATCHING,  FSM_ON_ANY,   FALL_ACTION_SUPPRESSED, FSM_ANY,   FSM_ANY,   SUPPRESSED,     0,                      FSM_NO_LIMIT, 0,                     0,                                     0 },
+    { FALL_STATE_SUSPECTED, FALL_STATE_WATCHING,  FSM_ON_EVENT, FALL_ACTION_CANCEL,     NOT_LYING, FSM_ANY,   FSM_ANY,        0,                      FSM_NO_LIMIT, 0,                     0,                                     0 },
+    { FALL_STATE_SUSPECTED, FALL_STATE_WATCHING,  FSM_ON_EVENT, FALL_ACTION_CANCEL,     LYING,     FSM_ANY,   FSM_ANY,        FALL_CANCEL_SPEED_MM_S, FSM_NO_LIMIT, 0,                     FALL_CANCEL_AFTER_MS,                  0 },
+    { FALL_STATE_SUSPECTED, FALL_STATE_CONFIRMED, FSM_ON_ANY,   FALL_ACTION_CONFIRM,    LYING,     FSM_ANY,   ESCALATED,      0,                      FSM_NO_LIMIT, 0,                     ZONE_ESCALATED_CONFIRM_MS,             0 },
+    { FALL_STATE_SUSPECTED, FALL_STATE_CONFIRMED, FSM_ON_ANY,   FALL_ACTION_CONFIRM,    LYING,     FSM_ANY,   FSM_ANY,        0,                      FSM_NO_LIMIT, 0,                     LYING_CONFIRMATION_DURATION_S * 1000u, 0 },
+    { FALL_STATE_CONFIRMED, FALL_STATE_WATCHING,  FSM_ON_EVENT, FALL_ACTION_RECOVERED,  UPRIGHT,   FSM_ANY,   FSM_ANY,        0,                      FSM_NO_LIMIT, 0,                     0,                                     0 },
+};
+
+static fsm_table_t table;
+
+bool fall_rules_init(void) {
+    // Constant rules, checked by test_fall_detector.c
+    return fsm_table_init(&table, fall_rules, sizeof(fall_rules) / sizeof(fall_rules[0]), FALL_STATE_COUNT);
+}
+
+const fsm_table_t *fall_rules_table(void) {
+    return &table;
+}
+
+const char *fall_state_name(uint8_t state) {
+    switch (state) {
+        case FALL_STATE_WATCHING:  return "WATCHING";
+        case FALL_STATE_SUSPECTED: return "SUSPECTED";
+        case FALL_STATE_CONFIRMED: return "CONFIRMED";
+        default:                   return "?";
+    }
+}
+
+fsm_event_t fall_event_from(const FusedData *data, const fall_feature_values_t *features,
+                            zone_fall_policy_t zone_policy) {
+    uint32_t speed = features->speed_mm_s;
+    if (features->samples < 2) {
+        // max + min / 2: |v| without a square root, 12 % high at most
+        uint32_t ax = (uint32_t)abs(data->vx_mm_s), ay = (uint32_t)abs(data->vy_mm_s);
+        speed = ax > ay ? ax + ay / 2 : ay + ax / 2;
+    }
+    fsm_event_t event = {
+        .now_ms = data->timestamp,
+        .speed_mm_s = (uint16_t)(speed > FSM_NO_LIMIT - 1 ? FSM_NO_LIMIT - 1 : speed),
+        .descent_mm_s = features->peak_descent_mm_s,
+        .posture = data->posture,
+        .context = (uint8_t)zone_policy,
+    };
+    return event;
+}
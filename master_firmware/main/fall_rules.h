@@ -0,0 +1,65 @@
+#ifndef FALL_RULES_H
+#define FALL_RULES_H
+
+#include <stdbool.h>
+#include "fsm_engine.h"
+#include "pipeline_msgs.h"
+#include "fall_features.h"
+#include "zone_engine.h"
+
+// Fall detection rules of the FallDetector task, as an fsm_engine table. One
+// instance per person (room, track): upright then LYING within
+// FALL_TRANSITION_MAX_MS, or LYING after a descent of at least
+// FALL_MIN_DESCENT_MM_S in the feature window (a fall seen across a gap or a
+// glitch in the outputs), arms it. LYING for LYING_CONFIRMATION_DURATION_S
+// confirms the fall, by event or by timer (a motionless person whose track
+// has gone quiet). Standing up, or moving faster than FALL_CANCEL_SPEED_MM_S
+// once on the floor, cancels.
+//
+// The context of the events and ticks is the fall policy of the zone the
+// person is in (zone_fall_policy_t): lying down in a SUPPRESS zone arms
+// nothing and drops a suspected fall; in an ESCALATE zone the fall is
+// confirmed after ZONE_ESCALATED_CONFIRM_MS.
+
+#define FALL_TRANSITION_MAX_MS        1000
+#define LYING_CONFIRMATION_DURATION_S 20
+#define FALL_MIN_DESCENT_MM_S         1000  // Peak height drop rate of a fall (fall_features.h)
+#define FALL_CANCEL_SPEED_MM_S        800   // Walking, not lying on the floor
+#define FALL_CANCEL_AFTER_MS          2000  // Speed of the fall itself ignored before
+#define ZONE_ESCALATED_CONFIRM_MS     5000  // LYING confirmation in an ESCALATE zone
+
+typedef enum {
+    FALL_STATE_WATCHING = 0,
+    FALL_STATE_SUSPECTED,   // Fast transition to LYING, waiting for the confirmation
+    FALL_STATE_CONFIRMED,   // Alert sent, until the person is up again
+    FALL_STATE_COUNT
+} fall_state_t;
+
+typedef enum {
+    FALL_ACTION_NONE = FSM_ACTION_NONE,
+    FALL_ACTION_SUSPECT,    // Enter the potential fall state
+    FALL_ACTION_SLOW_LYING, // Lay down too slowly to be a fall
+    FALL_ACTION_CANCEL,     // Up again, or moving, before the confirmation
+    FALL_ACTION_CONFIRM,    // Send the fall alert
+    FALL_ACTION_RECOVERED,  // Up again after a confirmed fall
+    FALL_ACTION_SUPPRESSED, // Lying down, or a suspected fall, in a SUPPRESS zone: not reported
+} fall_action_t;
+
+// Indexes the rule table. Call once, before the FallDetector tasks start:
+// they share the table and only read it. False if the rules are not valid
+// (the table then has no rule).
+bool fall_rules_init(void);
+
+// The rule table indexed by fall_rules_init(). Never NULL.
+const fsm_table_t *fall_rules_table(void);
+
+const char *fall_state_name(uint8_t state);
+
+// Engine event of a fused output and of the features of its person (after
+// fall_features_add()): timestamp, posture, window speed (the track velocity
+// if the window has a single sample), peak descent rate, and `zone_policy`
+// (zone_engine_fall_policy() of its position) as context.
+fsm_event_t fall_event_from(const FusedData *data, const fall_feature_values_t *features,
+                            zone_fall_policy_t zone_policy);
+
+#endif // FALL_RULES_H
@@ -0,0 +1,96 @@
+#include <string.h>
+#include "fsm_engine.h"
+
+bool fsm_table_init(fsm_table_t *table, const fsm_rule_t *rules, uint8_t rule_count, uint8_t state_count) {
+    memset(table, 0, sizeof(*table));
+    if (state_count == 0 || state_count > FSM_MAX_STATES) {
+        return false;
+    }
+    for (int i = 0; i < rule_count; i++) {
+        if (rules[i].from >= state_count || rules[i].to >= state_count ||
+            (i > 0 && rules[i].from < rules[i - 1].from)) {
+            return false;
+        }
+    }
+    int r = 0;
+    for (int s = 0; s <= state_count; s++) {
+        while (r < rule_count && rules[r].from < s) {
+            r++;
+        }
+        table->first[s] = (uint8_t)r;
+    }
+    table->rules = rules;
+    table->rule_count = rule_count;
+    table->state_count = state_count;
+    return true;
+}
+
+void fsm_instance_init(fsm_instance_t *inst, uint8_t state, uint32_t now_ms) {
+    memset(inst, 0, sizeof(*inst));
+    inst->state = state;
+    inst->entered_ms = now_ms;
+}
+
+static bool posture_in(uint8_t mask, uint8_t posture) {
+    return mask == FSM_ANY || (posture < 8 && (mask & RADAR_POSTURE_BIT(posture)) != 0);
+}
+
+// Guards of `rule` shared by events and ticks
+static bool common_guards(const fsm_rule_t *rule, const fsm_instance_t *inst, uint8_t posture, uint8_t context,
+                          uint32_t now_ms) {
+    return posture_in(rule->posture_mask, posture) &&
+           (rule->context_mask == FSM_ANY || (context < 8 && (rule->context_mask & FSM_CONTEXT_BIT(context)) != 0)) &&
+           (rule->min_in_state_ms == 0 || now_ms - inst->entered_ms >= rule->min_in_state_ms);
+}
+
+static uint8_t apply(fsm_instance_t *inst, const fsm_rule_t *rule, uint32_t now_ms) {
+    if (rule->to != inst->state) {
+        inst->state = rule->to;
+        inst->entered_ms = now_ms;
+    }
+    return rule->action;
+}
+
+uint8_t fsm_dispatch(const fsm_table_t *table, fsm_instance_t *inst, const fsm_event_t *event) {
+    uint8_t action = FSM_ACTION_NONE;
+    if (inst->state < table->state_count) {
+        uint32_t gap = event->now_ms - inst->last_ms;
+        for (int i = table->first[inst->state]; i < table->first[inst->state + 1]; i++) {
+            const fsm_rule_t *rule = &table->rules[i];
+            if (!(rule->trigger & FSM_ON_EVENT) || !common_guards(rule, inst, event->posture, event->context, event->now_ms) ||
+                event->speed_mm_s < rule->min_speed_mm_s || event->speed_mm_s > rule->max_speed_mm_s ||
+                event->descent_mm_s < rule->min_descent_mm_s) {
+                continue;
+            }
+            // Guards on the previous event fail until there is one
+            if ((rule->prev_mask != FSM_ANY || rule->max_gap_ms != 0) && !inst->has_event) {
+                continue;
+            }
+            if (!posture_in(rule->prev_mask, inst->last_posture) || (rule->max_gap_ms != 0 && gap >= rule->max_gap_ms)) {
+                continue;
+            }
+            action = apply(inst, rule, event->now_ms);
+            break;
+        }
+    }
+    inst->last_ms = event->now_ms;
+    inst->last_posture = event->posture;
+    inst->has_event = 1;
+    return action;
+}
+
+uint8_t fsm_tick(const fsm_table_t *table, fsm_instance_t *inst, uint32_t now_ms, uint8_t context) {
+    if (!inst->has_event || inst->state >= table->state_count) {
+        return FSM_ACTION_NONE;
+    }
+    for (int i = table->first[inst->state]; i < table->first[inst->state + 1]; i++) {
+        const fsm_rule_t *rule = &table->rules[i];
+        // Timer rules guard on postures, context and durations only
+        if ((rule->trigger & FSM_ON_TIMER) && rule->prev_mask == FSM_ANY && rule->max_gap_ms == 0 &&
+            rule->min_speed_mm_s == 0 && rule->max_speed_mm_s == FSM_NO_LIMIT && rule->min_descent_mm_s == 0 &&
+            common_guards(rule, inst, inst->last_posture, context, now_ms)) {
+            return apply(inst, rule, now_ms);
+        }
+    }
+    return FSM_ACTION_NONE;
+}
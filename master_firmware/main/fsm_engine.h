@@ -0,0 +1,96 @@
+#ifndef FSM_ENGINE_H
+#define FSM_ENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radar_posture.h"
+
+// Small state-machine engine driven by constant rule tables (fall detection,
+// see fall_rules.c).
+//
+// A table is an array of fsm_rule_t sorted by `from` state. A rule fires when
+// its trigger matches and all its guards hold:
+// - posture of the event (or, on a timer tick, of the last event) in
+//   `posture_mask`, posture of the previous event in `prev_mask`;
+// - context of the event or tick in `context_mask`: a value 0..7 the owner
+//   attaches (the fall policy of the zone the person is in, for the fall
+//   rules);
+// - speed of the event in [min_speed, max_speed], its descent rate at least
+//   `min_descent_mm_s` (event rules only);
+// - time spent in `from` at least `min_in_state_ms` (a duration or a timer);
+// - time since the previous event below `max_gap_ms` (transition speed).
+// The first rule of the current state that matches is applied: the instance
+// moves to `to` and the rule's `action` is returned for the caller to carry
+// out. One rule at most per event or tick.
+//
+// An instance is the 12-byte fsm_instance_t: any number of them (one per
+// room, per person, ...) share one table. fsm_table_init() indexes the
+// rules by state once, so a dispatch only scans the rules of the current
+// state. Plain C, no allocation, no locking: instances belong to their task.
+
+#define FSM_MAX_STATES   16
+#define FSM_ANY          0           // posture_mask / prev_mask / context_mask: no guard
+#define FSM_NO_LIMIT     UINT16_MAX  // max_speed_mm_s: no guard
+
+#define FSM_ON_EVENT 0x01
+#define FSM_ON_TIMER 0x02
+#define FSM_ON_ANY   (FSM_ON_EVENT | FSM_ON_TIMER)
+
+#define FSM_ACTION_NONE 0
+
+#define FSM_CONTEXT_BIT(c) (1u << (c)) // For context_mask
+
+typedef struct {
+    uint8_t from, to;          // States
+    uint8_t trigger;           // FSM_ON_* bits
+    uint8_t action;            // Returned when the rule fires, FSM_ACTION_NONE for none
+    uint8_t posture_mask;      // RADAR_POSTURE_BIT() set, FSM_ANY
+    uint8_t prev_mask;         // Same, for the previous event
+    uint8_t context_mask;      // FSM_CONTEXT_BIT() set, FSM_ANY
+    uint16_t min_speed_mm_s;
+    uint16_t max_speed_mm_s;   // FSM_NO_LIMIT for none
+    uint16_t min_descent_mm_s; // 0 for none
+    uint32_t min_in_state_ms;  // 0 for none
+    uint32_t max_gap_ms;       // Time since the previous event must be below, 0 for none
+} fsm_rule_t;
+
+typedef struct {
+    const fsm_rule_t *rules;
+    uint8_t rule_count;
+    uint8_t state_count;
+    uint8_t first[FSM_MAX_STATES + 1]; // Rules of state s: [first[s], first[s + 1])
+} fsm_table_t;
+
+typedef struct {
+    uint32_t entered_ms;   // Entry in `state`
+    uint32_t last_ms;      // Previous event
+    uint8_t state;
+    uint8_t last_posture;  // radar_posture_t of the previous event
+    uint8_t has_event;     // last_ms / last_posture valid
+    uint8_t user;          // Free for the owner (e.g. a track id)
+} fsm_instance_t;
+
+typedef struct {
+    uint32_t now_ms;
+    uint16_t speed_mm_s;
+    uint16_t descent_mm_s; // Peak height drop rate (fall_features.h)
+    uint8_t posture;       // radar_posture_t
+    uint8_t context;       // 0..7, for context_mask
+} fsm_event_t;
+
+// Indexes `rules` by state. Returns false if they are not sorted by `from`
+// or name a state >= state_count (the table is then unusable).
+bool fsm_table_init(fsm_table_t *table, const fsm_rule_t *rules, uint8_t rule_count, uint8_t state_count);
+
+void fsm_instance_init(fsm_instance_t *inst, uint8_t state, uint32_t now_ms);
+
+// Applies the first matching FSM_ON_EVENT rule, then records the event as
+// the previous one. Returns the action of the rule, FSM_ACTION_NONE if none.
+uint8_t fsm_dispatch(const fsm_table_t *table, fsm_instance_t *inst, const fsm_event_t *event);
+
+// Applies the first matching FSM_ON_TIMER rule at `now_ms` in `context`,
+// posture guards applying to the last event (no rule fires before the first
+// event).
+uint8_t fsm_tick(const fsm_table_t *table, fsm_instance_t *inst, uint32_t now_ms, uint8_t context);
+
+#endif // FSM_ENGINE_H
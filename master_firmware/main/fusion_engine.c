@@ -0,0 +1,344 @@
+#include <string.h>
+#include "fusion_engine.h"
+
+#define LOC_ROOM(loc) ((uint8_t)((loc) - 1) >> 3)
+#define LOC_SLOT(loc) ((uint8_t)((loc) - 1) & 7)
+#define MAKE_LOC(room, slot) ((uint8_t)((((room) << 3) | (slot)) + 1))
+
+_Static_assert(FUSION_SLOTS_PER_ROOM == 8, "LOC_* macros use 3 slot bits");
+
+void fusion_engine_init(fusion_engine_t *fe, uint32_t window_ms, uint8_t default_quorum) {
+    memset(fe, 0, sizeof(*fe));
+    fe->window_ms = window_ms;
+    fe->default_quorum = default_quorum ? default_quorum : 1;
+}
+
+static int find_or_create_room(fusion_engine_t *fe, const char *room_name) {
+    for (int i = 0; i < fe->room_count; i++) {
+        if (strncmp(fe->rooms[i].name, room_name, FUSION_ROOM_NAME_LEN - 1) == 0) {
+            return i;
+        }
+    }
+    if (fe->room_count >= FUSION_MAX_ROOMS) {
+        return -1;
+    }
+    fusion_room_t *room = &fe->rooms[fe->room_count];
+    memset(room, 0, sizeof(*room));
+    strncpy(room->name, room_name, FUSION_ROOM_NAME_LEN - 1);
+    room->quorum = fe->default_quorum;
+    posture_hmm_init(&room->posture);
+    return fe->room_count++;
+}
+
+static void release_slot(fusion_engine_t *fe, uint8_t loc) {
+    fusion_room_t *room = &fe->rooms[LOC_ROOM(loc)];
+    uint8_t slot = LOC_SLOT(loc);
+    room->slots[slot].module_id = 0;
+    room->slots[slot].count = 0;
+    room->fresh_mask &= (uint8_t)~(1u << slot);
+}
+
+int fusion_engine_assign(fusion_engine_t *fe, int module_id, const char *room_name) {
+    if (module_id <= 0 || module_id > 255) {
+        return -1;
+    }
+    int room_index = find_or_create_room(fe, room_name ? room_name : "");
+    if (room_index < 0) {
+        return -1;
+    }
+    uint8_t loc = fe->loc_by_id[module_id];
+    if (loc && LOC_ROOM(loc) == room_index) {
+        return room_index;
+    }
+
+    fusion_room_t *room = &fe->rooms[room_index];
+    int slot = -1;
+    for (int i = 0; i < FUSION_SLOTS_PER_ROOM; i++) {
+        if (room->slots[i].module_id == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+    if (loc) {
+        release_slot(fe, loc);
+    }
+    memset(&room->slots[slot], 0, sizeof(room->slots[slot]));
+    room->slots[slot].module_id = (uint8_t)module_id;
+    if (slot >= room->slot_count) {
+        room->slot_count = (uint8_t)(slot + 1);
+    }
+    fe->loc_by_id[module_id] = MAKE_LOC(room_index, slot);
+    return room_index;
+}
+
+int fusion_engine_room_of(const fusion_engine_t *fe, int module_id) {
+    if (module_id <= 0 || module_id > 255 || fe->loc_by_id[module_id] == 0) {
+        return -1;
+    }
+    return LOC_ROOM(fe->loc_by_id[module_id]);
+}
+
+int fusion_engine_module_count(const fusion_engine_t *fe, int room) {
+    int count = 0;
+    for (int i = 0; room >= 0 && room < fe->room_count && i < fe->rooms[room].slot_count; i++) {
+        count += fe->rooms[room].slots[i].module_id != 0;
+    }
+    return count;
+}
+
+int fusion_engine_alive_count(const fusion_engine_t *fe, int room) {
+    return room >= 0 && room < fe->room_count ? __builtin_popcount(fe->rooms[room].alive_mask) : 0;
+}
+
+void fusion_engine_set_quorum(fusion_engine_t *fe, int room, uint8_t quorum) {
+    if (room < 0 || room >= fe->room_count) {
+        return;
+    }
+    if (quorum < 1) {
+        quorum = 1;
+    }
+    fe->rooms[room].quorum = quorum > FUSION_SLOTS_PER_ROOM ? FUSION_SLOTS_PER_ROOM : quorum;
+}
+
+static inline uint32_t master_time(const fusion_slot_t *s, const fusion_reading_t *r) {
+    return r->timestamp + (uint32_t)s->offset_ms;
+}
+
+static inline const fusion_reading_t *history_at(const fusion_slot_t *s, int age) {
+    return &s->history[(s->head + FUSION_HISTORY_LEN - age) % FUSION_HISTORY_LEN];
+}
+
+const fusion_reading_t *fusion_engine_history(const fusion_engine_t *fe, int module_id, int age) {
+    if (fusion_engine_room_of(fe, module_id) < 0) {
+        return NULL;
+    }
+    uint8_t loc = fe->loc_by_id[module_id];
+    const fusion_slot_t *s = &fe->rooms[LOC_ROOM(loc)].slots[LOC_SLOT(loc)];
+    return age >= 0 && age < s->count ? history_at(s, age) : NULL;
+}
+
+// Clock offset, jitter and window of `s` for a reading stamped `ts` (slave
+// clock) received at `now_ms`. Returns false for a reading older than the
+// newest one (duplicate or reordered).
+static bool update_timing(const fusion_engine_t *fe, fusion_slot_t *s, uint32_t ts, uint32_t now_ms) {
+    int32_t delay = (int32_t)(now_ms - ts);
+    int32_t ds = s->count ? (int32_t)(ts - history_at(s, 0)->timestamp) : 0;
+    if (s->count && ds <= 0 && ds > -(int32_t)FUSION_MAX_WINDOW_MS) {
+        return false;
+    }
+    if (s->count == 0 || ds <= 0 || ds > (int32_t)FUSION_MAX_WINDOW_MS) {
+        // First reading, slave restarted or silent for long: start over
+        s->count = 0;
+        s->intervals = 0;
+        s->interval_x8 = 0;
+        s->jitter_x16 = 0;
+        s->offset_ms = delay;
+    } else {
+        // RFC 3550: J += (|D| - J) / 16, D = arrival interval - sample interval
+        int32_t d = (int32_t)(now_ms - s->last_arrival_ms) - ds;
+        s->jitter_x16 += (uint32_t)(d < 0 ? -d : d);
+        s->jitter_x16 -= (s->jitter_x16 + 8) / 16;
+        s->interval_x8 = s->intervals ? s->interval_x8 + (uint32_t)ds - (s->interval_x8 + 4) / 8 : (uint32_t)ds * 8;
+        s->intervals += s->intervals < UINT8_MAX;
+        // Smallest transit delay; creeps up to follow a slave clock slower than ours
+        s->offset_ms = delay < s->offset_ms ? delay : s->offset_ms + (delay - s->offset_ms + 32) / 64;
+    }
+    s->last_arrival_ms = now_ms;
+
+    if (s->intervals < FUSION_MIN_INTERVALS) {
+        s->window_ms = fe->window_ms;
+    } else {
+        uint32_t interval = (s->interval_x8 + 4) / 8;
+        uint32_t margin = FUSION_JITTER_GAIN * ((s->jitter_x16 + 8) / 16);
+        uint32_t window = interval + (margin > interval / 4 ? margin : interval / 4);
+        s->window_ms = window < FUSION_MAX_WINDOW_MS ? window : FUSION_MAX_WINDOW_MS;
+    }
+    return true;
+}
+
+// r0 + (r1 - r0) * num / den, for num > den an extrapolation. Zero is "no
+// target": such values are not blended, the nearest one is kept.
+static uint16_t blend_mm(uint16_t v0, uint16_t v1, int32_t num, int32_t den, bool nearest_is_1) {
+    if (v0 == 0 || v1 == 0) {
+        return nearest_is_1 ? v1 : v0;
+    }
+    int32_t v = (int32_t)v0 + ((int32_t)v1 - (int32_t)v0) * num / den;
+    return v < 1 ? 1 : v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+static void blend(const fusion_reading_t *r0, const fusion_reading_t *r1, int32_t num, int32_t den,
+                  fusion_reading_t *out) {
+    bool nearest_is_1 = 2 * num >= den;
+    bool targets = (r0->flags & r1->flags & RADAR_MSG_HAS_TARGETS) != 0;
+    *out = nearest_is_1 ? *r1 : *r0; // Posture, signal and flags of the nearest reading
+    out->distance_mm = blend_mm(r0->distance_mm, r1->distance_mm, num, den, nearest_is_1);
+    if (targets) {
+        out->moving_mm = blend_mm(r0->moving_mm, r1->moving_mm, num, den, nearest_is_1);
+        out->static_mm = blend_mm(r0->static_mm, r1->static_mm, num, den, nearest_is_1);
+    }
+}
+
+// Reading of slot `s` at master time `t`: interpolated between the readings
+// around t, extrapolated from the last two when t is past the newest, the
+// nearest one when they are too far apart. False when no reading is within
+// the module window of t.
+static bool align_slot(const fusion_slot_t *s, uint32_t t, fusion_reading_t *out) {
+    const fusion_reading_t *after = NULL, *before = NULL, *prev = NULL;
+    for (int age = 0; age < s->count; age++) {
+        const fusion_reading_t *r = history_at(s, age);
+        if ((int32_t)(master_time(s, r) - t) > 0) {
+            after = r;
+            continue;
+        }
+        before = r;
+        prev = age + 1 < s->count ? history_at(s, age + 1) : NULL;
+        break;
+    }
+    int32_t window = (int32_t)s->window_ms;
+    if (before == NULL) {
+        if (after == NULL || (int32_t)(master_time(s, after) - t) > window) {
+            return false;
+        }
+        *out = *after;
+    } else if (after != NULL) {
+        int32_t gap = (int32_t)(after->timestamp - before->timestamp);
+        int32_t num = (int32_t)(t - master_time(s, before));
+        if (gap <= window) {
+            blend(before, after, num, gap, out);
+        } else if (2 * num >= gap ? gap - num <= window : num <= window) {
+            *out = 2 * num >= gap ? *after : *before;
+        } else {
+            return false;
+        }
+    } else {
+        int32_t age = (int32_t)(t - master_time(s, before));
+        int32_t gap = prev ? (int32_t)(before->timestamp - prev->timestamp) : 0;
+        if (age > window) {
+            return false;
+        }
+        if (age > 0 && gap > 0 && gap <= window) {
+            blend(prev, before, gap + age, gap, out);
+        } else {
+            *out = *before;
+        }
+    }
+    out->timestamp = t;
+    return true;
+}
+
+fusion_result_t fusion_engine_update(fusion_engine_t *fe, const RadarMessage *msg, uint32_t now_ms,
+                                     fusion_set_t *out) {
+    uint8_t loc = fe->loc_by_id[msg->module_id];
+    if (loc == 0) {
+        fe->rejected++;
+        return FUSION_REJECTED;
+    }
+    uint8_t room_index = LOC_ROOM(loc);
+    fusion_room_t *room = &fe->rooms[room_index];
+    uint8_t slot = LOC_SLOT(loc);
+    fusion_slot_t *s = &room->slots[slot];
+    if (!update_timing(fe, s, msg->timestamp, now_ms)) {
+        room->expired_count++;
+        return FUSION_STORED;
+    }
+
+    s->head = (uint8_t)((s->head + 1) % FUSION_HISTORY_LEN);
+    s->count += s->count < FUSION_HISTORY_LEN;
+    fusion_reading_t *reading = &s->history[s->head];
+    reading->timestamp = msg->timestamp;
+    reading->distance_mm = msg->distance_mm;
+    reading->moving_mm = msg->moving_mm;
+    reading->static_mm = msg->static_mm;
+    reading->module_id = s->module_id;
+    reading->posture = msg->posture;
+    reading->signal = msg->signal;
+    reading->flags = msg->flags;
+    room->fresh_mask |= (uint8_t)(1u << slot);
+
+    // Live modules and mode: below the quorum, fuse what is left
+    room->alive_mask = 0;
+    for (int i = 0; i < room->slot_count; i++) {
+        const fusion_slot_t *fs = &room->slots[i];
+        if (fs->module_id != 0 && (fs->count == 0 || now_ms - fs->last_arrival_ms <= FUSION_ABSENT_WINDOWS * fs->window_ms)) {
+            room->alive_mask |= (uint8_t)(1u << i);
+        }
+    }
+    uint8_t alive = (uint8_t)__builtin_popcount(room->alive_mask);
+    bool degraded = alive < room->quorum;
+    room->degraded_count += degraded && !room->degraded;
+    room->degraded = degraded;
+    uint8_t quorum = degraded ? alive : room->quorum;
+
+    // Newest fresh reading of the room: the others must be within their
+    // module window of it. Signed differences keep this correct across the
+    // 32-bit ms wrap.
+    uint32_t newest = master_time(s, reading);
+    for (uint8_t mask = room->fresh_mask; mask; mask &= (uint8_t)(mask - 1)) {
+        const fusion_slot_t *fs = &room->slots[__builtin_ctz(mask)];
+        uint32_t t = master_time(fs, history_at(fs, 0));
+        if ((int32_t)(t - newest) > 0) {
+            newest = t;
+        }
+    }
+    uint8_t count = 0;
+    uint32_t ref = newest;
+    for (uint8_t mask = room->fresh_mask; mask; mask &= (uint8_t)(mask - 1)) {
+        int i = __builtin_ctz(mask);
+        const fusion_slot_t *fs = &room->slots[i];
+        uint32_t t = master_time(fs, history_at(fs, 0));
+        if (newest - t > fs->window_ms) {
+            room->fresh_mask &= (uint8_t)~(1u << i);
+            room->expired_count++;
+        } else {
+            count++;
+            ref = (int32_t)(t - ref) < 0 ? t : ref;
+        }
+    }
+    if (count < quorum) {
+        return FUSION_STORED;
+    }
+    // Sets leave in time order, even when a clock offset estimate moved back
+    if (room->fused_count && (int32_t)(ref - room->ref_ms) <= 0) {
+        ref = room->ref_ms + 1;
+    }
+
+    out->room = room_index;
+    out->count = 0;
+    out->slot_mask = 0;
+    out->extrapolated_mask = 0;
+    out->degraded = degraded;
+    out->timestamp = ref;
+    posture_votes_t votes;
+    posture_votes_init(&votes);
+    for (int i = 0; i < room->slot_count; i++) {
+        const fusion_slot_t *fs = &room->slots[i];
+        fusion_reading_t *r = &out->readings[out->count];
+        bool fresh = (room->fresh_mask >> i) & 1;
+        if (fs->module_id == 0 || fs->count == 0) {
+            continue;
+        }
+        if (!align_slot(fs, ref, r)) {
+            if (!fresh) {
+                continue; // Late module, nothing recent enough
+            }
+            *r = *history_at(fs, 0);
+            r->timestamp = ref;
+        }
+        if (!fresh && (int32_t)(ref - master_time(fs, history_at(fs, 0))) > 0) {
+            out->extrapolated_mask |= (uint8_t)(1u << i);
+        }
+        out->slot_mask |= (uint8_t)(1u << i);
+        float weight = posture_vote_weight(r->signal, r->distance_mm);
+        posture_votes_add(&votes, (radar_posture_t)r->posture, fresh ? weight : 0.5f * weight);
+        out->count++;
+    }
+    out->posture = posture_hmm_step(&room->posture, &votes);
+    posture_hmm_percent(&room->posture, out->posture_pct);
+    room->fresh_mask = 0;
+    room->ref_ms = ref;
+    room->fused_count++;
+    return FUSION_FUSED;
+}
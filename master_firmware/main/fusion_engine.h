@@ -0,0 +1,163 @@
+#ifndef FUSION_ENGINE_H
+#define FUSION_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pipeline_msgs.h"
+#include "posture_hmm.h"
+
+// Fusion core of the FusionEngine task: groups the radar modules by room and
+// fuses the fresh readings of a room once enough of them agree in time.
+//
+// Each room owns a small fixed array of per-module slots. A module id maps to
+// its (room, slot) through a 256-entry table, so an incoming sample costs one
+// lookup plus a pass over the slots of its own room (at most
+// FUSION_SLOTS_PER_ROOM), whatever the number of rooms.
+//
+// Time alignment. Slaves stamp their samples with their own clock, so every
+// module keeps an offset to the master clock (the smallest transit delay
+// seen, following drift slowly) and its last FUSION_HISTORY_LEN readings.
+// It also measures its inter-arrival jitter (RFC 3550 estimator) and mean
+// sample interval; its sync window is interval + FUSION_JITTER_GAIN x jitter
+// (at least interval / 4), `window_ms` until FUSION_MIN_INTERVALS intervals
+// have been seen.
+//
+// A reading is fresh until it is used by a fused output or until the room
+// has a reading newer than it by more than its module window. When a room
+// holds at least `quorum` fresh readings, they are fused at a common
+// reference time, the oldest fresh reading: newer readings are interpolated
+// back to it from their history, and modules of the room late for this
+// round are extrapolated from their last two readings, within their window.
+// A phase offset between slaves therefore no longer starves the fusion, it
+// only delays the output by up to one sample interval. With two modules and
+// a quorum of 2 this is the former sensor1/sensor2 pairing.
+//
+// Degraded mode. A module silent for FUSION_ABSENT_WINDOWS of its windows is
+// absent. When fewer modules than the quorum are left, the room is degraded:
+// it fuses whatever its live modules send (down to one), and every set says
+// so. The room enters degraded mode at the first reading of a live module
+// after that deadline, at most FUSION_ABSENT_WINDOWS x FUSION_MAX_WINDOW_MS
+// after the last reading of the absent one, and leaves it at the first
+// reading of the returning module.
+//
+// Posture. Every set steps the posture filter of its room (posture_hmm.c):
+// each reading votes with its signal and detection distance, readings of
+// modules late for the round with half the weight (their posture was
+// counted by the previous set already).
+//
+// Plain C, no locking. On the master each room belongs to the FusionEngine
+// task of its shard (pipeline_shard.h); fusion_engine_assign() runs with
+// every shard locked.
+
+#define FUSION_MAX_ROOMS       16
+#define FUSION_SLOTS_PER_ROOM  8
+#define FUSION_ROOM_NAME_LEN   16
+#define FUSION_DEFAULT_QUORUM  2
+#define FUSION_HISTORY_LEN     4     // Readings kept per module for alignment
+#define FUSION_JITTER_GAIN     4     // Window = interval + 4 x jitter
+#define FUSION_MIN_INTERVALS   4     // Intervals measured before the window adapts
+#define FUSION_MAX_WINDOW_MS   2000
+#define FUSION_ABSENT_WINDOWS  3     // Silent for 3 windows: module absent
+
+typedef struct {
+    uint32_t timestamp;    // Sample timestamp, ms
+    uint16_t distance_mm;
+    uint16_t moving_mm;    // LD2410 targets, valid when flags & RADAR_MSG_HAS_TARGETS
+    uint16_t static_mm;
+    uint8_t module_id;     // 0 = free slot
+    uint8_t posture;       // radar_posture_t
+    uint8_t signal;
+    uint8_t flags;         // RadarMessage flags
+} fusion_reading_t;
+
+// One module of a room. Timestamps in `history` are slave clock; add
+// `offset_ms` for the master clock.
+typedef struct {
+    uint8_t module_id;         // 0 = free slot
+    uint8_t head;              // history[head] is the newest reading
+    uint8_t count;             // Readings in history
+    uint8_t intervals;         // Intervals measured (saturated)
+    int32_t offset_ms;         // Master clock - slave clock
+    uint32_t last_arrival_ms;  // Master clock at the newest reading
+    uint32_t interval_x8;      // Mean sample interval, ms x 8
+    uint32_t jitter_x16;       // Inter-arrival jitter, ms x 16
+    uint32_t window_ms;        // Sync window of the module
+    fusion_reading_t history[FUSION_HISTORY_LEN];
+} fusion_slot_t;
+
+typedef struct {
+    char name[FUSION_ROOM_NAME_LEN];
+    uint8_t quorum;
+    uint8_t slot_count;
+    uint8_t fresh_mask;    // Bit i: the newest reading of slots[i] is unused
+    uint8_t alive_mask;    // Bit i: slots[i] not absent (or not heard from yet)
+    bool degraded;         // Fewer live modules than the quorum
+    uint32_t degraded_count; // Entries in degraded mode
+    uint32_t ref_ms;       // Reference time of the last fused set, master clock
+    posture_hmm_t posture; // Room posture filter, stepped by every fused set
+    uint32_t fused_count;
+    uint32_t expired_count; // Readings dropped without being fused (too old, out of order)
+    fusion_slot_t slots[FUSION_SLOTS_PER_ROOM];
+} fusion_room_t;
+
+typedef struct {
+    uint8_t loc_by_id[256]; // (room << 3 | slot) + 1, 0 = unassigned
+    uint8_t room_count;
+    uint32_t window_ms;     // Sync window of modules whose jitter is not measured yet
+    uint8_t default_quorum;
+    uint32_t rejected;      // Samples of unassigned modules
+    fusion_room_t rooms[FUSION_MAX_ROOMS];
+} fusion_engine_t;
+
+_Static_assert(FUSION_MAX_ROOMS * FUSION_SLOTS_PER_ROOM <= 255, "loc_by_id is a u8");
+
+// Readings fused together, in slot order, all aligned on `timestamp`.
+typedef struct {
+    uint8_t room;
+    uint8_t count;
+    uint8_t slot_mask;      // Bit i: the set includes the reading of slot i
+    uint8_t extrapolated_mask; // Bit i: no reading of slot i after `timestamp`, extrapolated
+    bool degraded;          // Fused below the room quorum
+    uint32_t timestamp;     // Reference time, master clock
+    radar_posture_t posture; // Most likely room posture after this set
+    uint8_t posture_pct[RADAR_POSTURE_COUNT]; // Room posture probabilities, percent
+    fusion_reading_t readings[FUSION_SLOTS_PER_ROOM];
+} fusion_set_t;
+
+typedef enum {
+    FUSION_STORED = 0,  // Reading kept, quorum not reached
+    FUSION_FUSED,       // `out` holds a fused set
+    FUSION_REJECTED,    // Module not assigned to a room
+} fusion_result_t;
+
+void fusion_engine_init(fusion_engine_t *fe, uint32_t window_ms, uint8_t default_quorum);
+
+// Puts `module_id` in room `room_name` (created on first use, "" is a valid
+// name). A module already in another room is moved. Returns the room index,
+// or -1 if the id is invalid, there are FUSION_MAX_ROOMS rooms already or the
+// room has no free slot. O(rooms): call it when a module appears or moves.
+int fusion_engine_assign(fusion_engine_t *fe, int module_id, const char *room_name);
+
+// Room index of `module_id`, -1 if unassigned. O(1).
+int fusion_engine_room_of(const fusion_engine_t *fe, int module_id);
+
+// Modules assigned to a room and live ones among them.
+int fusion_engine_module_count(const fusion_engine_t *fe, int room);
+int fusion_engine_alive_count(const fusion_engine_t *fe, int room);
+
+// Reading of `module_id` stored `age` readings ago (0 = newest), NULL if
+// there is none. Slave clock timestamp. O(1).
+const fusion_reading_t *fusion_engine_history(const fusion_engine_t *fe, int module_id, int age);
+
+// Quorum of a room, clamped to 1..FUSION_SLOTS_PER_ROOM.
+void fusion_engine_set_quorum(fusion_engine_t *fe, int room, uint8_t quorum);
+
+// Stores `msg`, received at `now_ms` (master clock), in its module slot and
+// fuses the room when the quorum is met, or when all its live modules have
+// a fresh reading in degraded mode. `rooms[room].degraded` may change on any
+// call.
+fusion_result_t fusion_engine_update(fusion_engine_t *fe, const RadarMessage *msg, uint32_t now_ms,
+                                     fusion_set_t *out);
+
+#endif // FUSION_ENGINE_H
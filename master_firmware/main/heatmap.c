@@ -0,0 +1,157 @@
+#include <math.h>
+#include <string.h>
+#include "heatmap.h"
+
+// The scale is recomputed at most once per this fraction of a half-life:
+// outputs of the same instant share it (error below 0.07 %)
+#define WEIGHT_STEP_DIVISOR 1024u
+
+uint32_t heatmap_cells_needed(int16_t min_x_mm, int16_t min_y_mm, int16_t max_x_mm, int16_t max_y_mm,
+                              uint16_t cell_mm) {
+    if (cell_mm == 0 || max_x_mm <= min_x_mm || max_y_mm <= min_y_mm) {
+        return 0;
+    }
+    int32_t cols = ((int32_t)max_x_mm - min_x_mm + cell_mm - 1) / cell_mm;
+    int32_t rows = ((int32_t)max_y_mm - min_y_mm + cell_mm - 1) / cell_mm;
+    return cols > 255 || rows > 255 ? 0 : (uint32_t)(cols * rows);
+}
+
+bool heatmap_init(heatmap_t *hm, float *cells, uint32_t capacity, int16_t min_x_mm, int16_t min_y_mm,
+                  int16_t max_x_mm, int16_t max_y_mm, uint16_t cell_mm, uint32_t half_life_ms, uint32_t now_ms) {
+    memset(hm, 0, sizeof(*hm));
+    uint32_t needed = heatmap_cells_needed(min_x_mm, min_y_mm, max_x_mm, max_y_mm, cell_mm);
+    if (cells == NULL || needed == 0 || needed > capacity || half_life_ms == 0 ||
+        half_life_ms > HEATMAP_MAX_HALF_LIFE_MS) {
+        return false;
+    }
+    hm->min_x_mm = min_x_mm;
+    hm->min_y_mm = min_y_mm;
+    hm->cell_mm = cell_mm;
+    hm->cols = (uint8_t)(((int32_t)max_x_mm - min_x_mm + cell_mm - 1) / cell_mm);
+    hm->rows = (uint8_t)(needed / hm->cols);
+    hm->half_life_ms = half_life_ms;
+    hm->epoch_ms = now_ms;
+    hm->cells = cells;
+    hm->weight = 1.0f;
+    hm->weight_ms = now_ms;
+    atomic_init(&hm->rescales, 0);
+    memset(cells, 0, needed * sizeof(float));
+    return true;
+}
+
+// Divides the cells by 2^k, k whole half-lives since the epoch, and moves the
+// epoch forward by as much
+static void rescale(heatmap_t *hm, uint32_t age_ms) {
+    uint32_t k = age_ms / hm->half_life_ms;
+    float factor = ldexpf(1.0f, -(int)k);
+    uint32_t count = (uint32_t)hm->cols * hm->rows;
+    atomic_fetch_add_explicit(&hm->rescales, 1, memory_order_acq_rel);
+    for (uint32_t i = 0; i < count; i++) {
+        hm->cells[i] *= factor;
+    }
+    hm->epoch_ms += k * hm->half_life_ms;
+    atomic_fetch_add_explicit(&hm->rescales, 1, memory_order_acq_rel);
+}
+
+void heatmap_add(heatmap_t *hm, int16_t x_mm, int16_t y_mm, uint32_t dwell_ms, uint32_t now_ms) {
+    if (x_mm < hm->min_x_mm || y_mm < hm->min_y_mm) {
+        hm->outside++;
+        return;
+    }
+    uint32_t c = (uint32_t)(x_mm - hm->min_x_mm) / hm->cell_mm, r = (uint32_t)(y_mm - hm->min_y_mm) / hm->cell_mm;
+    if (c >= hm->cols || r >= hm->rows) {
+        hm->outside++;
+        return;
+    }
+    int32_t age = (int32_t)(now_ms - hm->epoch_ms);
+    if (age >= (int32_t)(HEATMAP_RESCALE_HALF_LIVES * hm->half_life_ms)) {
+        rescale(hm, (uint32_t)age);
+        age = (int32_t)(now_ms - hm->epoch_ms);
+        hm->weight_ms = now_ms - hm->half_life_ms; // Forces the recomputation below
+    }
+    // Outputs of several tracks interleave: `now_ms` may go back a little
+    int32_t since = (int32_t)(now_ms - hm->weight_ms);
+    if ((since < 0 ? -since : since) >= (int32_t)(hm->half_life_ms / WEIGHT_STEP_DIVISOR)) {
+        hm->weight = exp2f((float)age / (float)hm->half_life_ms);
+        hm->weight_ms = now_ms;
+    }
+    hm->cells[r * hm->cols + c] += (float)dwell_ms * hm->weight;
+    hm->updates++;
+}
+
+float heatmap_cell_ms(const heatmap_t *hm, int col, int row, uint32_t now_ms) {
+    if (col < 0 || row < 0 || col >= hm->cols || row >= hm->rows) {
+        return 0.0f;
+    }
+    int32_t age = (int32_t)(now_ms - hm->epoch_ms);
+    return hm->cells[row * hm->cols + col] * exp2f(-(float)age / (float)hm->half_life_ms);
+}
+
+static float tile_sum(const heatmap_t *hm, int tc, int tr, uint8_t tile) {
+    float sum = 0.0f;
+    int c1 = (tc + 1) * tile < hm->cols ? (tc + 1) * tile : hm->cols;
+    int r1 = (tr + 1) * tile < hm->rows ? (tr + 1) * tile : hm->rows;
+    for (int r = tr * tile; r < r1; r++) {
+        for (int c = tc * tile; c < c1; c++) {
+            sum += hm->cells[r * hm->cols + c];
+        }
+    }
+    return sum;
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+int heatmap_export(const heatmap_t *hm, uint8_t room, uint8_t tile, uint32_t now_ms, uint8_t *buf, size_t len) {
+    if (tile == 0) {
+        return 0;
+    }
+    int tcols = (hm->cols + tile - 1) / tile, trows = (hm->rows + tile - 1) / tile;
+    size_t total = HEATMAP_EXPORT_HEADER_LEN + (size_t)tcols * trows;
+    if (len < total) {
+        return 0;
+    }
+    unsigned before = atomic_load_explicit(&hm->rescales, memory_order_acquire);
+    if (before & 1u) {
+        return -1;
+    }
+    uint32_t epoch_ms = hm->epoch_ms;
+    // Max first, then each tile against it: two passes over the cells
+    // instead of a buffer of tile sums
+    float max = 0.0f;
+    for (int tr = 0; tr < trows; tr++) {
+        for (int tc = 0; tc < tcols; tc++) {
+            float sum = tile_sum(hm, tc, tr, tile);
+            max = sum > max ? sum : max;
+        }
+    }
+    uint8_t *out = buf + HEATMAP_EXPORT_HEADER_LEN;
+    for (int tr = 0; tr < trows; tr++) {
+        for (int tc = 0; tc < tcols; tc++) {
+            float sum = tile_sum(hm, tc, tr, tile);
+            *out++ = max > 0.0f ? (uint8_t)(255.0f * (sum > max ? max : sum) / max + 0.5f) : 0;
+        }
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&hm->rescales, memory_order_relaxed) != before) {
+        return -1;
+    }
+
+    float max_ms = max * exp2f(-(float)(int32_t)(now_ms - epoch_ms) / (float)hm->half_life_ms);
+    memcpy(buf, HEATMAP_EXPORT_MAGIC, 2);
+    buf[2] = HEATMAP_EXPORT_VERSION;
+    buf[3] = room;
+    buf[4] = (uint8_t)tcols;
+    buf[5] = (uint8_t)trows;
+    put_u16(buf + 6, (uint16_t)(hm->cell_mm * tile > UINT16_MAX ? UINT16_MAX : hm->cell_mm * tile));
+    put_u32(buf + 8, max_ms >= 4294967040.0f ? UINT32_MAX : (uint32_t)(max_ms + 0.5f));
+    put_u32(buf + 12, hm->half_life_ms / 1000u);
+    return (int)total;
+}
@@ -0,0 +1,76 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Occupancy heatmap of one room: where people spend their time.
+//
+// A fixed grid over the room bounds; every fused position adds the time the
+// person spent there (ms since the previous output of the person) to its
+// cell. Older time fades with a half-life: a cell holds the time spent,
+// each ms counting 2^(-age / half_life).
+//
+// Decay without touching every cell: a cell stores its time scaled by
+// 2^((t - epoch) / half_life), so an update is one multiply-add whatever the
+// grid. Once the scale reaches 2^HEATMAP_RESCALE_HALF_LIVES, the cells are
+// divided back and the epoch moved forward, O(cells) once per
+// HEATMAP_RESCALE_HALF_LIVES half-lives.
+//
+// heatmap_export() downsamples the grid into tiles of k x k cells and writes
+// a compact binary array (HEATMAP_EXPORT_HEADER_LEN bytes of header, one byte
+// per tile). The cells come from a buffer given by the caller: the memory of
+// a room is cols x rows floats, no more.
+//
+// One writer (the FallDetector task of the room), no locking. The export may
+// run in another task: cells are 32-bit words, and a rescale during the read
+// is detected (odd or changed `rescales`) and reported for a retry.
+
+#define HEATMAP_RESCALE_HALF_LIVES 16
+#define HEATMAP_MAX_HALF_LIFE_MS   (24u * 3600u * 1000u) // Rescales well before the ms clock wraps
+#define HEATMAP_EXPORT_HEADER_LEN  16
+#define HEATMAP_EXPORT_MAGIC       "HM"
+#define HEATMAP_EXPORT_VERSION     1
+
+typedef struct {
+    int16_t min_x_mm, min_y_mm;
+    uint16_t cell_mm;
+    uint8_t cols, rows;
+    uint32_t half_life_ms;
+    uint32_t epoch_ms;        // Instant of scale 1
+    float *cells;             // cols x rows, row-major
+    float weight;             // Scale of an update at weight_ms
+    uint32_t weight_ms;
+    atomic_uint rescales;     // Odd while the cells are being rescaled
+    uint32_t updates;
+    uint32_t outside;         // Positions off the grid, not counted
+} heatmap_t;
+
+// Grid of `cell_mm` cells over [min, max) (mm). False on a bad argument or if
+// the grid needs more than `capacity` cells (or 255 cells a side).
+bool heatmap_init(heatmap_t *hm, float *cells, uint32_t capacity, int16_t min_x_mm, int16_t min_y_mm,
+                  int16_t max_x_mm, int16_t max_y_mm, uint16_t cell_mm, uint32_t half_life_ms, uint32_t now_ms);
+
+// Cells a grid needs (for sizing the buffer), 0 if it cannot be built
+uint32_t heatmap_cells_needed(int16_t min_x_mm, int16_t min_y_mm, int16_t max_x_mm, int16_t max_y_mm,
+                              uint16_t cell_mm);
+
+// `dwell_ms` spent at (x_mm, y_mm) up to `now_ms`
+void heatmap_add(heatmap_t *hm, int16_t x_mm, int16_t y_mm, uint32_t dwell_ms, uint32_t now_ms);
+
+// Decayed time (ms) in cell (col, row) at `now_ms`
+float heatmap_cell_ms(const heatmap_t *hm, int col, int row, uint32_t now_ms);
+
+// Binary export at `now_ms`, tiles of `tile` x `tile` cells (little-endian):
+//   0  "HM", version, room
+//   4  tile columns, tile rows, tile size (mm, uint16)
+//   8  time in the fullest tile (ms, uint32)
+//   12 half-life (s, uint32)
+//   16 one byte per tile, row-major: 255 * tile time / fullest tile time
+// Returns the bytes written, 0 if `len` is too small or `tile` is 0, -1 if a
+// rescale ran during the read (try again).
+int heatmap_export(const heatmap_t *hm, uint8_t room, uint8_t tile, uint32_t now_ms, uint8_t *buf, size_t len);
+
+#endif // HEATMAP_H
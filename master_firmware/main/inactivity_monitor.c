@@ -0,0 +1,122 @@
+#include <string.h>
+#include "inactivity_monitor.h"
+
+// Farthest alert instant, so that the signed comparison with the clock holds
+#define MAX_DELAY_MS 0x3FFFFFFFu
+
+void inactivity_room_init(inactivity_room_t *room) {
+    memset(room, 0, sizeof(*room));
+    room->weight_pct = INACTIVITY_WEIGHT_DEFAULT;
+}
+
+static bool is_night(const inactivity_config_t *cfg, int minute_of_day) {
+    if (minute_of_day < 0 || cfg->night_start_min == cfg->night_end_min) {
+        return false;
+    }
+    if (cfg->night_start_min < cfg->night_end_min) {
+        return minute_of_day >= cfg->night_start_min && minute_of_day < cfg->night_end_min;
+    }
+    return minute_of_day >= cfg->night_start_min || minute_of_day < cfg->night_end_min;
+}
+
+uint16_t inactivity_weight_pct(const inactivity_config_t *cfg, uint16_t zone_pct, uint8_t posture,
+                               int minute_of_day) {
+    if (zone_pct != 0) {
+        return zone_pct;
+    }
+    if (posture == RADAR_POSTURE_LYING) {
+        return cfg->lying_pct;
+    }
+    return is_night(cfg, minute_of_day) ? cfg->night_pct : INACTIVITY_WEIGHT_DEFAULT;
+}
+
+// Instant of the next level, from the last motion and the current weight
+static void schedule(const inactivity_config_t *cfg, inactivity_room_t *room) {
+    if (room->level >= INACTIVITY_LEVELS) {
+        return;
+    }
+    uint64_t delay_ms = (uint64_t)cfg->level_s[room->level] * 10u * room->weight_pct;
+    room->due_ms = room->last_motion_ms + (delay_ms > MAX_DELAY_MS ? MAX_DELAY_MS : (uint32_t)delay_ms);
+}
+
+// Postures whose changes count as motion; STILL and UNKNOWN say nothing
+static bool is_body_posture(uint8_t posture) {
+    return posture == RADAR_POSTURE_STANDING || posture == RADAR_POSTURE_SITTING || posture == RADAR_POSTURE_LYING;
+}
+
+static void follow(inactivity_room_t *room, const FusedData *data, bool measured) {
+    room->anchor_track = data->track_id;
+    room->anchor_posture = data->posture;
+    room->anchor_x_mm = data->x_mm;
+    room->anchor_y_mm = data->y_mm;
+    room->has_anchor_position = measured;
+    room->anchor_ms = data->timestamp;
+}
+
+uint8_t inactivity_update(const inactivity_config_t *cfg, inactivity_room_t *room, const FusedData *data,
+                          uint16_t weight_pct) {
+    const uint32_t now_ms = data->timestamp;
+    // Predicted positions drift and a new track has no velocity yet
+    const bool measured = data->sigma_cm != FUSED_SIGMA_UNKNOWN &&
+                          (data->flags & (FUSED_FLAG_PREDICTED | FUSED_FLAG_NEW_TRACK)) == 0;
+    bool moved = false;
+
+    if (!room->armed) {
+        // Someone arrives: that is motion
+        room->armed = true;
+        room->level = 0;
+        follow(room, data, measured);
+        moved = true;
+    } else if (data->track_id == room->anchor_track) {
+        if (is_body_posture(data->posture)) {
+            moved = is_body_posture(room->anchor_posture) && data->posture != room->anchor_posture;
+            room->anchor_posture = data->posture;
+        }
+        if (measured && room->has_anchor_position) {
+            int32_t dx = (int32_t)data->x_mm - room->anchor_x_mm, dy = (int32_t)data->y_mm - room->anchor_y_mm;
+            moved = moved || dx * dx + dy * dy >= (int32_t)cfg->motion_mm * cfg->motion_mm;
+        }
+        if (moved || (measured && !room->has_anchor_position)) {
+            follow(room, data, measured);
+        }
+        room->anchor_ms = now_ms;
+    } else if ((int32_t)(now_ms - room->anchor_ms) >= INACTIVITY_ANCHOR_STALE_MS) {
+        follow(room, data, measured);
+    }
+    moved = moved || data->posture == RADAR_POSTURE_MOVING;
+    if (measured) {
+        int32_t vx = data->vx_mm_s, vy = data->vy_mm_s;
+        moved = moved || vx * vx + vy * vy >= (int32_t)cfg->motion_speed_mm_s * cfg->motion_speed_mm_s;
+    }
+
+    uint8_t ended = 0;
+    if (moved) {
+        ended = room->level;
+        room->level = 0;
+        room->last_motion_ms = now_ms;
+    }
+    room->last_seen_ms = now_ms;
+    room->weight_pct = weight_pct;
+    schedule(cfg, room);
+    return ended;
+}
+
+uint8_t inactivity_check(const inactivity_config_t *cfg, inactivity_room_t *room, uint32_t now_ms) {
+    if (!room->armed) {
+        return 0;
+    }
+    if ((int32_t)(now_ms - room->last_seen_ms) >= (int32_t)cfg->absent_ms) {
+        room->armed = false;
+        return 0;
+    }
+    if (room->level >= INACTIVITY_LEVELS || (int32_t)(now_ms - room->due_ms) < 0) {
+        return 0;
+    }
+    room->level++;
+    schedule(cfg, room);
+    return room->level;
+}
+
+uint32_t inactivity_still_ms(const inactivity_room_t *room, uint32_t now_ms) {
+    return room->armed ? now_ms - room->last_motion_ms : 0;
+}
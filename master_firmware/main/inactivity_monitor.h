@@ -0,0 +1,75 @@
+#ifndef INACTIVITY_MONITOR_H
+#define INACTIVITY_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pipeline_msgs.h"
+
+// Long immobility of the people of a room: a slow collapse never shows the
+// fast transition to LYING the fall rules look for, but it ends with someone
+// who no longer moves.
+//
+// Per room, the time since the last significant motion: a measured track
+// speed above a threshold, a MOVING posture, a displacement of the followed
+// person away from where they last moved, or a change of their posture
+// (standing, sitting, lying). Each fused output is one O(1) update, no
+// history is kept. Graded alerts are raised when the stillness reaches
+// level_s[0], level_s[1], ... scaled by a weight: the zone the person is in
+// (a bed allows longer, a shower shorter), lying outside a weighted zone
+// (shorter), the night (longer). The next alert instant is kept up to date,
+// so the timer only compares it with the clock.
+//
+// Plain C, no allocation, no locking: a room is updated and checked by the
+// FallDetector task of its shard.
+
+#define INACTIVITY_LEVELS         3
+#define INACTIVITY_WEIGHT_DEFAULT 100  // Percent
+#define INACTIVITY_ANCHOR_STALE_MS 5000 // Followed person unseen this long: the next one is followed
+
+typedef struct {
+    uint32_t level_s[INACTIVITY_LEVELS]; // Stillness before each level at weight 100 %, increasing
+    uint16_t motion_speed_mm_s;          // Measured track speed counted as motion
+    uint16_t motion_mm;                  // Displacement of the followed person counted as motion
+    uint16_t lying_pct;                  // Weight while lying outside a weighted zone
+    uint16_t night_pct;                  // Weight at night, upright outside a weighted zone
+    uint16_t night_start_min;            // Night from this minute of the day...
+    uint16_t night_end_min;              // ...to this one (may wrap past midnight)
+    uint32_t absent_ms;                  // No output for this long: room empty, monitor disarmed
+} inactivity_config_t;
+
+typedef struct {
+    uint32_t last_motion_ms;
+    uint32_t last_seen_ms;    // Last output of the room
+    uint32_t anchor_ms;       // Last output of the followed person
+    uint32_t due_ms;          // Next level raised at this instant (level < INACTIVITY_LEVELS)
+    int16_t anchor_x_mm, anchor_y_mm; // Where the followed person last moved
+    uint16_t weight_pct;
+    uint8_t anchor_track;     // Followed person (FUSED_TRACK_NONE: room-level outputs)
+    uint8_t anchor_posture;
+    uint8_t level;            // Levels raised since the last motion
+    bool armed;               // Someone in the room
+    bool has_anchor_position;
+} inactivity_room_t;
+
+void inactivity_room_init(inactivity_room_t *room);
+
+// Weight of the thresholds (percent): `zone_pct` if the person is in a
+// weighted zone (non-zero), else `lying_pct` when lying, else `night_pct` at
+// night. `minute_of_day` < 0: clock not set, day assumed.
+uint16_t inactivity_weight_pct(const inactivity_config_t *cfg, uint16_t zone_pct, uint8_t posture,
+                               int minute_of_day);
+
+// One fused output of the room, `weight_pct` computed for its person. Returns
+// the level reached before this output if it ends the stillness (motion after
+// an alert), else 0.
+uint8_t inactivity_update(const inactivity_config_t *cfg, inactivity_room_t *room, const FusedData *data,
+                          uint16_t weight_pct);
+
+// Level raised at `now_ms` (1..INACTIVITY_LEVELS), 0 if none is due. One level
+// per call; disarms the room once it stops sending outputs.
+uint8_t inactivity_check(const inactivity_config_t *cfg, inactivity_room_t *room, uint32_t now_ms);
+
+// Time without significant motion at `now_ms`, 0 if the room is not armed
+uint32_t inactivity_still_ms(const inactivity_room_t *room, uint32_t now_ms);
+
+#endif // INACTIVITY_MONITOR_H
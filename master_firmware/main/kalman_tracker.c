@@ -0,0 +1,148 @@
+#include <math.h>
+#include <string.h>
+#include "kalman_tracker.h"
+
+void kalman_track_init(kalman_track_t *t, float accel_sigma) {
+    memset(t, 0, sizeof(*t));
+    t->accel_sigma = accel_sigma > 0.0f ? accel_sigma : KALMAN_DEFAULT_ACCEL_SIGMA;
+}
+
+// Measurement covariance with the noise floor applied
+static void meas_cov(const kalman_meas_t *m, float *rxx, float *rxy, float *ryy) {
+    const float min_var = KALMAN_MIN_MEAS_SIGMA_M * KALMAN_MIN_MEAS_SIGMA_M;
+    *rxx = m->cov_xx > min_var ? m->cov_xx : min_var;
+    *ryy = m->cov_yy > min_var ? m->cov_yy : min_var;
+    *rxy = m->cov_xy;
+}
+
+static void start(kalman_track_t *t, uint32_t now_ms, const kalman_meas_t *m) {
+    float rxx, rxy, ryy;
+    meas_cov(m, &rxx, &rxy, &ryy);
+    memset(t->s, 0, sizeof(t->s));
+    memset(t->P, 0, sizeof(t->P));
+    t->s[0] = m->x;
+    t->s[1] = m->y;
+    t->P[0][0] = rxx;
+    t->P[0][1] = t->P[1][0] = rxy;
+    t->P[1][1] = ryy;
+    t->P[2][2] = t->P[3][3] = KALMAN_INITIAL_SPEED_SIGMA * KALMAN_INITIAL_SPEED_SIGMA;
+    t->time_ms = t->last_update_ms = now_ms;
+    t->active = true;
+    t->rejects_in_row = 0;
+    t->starts++;
+}
+
+// s = F s, P = F P F^T + Q with F = [I dt*I; 0 I]
+static void predict(kalman_track_t *t, float dt) {
+    t->s[0] += dt * t->s[2];
+    t->s[1] += dt * t->s[3];
+
+    float A[4][4];
+    for (int j = 0; j < 4; j++) { // A = F P
+        A[0][j] = t->P[0][j] + dt * t->P[2][j];
+        A[1][j] = t->P[1][j] + dt * t->P[3][j];
+        A[2][j] = t->P[2][j];
+        A[3][j] = t->P[3][j];
+    }
+    for (int i = 0; i < 4; i++) { // P = A F^T
+        t->P[i][0] = A[i][0] + dt * A[i][2];
+        t->P[i][1] = A[i][1] + dt * A[i][3];
+        t->P[i][2] = A[i][2];
+        t->P[i][3] = A[i][3];
+    }
+
+    float q = t->accel_sigma * t->accel_sigma;
+    float dt2 = dt * dt;
+    float qpp = q * dt2 * dt / 3.0f, qpv = q * dt2 * 0.5f, qvv = q * dt;
+    for (int axis = 0; axis < 2; axis++) {
+        t->P[axis][axis] += qpp;
+        t->P[axis][axis + 2] += qpv;
+        t->P[axis + 2][axis] += qpv;
+        t->P[axis + 2][axis + 2] += qvv;
+    }
+}
+
+// Returns false (state unchanged) if the measurement is outside the gate.
+static bool update(kalman_track_t *t, const kalman_meas_t *m) {
+    float rxx, rxy, ryy;
+    meas_cov(m, &rxx, &rxy, &ryy);
+    float nx = m->x - t->s[0], ny = m->y - t->s[1];
+    float sxx = t->P[0][0] + rxx, sxy = t->P[0][1] + rxy, syy = t->P[1][1] + ryy;
+    float det = sxx * syy - sxy * sxy;
+    if (!(det > 0.0f)) {
+        return false;
+    }
+    float ixx = syy / det, ixy = -sxy / det, iyy = sxx / det; // S^-1
+    float d2 = nx * (ixx * nx + ixy * ny) + ny * (ixy * nx + iyy * ny);
+    if (d2 > KALMAN_GATE_CHI2) {
+        return false;
+    }
+
+    // K = P H^T S^-1 (4x2), H = [I 0]
+    float K[4][2];
+    for (int i = 0; i < 4; i++) {
+        K[i][0] = t->P[i][0] * ixx + t->P[i][1] * ixy;
+        K[i][1] = t->P[i][0] * ixy + t->P[i][1] * iyy;
+    }
+    for (int i = 0; i < 4; i++) {
+        t->s[i] += K[i][0] * nx + K[i][1] * ny;
+    }
+    // P = P - K H P, then symmetrised against rounding drift
+    float HP[2][4];
+    memcpy(HP[0], t->P[0], sizeof(HP[0]));
+    memcpy(HP[1], t->P[1], sizeof(HP[1]));
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            t->P[i][j] -= K[i][0] * HP[0][j] + K[i][1] * HP[1][j];
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = i + 1; j < 4; j++) {
+            float v = 0.5f * (t->P[i][j] + t->P[j][i]);
+            t->P[i][j] = t->P[j][i] = v;
+        }
+    }
+    return true;
+}
+
+kalman_result_t kalman_track_step(kalman_track_t *t, uint32_t now_ms, const kalman_meas_t *meas) {
+    if (t->active && (int32_t)(now_ms - t->last_update_ms) > KALMAN_MAX_COAST_MS) {
+        t->active = false;
+    }
+    if (!t->active) {
+        if (meas == NULL) {
+            return KALMAN_LOST;
+        }
+        start(t, now_ms, meas);
+        return KALMAN_STARTED;
+    }
+
+    int32_t dt_ms = (int32_t)(now_ms - t->time_ms);
+    if (dt_ms > 0) {
+        predict(t, dt_ms / 1000.0f);
+        t->time_ms = now_ms;
+    }
+    if (meas == NULL) {
+        return KALMAN_PREDICTED;
+    }
+    if (update(t, meas)) {
+        t->last_update_ms = now_ms;
+        t->rejects_in_row = 0;
+        t->updates++;
+        return KALMAN_UPDATED;
+    }
+    t->rejects++;
+    if (++t->rejects_in_row >= KALMAN_RESET_AFTER_REJECTS) {
+        start(t, now_ms, meas);
+        return KALMAN_STARTED;
+    }
+    return KALMAN_REJECTED;
+}
+
+float kalman_track_position_sigma(const kalman_track_t *t) {
+    return sqrtf(t->P[0][0] + t->P[1][1]);
+}
+
+float kalman_track_speed_sigma(const kalman_track_t *t) {
+    return sqrtf(t->P[2][2] + t->P[3][3]);
+}
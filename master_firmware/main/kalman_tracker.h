@@ -0,0 +1,65 @@
+#ifndef KALMAN_TRACKER_H
+#define KALMAN_TRACKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Constant-velocity Kalman filter on the position of the person of one room.
+//
+// State (x, y, vx, vy) in metres and m/s; the process noise is a white
+// acceleration of `accel_sigma` m/s^2 on each axis. A measurement is the
+// trilateration position with its covariance.
+//
+// - Gating: a measurement whose Mahalanobis distance to the prediction is
+//   above KALMAN_GATE_CHI2 is rejected and the track only predicts. After
+//   KALMAN_RESET_AFTER_REJECTS rejections in a row the track restarts on the
+//   new measurement (the person is really elsewhere).
+// - Missing position (fewer than 2 calibrated sensors in a fused set): the
+//   track predicts, its uncertainty grows. After KALMAN_MAX_COAST_MS without
+//   an accepted measurement the track is dropped.
+//
+// Fixed-size state, no allocation. Plain C, no locking: owned by the
+// FusionEngine task, one track per fusion room.
+
+#define KALMAN_DEFAULT_ACCEL_SIGMA  0.5f   // m/s^2, walking person
+#define KALMAN_GATE_CHI2            9.21f  // 99 % of a 2-DOF chi-square
+#define KALMAN_RESET_AFTER_REJECTS  3
+#define KALMAN_MAX_COAST_MS         3000
+#define KALMAN_INITIAL_SPEED_SIGMA  1.5f   // m/s, velocity unknown at track start
+#define KALMAN_MIN_MEAS_SIGMA_M     0.03f  // Floor on the measurement noise
+
+typedef struct {
+    float x, y;                    // m
+    float cov_xx, cov_xy, cov_yy;  // m^2
+} kalman_meas_t;
+
+typedef enum {
+    KALMAN_LOST = 0,  // No track: nothing to report
+    KALMAN_STARTED,   // Track (re)started on this measurement
+    KALMAN_UPDATED,   // Measurement accepted
+    KALMAN_REJECTED,  // Measurement outside the gate: prediction only
+    KALMAN_PREDICTED, // No measurement: prediction only
+} kalman_result_t;
+
+typedef struct {
+    float s[4];          // x, y, vx, vy
+    float P[4][4];       // State covariance
+    float accel_sigma;
+    uint32_t time_ms;          // Time of `s`
+    uint32_t last_update_ms;   // Last accepted measurement
+    bool active;
+    uint8_t rejects_in_row;
+    uint32_t updates, rejects, starts; // Statistics
+} kalman_track_t;
+
+void kalman_track_init(kalman_track_t *t, float accel_sigma);
+
+// Advances the track to `now_ms` (sample timestamp) and applies `meas` if it
+// is not NULL. Timestamps that go backwards are treated as simultaneous.
+kalman_result_t kalman_track_step(kalman_track_t *t, uint32_t now_ms, const kalman_meas_t *meas);
+
+// Position standard deviation sqrt(P_xx + P_yy) and speed standard deviation.
+float kalman_track_position_sigma(const kalman_track_t *t);
+float kalman_track_speed_sigma(const kalman_track_t *t);
+
+#endif // KALMAN_TRACKER_H
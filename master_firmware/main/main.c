@@ -1,11 +1,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h> // For abs()
+#include <time.h>   // Local time of day (SNTP), for the inactivity weights
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "freertos/queue.h" // For FreeRTOS queues
 #include "esp_log.h"
+#include "esp_random.h"  // For esp_random() (backoff jitter seed)
 #include "nvs_flash.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -14,6 +16,32 @@
 #include "mdns.h"        // For mDNS
 #include "esp_http_server.h" // For HTTP Server
 #include "freertos/semphr.h" // For Mutex
+#include "conn_supervisor.h" // Wi-Fi/IP/MQTT connection state machine (hlk_common)
+#include "radar_wire.h"      // Compact authenticated binary sample (hlk_common)
+#include "mqtt_broker.h"     // Optional embedded MQTT broker
+#include "module_registry.h" // Radar modules discovered at runtime
+#include "mqtt5_props.h"     // MQTT 5 user properties of radar samples (hlk_common)
+#include "pipeline_msgs.h"    // Compact items of the radar/fusion rings and the alert queue
+#include "fusion_engine.h"    // Per-room N-sensor fusion core
+#include "trilateration.h"    // Position from the module distances
+#include "kalman_tracker.h"   // Position/velocity track of one person
+#include "multi_tracker.h"    // People of a room: association, track birth and death
+#include "fall_rules.h"       // Fall detection rules (fsm_engine table)
+#include "posture_nn.h"       // Int8 posture classifier on the master
+#include "pipeline_shard.h"   // Rooms split between pinned fusion/fall task pairs
+#include "spsc_ring.h"        // Lock-free rings between the pipeline tasks
+#include "msg_pool.h"         // Fixed-block pools: fused outputs, status page
+#include "msg_bus.h"          // Fan-out of the fused outputs of a shard
+#include "zone_engine.h"      // Zones of the rooms: events, fall policy
+#include "heatmap.h"          // Where people spend their time, per room
+#include "inactivity_monitor.h" // Long immobility of the people of a room
+#include "sensor_health.h" // Health score of each radar module
+#include "timer_wheel.h" // Watchdog deadlines
+#include "alert_outbox.h" // Alerts kept until the upstream broker acknowledges them
+#include "esp_sntp.h"         // Wall clock for the time of day
+#include "esp_partition.h"    // Model blob of the posture_nn partition
+#include "esp_timer.h"        // Classifier and ring self-benchmarks at boot
+#include "lwip/sockets.h"    // For the direct UDP transport
 
 // Note: cJSON.h is not included as manual parsing will be implemented.
 
@@ -36,32 +64,104 @@ static const char *mqtt_broker_ca_cert_pem_start = "-----BEGIN CERTIFICATE-----\
 // Wi-Fi Configuration
 #define MASTER_ESP_WIFI_SSID      "your_master_wifi_ssid"
 #define MASTER_ESP_WIFI_PASS      "your_master_wifi_password"
-#define MASTER_ESP_MAXIMUM_RETRY  5
 
 // MQTT Configuration
 #define MASTER_CONFIG_BROKER_URL          "mqtts://192.168.1.100:8883" // Changed to mqtts and port 8883
-#define HOME_MQTT_TOPIC_WILDCARD      "home/+/radar+"    
+#define MASTER_FALLBACK_BROKER_URL        "mqtts://192.168.1.101:8883" // Used when the preferred broker fails
+#define HOME_MQTT_TOPIC_WILDCARD      "home/+/+" // '+' must fill a whole level; radar topics are filtered by RADAR_TOPIC_PREFIX
+#define RADAR_TOPIC_PREFIX            "radar"    // Last topic level of radar data ("home/room1/radar1")
 #define MASTER_MQTT_CLIENT_ID             "esp32_master_controller_1"
 #define ALERT_TOPIC                       "home/room1/alert"
 
+// Ordered broker list: index 0 is preferred, the supervisor fails over down the list
+// and probes its way back up. Add more entries (max CONN_MAX_BROKERS) as needed.
+static const char *const master_broker_uris[] = {
+    MASTER_CONFIG_BROKER_URL,
+    MASTER_FALLBACK_BROKER_URL,
+};
+#define NUM_MASTER_BROKERS (sizeof(master_broker_uris) / sizeof(master_broker_uris[0]))
+#define BROKER_PROBE_TIMEOUT_MS 1500
+#define CONN_EVENT_QUEUE_SIZE 8
+
+// MQTT 5 on the master's client (needs CONFIG_MQTT_PROTOCOL_5=y, set in
+// sdkconfig.defaults): the broker may then send radar topics as topic aliases,
+// and the module id / sequence user properties of MQTT 5 slaves are read.
+// Without CONFIG_MQTT_PROTOCOL_5 the client stays on MQTT 3.1.1.
+#define MASTER_MQTT_PROTOCOL_V5      1
+#define MASTER_MQTT5_TOPIC_ALIAS_MAX 8 // Aliases the broker may use towards the master
+#if MASTER_MQTT_PROTOCOL_V5 && defined(CONFIG_MQTT_PROTOCOL_5)
+#define MASTER_USE_MQTT5 1
+#else
+#define MASTER_USE_MQTT5 0
+#endif
+
+// Embedded MQTT broker (mqtt_broker.c) for homes without a server: slaves use
+// "mqtt://esp32-master-controller.local" as CONFIG_BROKER_URL and the master
+// consumes their radar data in-process (no loopback MQTT client).
+#define MASTER_EMBEDDED_BROKER_ENABLED 0
+#define MASTER_EMBEDDED_BROKER_PORT    1883
+#define BROKER_OUTBOUND_QUEUE_SIZE     4
+// With the embedded broker, the external brokers above only bridge alerts
+// upstream. Set to 0 when there is no external broker at all.
+#define MASTER_UPSTREAM_BRIDGE_ENABLED 1
+
+#if MASTER_UPSTREAM_BRIDGE_ENABLED
+#define NUM_UPSTREAM_BROKERS NUM_MASTER_BROKERS
+#else
+#define NUM_UPSTREAM_BROKERS 0 // The supervisor then only manages Wi-Fi/IP
+#endif
+
+// Direct UDP transport: slaves built with RADAR_TRANSPORT_UDP send radar_wire
+// packets to this port, bypassing the broker. MQTT slaves keep working alongside.
+#define MASTER_RADAR_UDP_ENABLED 1
+#define MASTER_RADAR_UDP_PORT    RADAR_WIRE_DEFAULT_PORT
+
+// Shared SipHash key authenticating UDP samples. Must match the slaves' key.
+static const uint8_t radar_udp_auth_key[RADAR_WIRE_KEY_LEN] = {
+    0x6b, 0x65, 0x79, 0x2d, 0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x2d, 0x6d, 0x65, 0x21, 0x21, 0x21
+};
 
 // Event Group for Wi-Fi connection status
 static EventGroupHandle_t wifi_event_group;
 #define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
 
 // MQTT Client Handle and connection flag (file static, accessible within main.c)
 static esp_mqtt_client_handle_t client_handle = NULL;
 static bool mqtt_connected_flag = false;
+static bool mqtt_client_running = false; // esp_mqtt_client_start() called and not stopped since
+
+// Connection supervisor (owned by NetworkManager_task) and the queue feeding it
+// Wi-Fi/IP/MQTT events from the esp_event handlers.
+static conn_supervisor_t conn_supervisor;
+static QueueHandle_t conn_event_queue;
 
 // Web Server Data Structure and Mutex
 typedef struct {
     bool mqtt_connected;
-    bool module_status[NUM_SLAVE_MODULES]; // true for online, false for offline
+    const char *mqtt_broker_uri;       // Broker currently selected by the connection supervisor
+    conn_outage_stats_t conn_stats;    // Snapshot taken on every online/offline transition
+#if MASTER_EMBEDDED_BROKER_ENABLED
+    mqtt_broker_stats_t broker_stats;  // Refreshed by EmbeddedBroker_task
+#endif
+    uint8_t room_count;       // Fusion rooms, refreshed by the FusionEngine tasks on changes
+    struct {
+        char name[FUSION_ROOM_NAME_LEN];
+        uint8_t modules, alive;
+        bool degraded;
+        // Person of the room updated last, refreshed by the FallDetector task of its shard every FALL_TICK_MS
+        bool has_person;
+        uint8_t person_track_id, person_fall_state;
+        uint16_t person_zone;      // Zone deciding its fall policy, else the first it is in, ZONE_NONE if none
+        uint32_t still_ms;         // Room without significant motion for, 0 if empty (inactivity_monitor.h)
+        uint8_t inactivity_level;
+        fall_feature_values_t person_features;
+        // Latest fused output (a fused_pool block WebTap_task holds a reference on)
+        FusedData *last_output;
+        uint32_t outputs;
+    } rooms[FUSION_MAX_ROOMS];
     char last_alerts[5][128]; // Store last 5 alert descriptions
     int alert_write_index;    // Index for next alert to write (for circular buffer)
     int stored_alert_count;   // Number of alerts actually stored (0 to 5)
-    uint32_t system_uptime_seconds; // System uptime
 } WebServerData;
 
 static WebServerData g_web_server_data;
@@ -75,82 +175,328 @@ static httpd_handle_t http_server_handle = NULL; // Global handle for the server
 #define ALERT_TASK_PRIORITY      5
 #define WATCHDOG_TASK_PRIORITY   1 // Watchdog should have a low priority, but higher than IDLE
 
-// Radar Data Fusion Definitions
+// Radar Data Fusion Definitions (RadarMessage, FusedData and AlertMessage are in pipeline_msgs.h)
+
+// Sample metadata carried outside the JSON payload (MQTT 5 user properties)
 typedef struct {
-    int module_id;
-    uint32_t timestamp; // This is the slave's timestamp
-    float distance_m;
-    char posture[16]; 
-    int signal;
-} RadarMessage;
-
-// Fall Detector Definitions
-#define STANDING_POSTURE "STANDING" 
-#define SITTING_POSTURE  "SITTING"  
-#define LYING_POSTURE    "LYING"
-#define MOVING_POSTURE   "MOVING"   
-#define STILL_POSTURE    "STILL"    
-
-#define FALL_TRANSITION_MAX_MS 1000       
-#define LYING_CONFIRMATION_DURATION_S 20  
+    int module_id;      // 0 = not present, read "id_module" from the payload
+    bool has_sequence;
+    uint32_t sequence;
+} RadarPayloadMeta;
 
+// Fall Detector Definitions (rules and thresholds: fall_rules.h)
+#define FALL_TICK_MS 1000 // Timer rules evaluated at least this often
+
+// Sensor positions in room coordinates (metres), as generated by
+// scripts/calibration_setup.py. Modules without an entry still take part in
+// posture fusion but not in positioning. All rooms share the same bounds.
 typedef struct {
+    uint8_t module_id;
     float x, y;
-    char final_posture[16];
-    uint32_t timestamp; // Average or one of the sensor timestamps from master's perspective
-} FusedData;
+} SensorCalibration;
 
-// Alert Manager Definitions
-typedef enum { 
-    ALERT_TYPE_FALL_DETECTED, 
-    ALERT_TYPE_MODULE_OFFLINE,
-    ALERT_TYPE_MODULE_ONLINE // Optional: For module online notifications
-} AlertType;
+static const SensorCalibration sensor_calibration[] = {
+    { 1, 0.00f, 0.50f },
+    { 2, 3.00f, 0.50f },
+};
+#define NUM_SENSOR_CALIBRATIONS (sizeof(sensor_calibration) / sizeof(sensor_calibration[0]))
+#define ROOM_MIN_X_M 0.0f
+#define ROOM_MIN_Y_M 0.0f
+#define ROOM_MAX_X_M 4.0f
+#define ROOM_MAX_Y_M 4.0f
+#define RADAR_RANGE_SIGMA_M TRILAT_DEFAULT_RANGE_SIGMA_M
+#define TRACK_ACCEL_SIGMA   KALMAN_DEFAULT_ACCEL_SIGMA // m/s^2, process noise of the person tracks
+
+// Zones of the rooms, in room coordinates (mm), as the sensor positions. A
+// room takes the zones naming it (the "room" TXT record of its modules) when
+// it first appears. SUPPRESS: no fall alert while the person is in the zone;
+// ESCALATE: the fall is confirmed after ZONE_ESCALATED_CONFIRM_MS instead of
+// LYING_CONFIRMATION_DURATION_S, and the alert flagged. The last field scales
+// the inactivity alert delays in the zone (percent, 0 = default).
+static const zone_def_t zone_config[] = {
+    { "chambre", "lit", ZONE_FALL_SUPPRESS, 4, 0,
+      { { 2000, 1500 }, { 3900, 1500 }, { 3900, 3900 }, { 2000, 3900 } }, 400 },
+    { "chambre", "porte", ZONE_FALL_NORMAL, 4, 120,
+      { { 0, 3200 }, { 900, 3200 }, { 900, 4000 }, { 0, 4000 } }, 0 },
+    { "salle_de_bain", "douche", ZONE_FALL_ESCALATE, 4, 1800,
+      { { 0, 0 }, { 1200, 0 }, { 1200, 1200 }, { 0, 1200 } }, 30 },
+};
+#define NUM_ZONES (sizeof(zone_config) / sizeof(zone_config[0]))
+#define ZONE_GRID_CELL_MM         250  // 16 x 16 cells over the room bounds
+#define ZONE_ARENA_WORDS          2048 // Grids of the rooms with zones: 257 words + 1 per zone and cell touched
+#define MASTER_ZONE_EVENTS_ENABLED 1   // ENTER/EXIT/DWELL as alerts (dropped when the alert queue is full)
+
+// Occupancy heatmap of each room (heatmap.h): time spent per cell, fading
+// with a half-life, exported at /heatmap?room=<n>&tile=<cells per tile side>.
+// Rooms take HEATMAP_CELL_MM cells over the room bounds from a shared arena
+// as they appear; once it is full, later rooms have no heatmap.
+#define HEATMAP_CELL_MM      250       // 16 x 16 cells, 1 KB per room
+#define HEATMAP_ARENA_CELLS  (8 * 256) // 8 rooms at 250 mm
+#define HEATMAP_HALF_LIFE_S  3600
+#define HEATMAP_MAX_DWELL_MS 2000      // Longer gaps between two outputs of a person are not counted
+
+// Long immobility of each room (inactivity_monitor.h): graded INACTIVITY
+// alerts when nobody in the room has moved for level_s, scaled by the zone
+// of the person (zone_config), by lying outside such a zone, and at night.
+// Catches the slow collapse the fall rules miss. The time of day comes from
+// SNTP; until the clock is set, it is day.
+#define MASTER_INACTIVITY_ENABLED 1
+static const inactivity_config_t inactivity_config = {
+    .level_s = { 30 * 60, 60 * 60, 120 * 60 },
+    .motion_speed_mm_s = 200,
+    .motion_mm = 300,
+    .lying_pct = 25,               // 7.5 min lying on the floor before the first level
+    .night_pct = 200,
+    .night_start_min = 22 * 60,
+    .night_end_min = 7 * 60,
+    .absent_ms = 5 * 60 * 1000,    // No output for 5 min: the room is empty
+};
+#define MASTER_SNTP_SERVER      "pool.ntp.org"
+#define MASTER_TIMEZONE         "CET-1CEST,M3.5.0,M10.5.0/3" // POSIX TZ of the home
+#define MASTER_CLOCK_VALID_AFTER 1700000000 // time() before this: clock not set yet
+
+// Health of each radar module (sensor_health.h), from the samples it sends:
+// stuck values, collapsed signal, error frames, lost samples, distance spread.
+// SENSOR_DEGRADED / SENSOR_RESTORED alerts, score on the status page.
+// Slaves send about 10 samples/s: alpha 0.02 averages over ~5 s.
+static const sensor_health_config_t sensor_health_config = {
+    .alpha = 0.02f,
+    .warmup_samples = 50,
+    .stuck_samples = 600,          // 1 min of identical samples with a target
+    .max_error_rate = 0.2f,
+    .max_drop_rate = 0.3f,
+    .min_signal = 10.0f,
+    .max_distance_std_mm = 1500.0f,
+    .degraded_below = 50,
+    .restored_above = 70,
+};
 
-typedef struct {
-    AlertType type;
-    char description[64]; 
-    uint32_t alert_timestamp; 
-} AlertMessage;
+// Alert outbox (alert_outbox.h): each alert for the upstream broker is kept,
+// in NVS as well, until the broker acknowledges it (PUBACK), and published
+// again with a backoff meanwhile. The payload carries its "id": a subscriber
+// drops the copies of an alert published twice (QoS 1, retries, reboots).
+// Informational alerts (zone events, module online, end of an inactivity)
+// skip it: published once at QoS 0 if connected, with id 0.
+#define ALERT_OUTBOX_NVS_NAMESPACE "alert_outbox"
+#define ALERT_OUTBOX_NVS_KEY       "entries"
+#define ALERT_OUTBOX_POLL_MS       250 // AlertManager_task wake-up while alerts wait for their PUBACK
+static const alert_outbox_config_t alert_outbox_config = {
+    .retry_base_ms = 2000,
+    .retry_max_ms = 60000,
+    .ack_timeout_ms = 10000,
+};
 
 // Watchdog Definitions
-#define NUM_SLAVE_MODULES 2
-#define WATCHDOG_CHECK_INTERVAL_S 2
+// Each module has a deadline in a timer wheel (timer_wheel.h), re-armed at
+// each of its samples: the watchdog sleeps until the earliest one, so a
+// module goes offline SLAVE_MODULE_TIMEOUT_S after its last sample (to the
+// tick) at a cost that does not grow with the number of modules. A second
+// timer per module carries its pending health alert.
 #define SLAVE_MODULE_TIMEOUT_S 5  // Threshold before considering a module offline (e.g., 30 seconds)
+#define WATCHDOG_RETRY_MS      1000 // An alert that could not be queued is retried after this
+#define WATCHDOG_WHEEL_SHIFT   5    // 32 ms slots: 8.2 s per turn, longer than the timeout
+#define WATCHDOG_EXPIRE_BATCH  16
+#define LIVENESS_TIMER(slot)   (slot)
+#define HEALTH_TIMER(slot)     (MODULE_REGISTRY_MAX_MODULES + (slot))
 
-static uint32_t last_received_timestamp_ms[NUM_SLAVE_MODULES] = {0};
-static bool module_offline_alerted[NUM_SLAVE_MODULES] = {false}; // Tracks if an OFFLINE alert has been sent for a module
 static uint32_t system_start_time_ms = 0;
 
+// Modules known from mDNS announcements and radar traffic. Shared by the
+// RadarRouter, Watchdog, mDNS discovery and HTTP tasks under its own mutex.
+static module_registry_t module_registry;
+static SemaphoreHandle_t module_registry_mutex = NULL;
+// Timers by registry slot, under module_registry_mutex too
+static timer_wheel_entry_t watchdog_timers[2 * MODULE_REGISTRY_MAX_MODULES];
+static timer_wheel_t watchdog_wheel;
+static TaskHandle_t watchdog_task_handle = NULL;
+
+static inline uint16_t module_slot(const module_info_t *module) {
+    return (uint16_t)(module - module_registry.modules);
+}
+
 
-#define RADAR_DATA_QUEUE_SIZE 10
-#define FUSION_OUTPUT_QUEUE_SIZE 5 
+#define RADAR_RING_SIZE 16 // Per radar source (power of two, spsc_ring.h)
+#define UDP_RECEIVER_TASK_PRIORITY NETWORK_TASK_PRIORITY
+#define FUSED_RING_SIZE 16 // Per shard; up to MTT_MAX_TRACKS outputs per fused set
 #define ALERT_QUEUE_SIZE 5 // Increased slightly for potential module online/offline alerts
-#define SENSOR_SYNC_WINDOW_MS 500 
-
-static QueueHandle_t radar_data_queue;
-static QueueHandle_t fusion_output_queue;
+#define SENSOR_SYNC_WINDOW_MS 500 // Until a module's jitter is measured, then adapted per module
+#define MASTER_FUSION_QUORUM FUSION_DEFAULT_QUORUM // Fresh readings of a room needed for a fused output
+
+// Posture of each sample classified on the master (posture_nn.c) instead of
+// the string chosen by the slave. The model is read from the posture_nn data
+// partition (partitions.csv), updated without reflashing the application with
+// scripts/posture_nn_export.py + parttool.py; the compiled-in default model
+// is used when the partition holds no valid blob.
+#define MASTER_POSTURE_NN_ENABLED     1
+#define POSTURE_NN_MIN_CONFIDENCE_PCT 60           // Below, the slave's posture is kept
+#define POSTURE_NN_PARTITION_LABEL    "posture_nn"
+#define POSTURE_NN_SELF_BENCH_RUNS    1000         // Inferences timed at boot (0 = none)
+
+// Pipeline sharding (pipeline_shard.h): the rooms are split between
+// MASTER_PIPELINE_SHARDS pairs of FusionEngine/FallDetector tasks, each pair
+// pinned to a core. The network side (Wi-Fi, lwIP, MQTT, HTTP, UDP receiver,
+// RadarRouter_task) stays on NETWORK_CORE, so a burst of traffic or a status
+// page no longer delays the fusion, and a busy room only queues behind the
+// rooms of its own shard.
+#define MASTER_PIPELINE_SHARDS      2
+#define MASTER_PIPELINE_SHARD_CORES 1 // Cores shared by the shards: 1 = all off the network core, 2 = both in turn
+#define NETWORK_CORE                0 // PRO_CPU, where ESP-IDF pins the Wi-Fi and lwIP tasks (sdkconfig.defaults)
+#define SHARD_RADAR_RING_SIZE       16 // Samples waiting for the FusionEngine task of a shard
+#define PIPELINE_BATCH              8  // Items taken from a ring at a time
+#define SPSC_SELF_BENCH_ITEMS       20000 // Samples timed at boot, FreeRTOS queue vs ring (0 = none)
+
+// A fused output is written once into a block of fused_pool (msg_pool.h) and
+// published on the bus of its shard (msg_bus.h): the FallDetector task of the
+// shard and WebTap_task each get a pointer holding its own reference instead
+// of a copy. The pool covers the latest output of every room plus what the
+// rings and batches usually hold; when it runs dry the output is dropped and
+// counted, like on a full ring.
+#define FUSED_POOL_BLOCKS   (FUSION_MAX_ROOMS + MASTER_PIPELINE_SHARDS * 24)
+// The status page is built into blocks of page_pool and sent in chunks once
+// every lock is released, instead of a buffer taken from the heap per request
+#define HTTP_PAGE_BLOCK_LEN 1024
+#define HTTP_PAGE_BLOCKS    12
+
+// Stage boundary of the pipeline: a lock-free ring (spsc_ring.h) fed by one
+// task and drained by one task, which sleeps on its task notification when
+// the ring is empty. Neither side waits for the other: a full ring loses the
+// item, counted in its stats.
+typedef struct {
+    spsc_ring_t ring;
+    TaskHandle_t consumer; // Set by the consumer before it first parks
+} HotRing;
+
+// Radar samples reach the router through one ring per producing task, so
+// that every ring keeps a single producer.
+typedef enum {
+    RADAR_SOURCE_MQTT,   // External broker (esp-mqtt task)
+    RADAR_SOURCE_BROKER, // EmbeddedBroker_task
+    RADAR_SOURCE_UDP,    // UdpReceiver_task
+    RADAR_SOURCE_COUNT
+} RadarSource;
+
+static const char *const radar_source_names[RADAR_SOURCE_COUNT] = { "MQTT", "broker", "UDP" };
+static HotRing radar_rings[RADAR_SOURCE_COUNT]; // To RadarRouter_task
+static RadarMessage radar_ring_slots[RADAR_SOURCE_COUNT][RADAR_RING_SIZE];
+// Several producers and a few items an hour: a FreeRTOS queue, whose blocking
+// send lets a fall alert wait for room rather than be lost
 static QueueHandle_t alert_queue;
+// Written by AlertManager_task and the MQTT event handler (PUBACKs,
+// connections), read by the HTTP task. Never held across a publish.
+static alert_outbox_t alert_outbox;
+static SemaphoreHandle_t alert_outbox_mutex;
+
+// One shard: the rooms r with r % MASTER_PIPELINE_SHARDS == index
+typedef struct {
+    uint8_t index;
+    HotRing radar_ring;            // Samples of its rooms, from RadarRouter_task
+    HotRing fused_ring;            // Outputs of its rooms (fused_pool blocks), to its FallDetector_task
+    msg_bus_t fused_bus;           // Publishes its outputs to fused_ring and to its ring of WebTap_task
+    RadarMessage radar_slots[SHARD_RADAR_RING_SIZE];
+    FusedData *fused_slots[FUSED_RING_SIZE];
+    SemaphoreHandle_t rooms_mutex; // Held by its FusionEngine_task per sample, by the router to move a module
+#if MASTER_POSTURE_NN_ENABLED
+    posture_nn_t posture_nn;       // Own copy: the arena is scratch space, the weights are shared
+#endif
+} PipelineShard;
+
+static PipelineShard pipeline_shards[MASTER_PIPELINE_SHARDS];
+_Static_assert(MASTER_PIPELINE_SHARDS >= 1 && MASTER_PIPELINE_SHARDS <= PIPELINE_MAX_SHARDS, "1 to 4 shards");
+static pipeline_shards_t pipeline_plan; // Placement, then counters written by RadarRouter_task
+
+static msg_pool_t fused_pool;
+static alignas(8) uint8_t fused_pool_storage[MSG_POOL_STORAGE_LEN(sizeof(FusedData), FUSED_POOL_BLOCKS)];
+static HotRing web_tap_rings[MASTER_PIPELINE_SHARDS]; // Fused outputs of each shard, to WebTap_task
+static FusedData *web_tap_slots[MASTER_PIPELINE_SHARDS][FUSED_RING_SIZE];
+static msg_pool_t page_pool;
+static alignas(8) uint8_t page_pool_storage[MSG_POOL_STORAGE_LEN(HTTP_PAGE_BLOCK_LEN, HTTP_PAGE_BLOCKS)];
+
+// Grids written by RadarRouter_task when a room appears (assign_module_room),
+// read without lock by the FallDetector task of the room: the grid is bound
+// before the first sample of the room goes through the rings, whose
+// release/acquire order publishes it.
+static zone_engine_t zone_engine;
+static uint16_t zone_arena[ZONE_ARENA_WORDS];
+_Static_assert(FUSION_MAX_ROOMS <= ZONE_MAX_ROOMS, "A zone grid per fusion room");
+_Static_assert(NUM_ZONES < ALERT_ZONE_NONE, "Zone index of an alert is 8 bits");
+
+// Same ownership as the zone grids: set up by RadarRouter_task when the room
+// appears, updated by the FallDetector task of the room only, exported by the
+// HTTP task (heatmap_export() detects a concurrent rescale)
+static heatmap_t room_heatmaps[FUSION_MAX_ROOMS];
+static float heatmap_arena[HEATMAP_ARENA_CELLS];
+static uint32_t heatmap_arena_used;
+
+static bool hot_ring_init(HotRing *hr, void *slots, size_t item_size, uint32_t capacity) {
+    hr->consumer = NULL;
+    return spsc_ring_init(&hr->ring, slots, item_size, capacity);
+}
+
+// Wakes the consumer of a ring found parked (also the msg_bus wake-up of a
+// subscriber, ctx: its HotRing)
+static void hot_ring_wake(void *ctx) {
+    HotRing *hr = (HotRing *)ctx;
+    if (hr->consumer != NULL) {
+        xTaskNotifyGive(hr->consumer);
+    }
+}
+
+// Producer side: copies `item` in and wakes the consumer if it sleeps. False
+// when the ring is full.
+static bool hot_ring_push(HotRing *hr, const void *item) {
+    bool accepted = spsc_ring_push(&hr->ring, item);
+    if (spsc_ring_take_sleeper(&hr->ring)) {
+        hot_ring_wake(hr);
+    }
+    return accepted;
+}
+
+// Consumer side: sleeps until one of the `count` rings gets an item or
+// `ticks` pass. Returns at once if one already holds items. A notification
+// left by an earlier push only costs one empty pass of the caller.
+static void hot_rings_wait(HotRing *rings, int count, TickType_t ticks) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool idle = true;
+    for (int i = 0; i < count && idle; i++) {
+        rings[i].consumer = self; // Before parking: a producer that sees the park sees the handle
+        idle = spsc_ring_park(&rings[i].ring);
+    }
+    if (idle) {
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+    for (int i = 0; i < count; i++) {
+        spsc_ring_unpark(&rings[i].ring);
+    }
+}
 
 
 // Task function declarations
 void NetworkManager_task(void *pvParameters);
-void FusionEngine_task(void *pvParameters);
-void FallDetector_task(void *pvParameters);
+void RadarRouter_task(void *pvParameters); // Registry and room of each sample, then its shard
+void FusionEngine_task(void *pvParameters); // One per shard (pvParameters: its PipelineShard)
+void FallDetector_task(void *pvParameters); // One per shard
+void WebTap_task(void *pvParameters); // Latest fused output of each room, for the status page
 void AlertManager_task(void *pvParameters);
 void Watchdog_task(void *pvParameters);
 void discover_radar_modules_task(void *pvParameters); // mDNS Discovery Task
+void UdpReceiver_task(void *pvParameters); // Direct UDP radar transport
+void EmbeddedBroker_task(void *pvParameters); // Optional in-process MQTT broker
 
 // Network related function declarations
 static void nvs_init();
+static void alert_outbox_restore(void);
 static void master_wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 static void master_wifi_init_sta(void);
-static bool parse_radar_json(const char* json_str, int data_len, RadarMessage* msg);
+static bool parse_radar_json(const char* json_str, int data_len, int module_id_hint, RadarMessage* msg);
 static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data);
 static void master_mqtt_app_start(void);
+static void post_conn_event(conn_event_id_t id, uint8_t broker_index);
+static void master_conn_execute_actions(uint32_t actions);
 
 // Fusion Engine related function declarations
-static bool calculate_xy_position(float d1, float d2, float* x, float* y);
+static bool pipeline_init(void);
+static void pipeline_ring_self_bench(void);
+static int track_room_people(const fusion_set_t *set);
 
 // HTTP Server related function declarations
 static httpd_handle_t start_webserver(void);
@@ -165,19 +511,13 @@ void app_main(void)
 
     nvs_init(); 
 
-    radar_data_queue = xQueueCreate(RADAR_DATA_QUEUE_SIZE, sizeof(RadarMessage));
-    if (radar_data_queue == NULL) {
-        ESP_LOGE(TAG_MAIN_APP, "Failed to create radar_data_queue. Halting.");
-        while(1); 
-    }
-    ESP_LOGI(TAG_MAIN_APP, "radar_data_queue created successfully.");
-
-    fusion_output_queue = xQueueCreate(FUSION_OUTPUT_QUEUE_SIZE, sizeof(FusedData));
-    if (fusion_output_queue == NULL) {
-        ESP_LOGE(TAG_MAIN_APP, "Failed to create fusion_output_queue. Halting.");
+    if (!pipeline_init()) {
+        ESP_LOGE(TAG_MAIN_APP, "Failed to create the pipeline rings and shards. Halting.");
         while(1);
     }
-    ESP_LOGI(TAG_MAIN_APP, "fusion_output_queue created successfully.");
+    if (SPSC_SELF_BENCH_ITEMS > 0) {
+        pipeline_ring_self_bench();
+    }
 
     alert_queue = xQueueCreate(ALERT_QUEUE_SIZE, sizeof(AlertMessage));
     if (alert_queue == NULL) {
@@ -186,6 +526,23 @@ void app_main(void)
     }
     ESP_LOGI(TAG_MAIN_APP, "alert_queue created successfully.");
 
+    alert_outbox_mutex = xSemaphoreCreateMutex();
+    if (alert_outbox_mutex == NULL) {
+        ESP_LOGE(TAG_MAIN_APP, "Failed to create alert_outbox_mutex. Halting.");
+        while(1);
+    }
+    alert_outbox_restore();
+
+    conn_event_queue = xQueueCreate(CONN_EVENT_QUEUE_SIZE, sizeof(conn_event_t));
+    if (conn_event_queue == NULL) {
+        ESP_LOGE(TAG_MAIN_APP, "Failed to create conn_event_queue. Halting.");
+        while(1);
+    }
+    ESP_LOGI(TAG_MAIN_APP, "conn_event_queue created successfully.");
+
+    // Created here (not in master_wifi_init_sta) so that every task can wait on it
+    wifi_event_group = xEventGroupCreate();
+
     // Create mutex for web server data
     g_web_data_mutex = xSemaphoreCreateMutex();
     if (g_web_data_mutex == NULL) {
@@ -194,31 +551,59 @@ void app_main(void)
     }
     ESP_LOGI(TAG_MAIN_APP, "g_web_data_mutex created successfully.");
 
+    module_registry_init(&module_registry);
+    timer_wheel_init(&watchdog_wheel, watchdog_timers, 2 * MODULE_REGISTRY_MAX_MODULES, WATCHDOG_WHEEL_SHIFT,
+                     esp_log_timestamp());
+    module_registry_mutex = xSemaphoreCreateMutex();
+    if (module_registry_mutex == NULL) {
+        ESP_LOGE(TAG_MAIN_APP, "Failed to create module_registry_mutex. Halting.");
+        while(1);
+    }
+
     // Initialize web server data (critical section)
     if(xSemaphoreTake(g_web_data_mutex, portMAX_DELAY) == pdTRUE) {
         g_web_server_data.mqtt_connected = false;
-        for (int i = 0; i < NUM_SLAVE_MODULES; i++) {
-            g_web_server_data.module_status[i] = false; // Initialize as offline
-        }
+        g_web_server_data.mqtt_broker_uri = MASTER_CONFIG_BROKER_URL;
+        memset(&g_web_server_data.conn_stats, 0, sizeof(g_web_server_data.conn_stats));
         g_web_server_data.alert_write_index = 0;
         g_web_server_data.stored_alert_count = 0;
         for (int i = 0; i < 5; i++) {
             strcpy(g_web_server_data.last_alerts[i], ""); // Clear alert strings
         }
-        g_web_server_data.system_uptime_seconds = 0;
         xSemaphoreGive(g_web_data_mutex);
     }
 
 
+    // Shared by the FallDetector tasks of all shards: indexed before they start
+    if (!fall_rules_init()) {
+        ESP_LOGE(TAG_MAIN_APP, "Invalid fall rule table, fall detection disabled.");
+    }
+
     // Record system start time for Watchdog initial grace period
     system_start_time_ms = esp_log_timestamp(); 
 
-    xTaskCreate(&NetworkManager_task, "NetworkManager_task", 4096*2, NULL, NETWORK_TASK_PRIORITY, NULL);
-    xTaskCreate(&FusionEngine_task, "FusionEngine_task", 4096, NULL, FUSION_TASK_PRIORITY, NULL);
-    xTaskCreate(&FallDetector_task, "FallDetector_task", 4096, NULL, FALL_DETECTION_TASK_PRIORITY, NULL);
-    xTaskCreate(&AlertManager_task, "AlertManager_task", 4096, NULL, ALERT_TASK_PRIORITY, NULL);
-    xTaskCreate(&Watchdog_task, "Watchdog_task", 2048, NULL, WATCHDOG_TASK_PRIORITY, NULL); 
-    xTaskCreate(&discover_radar_modules_task, "mdns_discover_task", 4096, NULL, 1, NULL); // Low priority for discovery
+    // Network side on NETWORK_CORE, the fusion/fall pair of each shard on the core of its shard
+    xTaskCreatePinnedToCore(&NetworkManager_task, "NetworkManager_task", 4096*2, NULL, NETWORK_TASK_PRIORITY, NULL, NETWORK_CORE);
+    xTaskCreatePinnedToCore(&RadarRouter_task, "RadarRouter_task", 3072, NULL, FUSION_TASK_PRIORITY, NULL, NETWORK_CORE);
+    for (int s = 0; s < pipeline_plan.shard_count; s++) {
+        char task_name[16];
+        snprintf(task_name, sizeof(task_name), "FusionEngine_%d", s);
+        xTaskCreatePinnedToCore(&FusionEngine_task, task_name, 4096, &pipeline_shards[s], FUSION_TASK_PRIORITY, NULL,
+                                pipeline_plan.core[s]);
+        snprintf(task_name, sizeof(task_name), "FallDetector_%d", s);
+        xTaskCreatePinnedToCore(&FallDetector_task, task_name, 4096, &pipeline_shards[s], FALL_DETECTION_TASK_PRIORITY, NULL,
+                                pipeline_plan.core[s]);
+    }
+    xTaskCreatePinnedToCore(&AlertManager_task, "AlertManager_task", 4096, NULL, ALERT_TASK_PRIORITY, NULL, NETWORK_CORE);
+    xTaskCreatePinnedToCore(&Watchdog_task, "Watchdog_task", 2048, NULL, WATCHDOG_TASK_PRIORITY, &watchdog_task_handle, NETWORK_CORE);
+    xTaskCreatePinnedToCore(&WebTap_task, "WebTap_task", 2048, NULL, 1, NULL, NETWORK_CORE); // Status page only: lowest priority
+    xTaskCreatePinnedToCore(&discover_radar_modules_task, "mdns_discover_task", 4096, NULL, 1, NULL, NETWORK_CORE); // Low priority for discovery
+#if MASTER_RADAR_UDP_ENABLED
+    xTaskCreatePinnedToCore(&UdpReceiver_task, "UdpReceiver_task", 3072, NULL, UDP_RECEIVER_TASK_PRIORITY, NULL, NETWORK_CORE);
+#endif
+#if MASTER_EMBEDDED_BROKER_ENABLED
+    xTaskCreatePinnedToCore(&EmbeddedBroker_task, "EmbeddedBroker_task", 6144, NULL, NETWORK_TASK_PRIORITY, NULL, NETWORK_CORE); // deliver() keeps one packet per MQTT version on the stack
+#endif
     // HTTP server will be started by NetworkManager_task upon IP acquisition
 
     ESP_LOGI(TAG_MAIN_APP, "All tasks created.");
@@ -234,45 +619,72 @@ static void nvs_init() {
     ESP_LOGI(TAG_NETWORK, "NVS flash initialized successfully.");
 }
 
-static int s_master_retry_num = 0;
+// Alerts not acknowledged before the last reboot or power loss: published
+// again once the upstream broker is connected, under the same ids
+static void alert_outbox_restore(void) {
+    static uint8_t blob[ALERT_OUTBOX_BLOB_MAX];
+    size_t len = sizeof(blob);
+    nvs_handle_t nvs;
+    alert_outbox_init(&alert_outbox, &alert_outbox_config);
+    if (nvs_open(ALERT_OUTBOX_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return; // Nothing saved yet
+    }
+    esp_err_t err = nvs_get_blob(nvs, ALERT_OUTBOX_NVS_KEY, blob, &len);
+    nvs_close(nvs);
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG_ALERT_MANAGER, "Failed to read the alert outbox from NVS: %s", esp_err_to_name(err));
+        }
+        return;
+    }
+    if (alert_outbox_load(&alert_outbox, blob, len, esp_log_timestamp())) {
+        ESP_LOGI(TAG_ALERT_MANAGER, "Alert outbox restored: %u alerts to publish, next id %u.",
+                 (unsigned)alert_outbox_count(&alert_outbox), alert_outbox.next_id);
+    } else {
+        ESP_LOGW(TAG_ALERT_MANAGER, "Alert outbox in NVS not valid (%u bytes), discarded.", (unsigned)len);
+    }
+}
+
+// Forwards a connection event to NetworkManager_task. Called from the esp_event
+// and MQTT handlers, so it never blocks.
+static void post_conn_event(conn_event_id_t id, uint8_t broker_index) {
+    conn_event_t event = { .id = id, .broker_index = broker_index };
+    if (conn_event_queue == NULL || xQueueSend(conn_event_queue, &event, 0) != pdPASS) {
+        ESP_LOGE(TAG_NETWORK, "Failed to post connection event %d (queue full or not created).", id);
+    }
+}
 
 static void master_wifi_event_handler(void* arg, esp_event_base_t event_base,
                                 int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        ESP_LOGI(TAG_NETWORK, "Wi-Fi STA Started, attempting to connect...");
-        esp_wifi_connect();
+        ESP_LOGI(TAG_NETWORK, "Wi-Fi STA Started.");
+        post_conn_event(CONN_EVT_START, 0);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
         ESP_LOGI(TAG_NETWORK, "Wi-Fi STA Connected to AP: %s", MASTER_ESP_WIFI_SSID);
-        s_master_retry_num = 0;
+        post_conn_event(CONN_EVT_WIFI_CONNECTED, 0);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        mqtt_connected_flag = false; 
-        if (s_master_retry_num < MASTER_ESP_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_master_retry_num++;
-            ESP_LOGI(TAG_NETWORK, "Retry Wi-Fi connection (%d/%d)...", s_master_retry_num, MASTER_ESP_MAXIMUM_RETRY);
-        } else {
-            xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
-            ESP_LOGE(TAG_NETWORK, "Failed to connect to Wi-Fi AP %s after %d retries.", MASTER_ESP_WIFI_SSID, MASTER_ESP_MAXIMUM_RETRY);
-        }
-        ESP_LOGE(TAG_NETWORK,"Disconnected from AP %s", MASTER_ESP_WIFI_SSID);
+        wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+        mqtt_connected_flag = false;
+        xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        ESP_LOGW(TAG_NETWORK, "Disconnected from AP %s (reason %d)", MASTER_ESP_WIFI_SSID, event->reason);
+        post_conn_event(CONN_EVT_WIFI_DISCONNECTED, 0);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP) {
+        ESP_LOGW(TAG_NETWORK, "Lost IP address.");
+        xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        post_conn_event(CONN_EVT_LOST_IP, 0);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG_NETWORK, "Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_master_retry_num = 0;
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
-
-        // If MQTT was initialized and is not connected, try to reconnect.
-        if (client_handle != NULL && !mqtt_connected_flag) {
-            ESP_LOGI(TAG_NETWORK, "Wi-Fi (re)connected, attempting to reconnect MQTT client...");
-            esp_err_t err = esp_mqtt_client_reconnect(client_handle);
-            if (err == ESP_OK) {
-                ESP_LOGI(TAG_NETWORK, "MQTT client reconnect initiated successfully.");
-                // Note: MQTT_EVENT_CONNECTED will set mqtt_connected_flag = true
-            } else {
-                ESP_LOGE(TAG_NETWORK, "Failed to initiate MQTT client reconnect: %s. Will retry in NetworkManager_task.", esp_err_to_name(err));
-                // esp_mqtt_client_start(client_handle) might be an alternative if reconnect fails persistently
-            }
+        post_conn_event(CONN_EVT_GOT_IP, 0); // The supervisor starts MQTT from here
+        if (!esp_sntp_enabled()) {
+            // Time of day for the inactivity weights; SNTP keeps polling across reconnections
+            setenv("TZ", MASTER_TIMEZONE, 1);
+            tzset();
+            esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
+            esp_sntp_setservername(0, MASTER_SNTP_SERVER);
+            esp_sntp_init();
         }
         // Start the web server if not already started and we have a valid handle reference
         if (!http_server_started_flag && http_server_handle == NULL) {
@@ -300,96 +712,322 @@ static void master_wifi_event_handler(void* arg, esp_event_base_t event_base,
 }
 
 
+// Status page being built: a chain of page_pool blocks, filled under the
+// locks and sent once they are released
+typedef struct {
+    char *blocks[HTTP_PAGE_BLOCKS];
+    int count;
+    size_t used;    // Bytes in the last block
+    bool truncated; // page_pool ran dry: the rest of the page is left out
+} StatusPage;
+
+static void page_append(StatusPage *page, const char *text) {
+    size_t len = strlen(text);
+    while (len > 0 && !page->truncated) {
+        if (page->count == 0 || page->used == HTTP_PAGE_BLOCK_LEN) {
+            char *block = page->count < HTTP_PAGE_BLOCKS ? (char *)msg_pool_alloc(&page_pool) : NULL;
+            if (block == NULL) {
+                page->truncated = true;
+                return;
+            }
+            page->blocks[page->count++] = block;
+            page->used = 0;
+        }
+        size_t n = HTTP_PAGE_BLOCK_LEN - page->used;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(page->blocks[page->count - 1] + page->used, text, n);
+        page->used += n;
+        text += n;
+        len -= n;
+    }
+}
+
 // HTTP Server Request Handler for Root Path
 static esp_err_t root_get_handler(httpd_req_t *req)
 {
-    char*  buf;
-    size_t buf_len;
-
-    // Estimate buffer size (can be quite large for HTML)
-    // Increased to 1500 to accommodate more data and styling
-    buf_len = 1500; 
-    buf = malloc(buf_len);
-    if (!buf) {
-        ESP_LOGE(TAG_HTTP_SERVER, "Failed to allocate memory for HTTP response");
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-
+    StatusPage page = { 0 };
     char temp_buffer[256]; // For individual lines/parts
 
     if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(500)) == pdTRUE) {
         // Start HTML
-        snprintf(buf, buf_len, "<!DOCTYPE html><html><head><title>ESP32 Master Status</title>"
-                              "<meta http-equiv=\"refresh\" content=\"10\">" // Auto-refresh every 10 seconds
-                              "<style>"
-                              "body { font-family: Arial, sans-serif; margin: 20px; background-color: #f4f4f4; color: #333; }"
-                              "h1 { color: #0056b3; }"
-                              "h2 { color: #0056b3; border-bottom: 1px solid #ccc; padding-bottom: 5px; }"
-                              ".status-ok { color: green; font-weight: bold; }"
-                              ".status-offline { color: red; font-weight: bold; }"
-                              "ul { list-style-type: none; padding-left: 0; }"
-                              "li { background-color: #fff; border: 1px solid #ddd; margin-bottom: 5px; padding: 10px; border-radius: 4px; }"
-                              ".container { background-color: #fff; padding: 20px; border-radius: 8px; box-shadow: 0 0 10px rgba(0,0,0,0.1); }"
-                              "</style>"
-                              "</head><body><div class=\"container\"><h1>ESP32 Master Status</h1>");
+        page_append(&page, "<!DOCTYPE html><html><head><title>ESP32 Master Status</title>"
+                           "<meta http-equiv=\"refresh\" content=\"10\">" // Auto-refresh every 10 seconds
+                           "<style>"
+                           "body { font-family: Arial, sans-serif; margin: 20px; background-color: #f4f4f4; color: #333; }"
+                           "h1 { color: #0056b3; }"
+                           "h2 { color: #0056b3; border-bottom: 1px solid #ccc; padding-bottom: 5px; }"
+                           ".status-ok { color: green; font-weight: bold; }"
+                           ".status-offline { color: red; font-weight: bold; }"
+                           "ul { list-style-type: none; padding-left: 0; }"
+                           "li { background-color: #fff; border: 1px solid #ddd; margin-bottom: 5px; padding: 10px; border-radius: 4px; }"
+                           ".container { background-color: #fff; padding: 20px; border-radius: 8px; box-shadow: 0 0 10px rgba(0,0,0,0.1); }"
+                           "</style>"
+                           "</head><body><div class=\"container\"><h1>ESP32 Master Status</h1>");
 
         // MQTT Status
         snprintf(temp_buffer, sizeof(temp_buffer), "<p>MQTT Status: <span class=\"%s\">%s</span></p>",
                  g_web_server_data.mqtt_connected ? "status-ok" : "status-offline",
                  g_web_server_data.mqtt_connected ? "Connected" : "Disconnected");
-        strlcat(buf, temp_buffer, buf_len);
+        page_append(&page, temp_buffer);
+
+        // Broker and outage statistics from the connection supervisor
+        const conn_outage_stats_t *conn_stats = &g_web_server_data.conn_stats;
+        snprintf(temp_buffer, sizeof(temp_buffer),
+                 "<p>Broker: %s<br>Outages: %u (last %u ms, max %u ms, total %llu ms), failovers: %u</p>",
+                 g_web_server_data.mqtt_broker_uri ? g_web_server_data.mqtt_broker_uri : "N/A",
+                 conn_stats->outage_count, conn_stats->last_outage_ms, conn_stats->max_outage_ms,
+                 (unsigned long long)conn_stats->total_outage_ms, conn_stats->failovers);
+        page_append(&page, temp_buffer);
+
+#if MASTER_EMBEDDED_BROKER_ENABLED
+        const mqtt_broker_stats_t *broker_stats = &g_web_server_data.broker_stats;
+        snprintf(temp_buffer, sizeof(temp_buffer),
+                 "<p>Embedded broker: %u clients, %u messages in, %u out (%u dropped), %u rejected connections</p>",
+                 broker_stats->active_clients, broker_stats->publishes_in, broker_stats->publishes_out,
+                 broker_stats->deliveries_dropped, broker_stats->connections_rejected);
+        page_append(&page, temp_buffer);
+#endif
 
         // System Uptime
-        uint32_t uptime_total_seconds = g_web_server_data.system_uptime_seconds;
+        uint32_t uptime_total_seconds = (esp_log_timestamp() - system_start_time_ms) / 1000;
         uint32_t days = uptime_total_seconds / (24 * 3600);
         uint32_t hours = (uptime_total_seconds % (24 * 3600)) / 3600;
         uint32_t minutes = (uptime_total_seconds % 3600) / 60;
         uint32_t seconds = uptime_total_seconds % 60;
         snprintf(temp_buffer, sizeof(temp_buffer), "<p>System Uptime: %u days, %02u:%02u:%02u</p>", days, hours, minutes, seconds);
-        strlcat(buf, temp_buffer, buf_len);
+        page_append(&page, temp_buffer);
 
 
-        // Module Status
-        strlcat(buf, "<h2>Module Status</h2>", buf_len);
-        for (int i = 0; i < NUM_SLAVE_MODULES; i++) {
-            snprintf(temp_buffer, sizeof(temp_buffer), "<p>Module %d: <span class=\"%s\">%s</span></p>",
-                     i + 1,
-                     g_web_server_data.module_status[i] ? "status-ok" : "status-offline",
-                     g_web_server_data.module_status[i] ? "Online" : "Offline");
-            strlcat(buf, temp_buffer, buf_len);
+        // Module Status (from the runtime registry)
+        page_append(&page, "<h2>Module Status</h2>");
+        if (xSemaphoreTake(module_registry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            size_t module_count = module_registry_count(&module_registry);
+            if (module_count == 0) {
+                page_append(&page, "<p>No module discovered yet.</p>");
+            }
+            for (size_t i = 0; i < module_count; i++) {
+                const module_info_t *module = module_registry_at(&module_registry, i);
+                esp_ip4_addr_t ip = { .addr = module->ipv4 };
+                snprintf(temp_buffer, sizeof(temp_buffer),
+                         "<p>Module %u (%s, " IPSTR ", fw %s): <span class=\"%s\">%s</span> - %u samples</p>",
+                         module->id, module->room[0] ? module->room : "?", IP2STR(&ip),
+                         module->firmware_version[0] ? module->firmware_version : "?",
+                         module->online ? "status-ok" : "status-offline",
+                         module->online ? "Online" : "Offline", module->sample_count);
+                page_append(&page, temp_buffer);
+                // Health score once warmed up, with what costs it points
+                const sensor_health_t *health = &module->health;
+                if (health->samples >= sensor_health_config.warmup_samples) {
+                    char reasons[48];
+                    sensor_health_describe(health->reasons, reasons, sizeof(reasons));
+                    snprintf(temp_buffer, sizeof(temp_buffer),
+                             "<p>&nbsp;&nbsp;Health: <span class=\"%s\">%u/100</span>%s%s%s - signal %.0f, "
+                             "errors %.0f%%, lost %.0f%%</p>",
+                             health->degraded ? "status-offline" : "status-ok", health->score,
+                             reasons[0] ? " (" : "", reasons, reasons[0] ? ")" : "", health->signal_mean,
+                             health->error_rate * 100.0f, health->drop_rate * 100.0f);
+                    page_append(&page, temp_buffer);
+                }
+            }
+            xSemaphoreGive(module_registry_mutex);
+        }
+
+        // Fusion mode of each room, after the load of each shard and of the
+        // rings feeding it. The counters are 32-bit words, each written by a
+        // single task: read without lock.
+        page_append(&page, "<h2>Rooms</h2>");
+        page_append(&page, "<p>Radar rings (waiting/size, peak, dropped):");
+        for (int i = 0; i < RADAR_SOURCE_COUNT; i++) {
+            spsc_ring_stats_t rs;
+            spsc_ring_get_stats(&radar_rings[i].ring, &rs);
+            snprintf(temp_buffer, sizeof(temp_buffer), " %s %u/%u, %u, %u;", radar_source_names[i], rs.count,
+                     rs.capacity, rs.high_water, rs.dropped);
+            page_append(&page, temp_buffer);
+        }
+        page_append(&page, "</p>");
+        msg_pool_stats_t fused_stats, page_stats;
+        msg_pool_get_stats(&fused_pool, &fused_stats);
+        msg_pool_get_stats(&page_pool, &page_stats);
+        snprintf(temp_buffer, sizeof(temp_buffer),
+                 "<p>Fused pool: %u/%u blocks in use, peak %u, %u outputs dropped when empty. "
+                 "Page pool: peak %u/%u blocks of %u bytes</p>", fused_stats.in_use, fused_stats.count,
+                 fused_stats.peak, fused_stats.exhausted, page_stats.peak, page_stats.count, page_stats.block_size);
+        page_append(&page, temp_buffer);
+        snprintf(temp_buffer, sizeof(temp_buffer), "<p>Zones: %u configured, grids of %u mm, arena %u/%u words. "
+                 "Heatmaps: %u mm cells, half-life %u s, arena %u/%u cells "
+                 "(<a href=\"/heatmap?room=0&amp;tile=1\">/heatmap?room=N&amp;tile=K</a>)</p>",
+                 (unsigned)NUM_ZONES, ZONE_GRID_CELL_MM, zone_engine.arena_used, zone_engine.arena_len,
+                 HEATMAP_CELL_MM, HEATMAP_HALF_LIFE_S, heatmap_arena_used, HEATMAP_ARENA_CELLS);
+        page_append(&page, temp_buffer);
+        for (int s = 0; s < pipeline_plan.shard_count; s++) {
+            spsc_ring_stats_t in, fall, tap;
+            spsc_ring_get_stats(&pipeline_shards[s].radar_ring.ring, &in);
+            spsc_ring_get_stats(&pipeline_shards[s].fused_ring.ring, &fall);
+            spsc_ring_get_stats(&web_tap_rings[s].ring, &tap);
+            snprintf(temp_buffer, sizeof(temp_buffer),
+                     "<p>Shard %d (core %u): %d rooms, %u samples, %u dropped (ring %u/%u, peak %u); "
+                     "%u outputs, %u lost by the fall ring (peak %u/%u), %u by the web tap</p>", s,
+                     pipeline_plan.core[s], pipeline_shard_room_count(&pipeline_plan, s, g_web_server_data.room_count),
+                     pipeline_plan.routed[s], pipeline_plan.dropped[s], in.count, in.capacity, in.high_water,
+                     pipeline_shards[s].fused_bus.published, fall.dropped, fall.high_water, fall.capacity, tap.dropped);
+            page_append(&page, temp_buffer);
+        }
+        if (g_web_server_data.room_count == 0) {
+            page_append(&page, "<p>No room yet.</p>");
+        }
+        for (int i = 0; i < g_web_server_data.room_count; i++) {
+            snprintf(temp_buffer, sizeof(temp_buffer), "<p>Room %d '%s' (shard %d): <span class=\"%s\">%s</span> - %u/%u modules live</p>",
+                     i, g_web_server_data.rooms[i].name, pipeline_shard_of_room(&pipeline_plan, i),
+                     g_web_server_data.rooms[i].degraded ? "status-offline" : "status-ok",
+                     g_web_server_data.rooms[i].degraded ? "Degraded" : "Normal",
+                     g_web_server_data.rooms[i].alive, g_web_server_data.rooms[i].modules);
+            page_append(&page, temp_buffer);
+            if (g_web_server_data.rooms[i].still_ms != 0) {
+                uint8_t level = g_web_server_data.rooms[i].inactivity_level;
+                snprintf(temp_buffer, sizeof(temp_buffer),
+                         "<p>&nbsp;&nbsp;No significant motion for %u min: <span class=\"%s\">level %u/%d</span></p>",
+                         g_web_server_data.rooms[i].still_ms / 60000, level != 0 ? "status-offline" : "status-ok",
+                         level, INACTIVITY_LEVELS);
+                page_append(&page, temp_buffer);
+            }
+            if (g_web_server_data.rooms[i].has_person) {
+                const fall_feature_values_t *f = &g_web_server_data.rooms[i].person_features;
+                char upright[16] = "never";
+                if (f->since_upright_ms != UINT32_MAX) {
+                    snprintf(upright, sizeof(upright), "%u s ago", f->since_upright_ms / 1000);
+                }
+                uint16_t zone = g_web_server_data.rooms[i].person_zone;
+                snprintf(temp_buffer, sizeof(temp_buffer),
+                         "<p>&nbsp;&nbsp;Track %u (%s, zone %s): speed %u mm/s, accel %d mm/s&sup2;, peak descent %u mm/s, "
+                         "position std %u mm over %u samples, upright %s</p>",
+                         g_web_server_data.rooms[i].person_track_id,
+                         fall_state_name(g_web_server_data.rooms[i].person_fall_state),
+                         zone != ZONE_NONE ? zone_config[zone].name : "none", f->speed_mm_s, f->accel_mm_s2,
+                         f->peak_descent_mm_s, f->position_std_mm, f->samples, upright);
+                page_append(&page, temp_buffer);
+            }
+            const FusedData *last = g_web_server_data.rooms[i].last_output;
+            if (last != NULL) {
+                char position[40] = "no position";
+                if (last->sigma_cm != FUSED_SIGMA_UNKNOWN) {
+                    snprintf(position, sizeof(position), "(%d, %d) mm &plusmn; %u cm", last->x_mm, last->y_mm,
+                             last->sigma_cm);
+                }
+                snprintf(temp_buffer, sizeof(temp_buffer),
+                         "<p>&nbsp;&nbsp;Last output %u ms ago: %s (%u %%), %s, %u occupants; %u outputs</p>",
+                         esp_log_timestamp() - last->timestamp, radar_posture_name((radar_posture_t)last->posture),
+                         last->posture_pct[last->posture < RADAR_POSTURE_COUNT ? last->posture : 0], position,
+                         last->occupants, g_web_server_data.rooms[i].outputs);
+                page_append(&page, temp_buffer);
+            }
         }
 
         // Last Alerts
-        strlcat(buf, "<h2>Last Alerts</h2><ul>", buf_len);
+        page_append(&page, "<h2>Last Alerts</h2>");
+        if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+            alert_outbox_stats_t outbox_stats = alert_outbox.stats;
+            size_t outbox_count = alert_outbox_count(&alert_outbox);
+            xSemaphoreGive(alert_outbox_mutex);
+            uint32_t mean_ms = outbox_stats.latency_count
+                                   ? (uint32_t)(outbox_stats.latency_sum_ms / outbox_stats.latency_count) : 0;
+            snprintf(temp_buffer, sizeof(temp_buffer),
+                     "<p>Alert outbox: <span class=\"%s\">%u waiting</span>, %u delivered (latency last %u ms, "
+                     "mean %u ms, max %u ms), %u retries, %u dropped</p>",
+                     outbox_count ? "status-offline" : "status-ok", (unsigned)outbox_count, outbox_stats.delivered,
+                     outbox_stats.latency_last_ms, mean_ms, outbox_stats.latency_max_ms, outbox_stats.retries,
+                     outbox_stats.dropped);
+            page_append(&page, temp_buffer);
+        }
+        page_append(&page, "<ul>");
         if (g_web_server_data.stored_alert_count == 0) {
-            strlcat(buf, "<li>No alerts yet.</li>", buf_len);
+            page_append(&page, "<li>No alerts yet.</li>");
         } else {
             // Display alerts in chronological order (oldest first from circular buffer)
             for (int i = 0; i < g_web_server_data.stored_alert_count; i++) {
                 // Calculate the correct index to read from the circular buffer
                 int alert_idx = (g_web_server_data.alert_write_index - g_web_server_data.stored_alert_count + i + 5) % 5;
                 snprintf(temp_buffer, sizeof(temp_buffer), "<li>%s</li>", g_web_server_data.last_alerts[alert_idx]);
-                strlcat(buf, temp_buffer, buf_len);
+                page_append(&page, temp_buffer);
             }
         }
-        strlcat(buf, "</ul>", buf_len);
+        page_append(&page, "</ul>");
 
         xSemaphoreGive(g_web_data_mutex);
     } else {
         ESP_LOGE(TAG_HTTP_SERVER, "Failed to take g_web_data_mutex for HTTP handler");
-        snprintf(buf, buf_len, "<h1>Error fetching status</h1><p>Could not access system data. Please try again.</p>");
+        page_append(&page, "<h1>Error fetching status</h1><p>Could not access system data. Please try again.</p>");
         // No need to give mutex if not taken
     }
 
-    // End HTML
-    strlcat(buf, "</div></body></html>", buf_len);
-
+    // Sent with no lock held: a slow client only holds up the HTTP task
     httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, buf, strlen(buf));
+    esp_err_t err = ESP_OK;
+    for (int i = 0; i < page.count; i++) {
+        if (err == ESP_OK) {
+            err = httpd_resp_send_chunk(req, page.blocks[i], i + 1 < page.count ? HTTP_PAGE_BLOCK_LEN : page.used);
+        }
+        msg_pool_release(&page_pool, page.blocks[i]);
+    }
+    if (err == ESP_OK && page.truncated) {
+        ESP_LOGW(TAG_HTTP_SERVER, "Status page larger than %d bytes, truncated.", HTTP_PAGE_BLOCKS * HTTP_PAGE_BLOCK_LEN);
+        err = httpd_resp_sendstr_chunk(req, "<p>(page truncated)</p>");
+    }
+    // End HTML
+    if (err == ESP_OK) {
+        err = httpd_resp_sendstr_chunk(req, "</div></body></html>");
+    }
+    if (err == ESP_OK) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return err;
+}
 
-    free(buf); // Free the buffer
-    return ESP_OK;
+// Binary heatmap of a room (format in heatmap.h), written into a page_pool
+// block: GET /heatmap?room=<n>&tile=<k>, k cells per tile side (default 1)
+static esp_err_t heatmap_get_handler(httpd_req_t *req)
+{
+    char query[32], value[8];
+    int room = -1, tile = 1;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "room", value, sizeof(value)) == ESP_OK) {
+            room = atoi(value);
+        }
+        if (httpd_query_key_value(query, "tile", value, sizeof(value)) == ESP_OK) {
+            tile = atoi(value);
+        }
+    }
+    if (room < 0 || room >= FUSION_MAX_ROOMS || room_heatmaps[room].cells == NULL || tile < 1 || tile > 255) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No heatmap for this room/tile");
+    }
+    uint8_t *block = msg_pool_alloc(&page_pool);
+    if (block == NULL) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Busy");
+    }
+    int len = -1;
+    for (int attempt = 0; attempt < 3 && len < 0; attempt++) { // -1: rescaled during the read
+        if (attempt > 0) {
+            vTaskDelay(1); // Let FallDetector_task finish the rescale
+        }
+        len = heatmap_export(&room_heatmaps[room], (uint8_t)room, (uint8_t)tile, esp_log_timestamp(), block,
+                             HTTP_PAGE_BLOCK_LEN);
+    }
+    esp_err_t err;
+    if (len > 0) {
+        httpd_resp_set_type(req, "application/octet-stream");
+        err = httpd_resp_send(req, (const char *)block, len);
+    } else if (len == 0) {
+        err = httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Larger tiles needed");
+    } else {
+        // Still rescaling: transient, the request itself is fine (no 503 in httpd_err_code_t)
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_set_type(req, "text/plain");
+        err = httpd_resp_sendstr(req, "Heatmap busy, retry");
+    }
+    msg_pool_release(&page_pool, block);
+    return err;
 }
 
 // HTTP Server URI Registration
@@ -400,6 +1038,13 @@ static const httpd_uri_t root_uri = {
     .user_ctx = NULL 
 };
 
+static const httpd_uri_t heatmap_uri = {
+    .uri      = "/heatmap",
+    .method   = HTTP_GET,
+    .handler  = heatmap_get_handler,
+    .user_ctx = NULL
+};
+
 // Function to start the web server
 static httpd_handle_t start_webserver(void)
 {
@@ -407,11 +1052,13 @@ static httpd_handle_t start_webserver(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.max_open_sockets = 7; 
     config.lru_purge_enable = true; 
+    config.core_id = NETWORK_CORE; // Keep the pipeline cores free
 
     ESP_LOGI(TAG_HTTP_SERVER, "Starting HTTP server on port: '%d'", config.server_port);
     if (httpd_start(&server, &config) == ESP_OK) {
         ESP_LOGI(TAG_HTTP_SERVER, "Registering URI handlers");
         httpd_register_uri_handler(server, &root_uri);
+        httpd_register_uri_handler(server, &heatmap_uri);
         return server;
     }
 
@@ -491,11 +1138,48 @@ void discover_radar_modules_task(void *pvParameters) {
                     #endif
                 }
 
-                // TXT Records
+                // TXT Records: module_id (required), room and version (optional)
                 ESP_LOGI(TAG_MDNS_DISCOVERY, "  TXT Records (%d):", r->txt_count);
+                int module_id = 0;
+                const char *room = NULL;
+                const char *version = NULL;
                 for (int k = 0; k < r->txt_count; k++) {
                     ESP_LOGI(TAG_MDNS_DISCOVERY, "    %s = %s", r->txt[k].key, r->txt[k].value ? r->txt[k].value : "N/A");
-                     // TODO: Here you could parse module_id, e.g. if (strcmp(r->txt[k].key, "module_id") == 0) ...
+                    if (strcmp(r->txt[k].key, "module_id") == 0) {
+                        module_registry_parse_id(r->txt[k].value, &module_id);
+                    } else if (strcmp(r->txt[k].key, "room") == 0) {
+                        room = r->txt[k].value;
+                    } else if (strcmp(r->txt[k].key, "version") == 0) {
+                        version = r->txt[k].value;
+                    }
+                }
+
+                uint32_t ipv4 = 0;
+                for (int j = 0; j < r->addr_count; j++) {
+                    if (r->addr[j].addr.type == ESP_IPADDR_TYPE_V4) {
+                        ipv4 = r->addr[j].addr.u_addr.ip4.addr;
+                        break;
+                    }
+                }
+                if (module_id == 0) {
+                    ESP_LOGW(TAG_MDNS_DISCOVERY, "  Service without a valid module_id TXT record, ignored.");
+                } else if (xSemaphoreTake(module_registry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                    bool known = module_registry_find(&module_registry, module_id) != NULL;
+                    module_info_t *module = module_registry_note_announce(&module_registry, module_id, esp_log_timestamp(),
+                                                                         room, r->hostname, ipv4, version);
+                    // Announced but silent: offline SLAVE_MODULE_TIMEOUT_S after its discovery
+                    if (module != NULL && module->last_seen_ms == 0 && !module->offline_alerted &&
+                        !timer_wheel_armed(&watchdog_wheel, LIVENESS_TIMER(module_slot(module)))) {
+                        timer_wheel_arm(&watchdog_wheel, LIVENESS_TIMER(module_slot(module)),
+                                        module->first_seen_ms + SLAVE_MODULE_TIMEOUT_S * 1000 + 1);
+                    }
+                    xSemaphoreGive(module_registry_mutex);
+                    if (module == NULL) {
+                        ESP_LOGE(TAG_MDNS_DISCOVERY, "  Module registry full (%d), module %d not registered.",
+                                 MODULE_REGISTRY_MAX_MODULES, module_id);
+                    } else if (!known) {
+                        ESP_LOGI(TAG_MDNS_DISCOVERY, "  New module %d registered (room %s).", module_id, room ? room : "?");
+                    }
                 }
                 r = r->next;
             }
@@ -511,8 +1195,6 @@ void discover_radar_modules_task(void *pvParameters) {
 
 static void master_wifi_init_sta(void)
 {
-    wifi_event_group = xEventGroupCreate();
-
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     esp_netif_create_default_wifi_sta();
@@ -522,6 +1204,7 @@ static void master_wifi_init_sta(void)
 
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
+    esp_event_handler_instance_t instance_lost_ip;
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                         ESP_EVENT_ANY_ID,
                                                         &master_wifi_event_handler,
@@ -532,6 +1215,11 @@ static void master_wifi_init_sta(void)
                                                         &master_wifi_event_handler,
                                                         NULL,
                                                         &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                        IP_EVENT_STA_LOST_IP,
+                                                        &master_wifi_event_handler,
+                                                        NULL,
+                                                        &instance_lost_ip));
 
     wifi_config_t wifi_config = {
         .sta = {
@@ -544,31 +1232,36 @@ static void master_wifi_init_sta(void)
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config) );
     ESP_ERROR_CHECK(esp_wifi_start() );
 
-    ESP_LOGI(TAG_NETWORK, "master_wifi_init_sta finished. Waiting for connection...");
-
-    #if 1 
-    ESP_LOGW(TAG_NETWORK, "SIMULATION: Forcing Wi-Fi connected bit after 3 seconds for master.");
-    vTaskDelay(pdMS_TO_TICKS(3000));
-    xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
-    #endif
+    ESP_LOGI(TAG_NETWORK, "master_wifi_init_sta finished. Connection is driven by the supervisor.");
 }
 
-static bool parse_radar_json(const char* json_str, int data_len, RadarMessage* msg) {
+// `module_id_hint` (> 0) comes from the MQTT 5 user property; "id_module" is then optional.
+// Accepts both the pretty-printed (MQTT 3.1.1 slaves) and the compact (MQTT 5 slaves) layouts.
+static bool parse_radar_json(const char* json_str, int data_len, int module_id_hint, RadarMessage* msg) {
     if (json_str == NULL || msg == NULL || data_len <= 0) {
         return false;
     }
 
     char temp_json_str[data_len + 1]; 
     memcpy(temp_json_str, json_str, data_len);
-    temp_json_str[data_len] = '\\0';
+    temp_json_str[data_len] = '\0';
 
     char* ptr;
     bool success = true;
-
-    ptr = strstr(temp_json_str, "\"id_module\":");
-    if (ptr) {
-        if (sscanf(ptr + strlen("\"id_module\":"), "%d", &msg->module_id) != 1) success = false;
-    } else success = false;
+    int module_id = module_id_hint;
+    float distance_m = 0.0f, moving_m = 0.0f, static_m = 0.0f;
+    int signal = 0;
+
+    if (module_id_hint <= 0) {
+        ptr = strstr(temp_json_str, "\"id_module\":");
+        if (ptr) {
+            if (sscanf(ptr + strlen("\"id_module\":"), "%d", &module_id) != 1) success = false;
+        } else success = false;
+    }
+    if (success && (module_id < 1 || module_id > UINT8_MAX)) {
+        ESP_LOGE(TAG_FUSION, "Module id %d out of range in JSON.", module_id);
+        success = false;
+    }
 
     ptr = strstr(temp_json_str, "\"timestamp\":");
     if (ptr && success) {
@@ -577,33 +1270,47 @@ static bool parse_radar_json(const char* json_str, int data_len, RadarMessage* m
 
     ptr = strstr(temp_json_str, "\"distance_m\":");
     if (ptr && success) {
-        if (sscanf(ptr + strlen("\"distance_m\":"), "%f", &msg->distance_m) != 1) success = false;
+        if (sscanf(ptr + strlen("\"distance_m\":"), "%f", &distance_m) != 1) success = false;
     } else success = false;
     
     ptr = strstr(temp_json_str, "\"signal\":");
     if (ptr && success) {
-        if (sscanf(ptr + strlen("\"signal\":"), "%d", &msg->signal) != 1) success = false;
+        if (sscanf(ptr + strlen("\"signal\":"), "%d", &signal) != 1) success = false;
     } else success = false;
 
-    ptr = strstr(temp_json_str, "\"posture\": \"");
+    // LD2410 targets (slaves >= 1.2.0), optional: older slaves only send distance_m
+    bool has_targets = false;
+    ptr = strstr(temp_json_str, "\"moving_m\":");
+    if (ptr && success) {
+        has_targets = sscanf(ptr + strlen("\"moving_m\":"), "%f", &moving_m) == 1;
+    }
+    ptr = strstr(temp_json_str, "\"static_m\":");
+    if (ptr && has_targets) {
+        has_targets = sscanf(ptr + strlen("\"static_m\":"), "%f", &static_m) == 1;
+    } else has_targets = false;
+
+    ptr = strstr(temp_json_str, "\"posture\":");
     if (ptr && success) {
-        ptr += strlen("\"posture\": \"");
-        char* end_quote = strchr(ptr, '\"');
+        ptr += strlen("\"posture\":");
+        while (*ptr == ' ') ptr++; // "posture": "X" (pretty) or "posture":"X" (compact)
+        char* end_quote = (*ptr == '\"') ? strchr(++ptr, '\"') : NULL;
         if (end_quote) {
-            int posture_len = end_quote - ptr;
-            if (posture_len < sizeof(msg->posture)) {
-                strncpy(msg->posture, ptr, posture_len);
-                msg->posture[posture_len] = '\\0';
-            } else {
-                ESP_LOGE(TAG_FUSION, "Posture string too long in JSON.");
-                success = false;
-            }
+            *end_quote = '\0'; // temp_json_str is a private copy
+            msg->posture = (uint8_t)radar_posture_from_string(ptr); // Unknown names (e.g. "ERROR") -> UNKNOWN
         } else success = false;
     } else success = false;
 
     if (success) {
-        ESP_LOGD(TAG_FUSION, "Parsed JSON: id=%d, ts=%u, dist=%.2f, posture=%s, sig=%d",
-                 msg->module_id, msg->timestamp, msg->distance_m, msg->posture, msg->signal);
+        msg->module_id = (uint8_t)module_id;
+        msg->distance_mm = pipeline_distance_mm(distance_m);
+        msg->moving_mm = has_targets ? pipeline_distance_mm(moving_m) : 0;
+        msg->static_mm = has_targets ? pipeline_distance_mm(static_m) : 0;
+        msg->signal = (uint8_t)(signal < 0 ? 0 : (signal > 100 ? 100 : signal));
+        msg->flags = has_targets ? RADAR_MSG_HAS_TARGETS : 0;
+        msg->sequence = 0;
+        ESP_LOGD(TAG_FUSION, "Parsed JSON: id=%u, ts=%u, dist=%u mm (moving %u, static %u), posture=%s, sig=%u",
+                 msg->module_id, msg->timestamp, msg->distance_mm, msg->moving_mm, msg->static_mm,
+                 radar_posture_name((radar_posture_t)msg->posture), msg->signal);
     } else {
         ESP_LOGE(TAG_FUSION, "Failed to parse one or more fields in JSON: %s", temp_json_str);
     }
@@ -611,6 +1318,116 @@ static bool parse_radar_json(const char* json_str, int data_len, RadarMessage* m
 }
 
 
+// True when the last level of `topic` starts with RADAR_TOPIC_PREFIX.
+static bool is_radar_topic(const char *topic, int topic_len) {
+    int level_start = 0;
+    for (int i = 0; i < topic_len; i++) {
+        if (topic[i] == '/') {
+            level_start = i + 1;
+        }
+    }
+    size_t prefix_len = strlen(RADAR_TOPIC_PREFIX);
+    return topic_len - level_start >= (int)prefix_len &&
+           memcmp(topic + level_start, RADAR_TOPIC_PREFIX, prefix_len) == 0;
+}
+
+// Parses one radar JSON payload and hands it to the RadarRouter through
+// `ring`, the ring of the calling task: the external MQTT client and the
+// embedded broker each have theirs. Never blocks. `meta` (MQTT 5 user
+// properties) may be NULL.
+static void master_handle_radar_payload(const char *data, int data_len, const RadarPayloadMeta *meta,
+                                        HotRing *ring) {
+    RadarMessage received_radar_msg;
+    if (parse_radar_json(data, data_len, meta ? meta->module_id : 0, &received_radar_msg)) {
+        if (meta != NULL && meta->has_sequence) {
+            received_radar_msg.flags |= RADAR_MSG_HAS_SEQUENCE;
+            received_radar_msg.sequence = meta->sequence;
+        }
+        ESP_LOGI(TAG_NETWORK, "Parsed Radar Data: ID=%u, TS=%u, Dist=%u mm, Posture=%s, Sig=%u",
+                 received_radar_msg.module_id, received_radar_msg.timestamp, received_radar_msg.distance_mm,
+                 radar_posture_name((radar_posture_t)received_radar_msg.posture), received_radar_msg.signal);
+
+        if (!hot_ring_push(ring, &received_radar_msg)) {
+            ESP_LOGE(TAG_NETWORK, "Radar ring full, sample of module %u dropped.", received_radar_msg.module_id);
+        } else {
+            ESP_LOGD(TAG_NETWORK, "Radar data handed to the RadarRouter.");
+        }
+    } else {
+        ESP_LOGE(TAG_NETWORK, "Failed to parse incoming radar JSON data. Raw: %.*s", data_len, data);
+    }
+}
+
+#if MASTER_USE_MQTT5
+// Reads the radar user properties ("m" module id, "s" sequence) of an MQTT 5
+// message received by esp-mqtt. esp-mqtt hands out heap copies of each item.
+static void master_read_user_properties(mqtt5_user_property_handle_t handle, RadarPayloadMeta *meta) {
+    uint8_t count = esp_mqtt5_client_get_user_property_len(handle);
+    if (count == 0) {
+        return;
+    }
+    esp_mqtt5_user_property_item_t *items = malloc(count * sizeof(esp_mqtt5_user_property_item_t));
+    if (items == NULL) {
+        return;
+    }
+    if (esp_mqtt5_client_get_user_property(handle, items, &count) == ESP_OK) {
+        for (int i = 0; i < count; i++) {
+            char *end = NULL;
+            unsigned long value = strtoul(items[i].value, &end, 10);
+            bool numeric = items[i].value[0] != '\0' && *end == '\0';
+            if (numeric && strcmp(items[i].key, RADAR_PROP_MODULE_ID) == 0 && value >= 1 && value <= 255) {
+                meta->module_id = (int)value;
+            } else if (numeric && strcmp(items[i].key, RADAR_PROP_SEQUENCE) == 0 && value <= UINT32_MAX) {
+                meta->has_sequence = true;
+                meta->sequence = (uint32_t)value;
+            }
+            free((char *)items[i].key);
+            free((char *)items[i].value);
+        }
+    }
+    free(items);
+}
+#endif
+
+// Wall clock in s, for the latency of alerts delivered after a reboot; 0
+// until SNTP has set it
+static uint32_t wall_clock_s(void) {
+    time_t now = time(NULL);
+    return now < MASTER_CLOCK_VALID_AFTER ? 0 : (uint32_t)now;
+}
+
+// MQTT_EVENT_CONNECTED: the alerts left in the outbox are published at once
+// on the new connection (AlertManager_task polls while there are some)
+static void alert_outbox_connected(void) {
+    if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG_NETWORK, "Failed to take alert_outbox_mutex on connection; alerts retried after their timeout.");
+        return;
+    }
+    size_t count = alert_outbox_count(&alert_outbox);
+    alert_outbox_reset(&alert_outbox, esp_log_timestamp());
+    xSemaphoreGive(alert_outbox_mutex);
+    if (count > 0) {
+        ESP_LOGI(TAG_ALERT_MANAGER, "%u alerts waiting for the broker, publishing them.", (unsigned)count);
+    }
+}
+
+// MQTT_EVENT_PUBLISHED: PUBACK of a QoS 1 publish, maybe of an alert
+static void alert_outbox_acked(int msg_id) {
+    uint32_t id = 0, latency_ms = 0;
+    bool delivered = false;
+    if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        delivered = alert_outbox_ack(&alert_outbox, msg_id, esp_log_timestamp(), wall_clock_s(), &id, &latency_ms);
+        xSemaphoreGive(alert_outbox_mutex);
+    } else {
+        ESP_LOGE(TAG_NETWORK, "Failed to take alert_outbox_mutex for PUBACK %d; the alert will be published again.",
+                 msg_id);
+    }
+    if (delivered && latency_ms != ALERT_OUTBOX_LATENCY_UNKNOWN) {
+        ESP_LOGI(TAG_ALERT_MANAGER, "Alert %u delivered %u ms after it was raised.", id, latency_ms);
+    } else if (delivered) {
+        ESP_LOGI(TAG_ALERT_MANAGER, "Alert %u delivered (raised before the last reboot, clock not set).", id);
+    }
+}
+
 static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data) {
     ESP_LOGD(TAG_NETWORK, "MQTT Event dispatched from event loop base=%s, event_id=%ld", base, event_id);
     esp_mqtt_event_handle_t event = event_data;
@@ -619,8 +1436,10 @@ static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base,
 
     switch ((esp_mqtt_event_id_t)event_id) {
     case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG_NETWORK, "MQTT_EVENT_CONNECTED to broker %s", MASTER_CONFIG_BROKER_URL);
+        ESP_LOGI(TAG_NETWORK, "MQTT_EVENT_CONNECTED to broker %s", conn_supervisor_active_uri(&conn_supervisor));
         mqtt_connected_flag = true;
+        post_conn_event(CONN_EVT_MQTT_CONNECTED, 0);
+        alert_outbox_connected();
         if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             g_web_server_data.mqtt_connected = true;
             xSemaphoreGive(g_web_data_mutex);
@@ -633,6 +1452,7 @@ static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base,
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG_NETWORK, "MQTT_EVENT_DISCONNECTED");
         mqtt_connected_flag = false;
+        post_conn_event(CONN_EVT_MQTT_DISCONNECTED, 0);
         if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             g_web_server_data.mqtt_connected = false;
             xSemaphoreGive(g_web_data_mutex);
@@ -648,33 +1468,26 @@ static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base,
         break;
     case MQTT_EVENT_PUBLISHED: 
         ESP_LOGI(TAG_NETWORK, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        alert_outbox_acked(event->msg_id);
         break;
     case MQTT_EVENT_DATA:
         ESP_LOGI(TAG_NETWORK, "MQTT_EVENT_DATA received");
         ESP_LOGI(TAG_NETWORK, "TOPIC=%.*s", event->topic_len, event->topic);
         ESP_LOGD(TAG_NETWORK, "DATA (len %d)=%.*s", event->data_len, event->data_len, event->data); 
-        
-        RadarMessage received_radar_msg;
-        if (parse_radar_json(event->data, event->data_len, &received_radar_msg)) {
-            ESP_LOGI(TAG_NETWORK, "Parsed Radar Data: ID=%d, TS=%u, Dist=%.2f, Posture=%s, Sig=%d",
-                     received_radar_msg.module_id, received_radar_msg.timestamp,
-                     received_radar_msg.distance_m, received_radar_msg.posture, received_radar_msg.signal);
-            
-            if (radar_data_queue != NULL) {
-                if (xQueueSend(radar_data_queue, &received_radar_msg, pdMS_TO_TICKS(100)) != pdPASS) {
-                    ESP_LOGE(TAG_NETWORK, "Failed to send radar data to radar_data_queue (queue full or error).");
-                } else {
-                    ESP_LOGD(TAG_NETWORK, "Radar data sent to radar_data_queue successfully.");
-                }
-            } else {
-                 ESP_LOGE(TAG_NETWORK, "radar_data_queue is NULL. Cannot send data."); // This check is good.
+
+        if (is_radar_topic(event->topic, event->topic_len)) {
+            RadarPayloadMeta meta = { 0 };
+#if MASTER_USE_MQTT5
+            if (event->property != NULL && event->property->user_property != NULL) {
+                master_read_user_properties(event->property->user_property, &meta);
             }
-        } else {
-            ESP_LOGE(TAG_NETWORK, "Failed to parse incoming radar JSON data. Raw: %.*s", event->data_len, event->data);
+#endif
+            master_handle_radar_payload(event->data, event->data_len, &meta, &radar_rings[RADAR_SOURCE_MQTT]);
         }
         break;
     case MQTT_EVENT_ERROR:
         ESP_LOGE(TAG_NETWORK, "MQTT_EVENT_ERROR");
+        post_conn_event(CONN_EVT_MQTT_ERROR, 0);
         if (event->error_handle) { // Check if error_handle is not NULL
             ESP_LOGE(TAG_NETWORK, "Last error code reported from esp-tls: 0x%x", event->error_handle->esp_tls_last_esp_err);
             ESP_LOGE(TAG_NETWORK, "Last tls stack error number: 0x%x", event->error_handle->esp_tls_stack_err);
@@ -697,557 +1510,1513 @@ static void master_mqtt_event_handler(void* handler_args, esp_event_base_t base,
     }
 }
 
+// Creates the MQTT client without starting it: the connection supervisor decides
+// when (and to which broker) it connects. esp-mqtt's own auto-reconnect is disabled
+// so that retries follow the supervisor's jittered backoff and failover policy.
 static void master_mqtt_app_start(void) {
     esp_mqtt_client_config_t mqtt_cfg = {
-        .broker.address.uri = MASTER_CONFIG_BROKER_URL,
+        .broker.address.uri = master_broker_uris[0],
         .broker.verification.certificate = mqtt_broker_ca_cert_pem_start,
         .credentials.client_id = MASTER_MQTT_CLIENT_ID,
+        .network.disable_auto_reconnect = true,
+#if MASTER_USE_MQTT5
+        .session.protocol_ver = MQTT_PROTOCOL_V_5,
+#endif
     };
 
-    ESP_LOGI(TAG_NETWORK, "Attempting to start MQTT client, broker URI: %s", mqtt_cfg.broker.address.uri);
+    ESP_LOGI(TAG_NETWORK, "Initializing MQTT client, preferred broker URI: %s", mqtt_cfg.broker.address.uri);
     client_handle = esp_mqtt_client_init(&mqtt_cfg);
     if (client_handle == NULL) {
         ESP_LOGE(TAG_NETWORK, "Failed to initialize MQTT client");
         return;
     }
+#if MASTER_USE_MQTT5
+    esp_mqtt5_connection_property_config_t connect_property = {
+        .topic_alias_maximum = MASTER_MQTT5_TOPIC_ALIAS_MAX,
+    };
+    esp_err_t err = esp_mqtt5_client_set_connect_property(client_handle, &connect_property);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG_NETWORK, "Failed to set MQTT 5 connect properties: %s", esp_err_to_name(err));
+    }
+#endif
     ESP_ERROR_CHECK(esp_mqtt_client_register_event(client_handle, ESP_EVENT_ANY_ID, master_mqtt_event_handler, NULL));
-    ESP_ERROR_CHECK(esp_mqtt_client_start(client_handle));
-    
-    #if 1 
-    ESP_LOGW(TAG_NETWORK, "SIMULATION: MQTT client considered 'started'. Actual connection depends on network.");
-    #endif
 }
 
-
-void NetworkManager_task(void *pvParameters) {
-    ESP_LOGI(TAG_NETWORK, "NetworkManager_task started");
-    
-    master_wifi_init_sta();
-
-    ESP_LOGI(TAG_NETWORK, "Waiting for Wi-Fi connection...");
-    EventBits_t bits = xEventGroupWaitBits(wifi_event_group,
-            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-            pdFALSE, 
-            pdFALSE, 
-            portMAX_DELAY);
-
-    if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG_NETWORK, "Wi-Fi Connected. Initializing MQTT client...");
-        master_mqtt_app_start();
-    } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGE(TAG_NETWORK, "Wi-Fi connection failed. MQTT will not be started.");
+// Publishes the supervisor's view of the link to the status page.
+static void master_conn_update_web_status(bool online) {
+    if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        g_web_server_data.mqtt_connected = online;
+        g_web_server_data.mqtt_broker_uri = conn_supervisor_active_uri(&conn_supervisor);
+        conn_supervisor_get_stats(&conn_supervisor, esp_log_timestamp(), &g_web_server_data.conn_stats);
+        xSemaphoreGive(g_web_data_mutex);
     } else {
-        ESP_LOGE(TAG_NETWORK, "Unexpected event from Wi-Fi event group.");
+        ESP_LOGE(TAG_NETWORK, "Failed to take g_web_data_mutex for connection status.");
     }
+}
 
-    for(;;) {
-        if (mqtt_connected_flag) {
-            ESP_LOGD(TAG_NETWORK, "NetworkManager: MQTT connection active.");
+// Executes the CONN_ACT_* mask returned by the supervisor, in bit order.
+static void master_conn_execute_actions(uint32_t actions) {
+    if (actions & CONN_ACT_WIFI_CONNECT) {
+        esp_err_t err = esp_wifi_connect();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG_NETWORK, "esp_wifi_connect failed: %s", esp_err_to_name(err));
+        }
+    }
+    if ((actions & CONN_ACT_MQTT_STOP) && client_handle != NULL && mqtt_client_running) {
+        esp_mqtt_client_stop(client_handle);
+        mqtt_client_running = false;
+        mqtt_connected_flag = false;
+    }
+    if ((actions & CONN_ACT_MQTT_START) && client_handle != NULL) {
+        const char *uri = conn_supervisor_active_uri(&conn_supervisor);
+        ESP_LOGI(TAG_NETWORK, "Connecting MQTT client to broker %s", uri);
+        if (mqtt_client_running) {
+            esp_mqtt_client_stop(client_handle);
+            mqtt_client_running = false;
+        }
+        esp_err_t err = esp_mqtt_client_set_uri(client_handle, uri);
+        if (err == ESP_OK) {
+            err = esp_mqtt_client_start(client_handle);
+        }
+        if (err == ESP_OK) {
+            mqtt_client_running = true;
         } else {
-            ESP_LOGW(TAG_NETWORK, "NetworkManager: MQTT connection lost or not established. Wi-Fi status: %s",
-                (xEventGroupGetBits(wifi_event_group) & WIFI_CONNECTED_BIT) ? "Connected" : "Disconnected");
-
-            // If Wi-Fi is connected, MQTT client is initialized, but MQTT is not connected, try to start/reconnect.
-            if ((xEventGroupGetBits(wifi_event_group) & WIFI_CONNECTED_BIT) && client_handle != NULL && !mqtt_connected_flag) {
-                ESP_LOGI(TAG_NETWORK, "NetworkManager_task: Wi-Fi is connected but MQTT is not. Attempting to start/reconnect MQTT client...");
-                esp_err_t err = esp_mqtt_client_start(client_handle); // Using start as it handles various states including initial start and reconnect after stop.
-                if (err == ESP_OK) {
-                    ESP_LOGI(TAG_NETWORK, "NetworkManager_task: MQTT client start/reconnect initiated successfully.");
-                    // MQTT_EVENT_CONNECTED will set mqtt_connected_flag = true
-                } else {
-                    ESP_LOGE(TAG_NETWORK, "NetworkManager_task: Failed to start/reconnect MQTT client: %s.", esp_err_to_name(err));
-                }
-            }
+            // The supervisor's connect timeout turns this into a regular failure.
+            ESP_LOGE(TAG_NETWORK, "Failed to start MQTT client: %s", esp_err_to_name(err));
         }
-        vTaskDelay(pdMS_TO_TICKS(30000)); // Check connection status periodically
+    }
+    if (actions & CONN_ACT_PROBE_BROKER) {
+        uint8_t probe_index = conn_supervisor.probe_broker;
+        const char *probe_uri = conn_supervisor_probe_uri(&conn_supervisor);
+        bool reachable = conn_probe_broker(probe_uri, BROKER_PROBE_TIMEOUT_MS);
+        ESP_LOGI(TAG_NETWORK, "Broker probe %s: %s", probe_uri, reachable ? "reachable" : "unreachable");
+        post_conn_event(reachable ? CONN_EVT_PROBE_OK : CONN_EVT_PROBE_FAIL, probe_index);
+    }
+    if (actions & CONN_ACT_NOTIFY_OFFLINE) {
+        ESP_LOGW(TAG_NETWORK, "MQTT link down, outage started.");
+        master_conn_update_web_status(false);
+    }
+    if (actions & CONN_ACT_NOTIFY_ONLINE) {
+        ESP_LOGI(TAG_NETWORK, "MQTT link up via %s (last outage %u ms, %u outages, %u failovers).",
+                 conn_supervisor_active_uri(&conn_supervisor), conn_supervisor.stats.last_outage_ms,
+                 conn_supervisor.stats.outage_count, conn_supervisor.stats.failovers);
+        master_conn_update_web_status(true);
     }
 }
 
-static bool calculate_xy_position(float d1, float d2, float* x, float* y) {
-    ESP_LOGD(TAG_FUSION, "calculate_xy_position called with d1=%.2f, d2=%.2f", d1, d2);
-    *x = 1.0f;
-    *y = 1.5f;
-    ESP_LOGI(TAG_FUSION, "Calculated position: x=%.2f, y=%.2f (stubbed)", *x, *y);
-    return true;
-}
-
-void FusionEngine_task(void *pvParameters) {
-    ESP_LOGI(TAG_FUSION, "FusionEngine_task started");
+// NetworkManager_task owns the connection supervisor: it sleeps until either a
+// Wi-Fi/IP/MQTT event arrives or the supervisor's next deadline expires, so a
+// lost link is handled within one event dispatch instead of a polling period.
+void NetworkManager_task(void *pvParameters) {
+    ESP_LOGI(TAG_NETWORK, "NetworkManager_task started");
 
-    static RadarMessage sensor1_data;
-    static bool sensor1_data_valid = false;
-    static RadarMessage sensor2_data;
-    static bool sensor2_data_valid = false;
+    conn_supervisor_config_t sup_cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&conn_supervisor, &sup_cfg, master_broker_uris, NUM_UPSTREAM_BROKERS, esp_random());
 
-    RadarMessage current_msg;
-    float pos_x, pos_y;
-    char final_posture[16];
+#if MASTER_UPSTREAM_BRIDGE_ENABLED
+    master_mqtt_app_start();
+#endif
+    master_wifi_init_sta(); // WIFI_EVENT_STA_START posts CONN_EVT_START
 
+    conn_event_t event;
     for(;;) {
-        if (xQueueReceive(radar_data_queue, &current_msg, portMAX_DELAY) != pdPASS) {
-            ESP_LOGE(TAG_FUSION, "Error receiving from radar_data_queue. This should not happen with portMAX_DELAY unless queue is deleted.");
-            // If this happens, it might indicate a severe issue.
-            // Add a small delay here to prevent a tight loop if the queue is somehow problematic.
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue; // Skip the rest of the loop iteration
+        uint32_t wait_ms = conn_supervisor_ms_until_deadline(&conn_supervisor, esp_log_timestamp());
+        TickType_t wait_ticks = (wait_ms == CONN_NO_DEADLINE) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms) + 1;
+        if (xQueueReceive(conn_event_queue, &event, wait_ticks) != pdPASS) {
+            event.id = CONN_EVT_TIMEOUT;
+            event.broker_index = 0;
         }
-        
-        ESP_LOGI(TAG_FUSION, "Received data from module_id: %d, ts: %u, dist: %.2f, posture: %s, signal: %d",
-                 current_msg.module_id, current_msg.timestamp, current_msg.distance_m,
-                 current_msg.posture, current_msg.signal);
-
-            // Update last received timestamp for the specific module
-            if (current_msg.module_id >= 1 && current_msg.module_id <= NUM_SLAVE_MODULES) {
-                uint32_t reception_time_ms = esp_log_timestamp();
-                last_received_timestamp_ms[current_msg.module_id - 1] = reception_time_ms;
-                ESP_LOGD(TAG_FUSION, "Updated last_received_timestamp_ms for module %d to %u", current_msg.module_id, reception_time_ms);
-
-                if (module_offline_alerted[current_msg.module_id - 1]) {
-                    ESP_LOGI(TAG_FUSION, "Module %d is back online.", current_msg.module_id);
-                    module_offline_alerted[current_msg.module_id - 1] = false;
-                    if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        if (current_msg.module_id -1 < NUM_SLAVE_MODULES) { // Bounds check
-                           g_web_server_data.module_status[current_msg.module_id - 1] = true;
-                        }
-                        xSemaphoreGive(g_web_data_mutex);
-                    } else {
-                        ESP_LOGE(TAG_FUSION, "Failed to take g_web_data_mutex for module online status.");
-                    }
-                    // Optional: Send MODULE_ONLINE alert
-                    // AlertMessage online_alert;
-                    // online_alert.type = ALERT_TYPE_MODULE_ONLINE;
-                    // online_alert.alert_timestamp = reception_time_ms;
-                    // snprintf(online_alert.description, sizeof(online_alert.description), "Module %d back online", current_msg.module_id);
-                    // if (alert_queue != NULL) xQueueSend(alert_queue, &online_alert, pdMS_TO_TICKS(10));
-                }
-            }
-
-
-            if (current_msg.module_id == 1) { 
-                sensor1_data = current_msg;
-                sensor1_data_valid = true;
-                ESP_LOGD(TAG_FUSION, "Stored data for Sensor 1 (ts: %u).", sensor1_data.timestamp);
-            } else if (current_msg.module_id == 2) { 
-                sensor2_data = current_msg;
-                sensor2_data_valid = true;
-                ESP_LOGD(TAG_FUSION, "Stored data for Sensor 2 (ts: %u).", sensor2_data.timestamp);
-            } else {
-                ESP_LOGW(TAG_FUSION, "Received data from unknown module_id: %d", current_msg.module_id);
-            }
-
-            if (sensor1_data_valid && sensor2_data_valid) {
-                ESP_LOGD(TAG_FUSION, "Data from both sensors is valid. Checking timestamps...");
-                ESP_LOGD(TAG_FUSION, "Sensor 1 TS: %u, Sensor 2 TS: %u, Diff: %d ms, Window: %d ms",
-                         sensor1_data.timestamp, sensor2_data.timestamp,
-                         abs((int32_t)sensor1_data.timestamp - (int32_t)sensor2_data.timestamp), SENSOR_SYNC_WINDOW_MS);
-
-                if (abs((int32_t)sensor1_data.timestamp - (int32_t)sensor2_data.timestamp) <= SENSOR_SYNC_WINDOW_MS) {
-                    ESP_LOGI(TAG_FUSION, "Synchronized data found for Sensor 1 and Sensor 2.");
-
-                    calculate_xy_position(sensor1_data.distance_m, sensor2_data.distance_m, &pos_x, &pos_y);
-
-                    if (strcmp(sensor1_data.posture, LYING_POSTURE) == 0 || strcmp(sensor2_data.posture, LYING_POSTURE) == 0) {
-                        strcpy(final_posture, LYING_POSTURE);
-                    } else if (strcmp(sensor1_data.posture, MOVING_POSTURE) == 0 || strcmp(sensor2_data.posture, MOVING_POSTURE) == 0) {
-                        strcpy(final_posture, MOVING_POSTURE);
-                    } else if (strcmp(sensor1_data.posture, SITTING_POSTURE) == 0 || strcmp(sensor2_data.posture, SITTING_POSTURE) == 0) {
-                        strcpy(final_posture, SITTING_POSTURE);
-                    } else if (strcmp(sensor1_data.posture, STANDING_POSTURE) == 0 || strcmp(sensor2_data.posture, STANDING_POSTURE) == 0) {
-                        strcpy(final_posture, STANDING_POSTURE);
-                    } else { 
-                        strcpy(final_posture, STILL_POSTURE); 
-                    }
-                    ESP_LOGI(TAG_FUSION, "Final posture: %s", final_posture);
-
-                    FusedData fused_output_data;
-                    fused_output_data.x = pos_x;
-                    fused_output_data.y = pos_y;
-                    strcpy(fused_output_data.final_posture, final_posture);
-                    fused_output_data.timestamp = (sensor1_data.timestamp > sensor2_data.timestamp) ? sensor1_data.timestamp : sensor2_data.timestamp;
-                    
-                    if (fusion_output_queue != NULL) {
-                        if (xQueueSend(fusion_output_queue, &fused_output_data, pdMS_TO_TICKS(100)) != pdPASS) {
-                            ESP_LOGE(TAG_FUSION, "Failed to send fused data to fusion_output_queue (queue full or error).");
-                        } else {
-                            ESP_LOGD(TAG_FUSION, "Fused data sent to fusion_output_queue.");
-                        }
-                    } else {
-                        ESP_LOGE(TAG_FUSION, "fusion_output_queue is NULL."); // This check is good.
-                    }
 
-                    sensor1_data_valid = false;
-                    sensor2_data_valid = false;
-                    ESP_LOGD(TAG_FUSION, "Sensor data invalidated, waiting for new pair.");
-                } else {
-                    ESP_LOGW(TAG_FUSION, "Data not synchronized: Timestamp diff %d ms > %d ms. Invalidating older data.",
-                             abs((int32_t)sensor1_data.timestamp - (int32_t)sensor2_data.timestamp), SENSOR_SYNC_WINDOW_MS);
-                    if (sensor1_data.timestamp < sensor2_data.timestamp) {
-                        sensor1_data_valid = false; 
-                        ESP_LOGI(TAG_FUSION, "Invalidated Sensor 1 data as it was older.");
-                    } else {
-                        sensor2_data_valid = false; 
-                        ESP_LOGI(TAG_FUSION, "Invalidated Sensor 2 data as it was older.");
-                    }
-                }
-            } else {
-                ESP_LOGD(TAG_FUSION, "Waiting for data from the other sensor. S1_valid: %d, S2_valid: %d", sensor1_data_valid, sensor2_data_valid);
-            }
+        conn_state_t previous_state = conn_supervisor.state;
+        uint32_t actions = conn_supervisor_handle(&conn_supervisor, &event, esp_log_timestamp());
+        if (conn_supervisor.state != previous_state) {
+            ESP_LOGI(TAG_NETWORK, "Connection state %s -> %s (event %d, actions 0x%02x)",
+                     conn_state_name(previous_state), conn_state_name(conn_supervisor.state),
+                     event.id, (unsigned int)actions);
         }
+        master_conn_execute_actions(actions);
     }
 }
 
-void FallDetector_task(void *pvParameters) {
-    ESP_LOGI(TAG_FALL_DETECTOR, "FallDetector_task started");
+#if MASTER_EMBEDDED_BROKER_ENABLED
+static const char *TAG_BROKER = "EmbeddedBroker";
 
-    static FusedData previous_data;
-    static bool previous_data_valid = false;
-    static uint32_t potential_fall_start_time_ms = 0;
-    static bool in_potential_fall_state = false;
+// The broker is single threaded: other tasks hand it messages through this queue.
+typedef struct {
+    char topic[32];
+    char payload[128];
+} BrokerOutboundMessage;
+
+static mqtt_broker_t embedded_broker;
+static QueueHandle_t broker_outbound_queue = NULL;
+
+static void embedded_broker_on_publish(const mqtt_broker_message_t *msg, void *ctx) {
+    if (is_radar_topic(msg->topic, (int)msg->topic_len)) {
+        RadarPayloadMeta meta = { 0 };
+        uint32_t module_id;
+        if (mqtt5_props_find_user_u32(msg->props, msg->props_len, RADAR_PROP_MODULE_ID, &module_id) &&
+            module_id >= 1 && module_id <= 255) {
+            meta.module_id = (int)module_id;
+        }
+        meta.has_sequence = mqtt5_props_find_user_u32(msg->props, msg->props_len, RADAR_PROP_SEQUENCE, &meta.sequence);
+        master_handle_radar_payload((const char *)msg->payload, (int)msg->payload_len, &meta,
+                                    &radar_rings[RADAR_SOURCE_BROKER]);
+    }
+}
 
-    FusedData current_data;
+static void embedded_broker_enqueue(const char *topic, const char *payload) {
+    BrokerOutboundMessage msg;
+    strlcpy(msg.topic, topic, sizeof(msg.topic));
+    strlcpy(msg.payload, payload, sizeof(msg.payload));
+    if (broker_outbound_queue == NULL || xQueueSend(broker_outbound_queue, &msg, 0) != pdPASS) {
+        ESP_LOGW(TAG_BROKER, "Outbound queue full, message on %s dropped.", topic);
+    }
+}
 
-    for(;;) {
-        if (xQueueReceive(fusion_output_queue, &current_data, portMAX_DELAY) != pdPASS) {
-            ESP_LOGE(TAG_FALL_DETECTOR, "Error receiving from fusion_output_queue. This should not happen with portMAX_DELAY unless queue is deleted.");
-            // Add a small delay here to prevent a tight loop if the queue is somehow problematic.
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue; // Skip the rest of the loop iteration
-        }
-        ESP_LOGI(TAG_FALL_DETECTOR, "Received fused data: TS=%u, Pos=(%.2f, %.2f), Posture=%s",
-                 current_data.timestamp, current_data.x, current_data.y, current_data.final_posture);
-
-            if (previous_data_valid) {
-                bool was_upright_or_moving = (strcmp(previous_data.final_posture, STANDING_POSTURE) == 0) ||
-                                             (strcmp(previous_data.final_posture, SITTING_POSTURE) == 0)  ||
-                                             (strcmp(previous_data.final_posture, MOVING_POSTURE) == 0)   ||
-                                             (strcmp(previous_data.final_posture, STILL_POSTURE) == 0); 
-                                   
-                if (was_upright_or_moving && strcmp(current_data.final_posture, LYING_POSTURE) == 0) {
-                    uint32_t transition_time_ms = current_data.timestamp - previous_data.timestamp;
-                    ESP_LOGI(TAG_FALL_DETECTOR, "Transition to LYING detected. Prev: %s, Curr: %s, Time_diff: %u ms",
-                             previous_data.final_posture, current_data.final_posture, transition_time_ms);
-
-                    if (transition_time_ms < FALL_TRANSITION_MAX_MS) {
-                        ESP_LOGW(TAG_FALL_DETECTOR, "Potential fall detected! Transition time: %u ms. Entering potential fall state.", transition_time_ms);
-                        in_potential_fall_state = true;
-                        potential_fall_start_time_ms = current_data.timestamp; 
-                    } else {
-                         ESP_LOGI(TAG_FALL_DETECTOR, "Transition to LYING too slow (%u ms), not considered a fall trigger.", transition_time_ms);
-                    }
-                }
-            }
+void EmbeddedBroker_task(void *pvParameters) {
+    ESP_LOGI(TAG_BROKER, "EmbeddedBroker_task started, waiting for IP...");
+    xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
 
-            if (in_potential_fall_state) {
-                if (strcmp(current_data.final_posture, LYING_POSTURE) == 0) {
-                    uint32_t lying_duration_ms = current_data.timestamp - potential_fall_start_time_ms;
-                    ESP_LOGI(TAG_FALL_DETECTOR, "In potential fall state, current posture: LYING. Lying duration: %u ms.", lying_duration_ms);
-                    if (lying_duration_ms >= (LYING_CONFIRMATION_DURATION_S * 1000)) {
-                        ESP_LOGE(TAG_FALL_DETECTOR, "CHUTE CONFIRMÉE! Lying duration: %u ms.", lying_duration_ms);
-                        
-                        AlertMessage alert_msg;
-                        alert_msg.type = ALERT_TYPE_FALL_DETECTED;
-                        alert_msg.alert_timestamp = current_data.timestamp; 
-                        snprintf(alert_msg.description, sizeof(alert_msg.description), 
-                                 "Chute détectée à %lu (Pos: %.2f,%.2f)", 
-                                 (unsigned long)current_data.timestamp, current_data.x, current_data.y);
-
-                        if (alert_queue != NULL) {
-                            if (xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(100)) != pdPASS) {
-                                ESP_LOGE(TAG_FALL_DETECTOR, "Failed to send fall alert to alert_queue (queue full or error).");
-                            } else {
-                                ESP_LOGI(TAG_FALL_DETECTOR, "Fall alert sent to alert_queue.");
-                            }
-                        } else {
-                            ESP_LOGE(TAG_FALL_DETECTOR, "alert_queue is NULL!"); // This check is good.
-                        }
-                        
-                        in_potential_fall_state = false;
-                        potential_fall_start_time_ms = 0;
-                        ESP_LOGI(TAG_FALL_DETECTOR, "Fall state reset after confirmation.");
-                    }
-                } else { 
-                    ESP_LOGI(TAG_FALL_DETECTOR, "Potential fall cancelled. Person no longer LYING. Current posture: %s", current_data.final_posture);
-                    in_potential_fall_state = false;
-                    potential_fall_start_time_ms = 0;
-                }
-            }
-            
-            previous_data = current_data;
-            previous_data_valid = true;
-        }
+    broker_outbound_queue = xQueueCreate(BROKER_OUTBOUND_QUEUE_SIZE, sizeof(BrokerOutboundMessage));
+    mqtt_broker_config_t cfg = {
+        .port = MASTER_EMBEDDED_BROKER_PORT,
+        .max_clients = MQTT_BROKER_MAX_CLIENTS,
+        .on_publish = embedded_broker_on_publish,
+        .ctx = NULL,
+    };
+    while (mqtt_broker_start(&embedded_broker, &cfg) < 0) {
+        ESP_LOGE(TAG_BROKER, "Unable to listen on port %d: errno %d. Retrying in 5 s.", MASTER_EMBEDDED_BROKER_PORT, errno);
+        vTaskDelay(pdMS_TO_TICKS(5000));
     }
-}
+    ESP_LOGI(TAG_BROKER, "Embedded MQTT broker listening on port %d (max %d clients)",
+             MASTER_EMBEDDED_BROKER_PORT, MQTT_BROKER_MAX_CLIENTS);
 
-void AlertManager_task(void *pvParameters) {
-    ESP_LOGI(TAG_ALERT_MANAGER, "AlertManager_task started");
-    AlertMessage received_alert;
-    char mqtt_payload[128];
+    uint32_t last_stats_ms = 0;
+    for (;;) {
+        // Short poll timeout: bounds the latency of alerts queued by other tasks.
+        mqtt_broker_poll(&embedded_broker, 50, esp_log_timestamp());
 
-    for(;;) {
-        if (xQueueReceive(alert_queue, &received_alert, portMAX_DELAY) != pdPASS) {
-            ESP_LOGE(TAG_ALERT_MANAGER, "Error receiving from alert_queue. This should not happen with portMAX_DELAY unless queue is deleted.");
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue; 
+        BrokerOutboundMessage msg;
+        while (xQueueReceive(broker_outbound_queue, &msg, 0) == pdPASS) {
+            mqtt_broker_publish(&embedded_broker, msg.topic, msg.payload, strlen(msg.payload));
         }
-        ESP_LOGI(TAG_ALERT_MANAGER, "Received alert. Type: %d, Description: %s, Timestamp: %u",
-                 received_alert.type, received_alert.description, received_alert.alert_timestamp);
 
-        // Update web server data with the new alert
-        if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            // Use alert_write_index for circular buffer
-            strncpy(g_web_server_data.last_alerts[g_web_server_data.alert_write_index], 
-                    received_alert.description, 
-                    sizeof(g_web_server_data.last_alerts[0])-1);
-            g_web_server_data.last_alerts[g_web_server_data.alert_write_index][sizeof(g_web_server_data.last_alerts[0])-1] = '\\0'; // Ensure null termination
-            
-            g_web_server_data.alert_write_index = (g_web_server_data.alert_write_index + 1) % 5;
-            if (g_web_server_data.stored_alert_count < 5) {
-                g_web_server_data.stored_alert_count++;
+        uint32_t now_ms = esp_log_timestamp();
+        if (now_ms - last_stats_ms >= 1000) {
+            last_stats_ms = now_ms;
+            if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+                g_web_server_data.broker_stats = embedded_broker.stats;
+                xSemaphoreGive(g_web_data_mutex);
             }
-            xSemaphoreGive(g_web_data_mutex);
-        } else {
-            ESP_LOGE(TAG_ALERT_MANAGER, "Failed to take g_web_data_mutex for updating alerts.");
         }
+    }
+}
+#endif
 
-        if (received_alert.type == ALERT_TYPE_FALL_DETECTED) {
-            snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                     "{\"alert_type\": \"FALL_DETECTED\", \"description\": \"%s\", \"timestamp\": %u}", 
-                     received_alert.description, received_alert.alert_timestamp);
-        } else if (received_alert.type == ALERT_TYPE_MODULE_OFFLINE) {
-            snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                     "{\"alert_type\": \"MODULE_OFFLINE\", \"description\": \"%s\", \"timestamp\": %u}", 
-                     received_alert.description, received_alert.alert_timestamp);
-        } else {
-            snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                     "{\"alert_type\": \"UNKNOWN\", \"description\": \"%s\", \"timestamp\": %u}", 
-                     received_alert.description, received_alert.alert_timestamp);
-        }
+#if MASTER_RADAR_UDP_ENABLED
+static const char *TAG_UDP_RX = "UdpReceiver";
 
-        ESP_LOGI(TAG_ALERT_MANAGER, "Prepared MQTT Payload: %s", mqtt_payload);
+// One anti-replay window per module id (the id is a u8 on the wire). A slave
+// whose sequence restarted resyncs its window (radar_wire_replay_check_resync()).
+static radar_wire_replay_t udp_replay_windows[256];
 
-            if (mqtt_connected_flag && client_handle != NULL) {
-                int msg_id = esp_mqtt_client_publish(client_handle, ALERT_TOPIC, mqtt_payload, 0, 1, 0); 
-                if (msg_id != -1) {
-                    ESP_LOGI(TAG_ALERT_MANAGER, "Alert published to MQTT topic %s, msg_id=%d", ALERT_TOPIC, msg_id);
-                } else {
-                    ESP_LOGE(TAG_ALERT_MANAGER, "Failed to publish alert to MQTT topic %s", ALERT_TOPIC);
-                }
-            } else {
-                ESP_LOGW(TAG_ALERT_MANAGER, "MQTT not connected. Alert not published via MQTT.");
-            }
+typedef struct {
+    uint32_t accepted;
+    uint32_t rejected;  // Bad length/magic/version/tag
+    uint32_t replayed;  // Duplicate or outside the replay window
+    uint32_t resynced;  // Windows restarted by a slave whose sequence went back
+    uint32_t lost;      // Gaps in the per-module sequence
+    uint32_t ring_full;
+} UdpRxStats;
+static UdpRxStats udp_rx_stats;
+
+// Receives radar_wire packets from slaves and feeds its radar ring directly.
+// Never blocks on the ring: a full ring drops the sample (counted) so the
+// socket keeps being drained.
+void UdpReceiver_task(void *pvParameters) {
+    ESP_LOGI(TAG_UDP_RX, "UdpReceiver_task started, waiting for IP...");
+    xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG_UDP_RX, "Unable to create socket: errno %d", errno);
+        vTaskDelete(NULL);
+        return;
+    }
+    struct sockaddr_in bind_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(MASTER_RADAR_UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&bind_addr, sizeof(bind_addr)) < 0) {
+        ESP_LOGE(TAG_UDP_RX, "Unable to bind UDP port %d: errno %d", MASTER_RADAR_UDP_PORT, errno);
+        close(sock);
+        vTaskDelete(NULL);
+        return;
+    }
+    ESP_LOGI(TAG_UDP_RX, "Listening for radar samples on UDP port %d", MASTER_RADAR_UDP_PORT);
 
-            ESP_LOGI(TAG_ALERT_MANAGER, "Placeholder for Buzzer/LED activation.");
-            ESP_LOGI(TAG_ALERT_MANAGER, "Placeholder for HTTP POST/E-mail notification.");
+    uint8_t packet[RADAR_WIRE_PACKET_LEN + 8]; // Oversized datagrams are rejected by length
+    for (;;) {
+        struct sockaddr_in source;
+        socklen_t source_len = sizeof(source);
+        int len = recvfrom(sock, packet, sizeof(packet), 0, (struct sockaddr *)&source, &source_len);
+        if (len < 0) {
+            ESP_LOGE(TAG_UDP_RX, "recvfrom failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        radar_wire_sample_t sample;
+        radar_wire_status_t status = radar_wire_decode(packet, (size_t)len, radar_udp_auth_key, &sample);
+        if (status != RADAR_WIRE_OK) {
+            udp_rx_stats.rejected++;
+            ESP_LOGW(TAG_UDP_RX, "Rejected UDP packet (%d bytes, status %d)", len, status);
+            continue;
+        }
+        uint32_t lost = 0;
+        switch (radar_wire_replay_check_resync(&udp_replay_windows[sample.module_id], sample.sequence, &lost)) {
+        case RADAR_REPLAY_ACCEPT:
+            break;
+        case RADAR_REPLAY_RESYNC:
+            udp_rx_stats.resynced++;
+            ESP_LOGW(TAG_UDP_RX, "Module %u restarted its sequence at %u, replay window resynced",
+                     sample.module_id, sample.sequence);
+            break;
+        default:
+            udp_rx_stats.replayed++;
+            ESP_LOGW(TAG_UDP_RX, "Replayed/stale sample from module %u (seq %u)", sample.module_id, sample.sequence);
+            continue;
+        }
+        udp_rx_stats.lost += lost;
+        udp_rx_stats.accepted++;
+
+        // Same units as the wire format: no conversion
+        RadarMessage msg = {
+            .timestamp = sample.timestamp_ms,
+            .sequence = sample.sequence,
+            .distance_mm = sample.distance_mm,
+            .moving_mm = sample.moving_mm,
+            .static_mm = sample.static_mm,
+            .module_id = sample.module_id,
+            .posture = sample.posture,
+            .signal = sample.signal,
+            // Replays already dropped by udp_replay_windows; the registry counts the losses per module
+            // (sensor health). Version 1 packets carry no targets.
+            .flags = RADAR_MSG_HAS_SEQUENCE | ((sample.moving_mm | sample.static_mm) ? RADAR_MSG_HAS_TARGETS : 0),
+        };
+        if (!hot_ring_push(&radar_rings[RADAR_SOURCE_UDP], &msg)) {
+            udp_rx_stats.ring_full++;
+        }
+
+        if ((udp_rx_stats.accepted % 1000) == 0) {
+            ESP_LOGI(TAG_UDP_RX, "UDP stats: accepted=%u rejected=%u replayed=%u resynced=%u lost=%u ring_full=%u",
+                     udp_rx_stats.accepted, udp_rx_stats.rejected, udp_rx_stats.replayed,
+                     udp_rx_stats.resynced, udp_rx_stats.lost, udp_rx_stats.ring_full);
         }
     }
 }
+#endif
+
+// Room r is owned by the FusionEngine task of shard r % MASTER_PIPELINE_SHARDS,
+// which holds the shard's rooms_mutex while it works on it. RadarRouter_task
+// only (re)assigns modules, with every shard locked, and is the only writer
+// of the module -> room map. Static: about 12 KB (4 readings of history per
+// module) + 16 x (0.6 KB of geometry + 0.6 KB of tracks), whatever the shards.
+static fusion_engine_t fusion_engine;
+static trilat_geometry_t room_geometry[FUSION_MAX_ROOMS];
+static mtt_room_t room_people[FUSION_MAX_ROOMS];
+
+#if MASTER_POSTURE_NN_ENABLED
+// 240 B of RAM per shard; the weights stay in flash. Set before the tasks start.
+static bool posture_nn_ready = false;
+
+// Loads the model of the posture_nn partition, else the compiled-in one, into
+// `nn` and logs the cost of an inference on this target.
+static void posture_nn_setup(posture_nn_t *nn) {
+    const char *source = "default";
+    posture_nn_status_t status = POSTURE_NN_ERR_LENGTH;
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                POSTURE_NN_PARTITION_LABEL);
+    const void *mapped = NULL;
+    esp_partition_mmap_handle_t mmap_handle;
+    if (partition != NULL &&
+        esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mapped, &mmap_handle) == ESP_OK) {
+        // Kept mapped for good: the network reads its weights in place
+        status = posture_nn_load(nn, mapped, partition->size);
+        if (status == POSTURE_NN_OK) {
+            source = "partition";
+        } else {
+            esp_partition_munmap(mmap_handle);
+            ESP_LOGW(TAG_FUSION, "No usable model in partition '%s' (%s), using the default one.",
+                     POSTURE_NN_PARTITION_LABEL, posture_nn_status_name(status));
+        }
+    }
+    if (status != POSTURE_NN_OK) {
+        status = posture_nn_load(nn, posture_nn_default_model, posture_nn_default_model_len);
+    }
+    posture_nn_ready = status == POSTURE_NN_OK;
+    if (!posture_nn_ready) {
+        ESP_LOGE(TAG_FUSION, "Default posture model rejected (%s): slave postures kept.", posture_nn_status_name(status));
+        return;
+    }
+    ESP_LOGI(TAG_FUSION, "Posture model: %s, %u layers, %u B of flash, %u B of RAM per shard.", source, nn->layer_count,
+             (unsigned)nn->blob_len, (unsigned)sizeof(*nn));
+    if (POSTURE_NN_SELF_BENCH_RUNS > 0) {
+        int8_t features[POSTURE_NN_FEATURES] = { 60, 61, 60, 70, 64, 64 };
+        uint8_t pct[RADAR_POSTURE_COUNT];
+        int64_t start_us = esp_timer_get_time();
+        for (int i = 0; i < POSTURE_NN_SELF_BENCH_RUNS; i++) {
+            features[6] = (int8_t)i; // Vary the input
+            posture_nn_classify(nn, features, pct);
+        }
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        ESP_LOGI(TAG_FUSION, "Posture model: %lld ns per inference (softmax included, %d runs).",
+                 elapsed_us * 1000 / POSTURE_NN_SELF_BENCH_RUNS, POSTURE_NN_SELF_BENCH_RUNS);
+    }
+}
 
+// Replaces the slave's posture of `msg` by the classifier's when it is
+// confident enough. Needs the target distances (slaves >= 1.2.0) and uses
+// the module's fusion history, so runs before fusion_engine_update().
+static void classify_posture(PipelineShard *shard, RadarMessage *msg) {
+    if (!posture_nn_ready || !(msg->flags & RADAR_MSG_HAS_TARGETS)) {
+        return;
+    }
+    const fusion_reading_t *prev = fusion_engine_history(&fusion_engine, msg->module_id, 0);
+    const fusion_reading_t *oldest = NULL;
+    for (int age = FUSION_HISTORY_LEN - 1; age >= 0 && oldest == NULL; age--) {
+        oldest = fusion_engine_history(&fusion_engine, msg->module_id, age);
+    }
+    int8_t features[POSTURE_NN_FEATURES];
+    uint8_t pct[RADAR_POSTURE_COUNT];
+    posture_nn_features(msg, prev, oldest, features);
+    radar_posture_t posture = posture_nn_classify(&shard->posture_nn, features, pct);
+    if (pct[posture] >= POSTURE_NN_MIN_CONFIDENCE_PCT) {
+        if (posture != msg->posture) {
+            ESP_LOGD(TAG_FUSION, "Module %u: posture %s -> %s (%u %%).", msg->module_id,
+                     radar_posture_name((radar_posture_t)msg->posture), radar_posture_name(posture), pct[posture]);
+        }
+        msg->posture = (uint8_t)posture;
+    }
+}
+#endif
 
-// HTTP Server Request Handler for Root Path
-static esp_err_t root_get_handler(httpd_req_t *req)
-{
-    char*  buf;
-    size_t buf_len;
-
-    // Estimate buffer size (can be quite large for HTML)
-    // This is a rough estimate, adjust as needed, or use dynamic allocation carefully
-    buf_len = 1024; 
-    buf = malloc(buf_len);
-    if (!buf) {
-        ESP_LOGE(TAG_HTTP_SERVER, "Failed to allocate memory for HTTP response");
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+// Rebuilds the sensor geometry of a fusion room from its slots. Called when a
+// module joins or leaves the room, not per sample.
+static void update_room_geometry(int room) {
+    static const trilat_bounds_t bounds = { ROOM_MIN_X_M, ROOM_MIN_Y_M, ROOM_MAX_X_M, ROOM_MAX_Y_M };
+    if (room < 0 || room >= FUSION_MAX_ROOMS) {
+        return;
     }
+    trilat_geometry_t *geometry = &room_geometry[room];
+    const fusion_room_t *fr = &fusion_engine.rooms[room];
+    trilat_geometry_init(geometry, &bounds, RADAR_RANGE_SIGMA_M);
+    for (int slot = 0; slot < fr->slot_count; slot++) {
+        uint8_t id = fr->slots[slot].module_id;
+        for (size_t i = 0; id != 0 && i < NUM_SENSOR_CALIBRATIONS; i++) {
+            if (sensor_calibration[i].module_id == id) {
+                trilat_geometry_set_sensor(geometry, slot, sensor_calibration[i].x, sensor_calibration[i].y);
+                break;
+            }
+        }
+    }
+    ESP_LOGI(TAG_FUSION, "Room %d geometry: %d calibrated sensors.", room, __builtin_popcount(geometry->valid_mask));
+}
 
-    char temp_buffer[256]; // For individual lines/parts
+// Runs the people tracker of the set's room on the moving/static targets of
+// its readings. Returns the number of confirmed tracks.
+static int track_room_people(const fusion_set_t *set) {
+    mtt_scan_t scan;
+    mtt_scan_init(&scan);
+    int n = 0;
+    for (uint8_t mask = set->slot_mask; mask; mask &= (uint8_t)(mask - 1)) {
+        const fusion_reading_t *r = &set->readings[n++];
+        bool targets = (r->flags & RADAR_MSG_HAS_TARGETS) != 0;
+        mtt_scan_add(&scan, __builtin_ctz(mask), r->distance_mm, targets ? r->moving_mm : 0,
+                     targets ? r->static_mm : 0, (radar_posture_t)r->posture, r->signal);
+    }
+    mtt_room_t *people = &room_people[set->room];
+    int confirmed = mtt_room_step(people, &room_geometry[set->room], set->timestamp, &scan);
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        const mtt_track_t *t = &people->tracks[i];
+        if (t->id != 0) {
+            ESP_LOGI(TAG_FUSION, "Room %u track %u%s: x=%.2f, y=%.2f, %s (%d sensors, result %u)", set->room, t->id,
+                     t->confirmed ? "" : " (tentative)", t->kf.s[0], t->kf.s[1],
+                     radar_posture_name((radar_posture_t)t->posture), __builtin_popcount(t->sensors), t->result);
+        }
+    }
+    return confirmed;
+}
 
-    if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-        // Start HTML
-        snprintf(buf, buf_len, "<!DOCTYPE html><html><head><title>ESP32 Master Status</title>"
-                              "<meta http-equiv=\"refresh\" content=\"10\">" // Auto-refresh every 10 seconds
-                              "<style>"
-                              "body { font-family: Arial, sans-serif; margin: 20px; background-color: #f4f4f4; color: #333; }"
-                              "h1 { color: #0056b3; }"
-                              "h2 { color: #0056b3; border-bottom: 1px solid #ccc; padding-bottom: 5px; }"
-                              ".status-ok { color: green; }"
-                              ".status-offline { color: red; }"
-                              "ul { list-style-type: none; padding-left: 0; }"
-                              "li { background-color: #fff; border: 1px solid #ddd; margin-bottom: 5px; padding: 10px; border-radius: 4px; }"
-                              ".container { background-color: #fff; padding: 20px; border-radius: 8px; box-shadow: 0 0 10px rgba(0,0,0,0.1); }"
-                              "</style>"
-                              "</head><body><div class=\"container\"><h1>ESP32 Master Status</h1>");
+// Detection distance of the strongest reading: the range-only part of an
+// output, still meaningful with a single live module.
+static uint16_t strongest_range_mm(const fusion_set_t *set) {
+    const fusion_reading_t *best = NULL;
+    for (int i = 0; i < set->count; i++) {
+        if (best == NULL || set->readings[i].signal > best->signal) {
+            best = &set->readings[i];
+        }
+    }
+    return best ? best->distance_mm : 0;
+}
 
-        // MQTT Status
-        snprintf(temp_buffer, sizeof(temp_buffer), "<p>MQTT Status: <span class=\"%s\">%s</span></p>",
-                 g_web_server_data.mqtt_connected ? "status-ok" : "status-offline",
-                 g_web_server_data.mqtt_connected ? "Connected" : "Disconnected");
-        strlcat(buf, temp_buffer, buf_len);
+// Publishes the mode of `room` on the status page and raises ROOM_DEGRADED /
+// ROOM_RESTORED on transitions. Called after every reading of the room.
+static void report_room_mode(int room, uint32_t now_ms) {
+    static bool reported_degraded[FUSION_MAX_ROOMS];
+    static uint8_t reported_alive[FUSION_MAX_ROOMS], reported_modules[FUSION_MAX_ROOMS];
+    const fusion_room_t *fr = &fusion_engine.rooms[room];
+    uint8_t alive = (uint8_t)fusion_engine_alive_count(&fusion_engine, room);
+    uint8_t modules = (uint8_t)fusion_engine_module_count(&fusion_engine, room);
+    if (fr->degraded == reported_degraded[room] && alive == reported_alive[room] && modules == reported_modules[room]) {
+        return;
+    }
 
-        // System Uptime
-        uint32_t uptime = g_web_server_data.system_uptime_seconds;
-        uint32_t days = uptime / (24 * 3600);
-        uptime = uptime % (24 * 3600);
-        uint32_t hours = uptime / 3600;
-        uptime = uptime % 3600;
-        uint32_t minutes = uptime / 60;
-        uint32_t seconds = uptime % 60;
-        snprintf(temp_buffer, sizeof(temp_buffer), "<p>System Uptime: %u days, %02u:%02u:%02u</p>", days, hours, minutes, seconds);
-        strlcat(buf, temp_buffer, buf_len);
+    if (fr->degraded != reported_degraded[room]) {
+        AlertMessage alert_msg = {
+            .alert_timestamp = now_ms,
+            .type = fr->degraded ? ALERT_TYPE_ROOM_DEGRADED : ALERT_TYPE_ROOM_RESTORED,
+            .room = (uint8_t)room,
+        };
+        for (int i = 0; fr->degraded && i < fr->slot_count; i++) {
+            const fusion_slot_t *slot = &fr->slots[i];
+            if (slot->module_id != 0 && !((fr->alive_mask >> i) & 1)) {
+                alert_msg.module_id = slot->module_id;
+                alert_msg.silent_ms = now_ms - slot->last_arrival_ms;
+                break;
+            }
+        }
+        ESP_LOGW(TAG_FUSION, "Room %d '%s' %s: %u of %u modules live (quorum %u).", room, fr->name,
+                 fr->degraded ? "degraded" : "restored", alive, modules, fr->quorum);
+        if (alert_queue == NULL || xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(10)) != pdPASS) {
+            ESP_LOGE(TAG_FUSION, "Failed to send room mode alert to alert_queue.");
+        }
+    }
+    if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG_FUSION, "Failed to take g_web_data_mutex for the room status.");
+        return; // Retried on the next reading of the room
+    }
+    g_web_server_data.room_count = fusion_engine.room_count;
+    strlcpy(g_web_server_data.rooms[room].name, fr->name, sizeof(g_web_server_data.rooms[room].name));
+    g_web_server_data.rooms[room].modules = modules;
+    g_web_server_data.rooms[room].alive = alive;
+    g_web_server_data.rooms[room].degraded = fr->degraded;
+    xSemaphoreGive(g_web_data_mutex);
+    reported_degraded[room] = fr->degraded;
+    reported_alive[room] = alive;
+    reported_modules[room] = modules;
+}
 
+// Copies the output into a fused_pool block, the only copy its subscribers get
+static void send_fused_output(PipelineShard *shard, const FusedData *fused_output_data) {
+    FusedData *block = (FusedData *)msg_pool_alloc(&fused_pool);
+    if (block == NULL) {
+        ESP_LOGE(TAG_FUSION, "Fused pool empty, output of room %u dropped.", fused_output_data->room);
+        return;
+    }
+    *block = *fused_output_data;
+    if (msg_bus_publish(&shard->fused_bus, block) < shard->fused_bus.subscriber_count) {
+        ESP_LOGE(TAG_FUSION, "A fused ring of shard %u is full, output of room %u lost there.", shard->index,
+                 fused_output_data->room);
+    } else {
+        ESP_LOGD(TAG_FUSION, "Fused data published on the bus of shard %u.", shard->index);
+    }
+}
 
-        // Module Status
-        strlcat(buf, "<h2>Module Status</h2>", buf_len);
-        for (int i = 0; i < NUM_SLAVE_MODULES; i++) {
-            snprintf(temp_buffer, sizeof(temp_buffer), "<p>Module %d: <span class=\"%s\">%s</span></p>",
-                     i + 1,
-                     g_web_server_data.module_status[i] ? "status-ok" : "status-offline",
-                     g_web_server_data.module_status[i] ? "Online" : "Offline");
-            strlcat(buf, temp_buffer, buf_len);
+// Fusion state, posture models, the pools, the radar rings and the rings,
+// bus and lock of every shard. Called by app_main before the tasks exist.
+static bool pipeline_init(void) {
+    pipeline_shards_init(&pipeline_plan, MASTER_PIPELINE_SHARDS, portNUM_PROCESSORS, NETWORK_CORE,
+                         MASTER_PIPELINE_SHARD_CORES);
+    fusion_engine_init(&fusion_engine, SENSOR_SYNC_WINDOW_MS, MASTER_FUSION_QUORUM);
+    for (int i = 0; i < FUSION_MAX_ROOMS; i++) {
+        mtt_room_init(&room_people[i], TRACK_ACCEL_SIGMA);
+    }
+    if (!zone_engine_init(&zone_engine, zone_config, NUM_ZONES, zone_arena, ZONE_ARENA_WORDS,
+                          pipeline_position_mm(ROOM_MIN_X_M), pipeline_position_mm(ROOM_MIN_Y_M),
+                          pipeline_position_mm(ROOM_MAX_X_M), pipeline_position_mm(ROOM_MAX_Y_M), ZONE_GRID_CELL_MM)) {
+        ESP_LOGE(TAG_FUSION, "Invalid zone table.");
+        return false;
+    }
+#if MASTER_POSTURE_NN_ENABLED
+    posture_nn_setup(&pipeline_shards[0].posture_nn);
+#endif
+    if (!msg_pool_init(&fused_pool, fused_pool_storage, sizeof(fused_pool_storage), sizeof(FusedData),
+                       FUSED_POOL_BLOCKS) ||
+        !msg_pool_init(&page_pool, page_pool_storage, sizeof(page_pool_storage), HTTP_PAGE_BLOCK_LEN,
+                       HTTP_PAGE_BLOCKS)) {
+        return false;
+    }
+    for (int i = 0; i < RADAR_SOURCE_COUNT; i++) {
+        if (!hot_ring_init(&radar_rings[i], radar_ring_slots[i], sizeof(RadarMessage), RADAR_RING_SIZE)) {
+            return false;
+        }
+    }
+    for (int s = 0; s < pipeline_plan.shard_count; s++) {
+        PipelineShard *shard = &pipeline_shards[s];
+        shard->index = (uint8_t)s;
+        shard->rooms_mutex = xSemaphoreCreateMutex();
+        if (!hot_ring_init(&shard->radar_ring, shard->radar_slots, sizeof(RadarMessage), SHARD_RADAR_RING_SIZE) ||
+            !hot_ring_init(&shard->fused_ring, shard->fused_slots, sizeof(FusedData *), FUSED_RING_SIZE) ||
+            !hot_ring_init(&web_tap_rings[s], web_tap_slots[s], sizeof(FusedData *), FUSED_RING_SIZE) ||
+            shard->rooms_mutex == NULL) {
+            return false;
+        }
+        msg_bus_init(&shard->fused_bus, &fused_pool);
+        if (msg_bus_subscribe(&shard->fused_bus, &shard->fused_ring.ring, hot_ring_wake, &shard->fused_ring) < 0 ||
+            msg_bus_subscribe(&shard->fused_bus, &web_tap_rings[s].ring, hot_ring_wake, &web_tap_rings[s]) < 0) {
+            return false;
         }
+#if MASTER_POSTURE_NN_ENABLED
+        shard->posture_nn = pipeline_shards[0].posture_nn; // Same weights (flash), own arena
+#endif
+        ESP_LOGI(TAG_FUSION, "Pipeline shard %d: rooms %d, %d, ... on core %u.", s, s, s + pipeline_plan.shard_count,
+                 pipeline_plan.core[s]);
+    }
+    return true;
+}
 
-        // Last Alerts
-        strlcat(buf, "<h2>Last Alerts</h2><ul>", buf_len);
-        if (g_web_server_data.stored_alert_count == 0) {
-            strlcat(buf, "<li>No alerts yet.</li>", buf_len);
+// Boot self-benchmark of a stage boundary: SPSC_SELF_BENCH_ITEMS samples sent
+// by a task on the core of shard 0 to this task, through a FreeRTOS queue and
+// then through a ring drained by batches. Also runs under QEMU (idf.py qemu).
+static HotRing bench_ring;
+static RadarMessage bench_ring_slots[SHARD_RADAR_RING_SIZE];
+static QueueHandle_t bench_queue;
+
+static void ring_bench_producer_task(void *pvParameters) {
+    bool use_ring = pvParameters != NULL;
+    RadarMessage msg = { 0 };
+    for (uint32_t i = 0; i < SPSC_SELF_BENCH_ITEMS; i++) {
+        msg.sequence = i;
+        if (use_ring) {
+            // Waits for room rather than dropping: every item is timed
+            while (spsc_ring_count(&bench_ring.ring) == bench_ring.ring.capacity) {
+                taskYIELD();
+            }
+            hot_ring_push(&bench_ring, &msg);
         } else {
-            // Display alerts in chronological order (oldest first from circular buffer)
-            for (int i = 0; i < g_web_server_data.stored_alert_count; i++) {
-                int alert_idx = (g_web_server_data.alert_write_index - g_web_server_data.stored_alert_count + i + 5) % 5;
-                snprintf(temp_buffer, sizeof(temp_buffer), "<li>%s</li>", g_web_server_data.last_alerts[alert_idx]);
-                strlcat(buf, temp_buffer, buf_len);
+            xQueueSend(bench_queue, &msg, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void pipeline_ring_self_bench(void) {
+    bench_queue = xQueueCreate(SHARD_RADAR_RING_SIZE, sizeof(RadarMessage));
+    if (bench_queue == NULL ||
+        !hot_ring_init(&bench_ring, bench_ring_slots, sizeof(RadarMessage), SHARD_RADAR_RING_SIZE)) {
+        ESP_LOGE(TAG_MAIN_APP, "Ring self-benchmark skipped (no memory).");
+        return;
+    }
+    int64_t ns_per_item[2] = { 0 };
+    uint32_t out_of_order = 0;
+    for (int use_ring = 0; use_ring < 2; use_ring++) {
+        RadarMessage batch[PIPELINE_BATCH];
+        uint32_t received = 0;
+        int64_t start_us = esp_timer_get_time();
+        if (xTaskCreatePinnedToCore(&ring_bench_producer_task, "ring_bench", 2048, use_ring ? &bench_ring : NULL,
+                                    uxTaskPriorityGet(NULL), NULL, pipeline_plan.core[0]) != pdPASS) {
+            ESP_LOGE(TAG_MAIN_APP, "Ring self-benchmark skipped (no producer task).");
+            break;
+        }
+        while (received < SPSC_SELF_BENCH_ITEMS) {
+            uint32_t n;
+            if (use_ring) {
+                n = spsc_ring_pop_batch(&bench_ring.ring, batch, PIPELINE_BATCH);
+                if (n == 0) {
+                    hot_rings_wait(&bench_ring, 1, portMAX_DELAY);
+                }
+            } else {
+                n = xQueueReceive(bench_queue, &batch[0], portMAX_DELAY) == pdPASS;
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                out_of_order += batch[i].sequence != received++;
             }
         }
-        strlcat(buf, "</ul>", buf_len);
+        ns_per_item[use_ring] = (esp_timer_get_time() - start_us) * 1000 / SPSC_SELF_BENCH_ITEMS;
+    }
+    vQueueDelete(bench_queue);
+    ESP_LOGI(TAG_MAIN_APP, "Stage boundary, %d samples from core %u to core %d: FreeRTOS queue %lld ns/item, "
+             "ring %lld ns/item (batches of %d), %u out of order.", SPSC_SELF_BENCH_ITEMS, pipeline_plan.core[0],
+             xPortGetCoreID(), ns_per_item[0], ns_per_item[1], PIPELINE_BATCH, out_of_order);
+}
 
-        xSemaphoreGive(g_web_data_mutex);
+// Puts `module_id` in room `room_name` with every shard locked: its old and
+// new rooms may belong to two shards, and a new room extends the room list.
+// Taken in shard order; the FusionEngine tasks only take their own lock.
+static void assign_module_room(uint8_t module_id, const char *room_name) {
+    for (int s = 0; s < pipeline_plan.shard_count; s++) {
+        xSemaphoreTake(pipeline_shards[s].rooms_mutex, portMAX_DELAY);
+    }
+    int previous_room = fusion_engine_room_of(&fusion_engine, module_id);
+    int room = fusion_engine_assign(&fusion_engine, module_id, room_name);
+    if (room < 0) {
+        ESP_LOGW(TAG_FUSION, "No fusion slot for module %u in room '%s' (%d rooms max, %d modules per room).",
+                 module_id, room_name, FUSION_MAX_ROOMS, FUSION_SLOTS_PER_ROOM);
     } else {
-        ESP_LOGE(TAG_HTTP_SERVER, "Failed to take g_web_data_mutex for HTTP handler");
-        snprintf(buf, buf_len, "<h1>Error fetching status</h1><p>Could not access system data. Please try again.</p>");
-        // No need to give mutex if not taken
+        ESP_LOGI(TAG_FUSION, "Module %u fused in room %d '%s' (shard %d).", module_id, room, room_name,
+                 pipeline_shard_of_room(&pipeline_plan, room));
+        update_room_geometry(room);
+        if (previous_room >= 0 && previous_room != room) {
+            update_room_geometry(previous_room);
+        }
+        // Once per room, before its first sample is routed
+        if (!zone_engine.bound[room]) {
+            int zones = zone_engine_bind_room(&zone_engine, room, room_name);
+            if (zones < 0) {
+                ESP_LOGE(TAG_FUSION, "Zone arena full (%u/%u words): room '%s' has no zone.", zone_engine.arena_used,
+                         zone_engine.arena_len, room_name);
+            } else if (zones > 0) {
+                ESP_LOGI(TAG_FUSION, "Room '%s': %d zones, arena %u/%u words.", room_name, zones,
+                         zone_engine.arena_used, zone_engine.arena_len);
+            }
+        }
+        if (room_heatmaps[room].cells == NULL) {
+            heatmap_t *hm = &room_heatmaps[room];
+            if (heatmap_init(hm, heatmap_arena + heatmap_arena_used, HEATMAP_ARENA_CELLS - heatmap_arena_used,
+                             pipeline_position_mm(ROOM_MIN_X_M), pipeline_position_mm(ROOM_MIN_Y_M),
+                             pipeline_position_mm(ROOM_MAX_X_M), pipeline_position_mm(ROOM_MAX_Y_M), HEATMAP_CELL_MM,
+                             HEATMAP_HALF_LIFE_S * 1000u, esp_log_timestamp())) {
+                heatmap_arena_used += (uint32_t)hm->cols * hm->rows;
+            } else {
+                ESP_LOGW(TAG_FUSION, "Heatmap arena full (%u/%u cells): room '%s' has no heatmap.",
+                         heatmap_arena_used, HEATMAP_ARENA_CELLS, room_name);
+            }
+        }
+    }
+    for (int s = pipeline_plan.shard_count - 1; s >= 0; s--) {
+        xSemaphoreGive(pipeline_shards[s].rooms_mutex);
     }
+}
 
-    // End HTML
-    strlcat(buf, "</div></body></html>", buf_len);
+// Front of the pipeline, on the network core: records a sample in the module
+// registry, assigns a new or moved module to its room and hands the sample to
+// the shard of its room. Never waits for a shard: a full shard ring loses the
+// sample rather than holding back the rooms of the others.
+static void route_sample(const RadarMessage *msg) {
+    ESP_LOGI(TAG_FUSION, "Received data from module_id: %u, ts: %u, dist: %u mm, posture: %s, signal: %u",
+             msg->module_id, msg->timestamp, msg->distance_mm,
+             radar_posture_name((radar_posture_t)msg->posture), msg->signal);
+
+    // Record the sample in the module registry (registers first-seen modules)
+    bool needs_room = false;
+    bool health_changed = false;
+    char room_name[MODULE_ROOM_LEN] = "";
+    if (xSemaphoreTake(module_registry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        uint32_t now_ms = esp_log_timestamp();
+        if ((msg->flags & RADAR_MSG_HAS_SEQUENCE) &&
+            !module_registry_check_sequence(&module_registry, msg->module_id, msg->sequence, now_ms)) {
+            xSemaphoreGive(module_registry_mutex);
+            ESP_LOGD(TAG_FUSION, "Duplicate sample %u from module %u dropped.", msg->sequence, msg->module_id);
+            return;
+        }
+        bool came_back = false;
+        module_info_t *module = module_registry_note_sample(&module_registry, msg->module_id, now_ms, &came_back);
+        if (module != NULL) {
+            // Offline SLAVE_MODULE_TIMEOUT_S after this sample unless another one comes (O(1))
+            timer_wheel_arm(&watchdog_wheel, LIVENESS_TIMER(module_slot(module)),
+                            now_ms + SLAVE_MODULE_TIMEOUT_S * 1000 + 1);
+            // O(1); the alert is raised by the watchdog, woken below
+            health_changed = sensor_health_update(&sensor_health_config, &module->health, msg, module->samples_lost);
+            if (health_changed) {
+                timer_wheel_arm(&watchdog_wheel, HEALTH_TIMER(module_slot(module)), now_ms);
+                ESP_LOGW(TAG_FUSION, "Module %u health score %u: %s.", module->id, module->health.score,
+                         module->health.degraded ? "degraded" : "restored");
+            }
+        }
+        // Room from the mDNS TXT record; modules without one share the "" room.
+        if (module != NULL && (module->room_changed || fusion_engine_room_of(&fusion_engine, module->id) < 0)) {
+            strlcpy(room_name, module->room, sizeof(room_name));
+            module->room_changed = false;
+            needs_room = true;
+        }
+        xSemaphoreGive(module_registry_mutex);
+        if (health_changed && watchdog_task_handle != NULL) {
+            xTaskNotifyGive(watchdog_task_handle);
+        }
+        if (module == NULL) {
+            ESP_LOGW(TAG_FUSION, "Module id %u rejected by the registry (invalid or registry full).", msg->module_id);
+        } else if (came_back) {
+            ESP_LOGI(TAG_FUSION, "Module %u is back online.", msg->module_id);
+            // Minor alert: never waits, and leaves room for the important ones
+            AlertMessage online_alert = {
+                .alert_timestamp = now_ms,
+                .type = ALERT_TYPE_MODULE_ONLINE,
+                .module_id = msg->module_id,
+            };
+            if (alert_queue != NULL && uxQueueSpacesAvailable(alert_queue) >= 2) {
+                xQueueSend(alert_queue, &online_alert, 0);
+            }
+        }
+    } else {
+        ESP_LOGE(TAG_FUSION, "Failed to take module_registry_mutex for module tracking.");
+    }
 
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, buf, strlen(buf));
+    if (needs_room) {
+        assign_module_room(msg->module_id, room_name);
+    }
 
-    free(buf); // Free the buffer
-    return ESP_OK;
+    // Read without lock: this task is the only writer of the module -> room map
+    int room = fusion_engine_room_of(&fusion_engine, msg->module_id);
+    if (room < 0) {
+        ESP_LOGW(TAG_FUSION, "Received data from module_id %u, which has no fusion slot.", msg->module_id);
+        return;
+    }
+    int shard = pipeline_shard_of_room(&pipeline_plan, room);
+    bool accepted = hot_ring_push(&pipeline_shards[shard].radar_ring, msg);
+    pipeline_shard_note(&pipeline_plan, shard, accepted);
+    if (!accepted) {
+        ESP_LOGE(TAG_FUSION, "Ring of shard %d full, sample of module %u (room %d) dropped.", shard,
+                 msg->module_id, room);
+    }
 }
 
-// HTTP Server URI Registration
-static const httpd_uri_t root_uri = {
-    .uri      = "/",
-    .method   = HTTP_GET,
-    .handler  = root_get_handler,
-    .user_ctx = NULL 
-};
+// Drains the radar ring of each source, a batch at a time, and sleeps when
+// all are empty.
+void RadarRouter_task(void *pvParameters) {
+    ESP_LOGI(TAG_FUSION, "RadarRouter_task started (%u shards)", pipeline_plan.shard_count);
 
-// Function to start the web server
-static httpd_handle_t start_webserver(void)
-{
-    httpd_handle_t server = NULL;
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_open_sockets = 7; // Increased a bit
-    config.lru_purge_enable = true; // Enable LRU purge for inactive sockets
+    RadarMessage batch[PIPELINE_BATCH];
 
-    ESP_LOGI(TAG_HTTP_SERVER, "Starting HTTP server on port: '%d'", config.server_port);
-    if (httpd_start(&server, &config) == ESP_OK) {
-        ESP_LOGI(TAG_HTTP_SERVER, "Registering URI handlers");
-        httpd_register_uri_handler(server, &root_uri);
-        return server;
+    for(;;) {
+        uint32_t popped = 0;
+        for (int source = 0; source < RADAR_SOURCE_COUNT; source++) {
+            uint32_t n = spsc_ring_pop_batch(&radar_rings[source].ring, batch, PIPELINE_BATCH);
+            for (uint32_t i = 0; i < n; i++) {
+                route_sample(&batch[i]);
+            }
+            popped += n;
+        }
+        if (popped == 0) {
+            hot_rings_wait(radar_rings, RADAR_SOURCE_COUNT, portMAX_DELAY);
+        }
+    }
+}
+
+// Fuses one sample of the shard's rooms. Called with the shard's rooms_mutex held.
+static void fuse_sample(PipelineShard *shard, RadarMessage *msg, fusion_set_t *fused_set) {
+    int room = fusion_engine_room_of(&fusion_engine, msg->module_id);
+    if (!pipeline_shard_owns(&pipeline_plan, shard->index, room)) {
+        // Queued before its module moved to a room of another shard
+        ESP_LOGD(TAG_FUSION, "Stale sample of module %u dropped by shard %u.", msg->module_id, shard->index);
+        return;
     }
 
-    ESP_LOGE(TAG_HTTP_SERVER, "Error starting server!");
-    return NULL;
+#if MASTER_POSTURE_NN_ENABLED
+    classify_posture(shard, msg);
+#endif
+    uint32_t now_ms = esp_log_timestamp();
+    fusion_result_t fusion_result = fusion_engine_update(&fusion_engine, msg, now_ms, fused_set);
+    if (fusion_result != FUSION_REJECTED) {
+        report_room_mode(room, now_ms);
+    }
+    switch (fusion_result) {
+    case FUSION_REJECTED:
+        ESP_LOGW(TAG_FUSION, "Received data from module_id %u, which has no fusion slot.", msg->module_id);
+        break;
+    case FUSION_STORED:
+        ESP_LOGD(TAG_FUSION, "Reading of module %u stored, waiting for the room quorum.", msg->module_id);
+        break;
+    case FUSION_FUSED: {
+        ESP_LOGI(TAG_FUSION, "Readings of %u modules aligned at %u ms in room %u (%d extrapolated%s).",
+                 fused_set->count, fused_set->timestamp, fused_set->room, __builtin_popcount(fused_set->extrapolated_mask),
+                 fused_set->degraded ? ", degraded" : "");
+
+        ESP_LOGI(TAG_FUSION, "Final posture: %s (%u %%, lying %u %%)", radar_posture_name(fused_set->posture),
+                 fused_set->posture_pct[fused_set->posture], fused_set->posture_pct[RADAR_POSTURE_LYING]);
+
+        // One output per confirmed person; a room without any (uncalibrated
+        // sensors, nobody tracked yet, a single live module) still gets its
+        // posture and range output.
+        int occupants = track_room_people(fused_set);
+        uint8_t mode_flags = fused_set->degraded ? FUSED_FLAG_DEGRADED : 0;
+        FusedData fused_output_data = { 0 };
+        fused_output_data.room = fused_set->room;
+        fused_output_data.timestamp = fused_set->timestamp;
+        fused_output_data.occupants = (uint8_t)occupants;
+        fused_output_data.range_mm = strongest_range_mm(fused_set);
+        if (occupants == 0) {
+            fused_output_data.posture = (uint8_t)fused_set->posture;
+            memcpy(fused_output_data.posture_pct, fused_set->posture_pct, sizeof(fused_output_data.posture_pct));
+            fused_output_data.sigma_cm = FUSED_SIGMA_UNKNOWN;
+            fused_output_data.flags = FUSED_FLAG_PREDICTED | mode_flags;
+            fused_output_data.track_id = FUSED_TRACK_NONE;
+            send_fused_output(shard, &fused_output_data);
+        }
+        const mtt_room_t *people = &room_people[fused_set->room];
+        for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+            const mtt_track_t *t = &people->tracks[i];
+            if (t->id == 0 || !t->confirmed) {
+                continue;
+            }
+            fused_output_data.x_mm = pipeline_position_mm(t->kf.s[0]);
+            fused_output_data.y_mm = pipeline_position_mm(t->kf.s[1]);
+            fused_output_data.vx_mm_s = pipeline_position_mm(t->kf.s[2]); // m/s -> mm/s
+            fused_output_data.vy_mm_s = pipeline_position_mm(t->kf.s[3]);
+            fused_output_data.sigma_cm = pipeline_sigma_cm(kalman_track_position_sigma(&t->kf));
+            fused_output_data.posture = t->posture;
+            posture_hmm_percent(&t->posture_hmm, fused_output_data.posture_pct);
+            fused_output_data.track_id = t->id;
+            if (t->result == KALMAN_STARTED || t->newly_confirmed) {
+                fused_output_data.flags = FUSED_FLAG_NEW_TRACK;
+            } else if (t->result == KALMAN_REJECTED) {
+                fused_output_data.flags = FUSED_FLAG_PREDICTED | FUSED_FLAG_OUTLIER;
+                ESP_LOGW(TAG_FUSION, "Room %u track %u: position outside the track gate, predicting.",
+                         fused_set->room, t->id);
+            } else if (t->result == KALMAN_PREDICTED) {
+                fused_output_data.flags = FUSED_FLAG_PREDICTED;
+            } else {
+                fused_output_data.flags = 0;
+            }
+            fused_output_data.flags |= mode_flags;
+            send_fused_output(shard, &fused_output_data);
+        }
+        break;
+    }
+    }
 }
 
-// Function to stop the webserver (optional, if needed for cleanup)
-/*
-static void stop_webserver(httpd_handle_t server)
-{
-    if (server) {
-        httpd_stop(server);
+// Fusion of the rooms of one shard (pvParameters: its PipelineShard)
+void FusionEngine_task(void *pvParameters) {
+    PipelineShard *shard = (PipelineShard *)pvParameters;
+    ESP_LOGI(TAG_FUSION, "FusionEngine_task of shard %u started on core %d", shard->index, xPortGetCoreID());
+
+    RadarMessage batch[PIPELINE_BATCH];
+    fusion_set_t fused_set;
+
+    for(;;) {
+        uint32_t n = spsc_ring_pop_batch(&shard->radar_ring.ring, batch, PIPELINE_BATCH);
+        if (n == 0) {
+            hot_rings_wait(&shard->radar_ring, 1, portMAX_DELAY);
+            continue;
+        }
+        // One lock per batch: the router only takes it to move a module
+        xSemaphoreTake(shard->rooms_mutex, portMAX_DELAY);
+        for (uint32_t i = 0; i < n; i++) {
+            fuse_sample(shard, &batch[i], &fused_set);
+        }
+        xSemaphoreGive(shard->rooms_mutex);
     }
 }
-*/
 
-void Watchdog_task(void *pvParameters) {
-    ESP_LOGI(TAG_WATCHDOG, "Watchdog_task started");
-    // system_start_time_ms is initialized in app_main before this task starts.
+// Fall detection state of one person (room, track id), or of a room output
+// without track: the fall_rules instance (its `user` byte holds the track id),
+// the motion features feeding it, where the person was last seen, for a
+// confirmation by timer, and the zones the person is in. About 390 bytes.
+typedef struct {
+    fsm_instance_t fsm;
+    fall_features_t features;
+    zone_presence_t zones;
+    int16_t x_mm, y_mm;
+    uint8_t flags;          // FUSED_FLAG_* of the last output
+} FallTrackState;
+
+// One state per person: outputs of different rooms and tracks interleave on
+// the rings. Room r is owned by the FallDetector task of its shard. Static:
+// about 31 KB (80 persons), whatever the shards.
+static FallTrackState fall_track_state[FUSION_MAX_ROOMS][MTT_MAX_TRACKS + 1];
+// Stillness of each room, owned like its fall states
+static inactivity_room_t room_inactivity[FUSION_MAX_ROOMS];
+
+// State of `data`'s track among the MTT_MAX_TRACKS + 1 states of its room. A
+// new track id takes a free state, else the one updated least recently (a
+// track that has died), reset.
+static FallTrackState *fall_state_for(FallTrackState states[MTT_MAX_TRACKS + 1], const FusedData *data) {
+    FallTrackState *victim = NULL;
+    for (int i = 0; i <= MTT_MAX_TRACKS; i++) {
+        FallTrackState *st = &states[i];
+        if (!st->fsm.has_event) {
+            if (victim == NULL || victim->fsm.has_event) {
+                victim = st;
+            }
+        } else if (st->fsm.user == data->track_id) {
+            return st;
+        } else if (victim == NULL ||
+                   (victim->fsm.has_event && (int32_t)(st->fsm.last_ms - victim->fsm.last_ms) < 0)) {
+            victim = st;
+        }
+    }
+    memset(victim, 0, sizeof(*victim));
+    fsm_instance_init(&victim->fsm, FALL_STATE_WATCHING, data->timestamp);
+    fall_features_init(&victim->features);
+    zone_presence_init(&victim->zones);
+    victim->fsm.user = data->track_id;
+    return victim;
+}
+
+// Carries out an action of the fall rules for the person of `st`
+static void fall_apply_action(const FallTrackState *st, uint8_t room, uint8_t action, uint32_t now_ms) {
+    switch (action) {
+        case FALL_ACTION_SUSPECT:
+            ESP_LOGW(TAG_FALL_DETECTOR, "Potential fall detected! Room %u track %u: transition to LYING within %d ms. Entering potential fall state.",
+                     room, st->fsm.user, FALL_TRANSITION_MAX_MS);
+            break;
+        case FALL_ACTION_SLOW_LYING:
+            ESP_LOGI(TAG_FALL_DETECTOR, "Transition to LYING too slow (room %u track %u), not considered a fall trigger.",
+                     room, st->fsm.user);
+            break;
+        case FALL_ACTION_CANCEL:
+            ESP_LOGI(TAG_FALL_DETECTOR, "Potential fall cancelled (room %u track %u). Person no longer LYING or moving. Current posture: %s",
+                     room, st->fsm.user, radar_posture_name((radar_posture_t)st->fsm.last_posture));
+            break;
+        case FALL_ACTION_RECOVERED:
+            ESP_LOGI(TAG_FALL_DETECTOR, "Room %u track %u up again after the fall.", room, st->fsm.user);
+            break;
+        case FALL_ACTION_SUPPRESSED: {
+            uint16_t zone;
+            zone_engine_fall_policy(&zone_engine, &st->zones, &zone);
+            ESP_LOGI(TAG_FALL_DETECTOR, "Room %u track %u lying in zone '%s': fall ignored.", room, st->fsm.user,
+                     zone != ZONE_NONE ? zone_config[zone].name : "?");
+            break;
+        }
+        case FALL_ACTION_CONFIRM: {
+            uint16_t zone;
+            bool escalated = zone_engine_fall_policy(&zone_engine, &st->zones, &zone) == ZONE_FALL_ESCALATE;
+            ESP_LOGE(TAG_FALL_DETECTOR, "CHUTE CONFIRMÉE! Room %u track %u, lying for at least %d s (%u ms since the last output)%s%s.",
+                     room, st->fsm.user, escalated ? ZONE_ESCALATED_CONFIRM_MS / 1000 : LYING_CONFIRMATION_DURATION_S,
+                     now_ms - st->fsm.last_ms, escalated ? " in zone " : "", escalated ? zone_config[zone].name : "");
+            AlertMessage alert_msg = {
+                .alert_timestamp = now_ms,
+                .x_mm = st->x_mm,
+                .y_mm = st->y_mm,
+                .type = ALERT_TYPE_FALL_DETECTED,
+                .zone = escalated ? (uint8_t)zone : ALERT_ZONE_NONE,
+                .flags = (uint8_t)(((st->flags & FUSED_FLAG_DEGRADED) ? ALERT_FLAG_DEGRADED : 0) |
+                                   (escalated ? ALERT_FLAG_ESCALATED : 0)),
+                .room = room,
+            };
+
+            if (alert_queue != NULL) {
+                if (xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(100)) != pdPASS) {
+                    ESP_LOGE(TAG_FALL_DETECTOR, "Failed to send fall alert to alert_queue (queue full or error).");
+                } else {
+                    ESP_LOGI(TAG_FALL_DETECTOR, "Fall alert sent to alert_queue.");
+                }
+            } else {
+                ESP_LOGE(TAG_FALL_DETECTOR, "alert_queue is NULL!");
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Logs the zone events of the person of `st` and, if enabled, queues them as
+// alerts. Never waits, and leaves the last slot of the queue to a fall alert.
+static void report_zone_events(const FallTrackState *st, uint8_t room, const zone_event_t *events, int count,
+                               uint32_t now_ms) {
+    static const uint8_t alert_types[] = {
+        [ZONE_EVENT_ENTER] = ALERT_TYPE_ZONE_ENTER,
+        [ZONE_EVENT_EXIT] = ALERT_TYPE_ZONE_EXIT,
+        [ZONE_EVENT_DWELL] = ALERT_TYPE_ZONE_DWELL,
+    };
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG_FALL_DETECTOR, "Room %u track %u: zone '%s' %s (%u ms inside).", room, st->fsm.user,
+                 zone_config[events[i].zone].name, zone_event_name((zone_event_type_t)events[i].type),
+                 events[i].inside_ms);
+#if MASTER_ZONE_EVENTS_ENABLED
+        AlertMessage alert_msg = {
+            .alert_timestamp = now_ms,
+            .inside_ms = events[i].inside_ms,
+            .x_mm = st->x_mm,
+            .y_mm = st->y_mm,
+            .type = alert_types[events[i].type],
+            .zone = (uint8_t)events[i].zone,
+            .room = room,
+        };
+        if (alert_queue == NULL || uxQueueSpacesAvailable(alert_queue) < 2 ||
+            xQueueSend(alert_queue, &alert_msg, 0) != pdPASS) {
+            ESP_LOGW(TAG_FALL_DETECTOR, "Alert queue busy: zone event not sent.");
+        }
+#else
+        (void)alert_types;
+        (void)now_ms;
+#endif
+    }
+}
+
+// Minute of the local day, -1 until SNTP has set the clock
+static int local_minute_of_day(void) {
+    time_t now = time(NULL);
+    struct tm local;
+    if (now < MASTER_CLOCK_VALID_AFTER || localtime_r(&now, &local) == NULL) {
+        return -1;
+    }
+    return local.tm_hour * 60 + local.tm_min;
+}
+
+// Logs an inactivity level raised in `room` (or the motion ending it) and
+// queues the alert. A level waits for room in the queue like a fall alert;
+// the end of one never waits and leaves the last slot to a fall alert.
+static void report_inactivity(uint8_t room, AlertType type, uint8_t level, uint32_t still_ms, uint32_t now_ms) {
+    const inactivity_room_t *ir = &room_inactivity[room];
+    AlertMessage alert_msg = {
+        .alert_timestamp = now_ms,
+        .still_ms = still_ms,
+        .x_mm = ir->anchor_x_mm,
+        .y_mm = ir->anchor_y_mm,
+        .type = type,
+        .level = level,
+        .room = room,
+    };
+    if (type == ALERT_TYPE_INACTIVITY) {
+        ESP_LOGW(TAG_FALL_DETECTOR, "Room %u: no significant motion for %u s (level %u/%d, weight %u %%).", room,
+                 still_ms / 1000, level, INACTIVITY_LEVELS, ir->weight_pct);
+        if (alert_queue == NULL || xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(100)) != pdPASS) {
+            ESP_LOGE(TAG_FALL_DETECTOR, "Failed to send inactivity alert to alert_queue.");
+        }
+    } else {
+        ESP_LOGI(TAG_FALL_DETECTOR, "Room %u: motion again after %u s still (level %u reached).", room,
+                 still_ms / 1000, level);
+        if (alert_queue == NULL || uxQueueSpacesAvailable(alert_queue) < 2 ||
+            xQueueSend(alert_queue, &alert_msg, 0) != pdPASS) {
+            ESP_LOGW(TAG_FALL_DETECTOR, "Alert queue busy: end of inactivity not sent.");
+        }
+    }
+}
+
+// Fall rules of the rooms of one shard (pvParameters: its PipelineShard)
+void FallDetector_task(void *pvParameters) {
+    PipelineShard *shard = (PipelineShard *)pvParameters;
+    const int first_room = shard->index, room_step = pipeline_plan.shard_count;
+    ESP_LOGI(TAG_FALL_DETECTOR, "FallDetector_task of shard %u started on core %d", shard->index, xPortGetCoreID());
+
+    const fsm_table_t *rules = fall_rules_table(); // Indexed by app_main, read-only here
+
+    FusedData *batch[PIPELINE_BATCH]; // fused_pool blocks, each holding a reference of this task
+    uint32_t last_tick_ms = esp_log_timestamp();
+    int minute_of_day = local_minute_of_day(); // Refreshed every FALL_TICK_MS
+    for (int room = first_room; room < FUSION_MAX_ROOMS; room += room_step) {
+        inactivity_room_init(&room_inactivity[room]);
+    }
 
     for(;;) {
-        vTaskDelay(pdMS_TO_TICKS(WATCHDOG_CHECK_INTERVAL_S * 1000));
-        uint32_t current_time_ms = esp_log_timestamp();
-        uint32_t uptime_seconds = (current_time_ms - system_start_time_ms) / 1000;
+        // Timer rules (confirmation of a person no longer reported) run even without outputs
+        uint32_t n = spsc_ring_pop_batch(&shard->fused_ring.ring, batch, PIPELINE_BATCH);
+        if (n == 0) {
+            hot_rings_wait(&shard->fused_ring, 1, pdMS_TO_TICKS(FALL_TICK_MS));
+            n = spsc_ring_pop_batch(&shard->fused_ring.ring, batch, PIPELINE_BATCH);
+        }
+        for (uint32_t b = 0; b < n; b++) {
+            const FusedData *current_data = batch[b];
+            ESP_LOGI(TAG_FALL_DETECTOR, "Received fused data: room=%u, track=%u/%u, TS=%u, Pos=(%d, %d) mm, V=(%d, %d) mm/s, Posture=%s (lying %u %%)",
+                     current_data->room, current_data->track_id, current_data->occupants, current_data->timestamp,
+                     current_data->x_mm, current_data->y_mm,
+                     current_data->vx_mm_s, current_data->vy_mm_s, radar_posture_name((radar_posture_t)current_data->posture),
+                     current_data->posture_pct[RADAR_POSTURE_LYING]);
+            if (current_data->room < FUSION_MAX_ROOMS) {
+                FallTrackState *st = fall_state_for(fall_track_state[current_data->room], current_data);
+                fall_feature_values_t features;
+                fall_features_add(&st->features, current_data);
+                fall_features_get(&st->features, current_data->timestamp, &features);
+                st->x_mm = current_data->x_mm;
+                st->y_mm = current_data->y_mm;
+                st->flags = current_data->flags;
+                if (current_data->sigma_cm != FUSED_SIGMA_UNKNOWN) {
+                    // Time since the previous output of the person, spent about here
+                    uint32_t dwell_ms = current_data->timestamp - st->fsm.last_ms;
+                    if (st->fsm.has_event && dwell_ms <= HEATMAP_MAX_DWELL_MS &&
+                        room_heatmaps[current_data->room].cells != NULL) {
+                        heatmap_add(&room_heatmaps[current_data->room], current_data->x_mm, current_data->y_mm,
+                                    dwell_ms, current_data->timestamp);
+                    }
+                    // Zones first: the fall policy is the one of the new position
+                    zone_event_t zone_events[ZONE_MAX_EVENTS];
+                    int count = zone_engine_update(&zone_engine, &st->zones, current_data->room, current_data->x_mm,
+                                                   current_data->y_mm, current_data->timestamp, zone_events);
+                    report_zone_events(st, current_data->room, zone_events, count, current_data->timestamp);
+                }
+                fsm_event_t event = fall_event_from(current_data, &features,
+                                                    zone_engine_fall_policy(&zone_engine, &st->zones, NULL));
+                uint8_t action = fsm_dispatch(rules, &st->fsm, &event);
+                fall_apply_action(st, current_data->room, action, current_data->timestamp);
+#if MASTER_INACTIVITY_ENABLED
+                // After the zones: the weight is the one of the new position
+                inactivity_room_t *ir = &room_inactivity[current_data->room];
+                uint32_t still_ms = inactivity_still_ms(ir, current_data->timestamp);
+                uint16_t weight = inactivity_weight_pct(&inactivity_config,
+                                                        zone_engine_inactivity_pct(&zone_engine, &st->zones),
+                                                        current_data->posture, minute_of_day);
+                uint8_t ended = inactivity_update(&inactivity_config, ir, current_data, weight);
+                if (ended != 0) {
+                    report_inactivity(current_data->room, ALERT_TYPE_INACTIVITY_CLEARED, ended, still_ms,
+                                      current_data->timestamp);
+                }
+#endif
+            }
+            msg_pool_release(&fused_pool, batch[b]);
+        }
 
-        if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            g_web_server_data.system_uptime_seconds = uptime_seconds;
+        uint32_t now_ms = esp_log_timestamp();
+        if (now_ms - last_tick_ms < FALL_TICK_MS) {
+            continue;
+        }
+        last_tick_ms = now_ms;
+        minute_of_day = local_minute_of_day();
+        const FallTrackState *latest[FUSION_MAX_ROOMS] = { NULL };
+        for (int room = first_room; room < FUSION_MAX_ROOMS; room += room_step) {
+#if MASTER_INACTIVITY_ENABLED
+            // Compares the next alert instant of the room with the clock
+            uint8_t level = inactivity_check(&inactivity_config, &room_inactivity[room], now_ms);
+            if (level != 0) {
+                report_inactivity((uint8_t)room, ALERT_TYPE_INACTIVITY, level,
+                                  inactivity_still_ms(&room_inactivity[room], now_ms), now_ms);
+            }
+#endif
+            for (int i = 0; i <= MTT_MAX_TRACKS; i++) {
+                FallTrackState *st = &fall_track_state[room][i];
+                if (st->fsm.has_event) {
+                    zone_event_t zone_events[ZONE_MAX_EVENTS];
+                    report_zone_events(st, (uint8_t)room, zone_events,
+                                       zone_engine_tick(&zone_engine, &st->zones, now_ms, zone_events), now_ms);
+                    uint8_t action = fsm_tick(rules, &st->fsm, now_ms,
+                                              zone_engine_fall_policy(&zone_engine, &st->zones, NULL));
+                    fall_apply_action(st, (uint8_t)room, action, now_ms);
+                    if (latest[room] == NULL || (int32_t)(st->fsm.last_ms - latest[room]->fsm.last_ms) > 0) {
+                        latest[room] = st;
+                    }
+                }
+            }
+        }
+
+        // Features of the person seen last in each room of the shard, for the status page
+        if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            for (int room = first_room; room < FUSION_MAX_ROOMS; room += room_step) {
+                g_web_server_data.rooms[room].still_ms = inactivity_still_ms(&room_inactivity[room], now_ms);
+                g_web_server_data.rooms[room].inactivity_level = room_inactivity[room].level;
+                g_web_server_data.rooms[room].has_person = latest[room] != NULL;
+                if (latest[room] != NULL) {
+                    g_web_server_data.rooms[room].person_track_id = latest[room]->fsm.user;
+                    g_web_server_data.rooms[room].person_fall_state = latest[room]->fsm.state;
+                    uint16_t zone;
+                    zone_engine_fall_policy(&zone_engine, &latest[room]->zones, &zone);
+                    if (zone == ZONE_NONE && latest[room]->zones.count > 0) {
+                        zone = latest[room]->zones.zone[0];
+                    }
+                    g_web_server_data.rooms[room].person_zone = zone;
+                    fall_features_get(&latest[room]->features, now_ms, &g_web_server_data.rooms[room].person_features);
+                }
+            }
             xSemaphoreGive(g_web_data_mutex);
         } else {
-            ESP_LOGE(TAG_WATCHDOG, "Failed to take g_web_data_mutex for uptime update.");
+            ESP_LOGE(TAG_FALL_DETECTOR, "Failed to take g_web_data_mutex for the motion features.");
         }
+    }
+}
 
-        for (int i = 0; i < NUM_SLAVE_MODULES; i++) {
-            bool initial_grace_period_passed = (current_time_ms - system_start_time_ms > (SLAVE_MODULE_TIMEOUT_S * 1000));
+// Subscriber of the fused bus of every shard: keeps a reference on the latest
+// output of each room for the status page. At the lowest priority on
+// NETWORK_CORE it only ever delays itself; a full tap ring loses outputs of
+// the page, never of the fall detection.
+void WebTap_task(void *pvParameters) {
+    ESP_LOGI(TAG_HTTP_SERVER, "WebTap_task started");
+    FusedData *batch[PIPELINE_BATCH];
+    FusedData *released[PIPELINE_BATCH];
 
-            if (last_received_timestamp_ms[i] == 0) { // Module has never sent data
-                if (initial_grace_period_passed && !module_offline_alerted[i]) {
-                    ESP_LOGW(TAG_WATCHDOG, "Module %d has never sent data after initial timeout.", i + 1);
-                    if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        g_web_server_data.module_status[i] = false;
-                        xSemaphoreGive(g_web_data_mutex);
-                    } else {
-                        ESP_LOGE(TAG_WATCHDOG, "Failed to take g_web_data_mutex for module status (never reported).");
-                    }
-                    
-                    AlertMessage alert_msg;
-                    alert_msg.type = ALERT_TYPE_MODULE_OFFLINE;
-                    alert_msg.alert_timestamp = current_time_ms;
-                    snprintf(alert_msg.description, sizeof(alert_msg.description), "Module %d never reported.", i + 1);
-                    
-                    if (alert_queue != NULL) {
-                        if (xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(100)) != pdPASS) {
-                            ESP_LOGE(TAG_WATCHDOG, "Failed to send MODULE_OFFLINE alert (never reported) for module %d to alert_queue.", i + 1);
-                        } else {
-                             ESP_LOGI(TAG_WATCHDOG, "MODULE_OFFLINE alert (never reported) for module %d sent to alert_queue.", i + 1);
-                        }
-                    } else {
-                        ESP_LOGE(TAG_WATCHDOG, "alert_queue is NULL. Cannot send MODULE_OFFLINE alert (never reported) for module %d.", i + 1);
+    for(;;) {
+        uint32_t total = 0;
+        for (int s = 0; s < pipeline_plan.shard_count; s++) {
+            uint32_t n = spsc_ring_pop_batch(&web_tap_rings[s].ring, batch, PIPELINE_BATCH);
+            if (n == 0) {
+                continue;
+            }
+            total += n;
+            // Swapped under the mutex, released after: the page only reads
+            // the blocks still referenced from g_web_server_data
+            memcpy(released, batch, n * sizeof(batch[0]));
+            if (xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                for (uint32_t b = 0; b < n; b++) {
+                    uint8_t room = batch[b]->room;
+                    if (room < FUSION_MAX_ROOMS) {
+                        released[b] = g_web_server_data.rooms[room].last_output;
+                        g_web_server_data.rooms[room].last_output = batch[b];
+                        g_web_server_data.rooms[room].outputs++;
                     }
-                    module_offline_alerted[i] = true; // Mark as alerted
                 }
-            } else if ((current_time_ms - last_received_timestamp_ms[i]) > (SLAVE_MODULE_TIMEOUT_S * 1000)) {
-                // Module has sent data before, but not recently
-                if (!module_offline_alerted[i]) { // Check if an offline alert for this timeout has already been sent
-                    ESP_LOGW(TAG_WATCHDOG, "Module %d timed out. Last seen %u ms ago.", i + 1, current_time_ms - last_received_timestamp_ms[i]);
-                     if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        g_web_server_data.module_status[i] = false;
-                        xSemaphoreGive(g_web_data_mutex);
-                    } else {
-                        ESP_LOGE(TAG_WATCHDOG, "Failed to take g_web_data_mutex for module status (timeout).");
+                xSemaphoreGive(g_web_data_mutex);
+            }
+            for (uint32_t b = 0; b < n; b++) {
+                if (released[b] != NULL) {
+                    msg_pool_release(&fused_pool, released[b]);
+                }
+            }
+        }
+        if (total == 0) {
+            hot_rings_wait(web_tap_rings, pipeline_plan.shard_count, portMAX_DELAY);
+        }
+    }
+}
+
+// Description of `alert` for the status page and the payload
+static void alert_full_description(const AlertMessage *alert, char *buf, size_t len) {
+    int used = alert_describe(alert, buf, len);
+    // Zone names are only known here
+    bool has_zone = alert->type == ALERT_TYPE_ZONE_ENTER || alert->type == ALERT_TYPE_ZONE_EXIT ||
+                    alert->type == ALERT_TYPE_ZONE_DWELL ||
+                    (alert->type == ALERT_TYPE_FALL_DETECTED && (alert->flags & ALERT_FLAG_ESCALATED));
+    if (has_zone && alert->zone < NUM_ZONES && used > 0 && (size_t)used < len) {
+        snprintf(buf + used, len - used, " (%s)", zone_config[alert->zone].name);
+    }
+}
+
+// Saves the outbox to NVS when it changed: copied under the mutex, written
+// without it. A failed write is tried again at the next pass.
+static void alert_outbox_persist(void) {
+    static uint8_t blob[ALERT_OUTBOX_BLOB_MAX];
+    size_t len = 0;
+    if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    if (alert_outbox.dirty) {
+        len = alert_outbox_save(&alert_outbox, blob, sizeof(blob));
+    }
+    xSemaphoreGive(alert_outbox_mutex);
+    if (len == 0) {
+        return;
+    }
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(ALERT_OUTBOX_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, ALERT_OUTBOX_NVS_KEY, blob, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_ALERT_MANAGER, "Failed to save the alert outbox to NVS: %s", esp_err_to_name(err));
+        if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            alert_outbox.dirty = true;
+            xSemaphoreGive(alert_outbox_mutex);
+        }
+    }
+}
+
+// Publishes the due alerts of the outbox, oldest first, while the upstream
+// broker is connected. The mutex is not held across a publish: the esp-mqtt
+// task takes it in the event handler for a PUBACK.
+static void alert_outbox_publish_due(void) {
+    char description[ALERT_DESCRIPTION_MAX];
+    char payload[ALERT_PAYLOAD_MAX];
+    alert_outbox_entry_t entry;
+    while (mqtt_connected_flag && client_handle != NULL) {
+        if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+            return;
+        }
+        bool due = alert_outbox_take_due(&alert_outbox, esp_log_timestamp(), &entry);
+        xSemaphoreGive(alert_outbox_mutex);
+        if (!due) {
+            return;
+        }
+        alert_full_description(&entry.alert, description, sizeof(description));
+        alert_payload(&entry.alert, entry.id, description, payload, sizeof(payload));
+        int msg_id = esp_mqtt_client_publish(client_handle, ALERT_TOPIC, payload, 0, 1, 0);
+        bool delivered = false;
+        if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            // Not recorded otherwise: published again after the ack timeout
+            delivered = alert_outbox_sent(&alert_outbox, entry.id, msg_id, esp_log_timestamp(), wall_clock_s());
+            xSemaphoreGive(alert_outbox_mutex);
+        }
+        if (msg_id < 0) {
+            ESP_LOGE(TAG_ALERT_MANAGER, "Failed to publish alert %u to MQTT topic %s, retried later.", entry.id,
+                     ALERT_TOPIC);
+            return;
+        }
+        ESP_LOGI(TAG_ALERT_MANAGER, "Alert %u published to MQTT topic %s (attempt %u), msg_id=%d%s", entry.id,
+                 ALERT_TOPIC, entry.attempts, msg_id, delivered ? ", already acknowledged" : "");
+    }
+}
+
+void AlertManager_task(void *pvParameters) {
+    ESP_LOGI(TAG_ALERT_MANAGER, "AlertManager_task started");
+    AlertMessage received_alert;
+    char description[ALERT_DESCRIPTION_MAX]; // Built here rather than carried in every queue item
+#if MASTER_EMBEDDED_BROKER_ENABLED || MASTER_UPSTREAM_BRIDGE_ENABLED
+    char mqtt_payload[ALERT_PAYLOAD_MAX];
+#endif
+
+    for(;;) {
+        // Asleep until the next alert while the outbox is empty; otherwise
+        // back for its next retry, at least every ALERT_OUTBOX_POLL_MS for
+        // the PUBACKs to save and the broker coming back
+        TickType_t wait = portMAX_DELAY;
+        uint32_t due_ms;
+        if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            if (alert_outbox_next_due(&alert_outbox, &due_ms)) {
+                int32_t until_ms = (int32_t)(due_ms - esp_log_timestamp());
+                wait = pdMS_TO_TICKS(ALERT_OUTBOX_POLL_MS);
+                if (mqtt_connected_flag && until_ms < ALERT_OUTBOX_POLL_MS) {
+                    wait = pdMS_TO_TICKS(until_ms > 10 ? until_ms : 10);
+                }
+            }
+            xSemaphoreGive(alert_outbox_mutex);
+        } else {
+            wait = pdMS_TO_TICKS(ALERT_OUTBOX_POLL_MS);
+        }
+
+        if (xQueueReceive(alert_queue, &received_alert, wait) == pdPASS) {
+            alert_full_description(&received_alert, description, sizeof(description));
+            ESP_LOGI(TAG_ALERT_MANAGER, "Received alert. Type: %d, Description: %s, Timestamp: %u",
+                     received_alert.type, description, received_alert.alert_timestamp);
+
+            // Update web server data with the new alert
+            if(xSemaphoreTake(g_web_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                // Use alert_write_index for circular buffer
+                strlcpy(g_web_server_data.last_alerts[g_web_server_data.alert_write_index], description,
+                        sizeof(g_web_server_data.last_alerts[0]));
+
+                g_web_server_data.alert_write_index = (g_web_server_data.alert_write_index + 1) % 5;
+                if (g_web_server_data.stored_alert_count < 5) {
+                    g_web_server_data.stored_alert_count++;
+                }
+                xSemaphoreGive(g_web_data_mutex);
+            } else {
+                ESP_LOGE(TAG_ALERT_MANAGER, "Failed to take g_web_data_mutex for updating alerts.");
+            }
+
+            uint32_t alert_id = 0;
+#if MASTER_UPSTREAM_BRIDGE_ENABLED
+            if (alert_outbox_rank((AlertType)received_alert.type) == 0) {
+                // Informational: best-effort, neither an outbox slot nor an NVS write
+                if (mqtt_connected_flag && client_handle != NULL) {
+                    alert_payload(&received_alert, 0, description, mqtt_payload, sizeof(mqtt_payload));
+                    esp_mqtt_client_publish(client_handle, ALERT_TOPIC, mqtt_payload, 0, 0, 0);
+                } else {
+                    ESP_LOGD(TAG_ALERT_MANAGER, "MQTT not connected. Informational alert not published.");
+                }
+            } else if (xSemaphoreTake(alert_outbox_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                // Upstream bridge: kept in the outbox until the external broker acknowledges it
+                uint32_t dropped = alert_outbox.stats.dropped;
+                alert_id = alert_outbox_push(&alert_outbox, &received_alert, esp_log_timestamp(), wall_clock_s());
+                dropped = alert_outbox.stats.dropped - dropped;
+                xSemaphoreGive(alert_outbox_mutex);
+                if (alert_id == 0) {
+                    ESP_LOGW(TAG_ALERT_MANAGER, "Alert outbox full of more serious alerts: alert dropped.");
+                } else if (dropped > 0) {
+                    ESP_LOGW(TAG_ALERT_MANAGER, "Alert outbox full: oldest least serious alert dropped for alert %u.",
+                             alert_id);
+                }
+                if (alert_id != 0 && !mqtt_connected_flag) {
+                    ESP_LOGW(TAG_ALERT_MANAGER, "MQTT not connected. Alert %u kept until the broker is back.",
+                             alert_id);
+                }
+            } else {
+                ESP_LOGE(TAG_ALERT_MANAGER, "Failed to take alert_outbox_mutex. Alert not published via MQTT.");
+            }
+#endif
+
+#if MASTER_EMBEDDED_BROKER_ENABLED
+            // Local subscribers (phones, dashboards on the LAN) get the alert from the master itself
+            alert_payload(&received_alert, alert_id, description, mqtt_payload, sizeof(mqtt_payload));
+            ESP_LOGI(TAG_ALERT_MANAGER, "Prepared MQTT Payload: %s", mqtt_payload);
+            embedded_broker_enqueue(ALERT_TOPIC, mqtt_payload);
+#else
+            (void)alert_id; // Only the local payload carries it
+#endif
+
+            ESP_LOGI(TAG_ALERT_MANAGER, "Placeholder for Buzzer/LED activation.");
+            ESP_LOGI(TAG_ALERT_MANAGER, "Placeholder for HTTP POST/E-mail notification.");
+        }
+
+        // Saved before the publish: an alert raised just before a reboot survives it
+        alert_outbox_persist();
+        alert_outbox_publish_due();
+    }
+}
+
+
+// MODULE_OFFLINE when the liveness timer of `module` expires: no sample for
+// SLAVE_MODULE_TIMEOUT_S, counted from its last sample or, if it never sent
+// any, from its mDNS discovery. Called with module_registry_mutex held; an
+// alert that cannot be queued is retried WATCHDOG_RETRY_MS later.
+static void report_module_offline(module_info_t *module, uint32_t now_ms) {
+    bool never_reported = (module->last_seen_ms == 0);
+    uint32_t silent_ms = now_ms - (never_reported ? module->first_seen_ms : module->last_seen_ms);
+    module->online = false;
+    AlertMessage alert_msg = {
+        .alert_timestamp = now_ms,
+        .silent_ms = silent_ms,
+        .type = ALERT_TYPE_MODULE_OFFLINE,
+        .module_id = module->id,
+        .flags = never_reported ? ALERT_FLAG_NEVER_REPORTED : 0,
+    };
+    if (never_reported) {
+        ESP_LOGW(TAG_WATCHDOG, "Module %u has never sent data after initial timeout.", module->id);
+    } else {
+        ESP_LOGW(TAG_WATCHDOG, "Module %u timed out. Last seen %u ms ago.", module->id, silent_ms);
+    }
+    // Short timeout: the registry mutex is held
+    if (alert_queue != NULL && xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(10)) == pdPASS) {
+        ESP_LOGI(TAG_WATCHDOG, "MODULE_OFFLINE alert for module %u sent to alert_queue.", module->id);
+        module->offline_alerted = true; // Cleared by the RadarRouter when data arrives again
+    } else {
+        ESP_LOGE(TAG_WATCHDOG, "Failed to send MODULE_OFFLINE alert for module %u to alert_queue.", module->id);
+        timer_wheel_arm(&watchdog_wheel, LIVENESS_TIMER(module_slot(module)), now_ms + WATCHDOG_RETRY_MS);
+    }
+}
+
+// SENSOR_DEGRADED / SENSOR_RESTORED when the health timer of `module` expires
+// (armed by the RadarRouter when the health changed). Same locking and retry.
+static void report_sensor_health(module_info_t *module, uint32_t now_ms) {
+    sensor_health_t *health = &module->health;
+    if (health->degraded == health->alerted) {
+        return; // Changed back before it was reported
+    }
+    AlertMessage alert_msg = {
+        .alert_timestamp = now_ms,
+        .score = health->score,
+        .reasons = health->reasons,
+        .type = health->degraded ? ALERT_TYPE_SENSOR_DEGRADED : ALERT_TYPE_SENSOR_RESTORED,
+        .module_id = module->id,
+    };
+    if (alert_queue != NULL && xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(10)) == pdPASS) {
+        health->alerted = health->degraded;
+    } else {
+        ESP_LOGE(TAG_WATCHDOG, "Failed to send %s alert for module %u to alert_queue.",
+                 alert_type_name((AlertType)alert_msg.type), module->id);
+        timer_wheel_arm(&watchdog_wheel, HEALTH_TIMER(module_slot(module)), now_ms + WATCHDOG_RETRY_MS);
+    }
+}
+
+// Sleeps until the earliest deadline of watchdog_wheel, or until the
+// RadarRouter notifies a health change. A wake only handles the timers due.
+void Watchdog_task(void *pvParameters) {
+    ESP_LOGI(TAG_WATCHDOG, "Watchdog_task started");
+    uint16_t due[WATCHDOG_EXPIRE_BATCH];
+
+    for(;;) {
+        // A liveness deadline armed while asleep is at least the timeout away: waking by then is enough
+        TickType_t wait = pdMS_TO_TICKS(SLAVE_MODULE_TIMEOUT_S * 1000);
+        if (xSemaphoreTake(module_registry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            uint32_t now_ms = esp_log_timestamp();
+            size_t count;
+            do {
+                count = timer_wheel_expire(&watchdog_wheel, now_ms, due, WATCHDOG_EXPIRE_BATCH);
+                for (size_t i = 0; i < count; i++) {
+                    module_info_t *module = module_registry_at(&module_registry, due[i] % MODULE_REGISTRY_MAX_MODULES);
+                    if (module == NULL) {
+                        continue;
                     }
-                    
-                    AlertMessage alert_msg;
-                    alert_msg.type = ALERT_TYPE_MODULE_OFFLINE;
-                    alert_msg.alert_timestamp = current_time_ms;
-                    snprintf(alert_msg.description, sizeof(alert_msg.description), "Module %d offline. Last seen %u ms ago.", i + 1, current_time_ms - last_received_timestamp_ms[i]);
-                    
-                    if (alert_queue != NULL) {
-                         if (xQueueSend(alert_queue, &alert_msg, pdMS_TO_TICKS(100)) != pdPASS) {
-                            ESP_LOGE(TAG_WATCHDOG, "Failed to send MODULE_OFFLINE alert (timeout) for module %d to alert_queue.", i + 1);
-                        } else {
-                            ESP_LOGI(TAG_WATCHDOG, "MODULE_OFFLINE alert (timeout) for module %d sent to alert_queue.", i + 1);
-                        }
+                    if (due[i] < MODULE_REGISTRY_MAX_MODULES) {
+                        report_module_offline(module, now_ms);
                     } else {
-                        ESP_LOGE(TAG_WATCHDOG, "alert_queue is NULL. Cannot send MODULE_OFFLINE alert (timeout) for module %d.", i + 1);
+                        report_sensor_health(module, now_ms);
                     }
-                    module_offline_alerted[i] = true; // Mark as alerted
                 }
-            } 
-            // The case where module_offline_alerted[i] is true and the module comes back online
-            // is handled in FusionEngine_task.
+            } while (count == WATCHDOG_EXPIRE_BATCH);
+            uint32_t next_ms;
+            if (timer_wheel_next_deadline(&watchdog_wheel, &next_ms)) {
+                int32_t until_ms = (int32_t)(next_ms - now_ms);
+                TickType_t until = until_ms <= 0 ? 1 : pdMS_TO_TICKS(until_ms) + 1; // Rounded up: never early
+                wait = until < wait ? until : wait;
+            }
+            xSemaphoreGive(module_registry_mutex);
+        } else {
+            ESP_LOGE(TAG_WATCHDOG, "Failed to take module_registry_mutex.");
+            wait = pdMS_TO_TICKS(WATCHDOG_RETRY_MS);
         }
+        ulTaskNotifyTake(pdTRUE, wait);
     }
 }
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+#include "module_registry.h"
+
+static void copy_field(char *dst, size_t dst_len, const char *src) {
+    if (src == NULL) {
+        return;
+    }
+    strncpy(dst, src, dst_len - 1);
+    dst[dst_len - 1] = '\0';
+}
+
+void module_registry_init(module_registry_t *reg) {
+    memset(reg, 0, sizeof(*reg));
+}
+
+module_info_t *module_registry_find(module_registry_t *reg, int id) {
+    if (id <= 0 || id > 255) {
+        return NULL;
+    }
+    uint8_t slot = reg->slot_by_id[id];
+    return slot ? &reg->modules[slot - 1] : NULL;
+}
+
+module_info_t *module_registry_get_or_add(module_registry_t *reg, int id, uint32_t now_ms) {
+    if (id <= 0 || id > 255) {
+        return NULL;
+    }
+    module_info_t *module = module_registry_find(reg, id);
+    if (module) {
+        return module;
+    }
+    if (reg->count >= MODULE_REGISTRY_MAX_MODULES) {
+        reg->rejected++;
+        return NULL;
+    }
+    module = &reg->modules[reg->count];
+    memset(module, 0, sizeof(*module));
+    module->id = (uint8_t)id;
+    module->first_seen_ms = now_ms;
+    sensor_health_init(&module->health);
+    reg->count++;
+    reg->slot_by_id[id] = reg->count; // slot + 1
+    return module;
+}
+
+module_info_t *module_registry_note_sample(module_registry_t *reg, int id, uint32_t now_ms, bool *came_back) {
+    if (came_back) {
+        *came_back = false;
+    }
+    module_info_t *module = module_registry_get_or_add(reg, id, now_ms);
+    if (module == NULL) {
+        return NULL;
+    }
+    module->sources |= MODULE_SOURCE_TRAFFIC;
+    module->last_seen_ms = now_ms ? now_ms : 1; // 0 is reserved for "never"
+    module->sample_count++;
+    module->online = true;
+    if (module->offline_alerted) {
+        module->offline_alerted = false;
+        if (came_back) {
+            *came_back = true;
+        }
+    }
+    return module;
+}
+
+bool module_registry_check_sequence(module_registry_t *reg, int id, uint32_t sequence, uint32_t now_ms) {
+    module_info_t *module = module_registry_get_or_add(reg, id, now_ms);
+    if (module == NULL) {
+        return true;
+    }
+    uint32_t lost = 0;
+    switch (radar_wire_replay_check(&module->seq_window, sequence, &lost)) {
+    case RADAR_REPLAY_ACCEPT:
+        module->samples_lost += lost;
+        return true;
+    case RADAR_REPLAY_DUPLICATE:
+        module->duplicates++;
+        return false;
+    case RADAR_REPLAY_TOO_OLD:
+    default:
+        module->seq_window.initialized = false;
+        radar_wire_replay_check(&module->seq_window, sequence, NULL);
+        return true;
+    }
+}
+
+module_info_t *module_registry_note_announce(module_registry_t *reg, int id, uint32_t now_ms,
+                                             const char *room, const char *hostname,
+                                             uint32_t ipv4, const char *firmware_version) {
+    module_info_t *module = module_registry_get_or_add(reg, id, now_ms);
+    if (module == NULL) {
+        return NULL;
+    }
+    module->sources |= MODULE_SOURCE_MDNS;
+    module->last_announce_ms = now_ms ? now_ms : 1;
+    if (ipv4) {
+        module->ipv4 = ipv4;
+    }
+    if (room != NULL && strncmp(module->room, room, sizeof(module->room) - 1) != 0) {
+        copy_field(module->room, sizeof(module->room), room);
+        module->room_changed = true;
+    }
+    copy_field(module->hostname, sizeof(module->hostname), hostname);
+    copy_field(module->firmware_version, sizeof(module->firmware_version), firmware_version);
+    return module;
+}
+
+bool module_registry_parse_id(const char *text, int *id) {
+    if (text == NULL || *text == '\0') {
+        return false;
+    }
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (*end != '\0' || value < 1 || value > 255) {
+        return false;
+    }
+    *id = (int)value;
+    return true;
+}
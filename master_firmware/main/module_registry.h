@@ -0,0 +1,91 @@
+#ifndef MODULE_REGISTRY_H
+#define MODULE_REGISTRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "radar_wire.h"
+#include "sensor_health.h"
+
+// Runtime registry of the radar modules known to the master.
+//
+// Modules are added when they are announced over mDNS (_hlk_radar._tcp, TXT
+// module_id/room/version) or when their first radar sample arrives, so new
+// slaves need no recompile of the master. Lookup by module id is O(1) through
+// a 256-entry id -> slot table (ids are a u8 on the wire, 0 is invalid); the
+// modules themselves live in a dense array for cheap iteration.
+//
+// Plain C, no locking: the caller serializes access (module_registry_mutex).
+
+#define MODULE_REGISTRY_MAX_MODULES 64
+#define MODULE_ROOM_LEN             16
+#define MODULE_HOSTNAME_LEN         32
+#define MODULE_FIRMWARE_LEN         12
+
+#define MODULE_SOURCE_MDNS    (1u << 0)
+#define MODULE_SOURCE_TRAFFIC (1u << 1)
+
+typedef struct {
+    uint8_t id;
+    uint8_t sources;           // MODULE_SOURCE_* that have seen this module
+    bool online;
+    bool offline_alerted;      // A MODULE_OFFLINE alert is outstanding
+    bool room_changed;         // Set by an announce that changed `room`, cleared by the RadarRouter
+    uint32_t ipv4;             // Network byte order, 0 = unknown
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;     // Last radar sample, 0 = never sent data
+    uint32_t last_announce_ms; // Last mDNS answer, 0 = never announced
+    uint32_t sample_count;
+    radar_wire_replay_t seq_window; // Sample sequences seen (MQTT 5 "s" user property)
+    uint32_t samples_lost;     // Gaps in the sequence
+    uint32_t duplicates;       // Redelivered samples dropped (QoS 1 retransmissions)
+    sensor_health_t health;    // Updated by the RadarRouter, alerts raised by the watchdog
+    char room[MODULE_ROOM_LEN];
+    char hostname[MODULE_HOSTNAME_LEN];
+    char firmware_version[MODULE_FIRMWARE_LEN];
+} module_info_t;
+
+typedef struct {
+    uint8_t slot_by_id[256];   // slot + 1, 0 = unknown id
+    uint8_t count;
+    uint32_t rejected;         // Registrations refused because the registry is full
+    module_info_t modules[MODULE_REGISTRY_MAX_MODULES];
+} module_registry_t;
+
+void module_registry_init(module_registry_t *reg);
+
+// O(1). Returns NULL for unknown ids.
+module_info_t *module_registry_find(module_registry_t *reg, int id);
+
+// Returns the module, registering it first if needed. NULL if the id is out of
+// range (1..255) or the registry is full.
+module_info_t *module_registry_get_or_add(module_registry_t *reg, int id, uint32_t now_ms);
+
+// Records a radar sample. `came_back` (optional) is set when the module had an
+// outstanding offline alert, which this call clears.
+module_info_t *module_registry_note_sample(module_registry_t *reg, int id, uint32_t now_ms, bool *came_back);
+
+// Checks the sequence number of a sample before it is recorded. Returns false
+// for a duplicate, which the caller drops. A sequence older than the window is
+// taken as a slave whose NVS was erased: the window restarts from it. Unknown
+// modules are registered; if that fails the sample is let through (and will be
+// rejected by module_registry_note_sample()).
+bool module_registry_check_sequence(module_registry_t *reg, int id, uint32_t sequence, uint32_t now_ms);
+
+// Records an mDNS announcement. NULL strings leave the stored value unchanged.
+module_info_t *module_registry_note_announce(module_registry_t *reg, int id, uint32_t now_ms,
+                                             const char *room, const char *hostname,
+                                             uint32_t ipv4, const char *firmware_version);
+
+static inline size_t module_registry_count(const module_registry_t *reg) {
+    return reg->count;
+}
+
+static inline module_info_t *module_registry_at(module_registry_t *reg, size_t index) {
+    return index < reg->count ? &reg->modules[index] : NULL;
+}
+
+// Parses a TXT "module_id" value. Returns false unless it is a decimal in 1..255.
+bool module_registry_parse_id(const char *text, int *id);
+
+#endif // MODULE_REGISTRY_H
@@ -0,0 +1,632 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "mqtt_broker.h"
+#include "mqtt5_props.h"
+
+#define PKT_CONNECT     1
+#define PKT_CONNACK     2
+#define PKT_PUBLISH     3
+#define PKT_PUBACK      4
+#define PKT_SUBSCRIBE   8
+#define PKT_SUBACK      9
+#define PKT_UNSUBSCRIBE 10
+#define PKT_UNSUBACK    11
+#define PKT_PINGREQ     12
+#define PKT_PINGRESP    13
+#define PKT_DISCONNECT  14
+
+#define CONNACK_ACCEPTED          0
+#define CONNACK_BAD_PROTOCOL      1
+#define CONNACK_SERVER_UNAVAILABLE 3
+
+#define MQTT_LEVEL_311 4
+#define MQTT_LEVEL_5   5
+
+// MQTT 5 reason codes
+#define REASON_SUCCESS            0x00
+#define REASON_NO_SUBSCRIPTION    0x11
+#define REASON_UNSPECIFIED_ERROR  0x80
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Decodes the fixed header at the start of `buf`. Returns 1 with the header and
+// remaining lengths when complete, 0 when more bytes are needed, -1 if malformed.
+static int decode_fixed_header(const uint8_t *buf, size_t len, size_t *header_len, uint32_t *remaining) {
+    uint32_t value = 0, mult = 1;
+    for (size_t i = 1; i < 5; i++) {
+        if (i >= len) {
+            return 0;
+        }
+        value += (uint32_t)(buf[i] & 0x7F) * mult;
+        if ((buf[i] & 0x80) == 0) {
+            *header_len = i + 1;
+            *remaining = value;
+            return 1;
+        }
+        mult *= 128;
+    }
+    return -1;
+}
+
+bool mqtt_topic_matches(const char *filter, const char *topic, size_t topic_len) {
+    size_t t = 0;
+    const char *f = filter;
+
+    // Wildcards at the first level do not match system topics ("$SYS/...")
+    if (topic_len > 0 && topic[0] == '$' && (f[0] == '+' || f[0] == '#')) {
+        return false;
+    }
+    while (*f) {
+        if (*f == '#') {
+            return true;
+        }
+        if (*f == '+') {
+            while (t < topic_len && topic[t] != '/') {
+                t++;
+            }
+            f++;
+        } else {
+            while (*f && *f != '/') {
+                if (t >= topic_len || topic[t] != *f) {
+                    return false;
+                }
+                t++;
+                f++;
+            }
+        }
+        if (*f == '\0') {
+            break;
+        }
+        // *f == '/': the topic must also have a level separator here
+        if (t >= topic_len) {
+            return f[1] == '#' && f[2] == '\0'; // "a/#" also matches "a"
+        }
+        if (topic[t] != '/') {
+            return false;
+        }
+        f++;
+        t++;
+    }
+    return t == topic_len;
+}
+
+static void close_client(mqtt_broker_t *broker, mqtt_broker_client_t *client) {
+    if (client->sock >= 0) {
+        close(client->sock);
+        broker->stats.disconnects++;
+        if (broker->stats.active_clients > 0) {
+            broker->stats.active_clients--;
+        }
+    }
+    memset(client, 0, sizeof(*client));
+    client->sock = -1;
+}
+
+// Sends a whole packet. The socket has a send timeout: a subscriber that cannot
+// take the packet within MQTT_BROKER_SEND_TIMEOUT_MS is dropped rather than
+// stalling every other client.
+static bool send_packet(mqtt_broker_t *broker, mqtt_broker_client_t *client, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        int written = send(client->sock, data, len, MSG_NOSIGNAL);
+        if (written <= 0) {
+            close_client(broker, client);
+            return false;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+// Serializes a QoS 0 PUBLISH for a subscriber of the given protocol level.
+// Returns the packet length, or 0 if it does not fit.
+static size_t build_delivery(uint8_t *packet, size_t cap, const mqtt_broker_message_t *msg, uint8_t level) {
+    bool v5 = level == MQTT_LEVEL_5;
+    uint8_t props_len_bytes[4];
+    size_t props_header = v5 ? mqtt5_varint_encode(props_len_bytes, (uint32_t)msg->props_len) : 0;
+    size_t body_len = 2 + msg->topic_len + (v5 ? props_header + msg->props_len : 0) + msg->payload_len;
+    if (body_len + 5 > cap) {
+        return 0;
+    }
+    size_t n = 0;
+    packet[n++] = PKT_PUBLISH << 4; // QoS 0, no retain
+    n += mqtt5_varint_encode(packet + n, (uint32_t)body_len);
+    packet[n++] = (uint8_t)(msg->topic_len >> 8);
+    packet[n++] = (uint8_t)msg->topic_len;
+    memcpy(packet + n, msg->topic, msg->topic_len);
+    n += msg->topic_len;
+    if (v5) {
+        memcpy(packet + n, props_len_bytes, props_header);
+        n += props_header;
+        if (msg->props_len) {
+            memcpy(packet + n, msg->props, msg->props_len);
+            n += msg->props_len;
+        }
+    }
+    memcpy(packet + n, msg->payload, msg->payload_len);
+    return n + msg->payload_len;
+}
+
+static int deliver(mqtt_broker_t *broker, mqtt_broker_client_t *from, const mqtt_broker_message_t *msg) {
+    // One encoding per protocol level, built on first use
+    uint8_t packets[2][MQTT_BROKER_RX_BUF_SIZE + 8];
+    size_t packet_len[2] = { 0, 0 };
+    bool built[2] = { false, false };
+
+    int deliveries = 0;
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+        mqtt_broker_client_t *client = &broker->clients[i];
+        if (client->sock < 0 || !client->connected || client == from) {
+            continue; // No echo to the publisher (MQTT 5 "no local" behaviour, harmless for 3.1.1 clients here)
+        }
+        for (int s = 0; s < MQTT_BROKER_MAX_SUBS; s++) {
+            if (client->filters[s][0] && mqtt_topic_matches(client->filters[s], msg->topic, msg->topic_len)) {
+                int v = client->protocol_level == MQTT_LEVEL_5 ? 1 : 0;
+                if (!built[v]) {
+                    packet_len[v] = build_delivery(packets[v], sizeof(packets[v]), msg, client->protocol_level);
+                    built[v] = true;
+                }
+                if (packet_len[v] == 0) {
+                    broker->stats.deliveries_dropped++;
+                } else if (send_packet(broker, client, packets[v], packet_len[v])) {
+                    deliveries++;
+                    broker->stats.publishes_out++;
+                } else {
+                    broker->stats.deliveries_dropped++;
+                }
+                break; // One copy per client even with overlapping filters
+            }
+        }
+    }
+    return deliveries;
+}
+
+// Reads the property length at body[*offset] and skips (after validating) the block.
+// `props`/`props_len` receive the block itself. Returns false if malformed.
+static bool take_properties(uint8_t *body, size_t len, size_t *offset, uint8_t **props, size_t *props_len) {
+    uint32_t block_len;
+    int used = mqtt5_varint_decode(body + *offset, len - *offset, &block_len);
+    if (used <= 0 || *offset + (size_t)used + block_len > len) {
+        return false;
+    }
+    *props = body + *offset + used;
+    *props_len = block_len;
+    *offset += (size_t)used + block_len;
+    return mqtt5_props_valid(*props, *props_len);
+}
+
+static bool handle_connect(mqtt_broker_t *broker, mqtt_broker_client_t *client, uint8_t *body, size_t len) {
+    // Protocol name "MQTT", level 4 (3.1.1) or 5. An unknown level is refused with the 3.1.1 code.
+    if (len < 10 || get_u16(body) != 4 || memcmp(body + 2, "MQTT", 4) != 0 ||
+        (body[6] != MQTT_LEVEL_311 && body[6] != MQTT_LEVEL_5)) {
+        uint8_t connack[4] = { PKT_CONNACK << 4, 2, 0, CONNACK_BAD_PROTOCOL };
+        send_packet(broker, client, connack, sizeof(connack));
+        broker->stats.connections_rejected++;
+        return false;
+    }
+    client->protocol_level = body[6];
+    client->keepalive_s = get_u16(body + 8);
+    size_t offset = 10;
+    if (client->protocol_level == MQTT_LEVEL_5) {
+        uint8_t *props;
+        size_t props_len;
+        if (!take_properties(body, len, &offset, &props, &props_len)) {
+            return false; // Session expiry, receive maximum... are accepted and ignored
+        }
+    }
+    if (offset + 2 > len) {
+        return false;
+    }
+    size_t id_len = get_u16(body + offset);
+    offset += 2;
+    if (offset + id_len > len) {
+        return false;
+    }
+    size_t copy = id_len < MQTT_BROKER_CLIENT_ID_LEN - 1 ? id_len : MQTT_BROKER_CLIENT_ID_LEN - 1;
+    memcpy(client->client_id, body + offset, copy);
+    client->client_id[copy] = '\0';
+    // Will, username and password fields (if flagged) are ignored.
+
+    // A reconnecting client (same id) takes over its old session slot
+    if (client->client_id[0]) {
+        for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+            mqtt_broker_client_t *other = &broker->clients[i];
+            if (other != client && other->sock >= 0 && other->connected &&
+                strcmp(other->client_id, client->client_id) == 0) {
+                close_client(broker, other);
+            }
+        }
+    }
+
+    client->connected = true;
+    broker->stats.connections_accepted++;
+    if (client->protocol_level == MQTT_LEVEL_5) {
+        // Announce what the broker supports: inbound topic aliases, QoS <= 1, no retained messages
+        uint8_t connack[] = {
+            PKT_CONNACK << 4, 10, 0, REASON_SUCCESS, 7,
+            MQTT5_PROP_TOPIC_ALIAS_MAX, 0, MQTT_BROKER_MAX_TOPIC_ALIASES,
+            MQTT5_PROP_MAXIMUM_QOS, 1,
+            MQTT5_PROP_RETAIN_AVAILABLE, 0,
+        };
+        return send_packet(broker, client, connack, sizeof(connack));
+    }
+    uint8_t connack[4] = { PKT_CONNACK << 4, 2, 0, CONNACK_ACCEPTED };
+    return send_packet(broker, client, connack, sizeof(connack));
+}
+
+// Resolves/records the topic alias of an MQTT 5 PUBLISH and removes it from the
+// property block in place, so that the remaining properties can be forwarded.
+// A topic too long for the alias table is delivered but not remembered: a later
+// PUBLISH relying on that alias is then a protocol error.
+static bool resolve_topic_alias(mqtt_broker_t *broker, mqtt_broker_client_t *client, const char **topic,
+                                size_t *topic_len, uint8_t *props, size_t *props_len) {
+    size_t offset = 0, kept = 0;
+    bool has_alias = false;
+    uint32_t alias = 0;
+    mqtt5_prop_t prop;
+    while (offset < *props_len) {
+        size_t start = offset;
+        if (mqtt5_prop_next(props, *props_len, &offset, &prop) <= 0) {
+            return false;
+        }
+        if (prop.id == MQTT5_PROP_TOPIC_ALIAS) {
+            has_alias = true;
+            alias = prop.value;
+            continue;
+        }
+        memmove(props + kept, props + start, offset - start);
+        kept += offset - start;
+    }
+    *props_len = kept;
+
+    if (!has_alias) {
+        return *topic_len > 0;
+    }
+    if (alias == 0 || alias > MQTT_BROKER_MAX_TOPIC_ALIASES) {
+        return false;
+    }
+    char *entry = client->aliases[alias - 1];
+    if (*topic_len > 0) {
+        if (*topic_len < MQTT_BROKER_MAX_ALIAS_TOPIC_LEN) {
+            memcpy(entry, *topic, *topic_len);
+            entry[*topic_len] = '\0';
+        } else {
+            entry[0] = '\0';
+        }
+        return true;
+    }
+    if (entry[0] == '\0') {
+        return false; // Alias used before being set
+    }
+    *topic = entry;
+    *topic_len = strlen(entry);
+    broker->stats.alias_hits++;
+    return true;
+}
+
+static bool handle_publish(mqtt_broker_t *broker, mqtt_broker_client_t *client, uint8_t flags,
+                           uint8_t *body, size_t len) {
+    uint8_t qos = (flags >> 1) & 0x03;
+    if (len < 2 || qos > 1) {
+        return false; // QoS 2 is not supported
+    }
+    bool v5 = client->protocol_level == MQTT_LEVEL_5;
+    size_t topic_len = get_u16(body);
+    size_t offset = 2 + topic_len;
+    if (offset + (qos ? 2 : 0) > len || (topic_len == 0 && !v5)) {
+        return false;
+    }
+    const char *topic = (const char *)body + 2;
+    uint16_t packet_id = 0;
+    if (qos) {
+        packet_id = get_u16(body + offset);
+        offset += 2;
+    }
+    mqtt_broker_message_t msg = { .qos = qos };
+    if (v5) {
+        uint8_t *props;
+        size_t props_len;
+        if (!take_properties(body, len, &offset, &props, &props_len) ||
+            !resolve_topic_alias(broker, client, &topic, &topic_len, props, &props_len)) {
+            return false;
+        }
+        msg.props = props;
+        msg.props_len = props_len;
+        broker->stats.publishes_in_v5++;
+    }
+    msg.topic = topic;
+    msg.topic_len = topic_len;
+    msg.payload = body + offset;
+    msg.payload_len = len - offset;
+    broker->stats.publishes_in++;
+
+    if (broker->cfg.on_publish) {
+        broker->cfg.on_publish(&msg, broker->cfg.ctx);
+    }
+    deliver(broker, client, &msg);
+
+    if (qos) {
+        // Same 2-byte form for both levels: MQTT 5 omits the reason code when it is "success"
+        uint8_t puback[4] = { PKT_PUBACK << 4, 2, (uint8_t)(packet_id >> 8), (uint8_t)packet_id };
+        return client->sock >= 0 && send_packet(broker, client, puback, sizeof(puback));
+    }
+    return true;
+}
+
+static bool handle_subscribe(mqtt_broker_t *broker, mqtt_broker_client_t *client, uint8_t *body, size_t len,
+                             bool subscribe) {
+    if (len < 2) {
+        return false;
+    }
+    bool v5 = client->protocol_level == MQTT_LEVEL_5;
+    uint8_t ack[5 + MQTT_BROKER_MAX_SUBS * 2];
+    size_t ack_len = 4; // header, length, packet id
+    ack[2] = body[0];
+    ack[3] = body[1];
+    size_t offset = 2;
+    if (v5) {
+        uint8_t *props;
+        size_t props_len;
+        if (!take_properties(body, len, &offset, &props, &props_len)) {
+            return false;
+        }
+        ack[ack_len++] = 0; // No properties in SUBACK/UNSUBACK
+    }
+    while (offset + 2 <= len) {
+        size_t filter_len = get_u16(body + offset);
+        offset += 2;
+        if (offset + filter_len + (subscribe ? 1 : 0) > len) {
+            return false;
+        }
+        const char *filter = (const char *)body + offset;
+        offset += filter_len + (subscribe ? 1 : 0); // Requested QoS / MQTT 5 options are ignored: deliveries are QoS 0
+
+        int slot = -1;
+        for (int s = 0; s < MQTT_BROKER_MAX_SUBS; s++) {
+            if (strlen(client->filters[s]) == filter_len && memcmp(client->filters[s], filter, filter_len) == 0) {
+                slot = s; // Already subscribed (or unsubscribing this one)
+                break;
+            }
+        }
+        uint8_t reason;
+        if (!subscribe) {
+            if (slot >= 0) {
+                client->filters[slot][0] = '\0';
+            }
+            reason = slot >= 0 ? REASON_SUCCESS : REASON_NO_SUBSCRIPTION;
+        } else {
+            if (slot < 0) {
+                for (int s = 0; s < MQTT_BROKER_MAX_SUBS; s++) {
+                    if (client->filters[s][0] == '\0') {
+                        slot = s;
+                        break;
+                    }
+                }
+            }
+            reason = REASON_UNSPECIFIED_ERROR; // Failure (0x80 in both versions): no slot or filter too long
+            if (slot >= 0 && filter_len > 0 && filter_len < MQTT_BROKER_MAX_FILTER_LEN) {
+                memcpy(client->filters[slot], filter, filter_len);
+                client->filters[slot][filter_len] = '\0';
+                reason = 0; // Granted QoS 0
+            }
+        }
+        // UNSUBACK carries reason codes only in MQTT 5
+        if ((subscribe || v5) && ack_len < sizeof(ack)) {
+            ack[ack_len++] = reason;
+        }
+    }
+    ack[0] = (uint8_t)((subscribe ? PKT_SUBACK : PKT_UNSUBACK) << 4);
+    ack[1] = (uint8_t)(ack_len - 2);
+    return send_packet(broker, client, ack, ack_len);
+}
+
+// Processes one complete packet. Returns false if the client must be closed.
+static bool handle_packet(mqtt_broker_t *broker, mqtt_broker_client_t *client, uint8_t header,
+                          uint8_t *body, size_t len) {
+    uint8_t type = header >> 4;
+    if (!client->connected && type != PKT_CONNECT) {
+        return false;
+    }
+    switch (type) {
+    case PKT_CONNECT:
+        return !client->connected && handle_connect(broker, client, body, len);
+    case PKT_PUBLISH:
+        return handle_publish(broker, client, header & 0x0F, body, len);
+    case PKT_PUBACK:
+        return true; // Deliveries are QoS 0, nothing to acknowledge
+    case PKT_SUBSCRIBE:
+        return handle_subscribe(broker, client, body, len, true);
+    case PKT_UNSUBSCRIBE:
+        return handle_subscribe(broker, client, body, len, false);
+    case PKT_PINGREQ: {
+        uint8_t pingresp[2] = { PKT_PINGRESP << 4, 0 };
+        return send_packet(broker, client, pingresp, sizeof(pingresp));
+    }
+    case PKT_DISCONNECT:
+    default:
+        return false;
+    }
+}
+
+static int read_client(mqtt_broker_t *broker, mqtt_broker_client_t *client, uint32_t now_ms) {
+    int r = recv(client->sock, client->rx + client->rx_len, sizeof(client->rx) - client->rx_len, 0);
+    if (r <= 0) {
+        close_client(broker, client);
+        return 0;
+    }
+    client->rx_len += (size_t)r;
+    client->last_rx_ms = now_ms;
+
+    int processed = 0;
+    size_t consumed = 0;
+    while (client->sock >= 0) {
+        size_t header_len;
+        uint32_t remaining;
+        int status = decode_fixed_header(client->rx + consumed, client->rx_len - consumed, &header_len, &remaining);
+        if (status < 0 || (status > 0 && header_len + remaining > sizeof(client->rx))) {
+            broker->stats.protocol_errors++; // Malformed or larger than we accept
+            close_client(broker, client);
+            return processed;
+        }
+        if (status == 0 || client->rx_len - consumed < header_len + remaining) {
+            break;
+        }
+        uint8_t *packet = client->rx + consumed;
+        bool keep = handle_packet(broker, client, packet[0], packet + header_len, remaining);
+        processed++;
+        if (!keep) {
+            if (client->sock >= 0 && (packet[0] >> 4) != PKT_DISCONNECT) {
+                broker->stats.protocol_errors++;
+            }
+            close_client(broker, client);
+            return processed;
+        }
+        consumed += header_len + remaining;
+    }
+    if (client->sock >= 0 && consumed > 0) {
+        memmove(client->rx, client->rx + consumed, client->rx_len - consumed);
+        client->rx_len -= consumed;
+    }
+    return processed;
+}
+
+static void accept_client(mqtt_broker_t *broker, uint32_t now_ms) {
+    int sock = accept(broker->listen_sock, NULL, NULL);
+    if (sock < 0) {
+        return;
+    }
+    mqtt_broker_client_t *slot = NULL;
+    for (int i = 0; i < broker->cfg.max_clients; i++) {
+        if (broker->clients[i].sock < 0) {
+            slot = &broker->clients[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        // Full: answer CONNACK "server unavailable" would need the CONNECT first; just close.
+        broker->stats.connections_rejected++;
+        close(sock);
+        return;
+    }
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval tv = { .tv_sec = 0, .tv_usec = MQTT_BROKER_SEND_TIMEOUT_MS * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    memset(slot, 0, sizeof(*slot));
+    slot->sock = sock;
+    slot->last_rx_ms = now_ms;
+    broker->stats.active_clients++;
+}
+
+int mqtt_broker_start(mqtt_broker_t *broker, const mqtt_broker_config_t *cfg) {
+    memset(broker, 0, sizeof(*broker));
+    broker->cfg = *cfg;
+    if (broker->cfg.max_clients == 0 || broker->cfg.max_clients > MQTT_BROKER_MAX_CLIENTS) {
+        broker->cfg.max_clients = MQTT_BROKER_MAX_CLIENTS;
+    }
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+        broker->clients[i].sock = -1;
+    }
+
+    broker->listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (broker->listen_sock < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(broker->listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(cfg->port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(broker->listen_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(broker->listen_sock, 4) < 0) {
+        int saved = errno;
+        close(broker->listen_sock);
+        broker->listen_sock = -1;
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+int mqtt_broker_poll(mqtt_broker_t *broker, uint32_t timeout_ms, uint32_t now_ms) {
+    if (broker->listen_sock < 0) {
+        return -1;
+    }
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(broker->listen_sock, &readable);
+    int max_fd = broker->listen_sock;
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+        int sock = broker->clients[i].sock;
+        if (sock >= 0) {
+            FD_SET(sock, &readable);
+            if (sock > max_fd) {
+                max_fd = sock;
+            }
+        }
+    }
+
+    struct timeval tv = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+    int ready = select(max_fd + 1, &readable, NULL, NULL, &tv);
+    if (ready < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int processed = 0;
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS && ready > 0; i++) {
+        mqtt_broker_client_t *client = &broker->clients[i];
+        if (client->sock >= 0 && FD_ISSET(client->sock, &readable)) {
+            processed += read_client(broker, client, now_ms);
+        }
+    }
+    if (ready > 0 && FD_ISSET(broker->listen_sock, &readable)) {
+        accept_client(broker, now_ms);
+    }
+
+    // Keep-alive: the spec allows 1.5x the negotiated interval; silent CONNECT-less sockets get a fixed timeout
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+        mqtt_broker_client_t *client = &broker->clients[i];
+        if (client->sock < 0) {
+            continue;
+        }
+        uint32_t limit_ms = client->connected ? client->keepalive_s * 1500u : MQTT_BROKER_CONNECT_TIMEOUT_MS;
+        if (limit_ms > 0 && now_ms - client->last_rx_ms > limit_ms) {
+            close_client(broker, client);
+        }
+    }
+    return processed;
+}
+
+int mqtt_broker_publish(mqtt_broker_t *broker, const char *topic, const void *payload, size_t len) {
+    mqtt_broker_message_t msg = {
+        .topic = topic,
+        .topic_len = strlen(topic),
+        .payload = (const uint8_t *)payload,
+        .payload_len = len,
+    };
+    return deliver(broker, NULL, &msg);
+}
+
+void mqtt_broker_stop(mqtt_broker_t *broker) {
+    for (int i = 0; i < MQTT_BROKER_MAX_CLIENTS; i++) {
+        if (broker->clients[i].sock >= 0) {
+            close_client(broker, &broker->clients[i]);
+        }
+    }
+    if (broker->listen_sock >= 0) {
+        close(broker->listen_sock);
+        broker->listen_sock = -1;
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef MQTT_BROKER_H
+#define MQTT_BROKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal in-process MQTT 3.1.1 / 5.0 broker for the master.
+//
+// Lets slaves connect to the master directly when the home has no server to run
+// a broker. Supported: CONNECT/CONNACK, PUBLISH QoS 0/1 (PUBACK), SUBSCRIBE and
+// UNSUBSCRIBE with '+'/'#' wildcards, PINGREQ, DISCONNECT, keep-alive timeout.
+// Not supported: retained messages, wills, QoS 2, persistent sessions (clean
+// session only), authentication. Forwarding to subscribers is QoS 0.
+//
+// MQTT 5 clients (protocol level 5) may use up to MQTT_BROKER_MAX_TOPIC_ALIASES
+// inbound topic aliases, announced in CONNACK. PUBLISH properties other than
+// the topic alias (user properties, content type...) are forwarded unchanged to
+// MQTT 5 subscribers and dropped for 3.1.1 ones. The broker never assigns
+// aliases on outbound deliveries.
+//
+// Every PUBLISH received is first handed to the `on_publish` callback, so the
+// master consumes radar data in-process without a loopback MQTT client.
+//
+// Single threaded: mqtt_broker_poll() and mqtt_broker_publish() must be called
+// from the same task. Plain C + POSIX sockets (lwIP on target, host for benchmarks).
+
+#ifndef MQTT_BROKER_MAX_CLIENTS
+#define MQTT_BROKER_MAX_CLIENTS 8    // lwIP default is 10 sockets in total (CONFIG_LWIP_MAX_SOCKETS)
+#endif
+#define MQTT_BROKER_MAX_SUBS         4    // Topic filters per client
+#define MQTT_BROKER_MAX_FILTER_LEN   48
+#define MQTT_BROKER_MAX_TOPIC_ALIASES 4   // Per MQTT 5 client (one data topic per slave in practice)
+#define MQTT_BROKER_MAX_ALIAS_TOPIC_LEN 48
+#define MQTT_BROKER_CLIENT_ID_LEN    32
+#define MQTT_BROKER_RX_BUF_SIZE      768  // Largest accepted packet (radar JSON is ~110 bytes)
+#define MQTT_BROKER_CONNECT_TIMEOUT_MS 5000
+#define MQTT_BROKER_SEND_TIMEOUT_MS  200  // A subscriber slower than this is disconnected
+
+typedef struct {
+    const char *topic;       // Alias already resolved; not NUL terminated
+    size_t topic_len;
+    const uint8_t *payload;
+    size_t payload_len;
+    const uint8_t *props;    // MQTT 5 properties without the topic alias (see mqtt5_props.h); NULL for 3.1.1
+    size_t props_len;
+    uint8_t qos;
+} mqtt_broker_message_t;
+
+typedef void (*mqtt_broker_publish_cb_t)(const mqtt_broker_message_t *msg, void *ctx);
+
+typedef struct {
+    uint16_t port;
+    uint8_t max_clients;               // <= MQTT_BROKER_MAX_CLIENTS
+    mqtt_broker_publish_cb_t on_publish; // Optional
+    void *ctx;
+} mqtt_broker_config_t;
+
+typedef struct {
+    int sock;                 // -1 when the slot is free
+    bool connected;           // CONNECT accepted
+    uint8_t protocol_level;   // 4 (3.1.1) or 5
+    uint16_t keepalive_s;
+    uint32_t last_rx_ms;
+    char client_id[MQTT_BROKER_CLIENT_ID_LEN];
+    char filters[MQTT_BROKER_MAX_SUBS][MQTT_BROKER_MAX_FILTER_LEN]; // Empty string = unused
+    char aliases[MQTT_BROKER_MAX_TOPIC_ALIASES][MQTT_BROKER_MAX_ALIAS_TOPIC_LEN]; // Index = alias - 1
+    size_t rx_len;
+    uint8_t rx[MQTT_BROKER_RX_BUF_SIZE];
+} mqtt_broker_client_t;
+
+typedef struct {
+    uint32_t connections_accepted;
+    uint32_t connections_rejected; // No free slot or CONNACK refused
+    uint32_t disconnects;          // Clean, timeout, error or slow consumer
+    uint32_t publishes_in;
+    uint32_t publishes_out;        // Deliveries to subscribers
+    uint32_t deliveries_dropped;   // Subscriber disconnected while sending
+    uint32_t protocol_errors;
+    uint32_t publishes_in_v5;      // Subset of publishes_in sent by MQTT 5 clients
+    uint32_t alias_hits;           // PUBLISH received with an empty topic + known alias
+    uint8_t active_clients;
+} mqtt_broker_stats_t;
+
+typedef struct {
+    mqtt_broker_config_t cfg;
+    int listen_sock;
+    mqtt_broker_client_t clients[MQTT_BROKER_MAX_CLIENTS];
+    mqtt_broker_stats_t stats;
+} mqtt_broker_t;
+
+// Binds and listens on cfg->port. Returns 0, or -1 with errno set.
+int mqtt_broker_start(mqtt_broker_t *broker, const mqtt_broker_config_t *cfg);
+
+// Waits up to timeout_ms for socket activity and processes it (accept, packets,
+// keep-alive). Returns the number of packets processed, or -1 on a fatal error.
+int mqtt_broker_poll(mqtt_broker_t *broker, uint32_t timeout_ms, uint32_t now_ms);
+
+// Publishes a broker-originated message (QoS 0) to matching subscribers.
+// Returns the number of deliveries.
+int mqtt_broker_publish(mqtt_broker_t *broker, const char *topic, const void *payload, size_t len);
+
+void mqtt_broker_stop(mqtt_broker_t *broker);
+
+// MQTT topic filter matching ('+' single level, '#' multi level, last position only).
+bool mqtt_topic_matches(const char *filter, const char *topic, size_t topic_len);
+
+#endif // MQTT_BROKER_H
@@ -0,0 +1,50 @@
+#include <string.h>
+#include "msg_bus.h"
+
+void msg_bus_init(msg_bus_t *bus, msg_pool_t *pool) {
+    memset(bus, 0, sizeof(*bus));
+    bus->pool = pool;
+}
+
+int msg_bus_subscribe(msg_bus_t *bus, spsc_ring_t *ring, msg_bus_wake_fn wake, void *ctx) {
+    if (bus->subscriber_count >= MSG_BUS_MAX_SUBSCRIBERS || ring == NULL || ring->item_size != sizeof(void *)) {
+        return -1;
+    }
+    msg_bus_subscriber_t *sub = &bus->subscribers[bus->subscriber_count];
+    sub->ring = ring;
+    sub->wake = wake;
+    sub->ctx = ctx;
+    return (int)bus->subscriber_count++;
+}
+
+uint32_t msg_bus_publish(msg_bus_t *bus, void *msg) {
+    uint32_t count = bus->subscriber_count;
+    bus->published++;
+    if (count == 0) {
+        bus->unread++;
+        msg_pool_release(bus->pool, msg);
+        return 0;
+    }
+    // One reference per subscriber, the caller's passed to the first, taken
+    // in one add before any push: a subscriber may release its reference as
+    // soon as the pointer is in its ring
+    if (count > 1) {
+        msg_pool_retain(bus->pool, msg, count - 1);
+    }
+    uint32_t delivered = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        msg_bus_subscriber_t *sub = &bus->subscribers[i];
+        if (!spsc_ring_push(sub->ring, &msg)) {
+            msg_pool_release(bus->pool, msg);
+            continue;
+        }
+        delivered++;
+        if (sub->wake != NULL && spsc_ring_take_sleeper(sub->ring)) {
+            sub->wake(sub->ctx);
+        }
+    }
+    if (delivered == 0) {
+        bus->unread++;
+    }
+    return delivered;
+}
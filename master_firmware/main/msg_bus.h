@@ -0,0 +1,51 @@
+#ifndef MSG_BUS_H
+#define MSG_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "msg_pool.h"
+#include "spsc_ring.h"
+
+// Fan-out of pooled messages to several consumers.
+//
+// One producer publishes blocks from a msg_pool_t; each subscriber owns an
+// spsc_ring_t of pointers (item_size sizeof(void *)) and receives the same
+// block with a reference of its own, so the payload is copied once however
+// many consumers read it. A subscriber pops pointers, reads the blocks and
+// releases each one (msg_pool_release) when done; it may keep a block longer
+// (last value seen) as long as it releases it later.
+//
+// Subscribe before the first publish. Publishing is single-producer like the
+// rings it feeds: a stream with several producers uses one bus per producer.
+// A full subscriber ring loses that message (counted by the ring) without
+// holding up the others.
+
+#define MSG_BUS_MAX_SUBSCRIBERS 4
+
+// Called after a push found the subscriber parked (spsc_ring_park)
+typedef void (*msg_bus_wake_fn)(void *ctx);
+
+typedef struct {
+    spsc_ring_t *ring;
+    msg_bus_wake_fn wake;   // May be NULL: the subscriber polls
+    void *ctx;
+} msg_bus_subscriber_t;
+
+typedef struct {
+    msg_pool_t *pool;
+    msg_bus_subscriber_t subscribers[MSG_BUS_MAX_SUBSCRIBERS];
+    uint32_t subscriber_count;
+    uint32_t published;
+    uint32_t unread;        // Published messages no subscriber could take
+} msg_bus_t;
+
+void msg_bus_init(msg_bus_t *bus, msg_pool_t *pool);
+
+// Index of the new subscriber, or -1 (bus full, ring not of pointers)
+int msg_bus_subscribe(msg_bus_t *bus, spsc_ring_t *ring, msg_bus_wake_fn wake, void *ctx);
+
+// Hands `msg` (a block of the bus pool) to every subscriber and consumes the
+// caller's reference. Returns the number of subscribers that got it.
+uint32_t msg_bus_publish(msg_bus_t *bus, void *msg);
+
+#endif // MSG_BUS_H
@@ -0,0 +1,109 @@
+#include <string.h>
+#include "msg_pool.h"
+
+#define NONE 0xFFFFu // Free-list end
+
+typedef struct {
+    atomic_uint refs;
+    atomic_uint next; // Next free block while free
+} block_header_t;
+
+_Static_assert(sizeof(block_header_t) == MSG_POOL_HEADER_LEN, "msg_pool header size");
+
+static block_header_t *header_at(const msg_pool_t *pool, uint32_t index) {
+    return (block_header_t *)(pool->storage + (size_t)index * pool->stride);
+}
+
+static block_header_t *header_of(const void *block) {
+    return (block_header_t *)((uint8_t *)block - MSG_POOL_HEADER_LEN);
+}
+
+static uint32_t index_of(const msg_pool_t *pool, const void *block) {
+    return (uint32_t)(((const uint8_t *)block - MSG_POOL_HEADER_LEN - pool->storage) / pool->stride);
+}
+
+static void push_free(msg_pool_t *pool, uint32_t index) {
+    uint32_t old = atomic_load_explicit(&pool->free_head, memory_order_relaxed);
+    uint32_t head;
+    do {
+        atomic_store_explicit(&header_at(pool, index)->next, old & 0xFFFFu, memory_order_relaxed);
+        head = (((old >> 16) + 1) << 16) | index;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->free_head, &old, head, memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+bool msg_pool_init(msg_pool_t *pool, void *storage, size_t storage_len, size_t block_size, uint32_t count) {
+    memset(pool, 0, sizeof(*pool));
+    if (storage == NULL || ((uintptr_t)storage & 7u) != 0 || block_size == 0 || block_size > UINT16_MAX ||
+        count == 0 || count > MSG_POOL_MAX_BLOCKS || storage_len < MSG_POOL_STORAGE_LEN(block_size, count)) {
+        return false;
+    }
+    pool->storage = (uint8_t *)storage;
+    pool->block_size = (uint32_t)block_size;
+    pool->stride = (uint32_t)MSG_POOL_STRIDE(block_size);
+    pool->count = count;
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->peak, 0);
+    atomic_init(&pool->exhausted, 0);
+    // Chain the blocks in order: block 0 is handed out first
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&header_at(pool, i)->refs, 0);
+        atomic_init(&header_at(pool, i)->next, i + 1 < count ? i + 1 : NONE);
+    }
+    atomic_init(&pool->free_head, 0);
+    return true;
+}
+
+void *msg_pool_alloc(msg_pool_t *pool) {
+    uint32_t old = atomic_load_explicit(&pool->free_head, memory_order_acquire);
+    uint32_t index;
+    for (;;) {
+        index = old & 0xFFFFu;
+        if (index == NONE) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        // May read a link another task is rewriting: the tag then fails the exchange
+        uint32_t next = atomic_load_explicit(&header_at(pool, index)->next, memory_order_relaxed);
+        uint32_t head = (((old >> 16) + 1) << 16) | next;
+        if (atomic_compare_exchange_weak_explicit(&pool->free_head, &old, head, memory_order_acquire,
+                                                  memory_order_acquire)) {
+            break;
+        }
+    }
+    block_header_t *header = header_at(pool, index);
+    atomic_store_explicit(&header->refs, 1, memory_order_relaxed);
+    uint32_t in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    uint32_t peak = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->peak, &peak, in_use, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+    return (uint8_t *)header + MSG_POOL_HEADER_LEN;
+}
+
+void msg_pool_retain(msg_pool_t *pool, void *block, uint32_t count) {
+    (void)pool;
+    atomic_fetch_add_explicit(&header_of(block)->refs, count, memory_order_relaxed);
+}
+
+void msg_pool_release(msg_pool_t *pool, void *block) {
+    // Release: this holder's reads of the block happen before its reuse
+    if (atomic_fetch_sub_explicit(&header_of(block)->refs, 1, memory_order_acq_rel) == 1) {
+        atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+        push_free(pool, index_of(pool, block));
+    }
+}
+
+uint32_t msg_pool_refs(const msg_pool_t *pool, const void *block) {
+    (void)pool;
+    return atomic_load_explicit(&header_of(block)->refs, memory_order_relaxed);
+}
+
+void msg_pool_get_stats(const msg_pool_t *pool, msg_pool_stats_t *stats) {
+    stats->count = pool->count;
+    stats->block_size = pool->block_size;
+    stats->in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->peak = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    stats->exhausted = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+}
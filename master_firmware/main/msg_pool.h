@@ -0,0 +1,69 @@
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pool of fixed-size, reference-counted message blocks.
+//
+// The blocks live in a static array given by the caller; nothing is taken
+// from the heap after boot, so a pool cannot fragment memory or fail because
+// another task did. msg_pool_alloc() returns a block holding one reference;
+// every further holder gets its own from msg_pool_retain(), and each
+// reference is dropped with msg_pool_release(). The last release puts the
+// block back.
+//
+// Any task may allocate, retain and release: the free list is a lock-free
+// stack (compare-and-swap on a head word carrying a 16-bit tag against ABA)
+// and the reference counts are atomic. A task would have to sleep between
+// two reads of the head while 65536 other operations hit the same pool for
+// the tag to wrap.
+
+#define MSG_POOL_HEADER_LEN 8          // Reference count and free-list link, before each block
+#define MSG_POOL_MAX_BLOCKS 0xFFFEu
+
+// Bytes of storage for `count` blocks of `block_size` bytes
+#define MSG_POOL_STRIDE(block_size)          ((MSG_POOL_HEADER_LEN + (size_t)(block_size) + 7u) & ~(size_t)7u)
+#define MSG_POOL_STORAGE_LEN(block_size, count) (MSG_POOL_STRIDE(block_size) * (size_t)(count))
+
+typedef struct {
+    uint8_t *storage;        // 8-byte aligned
+    uint32_t block_size;
+    uint32_t stride;
+    uint32_t count;
+    atomic_uint free_head;   // Tag << 16 | index of the first free block
+    atomic_uint in_use;
+    atomic_uint peak;        // Most blocks in use at once
+    atomic_uint exhausted;   // Allocations refused, pool empty
+} msg_pool_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t block_size;
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t exhausted;
+} msg_pool_stats_t;
+
+// `storage` is 8-byte aligned and holds MSG_POOL_STORAGE_LEN(block_size,
+// count) bytes. False on a bad argument.
+bool msg_pool_init(msg_pool_t *pool, void *storage, size_t storage_len, size_t block_size, uint32_t count);
+
+// A block of block_size bytes (contents undefined) holding one reference,
+// or NULL when every block is in use (counted).
+void *msg_pool_alloc(msg_pool_t *pool);
+
+// Adds `count` references to a block the caller holds one on
+void msg_pool_retain(msg_pool_t *pool, void *block, uint32_t count);
+
+// Drops a reference; the last one returns the block to the pool.
+void msg_pool_release(msg_pool_t *pool, void *block);
+
+// References held on `block` (tests, debugging: stale as soon as read)
+uint32_t msg_pool_refs(const msg_pool_t *pool, const void *block);
+
+void msg_pool_get_stats(const msg_pool_t *pool, msg_pool_stats_t *stats);
+
+#endif // MSG_POOL_H
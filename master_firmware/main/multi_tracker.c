@@ -0,0 +1,292 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "multi_tracker.h"
+
+_Static_assert(MTT_RANGES_PER_SENSOR == 2, "associate_sensor() enumerates two ranges");
+
+#define NO_TRACK (-1)
+
+void mtt_room_init(mtt_room_t *room, float accel_sigma) {
+    memset(room, 0, sizeof(*room));
+    room->accel_sigma = accel_sigma > 0.0f ? accel_sigma : KALMAN_DEFAULT_ACCEL_SIGMA;
+    room->next_id = 1;
+}
+
+void mtt_scan_init(mtt_scan_t *scan) {
+    memset(scan, 0, sizeof(*scan));
+}
+
+static void scan_put(mtt_scan_t *scan, int slot, int index, uint16_t mm, uint8_t kind) {
+    scan->range_m[slot][index] = mm / 1000.0f;
+    scan->kind[slot][index] = kind;
+    scan->mask |= (uint8_t)(1u << slot);
+}
+
+void mtt_scan_add(mtt_scan_t *scan, int slot, uint16_t distance_mm, uint16_t moving_mm, uint16_t static_mm,
+                  radar_posture_t posture, uint8_t signal) {
+    if (slot < 0 || slot >= TRILAT_MAX_SENSORS) {
+        return;
+    }
+    scan->posture[slot] = (uint8_t)posture;
+    scan->signal[slot] = signal;
+    scan->posture_range[slot] = 0;
+    if (moving_mm == 0 && static_mm == 0) {
+        if (distance_mm != 0) {
+            scan_put(scan, slot, 0, distance_mm, MTT_TARGET_MOVING | MTT_TARGET_STATIC);
+        }
+        return;
+    }
+    int diff = (int)moving_mm - (int)static_mm;
+    if (moving_mm != 0 && static_mm != 0 && diff < MTT_SAME_TARGET_MM && diff > -MTT_SAME_TARGET_MM) {
+        scan_put(scan, slot, 0, (uint16_t)((moving_mm + static_mm) / 2), MTT_TARGET_MOVING | MTT_TARGET_STATIC);
+        return;
+    }
+    int n = 0;
+    if (moving_mm != 0) {
+        scan_put(scan, slot, n++, moving_mm, MTT_TARGET_MOVING);
+    }
+    if (static_mm != 0) {
+        scan_put(scan, slot, n++, static_mm, MTT_TARGET_STATIC);
+    }
+    // The posture describes the main target, at the detection distance
+    if (n == 2 && abs((int)static_mm - (int)distance_mm) < abs((int)moving_mm - (int)distance_mm)) {
+        scan->posture_range[slot] = 1;
+    }
+}
+
+static void free_track(mtt_room_t *room, mtt_track_t *t) {
+    if (t->confirmed) {
+        room->deaths++;
+    } else {
+        room->ghosts++;
+    }
+    t->id = 0;
+}
+
+// Normalised squared range residual of range `r` for track `t` seen from sensor `k`.
+static float range_cost(const trilat_geometry_t *g, const mtt_track_t *t, int k, float r) {
+    float dx = t->kf.s[0] - g->pos[k].x, dy = t->kf.s[1] - g->pos[k].y;
+    float predicted = sqrtf(dx * dx + dy * dy);
+    float var = g->range_sigma_m * g->range_sigma_m;
+    if (predicted > 1e-3f) { // h^T P h, h = unit line of sight
+        float hx = dx / predicted, hy = dy / predicted;
+        var += hx * hx * t->kf.P[0][0] + 2.0f * hx * hy * t->kf.P[0][1] + hy * hy * t->kf.P[1][1];
+    } else {
+        var += t->kf.P[0][0] + t->kf.P[1][1];
+    }
+    float e = r - predicted;
+    float d2 = e * e / var;
+    if (d2 > MTT_RANGE_GATE_CHI2) {
+        return INFINITY;
+    }
+    return t->confirmed ? d2 : d2 + MTT_TENTATIVE_COST;
+}
+
+// Cheapest assignment of the ranges of sensor `k` to distinct tracks.
+// An unassigned range costs the gate. owner[r] = track index or NO_TRACK.
+static void associate_sensor(const mtt_room_t *room, const trilat_geometry_t *g, const mtt_scan_t *scan, int k,
+                             int8_t owner[MTT_RANGES_PER_SENSOR]) {
+    float cost[MTT_RANGES_PER_SENSOR][MTT_MAX_TRACKS];
+    for (int r = 0; r < MTT_RANGES_PER_SENSOR; r++) {
+        owner[r] = NO_TRACK;
+        for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+            const mtt_track_t *t = &room->tracks[i];
+            cost[r][i] = (t->id != 0 && scan->kind[k][r] != 0) ? range_cost(g, t, k, scan->range_m[k][r]) : INFINITY;
+        }
+    }
+    float unassigned[MTT_RANGES_PER_SENSOR];
+    for (int r = 0; r < MTT_RANGES_PER_SENSOR; r++) {
+        unassigned[r] = scan->kind[k][r] != 0 ? MTT_RANGE_GATE_CHI2 : 0.0f;
+    }
+
+    float best = unassigned[0] + unassigned[1];
+    for (int a = NO_TRACK; a < MTT_MAX_TRACKS; a++) {
+        float ca = a == NO_TRACK ? unassigned[0] : cost[0][a];
+        if (ca == INFINITY) {
+            continue;
+        }
+        for (int b = NO_TRACK; b < MTT_MAX_TRACKS; b++) {
+            if (b != NO_TRACK && b == a) {
+                continue;
+            }
+            float total = ca + (b == NO_TRACK ? unassigned[1] : cost[1][b]);
+            if (total < best) {
+                best = total;
+                owner[0] = (int8_t)a;
+                owner[1] = (int8_t)b;
+            }
+        }
+    }
+}
+
+static int free_slot(const mtt_room_t *room) {
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        if (room->tracks[i].id == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool near_track(const mtt_room_t *room, float x, float y) {
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        const mtt_track_t *t = &room->tracks[i];
+        if (t->id != 0 && hypotf(t->kf.s[0] - x, t->kf.s[1] - y) < MTT_MIN_SEPARATION_M) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Votes of the sensors whose main target went to track `index`; the posture
+// filter keeps its state if there are none.
+static void update_posture(mtt_track_t *t, int index, const mtt_scan_t *scan,
+                           int8_t owner[TRILAT_MAX_SENSORS][MTT_RANGES_PER_SENSOR]) {
+    posture_votes_t votes;
+    posture_votes_init(&votes);
+    for (uint8_t mask = t->sensors; mask; mask &= (uint8_t)(mask - 1)) {
+        int k = __builtin_ctz(mask);
+        int r = scan->posture_range[k];
+        if (owner[k][r] == index) {
+            uint16_t range_mm = (uint16_t)(scan->range_m[k][r] * 1000.0f);
+            posture_votes_add(&votes, (radar_posture_t)scan->posture[k], posture_vote_weight(scan->signal[k], range_mm));
+        }
+    }
+    t->posture = (uint8_t)posture_hmm_step(&t->posture_hmm, &votes);
+}
+
+// Starts a tentative track on the unassigned ranges of `kind`, if they agree.
+static void try_birth(mtt_room_t *room, trilat_geometry_t *g, uint32_t now_ms, const mtt_scan_t *scan,
+                      uint8_t usable, uint8_t kind, int8_t owner[TRILAT_MAX_SENSORS][MTT_RANGES_PER_SENSOR]) {
+    int index = free_slot(room);
+    if (index < 0) {
+        return;
+    }
+    float ranges[TRILAT_MAX_SENSORS] = { 0 };
+    uint8_t which[TRILAT_MAX_SENSORS] = { 0 };
+    uint8_t mask = 0;
+    for (uint8_t m = usable; m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        for (int r = 0; r < MTT_RANGES_PER_SENSOR; r++) {
+            if (owner[k][r] == NO_TRACK && (scan->kind[k][r] & kind)) {
+                ranges[k] = scan->range_m[k][r];
+                which[k] = (uint8_t)r;
+                mask |= (uint8_t)(1u << k);
+                break;
+            }
+        }
+    }
+    if (__builtin_popcount(mask) < 2) {
+        return;
+    }
+    trilat_result_t res;
+    if (!trilat_solve(g, mask, ranges, NULL, &res) ||
+        (res.flags & (TRILAT_FLAG_NO_INTERSECTION | TRILAT_FLAG_OUTSIDE)) ||
+        (res.used >= 3 && res.residual_rms_m > MTT_BIRTH_MAX_RESIDUAL_M) ||
+        near_track(room, res.p.x, res.p.y)) {
+        return;
+    }
+
+    mtt_track_t *t = &room->tracks[index];
+    memset(t, 0, sizeof(*t));
+    kalman_track_init(&t->kf, room->accel_sigma);
+    kalman_meas_t meas = { res.p.x, res.p.y, res.cov_xx, res.cov_xy, res.cov_yy };
+    t->result = (uint8_t)kalman_track_step(&t->kf, now_ms, &meas);
+    t->id = room->next_id;
+    room->next_id = room->next_id == UINT8_MAX ? 1 : (uint8_t)(room->next_id + 1);
+    t->hits = 1;
+    t->posture = RADAR_POSTURE_UNKNOWN;
+    posture_hmm_init(&t->posture_hmm);
+    t->sensors = mask;
+    for (uint8_t m = mask; m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        owner[k][which[k]] = (int8_t)index; // Not reused by the next kind
+    }
+    update_posture(t, index, scan, owner);
+    room->births++;
+}
+
+int mtt_room_step(mtt_room_t *room, trilat_geometry_t *g, uint32_t now_ms, const mtt_scan_t *scan) {
+    uint8_t usable = scan->mask & g->valid_mask;
+
+    // Prediction to the set time; tracks without a position for too long die
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        mtt_track_t *t = &room->tracks[i];
+        if (t->id == 0) {
+            continue;
+        }
+        t->newly_confirmed = false;
+        t->sensors = 0;
+        t->result = (uint8_t)kalman_track_step(&t->kf, now_ms, NULL);
+        if (t->result == KALMAN_LOST) {
+            free_track(room, t);
+        }
+    }
+
+    // Association, sensor by sensor
+    int8_t owner[TRILAT_MAX_SENSORS][MTT_RANGES_PER_SENSOR];
+    float ranges[MTT_MAX_TRACKS][TRILAT_MAX_SENSORS] = { { 0 } };
+    memset(owner, NO_TRACK, sizeof(owner));
+    for (uint8_t m = usable; m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        associate_sensor(room, g, scan, k, owner[k]);
+        for (int r = 0; r < MTT_RANGES_PER_SENSOR; r++) {
+            if (owner[k][r] != NO_TRACK) {
+                mtt_track_t *t = &room->tracks[owner[k][r]];
+                t->sensors |= (uint8_t)(1u << k);
+                ranges[owner[k][r]][k] = scan->range_m[k][r];
+            }
+        }
+    }
+
+    // Update of every track from its own ranges
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        mtt_track_t *t = &room->tracks[i];
+        if (t->id == 0) {
+            continue;
+        }
+        trilat_point_t hint = { t->kf.s[0], t->kf.s[1] };
+        trilat_result_t res;
+        bool located = __builtin_popcount(t->sensors) >= 2 && trilat_solve(g, t->sensors, ranges[i], &hint, &res);
+        if (located) {
+            kalman_meas_t meas = { res.p.x, res.p.y, res.cov_xx, res.cov_xy, res.cov_yy };
+            t->result = (uint8_t)kalman_track_step(&t->kf, now_ms, &meas);
+        }
+        if (located && t->result != KALMAN_REJECTED) {
+            t->hits = t->hits == UINT8_MAX ? UINT8_MAX : (uint8_t)(t->hits + 1);
+            t->misses = 0;
+        } else {
+            t->misses++;
+        }
+        update_posture(t, i, scan, owner);
+        if (!t->confirmed && t->hits >= MTT_CONFIRM_HITS) {
+            t->confirmed = true;
+            t->newly_confirmed = true;
+        } else if (!t->confirmed && t->misses >= MTT_TENTATIVE_MAX_MISSES) {
+            free_track(room, t);
+        }
+    }
+
+    try_birth(room, g, now_ms, scan, usable, MTT_TARGET_MOVING, owner);
+    try_birth(room, g, now_ms, scan, usable, MTT_TARGET_STATIC, owner);
+
+    // Two tracks on one person: keep the older (more positions), confirmed first
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        for (int j = i + 1; j < MTT_MAX_TRACKS && room->tracks[i].id != 0; j++) {
+            mtt_track_t *a = &room->tracks[i], *b = &room->tracks[j];
+            if (b->id == 0 || hypotf(a->kf.s[0] - b->kf.s[0], a->kf.s[1] - b->kf.s[1]) >= MTT_MIN_SEPARATION_M) {
+                continue;
+            }
+            bool keep_a = a->confirmed != b->confirmed ? a->confirmed : a->hits >= b->hits;
+            (keep_a ? b : a)->id = 0;
+            room->merges++;
+        }
+    }
+
+    int confirmed = 0;
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        confirmed += room->tracks[i].id != 0 && room->tracks[i].confirmed;
+    }
+    return confirmed;
+}
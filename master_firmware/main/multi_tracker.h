@@ -0,0 +1,108 @@
+#ifndef MULTI_TRACKER_H
+#define MULTI_TRACKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radar_posture.h"
+#include "kalman_tracker.h"
+#include "posture_hmm.h"
+#include "trilateration.h"
+
+// Several people in one room, from the LD2410 moving and static targets of
+// every sensor of the room.
+//
+// Each sensor gives up to MTT_RANGES_PER_SENSOR ranges per fused set (its
+// moving and its static target; one range when both are the same person or
+// when the slave only reports the detection distance). Association is done
+// in range space, sensor by sensor:
+//
+// - every track predicts its range to the sensor; a range is a candidate for
+//   the track when its normalised squared residual is below
+//   MTT_RANGE_GATE_CHI2 (the track covariance projected on the line of
+//   sight, plus the range noise);
+// - the ranges of the sensor are assigned to distinct tracks by exhaustive
+//   search of the cheapest assignment (global nearest neighbour), leaving a
+//   range unassigned costs the gate. At most (MTT_MAX_TRACKS + 1)^2 = 25
+//   combinations per sensor, so a set costs O(tracks x sensors) whatever
+//   the geometry;
+// - a track with ranges from 2 sensors or more is trilaterated on them and
+//   updated through its Kalman filter (kalman_tracker.c), otherwise it
+//   predicts.
+//
+// Birth: the ranges left over, moving targets together then static targets
+// together, are trilaterated once per kind and start a tentative track when
+// they are consistent (residual), inside the room and away from the existing
+// tracks. At most 2 solves per set. A tentative track is confirmed after
+// MTT_CONFIRM_HITS positions and dropped after MTT_TENTATIVE_MAX_MISSES sets
+// without one (ghost of a wrong combination). Death: the Kalman coast limit
+// (KALMAN_MAX_COAST_MS). Two tracks closer than MTT_MIN_SEPARATION_M are
+// merged, the younger one is dropped.
+//
+// Each track filters the postures reported by the sensors whose detection
+// distance was associated to it (posture_hmm.c, votes weighted by the
+// signal of the sensor and its range to the track), so the fall detector can
+// follow every person separately.
+//
+// Fixed-size state, no allocation. Plain C, no locking: owned by the
+// FusionEngine task, one mtt_room_t per fusion room.
+
+#define MTT_MAX_TRACKS            4
+#define MTT_RANGES_PER_SENSOR     2      // LD2410: moving and static target
+#define MTT_SAME_TARGET_MM        400    // Moving and static targets closer than this are one person
+#define MTT_RANGE_GATE_CHI2       6.63f  // 99 % of a 1-DOF chi-square
+#define MTT_TENTATIVE_COST        1.0f   // Added to tentative tracks: confirmed ones win the ties
+#define MTT_CONFIRM_HITS          3
+#define MTT_TENTATIVE_MAX_MISSES  2
+#define MTT_MIN_SEPARATION_M      0.4f
+#define MTT_BIRTH_MAX_RESIDUAL_M  0.45f  // 3 x TRILAT_DEFAULT_RANGE_SIGMA_M
+
+#define MTT_TARGET_MOVING 0x01
+#define MTT_TARGET_STATIC 0x02
+
+// Ranges of one fused set, by fusion slot.
+typedef struct {
+    float range_m[TRILAT_MAX_SENSORS][MTT_RANGES_PER_SENSOR];
+    uint8_t kind[TRILAT_MAX_SENSORS][MTT_RANGES_PER_SENSOR]; // MTT_TARGET_* bits, 0 = no range
+    uint8_t posture[TRILAT_MAX_SENSORS];       // radar_posture_t reported by the sensor
+    uint8_t signal[TRILAT_MAX_SENSORS];        // 0..100
+    uint8_t posture_range[TRILAT_MAX_SENSORS]; // Range closest to the detection distance
+    uint8_t mask;                              // Sensors with at least one range
+} mtt_scan_t;
+
+typedef struct {
+    kalman_track_t kf;
+    uint8_t id;              // 1..255, 0 = free
+    bool confirmed;
+    bool newly_confirmed;    // Confirmed by the last step
+    uint8_t hits;            // Accepted positions (saturated)
+    uint8_t misses;          // Sets in a row without an accepted position
+    uint8_t posture;         // radar_posture_t, most likely one (posture_hmm.posture)
+    uint8_t sensors;         // Sensors associated by the last step
+    uint8_t result;          // kalman_result_t of the last step
+    posture_hmm_t posture_hmm;
+} mtt_track_t;
+
+typedef struct {
+    mtt_track_t tracks[MTT_MAX_TRACKS];
+    float accel_sigma;
+    uint8_t next_id;
+    uint32_t births, deaths, ghosts, merges; // Statistics
+} mtt_room_t;
+
+void mtt_room_init(mtt_room_t *room, float accel_sigma);
+
+void mtt_scan_init(mtt_scan_t *scan);
+
+// Adds the reading of sensor `slot`. Targets at 0 are absent; with both
+// absent the detection distance is the only range (slaves without target
+// reports). `signal` weights the posture vote of the sensor.
+void mtt_scan_add(mtt_scan_t *scan, int slot, uint16_t distance_mm, uint16_t moving_mm, uint16_t static_mm,
+                  radar_posture_t posture, uint8_t signal);
+
+// Advances the tracks of `room` to `now_ms` with the ranges of `scan`:
+// association, updates, births, merges and deaths. `g` is the room geometry
+// (sensors without calibration are ignored). Returns the number of confirmed
+// tracks.
+int mtt_room_step(mtt_room_t *room, trilat_geometry_t *g, uint32_t now_ms, const mtt_scan_t *scan);
+
+#endif // MULTI_TRACKER_H
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include "pipeline_msgs.h"
+#include "sensor_health.h"
+
+uint16_t pipeline_distance_mm(float metres) {
+    float mm = metres * 1000.0f + 0.5f;
+    if (!(mm > 0.0f)) { // Also catches NaN
+        return 0;
+    }
+    return mm >= (float)UINT16_MAX ? UINT16_MAX : (uint16_t)mm;
+}
+
+int16_t pipeline_position_mm(float metres) {
+    float mm = metres * 1000.0f;
+    if (mm != mm) {
+        return 0;
+    }
+    if (mm >= (float)INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (mm <= (float)INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)(mm < 0.0f ? mm - 0.5f : mm + 0.5f);
+}
+
+uint8_t pipeline_sigma_cm(float metres) {
+    float cm = metres * 100.0f + 0.5f;
+    if (!(cm > 0.0f)) {
+        return 0;
+    }
+    return cm >= (float)(FUSED_SIGMA_UNKNOWN - 1) ? FUSED_SIGMA_UNKNOWN - 1 : (uint8_t)cm;
+}
+
+int alert_describe(const AlertMessage *alert, char *buf, size_t len) {
+    switch ((AlertType)alert->type) {
+    case ALERT_TYPE_FALL_DETECTED:
+        return snprintf(buf, len, "Chute détectée à %lu (Pos: %.2f,%.2f)%s%s",
+                        (unsigned long)alert->alert_timestamp, alert->x_mm / 1000.0f, alert->y_mm / 1000.0f,
+                        (alert->flags & ALERT_FLAG_DEGRADED) ? " [dégradé]" : "",
+                        (alert->flags & ALERT_FLAG_ESCALATED) ? " [zone à risque]" : "");
+    case ALERT_TYPE_MODULE_OFFLINE:
+        if (alert->flags & ALERT_FLAG_NEVER_REPORTED) {
+            return snprintf(buf, len, "Module %u never reported.", alert->module_id);
+        }
+        return snprintf(buf, len, "Module %u offline. Last seen %u ms ago.",
+                        alert->module_id, (unsigned)alert->silent_ms);
+    case ALERT_TYPE_MODULE_ONLINE:
+        return snprintf(buf, len, "Module %u back online", alert->module_id);
+    case ALERT_TYPE_ROOM_DEGRADED:
+        return snprintf(buf, len, "Pièce %u dégradée: module %u muet depuis %u ms",
+                        alert->room, alert->module_id, (unsigned)alert->silent_ms);
+    case ALERT_TYPE_ROOM_RESTORED:
+        return snprintf(buf, len, "Pièce %u: fusion complète rétablie", alert->room);
+    case ALERT_TYPE_ZONE_ENTER:
+        return snprintf(buf, len, "Pièce %u: entrée dans la zone %u", alert->room, alert->zone);
+    case ALERT_TYPE_ZONE_EXIT:
+        return snprintf(buf, len, "Pièce %u: sortie de la zone %u après %u s", alert->room, alert->zone,
+                        (unsigned)(alert->inside_ms / 1000));
+    case ALERT_TYPE_ZONE_DWELL:
+        return snprintf(buf, len, "Pièce %u: dans la zone %u depuis %u s", alert->room, alert->zone,
+                        (unsigned)(alert->inside_ms / 1000));
+    case ALERT_TYPE_INACTIVITY:
+        return snprintf(buf, len, "Pièce %u: aucun mouvement depuis %u min (niveau %u)", alert->room,
+                        (unsigned)(alert->still_ms / 60000), alert->level);
+    case ALERT_TYPE_INACTIVITY_CLEARED:
+        return snprintf(buf, len, "Pièce %u: mouvement repris après %u min (niveau %u atteint)", alert->room,
+                        (unsigned)(alert->still_ms / 60000), alert->level);
+    case ALERT_TYPE_SENSOR_DEGRADED: {
+        char reasons[48];
+        sensor_health_describe(alert->reasons, reasons, sizeof(reasons));
+        return snprintf(buf, len, "Module %u dégradé: score %u/100 (%s)", alert->module_id, alert->score, reasons);
+    }
+    case ALERT_TYPE_SENSOR_RESTORED:
+        return snprintf(buf, len, "Module %u rétabli: score %u/100", alert->module_id, alert->score);
+    default:
+        return snprintf(buf, len, "Alert type %u", alert->type);
+    }
+}
+
+const char *alert_type_name(AlertType type) {
+    switch (type) {
+    case ALERT_TYPE_FALL_DETECTED:  return "FALL_DETECTED";
+    case ALERT_TYPE_MODULE_OFFLINE: return "MODULE_OFFLINE";
+    case ALERT_TYPE_MODULE_ONLINE:  return "MODULE_ONLINE";
+    case ALERT_TYPE_ROOM_DEGRADED:  return "ROOM_DEGRADED";
+    case ALERT_TYPE_ROOM_RESTORED:  return "ROOM_RESTORED";
+    case ALERT_TYPE_ZONE_ENTER:     return "ZONE_ENTER";
+    case ALERT_TYPE_ZONE_EXIT:      return "ZONE_EXIT";
+    case ALERT_TYPE_ZONE_DWELL:     return "ZONE_DWELL";
+    case ALERT_TYPE_INACTIVITY:     return "INACTIVITY";
+    case ALERT_TYPE_INACTIVITY_CLEARED: return "INACTIVITY_CLEARED";
+    case ALERT_TYPE_SENSOR_DEGRADED: return "SENSOR_DEGRADED";
+    case ALERT_TYPE_SENSOR_RESTORED: return "SENSOR_RESTORED";
+    default:                        return "UNKNOWN";
+    }
+}
+
+int alert_payload(const AlertMessage *alert, uint32_t id, const char *description, char *buf, size_t len) {
+    return snprintf(buf, len, "{\"id\": %lu, \"alert_type\": \"%s\", \"description\": \"%s\", \"timestamp\": %lu}",
+                    (unsigned long)id, alert_type_name((AlertType)alert->type), description,
+                    (unsigned long)alert->alert_timestamp);
+}
@@ -0,0 +1,124 @@
+#ifndef PIPELINE_MSGS_H
+#define PIPELINE_MSGS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "radar_posture.h"
+
+// Items of the master pipeline: radar rings (one per source) -> RadarRouter
+// -> shard rings -> FusionEngine -> fused rings -> FallDetector (one pair per
+// shard) -> alert_queue -> AlertManager.
+//
+// The rings (spsc_ring.h) and the FreeRTOS queue copy every item in and out,
+// so the items hold no strings: postures are radar_posture_t codes, distances and positions are
+// integer millimetres, and alert texts are built by alert_describe() where
+// they leave the master (web page, MQTT). Fields are ordered largest first
+// so that the structs have no internal padding (RadarMessage and FusedData
+// end with 2 bytes of tail padding).
+
+#define RADAR_MSG_HAS_SEQUENCE 0x01 // MQTT 5 slaves: per-module sequence, used to drop QoS 1 redeliveries
+#define RADAR_MSG_HAS_TARGETS  0x02 // moving_mm / static_mm reported (slaves >= 1.2.0); else distance_mm only
+
+typedef struct {
+    uint32_t timestamp;    // Slave clock, ms
+    uint32_t sequence;     // Valid when flags & RADAR_MSG_HAS_SEQUENCE
+    uint16_t distance_mm;  // Detection distance (main target)
+    uint16_t moving_mm;    // LD2410 moving target, 0 = none
+    uint16_t static_mm;    // LD2410 static target, 0 = none
+    uint8_t module_id;
+    uint8_t posture;       // radar_posture_t
+    uint8_t signal;        // 0..100
+    uint8_t flags;
+} RadarMessage;
+
+typedef struct {
+    uint32_t timestamp;    // Reference time of the fused set, master clock, ms
+    int16_t x_mm, y_mm;    // Position of the room track (Kalman filtered)
+    int16_t vx_mm_s, vy_mm_s; // Velocity of the room track
+    uint16_t range_mm;     // Detection distance of the strongest reading of the set
+    uint8_t posture;       // radar_posture_t
+    uint8_t room;          // fusion_engine room index
+    uint8_t sigma_cm;      // Position standard deviation (sqrt of the covariance trace)
+    uint8_t flags;         // FUSED_FLAG_*
+    uint8_t track_id;      // multi_tracker person id, FUSED_TRACK_NONE for a room without track
+    uint8_t occupants;     // Confirmed tracks in the room
+    uint8_t posture_pct[RADAR_POSTURE_COUNT]; // Posture probabilities in percent (posture_hmm.c), by radar_posture_t
+} FusedData;
+
+#define FUSED_SIGMA_UNKNOWN 255 // sigma_cm: no position (no track in the room)
+#define FUSED_TRACK_NONE    0   // track_id: room-level output (posture only)
+
+#define FUSED_FLAG_PREDICTED 0x01 // No position measured in this set: track prediction
+#define FUSED_FLAG_OUTLIER   0x02 // Measured position rejected by the track gate
+#define FUSED_FLAG_NEW_TRACK 0x04 // Track (re)started on this set: velocity unknown
+#define FUSED_FLAG_DEGRADED  0x08 // Room below its quorum (modules absent): fewer sensors, reduced confidence
+
+typedef enum {
+    ALERT_TYPE_FALL_DETECTED,
+    ALERT_TYPE_MODULE_OFFLINE,
+    ALERT_TYPE_MODULE_ONLINE, // Optional: For module online notifications
+    ALERT_TYPE_ROOM_DEGRADED, // A room fuses fewer modules than its quorum
+    ALERT_TYPE_ROOM_RESTORED, // The room is back to its quorum
+    ALERT_TYPE_ZONE_ENTER,    // A person entered a zone of the room (zone_engine.h)
+    ALERT_TYPE_ZONE_EXIT,
+    ALERT_TYPE_ZONE_DWELL,    // A person stayed in a zone for its dwell time
+    ALERT_TYPE_INACTIVITY,    // No significant motion in a room for a graded time (inactivity_monitor.h)
+    ALERT_TYPE_INACTIVITY_CLEARED, // Motion again after an INACTIVITY alert
+    ALERT_TYPE_SENSOR_DEGRADED, // A module keeps sending but its samples look wrong (sensor_health.h)
+    ALERT_TYPE_SENSOR_RESTORED  // Its health score is back above the restore threshold
+} AlertType;
+
+#define ALERT_FLAG_NEVER_REPORTED 0x01 // MODULE_OFFLINE: the module never sent data
+#define ALERT_FLAG_DEGRADED       0x02 // FALL_DETECTED: detected while the room was degraded
+#define ALERT_FLAG_ESCALATED      0x04 // FALL_DETECTED: confirmed early in an escalating zone (`zone`)
+#define ALERT_ZONE_NONE           0xFF
+
+typedef struct {
+    uint32_t alert_timestamp;
+    union {
+        uint32_t silent_ms; // MODULE_OFFLINE, ROOM_DEGRADED: time since the last sample of the module
+        uint32_t inside_ms; // ZONE_EXIT, ZONE_DWELL: time spent in the zone
+        uint32_t still_ms;  // INACTIVITY*: time without significant motion
+        struct {
+            uint8_t score;   // SENSOR_*: health score 0..100
+            uint8_t reasons; // SENSOR_*: SENSOR_HEALTH_* costing points
+        };
+    };
+    int16_t x_mm, y_mm;    // FALL_DETECTED, ZONE_*, INACTIVITY: position of the person
+    uint8_t type;          // AlertType
+    union {
+        uint8_t module_id; // MODULE_OFFLINE / MODULE_ONLINE, ROOM_DEGRADED: absent module; SENSOR_*
+        uint8_t zone;      // ZONE_*, escalated FALL_DETECTED: zone index, ALERT_ZONE_NONE if none
+        uint8_t level;     // INACTIVITY: level raised; INACTIVITY_CLEARED: level reached
+    };
+    uint8_t flags;
+    uint8_t room;          // FALL_DETECTED, ROOM_*, ZONE_*, INACTIVITY*: fusion_engine room index
+} AlertMessage;
+
+_Static_assert(sizeof(RadarMessage) == 20, "RadarMessage layout changed");
+_Static_assert(sizeof(FusedData) == 28, "FusedData layout changed");
+_Static_assert(sizeof(AlertMessage) == 16, "AlertMessage layout changed");
+
+// Metres -> millimetres, rounded and saturated to the field range.
+uint16_t pipeline_distance_mm(float metres);
+int16_t pipeline_position_mm(float metres);
+// Metres -> centimetres for FusedData.sigma_cm, saturated below FUSED_SIGMA_UNKNOWN.
+uint8_t pipeline_sigma_cm(float metres);
+
+// Human readable alert text ("Chute détectée à ...", "Module 2 offline. ...").
+// Returns the snprintf() result.
+int alert_describe(const AlertMessage *alert, char *buf, size_t len);
+
+// "FALL_DETECTED", "MODULE_OFFLINE", ... as published in the MQTT alert payload.
+const char *alert_type_name(AlertType type);
+
+#define ALERT_DESCRIPTION_MAX 96  // alert_describe() text plus a zone name
+#define ALERT_PAYLOAD_MAX     208 // alert_payload() around a description of ALERT_DESCRIPTION_MAX
+
+// MQTT alert payload: {"id": ..., "alert_type": ..., "description": ...,
+// "timestamp": ...}. `id`: alert outbox id (alert_outbox.h), 0 when not
+// tracked. Returns the snprintf() result.
+int alert_payload(const AlertMessage *alert, uint32_t id, const char *description, char *buf, size_t len);
+
+#endif // PIPELINE_MSGS_H
@@ -0,0 +1,45 @@
+#include <string.h>
+#include "pipeline_shard.h"
+
+static int clamp(int v, int low, int high) {
+    return v < low ? low : v > high ? high : v;
+}
+
+void pipeline_shards_init(pipeline_shards_t *ps, int shard_count, int core_count, int network_core, int shard_cores) {
+    memset(ps, 0, sizeof(*ps));
+    ps->shard_count = (uint8_t)clamp(shard_count, 1, PIPELINE_MAX_SHARDS);
+    core_count = clamp(core_count, 1, PIPELINE_MAX_CORES);
+    network_core = clamp(network_core, 0, core_count - 1);
+    shard_cores = clamp(shard_cores, 1, core_count);
+
+    // Cores in placement order: the ones free of the network first
+    uint8_t order[PIPELINE_MAX_CORES];
+    int n = 0;
+    for (int c = 0; c < core_count; c++) {
+        if (c != network_core) {
+            order[n++] = (uint8_t)c;
+        }
+    }
+    order[n] = (uint8_t)network_core;
+    for (int s = 0; s < ps->shard_count; s++) {
+        ps->core[s] = core_count == 1 ? 0 : order[s % shard_cores];
+    }
+}
+
+int pipeline_shard_room_count(const pipeline_shards_t *ps, int shard, int room_count) {
+    if (shard < 0 || shard >= ps->shard_count || room_count <= shard) {
+        return 0;
+    }
+    return (room_count - shard + ps->shard_count - 1) / ps->shard_count;
+}
+
+void pipeline_shard_note(pipeline_shards_t *ps, int shard, bool accepted) {
+    if (shard < 0 || shard >= ps->shard_count) {
+        return;
+    }
+    if (accepted) {
+        ps->routed[shard]++;
+    } else {
+        ps->dropped[shard]++;
+    }
+}
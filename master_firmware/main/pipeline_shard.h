@@ -0,0 +1,53 @@
+#ifndef PIPELINE_SHARD_H
+#define PIPELINE_SHARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Room sharding of the fusion and fall pipeline.
+//
+// The rooms of the fusion engine are split into `shard_count` shards, each
+// served by its own FusionEngine and FallDetector tasks pinned to one core.
+// A room belongs to shard room % shard_count for good: rooms are numbered in
+// creation order, so the shards get rooms in turn and the ownership of the
+// per-room state (fusion slots, geometry, people tracks, fall rules) never
+// moves. Only the module -> room map changes, under the locks of every shard
+// (RadarRouter task, when a module appears or changes room).
+//
+// Placement: the network side (Wi-Fi, lwIP, MQTT, HTTP, the router) keeps
+// `network_core`; the shards go in turn over `shard_cores` cores, the other
+// cores first. With shard_cores = 1 no shard shares the network core, unless
+// the chip has a single core.
+//
+// The counters are written by the router alone. Plain C, no locking.
+
+#define PIPELINE_MAX_SHARDS 4
+#define PIPELINE_MAX_CORES  2
+
+typedef struct {
+    uint8_t shard_count;                   // 1..PIPELINE_MAX_SHARDS
+    uint8_t core[PIPELINE_MAX_SHARDS];     // Core of the tasks of each shard
+    uint32_t routed[PIPELINE_MAX_SHARDS];  // Samples handed to the shard
+    uint32_t dropped[PIPELINE_MAX_SHARDS]; // Samples lost, shard ring full
+} pipeline_shards_t;
+
+// Clamps shard_count to 1..PIPELINE_MAX_SHARDS and core_count, shard_cores
+// to 1..PIPELINE_MAX_CORES, then places the shards.
+void pipeline_shards_init(pipeline_shards_t *ps, int shard_count, int core_count, int network_core, int shard_cores);
+
+// Shard owning `room` (a fusion room index >= 0).
+static inline int pipeline_shard_of_room(const pipeline_shards_t *ps, int room) {
+    return room % ps->shard_count;
+}
+
+static inline bool pipeline_shard_owns(const pipeline_shards_t *ps, int shard, int room) {
+    return room >= 0 && pipeline_shard_of_room(ps, room) == shard;
+}
+
+// Rooms of `shard` among the first `room_count`.
+int pipeline_shard_room_count(const pipeline_shards_t *ps, int shard, int room_count);
+
+// Accounts a sample handed to `shard` (accepted or not by its queue).
+void pipeline_shard_note(pipeline_shards_t *ps, int shard, bool accepted);
+
+#endif // PIPELINE_SHARD_H
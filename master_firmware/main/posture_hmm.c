@@ -0,0 +1,108 @@
+#include <string.h>
+#include "posture_hmm.h"
+
+#define FIRST_STATE RADAR_POSTURE_STANDING
+
+// C[true][reported]: what a sensor reports for a person in a given posture.
+// Upright postures are mostly confused with each other, LYING with SITTING
+// and STILL (a low, still target).
+static const float confusion[RADAR_POSTURE_COUNT][RADAR_POSTURE_COUNT] = {
+    //                          UNKNOWN STANDING SITTING LYING MOVING STILL
+    [RADAR_POSTURE_STANDING] = { 0.0f,  0.70f,   0.10f,  0.05f, 0.10f, 0.05f },
+    [RADAR_POSTURE_SITTING]  = { 0.0f,  0.10f,   0.65f,  0.10f, 0.05f, 0.10f },
+    [RADAR_POSTURE_LYING]    = { 0.0f,  0.05f,   0.10f,  0.70f, 0.05f, 0.10f },
+    [RADAR_POSTURE_MOVING]   = { 0.0f,  0.10f,   0.05f,  0.05f, 0.75f, 0.05f },
+    [RADAR_POSTURE_STILL]    = { 0.0f,  0.10f,   0.10f,  0.10f, 0.05f, 0.65f },
+};
+
+// T[from][to], one fused set apart. Rows add up to 1.
+static const float transition[RADAR_POSTURE_COUNT][RADAR_POSTURE_COUNT] = {
+    //                          UNKNOWN STANDING SITTING LYING   MOVING  STILL
+    [RADAR_POSTURE_STANDING] = { 0.0f,  0.900f,  0.030f, 0.030f, 0.030f, 0.010f },
+    [RADAR_POSTURE_SITTING]  = { 0.0f,  0.020f,  0.950f, 0.010f, 0.010f, 0.010f },
+    [RADAR_POSTURE_LYING]    = { 0.0f,  0.003f,  0.010f, 0.980f, 0.004f, 0.003f },
+    [RADAR_POSTURE_MOVING]   = { 0.0f,  0.040f,  0.020f, 0.030f, 0.900f, 0.010f },
+    [RADAR_POSTURE_STILL]    = { 0.0f,  0.020f,  0.020f, 0.020f, 0.020f, 0.920f },
+};
+
+// Before the first vote: mostly upright, rarely lying.
+static const float initial[RADAR_POSTURE_COUNT] = {
+    [RADAR_POSTURE_STANDING] = 0.30f, [RADAR_POSTURE_SITTING] = 0.20f, [RADAR_POSTURE_LYING] = 0.05f,
+    [RADAR_POSTURE_MOVING] = 0.30f,   [RADAR_POSTURE_STILL] = 0.15f,
+};
+
+float posture_vote_weight(uint8_t signal, uint16_t range_mm) {
+    float w = (signal > 100 ? 100 : signal) / 100.0f;
+    if (range_mm >= POSTURE_FAR_MM) {
+        w *= POSTURE_FAR_WEIGHT;
+    } else if (range_mm > POSTURE_NEAR_MM) {
+        w *= 1.0f - (1.0f - POSTURE_FAR_WEIGHT) * (float)(range_mm - POSTURE_NEAR_MM) / (POSTURE_FAR_MM - POSTURE_NEAR_MM);
+    }
+    return w;
+}
+
+void posture_votes_init(posture_votes_t *votes) {
+    for (int s = 0; s < RADAR_POSTURE_COUNT; s++) {
+        votes->like[s] = 1.0f;
+    }
+    votes->votes = 0;
+}
+
+void posture_votes_add(posture_votes_t *votes, radar_posture_t reported, float weight) {
+    if ((unsigned)reported >= RADAR_POSTURE_COUNT || reported == RADAR_POSTURE_UNKNOWN || weight < POSTURE_MIN_WEIGHT) {
+        return;
+    }
+    weight = weight > 1.0f ? 1.0f : weight;
+    float floor = (1.0f - weight) / POSTURE_STATES;
+    for (int s = FIRST_STATE; s < RADAR_POSTURE_COUNT; s++) {
+        votes->like[s] *= weight * confusion[s][reported] + floor;
+    }
+    votes->votes++;
+}
+
+void posture_hmm_init(posture_hmm_t *hmm) {
+    memcpy(hmm->p, initial, sizeof(hmm->p));
+    hmm->posture = RADAR_POSTURE_UNKNOWN;
+    hmm->steps = 0;
+}
+
+radar_posture_t posture_hmm_step(posture_hmm_t *hmm, const posture_votes_t *votes) {
+    if (votes == NULL || votes->votes == 0) {
+        return hmm->posture;
+    }
+    float post[RADAR_POSTURE_COUNT] = { 0.0f };
+    float total = 0.0f;
+    for (int to = FIRST_STATE; to < RADAR_POSTURE_COUNT; to++) {
+        float prior = 0.0f;
+        for (int from = FIRST_STATE; from < RADAR_POSTURE_COUNT; from++) {
+            prior += hmm->p[from] * transition[from][to];
+        }
+        post[to] = prior * votes->like[to];
+        total += post[to];
+    }
+    if (!(total > 1e-30f)) {
+        posture_hmm_init(hmm); // Underflow: start again
+        return hmm->posture;
+    }
+    float inv = 1.0f / total;
+    for (int s = FIRST_STATE; s < RADAR_POSTURE_COUNT; s++) {
+        hmm->p[s] = post[s] * inv;
+    }
+    // Ties keep the current posture
+    radar_posture_t best = hmm->posture;
+    for (int s = FIRST_STATE; s < RADAR_POSTURE_COUNT; s++) {
+        if (best == RADAR_POSTURE_UNKNOWN || hmm->p[s] > hmm->p[best]) {
+            best = (radar_posture_t)s;
+        }
+    }
+    hmm->posture = best;
+    hmm->steps++;
+    return best;
+}
+
+void posture_hmm_percent(const posture_hmm_t *hmm, uint8_t pct[RADAR_POSTURE_COUNT]) {
+    pct[RADAR_POSTURE_UNKNOWN] = 0;
+    for (int s = FIRST_STATE; s < RADAR_POSTURE_COUNT; s++) {
+        pct[s] = (uint8_t)(hmm->p[s] * 100.0f + 0.5f);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef POSTURE_HMM_H
+#define POSTURE_HMM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radar_posture.h"
+
+// Posture of a room or of a person from the postures reported by several
+// sensors, weighted by their confidence and smoothed over time by a small
+// hidden Markov model.
+//
+// Votes. Each sensor reporting a posture casts a vote of weight w in [0, 1]:
+// its signal (0..100) times a range factor, 1 up to POSTURE_NEAR_MM and
+// falling linearly to POSTURE_FAR_WEIGHT at POSTURE_FAR_MM (the LD2410
+// posture estimate degrades with distance). The likelihood of a vote for
+// the true posture s is w x C[s][reported] + (1 - w) / 5, C being the
+// confusion matrix of a sensor: a vote of weight 0 says nothing, and a weak
+// or distant sensor cannot overrule a strong, close one. UNKNOWN votes and
+// votes below POSTURE_MIN_WEIGHT are ignored.
+//
+// Smoothing. Forward filter over the 5 postures (UNKNOWN is not a state),
+// one step per fused set (about 100 ms): prior = posterior x T, posterior =
+// prior x votes, normalised. The transition matrix T is tuned for falls:
+// - every posture is sticky, so a single set contradicting the others does
+//   not flip the output;
+// - out of STANDING and MOVING, LYING is as likely as any other move: two
+//   sensors agreeing on LYING flip the output on the first set, a single
+//   sensor within 2 or 3 sets;
+// - LYING is the stickiest state: getting up is slow, and a sensor briefly
+//   reporting SITTING does not end a lying period.
+// A step without any vote keeps the posterior: a track coasting without
+// posture reports does not drift towards the stickiest state.
+//
+// About 40 multiply-adds per step plus 5 per vote, no transcendental
+// function (the master's ESP32 FPU only does single-precision arithmetic).
+// Fixed size, plain C, no locking: owned by the FusionEngine task (fusion
+// rooms and people tracks).
+
+#define POSTURE_STATES      (RADAR_POSTURE_COUNT - 1) // UNKNOWN is not a state
+#define POSTURE_NEAR_MM     3000
+#define POSTURE_FAR_MM      6000
+#define POSTURE_FAR_WEIGHT  0.2f  // Range factor at POSTURE_FAR_MM and beyond
+#define POSTURE_MIN_WEIGHT  0.02f
+
+// Votes of one fused set.
+typedef struct {
+    float like[RADAR_POSTURE_COUNT]; // Product of the vote likelihoods, by true posture
+    uint8_t votes;
+} posture_votes_t;
+
+typedef struct {
+    float p[RADAR_POSTURE_COUNT]; // Posterior, by radar_posture_t; p[UNKNOWN] is always 0
+    radar_posture_t posture;      // Most likely posture, UNKNOWN before the first vote
+    uint32_t steps;               // Steps with at least one vote
+} posture_hmm_t;
+
+// Weight of a vote, 0..1, from the signal of the sensor (0..100) and its
+// range to the person (0 = unknown: no range factor).
+float posture_vote_weight(uint8_t signal, uint16_t range_mm);
+
+void posture_votes_init(posture_votes_t *votes);
+void posture_votes_add(posture_votes_t *votes, radar_posture_t reported, float weight);
+
+void posture_hmm_init(posture_hmm_t *hmm);
+
+// One step of the filter with the votes of a set (NULL or no vote: the
+// posterior is kept). Returns the most likely posture.
+radar_posture_t posture_hmm_step(posture_hmm_t *hmm, const posture_votes_t *votes);
+
+// Posterior in percent (0..100), by radar_posture_t. The entries add up to
+// 100 give or take the rounding.
+void posture_hmm_percent(const posture_hmm_t *hmm, uint8_t pct[RADAR_POSTURE_COUNT]);
+
+#endif // POSTURE_HMM_H
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <string.h>
+#include "posture_nn.h"
+
+#define FIRST_CLASS RADAR_POSTURE_STANDING
+
+static uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+uint32_t posture_nn_crc32(const uint8_t *data, size_t len) {
+    // Reflected polynomial 0xEDB88320, 4 bits at a time (64-byte table)
+    static const uint32_t nibble[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+posture_nn_status_t posture_nn_load(posture_nn_t *nn, const uint8_t *blob, size_t len) {
+    memset(nn, 0, sizeof(*nn));
+    if (blob == NULL || len < POSTURE_NN_HEADER_LEN) {
+        return POSTURE_NN_ERR_LENGTH;
+    }
+    if (rd32(blob) != POSTURE_NN_MAGIC) {
+        return POSTURE_NN_ERR_MAGIC;
+    }
+    if (rd16(blob + 4) != POSTURE_NN_VERSION) {
+        return POSTURE_NN_ERR_VERSION;
+    }
+    uint32_t payload_len = rd32(blob + 8);
+    if (payload_len > len - POSTURE_NN_HEADER_LEN) {
+        return POSTURE_NN_ERR_LENGTH;
+    }
+    const uint8_t *payload = blob + POSTURE_NN_HEADER_LEN;
+    if (posture_nn_crc32(payload, payload_len) != rd32(blob + 12)) {
+        return POSTURE_NN_ERR_CRC;
+    }
+    uint8_t layer_count = blob[6];
+    if (((uintptr_t)blob & 3) != 0 || layer_count == 0 || layer_count > POSTURE_NN_MAX_LAYERS ||
+        blob[7] != POSTURE_NN_FEATURES) {
+        return POSTURE_NN_ERR_LAYOUT;
+    }
+
+    // Layers: chained widths, within the arena, ending in the classes
+    uint32_t off = 0;
+    uint8_t width = POSTURE_NN_FEATURES;
+    for (int l = 0; l < layer_count; l++) {
+        if (payload_len - off < POSTURE_NN_LAYER_LEN) {
+            return POSTURE_NN_ERR_LAYOUT;
+        }
+        const uint8_t *p = payload + off;
+        posture_nn_layer_t *layer = &nn->layers[l];
+        layer->in = p[0];
+        layer->out = p[1];
+        layer->relu = (p[2] & POSTURE_NN_RELU) != 0;
+        uint32_t shifts_at = POSTURE_NN_LAYER_LEN + 8u * layer->out;
+        uint32_t weights_at = shifts_at + ((layer->out + 3u) & ~3u);
+        uint32_t size = weights_at + (((uint32_t)layer->out * layer->in + 3u) & ~3u);
+        if (layer->in != width || layer->out == 0 || layer->out > POSTURE_NN_MAX_WIDTH || payload_len - off < size) {
+            return POSTURE_NN_ERR_LAYOUT;
+        }
+        layer->bias = (const int32_t *)(p + POSTURE_NN_LAYER_LEN);
+        layer->mult = layer->bias + layer->out;
+        layer->shift = (const int8_t *)(p + shifts_at);
+        layer->weights = (const int8_t *)(p + weights_at);
+        for (int o = 0; o < layer->out; o++) {
+            if (layer->mult[o] <= 0 || layer->shift[o] < -30 || layer->shift[o] > 31) {
+                return POSTURE_NN_ERR_LAYOUT;
+            }
+        }
+        width = layer->out;
+        off += size;
+    }
+    if (width != POSTURE_NN_CLASSES || off != payload_len) {
+        return POSTURE_NN_ERR_LAYOUT;
+    }
+    float out_scale;
+    memcpy(&out_scale, blob + 16, sizeof(out_scale));
+    if (!(out_scale > 0.0f)) {
+        return POSTURE_NN_ERR_LAYOUT;
+    }
+    nn->out_scale = out_scale;
+    nn->layer_count = layer_count;
+    nn->blob_len = POSTURE_NN_HEADER_LEN + payload_len;
+    return POSTURE_NN_OK;
+}
+
+const char *posture_nn_status_name(posture_nn_status_t status) {
+    switch (status) {
+    case POSTURE_NN_OK:          return "ok";
+    case POSTURE_NN_ERR_LENGTH:  return "truncated";
+    case POSTURE_NN_ERR_MAGIC:   return "bad magic";
+    case POSTURE_NN_ERR_VERSION: return "unsupported version";
+    case POSTURE_NN_ERR_CRC:     return "bad CRC";
+    case POSTURE_NN_ERR_LAYOUT:  return "bad layout";
+    }
+    return "?";
+}
+
+static int8_t sat8(int32_t v) {
+    return (int8_t)(v < -128 ? -128 : v > 127 ? 127 : v);
+}
+
+// Target distance change, 0 unless both readings see the target
+static int32_t target_delta(uint16_t now_mm, uint16_t then_mm) {
+    return now_mm != 0 && then_mm != 0 ? (int32_t)now_mm - then_mm : 0;
+}
+
+void posture_nn_features(const RadarMessage *msg, const fusion_reading_t *prev, const fusion_reading_t *oldest,
+                         int8_t f[POSTURE_NN_FEATURES]) {
+    memset(f, 0, POSTURE_NN_FEATURES);
+    // Current sample: distances in 5 cm units (up to 6.35 m), signal, presence
+    f[0] = sat8(msg->distance_mm / 50);
+    f[1] = sat8(msg->moving_mm / 50);
+    f[2] = sat8(msg->static_mm / 50);
+    f[3] = sat8(msg->signal);
+    f[4] = msg->moving_mm != 0 ? 64 : 0;
+    f[5] = msg->static_mm != 0 ? 64 : 0;
+    // Changes since the previous reading (8 mm units) and interval (8 ms units)
+    if (prev != NULL) {
+        f[6] = sat8(((int32_t)msg->distance_mm - prev->distance_mm) / 8);
+        f[7] = sat8(target_delta(msg->moving_mm, prev->moving_mm) / 8);
+        f[8] = sat8(target_delta(msg->static_mm, prev->static_mm) / 8);
+        f[9] = sat8((int32_t)msg->signal - prev->signal);
+        f[13] = sat8((int32_t)((msg->timestamp - prev->timestamp) / 8));
+    }
+    // Changes over the history (16 mm units)
+    if (oldest != NULL) {
+        f[10] = sat8(((int32_t)msg->distance_mm - oldest->distance_mm) / 16);
+        f[11] = sat8(target_delta(msg->moving_mm, oldest->moving_mm) / 16);
+        f[12] = sat8(target_delta(msg->static_mm, oldest->static_mm) / 16);
+    }
+}
+
+// (acc x mult) / 2^(31 + shift), rounded half up, saturated to [low, high]
+static int32_t requantize(int32_t acc, int32_t mult, int shift, int32_t low, int32_t high) {
+    int total = 31 + shift;
+    int64_t v = ((int64_t)acc * mult + ((int64_t)1 << (total - 1))) >> total;
+    return (int32_t)(v < low ? low : v > high ? high : v);
+}
+
+// Bias + row . x. Targets without SIMD (the master's ESP32, RISC-V chips)
+// get four products per iteration in two independent accumulators: fewer
+// loop branches and load-use stalls, which the firmware (built for size)
+// would not unroll by itself. Elsewhere the plain loop is left to the
+// compiler's vectorizer.
+#ifndef POSTURE_NN_UNROLL
+#if defined(__riscv) || defined(__XTENSA__)
+#define POSTURE_NN_UNROLL 1
+#else
+#define POSTURE_NN_UNROLL 0
+#endif
+#endif
+
+static inline int32_t dot(const int8_t *restrict w, const int8_t *restrict x, int in, int32_t bias) {
+#if POSTURE_NN_UNROLL
+    int32_t acc0 = bias, acc1 = 0;
+    int i = 0;
+    for (; i < (in & ~3); i += 4) {
+        acc0 += w[i] * x[i] + w[i + 1] * x[i + 1];
+        acc1 += w[i + 2] * x[i + 2] + w[i + 3] * x[i + 3];
+    }
+    for (; i < in; i++) {
+        acc0 += w[i] * x[i];
+    }
+    return acc0 + acc1;
+#else
+    int32_t acc = bias;
+    for (int i = 0; i < in; i++) {
+        acc += w[i] * x[i];
+    }
+    return acc;
+#endif
+}
+
+// Hidden layer: int8 activations. Layer fields copied to locals: stores to
+// `y` (int8) may alias anything as far as the compiler knows.
+static void dense(const posture_nn_layer_t *layer, const int8_t *restrict x, int8_t *restrict y) {
+    const int8_t *w = layer->weights;
+    const int32_t *bias = layer->bias, *mult = layer->mult;
+    const int8_t *shift = layer->shift;
+    const int in = layer->in, out = layer->out;
+    const int32_t low = layer->relu ? 0 : INT8_MIN;
+    for (int o = 0; o < out; o++, w += in) {
+        y[o] = (int8_t)requantize(dot(w, x, in, bias[o]), mult[o], shift[o], low, INT8_MAX);
+    }
+}
+
+radar_posture_t posture_nn_infer(posture_nn_t *nn, const int8_t features[POSTURE_NN_FEATURES],
+                                 int16_t logits[POSTURE_NN_CLASSES]) {
+    memset(logits, 0, POSTURE_NN_CLASSES * sizeof(logits[0]));
+    if (nn->layer_count == 0) {
+        return RADAR_POSTURE_UNKNOWN;
+    }
+    const int8_t *x = features;
+    for (int l = 0; l < nn->layer_count - 1; l++) {
+        int8_t *y = nn->arena[l & 1];
+        dense(&nn->layers[l], x, y);
+        x = y;
+    }
+    // Output layer: int16 logits
+    const posture_nn_layer_t *layer = &nn->layers[nn->layer_count - 1];
+    int best = 0;
+    for (int c = 0; c < POSTURE_NN_CLASSES; c++) {
+        logits[c] = (int16_t)requantize(dot(layer->weights + c * layer->in, x, layer->in, layer->bias[c]),
+                                        layer->mult[c], layer->shift[c], INT16_MIN, INT16_MAX);
+        best = logits[c] > logits[best] ? c : best;
+    }
+    return (radar_posture_t)(FIRST_CLASS + best);
+}
+
+radar_posture_t posture_nn_classify(posture_nn_t *nn, const int8_t features[POSTURE_NN_FEATURES],
+                                    uint8_t pct[RADAR_POSTURE_COUNT]) {
+    int16_t logits[POSTURE_NN_CLASSES];
+    radar_posture_t best = posture_nn_infer(nn, features, logits);
+    memset(pct, 0, RADAR_POSTURE_COUNT);
+    if (best == RADAR_POSTURE_UNKNOWN) {
+        return best;
+    }
+    // Softmax relative to the largest logit: every exponent is <= 0
+    float p[POSTURE_NN_CLASSES], total = 0.0f;
+    int32_t top = logits[best - FIRST_CLASS];
+    for (int c = 0; c < POSTURE_NN_CLASSES; c++) {
+        p[c] = expf((float)(logits[c] - top) * nn->out_scale);
+        total += p[c];
+    }
+    for (int c = 0; c < POSTURE_NN_CLASSES; c++) {
+        pct[FIRST_CLASS + c] = (uint8_t)(p[c] * 100.0f / total + 0.5f);
+    }
+    return best;
+}
@@ -0,0 +1,117 @@
+#ifndef POSTURE_NN_H
+#define POSTURE_NN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "radar_posture.h"
+#include "pipeline_msgs.h"
+#include "fusion_engine.h"
+
+// Posture of a sample classified on the master by a small int8-quantized
+// network (multi-layer perceptron), instead of the string chosen by the
+// slave.
+//
+// Features. POSTURE_NN_FEATURES int8 values per sample, built by
+// posture_nn_features() from the sample and the module's previous readings
+// (fusion_engine history): distances of the main, moving and static
+// targets, signal, target presence, their changes since the previous reading
+// and since the oldest one kept, and the sample interval. The LD2410 gate
+// energies do not reach the master (RadarMessage), so the network works from
+// what does.
+//
+// Weights. A self-describing blob, little endian, 4-byte aligned, used in
+// place (no copy): it can live in flash (a data partition mapped with
+// esp_partition_mmap(), or the compiled-in posture_nn_default_model) and be
+// replaced without rebuilding the firmware. scripts/posture_nn_export.py
+// trains, quantizes and writes it.
+//    0  u32 magic        POSTURE_NN_MAGIC ("PNN1")
+//    4  u16 version      POSTURE_NN_VERSION
+//    6  u8  layer_count  1..POSTURE_NN_MAX_LAYERS
+//    7  u8  input_dim    POSTURE_NN_FEATURES
+//    8  u32 payload_len  Bytes after the header
+//   12  u32 crc32        IEEE CRC-32 of the payload
+//   16  f32 out_scale    Real value of one unit of the output logits
+//   20  u32 reserved
+// then, per layer: u8 in, u8 out, u8 flags (POSTURE_NN_RELU), u8 reserved,
+// i32 bias[out], i32 mult[out], i8 shift[out] and i8 weights[out][in], both
+// padded to 4 bytes.
+//
+// Arithmetic. Symmetric quantization (zero point 0): weights per output
+// channel, activations per layer. An output accumulates int8 x int8
+// products in int32 on top of its bias, then requantizes with its own
+// multiplier: y = (acc x mult) >> (31 + shift), rounded, saturated to int8
+// (0..127 with POSTURE_NN_RELU). The last layer gives POSTURE_NN_CLASSES
+// int16 logits, STANDING..STILL, so that close classes stay apart. Only the
+// 5 output probabilities use floats.
+//
+// Memory. The two activation buffers (ping-pong arena) are part of
+// posture_nn_t, no allocation: RAM is sizeof(posture_nn_t), flash is the
+// blob. Plain C, no locking: owned by the FusionEngine task.
+
+#define POSTURE_NN_MAGIC       0x314E4E50u // "PNN1" little endian
+#define POSTURE_NN_VERSION     1
+#define POSTURE_NN_HEADER_LEN  24
+#define POSTURE_NN_LAYER_LEN   4           // Layer header, before its arrays
+#define POSTURE_NN_MAX_LAYERS  4
+#define POSTURE_NN_MAX_WIDTH   32          // Inputs and outputs of a layer
+#define POSTURE_NN_FEATURES    14
+#define POSTURE_NN_CLASSES     (RADAR_POSTURE_COUNT - 1) // UNKNOWN is not a class
+#define POSTURE_NN_RELU        0x01        // Layer flags
+
+typedef enum {
+    POSTURE_NN_OK = 0,
+    POSTURE_NN_ERR_LENGTH,   // Shorter than its header or payload
+    POSTURE_NN_ERR_MAGIC,
+    POSTURE_NN_ERR_VERSION,
+    POSTURE_NN_ERR_CRC,
+    POSTURE_NN_ERR_LAYOUT,   // Misaligned, or layers not chaining / too wide / not ending in the classes
+} posture_nn_status_t;
+
+typedef struct {
+    // Arrays in the blob
+    const int8_t *weights;   // [out][in]
+    const int32_t *bias;     // [out]
+    const int32_t *mult;     // [out] requantization multipliers, 2^30..2^31 - 1
+    const int8_t *shift;     // [out] extra right shifts, -30..31
+    uint8_t in, out;
+    uint8_t relu;
+} posture_nn_layer_t;
+
+typedef struct {
+    posture_nn_layer_t layers[POSTURE_NN_MAX_LAYERS];
+    uint8_t layer_count;
+    float out_scale;
+    uint32_t blob_len;       // Header + payload
+    int8_t arena[2][POSTURE_NN_MAX_WIDTH];
+} posture_nn_t;
+
+// Compiled-in model (posture_nn_model.c, generated), used when no blob is
+// flashed in the posture_nn partition.
+extern const uint8_t posture_nn_default_model[];
+extern const size_t posture_nn_default_model_len;
+
+// IEEE 802.3 CRC-32 (the one of zlib and of the export script).
+uint32_t posture_nn_crc32(const uint8_t *data, size_t len);
+
+// Checks `blob` (at most `len` bytes; the payload may be shorter) and
+// indexes its layers. `nn` is only usable when POSTURE_NN_OK is returned.
+// The blob must stay mapped while `nn` is in use.
+posture_nn_status_t posture_nn_load(posture_nn_t *nn, const uint8_t *blob, size_t len);
+const char *posture_nn_status_name(posture_nn_status_t status);
+
+// Features of `msg` for the network. `prev` is the module's previous
+// reading and `oldest` the oldest one kept (NULL if none: no changes).
+void posture_nn_features(const RadarMessage *msg, const fusion_reading_t *prev, const fusion_reading_t *oldest,
+                         int8_t features[POSTURE_NN_FEATURES]);
+
+// Runs the network. Writes the logits of STANDING..STILL to `logits` and
+// returns the class with the largest (the first one on ties).
+radar_posture_t posture_nn_infer(posture_nn_t *nn, const int8_t features[POSTURE_NN_FEATURES],
+                                 int16_t logits[POSTURE_NN_CLASSES]);
+
+// posture_nn_infer() plus the probabilities (softmax of the logits) in
+// percent, by radar_posture_t; pct[UNKNOWN] is 0.
+radar_posture_t posture_nn_classify(posture_nn_t *nn, const int8_t features[POSTURE_NN_FEATURES],
+                                    uint8_t pct[RADAR_POSTURE_COUNT]);
+
+#endif // POSTURE_NN_H
@@ -0,0 +1,42 @@
+// Generated by scripts/posture_nn_export.py, do not edit.
+// 14-16-5 MLP trained on synthetic LD2410-like sequences (seed 2410), not on recordings.
+// Replaced at run time by a blob flashed in the posture_nn partition.
+
+#include "posture_nn.h"
+
+const uint8_t posture_nn_default_model[] __attribute__((aligned(4))) = {
+    0x50, 0x4e, 0x4e, 0x31, 0x01, 0x00, 0x02, 0x0e, 0xf8, 0x01, 0x00, 0x00, 0x8d, 0x49, 0xfe, 0xce,
+    0x38, 0x55, 0x22, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x10, 0x01, 0x00, 0x28, 0xf5, 0xff, 0xff,
+    0x13, 0x1d, 0x00, 0x00, 0xd6, 0x02, 0x00, 0x00, 0x7c, 0xea, 0xff, 0xff, 0x52, 0x09, 0x00, 0x00,
+    0x31, 0x00, 0x00, 0x00, 0x5a, 0x17, 0x00, 0x00, 0xf9, 0xe6, 0xff, 0xff, 0x8e, 0xff, 0xff, 0xff,
+    0x4b, 0xf9, 0xff, 0xff, 0x90, 0xff, 0xff, 0xff, 0x2e, 0x00, 0x00, 0x00, 0x10, 0x0c, 0x00, 0x00,
+    0x8f, 0xde, 0xff, 0xff, 0x44, 0x00, 0x00, 0x00, 0xf5, 0x01, 0x00, 0x00, 0x62, 0xb8, 0xda, 0x4f,
+    0x36, 0x32, 0xda, 0x47, 0xfa, 0x99, 0x39, 0x67, 0x3e, 0x60, 0xe5, 0x75, 0x90, 0x88, 0x2f, 0x66,
+    0x48, 0x7e, 0x41, 0x6a, 0x51, 0x80, 0xbe, 0x47, 0xbd, 0x56, 0x28, 0x60, 0xa8, 0x1b, 0x72, 0x50,
+    0x96, 0x6c, 0xff, 0x69, 0xf6, 0xce, 0x92, 0x68, 0xc8, 0x43, 0x69, 0x5a, 0x45, 0xf2, 0xaa, 0x49,
+    0x34, 0xdf, 0xe7, 0x7e, 0x96, 0x23, 0x83, 0x64, 0xb5, 0xf3, 0xbd, 0x53, 0x0a, 0x07, 0x07, 0x09,
+    0x08, 0x06, 0x06, 0x06, 0x05, 0x0a, 0x0a, 0x06, 0x06, 0x08, 0x08, 0x06, 0x26, 0x94, 0xea, 0xa7,
+    0x81, 0xd8, 0x26, 0x69, 0xe6, 0x1d, 0x11, 0x32, 0x9f, 0x51, 0xe0, 0x1e, 0x99, 0x81, 0x01, 0x01,
+    0x01, 0x05, 0xe0, 0x29, 0xce, 0xcc, 0x02, 0x10, 0x13, 0x01, 0xea, 0x05, 0x02, 0xfb, 0xed, 0x81,
+    0xfe, 0xf5, 0x2b, 0xdc, 0x28, 0xb7, 0x02, 0x42, 0x02, 0x06, 0x7f, 0x1c, 0xe7, 0x53, 0xf9, 0x08,
+    0x05, 0x41, 0x10, 0x95, 0xe9, 0xe9, 0xdb, 0x15, 0x17, 0xa9, 0xdf, 0x25, 0xf8, 0xdb, 0x0e, 0x1c,
+    0x14, 0x81, 0xff, 0x03, 0x02, 0xff, 0xf7, 0xff, 0x25, 0x0d, 0x11, 0x00, 0x81, 0xcf, 0xd2, 0x05,
+    0xf3, 0x08, 0xe8, 0x81, 0xfc, 0x15, 0xfd, 0xf6, 0x05, 0x43, 0xfd, 0xfc, 0x08, 0x15, 0xf6, 0x04,
+    0x0c, 0x7f, 0x04, 0xfb, 0x09, 0x09, 0xfd, 0xc2, 0xfe, 0xfe, 0xfa, 0x02, 0xff, 0xfe, 0x00, 0x00,
+    0x00, 0x02, 0x33, 0x0d, 0x05, 0x00, 0x7f, 0x3b, 0x23, 0x03, 0x9e, 0xf4, 0x03, 0xf7, 0xf2, 0x99,
+    0xc5, 0x26, 0xb7, 0xc8, 0x71, 0x98, 0xb7, 0x7f, 0x9e, 0x9f, 0x1d, 0x87, 0x40, 0xa9, 0xae, 0x8c,
+    0xd1, 0xb4, 0xd5, 0xfd, 0xd2, 0x81, 0xfc, 0xfb, 0x05, 0xff, 0x04, 0xfb, 0x81, 0xea, 0x5d, 0x03,
+    0xb1, 0xec, 0x2c, 0x04, 0x2c, 0x09, 0xf6, 0x81, 0xf4, 0x07, 0xef, 0xf4, 0xfd, 0x36, 0xf3, 0xfc,
+    0x09, 0xfa, 0xdf, 0xbe, 0x29, 0x7f, 0xbb, 0x1c, 0xed, 0xf8, 0x14, 0xdc, 0x18, 0x11, 0x20, 0xf7,
+    0xd9, 0x20, 0x81, 0x40, 0x27, 0xfb, 0xd2, 0x45, 0xaa, 0xe7, 0x02, 0x30, 0xe4, 0xd3, 0xfc, 0xf8,
+    0x08, 0x01, 0x0a, 0xfc, 0xd0, 0xf9, 0x81, 0xff, 0xa2, 0xc2, 0xac, 0xd6, 0x10, 0x05, 0x00, 0x00,
+    0x80, 0xfb, 0xff, 0xff, 0xf8, 0x0a, 0x00, 0x00, 0xf8, 0x02, 0x00, 0x00, 0xc6, 0xf7, 0xff, 0xff,
+    0x66, 0x05, 0x00, 0x00, 0xcf, 0x17, 0x7b, 0x5e, 0xb6, 0xd3, 0x3d, 0x4f, 0xe2, 0x1b, 0x6c, 0x78,
+    0x54, 0xc2, 0xea, 0x4c, 0x84, 0xa0, 0x3e, 0x53, 0x00, 0x01, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00,
+    0x02, 0xe9, 0x19, 0x1b, 0xc7, 0x23, 0x8e, 0x5a, 0x41, 0xf2, 0x0d, 0x55, 0x81, 0x30, 0x18, 0x38,
+    0xdd, 0x81, 0xcc, 0x15, 0xc0, 0xee, 0x23, 0x24, 0x34, 0xfd, 0x0c, 0x64, 0xf6, 0x31, 0xb2, 0x42,
+    0xf3, 0x38, 0xde, 0xd7, 0xfd, 0xe8, 0x47, 0x81, 0xf9, 0x01, 0xef, 0x10, 0x3e, 0xe3, 0xf8, 0xf9,
+    0x07, 0x05, 0x3e, 0x29, 0x28, 0x7f, 0xcc, 0x24, 0x59, 0xf3, 0xf3, 0x41, 0xfe, 0xea, 0x2e, 0x2a,
+    0xf9, 0xdc, 0xc9, 0xca, 0xff, 0x87, 0x25, 0xfc, 0x81, 0xf2, 0xef, 0x97, 0x0d, 0x0a, 0xda, 0x9e,
+};
+const size_t posture_nn_default_model_len = sizeof(posture_nn_default_model);
@@ -0,0 +1,121 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sensor_health.h"
+
+// Points lost per problem; errors and drops in proportion to their rate
+#define PENALTY_STUCK  60
+#define PENALTY_SIGNAL 60
+#define PENALTY_NOISY  25
+#define PENALTY_RATE   60
+#define RATE_REASON_PENALTY 15 // Errors or drops listed as a reason from this many points
+
+void sensor_health_init(sensor_health_t *h) {
+    memset(h, 0, sizeof(*h));
+    h->score = 100;
+}
+
+// Exponentially weighted mean and variance
+static void ewma_add(float alpha, float x, float *mean, float *var, bool first) {
+    if (first) {
+        *mean = x;
+        *var = 0.0f;
+        return;
+    }
+    float diff = x - *mean;
+    float incr = alpha * diff;
+    *mean += incr;
+    *var = (1.0f - alpha) * (*var + diff * incr);
+}
+
+static int rate_penalty(float rate, float max_rate) {
+    float ratio = max_rate > 0.0f ? rate / max_rate : 0.0f;
+    return (int)(PENALTY_RATE * (ratio > 1.0f ? 1.0f : ratio) + 0.5f);
+}
+
+static void score(const sensor_health_config_t *cfg, sensor_health_t *h) {
+    int points = 100;
+    uint8_t reasons = 0;
+    if (h->same_run >= cfg->stuck_samples) {
+        points -= PENALTY_STUCK;
+        reasons |= SENSOR_HEALTH_STUCK;
+    }
+    int errors = rate_penalty(h->error_rate, cfg->max_error_rate);
+    int drops = rate_penalty(h->drop_rate, cfg->max_drop_rate);
+    points -= errors + drops;
+    reasons |= (errors >= RATE_REASON_PENALTY ? SENSOR_HEALTH_ERRORS : 0) |
+               (drops >= RATE_REASON_PENALTY ? SENSOR_HEALTH_DROPS : 0);
+    bool target = h->last_distance_mm != 0 || h->last_moving_mm != 0 || h->last_static_mm != 0;
+    if (target && h->signal_mean < cfg->min_signal) {
+        points -= PENALTY_SIGNAL;
+        reasons |= SENSOR_HEALTH_SIGNAL;
+    }
+    if (h->distance_var > cfg->max_distance_std_mm * cfg->max_distance_std_mm) {
+        points -= PENALTY_NOISY;
+        reasons |= SENSOR_HEALTH_NOISY;
+    }
+    h->score = (uint8_t)(points < 0 ? 0 : points);
+    h->reasons = reasons;
+}
+
+bool sensor_health_update(const sensor_health_config_t *cfg, sensor_health_t *h, const RadarMessage *msg,
+                          uint32_t lost_total) {
+    const float keep = 1.0f - cfg->alpha;
+    bool first = h->samples == 0;
+    h->samples++;
+
+    // Each lost sample counts as a dropped one, this sample as a received one
+    uint32_t lost = first ? 0 : lost_total - h->lost_seen;
+    h->lost_seen = lost_total;
+    if (lost > 0) {
+        h->drop_rate = 1.0f - (1.0f - h->drop_rate) * powf(keep, (float)lost);
+    }
+    h->drop_rate *= keep;
+
+    bool error = msg->posture == RADAR_POSTURE_UNKNOWN;
+    h->error_rate = h->error_rate * keep + (error ? cfg->alpha : 0.0f);
+    if (!error) {
+        bool target = msg->distance_mm != 0 || msg->moving_mm != 0 || msg->static_mm != 0;
+        bool same = msg->distance_mm == h->last_distance_mm && msg->moving_mm == h->last_moving_mm &&
+                    msg->static_mm == h->last_static_mm && msg->signal == h->last_signal;
+        h->same_run = target && same ? (uint16_t)(h->same_run < UINT16_MAX ? h->same_run + 1 : UINT16_MAX) : 0;
+        h->last_distance_mm = msg->distance_mm;
+        h->last_moving_mm = msg->moving_mm;
+        h->last_static_mm = msg->static_mm;
+        h->last_signal = msg->signal;
+        if (target) {
+            // Empty room samples say nothing about the distance or the signal of a target
+            bool first_target = h->distance_mean_mm == 0.0f;
+            ewma_add(cfg->alpha, (float)msg->distance_mm, &h->distance_mean_mm, &h->distance_var, first_target);
+            ewma_add(cfg->alpha, (float)msg->signal, &h->signal_mean, &h->signal_var, first_target);
+        }
+    }
+
+    if (h->samples < cfg->warmup_samples) {
+        return false;
+    }
+    score(cfg, h);
+    bool was = h->degraded;
+    if (!was && h->score < cfg->degraded_below) {
+        h->degraded = true;
+    } else if (was && h->score >= cfg->restored_above) {
+        h->degraded = false;
+    }
+    return h->degraded != was;
+}
+
+int sensor_health_describe(uint8_t reasons, char *buf, size_t len) {
+    static const char *const names[] = { "stuck", "errors", "drops", "signal", "noisy" };
+    int n = 0;
+    if (len > 0) {
+        buf[0] = '\0';
+    }
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (reasons & (1u << i)) {
+            int w = snprintf(buf + (n < (int)len ? n : (int)len), n < (int)len ? len - (size_t)n : 0, "%s%s",
+                             n > 0 ? "," : "", names[i]);
+            n += w > 0 ? w : 0;
+        }
+    }
+    return n;
+}
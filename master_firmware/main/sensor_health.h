@@ -0,0 +1,70 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pipeline_msgs.h"
+
+// Health of one radar module from the samples it sends: a module that keeps
+// sending is not necessarily a sensor that still works.
+//
+// Streaming statistics, O(1) per sample, nothing kept but the running values:
+// - exponentially weighted mean and variance of the distance (samples with a
+//   target) and of the signal;
+// - stuck value: the same distance, targets and signal sample after sample,
+//   while a target is reported (an empty room, all zeros, is not stuck);
+// - error rate: samples whose posture is UNKNOWN (the slave sends "ERROR"
+//   when the LD2410 frame could not be read);
+// - drop rate: samples lost in the sequence, as a fraction of the samples
+//   the module should have sent.
+// The score starts at 100 and loses points for each of these; below
+// `degraded_below` the module is degraded, and healthy again from
+// `restored_above` (hysteresis).
+//
+// Plain C, no locking: the caller serializes access (module_registry_mutex).
+
+#define SENSOR_HEALTH_STUCK  0x01
+#define SENSOR_HEALTH_ERRORS 0x02
+#define SENSOR_HEALTH_DROPS  0x04
+#define SENSOR_HEALTH_SIGNAL 0x08 // Signal collapsed while targets are reported
+#define SENSOR_HEALTH_NOISY  0x10 // Distance spread too wide for one room
+
+typedef struct {
+    float alpha;                 // Weight of a new sample in the averages
+    uint16_t warmup_samples;     // No score before this many samples
+    uint16_t stuck_samples;      // Identical samples with a target before "stuck"
+    float max_error_rate;        // Rate costing the full error penalty
+    float max_drop_rate;
+    float min_signal;            // Mean signal (0..100) below which it has collapsed
+    float max_distance_std_mm;
+    uint8_t degraded_below;
+    uint8_t restored_above;
+} sensor_health_config_t;
+
+typedef struct {
+    float distance_mean_mm, distance_var;
+    float signal_mean, signal_var;
+    float error_rate, drop_rate;
+    uint32_t samples;
+    uint32_t lost_seen;          // Lost count of the registry at the previous sample
+    uint16_t last_distance_mm, last_moving_mm, last_static_mm;
+    uint16_t same_run;           // Identical samples with a target in a row
+    uint8_t last_signal;
+    uint8_t score;               // 0..100
+    uint8_t reasons;             // SENSOR_HEALTH_* costing points
+    bool degraded;
+    bool alerted;                // `degraded` as last reported by an alert
+} sensor_health_t;
+
+void sensor_health_init(sensor_health_t *h);
+
+// One sample of the module. `lost_total`: samples lost in its sequence so
+// far (module_info_t.samples_lost). Returns true when `degraded` changes.
+bool sensor_health_update(const sensor_health_config_t *cfg, sensor_health_t *h, const RadarMessage *msg,
+                          uint32_t lost_total);
+
+// "stuck", "errors", ... of `reasons`, comma separated; the snprintf() result
+int sensor_health_describe(uint8_t reasons, char *buf, size_t len);
+
+#endif // SENSOR_HEALTH_H
@@ -0,0 +1,100 @@
+#include <string.h>
+#include "spsc_ring.h"
+
+bool spsc_ring_init(spsc_ring_t *r, void *slots, size_t item_size, uint32_t capacity) {
+    memset(r, 0, sizeof(*r));
+    if (slots == NULL || item_size == 0 || item_size > UINT32_MAX || capacity == 0 ||
+        (capacity & (capacity - 1)) != 0 || capacity > (1u << 31)) {
+        return false;
+    }
+    atomic_init(&r->head, 0);
+    atomic_init(&r->pushed, 0);
+    atomic_init(&r->dropped, 0);
+    atomic_init(&r->high_water, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->parked, false);
+    r->slots = (uint8_t *)slots;
+    r->capacity = capacity;
+    r->mask = capacity - 1;
+    r->item_size = (uint32_t)item_size;
+    return true;
+}
+
+// Counters written by one side only: a plain read-modify-write, no atomic RMW
+static void bump(atomic_uint *counter) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+bool spsc_ring_push(spsc_ring_t *r, const void *item) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire); // Slot freed before we overwrite it
+    uint32_t count = head - tail;
+    if (count >= r->capacity) {
+        bump(&r->dropped);
+        return false;
+    }
+    memcpy(r->slots + (size_t)(head & r->mask) * r->item_size, item, r->item_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    bump(&r->pushed);
+    if (count + 1 > atomic_load_explicit(&r->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&r->high_water, count + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool spsc_ring_take_sleeper(spsc_ring_t *r) {
+    // Orders the head store above before the read of `parked` (see spsc_ring_park)
+    atomic_thread_fence(memory_order_seq_cst);
+    return atomic_load_explicit(&r->parked, memory_order_relaxed) &&
+           atomic_exchange_explicit(&r->parked, false, memory_order_relaxed);
+}
+
+uint32_t spsc_ring_pop_batch(spsc_ring_t *r, void *items, uint32_t max) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t n = atomic_load_explicit(&r->head, memory_order_acquire) - tail; // Items written before head moved
+    if (n > max) {
+        n = max;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    // At most two runs: up to the end of the slots, then from the start
+    uint32_t first = tail & r->mask;
+    uint32_t run = r->capacity - first < n ? r->capacity - first : n;
+    memcpy(items, r->slots + (size_t)first * r->item_size, (size_t)run * r->item_size);
+    memcpy((uint8_t *)items + (size_t)run * r->item_size, r->slots, (size_t)(n - run) * r->item_size);
+    atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+    return n;
+}
+
+bool spsc_ring_park(spsc_ring_t *r) {
+    atomic_store_explicit(&r->parked, true, memory_order_relaxed);
+    // Orders the store above before the read of head: a concurrent push either
+    // is seen here or sees `parked` in spsc_ring_take_sleeper()
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&r->head, memory_order_relaxed) != atomic_load_explicit(&r->tail, memory_order_relaxed)) {
+        atomic_store_explicit(&r->parked, false, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void spsc_ring_unpark(spsc_ring_t *r) {
+    atomic_store_explicit(&r->parked, false, memory_order_relaxed);
+}
+
+uint32_t spsc_ring_count(const spsc_ring_t *r) {
+    // Tail first: read the other way round, a pop in between could make tail pass head
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t count = head - tail;
+    return count > r->capacity ? r->capacity : count;
+}
+
+void spsc_ring_get_stats(const spsc_ring_t *r, spsc_ring_stats_t *stats) {
+    stats->capacity = r->capacity;
+    stats->count = spsc_ring_count(r);
+    stats->high_water = atomic_load_explicit(&r->high_water, memory_order_relaxed);
+    stats->pushed = atomic_load_explicit(&r->pushed, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&r->dropped, memory_order_relaxed);
+}
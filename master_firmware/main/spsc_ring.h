@@ -0,0 +1,88 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free single-producer / single-consumer ring of fixed-size items: the
+// stage boundaries of the master pipeline, where one task feeds one task.
+//
+// spsc_ring_push() copies the item into its slot and publishes it with a
+// release store of `head`; spsc_ring_pop_batch() copies up to `max` items out
+// and frees their slots with a release store of `tail`. No lock, no critical
+// section, no system call. A full ring makes push() fail at once, counted in
+// `dropped`: the producer never waits for the consumer.
+//
+// Waking the consumer is left to the caller (a task notification on the
+// master). Before sleeping the consumer calls spsc_ring_park(), which fails if
+// items arrived meanwhile; after each push the producer calls
+// spsc_ring_take_sleeper() and wakes the consumer when it returns true. Both
+// go through a sequentially consistent fence, so an item pushed while the
+// consumer parks is either seen by its last check or wakes it.
+//
+// The producer's and the consumer's words sit on separate cache lines on a
+// host. The ESP32's internal RAM has no data cache: the target aligns them
+// to words only.
+
+#ifndef SPSC_RING_ALIGN
+#if defined(__XTENSA__) || defined(__riscv)
+#define SPSC_RING_ALIGN 4
+#else
+#define SPSC_RING_ALIGN 64
+#endif
+#endif
+
+typedef struct {
+    // Producer side
+    alignas(SPSC_RING_ALIGN) atomic_uint head; // Items pushed so far (wraps)
+    atomic_uint pushed;
+    atomic_uint dropped;     // Pushes refused, ring full
+    atomic_uint high_water;  // Largest occupancy seen by a push
+    // Consumer side
+    alignas(SPSC_RING_ALIGN) atomic_uint tail; // Items popped so far (wraps)
+    atomic_bool parked;      // Consumer about to sleep, or asleep
+    // Set by spsc_ring_init()
+    alignas(SPSC_RING_ALIGN) uint8_t *slots;
+    uint32_t capacity;       // Power of two
+    uint32_t mask;
+    uint32_t item_size;
+} spsc_ring_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t count;          // Items waiting
+    uint32_t high_water;
+    uint32_t pushed;
+    uint32_t dropped;
+} spsc_ring_stats_t;
+
+// `slots` holds `capacity` items of `item_size` bytes and must outlive the
+// ring. False if capacity is not a power of two or an argument is 0/NULL.
+bool spsc_ring_init(spsc_ring_t *r, void *slots, size_t item_size, uint32_t capacity);
+
+// Producer task only. False (and counted) when the ring is full.
+bool spsc_ring_push(spsc_ring_t *r, const void *item);
+
+// Producer task only, after a push: true when the consumer was parked. The
+// caller then wakes it; the flag is cleared, so a single push wakes it once.
+bool spsc_ring_take_sleeper(spsc_ring_t *r);
+
+// Consumer task only: copies up to `max` items, oldest first, into `items`.
+// Returns how many.
+uint32_t spsc_ring_pop_batch(spsc_ring_t *r, void *items, uint32_t max);
+
+// Consumer task only: announces a sleep. False (not parked) when the ring
+// holds items, which the consumer must pop first.
+bool spsc_ring_park(spsc_ring_t *r);
+
+// Consumer task only, after waking (notified or not)
+void spsc_ring_unpark(spsc_ring_t *r);
+
+// Any task. `count` may be one item stale while the two sides are running.
+uint32_t spsc_ring_count(const spsc_ring_t *r);
+void spsc_ring_get_stats(const spsc_ring_t *r, spsc_ring_stats_t *stats);
+
+#endif // SPSC_RING_H
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "timer_wheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+// Ticks are compared as ms (start of their slot): the ms clock wraps at 2^32,
+// the tick count would not
+static inline uint32_t slot_start_ms(const timer_wheel_t *wheel, uint32_t ms) {
+    return ms & ~((1u << wheel->tick_shift) - 1);
+}
+
+static inline uint16_t slot_of(const timer_wheel_t *wheel, uint32_t ms) {
+    return (uint16_t)((ms >> wheel->tick_shift) & SLOT_MASK);
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_entry_t *timers, uint16_t capacity, uint8_t tick_shift,
+                      uint32_t now_ms) {
+    wheel->timers = timers;
+    wheel->capacity = capacity;
+    wheel->armed = 0;
+    wheel->tick_shift = tick_shift;
+    wheel->cursor_ms = slot_start_ms(wheel, now_ms);
+    memset(wheel->heads, 0xFF, sizeof(wheel->heads)); // TIMER_WHEEL_NONE
+    for (uint16_t i = 0; i < capacity; i++) {
+        timers[i].next = timers[i].prev = timers[i].slot = TIMER_WHEEL_NONE;
+        timers[i].deadline_ms = 0;
+    }
+}
+
+static void unlink_timer(timer_wheel_t *wheel, uint16_t id) {
+    timer_wheel_entry_t *t = &wheel->timers[id];
+    if (t->prev != TIMER_WHEEL_NONE) {
+        wheel->timers[t->prev].next = t->next;
+    } else {
+        wheel->heads[t->slot] = t->next;
+    }
+    if (t->next != TIMER_WHEEL_NONE) {
+        wheel->timers[t->next].prev = t->prev;
+    }
+    t->next = t->prev = t->slot = TIMER_WHEEL_NONE;
+    wheel->armed--;
+}
+
+void timer_wheel_arm(timer_wheel_t *wheel, uint16_t id, uint32_t deadline_ms) {
+    if (id >= wheel->capacity) {
+        return;
+    }
+    if (wheel->timers[id].slot != TIMER_WHEEL_NONE) {
+        unlink_timer(wheel, id);
+    }
+    // Already past the cursor: the cursor slot, visited by the next expiry
+    uint16_t slot = slot_of(wheel, (int32_t)(deadline_ms - wheel->cursor_ms) < 0 ? wheel->cursor_ms : deadline_ms);
+    timer_wheel_entry_t *t = &wheel->timers[id];
+    t->deadline_ms = deadline_ms;
+    t->slot = slot;
+    t->prev = TIMER_WHEEL_NONE;
+    t->next = wheel->heads[slot];
+    if (t->next != TIMER_WHEEL_NONE) {
+        wheel->timers[t->next].prev = id;
+    }
+    wheel->heads[slot] = id;
+    wheel->armed++;
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, uint16_t id) {
+    if (timer_wheel_armed(wheel, id)) {
+        unlink_timer(wheel, id);
+    }
+}
+
+size_t timer_wheel_expire(timer_wheel_t *wheel, uint32_t now_ms, uint16_t *expired, size_t max) {
+    uint32_t target_ms = slot_start_ms(wheel, now_ms);
+    int32_t span = (int32_t)(target_ms - wheel->cursor_ms) >> wheel->tick_shift;
+    if (span < 0) {
+        return 0;
+    }
+    uint32_t steps = span >= TIMER_WHEEL_SLOTS ? TIMER_WHEEL_SLOTS : (uint32_t)span + 1;
+    size_t n = 0;
+    for (uint32_t i = 0; i < steps && wheel->armed > 0; i++) {
+        uint16_t id = wheel->heads[slot_of(wheel, wheel->cursor_ms + (i << wheel->tick_shift))];
+        while (id != TIMER_WHEEL_NONE) {
+            uint16_t next = wheel->timers[id].next;
+            if ((int32_t)(now_ms - wheel->timers[id].deadline_ms) >= 0) {
+                if (n == max) {
+                    wheel->cursor_ms += i << wheel->tick_shift; // This slot again at the next call
+                    return n;
+                }
+                unlink_timer(wheel, id);
+                expired[n++] = id;
+            }
+            id = next;
+        }
+    }
+    wheel->cursor_ms = target_ms;
+    return n;
+}
+
+bool timer_wheel_next_deadline(const timer_wheel_t *wheel, uint32_t *deadline_ms) {
+    bool any = false;
+    uint32_t earliest = 0;
+    for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS && wheel->armed > 0; i++) {
+        uint32_t start_ms = wheel->cursor_ms + (i << wheel->tick_shift);
+        bool this_turn = false;
+        for (uint16_t id = wheel->heads[slot_of(wheel, start_ms)]; id != TIMER_WHEEL_NONE; id = wheel->timers[id].next) {
+            uint32_t deadline = wheel->timers[id].deadline_ms;
+            if (!any || (int32_t)(deadline - earliest) < 0) {
+                earliest = deadline;
+                any = true;
+            }
+            this_turn = this_turn || (int32_t)(slot_start_ms(wheel, deadline) - start_ms) <= 0;
+        }
+        // Slots are in deadline order within a turn: a deadline of this
+        // turn is earlier than any in the slots after
+        if (this_turn) {
+            break;
+        }
+    }
+    *deadline_ms = earliest;
+    return any;
+}
@@ -0,0 +1,65 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hashed timer wheel: one deadline per timer, re-armed in O(1) (the watchdog
+// re-arms the deadline of a module at each of its samples), expired by
+// visiting only the slots the clock went through since the last call.
+//
+// TIMER_WHEEL_SLOTS slots of 2^tick_shift ms; a timer sits in the slot of its
+// deadline, in an intrusive doubly linked list of timer indexes (no
+// allocation). A deadline more than one turn away waits in its slot for the
+// turns to come: expiry compares the deadline itself, so the slot size only
+// sets how many timers a call walks, not when they fire. The clock is a
+// uint32_t in ms (esp_log_timestamp()), compared with wrap-around: deadlines
+// must stay within 2^31 ms of the current time.
+//
+// Plain C, no locking: the caller serializes access (module_registry_mutex).
+
+#define TIMER_WHEEL_SLOTS 256 // Power of two
+#define TIMER_WHEEL_NONE  0xFFFF
+
+typedef struct {
+    uint32_t deadline_ms;
+    uint16_t next, prev;  // Timer indexes in the slot list, TIMER_WHEEL_NONE at the ends
+    uint16_t slot;        // TIMER_WHEEL_NONE: not armed
+} timer_wheel_entry_t;
+
+typedef struct {
+    timer_wheel_entry_t *timers; // Caller's array, one per timer index
+    uint16_t capacity;
+    uint16_t armed;              // Timers currently armed
+    uint8_t tick_shift;          // Slot size: 2^tick_shift ms
+    uint32_t cursor_ms;          // Start of the last slot expired: slots before it hold no due timer
+    uint16_t heads[TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+// `timers`: `capacity` entries (< TIMER_WHEEL_NONE), all disarmed.
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_entry_t *timers, uint16_t capacity, uint8_t tick_shift,
+                      uint32_t now_ms);
+
+// Arms timer `id` at `deadline_ms`, moving it if already armed. A deadline
+// already past fires at the next timer_wheel_expire(). O(1).
+void timer_wheel_arm(timer_wheel_t *wheel, uint16_t id, uint32_t deadline_ms);
+
+// O(1). Nothing happens if the timer is not armed.
+void timer_wheel_cancel(timer_wheel_t *wheel, uint16_t id);
+
+static inline bool timer_wheel_armed(const timer_wheel_t *wheel, uint16_t id) {
+    return id < wheel->capacity && wheel->timers[id].slot != TIMER_WHEEL_NONE;
+}
+
+// Disarms the timers due at `now_ms` and writes their ids to `expired`, at
+// most `max` (call again while it returns `max`). Walks the slots from the
+// previous call to `now_ms`, at most one turn.
+size_t timer_wheel_expire(timer_wheel_t *wheel, uint32_t now_ms, uint16_t *expired, size_t max);
+
+// Earliest deadline of the armed timers, false if none. Walks the slots from
+// the cursor up to the first one holding a deadline of this turn; all of them
+// only when every timer is more than a turn away.
+bool timer_wheel_next_deadline(const timer_wheel_t *wheel, uint32_t *deadline_ms);
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,251 @@
+#include <math.h>
+#include <string.h>
+#include "trilateration.h"
+
+#define MIN_BASELINE_M  0.01f
+#define CONVERGED_M2    1e-6f  // Gauss-Newton step below 1 mm
+#define SINGULAR_RATIO  1e-4f  // det / trace^2 of a 2x2 normal matrix below this: singular
+
+void trilat_geometry_init(trilat_geometry_t *g, const trilat_bounds_t *bounds, float range_sigma_m) {
+    memset(g, 0, sizeof(*g));
+    g->bounds = *bounds;
+    g->range_sigma_m = range_sigma_m > 0.0f ? range_sigma_m : TRILAT_DEFAULT_RANGE_SIGMA_M;
+}
+
+static void update_pairs(trilat_geometry_t *g, int index) {
+    for (int j = 0; j < TRILAT_MAX_SENSORS; j++) {
+        if (j == index || !(g->valid_mask & (1u << j))) {
+            continue;
+        }
+        int lo = index < j ? index : j, hi = index < j ? j : index;
+        trilat_pair_t *pr = &g->pair[trilat_pair_index(lo, hi)];
+        float dx = g->pos[hi].x - g->pos[lo].x, dy = g->pos[hi].y - g->pos[lo].y;
+        pr->d = sqrtf(dx * dx + dy * dy);
+        if (pr->d >= MIN_BASELINE_M) {
+            pr->ex.x = dx / pr->d;
+            pr->ex.y = dy / pr->d;
+        } else {
+            pr->ex.x = pr->ex.y = 0.0f;
+        }
+    }
+}
+
+void trilat_geometry_set_sensor(trilat_geometry_t *g, int index, float x, float y) {
+    if (index < 0 || index >= TRILAT_MAX_SENSORS) {
+        return;
+    }
+    g->pos[index].x = x;
+    g->pos[index].y = y;
+    g->norm2[index] = x * x + y * y;
+    g->valid_mask |= (uint8_t)(1u << index);
+    g->cached_mask = 0;
+    update_pairs(g, index);
+}
+
+void trilat_geometry_clear_sensor(trilat_geometry_t *g, int index) {
+    if (index < 0 || index >= TRILAT_MAX_SENSORS) {
+        return;
+    }
+    g->valid_mask &= (uint8_t)~(1u << index);
+    g->cached_mask = 0;
+}
+
+static bool inside(const trilat_bounds_t *b, trilat_point_t p) {
+    return p.x >= b->min_x && p.x <= b->max_x && p.y >= b->min_y && p.y <= b->max_y;
+}
+
+static float dist2(trilat_point_t a, trilat_point_t b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+// Squared distance from `p` to the room rectangle (0 inside).
+static float outside2(const trilat_bounds_t *b, trilat_point_t p) {
+    float dx = p.x < b->min_x ? b->min_x - p.x : (p.x > b->max_x ? p.x - b->max_x : 0.0f);
+    float dy = p.y < b->min_y ? b->min_y - p.y : (p.y > b->max_y ? p.y - b->max_y : 0.0f);
+    return dx * dx + dy * dy;
+}
+
+// Intersection of the circles of sensors i < j, mirror ambiguity resolved
+// with the room bounds, then `hint`.
+static bool two_circles(const trilat_geometry_t *g, int i, int j, float ri, float rj,
+                        trilat_point_t hint, trilat_point_t *p, uint8_t *flags) {
+    const trilat_pair_t *pr = &g->pair[trilat_pair_index(i, j)];
+    if (pr->d < MIN_BASELINE_M) {
+        return false;
+    }
+    float a = (ri * ri - rj * rj + pr->d * pr->d) / (2.0f * pr->d);
+    float h2 = ri * ri - a * a;
+    trilat_point_t base = { g->pos[i].x + a * pr->ex.x, g->pos[i].y + a * pr->ex.y };
+    if (h2 <= 0.0f) {
+        *flags |= TRILAT_FLAG_NO_INTERSECTION;
+        *p = base;
+        return true;
+    }
+    float h = sqrtf(h2);
+    trilat_point_t c1 = { base.x - h * pr->ex.y, base.y + h * pr->ex.x };
+    trilat_point_t c2 = { base.x + h * pr->ex.y, base.y - h * pr->ex.x };
+    bool in1 = inside(&g->bounds, c1), in2 = inside(&g->bounds, c2);
+    if (in1 != in2) {
+        *p = in1 ? c1 : c2;
+    } else if (in1) {
+        *flags |= TRILAT_FLAG_AMBIGUOUS;
+        *p = dist2(c1, hint) <= dist2(c2, hint) ? c1 : c2;
+    } else {
+        *p = outside2(&g->bounds, c1) <= outside2(&g->bounds, c2) ? c1 : c2;
+    }
+    return true;
+}
+
+// J^T J (a b; b c) and J^T r of the range residuals at `p`. Returns sum r^2.
+static float normal_equations(const trilat_geometry_t *g, uint8_t mask, const float *ranges,
+                              trilat_point_t p, float *a, float *b, float *c, float *gx, float *gy) {
+    float sum_r2 = 0.0f;
+    *a = *b = *c = *gx = *gy = 0.0f;
+    for (uint8_t m = mask; m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        float dx = p.x - g->pos[k].x, dy = p.y - g->pos[k].y;
+        float d = sqrtf(dx * dx + dy * dy);
+        if (d < 1e-4f) { // On the sensor: no gradient
+            sum_r2 += ranges[k] * ranges[k];
+            continue;
+        }
+        float ux = dx / d, uy = dy / d, r = d - ranges[k];
+        *a += ux * ux;
+        *b += ux * uy;
+        *c += uy * uy;
+        *gx += ux * r;
+        *gy += uy * r;
+        sum_r2 += r * r;
+    }
+    return sum_r2;
+}
+
+static bool singular(float a, float b, float c) {
+    float det = a * c - b * b;
+    return det <= SINGULAR_RATIO * (a + c) * (a + c);
+}
+
+// (A^T A)^-1 A^T of the linearised system, reference sensor = lowest of `mask`.
+static void cache_pseudo_inverse(trilat_geometry_t *g, uint8_t mask) {
+    int ref = __builtin_ctz(mask);
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    for (uint8_t m = mask & (uint8_t)(mask - 1); m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        float ax = 2.0f * (g->pos[k].x - g->pos[ref].x), ay = 2.0f * (g->pos[k].y - g->pos[ref].y);
+        a += ax * ax;
+        b += ax * ay;
+        c += ay * ay;
+    }
+    memset(g->pinv, 0, sizeof(g->pinv));
+    g->cached_mask = mask;
+    g->cached_degenerate = singular(a, b, c);
+    if (g->cached_degenerate) {
+        return;
+    }
+    float inv_det = 1.0f / (a * c - b * b);
+    for (uint8_t m = mask & (uint8_t)(mask - 1); m; m &= (uint8_t)(m - 1)) {
+        int k = __builtin_ctz(m);
+        float ax = 2.0f * (g->pos[k].x - g->pos[ref].x), ay = 2.0f * (g->pos[k].y - g->pos[ref].y);
+        g->pinv[0][k] = (c * ax - b * ay) * inv_det;
+        g->pinv[1][k] = (a * ay - b * ax) * inv_det;
+    }
+}
+
+static void longest_baseline(const trilat_geometry_t *g, uint8_t mask, int *bi, int *bj) {
+    float best = -1.0f;
+    for (uint8_t mi = mask; mi; mi &= (uint8_t)(mi - 1)) {
+        int i = __builtin_ctz(mi);
+        for (uint8_t mj = mi & (uint8_t)(mi - 1); mj; mj &= (uint8_t)(mj - 1)) {
+            int j = __builtin_ctz(mj);
+            float d = g->pair[trilat_pair_index(i, j)].d;
+            if (d > best) {
+                best = d;
+                *bi = i;
+                *bj = j;
+            }
+        }
+    }
+}
+
+bool trilat_solve(trilat_geometry_t *g, uint8_t mask, const float *ranges_m,
+                  const trilat_point_t *hint, trilat_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    mask &= g->valid_mask;
+    int n = __builtin_popcount(mask);
+    if (n < 2) {
+        return false;
+    }
+    trilat_point_t centre = { (g->bounds.min_x + g->bounds.max_x) * 0.5f, (g->bounds.min_y + g->bounds.max_y) * 0.5f };
+    trilat_point_t h = hint ? *hint : centre;
+    trilat_point_t p;
+
+    if (n == 2) {
+        int i = __builtin_ctz(mask), j = __builtin_ctz(mask & (uint8_t)(mask - 1));
+        if (!two_circles(g, i, j, ranges_m[i], ranges_m[j], h, &p, &out->flags)) {
+            return false;
+        }
+    } else {
+        if (mask != g->cached_mask) {
+            cache_pseudo_inverse(g, mask);
+        }
+        if (g->cached_degenerate) {
+            // All sensors on one line: the mirror ambiguity of 2 sensors remains
+            int i = 0, j = 0;
+            longest_baseline(g, mask, &i, &j);
+            if (!two_circles(g, i, j, ranges_m[i], ranges_m[j], h, &p, &out->flags)) {
+                return false;
+            }
+            out->flags |= TRILAT_FLAG_DEGENERATE;
+        } else {
+            int ref = __builtin_ctz(mask);
+            float base = ranges_m[ref] * ranges_m[ref] - g->norm2[ref];
+            p.x = p.y = 0.0f;
+            for (uint8_t m = mask & (uint8_t)(mask - 1); m; m &= (uint8_t)(m - 1)) {
+                int k = __builtin_ctz(m);
+                float bk = base - ranges_m[k] * ranges_m[k] + g->norm2[k];
+                p.x += g->pinv[0][k] * bk;
+                p.y += g->pinv[1][k] * bk;
+            }
+        }
+
+        for (int it = 0; it < TRILAT_MAX_ITERATIONS; it++) {
+            float a, b, c, gx, gy;
+            normal_equations(g, mask, ranges_m, p, &a, &b, &c, &gx, &gy);
+            if (singular(a, b, c)) {
+                break;
+            }
+            float inv_det = 1.0f / (a * c - b * b);
+            float sx = (c * gx - b * gy) * inv_det, sy = (a * gy - b * gx) * inv_det;
+            p.x -= sx;
+            p.y -= sy;
+            out->iterations++;
+            if (sx * sx + sy * sy < CONVERGED_M2) {
+                break;
+            }
+        }
+    }
+
+    float a, b, c, gx, gy;
+    float sum_r2 = normal_equations(g, mask, ranges_m, p, &a, &b, &c, &gx, &gy);
+    float var = g->range_sigma_m * g->range_sigma_m;
+    out->p = p;
+    out->used = (uint8_t)n;
+    out->residual_rms_m = sqrtf(sum_r2 / (float)n);
+    if (singular(a, b, c)) {
+        out->gdop = TRILAT_GDOP_MAX;
+        out->cov_xx = out->cov_yy = var * TRILAT_GDOP_MAX * TRILAT_GDOP_MAX * 0.5f;
+    } else {
+        float inv_det = 1.0f / (a * c - b * b);
+        out->cov_xx = var * c * inv_det;
+        out->cov_xy = -var * b * inv_det;
+        out->cov_yy = var * a * inv_det;
+        out->gdop = sqrtf((a + c) * inv_det);
+        if (out->gdop > TRILAT_GDOP_MAX) {
+            out->gdop = TRILAT_GDOP_MAX;
+        }
+    }
+    if (!inside(&g->bounds, p)) {
+        out->flags |= TRILAT_FLAG_OUTSIDE;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef TRILATERATION_H
+#define TRILATERATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Position of a person from the distances measured by the radar modules of a
+// room, in room coordinates (metres).
+//
+// trilat_geometry_t holds the calibrated sensor positions of one room, by
+// fusion slot, and everything that depends on them only: squared norms, unit
+// vector and length of every sensor pair, and the linear least-squares
+// pseudo-inverse of the last sensor subset. It is rebuilt when a sensor moves
+// (calibration or room membership), not per sample.
+//
+// - 2 sensors: intersection of two circles. Of the two mirror solutions, the
+//   one inside the room bounds is kept; if both are inside, the one closest
+//   to `hint` (last position, or the room centre).
+// - 3+ sensors: linear least squares as the starting point, then Gauss-Newton
+//   on the range residuals (a few iterations, 2x2 normal equations).
+//
+// The covariance is range_sigma_m^2 * (J^T J)^-1 at the solution and GDOP is
+// sqrt(trace((J^T J)^-1)): about 1 with sensors seen at right angles, large
+// when the person is on the line through two sensors.
+//
+// Plain C, no locking: owned by the FusionEngine task.
+
+#define TRILAT_MAX_SENSORS           8      // = FUSION_SLOTS_PER_ROOM
+#define TRILAT_DEFAULT_RANGE_SIGMA_M 0.15f  // LD2410 distance noise, 1 sigma
+#define TRILAT_MAX_ITERATIONS        8
+#define TRILAT_GDOP_MAX              99.0f  // Reported for a singular geometry
+
+#define TRILAT_FLAG_AMBIGUOUS       0x01 // 2 sensors: both intersections inside the room
+#define TRILAT_FLAG_NO_INTERSECTION 0x02 // 2 sensors: circles apart, point on the baseline
+#define TRILAT_FLAG_OUTSIDE         0x04 // Solution outside the room bounds
+#define TRILAT_FLAG_DEGENERATE      0x08 // 3+ sensors on one line: solved as 2 sensors
+
+typedef struct {
+    float x, y;
+} trilat_point_t;
+
+typedef struct {
+    float min_x, min_y, max_x, max_y;
+} trilat_bounds_t;
+
+typedef struct {
+    trilat_point_t ex; // Unit vector from sensor i to sensor j
+    float d;           // Baseline length
+} trilat_pair_t;
+
+#define TRILAT_PAIR_COUNT (TRILAT_MAX_SENSORS * (TRILAT_MAX_SENSORS - 1) / 2)
+
+typedef struct {
+    trilat_bounds_t bounds;
+    float range_sigma_m;
+    uint8_t valid_mask;     // Bit i: sensor i has a calibrated position
+    uint8_t cached_mask;    // Subset of `pinv`, 0 = none
+    bool cached_degenerate; // `cached_mask` sensors are collinear, `pinv` unused
+    trilat_point_t pos[TRILAT_MAX_SENSORS];
+    float norm2[TRILAT_MAX_SENSORS];          // |pos|^2
+    trilat_pair_t pair[TRILAT_PAIR_COUNT];    // i < j, see trilat_pair_index()
+    float pinv[2][TRILAT_MAX_SENSORS];        // Linear LS of `cached_mask`, by sensor
+} trilat_geometry_t;
+
+typedef struct {
+    trilat_point_t p;
+    float cov_xx, cov_xy, cov_yy; // m^2
+    float gdop;
+    float residual_rms_m;         // RMS of |p - sensor| - range over the used sensors
+    uint8_t used;                 // Sensors used
+    uint8_t iterations;           // Gauss-Newton iterations (0 for 2 sensors)
+    uint8_t flags;                // TRILAT_FLAG_*
+} trilat_result_t;
+
+void trilat_geometry_init(trilat_geometry_t *g, const trilat_bounds_t *bounds, float range_sigma_m);
+
+// Sets or clears the calibrated position of sensor `index`. O(TRILAT_MAX_SENSORS).
+void trilat_geometry_set_sensor(trilat_geometry_t *g, int index, float x, float y);
+void trilat_geometry_clear_sensor(trilat_geometry_t *g, int index);
+
+// Index of the pair (i, j), i < j, in trilat_geometry_t.pair.
+static inline int trilat_pair_index(int i, int j) {
+    return i * (2 * TRILAT_MAX_SENSORS - i - 1) / 2 + (j - i - 1);
+}
+
+// Solves for the sensors of `mask` that are calibrated; `ranges_m` is indexed
+// by sensor. `hint` may be NULL. Returns false if fewer than 2 sensors are
+// usable or they share a position.
+bool trilat_solve(trilat_geometry_t *g, uint8_t mask, const float *ranges_m,
+                  const trilat_point_t *hint, trilat_result_t *out);
+
+#endif // TRILATERATION_H
@@ -0,0 +1,347 @@
+#include <string.h>
+#include "zone_engine.h"
+
+typedef enum { CELL_OUTSIDE, CELL_PARTIAL, CELL_COVERED } cell_relation_t;
+
+bool zone_engine_init(zone_engine_t *ze, const zone_def_t *zones, uint16_t zone_count, uint16_t *arena,
+                      uint32_t arena_len, int16_t min_x_mm, int16_t min_y_mm, int16_t max_x_mm, int16_t max_y_mm,
+                      uint16_t cell_mm) {
+    memset(ze, 0, sizeof(*ze));
+    if ((zones == NULL && zone_count > 0) || zone_count > ZONE_MAX_ZONES || cell_mm == 0 || max_x_mm <= min_x_mm ||
+        max_y_mm <= min_y_mm) {
+        return false;
+    }
+    int32_t cols = ((int32_t)max_x_mm - min_x_mm + cell_mm - 1) / cell_mm;
+    int32_t rows = ((int32_t)max_y_mm - min_y_mm + cell_mm - 1) / cell_mm;
+    if (cols > 255 || rows > 255) {
+        return false;
+    }
+    for (uint16_t z = 0; z < zone_count; z++) {
+        if (zones[z].vertex_count < 3 || zones[z].vertex_count > ZONE_MAX_VERTICES || zones[z].room == NULL) {
+            return false;
+        }
+    }
+    ze->zones = zones;
+    ze->zone_count = zone_count;
+    ze->min_x_mm = min_x_mm;
+    ze->min_y_mm = min_y_mm;
+    ze->max_x_mm = max_x_mm;
+    ze->max_y_mm = max_y_mm;
+    ze->cell_mm = cell_mm;
+    ze->arena = arena;
+    ze->arena_len = arena != NULL ? arena_len : 0;
+    return true;
+}
+
+// Crossing number; a point on the border may fall either side
+static bool point_in_zone(const zone_def_t *zone, int32_t x, int32_t y) {
+    bool inside = false;
+    for (int i = 0, j = zone->vertex_count - 1; i < zone->vertex_count; j = i++) {
+        int32_t xi = zone->vertices[i].x_mm, yi = zone->vertices[i].y_mm;
+        int32_t xj = zone->vertices[j].x_mm, yj = zone->vertices[j].y_mm;
+        if ((yi > y) != (yj > y)) {
+            // x < xi + (y - yi) * (xj - xi) / (yj - yi), without the division
+            int64_t lhs = (int64_t)(x - xi) * (yj - yi);
+            int64_t rhs = (int64_t)(y - yi) * (xj - xi);
+            if (yj > yi ? lhs < rhs : lhs > rhs) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+// Liang-Barsky: does segment a-b touch the rectangle [x0, x1] x [y0, y1]?
+static bool segment_touches_rect(float ax, float ay, float bx, float by, float x0, float y0, float x1, float y1) {
+    float t0 = 0.0f, t1 = 1.0f;
+    float dx = bx - ax, dy = by - ay;
+    const float p[4] = { -dx, dx, -dy, dy };
+    const float q[4] = { ax - x0, x1 - ax, ay - y0, y1 - ay };
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f) {
+                return false; // Parallel to this side and outside it
+            }
+        } else {
+            float t = q[i] / p[i];
+            if (p[i] < 0.0f) {
+                if (t > t1) {
+                    return false;
+                }
+                if (t > t0) {
+                    t0 = t;
+                }
+            } else {
+                if (t < t0) {
+                    return false;
+                }
+                if (t < t1) {
+                    t1 = t;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// A cell no border crosses is either covered or outside: its centre decides.
+// The cell is widened by 1 mm so that a border along its side counts as
+// crossing it (the cell then gets a point test rather than a wrong answer).
+static cell_relation_t cell_relation(const zone_def_t *zone, int32_t x0, int32_t y0, int32_t cell_mm) {
+    float fx0 = (float)x0 - 1.0f, fy0 = (float)y0 - 1.0f;
+    float fx1 = (float)(x0 + cell_mm) + 1.0f, fy1 = (float)(y0 + cell_mm) + 1.0f;
+    for (int i = 0, j = zone->vertex_count - 1; i < zone->vertex_count; j = i++) {
+        if (segment_touches_rect(zone->vertices[j].x_mm, zone->vertices[j].y_mm, zone->vertices[i].x_mm,
+                                 zone->vertices[i].y_mm, fx0, fy0, fx1, fy1)) {
+            return CELL_PARTIAL;
+        }
+    }
+    return point_in_zone(zone, x0 + cell_mm / 2, y0 + cell_mm / 2) ? CELL_COVERED : CELL_OUTSIDE;
+}
+
+// Cells [c0, c1] x [r0, r1] of the grid overlapping the bounding box of `zone`,
+// false if none
+static bool zone_cells(const zone_engine_t *ze, const zone_grid_t *g, const zone_def_t *zone, int *c0, int *r0,
+                       int *c1, int *r1) {
+    int32_t minx = zone->vertices[0].x_mm, maxx = minx, miny = zone->vertices[0].y_mm, maxy = miny;
+    for (int i = 1; i < zone->vertex_count; i++) {
+        minx = zone->vertices[i].x_mm < minx ? zone->vertices[i].x_mm : minx;
+        maxx = zone->vertices[i].x_mm > maxx ? zone->vertices[i].x_mm : maxx;
+        miny = zone->vertices[i].y_mm < miny ? zone->vertices[i].y_mm : miny;
+        maxy = zone->vertices[i].y_mm > maxy ? zone->vertices[i].y_mm : maxy;
+    }
+    int32_t lo_x = (minx - g->min_x_mm) / (int32_t)ze->cell_mm, hi_x = (maxx - g->min_x_mm) / (int32_t)ze->cell_mm;
+    int32_t lo_y = (miny - g->min_y_mm) / (int32_t)ze->cell_mm, hi_y = (maxy - g->min_y_mm) / (int32_t)ze->cell_mm;
+    if (maxx < g->min_x_mm || maxy < g->min_y_mm || lo_x >= g->cols || lo_y >= g->rows) {
+        return false;
+    }
+    *c0 = lo_x < 0 ? 0 : (int)lo_x;
+    *r0 = lo_y < 0 ? 0 : (int)lo_y;
+    *c1 = hi_x >= g->cols ? g->cols - 1 : (int)hi_x;
+    *r1 = hi_y >= g->rows ? g->rows - 1 : (int)hi_y;
+    return true;
+}
+
+// Walks the cells of every zone of `room_name`. First pass (entries NULL):
+// counts the entries of each cell in cell_first[c + 1]. Second pass: writes
+// them, cell_first[c] serving as the write cursor of cell c.
+static void grid_fill(const zone_engine_t *ze, zone_grid_t *g, const char *room_name, uint16_t *entries) {
+    for (uint16_t z = 0; z < ze->zone_count; z++) {
+        const zone_def_t *zone = &ze->zones[z];
+        int c0, r0, c1, r1;
+        if (strcmp(zone->room, room_name) != 0 || !zone_cells(ze, g, zone, &c0, &r0, &c1, &r1)) {
+            continue;
+        }
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cell_relation_t rel = cell_relation(zone, g->min_x_mm + c * ze->cell_mm,
+                                                    g->min_y_mm + r * ze->cell_mm, ze->cell_mm);
+                if (rel == CELL_OUTSIDE) {
+                    continue;
+                }
+                int cell = r * g->cols + c;
+                if (entries == NULL) {
+                    g->cell_first[cell + 1]++;
+                } else {
+                    entries[g->cell_first[cell]++] = (uint16_t)(z | (rel == CELL_COVERED ? ZONE_ENTRY_COVERS : 0));
+                }
+            }
+        }
+    }
+}
+
+int zone_engine_bind_room(zone_engine_t *ze, int room, const char *room_name) {
+    if (room < 0 || room >= ZONE_MAX_ROOMS) {
+        return -1;
+    }
+    zone_grid_t *g = &ze->grids[room];
+    if (ze->bound[room]) {
+        return g->zone_count;
+    }
+    memset(g, 0, sizeof(*g));
+    g->min_x_mm = ze->min_x_mm;
+    g->min_y_mm = ze->min_y_mm;
+    g->cols = (uint8_t)(((int32_t)ze->max_x_mm - ze->min_x_mm + ze->cell_mm - 1) / ze->cell_mm);
+    g->rows = (uint8_t)(((int32_t)ze->max_y_mm - ze->min_y_mm + ze->cell_mm - 1) / ze->cell_mm);
+    for (uint16_t z = 0; z < ze->zone_count; z++) {
+        if (strcmp(ze->zones[z].room, room_name) == 0) {
+            g->room = ze->zones[z].room;
+            g->zone_count++;
+        }
+    }
+    ze->bound[room] = true;
+    if (g->zone_count == 0) {
+        return 0;
+    }
+
+    uint32_t cells = (uint32_t)g->cols * g->rows;
+    if (ze->arena_len - ze->arena_used < cells + 1) {
+        g->zone_count = 0;
+        return -1;
+    }
+    g->cell_first = ze->arena + ze->arena_used;
+    memset(g->cell_first, 0, (cells + 1) * sizeof(uint16_t));
+    grid_fill(ze, g, room_name, NULL);
+    uint32_t total = 0;
+    for (uint32_t c = 1; c <= cells; c++) {
+        total += g->cell_first[c];
+        if (total > UINT16_MAX) {
+            break;
+        }
+        g->cell_first[c] = (uint16_t)total;
+    }
+    if (total > UINT16_MAX || ze->arena_len - ze->arena_used < cells + 1 + total) {
+        g->cell_first = NULL;
+        g->zone_count = 0;
+        return -1;
+    }
+    g->entries = g->cell_first + cells + 1;
+    grid_fill(ze, g, room_name, g->entries); // Moves each cell_first[c] to the end of cell c...
+    for (uint32_t c = cells; c > 0; c--) {
+        g->cell_first[c] = g->cell_first[c - 1]; // ...which is the start of cell c + 1
+    }
+    g->cell_first[0] = 0;
+    ze->arena_used += cells + 1 + total;
+    return g->zone_count;
+}
+
+int zone_engine_classify(const zone_engine_t *ze, int room, int16_t x_mm, int16_t y_mm, uint16_t *hits, int max) {
+    if (room < 0 || room >= ZONE_MAX_ROOMS) {
+        return 0;
+    }
+    const zone_grid_t *g = &ze->grids[room];
+    if (g->cell_first == NULL || x_mm < g->min_x_mm || y_mm < g->min_y_mm) {
+        return 0;
+    }
+    uint32_t c = (uint32_t)(x_mm - g->min_x_mm) / ze->cell_mm, r = (uint32_t)(y_mm - g->min_y_mm) / ze->cell_mm;
+    if (c >= g->cols || r >= g->rows) {
+        return 0;
+    }
+    uint32_t cell = r * g->cols + c;
+    int n = 0;
+    for (uint32_t e = g->cell_first[cell]; e < g->cell_first[cell + 1] && n < max; e++) {
+        uint16_t z = g->entries[e] & ~ZONE_ENTRY_COVERS;
+        if ((g->entries[e] & ZONE_ENTRY_COVERS) || point_in_zone(&ze->zones[z], x_mm, y_mm)) {
+            hits[n++] = z;
+        }
+    }
+    return n;
+}
+
+int zone_engine_classify_linear(const zone_engine_t *ze, int room, int16_t x_mm, int16_t y_mm, uint16_t *hits,
+                                int max) {
+    if (room < 0 || room >= ZONE_MAX_ROOMS) {
+        return 0;
+    }
+    const zone_grid_t *g = &ze->grids[room];
+    // Same bounds as the grid
+    if (g->cell_first == NULL || x_mm < g->min_x_mm || y_mm < g->min_y_mm ||
+        x_mm - g->min_x_mm >= g->cols * ze->cell_mm || y_mm - g->min_y_mm >= g->rows * ze->cell_mm) {
+        return 0;
+    }
+    int n = 0;
+    for (uint16_t z = 0; z < ze->zone_count && n < max; z++) {
+        if (strcmp(ze->zones[z].room, g->room) == 0 && point_in_zone(&ze->zones[z], x_mm, y_mm)) {
+            hits[n++] = z;
+        }
+    }
+    return n;
+}
+
+void zone_presence_init(zone_presence_t *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+static int presence_dwell(const zone_engine_t *ze, zone_presence_t *p, uint32_t now_ms, zone_event_t *events) {
+    int n = 0;
+    for (int i = 0; i < p->count; i++) {
+        uint16_t dwell_s = ze->zones[p->zone[i]].dwell_s;
+        uint32_t inside_ms = now_ms - p->entered_ms[i];
+        if (dwell_s != 0 && !(p->dwell_sent & (1u << i)) && inside_ms >= (uint32_t)dwell_s * 1000u) {
+            p->dwell_sent |= (uint8_t)(1u << i);
+            events[n++] = (zone_event_t){ ZONE_EVENT_DWELL, p->zone[i], inside_ms };
+        }
+    }
+    return n;
+}
+
+int zone_engine_update(const zone_engine_t *ze, zone_presence_t *p, int room, int16_t x_mm, int16_t y_mm,
+                       uint32_t now_ms, zone_event_t *events) {
+    uint16_t hits[ZONE_MAX_HITS];
+    int hit_count = zone_engine_classify(ze, room, x_mm, y_mm, hits, ZONE_MAX_HITS);
+    int n = 0;
+    // Zones left: compacted out of `p`, order of the others kept
+    int kept = 0;
+    uint8_t dwell_sent = 0;
+    for (int i = 0; i < p->count; i++) {
+        bool still = false;
+        for (int h = 0; h < hit_count && !still; h++) {
+            still = hits[h] == p->zone[i];
+        }
+        if (!still) {
+            events[n++] = (zone_event_t){ ZONE_EVENT_EXIT, p->zone[i], now_ms - p->entered_ms[i] };
+            continue;
+        }
+        if (p->dwell_sent & (1u << i)) {
+            dwell_sent |= (uint8_t)(1u << kept);
+        }
+        p->zone[kept] = p->zone[i];
+        p->entered_ms[kept] = p->entered_ms[i];
+        kept++;
+    }
+    p->count = (uint8_t)kept;
+    p->dwell_sent = dwell_sent;
+    for (int h = 0; h < hit_count; h++) {
+        bool known = false;
+        for (int i = 0; i < p->count && !known; i++) {
+            known = p->zone[i] == hits[h];
+        }
+        if (!known && p->count < ZONE_MAX_HITS) {
+            p->zone[p->count] = hits[h];
+            p->entered_ms[p->count] = now_ms;
+            p->count++;
+            events[n++] = (zone_event_t){ ZONE_EVENT_ENTER, hits[h], 0 };
+        }
+    }
+    return n + presence_dwell(ze, p, now_ms, events + n);
+}
+
+int zone_engine_tick(const zone_engine_t *ze, zone_presence_t *p, uint32_t now_ms, zone_event_t *events) {
+    return presence_dwell(ze, p, now_ms, events);
+}
+
+zone_fall_policy_t zone_engine_fall_policy(const zone_engine_t *ze, const zone_presence_t *p, uint16_t *zone) {
+    zone_fall_policy_t policy = ZONE_FALL_NORMAL;
+    uint16_t decided = ZONE_NONE;
+    for (int i = 0; i < p->count; i++) {
+        zone_fall_policy_t zp = (zone_fall_policy_t)ze->zones[p->zone[i]].fall_policy;
+        if (zp == ZONE_FALL_ESCALATE || (zp == ZONE_FALL_SUPPRESS && policy == ZONE_FALL_NORMAL)) {
+            policy = zp;
+            decided = p->zone[i];
+        }
+    }
+    if (zone != NULL) {
+        *zone = decided;
+    }
+    return policy;
+}
+
+uint16_t zone_engine_inactivity_pct(const zone_engine_t *ze, const zone_presence_t *p) {
+    uint16_t pct = 0;
+    for (int i = 0; i < p->count; i++) {
+        uint16_t zp = ze->zones[p->zone[i]].inactivity_pct;
+        if (zp != 0 && (pct == 0 || zp < pct)) {
+            pct = zp;
+        }
+    }
+    return pct;
+}
+
+const char *zone_event_name(zone_event_type_t type) {
+    switch (type) {
+    case ZONE_EVENT_ENTER: return "ENTER";
+    case ZONE_EVENT_EXIT:  return "EXIT";
+    case ZONE_EVENT_DWELL: return "DWELL";
+    default:               return "?";
+    }
+}
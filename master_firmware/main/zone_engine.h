@@ -0,0 +1,136 @@
+#ifndef ZONE_ENGINE_H
+#define ZONE_ENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Zones of the rooms (bed, bathroom, doorway...): polygons in room
+// coordinates, classified through a uniform grid.
+//
+// The zones are a constant table (zone_def_t), each naming its room. When a
+// room appears, zone_engine_bind_room() builds its grid: for every cell, the
+// zones that touch it, flagged when they cover the whole cell. A position is
+// then classified by reading its cell: zones covering the cell match at
+// once, only the zones whose border crosses the cell need a point-in-polygon
+// test. The grid cells live in an arena given by the caller.
+//
+// Per person, a zone_presence_t remembers the zones the person is in and
+// since when; zone_engine_update() turns a new position into ENTER, EXIT and
+// DWELL events. The fall policy of the zones the person is in can suppress
+// the fall logic (a bed) or escalate it (a bathroom floor).
+//
+// Plain C, no allocation, no locking. Binding writes the grid of one room;
+// classifying only reads it, so the grid of a room is bound before the first
+// position of that room reaches its readers.
+
+#define ZONE_MAX_ROOMS     16
+#define ZONE_MAX_VERTICES  8
+#define ZONE_MAX_HITS      4      // Zones a position can be in at once (overlapping zones)
+#define ZONE_MAX_EVENTS    (3 * ZONE_MAX_HITS) // Events of one update, at most
+#define ZONE_NONE          0xFFFFu
+#define ZONE_MAX_ZONES     0x7FFF // Zone index in 15 bits of a grid entry
+#define ZONE_ENTRY_COVERS  0x8000u
+
+typedef enum {
+    ZONE_FALL_NORMAL = 0,
+    ZONE_FALL_SUPPRESS,   // A fall is not reported here (lying on a bed, a sofa)
+    ZONE_FALL_ESCALATE,   // A fall is confirmed sooner and flagged (bathroom, floor next to the bed)
+} zone_fall_policy_t;
+
+typedef struct {
+    int16_t x_mm, y_mm;
+} zone_point_t;
+
+typedef struct {
+    const char *room;         // Room name announced by its modules (mDNS TXT "room")
+    const char *name;
+    uint8_t fall_policy;      // zone_fall_policy_t
+    uint8_t vertex_count;     // 3..ZONE_MAX_VERTICES, in order around the polygon
+    uint16_t dwell_s;         // DWELL event after this long inside, 0 = none
+    zone_point_t vertices[ZONE_MAX_VERTICES];
+    uint16_t inactivity_pct;  // Inactivity alert delays in the zone (inactivity_monitor.h), percent; 0 = default
+} zone_def_t;
+
+typedef struct {
+    int16_t min_x_mm, min_y_mm;
+    uint8_t cols, rows;
+    uint16_t zone_count;      // Zones of the room
+    const char *room;         // Its name, from the zone table
+    uint16_t *cell_first;     // Entries of cell c: [cell_first[c], cell_first[c + 1]); NULL = no zone
+    uint16_t *entries;        // Zone index, ZONE_ENTRY_COVERS if the zone covers the cell
+} zone_grid_t;
+
+typedef struct {
+    const zone_def_t *zones;
+    uint16_t zone_count;
+    int16_t min_x_mm, min_y_mm, max_x_mm, max_y_mm; // Grid bounds, the same for every room
+    uint16_t cell_mm;
+    uint16_t *arena;
+    uint32_t arena_len, arena_used;                 // In uint16_t words
+    bool bound[ZONE_MAX_ROOMS];
+    zone_grid_t grids[ZONE_MAX_ROOMS];
+} zone_engine_t;
+
+// Zones a person is in, entry time of each, DWELL events sent
+typedef struct {
+    uint16_t zone[ZONE_MAX_HITS];
+    uint32_t entered_ms[ZONE_MAX_HITS];
+    uint8_t count;
+    uint8_t dwell_sent;       // Bit i: DWELL of zone[i] sent
+} zone_presence_t;
+
+typedef enum {
+    ZONE_EVENT_ENTER,
+    ZONE_EVENT_EXIT,
+    ZONE_EVENT_DWELL,
+} zone_event_type_t;
+
+typedef struct {
+    uint8_t type;             // zone_event_type_t
+    uint16_t zone;
+    uint32_t inside_ms;       // EXIT, DWELL: time spent inside
+} zone_event_t;
+
+// `zones` stays valid for the life of the engine. Positions outside the
+// bounds (mm) match no zone. Returns false on a bad argument (a zone with
+// fewer than 3 or more than ZONE_MAX_VERTICES vertices, too many zones, a
+// grid of more than 255 x 255 cells).
+bool zone_engine_init(zone_engine_t *ze, const zone_def_t *zones, uint16_t zone_count, uint16_t *arena,
+                      uint32_t arena_len, int16_t min_x_mm, int16_t min_y_mm, int16_t max_x_mm, int16_t max_y_mm,
+                      uint16_t cell_mm);
+
+// Builds the grid of room `room` from the zones naming `room_name`. Once per
+// room: a bound room is left as it is. Returns the zones of the room, -1 if
+// the arena is too small (the room then has no zone).
+int zone_engine_bind_room(zone_engine_t *ze, int room, const char *room_name);
+
+// Zones of `room` containing (x_mm, y_mm), at most `max`, in `hits`.
+int zone_engine_classify(const zone_engine_t *ze, int room, int16_t x_mm, int16_t y_mm, uint16_t *hits, int max);
+
+// Same result from every zone of the room, without the grid (tests, benchmarks)
+int zone_engine_classify_linear(const zone_engine_t *ze, int room, int16_t x_mm, int16_t y_mm, uint16_t *hits,
+                                int max);
+
+void zone_presence_init(zone_presence_t *p);
+
+// New position of a person at `now_ms`: EXIT of the zones left, ENTER of the
+// zones entered, DWELL of the zones held for their dwell time. Returns the
+// number of events written to `events` (ZONE_MAX_EVENTS at most).
+int zone_engine_update(const zone_engine_t *ze, zone_presence_t *p, int room, int16_t x_mm, int16_t y_mm,
+                       uint32_t now_ms, zone_event_t *events);
+
+// DWELL events due at `now_ms` without a new position (a person lying still)
+int zone_engine_tick(const zone_engine_t *ze, zone_presence_t *p, uint32_t now_ms, zone_event_t *events);
+
+// Fall policy of the zones the person is in: ESCALATE before SUPPRESS before
+// NORMAL (a missed fall costs more than a false alarm). `zone`, if not NULL,
+// receives the zone that decided, ZONE_NONE if none.
+zone_fall_policy_t zone_engine_fall_policy(const zone_engine_t *ze, const zone_presence_t *p, uint16_t *zone);
+
+// Inactivity weight of the zones the person is in: the smallest non-zero
+// inactivity_pct (the strictest zone), 0 if none sets one.
+uint16_t zone_engine_inactivity_pct(const zone_engine_t *ze, const zone_presence_t *p);
+
+const char *zone_event_name(zone_event_type_t type);
+
+#endif // ZONE_ENGINE_H
@@ -3,14 +3,16 @@
 #include <stdbool.h>
 #include <stdint.h> // For uint32_t
 #include "esp_log.h"
+#include "pipeline_msgs.h" // AlertMessage, alert_describe(), alert_payload() (shared with main.c)
+#include "alert_outbox.h"  // alert_outbox_rank(): informational alerts skip the outbox
 
 // --- BEGIN LIMITATION NOTE ---
 // This test file provides a THEORETICAL structure for unit testing AlertManager_task.
 // Due to sandbox limitations:
 // 1. This code will NOT be compiled or run.
 // 2. The AlertManager_task logic (which is static in main.c) is not directly callable.
-//    A simplified simulation of its core message processing and MQTT payload formatting
-//    is implemented here for test demonstration.
+//    A simplified simulation of its core message processing is implemented here; the
+//    MQTT payload comes from the real alert_payload() formatter (pipeline_msgs.c).
 // 3. The MQTT client handle (client_handle) and connection flag (mqtt_connected_flag)
 //    are global in main.c. Their states will be simulated within these test functions.
 // 4. FreeRTOS queues (alert_queue) are conceptually simulated.
@@ -23,97 +25,99 @@
 static const char *TAG_TEST_ALERT = "TEST_ALERT_MANAGER";
 
 // Definitions copied/adapted from main.c
-typedef enum { 
-    ALERT_TYPE_FALL_DETECTED, 
-    ALERT_TYPE_MODULE_OFFLINE 
-} AlertType;
-
-typedef struct {
-    AlertType type;
-    char description[64];
-    uint32_t alert_timestamp;
-} AlertMessage;
-
 #define ALERT_TOPIC "home/room1/alert" // As defined in main.c
 
 // Simulated MQTT client handle (conceptual, non-NULL indicates "initialized")
 #define SIM_MQTT_CLIENT_HANDLE ((void*)0x12345678) 
 
 // Simulates the core logic of AlertManager_task processing one alert message
-// and preparing the MQTT payload.
-void simulate_alert_manager_processing(AlertMessage alert_msg, bool sim_mqtt_connected, void* sim_client_handle) {
+// and preparing the MQTT payload, with the buffers and the formatter of
+// main.c (alert_payload(), pipeline_msgs.c). The payload is left in `payload`
+// (ALERT_PAYLOAD_MAX bytes); returns the length alert_payload() wanted.
+// `alert_id`: id given by the alert outbox (alert_outbox.h), in the payload for de-duplication.
+int simulate_alert_manager_processing(AlertMessage alert_msg, uint32_t alert_id, bool sim_mqtt_connected,
+                                      void* sim_client_handle, char *payload) {
+    char description[ALERT_DESCRIPTION_MAX]; // As in AlertManager_task: built from the queued fields
+    alert_describe(&alert_msg, description, sizeof(description));
     ESP_LOGI(TAG_TEST_ALERT, "Simulating processing of alert: Type=%d, Desc=%s, TS=%u", 
-             alert_msg.type, alert_msg.description, alert_msg.alert_timestamp);
-
-    char mqtt_payload[128]; // Buffer as in AlertManager_task
-
-    if (alert_msg.type == ALERT_TYPE_FALL_DETECTED) {
-        snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                 "{\"alert_type\": \"FALL_DETECTED\", \"description\": \"%s\", \"timestamp\": %u}", 
-                 alert_msg.description, alert_msg.alert_timestamp);
-    } else if (alert_msg.type == ALERT_TYPE_MODULE_OFFLINE) {
-        snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                 "{\"alert_type\": \"MODULE_OFFLINE\", \"description\": \"%s\", \"timestamp\": %u}", 
-                 alert_msg.description, alert_msg.alert_timestamp);
-    } else {
-        snprintf(mqtt_payload, sizeof(mqtt_payload), 
-                 "{\"alert_type\": \"UNKNOWN\", \"description\": \"%s\", \"timestamp\": %u}", 
-                 alert_msg.description, alert_msg.alert_timestamp);
-    }
+             alert_msg.type, description, alert_msg.alert_timestamp);
 
-    ESP_LOGI(TAG_TEST_ALERT, "Simulated MQTT Payload: %s", mqtt_payload);
+    bool informational = alert_outbox_rank((AlertType)alert_msg.type) == 0;
+    int len = alert_payload(&alert_msg, informational ? 0 : alert_id, description, payload, ALERT_PAYLOAD_MAX);
+    ESP_LOGI(TAG_TEST_ALERT, "Simulated MQTT Payload: %s", payload);
 
     if (sim_mqtt_connected && sim_client_handle != NULL) {
-        ESP_LOGI(TAG_TEST_ALERT, "Sim: Would publish to MQTT topic '%s'. (Simulated success)", ALERT_TOPIC);
+        ESP_LOGI(TAG_TEST_ALERT, "Sim: Would publish to MQTT topic '%s' at QoS %d. (Simulated success)", ALERT_TOPIC,
+                 informational ? 0 : 1);
+    } else if (informational) {
+        ESP_LOGW(TAG_TEST_ALERT, "Sim: MQTT not connected or client NULL. Informational alert not published.");
     } else {
-        ESP_LOGW(TAG_TEST_ALERT, "Sim: MQTT not connected or client NULL. Alert would not be published via MQTT.");
+        ESP_LOGW(TAG_TEST_ALERT, "Sim: MQTT not connected or client NULL. Alert %u would stay in the outbox until the broker is back.",
+                 alert_id);
     }
     // TODOs for buzzer, LED, HTTP/email are conceptually part of AlertManager_task but not tested here.
+    return len;
 }
 
 
 void test_format_fall_alert() {
     ESP_LOGI(TAG_TEST_ALERT, "Running test: test_format_fall_alert");
     
-    AlertMessage test_alert;
-    test_alert.type = ALERT_TYPE_FALL_DETECTED;
+    AlertMessage test_alert = { .type = ALERT_TYPE_FALL_DETECTED, .x_mm = 1000, .y_mm = 1500,
+                                .flags = ALERT_FLAG_DEGRADED | ALERT_FLAG_ESCALATED };
     test_alert.alert_timestamp = 1234567890;
-    snprintf(test_alert.description, sizeof(test_alert.description), "Chute à TS %u", test_alert.alert_timestamp);
+    char payload[ALERT_PAYLOAD_MAX];
 
     // Simulate MQTT connected
-    simulate_alert_manager_processing(test_alert, true, SIM_MQTT_CLIENT_HANDLE);
-    
-    // Manual check of logs: Expected payload should contain "FALL_DETECTED" and the description/timestamp.
-    // For a real test, we'd capture the `mqtt_payload` and `strcmp` it.
-    ESP_LOGI(TAG_TEST_ALERT, "Test PASSED (manual log check): Check simulated MQTT payload for FALL_DETECTED format.");
+    int len = simulate_alert_manager_processing(test_alert, 1, true, SIM_MQTT_CLIENT_HANDLE, payload);
+
+    // Longest fall description: fits the buffers of AlertManager_task
+    const char *prefix = "{\"id\": 1, \"alert_type\": \"FALL_DETECTED\"";
+    if (len < ALERT_PAYLOAD_MAX && strncmp(payload, prefix, strlen(prefix)) == 0 &&
+        strstr(payload, "\"timestamp\": 1234567890}") != NULL) {
+        ESP_LOGI(TAG_TEST_ALERT, "Test PASSED: FALL_DETECTED payload with its id, %d bytes.", len);
+    } else {
+        ESP_LOGE(TAG_TEST_ALERT, "Test FAILED: payload %s (%d bytes).", payload, len);
+    }
 }
 
 void test_format_module_offline_alert() {
     ESP_LOGI(TAG_TEST_ALERT, "Running test: test_format_module_offline_alert");
 
-    AlertMessage test_alert;
-    test_alert.type = ALERT_TYPE_MODULE_OFFLINE;
+    AlertMessage test_alert = { .type = ALERT_TYPE_MODULE_OFFLINE, .module_id = 2, .silent_ms = 6000 };
     test_alert.alert_timestamp = 1234500000;
-    snprintf(test_alert.description, sizeof(test_alert.description), "Module 2 offline");
+    char payload[ALERT_PAYLOAD_MAX];
 
     // Simulate MQTT connected
-    simulate_alert_manager_processing(test_alert, true, SIM_MQTT_CLIENT_HANDLE);
+    int len = simulate_alert_manager_processing(test_alert, 2, true, SIM_MQTT_CLIENT_HANDLE, payload);
 
-    ESP_LOGI(TAG_TEST_ALERT, "Test PASSED (manual log check): Check simulated MQTT payload for MODULE_OFFLINE format.");
+    if (len < ALERT_PAYLOAD_MAX && strstr(payload, "\"id\": 2, \"alert_type\": \"MODULE_OFFLINE\"") != NULL &&
+        strstr(payload, "Module 2 offline. Last seen 6000 ms ago.") != NULL) {
+        ESP_LOGI(TAG_TEST_ALERT, "Test PASSED: MODULE_OFFLINE payload with its description.");
+    } else {
+        ESP_LOGE(TAG_TEST_ALERT, "Test FAILED: payload %s (%d bytes).", payload, len);
+    }
 }
 
 void test_alert_publish_when_mqtt_disconnected() {
     ESP_LOGI(TAG_TEST_ALERT, "Running test: test_alert_publish_when_mqtt_disconnected");
     
-    AlertMessage test_alert;
-    test_alert.type = ALERT_TYPE_FALL_DETECTED;
+    AlertMessage test_alert = { .type = ALERT_TYPE_FALL_DETECTED };
     test_alert.alert_timestamp = 1234567900;
-    snprintf(test_alert.description, sizeof(test_alert.description), "Chute test déconnexion");
+    AlertMessage zone_alert = { .type = ALERT_TYPE_ZONE_ENTER, .zone = 1, .room = 1 };
+    char payload[ALERT_PAYLOAD_MAX];
 
-    // Simulate MQTT disconnected
-    simulate_alert_manager_processing(test_alert, false, SIM_MQTT_CLIENT_HANDLE);
-    
-    ESP_LOGI(TAG_TEST_ALERT, "Test PASSED (manual log check): Check log for 'MQTT not connected' warning.");
+    // Simulate MQTT disconnected: the fall stays in the outbox, the zone event is not tracked (id 0)
+    simulate_alert_manager_processing(test_alert, 3, false, SIM_MQTT_CLIENT_HANDLE, payload);
+    bool fall_kept = strstr(payload, "\"id\": 3,") != NULL;
+    simulate_alert_manager_processing(zone_alert, 4, false, SIM_MQTT_CLIENT_HANDLE, payload);
+    bool zone_untracked = strstr(payload, "\"id\": 0, \"alert_type\": \"ZONE_ENTER\"") != NULL;
+
+    if (fall_kept && zone_untracked) {
+        ESP_LOGI(TAG_TEST_ALERT, "Test PASSED: Fall kept in the outbox under its id, zone event best-effort.");
+    } else {
+        ESP_LOGE(TAG_TEST_ALERT, "Test FAILED: fall kept %d, zone event untracked %d.", fall_kept, zone_untracked);
+    }
 }
 
 
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "alert_outbox.h"
+
+// --- BEGIN NOTE ---
+// alert_outbox.c (master_firmware/main) is plain C: these tests drive it the
+// way AlertManager_task and the MQTT event handler do, with made-up packet
+// ids and clocks: publishes without PUBACK retried with a doubling backoff,
+// a PUBACK seen before the packet id was recorded, a full outbox ranking
+// falls above inactivity above offline modules, and a reboot through the
+// NVS blob (ids not reused, latency from the wall clock).
+// The broker side, a real broker stopped while an alert is in flight and
+// started again, is host_bench/bench_alert_outbox.
+// --- END NOTE ---
+
+static const char *TAG_TEST_OUTBOX = "TEST_ALERT_OUTBOX";
+
+static const alert_outbox_config_t test_outbox_config = {
+    .retry_base_ms = 1000,
+    .retry_max_ms = 8000,
+    .ack_timeout_ms = 5000,
+};
+
+static alert_outbox_t test_outbox;
+
+static AlertMessage test_alert(AlertType type, uint32_t now_ms) {
+    AlertMessage alert = { .alert_timestamp = now_ms, .type = (uint8_t)type, .room = 1 };
+    return alert;
+}
+
+void test_alert_outbox_retry_until_puback() {
+    ESP_LOGI(TAG_TEST_OUTBOX, "Running test: test_alert_outbox_retry_until_puback");
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    AlertMessage fall = test_alert(ALERT_TYPE_FALL_DETECTED, 10000);
+    uint32_t id = alert_outbox_push(&test_outbox, &fall, 10000, 0);
+
+    // Published at once, no PUBACK: again after the ack timeout plus 1 s, 2 s, 4 s, 8 s, 8 s
+    alert_outbox_entry_t entry;
+    uint32_t now = 10000, due = 0;
+    uint32_t expected_gaps[] = { 6000, 7000, 9000, 13000, 13000 };
+    bool backoff = alert_outbox_take_due(&test_outbox, now, &entry) && entry.id == id;
+    alert_outbox_sent(&test_outbox, id, 100, now, 0);
+    for (int i = 0; i < 5 && backoff; i++) {
+        uint32_t next = now + expected_gaps[i];
+        backoff = !alert_outbox_take_due(&test_outbox, next - 1, &entry) &&
+                  alert_outbox_take_due(&test_outbox, next, &entry) && entry.id == id;
+        now = next;
+        alert_outbox_sent(&test_outbox, id, 101 + i, now, 0);
+    }
+    // A failed publish waits for the backoff too, then the PUBACK of the next one
+    bool failed = alert_outbox_take_due(&test_outbox, now + 13000, &entry) &&
+                  !alert_outbox_sent(&test_outbox, id, -1, now + 13000, 0) &&
+                  alert_outbox_next_due(&test_outbox, &due) && due == now + 13000 + 8000;
+    now += 21000;
+    uint32_t acked = 0, latency = 0;
+    bool stale = alert_outbox_take_due(&test_outbox, now, &entry) &&
+                 !alert_outbox_sent(&test_outbox, id, 200, now, 0) &&
+                 !alert_outbox_ack(&test_outbox, 103, now + 10, 0, &acked, &latency); // PUBACK of an earlier publish
+    bool delivered = alert_outbox_ack(&test_outbox, 200, now + 40, 0, &acked, &latency) && acked == id &&
+                     latency == now + 40 - 10000 && alert_outbox_count(&test_outbox) == 0 &&
+                     test_outbox.stats.delivered == 1 && test_outbox.stats.retries == 7 &&
+                     !alert_outbox_ack(&test_outbox, 200, now + 50, 0, NULL, NULL); // Duplicate PUBACK
+
+    if (backoff && failed && stale && delivered) {
+        ESP_LOGI(TAG_TEST_OUTBOX, "Test PASSED: Retried with a doubling backoff until its PUBACK, latency %u ms.",
+                 latency);
+    } else {
+        ESP_LOGE(TAG_TEST_OUTBOX, "Test FAILED: backoff %d, failed %d, stale %d, delivered %d (latency %u).",
+                 backoff, failed, stale, delivered, latency);
+    }
+}
+
+void test_alert_outbox_early_puback_and_reconnect() {
+    ESP_LOGI(TAG_TEST_OUTBOX, "Running test: test_alert_outbox_early_puback_and_reconnect");
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    AlertMessage a = test_alert(ALERT_TYPE_MODULE_OFFLINE, 500);
+    AlertMessage b = test_alert(ALERT_TYPE_FALL_DETECTED, 600);
+    uint32_t id_a = alert_outbox_push(&test_outbox, &a, 500, 0);
+    uint32_t id_b = alert_outbox_push(&test_outbox, &b, 600, 0);
+
+    // Oldest first; the PUBACK of `a` comes before its packet id is recorded
+    alert_outbox_entry_t first, second;
+    bool order = alert_outbox_take_due(&test_outbox, 700, &first) && first.id == id_a &&
+                 alert_outbox_take_due(&test_outbox, 700, &second) && second.id == id_b &&
+                 !alert_outbox_take_due(&test_outbox, 700, &first);
+    bool early = !alert_outbox_ack(&test_outbox, 7, 720, 0, NULL, NULL) &&
+                 alert_outbox_sent(&test_outbox, id_a, 7, 725, 0) && alert_outbox_count(&test_outbox) == 1 &&
+                 test_outbox.stats.latency_last_ms == 225;
+
+    // `b` in flight when the connection drops: published again at once on the new one
+    alert_outbox_sent(&test_outbox, id_b, 8, 730, 0);
+    alert_outbox_reset(&test_outbox, 2000);
+    uint32_t latency = 0;
+    bool reconnect = alert_outbox_take_due(&test_outbox, 2000, &second) && second.id == id_b &&
+                     !alert_outbox_ack(&test_outbox, 8, 2010, 0, NULL, NULL) && // Previous connection
+                     !alert_outbox_sent(&test_outbox, id_b, 1, 2020, 0) &&
+                     alert_outbox_ack(&test_outbox, 1, 2030, 0, NULL, &latency) && latency == 1430;
+
+    if (order && early && reconnect) {
+        ESP_LOGI(TAG_TEST_OUTBOX, "Test PASSED: Early PUBACK matched, in-flight alert published again on reconnect.");
+    } else {
+        ESP_LOGE(TAG_TEST_OUTBOX, "Test FAILED: order %d, early %d, reconnect %d (latency %u).", order, early,
+                 reconnect, latency);
+    }
+}
+
+void test_alert_outbox_full_ranked() {
+    ESP_LOGI(TAG_TEST_OUTBOX, "Running test: test_alert_outbox_full_ranked");
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    // 4 falls, 4 inactivity levels, 8 modules offline
+    uint32_t first_fall = 0, ids[ALERT_OUTBOX_CAPACITY];
+    for (uint32_t i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        AlertType type = i % 4 == 0 ? ALERT_TYPE_FALL_DETECTED
+                                    : (i % 4 == 1 ? ALERT_TYPE_INACTIVITY : ALERT_TYPE_MODULE_OFFLINE);
+        AlertMessage alert = test_alert(type, i);
+        ids[i] = alert_outbox_push(&test_outbox, &alert, i, 0);
+        first_fall = i == 0 ? ids[i] : first_fall;
+    }
+    // The broker is away: 10 more falls push the 8 offline alerts out, then the 2 oldest inactivity ones
+    for (uint32_t i = 0; i < 10; i++) {
+        AlertMessage alert = test_alert(ALERT_TYPE_FALL_DETECTED, 100 + i);
+        alert_outbox_push(&test_outbox, &alert, 100 + i, 0);
+    }
+    // Ranking below everything left: refused; same rank: the oldest of that rank goes
+    AlertMessage offline = test_alert(ALERT_TYPE_MODULE_OFFLINE, 200);
+    AlertMessage inactivity = test_alert(ALERT_TYPE_INACTIVITY, 210);
+    bool refused = alert_outbox_push(&test_outbox, &offline, 200, 0) == 0;
+    uint32_t id_inactivity = alert_outbox_push(&test_outbox, &inactivity, 210, 0);
+
+    int falls = 0, inactive = 0;
+    bool first_kept = false, newest_kept = false;
+    for (int i = 0; i < ALERT_OUTBOX_CAPACITY; i++) {
+        const alert_outbox_entry_t *e = &test_outbox.entries[i];
+        falls += e->alert.type == ALERT_TYPE_FALL_DETECTED;
+        inactive += e->alert.type == ALERT_TYPE_INACTIVITY;
+        first_kept = first_kept || e->id == first_fall;
+        newest_kept = newest_kept || e->id == ids[13]; // Youngest inactivity alert of the first round
+    }
+    bool informational = alert_outbox_rank(ALERT_TYPE_ZONE_ENTER) == 0 &&
+                         alert_outbox_rank(ALERT_TYPE_MODULE_ONLINE) == 0 &&
+                         alert_outbox_rank(ALERT_TYPE_INACTIVITY_CLEARED) == 0;
+    bool ok = refused && id_inactivity != 0 && falls == 14 && inactive == 2 && first_kept && newest_kept &&
+              test_outbox.stats.dropped == 12 && informational;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_OUTBOX, "Test PASSED: A full outbox drops the oldest alerts of the lowest rank, falls last.");
+    } else {
+        ESP_LOGE(TAG_TEST_OUTBOX, "Test FAILED: refused %d, %d falls, %d inactivity, first fall kept %d, newest "
+                 "inactivity kept %d, %u dropped, informational %d.", refused, falls, inactive, first_kept,
+                 newest_kept, test_outbox.stats.dropped, informational);
+    }
+}
+
+void test_alert_outbox_survives_reboot() {
+    ESP_LOGI(TAG_TEST_OUTBOX, "Running test: test_alert_outbox_survives_reboot");
+    static uint8_t blob[ALERT_OUTBOX_BLOB_MAX];
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    AlertMessage fall = test_alert(ALERT_TYPE_FALL_DETECTED, 3000);
+    AlertMessage offline = test_alert(ALERT_TYPE_MODULE_OFFLINE, 3100);
+    uint32_t id_fall = alert_outbox_push(&test_outbox, &fall, 3000, 1750000000);
+    uint32_t id_offline = alert_outbox_push(&test_outbox, &offline, 3100, 0); // Clock not set yet
+    alert_outbox_entry_t entry;
+    alert_outbox_take_due(&test_outbox, 3200, &entry);
+    alert_outbox_sent(&test_outbox, entry.id, 5, 3200, 0);       // In flight when the power goes
+    size_t len = alert_outbox_save(&test_outbox, blob, sizeof(blob));
+    bool saved = len == 12 + 2 * 28 && !test_outbox.dirty;
+
+    // Next boot: both due at once, the fall republished under the same id
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    bool loaded = alert_outbox_load(&test_outbox, blob, len, 40) && alert_outbox_count(&test_outbox) == 2 &&
+                  test_outbox.boot == 2 && test_outbox.stats.restored == 2;
+    uint32_t latency = 0, acked = 0;
+    bool republished = alert_outbox_take_due(&test_outbox, 40, &entry) && entry.id == id_fall &&
+                       !alert_outbox_sent(&test_outbox, entry.id, 1, 40, 1750000090) &&
+                       alert_outbox_ack(&test_outbox, 1, 50, 1750000090, &acked, &latency) && acked == id_fall &&
+                       latency == 90000;
+    bool unknown = alert_outbox_take_due(&test_outbox, 60, &entry) && entry.id == id_offline &&
+                   !alert_outbox_sent(&test_outbox, entry.id, 2, 60, 1750000090) &&
+                   alert_outbox_ack(&test_outbox, 2, 70, 1750000090, NULL, &latency) &&
+                   latency == ALERT_OUTBOX_LATENCY_UNKNOWN && test_outbox.stats.latency_count == 1;
+    // Ids go on from the saved counter: a subscriber never sees an id twice for two alerts
+    AlertMessage next = test_alert(ALERT_TYPE_FALL_DETECTED, 80);
+    bool fresh_id = alert_outbox_push(&test_outbox, &next, 80, 0) == id_offline + 1;
+
+    // Corrupt or truncated blobs leave the outbox empty
+    blob[0] ^= 0xFF;
+    alert_outbox_init(&test_outbox, &test_outbox_config);
+    bool rejected = !alert_outbox_load(&test_outbox, blob, len, 0) && alert_outbox_count(&test_outbox) == 0;
+    blob[0] ^= 0xFF;
+    rejected = rejected && !alert_outbox_load(&test_outbox, blob, len - 1, 0) &&
+               alert_outbox_count(&test_outbox) == 0 && test_outbox.next_id == 1;
+
+    if (saved && loaded && republished && unknown && fresh_id && rejected) {
+        ESP_LOGI(TAG_TEST_OUTBOX, "Test PASSED: Alerts and ids restored after a reboot, latency from the wall clock.");
+    } else {
+        ESP_LOGE(TAG_TEST_OUTBOX, "Test FAILED: saved %d (%u B), loaded %d, republished %d (latency %u), unknown %d, "
+                 "fresh id %d, rejected %d.", saved, (unsigned)len, loaded, republished, latency, unknown, fresh_id,
+                 rejected);
+    }
+}
+
+void run_alert_outbox_tests() {
+    ESP_LOGI(TAG_TEST_OUTBOX, "--- Starting Alert Outbox Tests ---");
+    test_alert_outbox_retry_until_puback();
+    test_alert_outbox_early_puback_and_reconnect();
+    test_alert_outbox_full_ranked();
+    test_alert_outbox_survives_reboot();
+    ESP_LOGI(TAG_TEST_OUTBOX, "--- Finished Alert Outbox Tests ---");
+}
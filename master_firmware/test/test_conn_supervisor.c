@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "conn_supervisor.h"
+
+// --- BEGIN NOTE ---
+// Unlike the other master tests, conn_supervisor is a real, non-static module
+// (components/hlk_common) with no ESP-IDF dependency, so these tests drive the
+// actual implementation instead of a copy of it. Time is simulated by passing
+// explicit timestamps. Assertions are still reported through ESP_LOGI/ESP_LOGE.
+// --- END NOTE ---
+
+static const char *TAG_TEST_CONN = "TEST_CONN_SUPERVISOR";
+
+static const char *const test_brokers[] = { "mqtts://10.0.0.1:8883", "mqtt://10.0.0.2" };
+
+static uint32_t feed(conn_supervisor_t *sup, conn_event_id_t id, uint32_t now_ms) {
+    conn_event_t event = { .id = id, .broker_index = 0 };
+    return conn_supervisor_handle(sup, &event, now_ms);
+}
+
+static void bring_online(conn_supervisor_t *sup, uint32_t now_ms) {
+    feed(sup, CONN_EVT_START, now_ms);
+    feed(sup, CONN_EVT_WIFI_CONNECTED, now_ms);
+    feed(sup, CONN_EVT_GOT_IP, now_ms);
+    feed(sup, CONN_EVT_MQTT_CONNECTED, now_ms);
+}
+
+void test_conn_nominal_startup() {
+    ESP_LOGI(TAG_TEST_CONN, "Running test: test_conn_nominal_startup");
+    conn_supervisor_t sup;
+    conn_supervisor_config_t cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&sup, &cfg, test_brokers, 2, 1234);
+
+    uint32_t a1 = feed(&sup, CONN_EVT_START, 0);
+    uint32_t a2 = feed(&sup, CONN_EVT_WIFI_CONNECTED, 100);
+    uint32_t a3 = feed(&sup, CONN_EVT_GOT_IP, 200);
+    uint32_t a4 = feed(&sup, CONN_EVT_MQTT_CONNECTED, 300);
+
+    if (a1 == CONN_ACT_WIFI_CONNECT && a2 == CONN_ACT_NONE && a3 == CONN_ACT_MQTT_START &&
+        a4 == CONN_ACT_NOTIFY_ONLINE && conn_supervisor_is_online(&sup) &&
+        conn_supervisor_ms_until_deadline(&sup, 300) == CONN_NO_DEADLINE && sup.stats.outage_count == 0) {
+        ESP_LOGI(TAG_TEST_CONN, "Test PASSED: START -> WIFI -> IP -> MQTT reaches ONLINE without outage.");
+    } else {
+        ESP_LOGE(TAG_TEST_CONN, "Test FAILED: Unexpected startup sequence (state %s).", conn_state_name(sup.state));
+    }
+}
+
+void test_conn_wifi_never_gives_up() {
+    ESP_LOGI(TAG_TEST_CONN, "Running test: test_conn_wifi_never_gives_up");
+    conn_supervisor_t sup;
+    conn_supervisor_config_t cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&sup, &cfg, test_brokers, 2, 42);
+
+    uint32_t now = 0;
+    bool always_retried = true;
+    uint32_t previous_delay = 0;
+    bool delays_grow_until_cap = true;
+    feed(&sup, CONN_EVT_START, now);
+    for (int i = 0; i < 20; i++) { // Far more than the old MASTER_ESP_MAXIMUM_RETRY (5)
+        feed(&sup, CONN_EVT_WIFI_DISCONNECTED, now);
+        uint32_t delay = conn_supervisor_ms_until_deadline(&sup, now);
+        if (delay == CONN_NO_DEADLINE || delay > cfg.backoff_cap_ms) {
+            always_retried = false;
+            break;
+        }
+        // Equal jitter: the delay is at least half of the exponential step.
+        uint32_t step = cfg.backoff_base_ms << (i < 16 ? i : 16);
+        if (step > cfg.backoff_cap_ms) step = cfg.backoff_cap_ms;
+        if (delay < step / 2) delays_grow_until_cap = false;
+        previous_delay = delay;
+        now += delay;
+        if ((feed(&sup, CONN_EVT_TIMEOUT, now) & CONN_ACT_WIFI_CONNECT) == 0) {
+            always_retried = false;
+            break;
+        }
+    }
+
+    if (always_retried && delays_grow_until_cap && previous_delay >= cfg.backoff_cap_ms / 2) {
+        ESP_LOGI(TAG_TEST_CONN, "Test PASSED: Wi-Fi retried 20 times with capped jittered backoff (last %u ms).", previous_delay);
+    } else {
+        ESP_LOGE(TAG_TEST_CONN, "Test FAILED: Wi-Fi retry/backoff policy incorrect.");
+    }
+}
+
+void test_conn_broker_failover_and_outage_stats() {
+    ESP_LOGI(TAG_TEST_CONN, "Running test: test_conn_broker_failover_and_outage_stats");
+    conn_supervisor_t sup;
+    conn_supervisor_config_t cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&sup, &cfg, test_brokers, 2, 7);
+    bring_online(&sup, 0);
+
+    // Broker 0 drops: first failure backs off, second failure fails over immediately.
+    uint32_t a1 = feed(&sup, CONN_EVT_MQTT_DISCONNECTED, 1000);
+    uint32_t now = 1000 + conn_supervisor_ms_until_deadline(&sup, 1000);
+    uint32_t a2 = feed(&sup, CONN_EVT_TIMEOUT, now);                 // Retry broker 0
+    uint32_t a3 = feed(&sup, CONN_EVT_MQTT_ERROR, now + 50);         // Fails again -> failover
+    uint32_t a4 = feed(&sup, CONN_EVT_MQTT_CONNECTED, now + 300);    // Broker 1 accepts
+
+    bool ok = (a1 & CONN_ACT_NOTIFY_OFFLINE) && (a2 & CONN_ACT_MQTT_START) &&
+              (a3 & CONN_ACT_MQTT_STOP) && (a3 & CONN_ACT_MQTT_START) && (a4 & CONN_ACT_NOTIFY_ONLINE) &&
+              sup.active_broker == 1 && sup.stats.failovers == 1 && sup.stats.outage_count == 1 &&
+              sup.stats.last_outage_ms == (now + 300) - 1000;
+
+    // On the fallback broker a probe of broker 0 is scheduled; a successful probe fails back.
+    uint32_t probe_at = now + 300 + conn_supervisor_ms_until_deadline(&sup, now + 300);
+    uint32_t a5 = feed(&sup, CONN_EVT_TIMEOUT, probe_at);
+    conn_event_t probe_ok = { .id = CONN_EVT_PROBE_OK, .broker_index = sup.probe_broker };
+    uint32_t a6 = conn_supervisor_handle(&sup, &probe_ok, probe_at + 10);
+    ok = ok && (a5 & CONN_ACT_PROBE_BROKER) && sup.active_broker == 0 &&
+         (a6 & CONN_ACT_MQTT_STOP) && (a6 & CONN_ACT_MQTT_START);
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_CONN, "Test PASSED: Failover to broker 1, outage of %u ms recorded, failback after probe.",
+                 sup.stats.last_outage_ms);
+    } else {
+        ESP_LOGE(TAG_TEST_CONN, "Test FAILED: Broker failover/failback sequence incorrect (active=%u).", sup.active_broker);
+    }
+}
+
+void test_conn_parse_broker_uri() {
+    ESP_LOGI(TAG_TEST_CONN, "Running test: test_conn_parse_broker_uri");
+    char host[32];
+    uint16_t port1 = 0, port2 = 0;
+    bool r1 = conn_parse_broker_uri("mqtts://192.168.1.100:8883", host, sizeof(host), &port1);
+    bool host_ok = strcmp(host, "192.168.1.100") == 0;
+    bool r2 = conn_parse_broker_uri("mqtt://broker.local/path", host, sizeof(host), &port2);
+
+    if (r1 && host_ok && port1 == 8883 && r2 && strcmp(host, "broker.local") == 0 && port2 == 1883) {
+        ESP_LOGI(TAG_TEST_CONN, "Test PASSED: Broker URIs parsed with explicit and default ports.");
+    } else {
+        ESP_LOGE(TAG_TEST_CONN, "Test FAILED: Broker URI parsing incorrect.");
+    }
+}
+
+void test_conn_network_only_mode() {
+    ESP_LOGI(TAG_TEST_CONN, "Running test: test_conn_network_only_mode");
+    conn_supervisor_t sup;
+    conn_supervisor_config_t cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&sup, &cfg, NULL, 0, 99);
+
+    feed(&sup, CONN_EVT_START, 0);
+    feed(&sup, CONN_EVT_WIFI_CONNECTED, 100);
+    uint32_t a1 = feed(&sup, CONN_EVT_GOT_IP, 200);
+    bool online = conn_supervisor_is_online(&sup);
+    uint32_t a2 = feed(&sup, CONN_EVT_LOST_IP, 5000);
+    uint32_t a3 = feed(&sup, CONN_EVT_GOT_IP, 5400);
+
+    if (a1 == CONN_ACT_NOTIFY_ONLINE && online && a2 == CONN_ACT_NOTIFY_OFFLINE &&
+        a3 == CONN_ACT_NOTIFY_ONLINE && sup.stats.outage_count == 1 && sup.stats.last_outage_ms == 400) {
+        ESP_LOGI(TAG_TEST_CONN, "Test PASSED: Without brokers, IP alone brings the supervisor ONLINE.");
+    } else {
+        ESP_LOGE(TAG_TEST_CONN, "Test FAILED: Network-only mode incorrect (state %s).", conn_state_name(sup.state));
+    }
+}
+
+void run_conn_supervisor_tests() {
+    ESP_LOGI(TAG_TEST_CONN, "--- Starting Connection Supervisor Tests ---");
+    test_conn_nominal_startup();
+    test_conn_wifi_never_gives_up();
+    test_conn_broker_failover_and_outage_stats();
+    test_conn_parse_broker_uri();
+    test_conn_network_only_mode();
+    ESP_LOGI(TAG_TEST_CONN, "--- Finished Connection Supervisor Tests ---");
+}
@@ -3,141 +3,109 @@
 #include <stdbool.h>
 #include <stdint.h> // For uint32_t
 #include "esp_log.h"
+#include "pipeline_msgs.h" // FusedData, AlertMessage, radar_posture_t (shared with main.c)
+#include "fall_rules.h"    // The rule table of FallDetector_task
 
-// --- BEGIN LIMITATION NOTE ---
-// This test file provides a THEORETICAL structure for unit testing FallDetector_task.
-// Due to sandbox limitations:
-// 1. This code will NOT be compiled or run.
-// 2. The FallDetector_task logic (which is static in main.c) is not directly callable.
-//    A simplified simulation of its state machine is implemented here for test demonstration.
-// 3. FreeRTOS queues (fusion_output_queue, alert_queue) are conceptually simulated.
-//    Test functions will mimic sending/receiving from these queues by calling a simulated
-//    processing function or checking expected outputs.
-// 4. Assertions are simulated using ESP_LOGI/ESP_LOGE.
-//
-// For real tests, FallDetector_task's core logic would need to be refactored into
-// testable units (non-static functions), and a test framework (Unity) would be used.
-// --- END LIMITATION NOTE ---
+// --- BEGIN NOTE ---
+// FallDetector_task (main.c) runs the fall_rules.c table on the fsm_engine.c
+// engine, both plain C: these tests feed the same table, one fsm_engine
+// instance per person, and stand in for the task only to build the alert
+// (fall_apply_action() in main.c). FreeRTOS queues are not involved.
+// --- END NOTE ---
 
 static const char *TAG_TEST_FALL = "TEST_FALL_DETECTOR";
 
-// Definitions copied/adapted from main.c
-typedef struct {
-    float x, y;
-    char final_posture[16];
-    uint32_t timestamp;
-} FusedData;
-
-typedef enum { 
-    ALERT_TYPE_FALL_DETECTED, 
-    ALERT_TYPE_MODULE_OFFLINE 
-    // ALERT_TYPE_MODULE_ONLINE (if added)
-} AlertType;
-
-typedef struct {
-    AlertType type;
-    char description[64];
-    uint32_t alert_timestamp;
-} AlertMessage;
-
-#define STANDING_POSTURE "STANDING"
-#define SITTING_POSTURE  "SITTING"
-#define LYING_POSTURE    "LYING"
-#define MOVING_POSTURE   "MOVING"
-#define STILL_POSTURE    "STILL"
-
-#define FALL_TRANSITION_MAX_MS 1000
-#define LYING_CONFIRMATION_DURATION_S 20
-
-// Simulated state for the FallDetector logic
-static FusedData fd_previous_data;
-static bool fd_previous_data_valid = false;
-static uint32_t fd_potential_fall_start_time_ms = 0;
-static bool fd_in_potential_fall_state = false;
+// Simulated state of one person of the FallDetector task
+static fsm_instance_t fd_fsm;
+static fall_features_t fd_features;
 static AlertMessage fd_generated_alert; // To store any generated alert
 static bool fd_alert_generated_flag = false;
+static uint8_t fd_last_action = FALL_ACTION_NONE;
+static zone_fall_policy_t fd_zone_policy = ZONE_FALL_NORMAL; // Zone the person is in, as zone_engine_fall_policy()
 
-// Simulates processing one FusedData input by the FallDetector_task logic
+static void fd_handle_action(fsm_instance_t *inst, uint8_t action, uint32_t now_ms, const FusedData *data) {
+    fd_last_action = action;
+    if (action == FALL_ACTION_CONFIRM) {
+        ESP_LOGI(TAG_TEST_FALL, "Sim: CHUTE CONFIRMÉE! Track %u at %u ms", inst->user, now_ms);
+        fd_generated_alert.type = ALERT_TYPE_FALL_DETECTED;
+        fd_generated_alert.alert_timestamp = now_ms;
+        fd_generated_alert.x_mm = data ? data->x_mm : 0;
+        fd_generated_alert.y_mm = data ? data->y_mm : 0;
+        fd_alert_generated_flag = true;
+    }
+}
+
+// Processes one FusedData input as the FallDetector_task does
 void simulate_fall_detector_processing(FusedData current_data) {
-    ESP_LOGD(TAG_TEST_FALL, "Simulating processing: TS=%u, Posture=%s", current_data.timestamp, current_data.final_posture);
+    ESP_LOGD(TAG_TEST_FALL, "Simulating processing: TS=%u, Posture=%s", current_data.timestamp,
+             radar_posture_name((radar_posture_t)current_data.posture));
     fd_alert_generated_flag = false; // Reset before processing
+    fall_feature_values_t features;
+    fall_features_add(&fd_features, &current_data);
+    fall_features_get(&fd_features, current_data.timestamp, &features);
+    fsm_event_t event = fall_event_from(&current_data, &features, fd_zone_policy);
+    uint8_t action = fsm_dispatch(fall_rules_table(), &fd_fsm, &event);
+    fd_handle_action(&fd_fsm, action, current_data.timestamp, &current_data);
+}
 
-    if (fd_previous_data_valid) {
-        bool was_upright_or_moving = (strcmp(fd_previous_data.final_posture, STANDING_POSTURE) == 0) ||
-                                     (strcmp(fd_previous_data.final_posture, SITTING_POSTURE) == 0)  ||
-                                     (strcmp(fd_previous_data.final_posture, MOVING_POSTURE) == 0)   ||
-                                     (strcmp(fd_previous_data.final_posture, STILL_POSTURE) == 0); 
-                           
-        if (was_upright_or_moving && strcmp(current_data.final_posture, LYING_POSTURE) == 0) {
-            uint32_t transition_time_ms = current_data.timestamp - fd_previous_data.timestamp;
-            if (transition_time_ms < FALL_TRANSITION_MAX_MS) {
-                ESP_LOGI(TAG_TEST_FALL, "Sim: Potential fall detected! Transition: %u ms", transition_time_ms);
-                fd_in_potential_fall_state = true;
-                fd_potential_fall_start_time_ms = current_data.timestamp; 
-            }
-        }
-    }
+// Timer tick of the FallDetector_task, no output received
+static void simulate_fall_detector_tick(uint32_t now_ms) {
+    fd_alert_generated_flag = false;
+    fd_handle_action(&fd_fsm, fsm_tick(fall_rules_table(), &fd_fsm, now_ms, fd_zone_policy), now_ms, NULL);
+}
 
-    if (fd_in_potential_fall_state) {
-        if (strcmp(current_data.final_posture, LYING_POSTURE) == 0) {
-            uint32_t lying_duration_ms = current_data.timestamp - fd_potential_fall_start_time_ms;
-            if (lying_duration_ms >= (LYING_CONFIRMATION_DURATION_S * 1000)) {
-                ESP_LOGI(TAG_TEST_FALL, "Sim: CHUTE CONFIRMÉE! Duration: %u ms", lying_duration_ms);
-                
-                fd_generated_alert.type = ALERT_TYPE_FALL_DETECTED;
-                fd_generated_alert.alert_timestamp = current_data.timestamp;
-                snprintf(fd_generated_alert.description, sizeof(fd_generated_alert.description), 
-                         "Chute détectée à %lu (Pos: %.2f,%.2f)", 
-                         (unsigned long)current_data.timestamp, current_data.x, current_data.y);
-                fd_alert_generated_flag = true;
-                
-                fd_in_potential_fall_state = false;
-                fd_potential_fall_start_time_ms = 0;
-            }
-        } else { 
-            ESP_LOGI(TAG_TEST_FALL, "Sim: Potential fall cancelled. No longer LYING. Posture: %s", current_data.final_posture);
-            fd_in_potential_fall_state = false;
-            fd_potential_fall_start_time_ms = 0;
-        }
-    }
-    
-    fd_previous_data = current_data;
-    fd_previous_data_valid = true;
+static bool fd_in_potential_fall_state(void) {
+    return fd_fsm.state == FALL_STATE_SUSPECTED;
 }
 
 void reset_fall_detector_state() {
-    fd_previous_data_valid = false;
-    fd_potential_fall_start_time_ms = 0;
-    fd_in_potential_fall_state = false;
+    fsm_instance_init(&fd_fsm, FALL_STATE_WATCHING, 0);
+    fall_features_init(&fd_features);
     fd_alert_generated_flag = false;
-    memset(&fd_previous_data, 0, sizeof(FusedData));
+    fd_last_action = FALL_ACTION_NONE;
+    fd_zone_policy = ZONE_FALL_NORMAL;
     memset(&fd_generated_alert, 0, sizeof(AlertMessage));
 }
 
+void test_fall_rules_table_valid() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_rules_table_valid");
+    bool valid = fall_rules_init(); // As app_main, before any FallDetector task
+    const fsm_table_t *table = fall_rules_table();
+    if (valid && table->rule_count > 0 && table->state_count == FALL_STATE_COUNT && sizeof(fsm_instance_t) <= 12) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: %u rules over %u states, %u bytes per person.", table->rule_count,
+                 table->state_count, (unsigned)sizeof(fsm_instance_t));
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: rule table rejected (%u rules, %u states) or instance of %u bytes.",
+                 table->rule_count, table->state_count, (unsigned)sizeof(fsm_instance_t));
+    }
+}
+
 void test_fall_detection_confirmed() {
     ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_detection_confirmed");
     reset_fall_detector_state();
     uint32_t time_ms = 100000; // Starting timestamp
 
-    FusedData data_standing = { .x=1.0, .y=1.0, .final_posture=STANDING_POSTURE, .timestamp=time_ms };
+    FusedData data_standing = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_standing);
-    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d", fd_previous_data_valid, fd_in_potential_fall_state);
+    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d", fd_fsm.has_event, fd_in_potential_fall_state());
 
 
     time_ms += (FALL_TRANSITION_MAX_MS / 2); // Rapid transition
-    FusedData data_lying_quick = { .x=1.0, .y=1.0, .final_posture=LYING_POSTURE, .timestamp=time_ms };
+    FusedData data_lying_quick = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_LYING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_lying_quick);
-    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d, potential_ts=%u", fd_previous_data_valid, fd_in_potential_fall_state, fd_potential_fall_start_time_ms);
+    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d, potential_ts=%u", fd_fsm.has_event, fd_in_potential_fall_state(), fd_fsm.entered_ms);
 
 
     time_ms += (LYING_CONFIRMATION_DURATION_S * 1000) + 100; // Maintain lying for confirmation period
-    FusedData data_lying_confirmed = { .x=1.0, .y=1.0, .final_posture=LYING_POSTURE, .timestamp=time_ms };
+    FusedData data_lying_confirmed = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_LYING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_lying_confirmed);
-    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d, alert_gen=%d", fd_previous_data_valid, fd_in_potential_fall_state, fd_alert_generated_flag);
+    ESP_LOGI(TAG_TEST_FALL, "State: prev_valid=%d, potential_fall=%d, alert_gen=%d", fd_fsm.has_event, fd_in_potential_fall_state(), fd_alert_generated_flag);
 
 
+    char description[64];
+    alert_describe(&fd_generated_alert, description, sizeof(description));
     if (fd_alert_generated_flag && fd_generated_alert.type == ALERT_TYPE_FALL_DETECTED) {
-        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Fall alert correctly generated. Desc: %s", fd_generated_alert.description);
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Fall alert correctly generated. Desc: %s", description);
     } else {
         ESP_LOGE(TAG_TEST_FALL, "Test FAILED: Fall alert not generated or incorrect type.");
     }
@@ -149,24 +117,24 @@ void test_fall_detection_cancelled() {
     reset_fall_detector_state();
     uint32_t time_ms = 200000;
 
-    FusedData data_standing1 = { .x=1.0, .y=1.0, .final_posture=STANDING_POSTURE, .timestamp=time_ms };
+    FusedData data_standing1 = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_standing1);
 
     time_ms += (FALL_TRANSITION_MAX_MS / 2);
-    FusedData data_lying_temp = { .x=1.0, .y=1.0, .final_posture=LYING_POSTURE, .timestamp=time_ms };
+    FusedData data_lying_temp = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_LYING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_lying_temp);
-    ESP_LOGI(TAG_TEST_FALL, "State after LYING: potential_fall=%d, potential_ts=%u", fd_in_potential_fall_state, fd_potential_fall_start_time_ms);
+    ESP_LOGI(TAG_TEST_FALL, "State after LYING: potential_fall=%d, potential_ts=%u", fd_in_potential_fall_state(), fd_fsm.entered_ms);
 
 
     time_ms += 1000; // Short duration, not enough for confirmation
-    FusedData data_standing2 = { .x=1.0, .y=1.0, .final_posture=STANDING_POSTURE, .timestamp=time_ms };
+    FusedData data_standing2 = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_standing2);
-    ESP_LOGI(TAG_TEST_FALL, "State after STANDING again: potential_fall=%d, alert_gen=%d", fd_in_potential_fall_state, fd_alert_generated_flag);
+    ESP_LOGI(TAG_TEST_FALL, "State after STANDING again: potential_fall=%d, alert_gen=%d", fd_in_potential_fall_state(), fd_alert_generated_flag);
 
-    if (!fd_alert_generated_flag && !fd_in_potential_fall_state) {
+    if (!fd_alert_generated_flag && !fd_in_potential_fall_state()) {
         ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Potential fall correctly cancelled, no alert generated.");
     } else {
-        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: Alert generated or potential fall state not reset. Alert: %d, Potential: %d", fd_alert_generated_flag, fd_in_potential_fall_state);
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: Alert generated or potential fall state not reset. Alert: %d, Potential: %d", fd_alert_generated_flag, fd_in_potential_fall_state());
     }
     reset_fall_detector_state();
 }
@@ -176,26 +144,240 @@ void test_slow_to_lying_no_fall() {
     reset_fall_detector_state();
     uint32_t time_ms = 300000;
 
-    FusedData data_standing = { .x=1.0, .y=1.0, .final_posture=STANDING_POSTURE, .timestamp=time_ms };
+    FusedData data_standing = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_standing);
 
     time_ms += FALL_TRANSITION_MAX_MS + 500; // Transition > FALL_TRANSITION_MAX_MS
-    FusedData data_lying_slow = { .x=1.0, .y=1.0, .final_posture=LYING_POSTURE, .timestamp=time_ms };
+    FusedData data_lying_slow = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_LYING, .timestamp=time_ms };
     simulate_fall_detector_processing(data_lying_slow);
-    ESP_LOGI(TAG_TEST_FALL, "State after slow LYING: potential_fall=%d, alert_gen=%d", fd_in_potential_fall_state, fd_alert_generated_flag);
+    ESP_LOGI(TAG_TEST_FALL, "State after slow LYING: potential_fall=%d, alert_gen=%d", fd_in_potential_fall_state(), fd_alert_generated_flag);
 
-    if (!fd_alert_generated_flag && !fd_in_potential_fall_state) {
+    if (!fd_alert_generated_flag && !fd_in_potential_fall_state()) {
         ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Slow transition to lying did not trigger potential fall state.");
     } else {
-        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: Slow transition incorrectly triggered potential fall. Alert: %d, Potential: %d", fd_alert_generated_flag, fd_in_potential_fall_state);
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: Slow transition incorrectly triggered potential fall. Alert: %d, Potential: %d", fd_alert_generated_flag, fd_in_potential_fall_state());
+    }
+    reset_fall_detector_state();
+}
+
+void test_fall_confirmed_by_timer() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_confirmed_by_timer");
+    reset_fall_detector_state();
+    uint32_t time_ms = 400000;
+
+    FusedData data_moving = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_MOVING, .timestamp=time_ms };
+    simulate_fall_detector_processing(data_moving);
+    time_ms += 300;
+    FusedData data_lying = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_LYING, .timestamp=time_ms };
+    simulate_fall_detector_processing(data_lying);
+
+    // The track goes quiet (motionless person): only the 1 s ticks of the task
+    int alerts = 0;
+    uint32_t alert_ms = 0;
+    for (uint32_t t = time_ms + 1000; t <= time_ms + 30000; t += 1000) {
+        simulate_fall_detector_tick(t);
+        if (fd_alert_generated_flag) {
+            alerts++;
+            alert_ms = t - time_ms;
+        }
+    }
+
+    if (alerts == 1 && alert_ms == LYING_CONFIRMATION_DURATION_S * 1000 && fd_fsm.state == FALL_STATE_CONFIRMED) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Fall confirmed by the timer %u ms after the transition, once.", alert_ms);
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: %d alerts, last after %u ms, state %s.", alerts, alert_ms,
+                 fall_state_name(fd_fsm.state));
+    }
+    reset_fall_detector_state();
+}
+
+void test_fall_cancelled_by_speed() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_cancelled_by_speed");
+    reset_fall_detector_state();
+    uint32_t time_ms = 500000;
+
+    FusedData data = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
+    simulate_fall_detector_processing(data);
+    // Fast drop: the fall itself moves quickly, not a reason to cancel
+    data.posture = RADAR_POSTURE_LYING;
+    for (int i = 0; i < 5; i++) {
+        data.timestamp = (time_ms += 200);
+        data.x_mm += 300;
+        simulate_fall_detector_processing(data);
+    }
+    bool armed = fd_in_potential_fall_state();
+    // Still reported LYING, but walking away at 1.25 m/s: a posture error
+    uint32_t cancelled_after_ms = 0;
+    uint16_t speed = 0;
+    for (int i = 0; i < 20 && fd_in_potential_fall_state(); i++) {
+        data.timestamp = (time_ms += 200);
+        data.x_mm += 250;
+        simulate_fall_detector_processing(data);
+        cancelled_after_ms = time_ms - 500000;
+        fall_feature_values_t features;
+        fall_features_get(&fd_features, time_ms, &features);
+        speed = features.speed_mm_s;
+    }
+
+    if (armed && !fd_in_potential_fall_state() && fd_last_action == FALL_ACTION_CANCEL && !fd_alert_generated_flag &&
+        cancelled_after_ms >= FALL_CANCEL_AFTER_MS) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Potential fall kept through the drop, cancelled after %u ms when moving at %u mm/s.",
+                 cancelled_after_ms, speed);
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: armed %d, state %s, last action %u after %u ms.", armed,
+                 fall_state_name(fd_fsm.state), fd_last_action, cancelled_after_ms);
+    }
+    reset_fall_detector_state();
+}
+
+void test_fall_across_glitch() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_across_glitch");
+    reset_fall_detector_state();
+    uint32_t time_ms = 600000;
+
+    // Standing, one output without posture (no vote), then LYING: the previous
+    // output is not upright, the peak descent over the window still is a fall
+    FusedData data = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_UNKNOWN;
+    data.timestamp = (time_ms += 300);
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_LYING;
+    data.timestamp = (time_ms += 300);
+    simulate_fall_detector_processing(data);
+    bool armed = fd_in_potential_fall_state() && fd_last_action == FALL_ACTION_SUSPECT;
+
+    // Same sequence spread over 4 s: a slow lying down
+    reset_fall_detector_state();
+    data.posture = RADAR_POSTURE_STANDING;
+    data.timestamp = (time_ms += 10000);
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_UNKNOWN;
+    data.timestamp = (time_ms += 2000);
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_LYING;
+    data.timestamp = (time_ms += 2000);
+    simulate_fall_detector_processing(data);
+    bool slow_ignored = !fd_in_potential_fall_state();
+
+    if (armed && slow_ignored) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Fall detected across a glitch frame, slow lying down still ignored.");
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: armed %d, slow lying ignored %d.", armed, slow_ignored);
+    }
+    reset_fall_detector_state();
+}
+
+void test_fall_instances_independent() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_instances_independent");
+    const fsm_table_t *table = fall_rules_table();
+    // Two people of one room, outputs interleaved: track 1 falls, track 2 sits down slowly
+    fsm_instance_t people[2];
+    int confirms[2] = { 0, 0 };
+    for (int k = 0; k < 2; k++) {
+        fsm_instance_init(&people[k], FALL_STATE_WATCHING, 0);
+        people[k].user = (uint8_t)(k + 1);
+    }
+    for (uint32_t t = 0; t <= 30000; t += 100) {
+        for (int k = 0; k < 2; k++) {
+            fsm_event_t event = { .now_ms = t + (uint32_t)k * 50, .speed_mm_s = 0 };
+            if (k == 0) {
+                event.posture = t < 1000 ? RADAR_POSTURE_STANDING : RADAR_POSTURE_LYING;
+            } else {
+                // Upright, a gap in the outputs, then lying: too slow for a fall
+                if (t >= 1000 && t < 3000) {
+                    continue;
+                }
+                event.posture = t < 1000 ? RADAR_POSTURE_SITTING : RADAR_POSTURE_LYING;
+            }
+            confirms[k] += fsm_dispatch(table, &people[k], &event) == FALL_ACTION_CONFIRM;
+        }
+    }
+
+    if (confirms[0] == 1 && confirms[1] == 0 && people[0].state == FALL_STATE_CONFIRMED &&
+        people[1].state == FALL_STATE_WATCHING) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: Track 1 fall confirmed, slow lying of track 2 ignored.");
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: confirmations %d/%d, states %s/%s.", confirms[0], confirms[1],
+                 fall_state_name(people[0].state), fall_state_name(people[1].state));
+    }
+}
+
+// Quiet track after a fast fall at `time_ms`: ticks for 30 s, returns the
+// alerts and the delay of the last one
+static int ticks_after_fall(uint32_t time_ms, uint32_t *alert_ms) {
+    int alerts = 0;
+    for (uint32_t t = time_ms + 1000; t <= time_ms + 30000; t += 1000) {
+        simulate_fall_detector_tick(t);
+        if (fd_alert_generated_flag) {
+            alerts++;
+            *alert_ms = t - time_ms;
+        }
+    }
+    return alerts;
+}
+
+void test_fall_zone_policy() {
+    ESP_LOGI(TAG_TEST_FALL, "Running test: test_fall_zone_policy");
+    uint32_t time_ms = 700000, alert_ms = 0;
+
+    // SUPPRESS (a bed): fast lying down arms nothing, no alert however long
+    reset_fall_detector_state();
+    fd_zone_policy = ZONE_FALL_SUPPRESS;
+    FusedData data = { .x_mm=1000, .y_mm=1000, .posture=RADAR_POSTURE_STANDING, .timestamp=time_ms };
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_LYING;
+    data.timestamp = (time_ms += 300);
+    simulate_fall_detector_processing(data);
+    bool not_armed = !fd_in_potential_fall_state() && fd_last_action == FALL_ACTION_SUPPRESSED;
+    bool suppressed = not_armed && ticks_after_fall(time_ms, &alert_ms) == 0;
+
+    // Suspected fall, then the track ends up in the zone: dropped on the next tick
+    reset_fall_detector_state();
+    data.posture = RADAR_POSTURE_STANDING;
+    data.timestamp = (time_ms += 60000);
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_LYING;
+    data.timestamp = (time_ms += 300);
+    simulate_fall_detector_processing(data);
+    bool armed = fd_in_potential_fall_state();
+    fd_zone_policy = ZONE_FALL_SUPPRESS;
+    simulate_fall_detector_tick(time_ms + 1000);
+    bool dropped = armed && fd_fsm.state == FALL_STATE_WATCHING && fd_last_action == FALL_ACTION_SUPPRESSED &&
+                   ticks_after_fall(time_ms, &alert_ms) == 0;
+
+    // ESCALATE (a shower): confirmed by the timer after ZONE_ESCALATED_CONFIRM_MS
+    reset_fall_detector_state();
+    fd_zone_policy = ZONE_FALL_ESCALATE;
+    data.posture = RADAR_POSTURE_STANDING;
+    data.timestamp = (time_ms += 60000);
+    simulate_fall_detector_processing(data);
+    data.posture = RADAR_POSTURE_LYING;
+    data.timestamp = (time_ms += 300);
+    simulate_fall_detector_processing(data);
+    int alerts = ticks_after_fall(time_ms, &alert_ms);
+    bool escalated = alerts == 1 && alert_ms == ZONE_ESCALATED_CONFIRM_MS && fd_fsm.state == FALL_STATE_CONFIRMED;
+
+    if (suppressed && dropped && escalated) {
+        ESP_LOGI(TAG_TEST_FALL, "Test PASSED: No fall in a SUPPRESS zone, fall confirmed after %u ms in an ESCALATE zone.",
+                 alert_ms);
+    } else {
+        ESP_LOGE(TAG_TEST_FALL, "Test FAILED: suppressed %d, dropped %d, escalated %d (%d alerts, last after %u ms).",
+                 suppressed, dropped, escalated, alerts, alert_ms);
     }
     reset_fall_detector_state();
 }
 
 void run_fall_detector_tests() {
     ESP_LOGI(TAG_TEST_FALL, "--- Starting Fall Detector Tests ---");
+    test_fall_rules_table_valid();
     test_fall_detection_confirmed();
     test_fall_detection_cancelled();
     test_slow_to_lying_no_fall();
+    test_fall_confirmed_by_timer();
+    test_fall_cancelled_by_speed();
+    test_fall_across_glitch();
+    test_fall_instances_independent();
+    test_fall_zone_policy();
     ESP_LOGI(TAG_TEST_FALL, "--- Finished Fall Detector Tests ---");
 }
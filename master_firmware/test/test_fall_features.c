@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "fall_features.h"
+
+// --- BEGIN NOTE ---
+// fall_features.c (master_firmware/main) is plain C, so these tests run the
+// real sliding-window statistics of the FallDetector task on synthetic
+// fused outputs, and check the incremental values against a full pass over
+// the window.
+// --- END NOTE ---
+
+static const char *TAG_TEST_FEATURES = "TEST_FALL_FEATURES";
+
+static uint32_t rng_state = 4242;
+
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+void test_features_linear_walk() {
+    ESP_LOGI(TAG_TEST_FEATURES, "Running test: test_features_linear_walk");
+    fall_features_t ff;
+    fall_features_init(&ff);
+    // Walking along x at 1 m/s, one output every 100 ms for 5 s
+    FusedData data = { .x_mm = 0, .y_mm = 2000, .posture = RADAR_POSTURE_MOVING, .timestamp = 10000 };
+    for (int i = 0; i <= 50; i++) {
+        data.timestamp = 10000 + (uint32_t)i * 100;
+        data.x_mm = (int16_t)(i * 100);
+        fall_features_add(&ff, &data);
+    }
+    fall_feature_values_t f;
+    fall_features_get(&ff, data.timestamp, &f);
+    // 31 samples over 3 s, x uniform: std = 100 * sqrt((31^2 - 1) / 12)
+    float expected_std = 100.0f * sqrtf((31.0f * 31.0f - 1.0f) / 12.0f);
+    fall_feature_values_t stale;
+    fall_features_get(&ff, data.timestamp + FALL_FEATURE_WINDOW_MS + 1, &stale);
+
+    if (f.samples == 31 && f.speed_mm_s == 1000 && f.accel_mm_s2 == 0 && f.peak_descent_mm_s == 0 &&
+        fabsf((float)f.position_std_mm - expected_std) <= 1.0f && f.since_upright_ms == 0 && stale.samples == 0 &&
+        stale.since_upright_ms == FALL_FEATURE_WINDOW_MS + 1) {
+        ESP_LOGI(TAG_TEST_FEATURES, "Test PASSED: %u samples, speed %u mm/s, std %u mm (expected %.0f).", f.samples,
+                 f.speed_mm_s, f.position_std_mm, expected_std);
+    } else {
+        ESP_LOGE(TAG_TEST_FEATURES, "Test FAILED: %u samples, speed %u, accel %d, descent %u, std %u (expected %.0f), upright %u.",
+                 f.samples, f.speed_mm_s, f.accel_mm_s2, f.peak_descent_mm_s, f.position_std_mm, expected_std,
+                 f.since_upright_ms);
+    }
+}
+
+void test_features_fall_profile() {
+    ESP_LOGI(TAG_TEST_FEATURES, "Running test: test_features_fall_profile");
+    fall_features_t ff;
+    fall_features_init(&ff);
+    // Standing still, then the posture probabilities swing to LYING in 300 ms
+    FusedData data = { .x_mm = 1500, .y_mm = 1500, .timestamp = 20000 };
+    data.posture = RADAR_POSTURE_STANDING;
+    data.posture_pct[RADAR_POSTURE_STANDING] = 100;
+    for (int i = 0; i < 10; i++) {
+        data.timestamp += 100;
+        fall_features_add(&ff, &data);
+    }
+    uint32_t upright_ms = data.timestamp;
+    static const uint8_t lying_pct[] = { 30, 80, 100 };
+    for (int i = 0; i < 3; i++) {
+        data.timestamp += 100;
+        data.posture_pct[RADAR_POSTURE_LYING] = lying_pct[i];
+        data.posture_pct[RADAR_POSTURE_STANDING] = (uint8_t)(100 - lying_pct[i]);
+        data.posture = lying_pct[i] > 50 ? RADAR_POSTURE_LYING : RADAR_POSTURE_STANDING;
+        fall_features_add(&ff, &data);
+    }
+    fall_feature_values_t f;
+    fall_features_get(&ff, data.timestamp, &f);
+    int16_t height = fall_features_height_mm(&data);
+    // Steepest step: 50 % of the 1100 mm between standing and lying in 100 ms
+    bool fall = f.peak_descent_mm_s == 5500 && height == 200 && f.since_upright_ms == data.timestamp - (upright_ms + 100);
+
+    // Lying still for 4 s: the peak leaves the window
+    for (int i = 0; i < 40; i++) {
+        data.timestamp += 100;
+        fall_features_add(&ff, &data);
+    }
+    fall_feature_values_t later;
+    fall_features_get(&ff, data.timestamp, &later);
+
+    if (fall && later.peak_descent_mm_s == 0 && later.speed_mm_s == 0 && later.position_std_mm == 0) {
+        ESP_LOGI(TAG_TEST_FEATURES, "Test PASSED: Peak descent %u mm/s during the fall, 0 once it left the window.",
+                 f.peak_descent_mm_s);
+    } else {
+        ESP_LOGE(TAG_TEST_FEATURES, "Test FAILED: peak %u (later %u), height %d, upright %u ms ago.", f.peak_descent_mm_s,
+                 later.peak_descent_mm_s, height, f.since_upright_ms);
+    }
+}
+
+void test_features_match_full_pass() {
+    ESP_LOGI(TAG_TEST_FEATURES, "Running test: test_features_match_full_pass");
+    fall_features_t ff;
+    fall_features_init(&ff);
+    FusedData data = { .timestamp = 1000 };
+    int mismatches = 0, resets = 0;
+    for (int i = 0; i < 5000; i++) {
+        // 20 to 180 ms apart (up to 150 samples per window: capacity bound),
+        // now and then a gap longer than the window
+        uint32_t step = rng_next() % 200 == 0 ? FALL_FEATURE_WINDOW_MS + 500 : 20 + rng_next() % 160;
+        resets += step > FALL_FEATURE_WINDOW_MS;
+        data.timestamp += step;
+        data.x_mm = (int16_t)(rng_next() % 6000);
+        data.y_mm = (int16_t)(rng_next() % 6000);
+        data.posture = (uint8_t)(rng_next() % RADAR_POSTURE_COUNT);
+        fall_features_add(&ff, &data);
+        fall_feature_values_t f;
+        fall_features_get(&ff, data.timestamp, &f);
+
+        // Full pass over the samples of the ring
+        int16_t peak = INT16_MIN;
+        double sx = 0, sy = 0, sxx = 0, syy = 0;
+        uint32_t oldest_ms = 0;
+        for (int k = 0; k < ff.count; k++) {
+            const fall_feature_sample_t *s = &ff.samples[(ff.head + k) % FALL_FEATURE_CAPACITY];
+            peak = s->descent_mm_s > peak ? s->descent_mm_s : peak;
+            sx += s->x_mm;
+            sy += s->y_mm;
+            sxx += (double)s->x_mm * s->x_mm;
+            syy += (double)s->y_mm * s->y_mm;
+            if (k == 0) {
+                oldest_ms = data.timestamp - (uint16_t)((uint16_t)data.timestamp - s->t16);
+            }
+        }
+        double n = ff.count;
+        double var = sxx / n - (sx / n) * (sx / n) + syy / n - (sy / n) * (sy / n);
+        uint16_t std = (uint16_t)(sqrt(var > 0 ? var : 0) + 0.5);
+        bool ok = f.samples == ff.count && ff.count <= FALL_FEATURE_CAPACITY &&
+                  data.timestamp - oldest_ms <= FALL_FEATURE_WINDOW_MS &&
+                  f.peak_descent_mm_s == (uint16_t)(peak > 0 ? peak : 0) && abs((int)f.position_std_mm - (int)std) <= 1;
+        mismatches += !ok;
+    }
+
+    if (mismatches == 0 && resets > 0) {
+        ESP_LOGI(TAG_TEST_FEATURES, "Test PASSED: Incremental peak and variance match a full pass on 5000 samples (%d gaps).",
+                 resets);
+    } else {
+        ESP_LOGE(TAG_TEST_FEATURES, "Test FAILED: %d mismatches, %d gaps.", mismatches, resets);
+    }
+}
+
+void run_fall_features_tests() {
+    ESP_LOGI(TAG_TEST_FEATURES, "--- Starting Fall Features Tests ---");
+    test_features_linear_walk();
+    test_features_fall_profile();
+    test_features_match_full_pass();
+    ESP_LOGI(TAG_TEST_FEATURES, "--- Finished Fall Features Tests ---");
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "fsm_engine.h"
+
+// --- BEGIN NOTE ---
+// fsm_engine.c (master_firmware/main) is plain C: these tests run the real
+// engine on small tables of their own. The fall rules it runs in the
+// FallDetector task are covered by test_fall_detector.c.
+// --- END NOTE ---
+
+static const char *TAG_TEST_FSM = "TEST_FSM_ENGINE";
+
+#define LYING_BIT RADAR_POSTURE_BIT(RADAR_POSTURE_LYING)
+#define MOVING_BIT RADAR_POSTURE_BIT(RADAR_POSTURE_MOVING)
+
+enum { S_IDLE, S_ACTIVE, S_ALARM, S_COUNT };
+enum { A_NONE, A_SLOW, A_FAST, A_START, A_ALARM, A_STOP };
+
+static const fsm_rule_t toy_rules[] = {
+    // from    to        trigger       action   posture     prev     context  speed (min, max)    descent, in state, gap
+    { S_IDLE,   S_ACTIVE, FSM_ON_EVENT, A_FAST,  MOVING_BIT, FSM_ANY, FSM_ANY, 1000, FSM_NO_LIMIT, 0, 0,     0 },
+    { S_IDLE,   S_ACTIVE, FSM_ON_EVENT, A_SLOW,  MOVING_BIT, FSM_ANY, FSM_ANY, 100,  999,          0, 0,     0 },
+    { S_IDLE,   S_ACTIVE, FSM_ON_EVENT, A_START, LYING_BIT,  FSM_ANY, FSM_ANY, 0,    FSM_NO_LIMIT, 0, 0,     500 },
+    { S_ACTIVE, S_ACTIVE, FSM_ON_EVENT, A_NONE,  MOVING_BIT, FSM_ANY, FSM_ANY, 0,    FSM_NO_LIMIT, 0, 0,     0 },
+    { S_ACTIVE, S_ALARM,  FSM_ON_TIMER, A_ALARM, FSM_ANY,    FSM_ANY, FSM_ANY, 1,    FSM_NO_LIMIT, 0, 1000,  0 },
+    { S_ACTIVE, S_ALARM,  FSM_ON_ANY,   A_ALARM, FSM_ANY,    FSM_ANY, FSM_ANY, 0,    FSM_NO_LIMIT, 0, 5000,  0 },
+    { S_ALARM,  S_IDLE,   FSM_ON_EVENT, A_STOP,  FSM_ANY,    FSM_ANY, FSM_ANY, 0,    FSM_NO_LIMIT, 0, 0,     0 },
+};
+
+static uint8_t send(const fsm_table_t *table, fsm_instance_t *inst, uint32_t now_ms, radar_posture_t posture, uint16_t speed) {
+    fsm_event_t event = { .now_ms = now_ms, .speed_mm_s = speed, .posture = (uint8_t)posture };
+    return fsm_dispatch(table, inst, &event);
+}
+
+void test_fsm_table_index() {
+    ESP_LOGI(TAG_TEST_FSM, "Running test: test_fsm_table_index");
+    fsm_table_t table;
+    bool ok = fsm_table_init(&table, toy_rules, sizeof(toy_rules) / sizeof(toy_rules[0]), S_COUNT);
+    bool index_ok = ok && table.first[S_IDLE] == 0 && table.first[S_ACTIVE] == 3 && table.first[S_ALARM] == 6 &&
+                    table.first[S_COUNT] == 7;
+
+    // Unsorted, unknown target state, too many states: rejected
+    fsm_rule_t unsorted[2] = { toy_rules[3], toy_rules[0] };
+    fsm_rule_t bad_target = toy_rules[0];
+    bad_target.to = S_COUNT;
+    fsm_table_t rejected;
+    bool unsorted_rejected = !fsm_table_init(&rejected, unsorted, 2, S_COUNT) && rejected.rule_count == 0;
+    bool target_rejected = !fsm_table_init(&rejected, &bad_target, 1, S_COUNT);
+    bool size_rejected = !fsm_table_init(&rejected, toy_rules, 1, FSM_MAX_STATES + 1);
+
+    if (index_ok && unsorted_rejected && target_rejected && size_rejected) {
+        ESP_LOGI(TAG_TEST_FSM, "Test PASSED: Rules indexed by state, invalid tables rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_FSM, "Test FAILED: init %d, index %d, rejected %d/%d/%d.", ok, index_ok, unsorted_rejected,
+                 target_rejected, size_rejected);
+    }
+}
+
+void test_fsm_event_guards() {
+    ESP_LOGI(TAG_TEST_FSM, "Running test: test_fsm_event_guards");
+    fsm_table_t table;
+    fsm_table_init(&table, toy_rules, sizeof(toy_rules) / sizeof(toy_rules[0]), S_COUNT);
+    fsm_instance_t a, b, c;
+    fsm_instance_init(&a, S_IDLE, 0);
+    fsm_instance_init(&b, S_IDLE, 0);
+    fsm_instance_init(&c, S_IDLE, 0);
+
+    // Speed bounds, first match wins; too slow: no rule
+    bool speeds = send(&table, &a, 10, RADAR_POSTURE_MOVING, 50) == A_NONE && a.state == S_IDLE &&
+                  send(&table, &a, 20, RADAR_POSTURE_MOVING, 1500) == A_FAST && a.state == S_ACTIVE &&
+                  send(&table, &b, 20, RADAR_POSTURE_MOVING, 500) == A_SLOW;
+    // Gap guard: fails on the first event, holds when close to the previous one
+    bool gap = send(&table, &c, 100, RADAR_POSTURE_LYING, 0) == A_NONE &&
+               send(&table, &c, 1000, RADAR_POSTURE_LYING, 0) == A_NONE &&
+               send(&table, &c, 1400, RADAR_POSTURE_LYING, 0) == A_START && c.entered_ms == 1400;
+    // Self-transition keeps the entry time; min time in state then fires
+    bool in_state = send(&table, &a, 3000, RADAR_POSTURE_MOVING, 0) == A_NONE && a.entered_ms == 20 &&
+                    send(&table, &a, 5100, RADAR_POSTURE_STILL, 0) == A_ALARM && a.state == S_ALARM &&
+                    send(&table, &a, 5200, RADAR_POSTURE_STILL, 0) == A_STOP && a.state == S_IDLE;
+
+    if (speeds && gap && in_state) {
+        ESP_LOGI(TAG_TEST_FSM, "Test PASSED: Speed, gap and time-in-state guards applied, first matching rule wins.");
+    } else {
+        ESP_LOGE(TAG_TEST_FSM, "Test FAILED: speeds %d, gap %d, in state %d.", speeds, gap, in_state);
+    }
+}
+
+void test_fsm_timer() {
+    ESP_LOGI(TAG_TEST_FSM, "Running test: test_fsm_timer");
+    fsm_table_t table;
+    fsm_table_init(&table, toy_rules, sizeof(toy_rules) / sizeof(toy_rules[0]), S_COUNT);
+    fsm_instance_t inst;
+    fsm_instance_init(&inst, S_ACTIVE, 10000);
+
+    // No event yet: nothing fires
+    bool silent = fsm_tick(&table, &inst, 20000, 0) == A_NONE;
+    send(&table, &inst, 10000, RADAR_POSTURE_MOVING, 0);
+    // The 1 s timer rule guards on speed: never fires on ticks; the 5 s one does
+    bool early = fsm_tick(&table, &inst, 12000, 0) == A_NONE && inst.state == S_ACTIVE;
+    uint8_t action = fsm_tick(&table, &inst, 10000 + 5000, 0);
+    bool fired = silent && early && action == A_ALARM && inst.state == S_ALARM && inst.entered_ms == 15000 &&
+                 fsm_tick(&table, &inst, 16000, 0) == A_NONE;
+
+    if (fired) {
+        ESP_LOGI(TAG_TEST_FSM, "Test PASSED: Timer rule fired after 5 s in state, speed-guarded rule skipped on ticks.");
+    } else {
+        ESP_LOGE(TAG_TEST_FSM, "Test FAILED: silent %d, early %d, action %u, state %u.", silent, early, action, inst.state);
+    }
+}
+
+void run_fsm_engine_tests() {
+    ESP_LOGI(TAG_TEST_FSM, "--- Starting FSM Engine Tests ---");
+    test_fsm_table_index();
+    test_fsm_event_guards();
+    test_fsm_timer();
+    ESP_LOGI(TAG_TEST_FSM, "--- Finished FSM Engine Tests ---");
+}
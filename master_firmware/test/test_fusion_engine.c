@@ -1,16 +1,21 @@
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h> // For abs()
 #include <stdbool.h>
+#include <stdlib.h> // abs()
+#include <math.h>
 #include "freertos/FreeRTOS.h" // For types like TickType_t
 #include "freertos/queue.h"   // For QueueHandle_t (conceptually)
 #include "esp_log.h"
+#include "pipeline_msgs.h" // RadarMessage, FusedData, radar_posture_fuse() (shared with main.c)
+#include "fusion_engine.h" // Real fusion core used by FusionEngine_task
+#include "trilateration.h" // Real position solver, run by mtt_room_step()
+#include "multi_tracker.h" // Real per-room people tracker
 
 // --- BEGIN LIMITATION NOTE ---
 // This test file is a THEORETICAL structure for unit testing components of master_firmware/main/main.c.
 // Due to the sandbox environment:
 // 1. This code will NOT be compiled or run as part of an ESP-IDF project.
-// 2. Functions marked 'static' in main.c (e.g., parse_radar_json, calculate_xy_position,
+// 2. Functions marked 'static' in main.c (e.g., parse_radar_json
 //    and the core logic of FusionEngine_task if not refactored) are not directly callable.
 //    For this exercise, their signatures are re-declared here, and simplified stubs or copies
 //    of their logic are provided below to allow test functions to be written.
@@ -22,31 +27,17 @@
 // - Make relevant functions non-static.
 // - Move shared structs and function declarations to header files.
 // - Link test code with compiled object files of the functions under test or use a mocking framework.
+//
+// The per-room fusion core, the position solver and the people tracker have
+// since been moved to fusion_engine.c, trilateration.c, kalman_tracker.c and
+// multi_tracker.c: the fusion tests below drive the real implementations. The
+// JSON parser and the track_room_people() glue are copies.
 // --- END LIMITATION NOTE ---
 
 static const char *TAG_TEST_FUSION = "TEST_FUSION_ENGINE";
 
 // Definitions copied/adapted from main.c
-typedef struct {
-    int module_id;
-    uint32_t timestamp;
-    float distance_m;
-    char posture[16];
-    int signal;
-} RadarMessage;
-
-typedef struct {
-    float x, y;
-    char final_posture[16];
-    uint32_t timestamp;
-} FusedData;
-
 #define SENSOR_SYNC_WINDOW_MS 500
-#define STANDING_POSTURE "STANDING" 
-#define SITTING_POSTURE  "SITTING"  
-#define LYING_POSTURE    "LYING"
-#define MOVING_POSTURE   "MOVING"   
-#define STILL_POSTURE    "STILL"
 
 // --- Stubs/Re-declarations for functions from main.c ---
 
@@ -57,33 +48,83 @@ static bool parse_radar_json(const char* json_str, int data_len, RadarMessage* m
     }
     char temp_json_str[data_len + 1]; 
     memcpy(temp_json_str, json_str, data_len);
-    temp_json_str[data_len] = '\\0';
+    temp_json_str[data_len] = '\0';
     char* ptr; bool success = true;
+    int module_id = 0, signal = 0; float distance_m = 0.0f, moving_m = 0.0f, static_m = 0.0f;
     ptr = strstr(temp_json_str, "\"id_module\":");
-    if (ptr) { if (sscanf(ptr + strlen("\"id_module\":"), "%d", &msg->module_id) != 1) success = false; } else success = false;
+    if (ptr) { if (sscanf(ptr + strlen("\"id_module\":"), "%d", &module_id) != 1) success = false; } else success = false;
+    if (module_id < 1 || module_id > UINT8_MAX) success = false;
     ptr = strstr(temp_json_str, "\"timestamp\":");
     if (ptr && success) { if (sscanf(ptr + strlen("\"timestamp\":"), "%u", &msg->timestamp) != 1) success = false; } else success = false;
     ptr = strstr(temp_json_str, "\"distance_m\":");
-    if (ptr && success) { if (sscanf(ptr + strlen("\"distance_m\":"), "%f", &msg->distance_m) != 1) success = false; } else success = false;
+    if (ptr && success) { if (sscanf(ptr + strlen("\"distance_m\":"), "%f", &distance_m) != 1) success = false; } else success = false;
     ptr = strstr(temp_json_str, "\"signal\":");
-    if (ptr && success) { if (sscanf(ptr + strlen("\"signal\":"), "%d", &msg->signal) != 1) success = false; } else success = false;
-    ptr = strstr(temp_json_str, "\"posture\": \"");
+    if (ptr && success) { if (sscanf(ptr + strlen("\"signal\":"), "%d", &signal) != 1) success = false; } else success = false;
+    bool has_targets = false;
+    ptr = strstr(temp_json_str, "\"moving_m\":");
+    if (ptr && success) { has_targets = sscanf(ptr + strlen("\"moving_m\":"), "%f", &moving_m) == 1; }
+    ptr = strstr(temp_json_str, "\"static_m\":");
+    if (ptr && has_targets) { has_targets = sscanf(ptr + strlen("\"static_m\":"), "%f", &static_m) == 1; } else has_targets = false;
+    ptr = strstr(temp_json_str, "\"posture\":");
     if (ptr && success) {
-        ptr += strlen("\"posture\": \""); char* end_quote = strchr(ptr, '\"');
-        if (end_quote) {
-            int posture_len = end_quote - ptr;
-            if (posture_len < sizeof(msg->posture)) { strncpy(msg->posture, ptr, posture_len); msg->posture[posture_len] = '\\0'; }
-            else { success = false; }
-        } else success = false;
+        ptr += strlen("\"posture\":");
+        while (*ptr == ' ') ptr++;
+        char* end_quote = (*ptr == '\"') ? strchr(++ptr, '\"') : NULL;
+        if (end_quote) { *end_quote = '\0'; msg->posture = (uint8_t)radar_posture_from_string(ptr); }
+        else success = false;
     } else success = false;
+    if (success) {
+        msg->module_id = (uint8_t)module_id;
+        msg->distance_mm = pipeline_distance_mm(distance_m);
+        msg->moving_mm = has_targets ? pipeline_distance_mm(moving_m) : 0;
+        msg->static_mm = has_targets ? pipeline_distance_mm(static_m) : 0;
+        msg->signal = (uint8_t)(signal < 0 ? 0 : (signal > 100 ? 100 : signal));
+        msg->flags = has_targets ? RADAR_MSG_HAS_TARGETS : 0;
+        msg->sequence = 0;
+    }
     return success;
 }
 
-// Re-declaration of calculate_xy_position from main.c
-static bool calculate_xy_position(float d1, float d2, float* x, float* y) {
-    *x = 1.0f; // Stubbed values
-    *y = 1.5f;
-    return true;
+static fusion_engine_t test_fusion; // Static: ~12 KB
+
+// Calibration and room geometry as in main.c
+static const struct { uint8_t module_id; float x, y; } sensor_calibration[] = {
+    { 1, 0.00f, 0.50f },
+    { 2, 3.00f, 0.50f },
+};
+static trilat_geometry_t room_geometry[FUSION_MAX_ROOMS];
+static mtt_room_t room_people[FUSION_MAX_ROOMS];
+
+// Re-declaration of update_room_geometry from main.c
+static void update_room_geometry(int room) {
+    static const trilat_bounds_t bounds = { 0.0f, 0.0f, 4.0f, 4.0f };
+    trilat_geometry_t *geometry = &room_geometry[room];
+    const fusion_room_t *fr = &test_fusion.rooms[room];
+    trilat_geometry_init(geometry, &bounds, TRILAT_DEFAULT_RANGE_SIGMA_M);
+    mtt_room_init(&room_people[room], KALMAN_DEFAULT_ACCEL_SIGMA); // main.c: once at task start
+    for (int slot = 0; slot < fr->slot_count; slot++) {
+        uint8_t id = fr->slots[slot].module_id;
+        for (size_t i = 0; id != 0 && i < sizeof(sensor_calibration) / sizeof(sensor_calibration[0]); i++) {
+            if (sensor_calibration[i].module_id == id) {
+                trilat_geometry_set_sensor(geometry, slot, sensor_calibration[i].x, sensor_calibration[i].y);
+                break;
+            }
+        }
+    }
+}
+
+// Re-declaration of track_room_people from main.c (without the logs)
+static int track_room_people(const fusion_set_t *set) {
+    mtt_scan_t scan;
+    mtt_scan_init(&scan);
+    int n = 0;
+    for (uint8_t mask = set->slot_mask; mask; mask &= (uint8_t)(mask - 1)) {
+        const fusion_reading_t *r = &set->readings[n++];
+        bool targets = (r->flags & RADAR_MSG_HAS_TARGETS) != 0;
+        mtt_scan_add(&scan, __builtin_ctz(mask), r->distance_mm, targets ? r->moving_mm : 0,
+                     targets ? r->static_mm : 0, (radar_posture_t)r->posture, r->signal);
+    }
+    return mtt_room_step(&room_people[set->room], &room_geometry[set->room], set->timestamp, &scan);
 }
 
 // Simulated queue handles (conceptual)
@@ -98,13 +139,30 @@ void test_parse_valid_json() {
     const char* valid_json = "{\n  \"id_module\": 1,\n  \"timestamp\": 12345,\n  \"distance_m\": 2.50,\n  \"posture\": \"SITTING\",\n  \"signal\": 80\n}";
     bool success = parse_radar_json(valid_json, strlen(valid_json), &msg);
 
-    if (success && msg.module_id == 1 && msg.timestamp == 12345 && msg.distance_m == 2.50f && strcmp(msg.posture, "SITTING") == 0 && msg.signal == 80) {
+    if (success && msg.module_id == 1 && msg.timestamp == 12345 && msg.distance_mm == 2500 && msg.posture == RADAR_POSTURE_SITTING && msg.signal == 80 &&
+        msg.flags == 0 && msg.moving_mm == 0 && msg.static_mm == 0) {
         ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Valid JSON parsed correctly.");
     } else {
         ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Valid JSON parsing error or incorrect values.");
     }
 }
 
+void test_parse_json_with_targets() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_parse_json_with_targets");
+    RadarMessage msg;
+    // Slave 1.2.0: a person moving at 3.10 m, another one still at 1.80 m
+    const char* json = "{\n  \"id_module\": 2,\n  \"timestamp\": 500,\n  \"distance_m\": 3.10,\n  \"moving_m\": 3.10,\n"
+                       "  \"static_m\": 1.80,\n  \"posture\": \"MOVING\",\n  \"signal\": 70\n}";
+    bool success = parse_radar_json(json, strlen(json), &msg);
+
+    if (success && msg.distance_mm == 3100 && msg.moving_mm == 3100 && msg.static_mm == 1800 &&
+        msg.flags == RADAR_MSG_HAS_TARGETS && msg.posture == RADAR_POSTURE_MOVING) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Moving and static target distances parsed.");
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Target distances not parsed (flags 0x%02x).", success ? msg.flags : 0);
+    }
+}
+
 void test_parse_invalid_json() {
     ESP_LOGI(TAG_TEST_FUSION, "Running test: test_parse_invalid_json");
     RadarMessage msg;
@@ -118,88 +176,447 @@ void test_parse_invalid_json() {
     }
 }
 
-// Helper function to simulate processing logic of FusionEngine_task for a pair of messages
-// This would be more complex in reality, involving managing the static state of FusionEngine_task
-static bool simulate_fusion_engine_processing(RadarMessage msg1, RadarMessage msg2, FusedData* output) {
-    // Simplified simulation of FusionEngine_task's core logic
-    static RadarMessage sensor1_data_store;
-    static bool sensor1_valid_store = false;
-    static RadarMessage sensor2_data_store;
-    static bool sensor2_valid_store = false;
-
-    bool processed_output = false;
-
-    // Process first message
-    if (msg1.module_id == 1) { sensor1_data_store = msg1; sensor1_valid_store = true; }
-    else if (msg1.module_id == 2) { sensor2_data_store = msg1; sensor2_valid_store = true; }
-
-    // Process second message
-    if (msg2.module_id == 1) { sensor1_data_store = msg2; sensor1_valid_store = true; }
-    else if (msg2.module_id == 2) { sensor2_data_store = msg2; sensor2_valid_store = true; }
-    
-    if (sensor1_valid_store && sensor2_valid_store) {
-        if (abs((int32_t)sensor1_data_store.timestamp - (int32_t)sensor2_data_store.timestamp) <= SENSOR_SYNC_WINDOW_MS) {
-            calculate_xy_position(sensor1_data_store.distance_m, sensor2_data_store.distance_m, &output->x, &output->y);
-            
-            if (strcmp(sensor1_data_store.posture, LYING_POSTURE) == 0 || strcmp(sensor2_data_store.posture, LYING_POSTURE) == 0) {
-                strcpy(output->final_posture, LYING_POSTURE);
-            } else if (strcmp(sensor1_data_store.posture, MOVING_POSTURE) == 0 || strcmp(sensor2_data_store.posture, MOVING_POSTURE) == 0) {
-                 strcpy(output->final_posture, MOVING_POSTURE);
-            } else if (strcmp(sensor1_data_store.posture, SITTING_POSTURE) == 0 || strcmp(sensor2_data_store.posture, SITTING_POSTURE) == 0) {
-                strcpy(output->final_posture, SITTING_POSTURE);
-            } else if (strcmp(sensor1_data_store.posture, STANDING_POSTURE) == 0 || strcmp(sensor2_data_store.posture, STANDING_POSTURE) == 0) {
-                strcpy(output->final_posture, STANDING_POSTURE);
+// Feeds `msgs` to the fusion core as FusionEngine_task does, each received
+// at its own timestamp (slave clocks in step with the master). Returns true
+// if the last message produced a fused output, written to `output`.
+static bool feed_fusion(const RadarMessage *msgs, size_t count, FusedData *output, fusion_set_t *set) {
+    bool fused = false;
+    for (size_t i = 0; i < count; i++) {
+        fused = fusion_engine_update(&test_fusion, &msgs[i], msgs[i].timestamp, set) == FUSION_FUSED;
+        if (fused && output) {
+            // First output of the set, as FusionEngine_task sends them: the room
+            // output when nobody is confirmed, else the first confirmed track.
+            int occupants = track_room_people(set);
+            memset(output, 0, sizeof(*output));
+            output->room = set->room;
+            output->timestamp = set->timestamp;
+            output->occupants = (uint8_t)occupants;
+            output->posture = (uint8_t)set->posture;
+            memcpy(output->posture_pct, set->posture_pct, sizeof(output->posture_pct));
+            output->sigma_cm = FUSED_SIGMA_UNKNOWN;
+            output->flags = FUSED_FLAG_PREDICTED;
+            for (int i = 0; i < set->count; i++) { // strongest_range_mm()
+                if (i == 0 || set->readings[i].signal > set->readings[i - 1].signal) {
+                    output->range_mm = set->readings[i].distance_mm;
+                }
+            }
+            for (int t = 0; t < MTT_MAX_TRACKS && occupants > 0; t++) {
+                const mtt_track_t *track = &room_people[set->room].tracks[t];
+                if (track->id == 0 || !track->confirmed) {
+                    continue;
+                }
+                output->x_mm = pipeline_position_mm(track->kf.s[0]);
+                output->y_mm = pipeline_position_mm(track->kf.s[1]);
+                output->vx_mm_s = pipeline_position_mm(track->kf.s[2]);
+                output->vy_mm_s = pipeline_position_mm(track->kf.s[3]);
+                output->sigma_cm = pipeline_sigma_cm(kalman_track_position_sigma(&track->kf));
+                output->posture = track->posture;
+                posture_hmm_percent(&track->posture_hmm, output->posture_pct);
+                output->track_id = track->id;
+                output->flags = (track->result == KALMAN_STARTED || track->newly_confirmed) ? FUSED_FLAG_NEW_TRACK :
+                                track->result == KALMAN_UPDATED ? 0 : FUSED_FLAG_PREDICTED;
+                break;
             }
-            else { strcpy(output->final_posture, STILL_POSTURE); }
-            output->timestamp = (sensor1_data_store.timestamp > sensor2_data_store.timestamp) ? sensor1_data_store.timestamp : sensor2_data_store.timestamp;
-            processed_output = true;
+            output->flags |= set->degraded ? FUSED_FLAG_DEGRADED : 0;
         }
-        sensor1_valid_store = false; // Reset for next pair
-        sensor2_valid_store = false;
     }
-    return processed_output;
+    return fused;
+}
+
+// The former FusionEngine_task: modules 1 and 2, both needed. The pair is
+// sent `repeat` times, 200 ms apart (the tracker confirms a person after
+// MTT_CONFIRM_HITS positions).
+static bool simulate_fusion_engine_processing(RadarMessage msg1, RadarMessage msg2, int repeat, FusedData* output) {
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+    update_room_geometry(0);
+    bool fused = false;
+    for (int i = 0; i < repeat; i++) {
+        RadarMessage msgs[2] = { msg1, msg2 };
+        msgs[0].timestamp += 200 * i;
+        msgs[1].timestamp += 200 * i;
+        fused = feed_fusion(msgs, 2, output, &set);
+    }
+    return fused;
 }
 
 void test_fusion_synchronized_lying() {
     ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_synchronized_lying");
-    RadarMessage msg1 = { .module_id = 1, .timestamp = 10000, .distance_m = 2.0f, .posture = STANDING_POSTURE, .signal = 70 };
-    RadarMessage msg2 = { .module_id = 2, .timestamp = 10100, .distance_m = 2.1f, .posture = LYING_POSTURE,   .signal = 75 };
+    // Module 1 barely sees the person: the LYING votes of module 2 win
+    RadarMessage msg1 = { .module_id = 1, .timestamp = 10000, .distance_mm = 2000, .posture = RADAR_POSTURE_STANDING, .signal = 20 };
+    RadarMessage msg2 = { .module_id = 2, .timestamp = 10100, .distance_mm = 2100, .posture = RADAR_POSTURE_LYING,   .signal = 75 };
     FusedData fused_result;
 
-    bool processed = simulate_fusion_engine_processing(msg1, msg2, &fused_result);
+    bool processed = simulate_fusion_engine_processing(msg1, msg2, MTT_CONFIRM_HITS, &fused_result);
 
-    if (processed && strcmp(fused_result.final_posture, LYING_POSTURE) == 0 && fused_result.x == 1.0f && fused_result.y == 1.5f) {
-        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Synchronized LYING data fused correctly. Posture: %s, X:%.2f, Y:%.2f", fused_result.final_posture, fused_result.x, fused_result.y);
+    if (processed && fused_result.posture == RADAR_POSTURE_LYING && abs(fused_result.x_mm - 1432) <= 2 &&
+        abs(fused_result.y_mm - 1897) <= 2 && fused_result.sigma_cm != FUSED_SIGMA_UNKNOWN &&
+        fused_result.flags == FUSED_FLAG_NEW_TRACK && fused_result.track_id == 1 && fused_result.occupants == 1) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Synchronized LYING data fused correctly. Posture: %s, X:%d mm, Y:%d mm",
+                 radar_posture_name((radar_posture_t)fused_result.posture), fused_result.x_mm, fused_result.y_mm);
     } else {
         ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Synchronized LYING data fusion incorrect. Processed: %d", processed);
-        if(processed) ESP_LOGE(TAG_TEST_FUSION, "Result: Posture: %s, X:%.2f, Y:%.2f", fused_result.final_posture, fused_result.x, fused_result.y);
+        if(processed) ESP_LOGE(TAG_TEST_FUSION, "Result: Posture: %s, X:%d mm, Y:%d mm",
+                               radar_posture_name((radar_posture_t)fused_result.posture), fused_result.x_mm, fused_result.y_mm);
     }
 }
 
 void test_fusion_unsynchronized() {
     ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_unsynchronized");
-    RadarMessage msg1 = { .module_id = 1, .timestamp = 10000, .distance_m = 2.0f, .posture = STANDING_POSTURE, .signal = 70 };
-    RadarMessage msg2 = { .module_id = 2, .timestamp = 12000, .distance_m = 2.1f, .posture = SITTING_POSTURE,  .signal = 75 }; // Timestamp diff > SENSOR_SYNC_WINDOW_MS
+    RadarMessage msg1 = { .module_id = 1, .timestamp = 10000, .distance_mm = 2000, .posture = RADAR_POSTURE_STANDING, .signal = 70 };
+    RadarMessage msg2 = { .module_id = 2, .timestamp = 12000, .distance_mm = 2100, .posture = RADAR_POSTURE_SITTING,  .signal = 75 }; // Timestamp diff > SENSOR_SYNC_WINDOW_MS
     FusedData fused_result;
 
-    bool processed = simulate_fusion_engine_processing(msg1, msg2, &fused_result);
-    
-    if (!processed) {
-        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Unsynchronized data did not produce fused output, as expected.");
+    bool processed = simulate_fusion_engine_processing(msg1, msg2, 1, &fused_result);
+
+    // Module 1 has been silent for 2 s (more than FUSION_ABSENT_WINDOWS windows):
+    // module 2 is fused alone, in degraded mode, never with the stale reading.
+    if (processed && (fused_result.flags & FUSED_FLAG_DEGRADED) && fused_result.range_mm == 2100 &&
+        fused_result.posture == RADAR_POSTURE_SITTING) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Unsynchronized data not fused together, module 2 alone in degraded mode.");
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Unsynchronized data handling incorrect (processed %d, flags 0x%02x).",
+                 processed, processed ? fused_result.flags : 0);
+    }
+}
+
+void test_fusion_three_modules_quorum() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_three_modules_quorum");
+    fusion_set_t set;
+    FusedData fused;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 3, "salon");
+    fusion_engine_assign(&test_fusion, 7, "salon");
+    fusion_engine_assign(&test_fusion, 9, "salon");
+    fusion_engine_set_quorum(&test_fusion, fusion_engine_room_of(&test_fusion, 3), 3);
+
+    RadarMessage a = { .module_id = 3, .timestamp = 1000, .distance_mm = 1500, .posture = RADAR_POSTURE_STANDING, .signal = 60 };
+    RadarMessage b = { .module_id = 7, .timestamp = 1100, .distance_mm = 1800, .posture = RADAR_POSTURE_SITTING, .signal = 60 };
+    RadarMessage c = { .module_id = 9, .timestamp = 1200, .distance_mm = 2100, .posture = RADAR_POSTURE_STANDING, .signal = 60 };
+    bool after_two = feed_fusion((RadarMessage[]){ a, b }, 2, &fused, &set);
+    bool after_three = feed_fusion(&c, 1, &fused, &set);
+
+    // Aligned on the oldest fresh reading (a), b and c have no earlier reading:
+    // held. Two STANDING votes against one SITTING.
+    if (!after_two && after_three && set.count == 3 && fused.posture == RADAR_POSTURE_STANDING &&
+        fused.timestamp == 1000 && set.readings[2].distance_mm == 2100 && test_fusion.rooms[set.room].fresh_mask == 0) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Three modules with quorum 3 fused once all were fresh.");
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Quorum of 3 not honoured (after two: %d, after three: %d).", after_two, after_three);
+    }
+}
+
+void test_fusion_rooms_are_independent() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_rooms_are_independent");
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "cuisine");
+    fusion_engine_assign(&test_fusion, 2, "chambre");
+    fusion_engine_assign(&test_fusion, 3, "cuisine");
+
+    // 1 and 2 are synchronized but in different rooms: 1 waits for 3. Module 2,
+    // alone in its room (below the quorum), is fused alone in degraded mode.
+    RadarMessage m1 = { .module_id = 1, .timestamp = 5000, .posture = RADAR_POSTURE_MOVING, .signal = 80 };
+    RadarMessage m2 = { .module_id = 2, .timestamp = 5010, .posture = RADAR_POSTURE_LYING, .signal = 80 };
+    RadarMessage m3 = { .module_id = 3, .timestamp = 5020, .posture = RADAR_POSTURE_STILL, .signal = 40 };
+    bool waiting = feed_fusion(&m1, 1, NULL, &set);
+    bool alone = feed_fusion(&m2, 1, NULL, &set) && set.count == 1 && set.degraded &&
+                 set.room == fusion_engine_room_of(&test_fusion, 2);
+    bool same_room = feed_fusion(&m3, 1, NULL, &set);
+    RadarMessage unassigned = { .module_id = 42, .timestamp = 5030 };
+
+    if (!waiting && alone && same_room && set.room == fusion_engine_room_of(&test_fusion, 1) && set.count == 2 &&
+        !set.degraded && set.posture == RADAR_POSTURE_MOVING &&
+        fusion_engine_update(&test_fusion, &unassigned, 5030, &set) == FUSION_REJECTED) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Readings are only fused with modules of the same room.");
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Readings leaked between rooms.");
+    }
+}
+
+void test_fusion_stale_reading_expires() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_stale_reading_expires");
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+    fusion_engine_assign(&test_fusion, 3, "");
+
+    // Module 1 is 2 s older than module 2: dropped. Module 3 then pairs with 2.
+    RadarMessage old1 = { .module_id = 1, .timestamp = 10000, .posture = RADAR_POSTURE_LYING, .signal = 90 };
+    RadarMessage new2 = { .module_id = 2, .timestamp = 12000, .posture = RADAR_POSTURE_SITTING, .signal = 60 };
+    RadarMessage new3 = { .module_id = 3, .timestamp = 12100, .posture = RADAR_POSTURE_SITTING, .signal = 60 };
+    bool fused_stale = feed_fusion((RadarMessage[]){ old1, new2 }, 2, NULL, &set);
+    bool fused_fresh = feed_fusion(&new3, 1, NULL, &set);
+
+    if (!fused_stale && fused_fresh && set.count == 2 && set.posture == RADAR_POSTURE_SITTING &&
+        test_fusion.rooms[0].expired_count == 1) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Reading outside the %d ms window expired, fresh pair fused.", SENSOR_SYNC_WINDOW_MS);
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Stale reading handling incorrect.");
+    }
+}
+
+void test_fusion_noisy_lying_frame() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_noisy_lying_frame");
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+
+    // Both modules see a standing person every 100 ms; module 2 reports one
+    // LYING frame at 1 s. From 2 s both report LYING (a real fall).
+    bool flipped_on_noise = false;
+    int sets_to_lying = -1, sets_after_fall = 0;
+    uint8_t lying_pct_on_noise = 0;
+    for (uint32_t t = 0; t < 2500; t += 100) {
+        bool fallen = t >= 2000;
+        RadarMessage m1 = { .module_id = 1, .timestamp = t, .distance_mm = 2000, .signal = 70,
+                            .posture = fallen ? RADAR_POSTURE_LYING : RADAR_POSTURE_STANDING };
+        RadarMessage m2 = { .module_id = 2, .timestamp = t + 20, .distance_mm = 2400, .signal = 70,
+                            .posture = fallen || t == 1000 ? RADAR_POSTURE_LYING : RADAR_POSTURE_STANDING };
+        for (int k = 0; k < 2; k++) {
+            const RadarMessage *m = k == 0 ? &m1 : &m2;
+            if (fusion_engine_update(&test_fusion, m, m->timestamp, &set) != FUSION_FUSED) {
+                continue;
+            }
+            if (!fallen) {
+                flipped_on_noise = flipped_on_noise || set.posture != RADAR_POSTURE_STANDING;
+                lying_pct_on_noise = t == 1000 ? set.posture_pct[RADAR_POSTURE_LYING] : lying_pct_on_noise;
+            } else if (set.timestamp >= 2000) {
+                sets_after_fall++;
+                sets_to_lying = sets_to_lying < 0 && set.posture == RADAR_POSTURE_LYING ? sets_after_fall : sets_to_lying;
+            }
+        }
+    }
+
+    if (!flipped_on_noise && lying_pct_on_noise > 0 && lying_pct_on_noise < 50 && sets_to_lying == 1) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: One noisy LYING frame kept STANDING (lying %u %%), real fall LYING on the first set.",
+                 lying_pct_on_noise);
     } else {
-        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Unsynchronized data produced an output.");
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: flipped on noise %d (lying %u %%), LYING after %d sets.",
+                 flipped_on_noise, lying_pct_on_noise, sets_to_lying);
     }
 }
 
-void test_calculate_xy_stub() {
-    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_calculate_xy_stub");
-    float x, y;
-    bool result = calculate_xy_position(2.0f, 2.1f, &x, &y);
+void test_fusion_clock_offsets() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_clock_offsets");
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+
+    // Slave 2 booted 3 minutes after slave 1: its clock is 180 s behind. Both
+    // sample every 100 ms, 40 ms apart, received 5 ms later by the master.
+    // Module 2 walks away at 1 m/s: its reading at the reference time of
+    // module 1 is interpolated between its two samples around it.
+    bool fused_before = false, fused = false;
+    for (uint32_t i = 0; i < 3; i++) {
+        RadarMessage m1 = { .module_id = 1, .timestamp = 200000 + 100 * i, .distance_mm = 1500 };
+        RadarMessage m2 = { .module_id = 2, .timestamp = 20040 + 100 * i, .distance_mm = (uint16_t)(2040 + 100 * i) };
+        fused_before = fused_before || fused;
+        fused = fusion_engine_update(&test_fusion, &m1, 5005 + 100 * i, &set) == FUSION_FUSED;
+        fused = fusion_engine_update(&test_fusion, &m2, 5045 + 100 * i, &set) == FUSION_FUSED || fused;
+    }
+
+    // Last set: reference 5205 (module 1, master clock), module 2 between 5145 and 5245
+    if (fused && set.count == 2 && set.timestamp == 5205 && set.readings[0].distance_mm == 1500 &&
+        set.readings[1].distance_mm == 2200 && set.extrapolated_mask == 0) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Slave clocks 180 s apart fused at %u ms, module 2 interpolated to %u mm.",
+                 set.timestamp, set.readings[1].distance_mm);
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: fused %d (%d), ts %u, distances %u / %u mm.", fused, fused_before,
+                 set.timestamp, set.readings[0].distance_mm, set.readings[1].distance_mm);
+    }
+}
+
+void test_fusion_degraded_mode() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_degraded_mode");
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+
+    // Both modules every 100 ms for 2 s, module 2 silent from 2 s to 5 s, then back
+    uint32_t last_of_2 = 0, entered_at = 0, left_at = 0, back_at = 0;
+    int sets_while_silent = 0, degraded_sets = 0, single_sets = 0, normal_sets = 0;
+    for (uint32_t t = 0; t < 7000; t += 100) {
+        bool silent = t >= 2000 && t < 5000;
+        RadarMessage m1 = { .module_id = 1, .timestamp = t, .distance_mm = 1800, .posture = RADAR_POSTURE_STANDING, .signal = 60 };
+        RadarMessage m2 = { .module_id = 2, .timestamp = t + 30, .distance_mm = 2500, .posture = RADAR_POSTURE_STANDING };
+        bool was_degraded = test_fusion.rooms[0].degraded;
+        if (fusion_engine_update(&test_fusion, &m1, t + 5, &set) == FUSION_FUSED) {
+            sets_while_silent += silent && set.degraded;
+            degraded_sets += set.degraded;
+            single_sets += set.degraded && set.count == 1 && set.readings[0].module_id == 1;
+            normal_sets += !set.degraded && set.count == 2;
+        }
+        entered_at = !was_degraded && test_fusion.rooms[0].degraded ? t + 5 : entered_at;
+        if (!silent) {
+            was_degraded = test_fusion.rooms[0].degraded;
+            back_at = t >= 5000 && back_at == 0 ? t + 35 : back_at;
+            if (fusion_engine_update(&test_fusion, &m2, t + 35, &set) == FUSION_FUSED) {
+                normal_sets += !set.degraded && set.count == 2;
+            }
+            left_at = was_degraded && !test_fusion.rooms[0].degraded ? t + 35 : left_at;
+            last_of_2 = t < 2000 ? t + 35 : last_of_2;
+        }
+    }
+    uint32_t window = test_fusion.rooms[0].slots[1].window_ms;
+    uint32_t enter_delay = entered_at - last_of_2, leave_delay = left_at - back_at;
+
+    if (entered_at != 0 && enter_delay <= FUSION_ABSENT_WINDOWS * window + 100 && left_at != 0 && leave_delay == 0 &&
+        sets_while_silent >= 25 && single_sets == degraded_sets && normal_sets >= 35 &&
+        test_fusion.rooms[0].degraded_count == 1) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Degraded %u ms after module 2 went silent (window %u ms), %d single-module sets, restored on its first reading.",
+                 enter_delay, window, sets_while_silent);
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: entered %u ms after (window %u), left %d (delay %u), %d/%d degraded sets, %d normal, %u entries.",
+                 enter_delay, window, left_at != 0, leave_delay, single_sets, degraded_sets, normal_sets,
+                 test_fusion.rooms[0].degraded_count);
+    }
+}
+
+// Replay of two slaves over 60 s: 100 ms sampling with 3 ms of scheduling
+// jitter, clocks 186 s apart, 2 % loss. Module 1 is on a quiet link (a few
+// ms of delay); module 2 sleeps between beacons (Wi-Fi power save): 10 ms of
+// mean delay and 10 % of its samples 100 to 200 ms late. The person walks
+// back and forth (up to 0.6 m/s radial). Counts the fused sets and the
+// distance error at the reference time, against the newest raw samples.
+#define REPLAY_MS      60000
+#define REPLAY_PERIOD  100
+#define REPLAY_SAMPLES (REPLAY_MS / REPLAY_PERIOD)
+
+typedef struct {
+    uint32_t emitted, arrival; // Master clock
+    bool lost;
+} replay_sample_t;
+
+static uint32_t replay_rng = 99;
+
+static float replay_uniform(void) {
+    replay_rng = replay_rng * 1664525u + 1013904223u;
+    return (float)((replay_rng >> 8) + 1) / 16777217.0f;
+}
+
+static float replay_range_m(int module, float t_ms) {
+    return 2.0f + 0.8f * sinf(6.2831853f * t_ms / 8000.0f + (float)module);
+}
+
+void test_fusion_replay_with_jitter() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_replay_with_jitter");
+    static replay_sample_t stream[2][REPLAY_SAMPLES];
+    static const uint32_t boot_ms[2] = { 1234, 187500 };      // Master time of each slave boot
+    static const float mean_delay_ms[2] = { 3.0f, 10.0f };
+    static const float late_ratio[2] = { 0.0f, 0.10f };
+    for (int m = 0; m < 2; m++) {
+        uint32_t previous_arrival = 0;
+        for (int i = 0; i < REPLAY_SAMPLES; i++) {
+            replay_sample_t *r = &stream[m][i];
+            r->emitted = 200000 + (uint32_t)(i * REPLAY_PERIOD + m * 50) + (uint32_t)(3.0f * replay_uniform());
+            float delay = 2.0f - mean_delay_ms[m] * logf(replay_uniform());
+            if (replay_uniform() < late_ratio[m]) {
+                delay += 100.0f + 100.0f * replay_uniform();
+            }
+            r->arrival = r->emitted + (uint32_t)delay;
+            r->arrival = r->arrival < previous_arrival ? previous_arrival : r->arrival; // One link, in order
+            previous_arrival = r->arrival;
+            r->lost = replay_uniform() < 0.02f;
+        }
+    }
+
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 2, "");
+    int next[2] = { 0, 0 }, fused = 0, errors = 0;
+    uint16_t raw_mm[2] = { 0, 0 };
+    double aligned_err2 = 0.0, raw_err2 = 0.0;
+    while (next[0] < REPLAY_SAMPLES || next[1] < REPLAY_SAMPLES) {
+        int m = next[1] >= REPLAY_SAMPLES ||
+                (next[0] < REPLAY_SAMPLES && stream[0][next[0]].arrival <= stream[1][next[1]].arrival) ? 0 : 1;
+        const replay_sample_t *r = &stream[m][next[m]++];
+        if (r->lost) {
+            continue;
+        }
+        RadarMessage msg = {
+            .module_id = (uint8_t)(m + 1),
+            .timestamp = r->emitted - boot_ms[m],
+            .distance_mm = (uint16_t)(1000.0f * replay_range_m(m, (float)r->emitted) + 0.5f),
+            .posture = RADAR_POSTURE_MOVING,
+        };
+        raw_mm[m] = msg.distance_mm;
+        if (fusion_engine_update(&test_fusion, &msg, r->arrival, &set) != FUSION_FUSED) {
+            continue;
+        }
+        fused++;
+        // Reference time back to emission time: the offset is the smallest delay, 2 ms
+        float t_ref = (float)(set.timestamp - 2);
+        for (int i = 0; i < set.count; i++) {
+            int k = set.readings[i].module_id - 1;
+            float truth = 1000.0f * replay_range_m(k, t_ref);
+            float aligned = (float)set.readings[i].distance_mm - truth;
+            float raw = (float)raw_mm[k] - 1000.0f * replay_range_m(k, t_ref);
+            aligned_err2 += aligned * aligned;
+            raw_err2 += raw * raw;
+            errors++;
+        }
+    }
+    float rate = fused * 1000.0f / REPLAY_MS;
+    float aligned_rms = sqrtf((float)(aligned_err2 / (errors ? errors : 1)));
+    float raw_rms = sqrtf((float)(raw_err2 / (errors ? errors : 1)));
+    uint32_t window1 = test_fusion.rooms[0].slots[0].window_ms, window2 = test_fusion.rooms[0].slots[1].window_ms;
+
+    // 2 % loss per module, late samples: about 1 round in 10 without a set
+    if (rate >= 8.5f && rate <= 10.0f && aligned_rms < 10.0f && aligned_rms < raw_rms / 2.0f && window2 > window1 &&
+        window1 < SENSOR_SYNC_WINDOW_MS) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: %.1f fused sets/s for 10 samples/s per module; error %.1f mm aligned vs %.1f mm raw; windows %u / %u ms.",
+                 rate, aligned_rms, raw_rms, window1, window2);
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: %.1f fused sets/s, error %.1f mm aligned vs %.1f mm raw, windows %u / %u ms, %u expired.",
+                 rate, aligned_rms, raw_rms, window1, window2, test_fusion.rooms[0].expired_count);
+    }
+}
+
+void test_fusion_room_full_and_move() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_fusion_room_full_and_move");
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    bool filled = true;
+    for (int id = 1; id <= FUSION_SLOTS_PER_ROOM; id++) {
+        filled = filled && fusion_engine_assign(&test_fusion, id, "hall") == 0;
+    }
+    bool refused = fusion_engine_assign(&test_fusion, 100, "hall") == -1;
+    // Moving one module out frees its slot for the newcomer
+    bool moved = fusion_engine_assign(&test_fusion, 4, "bureau") == 1 && fusion_engine_room_of(&test_fusion, 4) == 1;
+    bool reused = fusion_engine_assign(&test_fusion, 100, "hall") == 0;
+
+    if (filled && refused && moved && reused) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: %d slots per room, moved module frees its slot.", FUSION_SLOTS_PER_ROOM);
+    } else {
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Slot assignment incorrect.");
+    }
+}
+
+void test_calculate_xy_unknown_module() {
+    ESP_LOGI(TAG_TEST_FUSION, "Running test: test_calculate_xy_unknown_module");
+    // Module 9 has no calibrated position: posture is fused, the position is unknown
+    RadarMessage msg1 = { .module_id = 1, .timestamp = 3000, .distance_mm = 1800, .posture = RADAR_POSTURE_SITTING, .signal = 80 };
+    RadarMessage msg9 = { .module_id = 9, .timestamp = 3050, .distance_mm = 2200, .posture = RADAR_POSTURE_STANDING, .signal = 30 };
+    FusedData fused_result;
+    fusion_set_t set;
+    fusion_engine_init(&test_fusion, SENSOR_SYNC_WINDOW_MS, 2);
+    fusion_engine_assign(&test_fusion, 1, "");
+    fusion_engine_assign(&test_fusion, 9, "");
+    update_room_geometry(0);
+    bool processed = feed_fusion((RadarMessage[]){ msg1, msg9 }, 2, &fused_result, &set);
 
-    if (result && x == 1.0f && y == 1.5f) { // Based on stub values
-        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: calculate_xy_position stub returned expected values (X=%.2f, Y=%.2f).", x, y);
+    if (processed && fused_result.posture == RADAR_POSTURE_SITTING && fused_result.sigma_cm == FUSED_SIGMA_UNKNOWN &&
+        fused_result.flags == FUSED_FLAG_PREDICTED && fused_result.track_id == FUSED_TRACK_NONE) {
+        ESP_LOGI(TAG_TEST_FUSION, "Test PASSED: Uncalibrated module fused without a position (no track, sigma unknown).");
     } else {
-        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: calculate_xy_position stub did not return expected values.");
+        ESP_LOGE(TAG_TEST_FUSION, "Test FAILED: Uncalibrated module handling incorrect.");
     }
 }
 
@@ -207,8 +624,17 @@ void run_fusion_engine_tests() {
     ESP_LOGI(TAG_TEST_FUSION, "--- Starting Fusion Engine Tests ---");
     test_parse_valid_json();
     test_parse_invalid_json();
+    test_parse_json_with_targets();
     test_fusion_synchronized_lying();
     test_fusion_unsynchronized();
-    test_calculate_xy_stub();
+    test_fusion_three_modules_quorum();
+    test_fusion_rooms_are_independent();
+    test_fusion_stale_reading_expires();
+    test_fusion_noisy_lying_frame();
+    test_fusion_clock_offsets();
+    test_fusion_degraded_mode();
+    test_fusion_replay_with_jitter();
+    test_fusion_room_full_and_move();
+    test_calculate_xy_unknown_module();
     ESP_LOGI(TAG_TEST_FUSION, "--- Finished Fusion Engine Tests ---");
 }
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "heatmap.h"
+
+// --- BEGIN NOTE ---
+// heatmap.c (master_firmware/main) is plain C: these tests check where the
+// time of each position lands, the half-life decay across the rescales of
+// the cells (against the decay computed directly), and the binary export
+// (header, tiles, normalisation, buffer too small). The cost per update and
+// the export time are in host_bench/bench_heatmap.c.
+// --- END NOTE ---
+
+static const char *TAG_TEST_HEATMAP = "TEST_HEATMAP";
+
+static float test_cells[32 * 32];
+
+static bool close_to(float a, float b, float rel) {
+    return fabsf(a - b) <= rel * (fabsf(b) > 1.0f ? fabsf(b) : 1.0f);
+}
+
+void test_heatmap_accumulates_time() {
+    ESP_LOGI(TAG_TEST_HEATMAP, "Running test: test_heatmap_accumulates_time");
+    heatmap_t hm;
+    bool rejected = !heatmap_init(&hm, test_cells, 255, 0, 0, 4000, 4000, 250, 60000, 0) && // 256 cells needed
+                    !heatmap_init(&hm, test_cells, 1024, 0, 0, 4000, 4000, 0, 60000, 0) &&
+                    !heatmap_init(&hm, test_cells, 1024, 0, 0, 4000, 4000, 250, 0, 0);
+    bool ok = heatmap_init(&hm, test_cells, 256, 0, 0, 4000, 4000, 250, 3600000, 0);
+    bool size = hm.cols == 16 && hm.rows == 16 && heatmap_cells_needed(0, 0, 4000, 3900, 250) == 256;
+
+    heatmap_add(&hm, 100, 100, 200, 1000);       // Cell (0, 0)
+    heatmap_add(&hm, 240, 249, 300, 1000);       // Same cell
+    heatmap_add(&hm, 3999, 2600, 500, 1000);     // Cell (15, 10)
+    heatmap_add(&hm, 4000, 100, 500, 1000);      // Off the grid
+    heatmap_add(&hm, -1, 100, 500, 1000);
+    bool placed = close_to(heatmap_cell_ms(&hm, 0, 0, 1000), 500.0f, 0.001f) &&
+                  close_to(heatmap_cell_ms(&hm, 15, 10, 1000), 500.0f, 0.001f) &&
+                  heatmap_cell_ms(&hm, 1, 0, 1000) == 0.0f && heatmap_cell_ms(&hm, 16, 0, 1000) == 0.0f &&
+                  hm.updates == 3 && hm.outside == 2;
+
+    if (rejected && ok && size && placed) {
+        ESP_LOGI(TAG_TEST_HEATMAP, "Test PASSED: Time added to the cell of each position, off-grid positions counted.");
+    } else {
+        ESP_LOGE(TAG_TEST_HEATMAP, "Test FAILED: rejected %d ok %d size %d placed %d (cell 0,0 %.1f ms, outside %u).",
+                 rejected, ok, size, placed, heatmap_cell_ms(&hm, 0, 0, 1000), hm.outside);
+    }
+}
+
+void test_heatmap_decay_and_rescale() {
+    ESP_LOGI(TAG_TEST_HEATMAP, "Running test: test_heatmap_decay_and_rescale");
+    heatmap_t hm;
+    const uint32_t half_life = 10000;
+    heatmap_init(&hm, test_cells, 256, 0, 0, 4000, 4000, 250, half_life, 0);
+    heatmap_add(&hm, 500, 500, 1000, 0);
+    bool halved = close_to(heatmap_cell_ms(&hm, 2, 2, half_life), 500.0f, 0.002f) &&
+                  close_to(heatmap_cell_ms(&hm, 2, 2, 3 * half_life), 125.0f, 0.002f);
+
+    // One update per second for 50 half-lives: several rescales. Expected
+    // value computed directly: sum of 1000 * 2^-(age / half-life)
+    double expected = 0.0;
+    uint32_t now = 0;
+    heatmap_init(&hm, test_cells, 256, 0, 0, 4000, 4000, 250, half_life, 0);
+    for (int i = 1; i <= 500; i++) {
+        now = (uint32_t)i * 1000u;
+        heatmap_add(&hm, 1000, 1000, 1000, now);
+    }
+    for (int i = 1; i <= 500; i++) {
+        expected += 1000.0 * pow(2.0, -(double)(now - (uint32_t)i * 1000u) / half_life);
+    }
+    unsigned rescales = atomic_load(&hm.rescales);
+    float got = heatmap_cell_ms(&hm, 4, 4, now);
+    bool steady = close_to(got, (float)expected, 0.002f) && rescales >= 4 &&
+                  (rescales & 1u) == 0 && (int32_t)(now - hm.epoch_ms) < (int32_t)(16 * half_life);
+
+    // Across the 32-bit ms wrap
+    heatmap_init(&hm, test_cells, 256, 0, 0, 4000, 4000, 250, half_life, UINT32_MAX - 5000);
+    heatmap_add(&hm, 1000, 1000, 1000, UINT32_MAX - 5000);
+    bool wrapped = close_to(heatmap_cell_ms(&hm, 4, 4, UINT32_MAX - 5000 + half_life), 500.0f, 0.002f);
+
+    if (halved && steady && wrapped) {
+        ESP_LOGI(TAG_TEST_HEATMAP, "Test PASSED: Half-life decay kept across %u rescales (%.0f ms, expected %.0f).",
+                 rescales / 2, got, expected);
+    } else {
+        ESP_LOGE(TAG_TEST_HEATMAP, "Test FAILED: halved %d steady %d wrapped %d, %u rescales, %.1f ms, expected %.1f.",
+                 halved, steady, wrapped, rescales, got, expected);
+    }
+}
+
+void test_heatmap_export() {
+    ESP_LOGI(TAG_TEST_HEATMAP, "Running test: test_heatmap_export");
+    heatmap_t hm;
+    heatmap_init(&hm, test_cells, 256, 0, 0, 4000, 3900, 250, 3600000, 0);  // 16 x 16 cells
+    heatmap_add(&hm, 100, 100, 4000, 1000);      // Tile (0, 0) of 4 x 4 cells
+    heatmap_add(&hm, 900, 900, 4000, 1000);      // Same tile: 8000 ms
+    heatmap_add(&hm, 3900, 3800, 2000, 1000);    // Tile (3, 3): 2000 ms
+
+    uint8_t buf[HEATMAP_EXPORT_HEADER_LEN + 256];
+    int n = heatmap_export(&hm, 7, 4, 1000, buf, sizeof(buf));
+    uint16_t tile_mm = (uint16_t)(buf[6] | buf[7] << 8);
+    uint32_t max_ms = (uint32_t)buf[8] | (uint32_t)buf[9] << 8 | (uint32_t)buf[10] << 16 | (uint32_t)buf[11] << 24;
+    uint32_t half_life_s = (uint32_t)buf[12] | (uint32_t)buf[13] << 8;
+    const uint8_t *tiles = buf + HEATMAP_EXPORT_HEADER_LEN;
+    int lit = 0;
+    for (int i = 0; i < 16; i++) {
+        lit += tiles[i] != 0;
+    }
+    bool header = n == HEATMAP_EXPORT_HEADER_LEN + 16 && memcmp(buf, "HM", 2) == 0 &&
+                  buf[2] == HEATMAP_EXPORT_VERSION && buf[3] == 7 && buf[4] == 4 && buf[5] == 4 && tile_mm == 1000 &&
+                  max_ms >= 7990 && max_ms <= 8000 && half_life_s == 3600; // Update scale shared within 3.5 s
+    uint8_t first = tiles[0], last = tiles[15];
+    bool tiles_ok = first == 255 && last == 64 && lit == 2;
+
+    int full = heatmap_export(&hm, 7, 1, 1000, buf, sizeof(buf));  // Every cell
+    bool small = heatmap_export(&hm, 7, 1, 1000, buf, 100) == 0 && heatmap_export(&hm, 7, 0, 1000, buf, sizeof(buf)) == 0;
+    heatmap_t empty;
+    heatmap_init(&empty, test_cells, 256, 0, 0, 4000, 4000, 250, 60000, 0);
+    int zero = heatmap_export(&empty, 0, 16, 0, buf, sizeof(buf));
+    bool blank = zero == HEATMAP_EXPORT_HEADER_LEN + 1 && buf[HEATMAP_EXPORT_HEADER_LEN] == 0 && buf[8] == 0;
+
+    if (header && tiles_ok && full == HEATMAP_EXPORT_HEADER_LEN + 256 && small && blank) {
+        ESP_LOGI(TAG_TEST_HEATMAP, "Test PASSED: 16 x 16 cells exported as 4 x 4 tiles of 1 m in %d bytes.", n);
+    } else {
+        ESP_LOGE(TAG_TEST_HEATMAP, "Test FAILED: %d bytes, header %d (tile %u mm, max %u ms), tiles %u/%u lit %d, "
+                 "full %d small %d blank %d.", n, header, tile_mm, max_ms, first, last, lit, full, small, blank);
+    }
+}
+
+void run_heatmap_tests() {
+    ESP_LOGI(TAG_TEST_HEATMAP, "--- Starting Heatmap Tests ---");
+    test_heatmap_accumulates_time();
+    test_heatmap_decay_and_rescale();
+    test_heatmap_export();
+    ESP_LOGI(TAG_TEST_HEATMAP, "--- Finished Heatmap Tests ---");
+}
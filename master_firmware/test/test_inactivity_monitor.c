@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "inactivity_monitor.h"
+
+// --- BEGIN NOTE ---
+// inactivity_monitor.c (master_firmware/main) is plain C: these tests feed it
+// fused outputs of a person sitting still (position and speed noise below the
+// motion thresholds) and check when each alert level is raised, the weights
+// (zone, lying, night), what counts as motion (speed, creeping displacement,
+// posture) and what does not (another person standing still, predictions),
+// and the disarming of an empty room.
+// --- END NOTE ---
+
+static const char *TAG_TEST_INACTIVITY = "TEST_INACTIVITY";
+
+static const inactivity_config_t test_cfg = {
+    .level_s = { 600, 1200, 2400 },
+    .motion_speed_mm_s = 200,
+    .motion_mm = 300,
+    .lying_pct = 25,
+    .night_pct = 300,
+    .night_start_min = 22 * 60,
+    .night_end_min = 7 * 60,
+    .absent_ms = 60000,
+};
+
+static FusedData still_output(uint32_t now_ms, uint8_t track, int16_t x_mm, int16_t vx_mm_s) {
+    FusedData d = { 0 };
+    d.timestamp = now_ms;
+    d.x_mm = x_mm;
+    d.y_mm = 2000;
+    d.vx_mm_s = vx_mm_s;
+    d.vy_mm_s = 10;
+    d.posture = RADAR_POSTURE_SITTING;
+    d.sigma_cm = 20;
+    d.track_id = track;
+    d.occupants = 1;
+    return d;
+}
+
+void test_inactivity_graded_levels() {
+    ESP_LOGI(TAG_TEST_INACTIVITY, "Running test: test_inactivity_graded_levels");
+    inactivity_room_t room;
+    inactivity_room_init(&room);
+    uint32_t raised_ms[INACTIVITY_LEVELS + 1] = { 0 };
+    int raised = 0;
+    uint8_t ended_early = 0;
+    for (uint32_t t = 1000; t <= 3000000; t += 1000) {
+        int16_t jitter = (int16_t)((t / 1000) % 7) * 10 - 30;
+        FusedData d = still_output(t, 1, (int16_t)(1500 + jitter), jitter);
+        ended_early |= inactivity_update(&test_cfg, &room, &d, INACTIVITY_WEIGHT_DEFAULT);
+        uint8_t level = inactivity_check(&test_cfg, &room, t + 500);
+        if (level != 0 && raised <= INACTIVITY_LEVELS) {
+            raised_ms[raised++] = t + 500;
+        }
+    }
+    // First output at 1000 ms: levels at 600, 1200 and 2400 s after it
+    bool levels = raised == INACTIVITY_LEVELS && raised_ms[0] == 601500 && raised_ms[1] == 1201500 &&
+                  raised_ms[2] == 2401500 && room.level == INACTIVITY_LEVELS && ended_early == 0 &&
+                  inactivity_still_ms(&room, 3000000) == 2999000;
+
+    FusedData walk = still_output(3001000, 1, 1500, 600);
+    uint8_t ended = inactivity_update(&test_cfg, &room, &walk, INACTIVITY_WEIGHT_DEFAULT);
+    bool cleared = ended == INACTIVITY_LEVELS && room.level == 0 && inactivity_still_ms(&room, 3002000) == 1000 &&
+                   inactivity_check(&test_cfg, &room, 3002000) == 0 && room.due_ms == 3601000;
+
+    if (levels && cleared) {
+        ESP_LOGI(TAG_TEST_INACTIVITY, "Test PASSED: Levels raised at 10, 20 and 40 min of stillness, cleared by a walk.");
+    } else {
+        ESP_LOGE(TAG_TEST_INACTIVITY, "Test FAILED: %d levels at %u/%u/%u ms, ended %u (early %u), cleared %d.",
+                 raised, raised_ms[0], raised_ms[1], raised_ms[2], ended, ended_early, cleared);
+    }
+}
+
+void test_inactivity_weights() {
+    ESP_LOGI(TAG_TEST_INACTIVITY, "Running test: test_inactivity_weights");
+    bool weights = inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_SITTING, 12 * 60) == 100 &&
+                   inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_SITTING, 23 * 60) == 300 &&
+                   inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_SITTING, 3 * 60) == 300 &&
+                   inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_SITTING, 7 * 60) == 100 &&
+                   inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_SITTING, -1) == 100 &&
+                   inactivity_weight_pct(&test_cfg, 0, RADAR_POSTURE_LYING, 3 * 60) == 25 &&
+                   inactivity_weight_pct(&test_cfg, 400, RADAR_POSTURE_LYING, 3 * 60) == 400;
+
+    // Lying on the floor: a quarter of the delays. The person then moves
+    // into a zone at 50 %: the next level is rescheduled from the last motion.
+    inactivity_config_t cfg = test_cfg;
+    cfg.absent_ms = 3600000; // Checks far from the last output below
+    inactivity_room_t room;
+    inactivity_room_init(&room);
+    FusedData d = still_output(0, 1, 1500, 0);
+    d.posture = RADAR_POSTURE_LYING;
+    inactivity_update(&cfg, &room, &d, 25);
+    uint32_t first = 0;
+    for (uint32_t t = 1000; t <= 200000 && first == 0; t += 1000) {
+        d.timestamp = t;
+        inactivity_update(&cfg, &room, &d, 25);
+        first = inactivity_check(&cfg, &room, t) == 1 ? t : 0;
+    }
+    d.timestamp = 151000;
+    inactivity_update(&cfg, &room, &d, 50);
+    bool rescheduled = room.due_ms == 600000 && inactivity_check(&cfg, &room, 599000) == 0 &&
+                       inactivity_check(&cfg, &room, 600000) == 2;
+    // Shorter weight with a level already overdue: raised at the next check
+    inactivity_update(&cfg, &room, &d, 10);
+    bool overdue = inactivity_check(&cfg, &room, 600000) == 3 && inactivity_check(&cfg, &room, 601000) == 0;
+
+    if (weights && first == 150000 && rescheduled && overdue) {
+        ESP_LOGI(TAG_TEST_INACTIVITY, "Test PASSED: Delays weighted by zone, lying and night, rescheduled in O(1).");
+    } else {
+        ESP_LOGE(TAG_TEST_INACTIVITY, "Test FAILED: weights %d, first level at %u ms, rescheduled %d, overdue %d.",
+                 weights, first, rescheduled, overdue);
+    }
+}
+
+void test_inactivity_motion_sources() {
+    ESP_LOGI(TAG_TEST_INACTIVITY, "Running test: test_inactivity_motion_sources");
+    inactivity_room_t room;
+    inactivity_room_init(&room);
+    FusedData d = still_output(1000, 1, 1500, 0);
+    inactivity_update(&test_cfg, &room, &d, 100);
+
+    // Creeping 20 mm per output, each step below the speed threshold: motion once 300 mm away
+    uint32_t crept_ms = 0;
+    for (int i = 1; i <= 20 && crept_ms == 0; i++) {
+        d = still_output(1000 + (uint32_t)i * 1000, 1, (int16_t)(1500 + 20 * i), 20);
+        inactivity_update(&test_cfg, &room, &d, 100);
+        crept_ms = room.last_motion_ms != 1000 ? d.timestamp : 0;
+    }
+    // A second person standing still, predictions with a stale speed: no motion
+    FusedData other = still_output(18000, 2, 500, 0);
+    FusedData predicted = still_output(19000, 1, 1800, 900);
+    predicted.flags = FUSED_FLAG_PREDICTED;
+    inactivity_update(&test_cfg, &room, &other, 100);
+    inactivity_update(&test_cfg, &room, &predicted, 100);
+    bool ignored = room.last_motion_ms == crept_ms && room.anchor_track == 1;
+    // A posture change of the followed person is motion
+    d = still_output(20000, 1, 1800, 0);
+    d.posture = RADAR_POSTURE_LYING;
+    inactivity_update(&test_cfg, &room, &d, 100);
+    bool posture = room.last_motion_ms == 20000;
+
+    // No output for absent_ms: the room is empty, nothing raised, rearmed by the next arrival
+    bool empty = inactivity_check(&test_cfg, &room, 80000) == 0 && !room.armed &&
+                 inactivity_check(&test_cfg, &room, 2000000) == 0 && inactivity_still_ms(&room, 2000000) == 0;
+    d = still_output(2000000, 3, 1000, 0);
+    inactivity_update(&test_cfg, &room, &d, 100);
+    bool rearmed = room.armed && room.anchor_track == 3 && room.due_ms == 2600000;
+
+    if (crept_ms == 16000 && ignored && posture && empty && rearmed) {
+        ESP_LOGI(TAG_TEST_INACTIVITY, "Test PASSED: Speed, creeping and posture count as motion, others do not.");
+    } else {
+        ESP_LOGE(TAG_TEST_INACTIVITY, "Test FAILED: crept at %u ms, ignored %d, posture %d, empty %d, rearmed %d.",
+                 crept_ms, ignored, posture, empty, rearmed);
+    }
+}
+
+void run_inactivity_monitor_tests() {
+    ESP_LOGI(TAG_TEST_INACTIVITY, "--- Starting Inactivity Monitor Tests ---");
+    test_inactivity_graded_levels();
+    test_inactivity_weights();
+    test_inactivity_motion_sources();
+    ESP_LOGI(TAG_TEST_INACTIVITY, "--- Finished Inactivity Monitor Tests ---");
+}
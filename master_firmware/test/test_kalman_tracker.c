@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "kalman_tracker.h"
+
+// --- BEGIN NOTE ---
+// kalman_tracker.c (master_firmware/main) is plain C, so these tests run the
+// real per-room tracker of the FusionEngine task on synthetic walks: a known
+// trajectory, noisy position measurements every 200 ms (5 fused sets per
+// second), and checks on the filtered state.
+// --- END NOTE ---
+
+static const char *TAG_TEST_KALMAN = "TEST_KALMAN_TRACKER";
+
+#define STEP_MS 200
+
+static uint32_t rng_state;
+
+static float rng_gauss(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    float u1 = (float)((rng_state >> 8) + 1) / 16777217.0f;
+    rng_state = rng_state * 1664525u + 1013904223u;
+    float u2 = (float)((rng_state >> 8) + 1) / 16777217.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+static kalman_meas_t noisy(float x, float y, float sigma) {
+    kalman_meas_t m = { x + sigma * rng_gauss(), y + sigma * rng_gauss(), sigma * sigma, 0.0f, sigma * sigma };
+    return m;
+}
+
+void test_kalman_smooths_walk() {
+    ESP_LOGI(TAG_TEST_KALMAN, "Running test: test_kalman_smooths_walk");
+    kalman_track_t t;
+    kalman_track_init(&t, KALMAN_DEFAULT_ACCEL_SIGMA);
+    rng_state = 42;
+
+    // 0.8 m/s along x, 0.3 m/s along y, 15 cm measurement noise, 10 s
+    const float sigma = 0.15f, vx = 0.8f, vy = 0.3f;
+    double raw2 = 0.0, filt2 = 0.0;
+    int n = 0;
+    for (uint32_t ms = 0; ms <= 10000; ms += STEP_MS) {
+        float x = 0.5f + vx * ms / 1000.0f, y = 1.0f + vy * ms / 1000.0f;
+        kalman_meas_t m = noisy(x, y, sigma);
+        kalman_track_step(&t, 100000 + ms, &m);
+        if (ms >= 2000) { // After convergence
+            raw2 += (m.x - x) * (m.x - x) + (m.y - y) * (m.y - y);
+            filt2 += (t.s[0] - x) * (t.s[0] - x) + (t.s[1] - y) * (t.s[1] - y);
+            n++;
+        }
+    }
+    double raw = sqrt(raw2 / n), filtered = sqrt(filt2 / n);
+    float speed_error = hypotf(t.s[2] - vx, t.s[3] - vy);
+
+    if (filtered < 0.7 * raw && speed_error < 0.2f && t.starts == 1 && t.rejects == 0) {
+        ESP_LOGI(TAG_TEST_KALMAN, "Test PASSED: RMS error %.0f mm filtered vs %.0f mm raw, speed error %.2f m/s.",
+                 filtered * 1000.0, raw * 1000.0, speed_error);
+    } else {
+        ESP_LOGE(TAG_TEST_KALMAN, "Test FAILED: RMS %.0f mm filtered vs %.0f mm raw, speed error %.2f m/s, %u rejects.",
+                 filtered * 1000.0, raw * 1000.0, speed_error, (unsigned)t.rejects);
+    }
+}
+
+void test_kalman_gates_outlier() {
+    ESP_LOGI(TAG_TEST_KALMAN, "Running test: test_kalman_gates_outlier");
+    kalman_track_t t;
+    kalman_track_init(&t, KALMAN_DEFAULT_ACCEL_SIGMA);
+    rng_state = 7;
+    uint32_t ms = 0;
+    for (; ms < 3000; ms += STEP_MS) { // Person standing at (2, 2)
+        kalman_meas_t m = noisy(2.0f, 2.0f, 0.1f);
+        kalman_track_step(&t, ms, &m);
+    }
+    // One wrong trilateration (mirror solution, multipath): 1.8 m away.
+    // Rejected, the track must be exactly where a prediction alone puts it.
+    kalman_track_t predicted = t;
+    kalman_track_step(&predicted, ms, NULL);
+    kalman_meas_t outlier = { 2.0f, 0.2f, 0.01f, 0.0f, 0.01f };
+    kalman_result_t r = kalman_track_step(&t, ms, &outlier);
+    bool unchanged = memcmp(t.s, predicted.s, sizeof(t.s)) == 0 && memcmp(t.P, predicted.P, sizeof(t.P)) == 0;
+    float after = hypotf(t.s[0] - 2.0f, t.s[1] - 2.0f);
+    ms += STEP_MS;
+    kalman_meas_t good = noisy(2.0f, 2.0f, 0.1f);
+    kalman_result_t next = kalman_track_step(&t, ms, &good);
+
+    if (r == KALMAN_REJECTED && unchanged && after < 0.3f && next == KALMAN_UPDATED && t.rejects_in_row == 0) {
+        ESP_LOGI(TAG_TEST_KALMAN, "Test PASSED: 1.8 m outlier rejected by the gate, track predicted only (%.0f mm from truth).", after * 1000.0f);
+    } else {
+        ESP_LOGE(TAG_TEST_KALMAN, "Test FAILED: Outlier result %d, track moved %.2f m.", r, after);
+    }
+}
+
+void test_kalman_predicts_missing_sensors() {
+    ESP_LOGI(TAG_TEST_KALMAN, "Running test: test_kalman_predicts_missing_sensors");
+    kalman_track_t t;
+    kalman_track_init(&t, KALMAN_DEFAULT_ACCEL_SIGMA);
+    rng_state = 99;
+    uint32_t ms = 0;
+    for (; ms <= 4000; ms += STEP_MS) { // Walking at 1 m/s along y
+        kalman_meas_t m = noisy(1.0f, 0.5f + ms / 1000.0f, 0.1f);
+        kalman_track_step(&t, ms, &m);
+    }
+    float sigma_before = kalman_track_position_sigma(&t);
+    // 1 s of fused samples without a position: prediction only
+    kalman_result_t r = KALMAN_LOST;
+    for (ms = 4200; ms <= 5000; ms += STEP_MS) {
+        r = kalman_track_step(&t, ms, NULL);
+    }
+    float predicted_error = hypotf(t.s[0] - 1.0f, t.s[1] - 5.5f);
+    float sigma_after = kalman_track_position_sigma(&t);
+    // Still no measurement beyond KALMAN_MAX_COAST_MS: the track is dropped
+    kalman_result_t lost = kalman_track_step(&t, 4000 + KALMAN_MAX_COAST_MS + STEP_MS, NULL);
+
+    if (r == KALMAN_PREDICTED && predicted_error < 0.2f && sigma_after > sigma_before && lost == KALMAN_LOST) {
+        ESP_LOGI(TAG_TEST_KALMAN, "Test PASSED: 1 s predicted within %.0f mm, sigma %.0f -> %.0f mm, dropped after %d ms.",
+                 predicted_error * 1000.0f, sigma_before * 1000.0f, sigma_after * 1000.0f, KALMAN_MAX_COAST_MS);
+    } else {
+        ESP_LOGE(TAG_TEST_KALMAN, "Test FAILED: Prediction error %.2f m, sigma %.3f -> %.3f, result %d/%d.",
+                 predicted_error, sigma_before, sigma_after, r, lost);
+    }
+}
+
+void test_kalman_restarts_on_persistent_jump() {
+    ESP_LOGI(TAG_TEST_KALMAN, "Running test: test_kalman_restarts_on_persistent_jump");
+    kalman_track_t t;
+    kalman_track_init(&t, KALMAN_DEFAULT_ACCEL_SIGMA);
+    rng_state = 3;
+    uint32_t ms = 0;
+    for (; ms < 2000; ms += STEP_MS) {
+        kalman_meas_t m = noisy(0.5f, 0.5f, 0.05f);
+        kalman_track_step(&t, ms, &m);
+    }
+    // The person is now consistently measured 3 m away (another person, or the
+    // first position was wrong): after KALMAN_RESET_AFTER_REJECTS rejects the track restarts
+    kalman_result_t r = KALMAN_LOST;
+    int steps = 0;
+    while (r != KALMAN_STARTED && steps < 10) {
+        kalman_meas_t m = noisy(3.5f, 2.0f, 0.05f);
+        r = kalman_track_step(&t, ms, &m);
+        ms += STEP_MS;
+        steps++;
+    }
+
+    if (r == KALMAN_STARTED && steps == KALMAN_RESET_AFTER_REJECTS && t.starts == 2 && fabsf(t.s[0] - 3.5f) < 0.2f) {
+        ESP_LOGI(TAG_TEST_KALMAN, "Test PASSED: Track restarted after %d consistent rejects.", steps);
+    } else {
+        ESP_LOGE(TAG_TEST_KALMAN, "Test FAILED: Track restart after %d steps (result %d, starts %u).", steps, r, (unsigned)t.starts);
+    }
+}
+
+void run_kalman_tracker_tests() {
+    ESP_LOGI(TAG_TEST_KALMAN, "--- Starting Kalman Tracker Tests ---");
+    test_kalman_smooths_walk();
+    test_kalman_gates_outlier();
+    test_kalman_predicts_missing_sensors();
+    test_kalman_restarts_on_persistent_jump();
+    ESP_LOGI(TAG_TEST_KALMAN, "--- Finished Kalman Tracker Tests ---");
+}
@@ -9,6 +9,28 @@ static const char *TAG_TEST_MASTER_MAIN = "TEST_MASTER_MAIN";
 void run_fusion_engine_tests();
 void run_fall_detector_tests();
 void run_alert_manager_tests();
+void run_conn_supervisor_tests();
+void run_radar_wire_tests();
+void run_mqtt_broker_tests();
+void run_module_registry_tests();
+void run_mqtt5_props_tests();
+void run_pipeline_msgs_tests();
+void run_trilateration_tests();
+void run_kalman_tracker_tests();
+void run_multi_tracker_tests();
+void run_posture_hmm_tests();
+void run_fsm_engine_tests();
+void run_fall_features_tests();
+void run_posture_nn_tests();
+void run_pipeline_shard_tests();
+void run_spsc_ring_tests();
+void run_msg_bus_tests();
+void run_zone_engine_tests();
+void run_heatmap_tests();
+void run_inactivity_monitor_tests();
+void run_sensor_health_tests();
+void run_timer_wheel_tests();
+void run_alert_outbox_tests();
 // Add run_watchdog_tests(); if/when watchdog tests are created.
 
 // Simulated test application main function for the master firmware.
@@ -26,6 +48,72 @@ void app_main_test(void) {
     // Run tests from test_alert_manager.c
     run_alert_manager_tests();
 
+    // Run tests from test_conn_supervisor.c
+    run_conn_supervisor_tests();
+
+    // Run tests from test_radar_wire.c
+    run_radar_wire_tests();
+
+    // Run tests from test_mqtt_broker.c
+    run_mqtt_broker_tests();
+
+    // Run tests from test_module_registry.c
+    run_module_registry_tests();
+
+    // Run tests from test_mqtt5_props.c
+    run_mqtt5_props_tests();
+
+    // Run tests from test_pipeline_msgs.c
+    run_pipeline_msgs_tests();
+
+    // Run tests from test_trilateration.c
+    run_trilateration_tests();
+
+    // Run tests from test_kalman_tracker.c
+    run_kalman_tracker_tests();
+
+    // Run tests from test_multi_tracker.c
+    run_multi_tracker_tests();
+
+    // Run tests from test_posture_hmm.c
+    run_posture_hmm_tests();
+
+    // Run tests from test_fsm_engine.c
+    run_fsm_engine_tests();
+
+    // Run tests from test_fall_features.c
+    run_fall_features_tests();
+
+    // Run tests from test_posture_nn.c
+    run_posture_nn_tests();
+
+    // Run tests from test_pipeline_shard.c
+    run_pipeline_shard_tests();
+
+    // Run tests from test_spsc_ring.c
+    run_spsc_ring_tests();
+
+    // Run tests from test_msg_bus.c
+    run_msg_bus_tests();
+
+    // Run tests from test_zone_engine.c
+    run_zone_engine_tests();
+
+    // Run tests from test_heatmap.c
+    run_heatmap_tests();
+
+    // Run tests from test_inactivity_monitor.c
+    run_inactivity_monitor_tests();
+
+    // Run tests from test_sensor_health.c
+    run_sensor_health_tests();
+
+    // Run tests from test_timer_wheel.c
+    run_timer_wheel_tests();
+
+    // Run tests from test_alert_outbox.c
+    run_alert_outbox_tests();
+
     // Placeholder for Watchdog tests if they were part of this suite
     // ESP_LOGI(TAG_TEST_MASTER_MAIN, "--- Watchdog tests would run here (if implemented) ---");
     // run_watchdog_tests(); 
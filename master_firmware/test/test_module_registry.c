@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "module_registry.h"
+
+// --- BEGIN NOTE ---
+// module_registry.c is plain C with no FreeRTOS dependency (locking is done by
+// main.c), so these tests drive the real implementation with explicit times.
+// --- END NOTE ---
+
+static const char *TAG_TEST_REGISTRY = "TEST_MODULE_REGISTRY";
+
+static module_registry_t test_registry; // Static: ~8 KB, keep it off the test task stack
+
+void test_registry_first_seen_traffic_and_mdns_merge() {
+    ESP_LOGI(TAG_TEST_REGISTRY, "Running test: test_registry_first_seen_traffic_and_mdns_merge");
+    module_registry_init(&test_registry);
+
+    module_info_t *from_traffic = module_registry_note_sample(&test_registry, 7, 1000, NULL);
+    module_info_t *from_mdns = module_registry_note_announce(&test_registry, 7, 2000, "kitchen", "esp32-slave-7",
+                                                             0x0A01A8C0, "1.1.0");
+    module_info_t *found = module_registry_find(&test_registry, 7);
+
+    if (from_traffic != NULL && from_traffic == from_mdns && found == from_traffic &&
+        module_registry_count(&test_registry) == 1 &&
+        found->sources == (MODULE_SOURCE_TRAFFIC | MODULE_SOURCE_MDNS) &&
+        strcmp(found->room, "kitchen") == 0 && strcmp(found->firmware_version, "1.1.0") == 0 &&
+        found->first_seen_ms == 1000 && found->last_seen_ms == 1000 && found->sample_count == 1) {
+        ESP_LOGI(TAG_TEST_REGISTRY, "Test PASSED: Traffic and mDNS sightings merge into one module entry.");
+    } else {
+        ESP_LOGE(TAG_TEST_REGISTRY, "Test FAILED: Module entries not merged correctly.");
+    }
+}
+
+void test_registry_scales_and_rejects_invalid_ids() {
+    ESP_LOGI(TAG_TEST_REGISTRY, "Running test: test_registry_scales_and_rejects_invalid_ids");
+    module_registry_init(&test_registry);
+
+    bool all_added = true;
+    for (int id = 1; id <= MODULE_REGISTRY_MAX_MODULES; id++) {
+        all_added = all_added && module_registry_note_sample(&test_registry, id * 3, (uint32_t)id, NULL) != NULL;
+    }
+    bool full_rejected = module_registry_note_sample(&test_registry, 250, 99, NULL) == NULL && test_registry.rejected == 1;
+    bool invalid_rejected = module_registry_get_or_add(&test_registry, 0, 1) == NULL &&
+                            module_registry_get_or_add(&test_registry, 256, 1) == NULL &&
+                            module_registry_find(&test_registry, -1) == NULL;
+    module_info_t *last = module_registry_find(&test_registry, MODULE_REGISTRY_MAX_MODULES * 3);
+
+    int parsed = 0;
+    bool parse_ok = module_registry_parse_id("42", &parsed) && parsed == 42 &&
+                    !module_registry_parse_id("0", &parsed) && !module_registry_parse_id("3x", &parsed) &&
+                    !module_registry_parse_id("300", &parsed);
+
+    if (all_added && full_rejected && invalid_rejected && last != NULL && last->id == MODULE_REGISTRY_MAX_MODULES * 3 &&
+        parse_ok) {
+        ESP_LOGI(TAG_TEST_REGISTRY, "Test PASSED: %d modules registered, overflow and invalid ids rejected.",
+                 MODULE_REGISTRY_MAX_MODULES);
+    } else {
+        ESP_LOGE(TAG_TEST_REGISTRY, "Test FAILED: Registry capacity or id validation incorrect.");
+    }
+}
+
+void test_registry_back_online_clears_alert() {
+    ESP_LOGI(TAG_TEST_REGISTRY, "Running test: test_registry_back_online_clears_alert");
+    module_registry_init(&test_registry);
+
+    module_info_t *module = module_registry_note_sample(&test_registry, 2, 500, NULL);
+    module->online = false;
+    module->offline_alerted = true; // As set by the Watchdog
+    bool came_back = false;
+    module_registry_note_sample(&test_registry, 2, 9000, &came_back);
+
+    if (came_back && module->online && !module->offline_alerted && module->last_seen_ms == 9000) {
+        ESP_LOGI(TAG_TEST_REGISTRY, "Test PASSED: A sample after an offline alert marks the module back online.");
+    } else {
+        ESP_LOGE(TAG_TEST_REGISTRY, "Test FAILED: Back-online transition incorrect.");
+    }
+}
+
+void test_registry_sequence_drops_redeliveries() {
+    ESP_LOGI(TAG_TEST_REGISTRY, "Running test: test_registry_sequence_drops_redeliveries");
+    module_registry_init(&test_registry);
+
+    bool first = module_registry_check_sequence(&test_registry, 4, 100, 10);
+    bool next = module_registry_check_sequence(&test_registry, 4, 101, 20);
+    bool redelivered = module_registry_check_sequence(&test_registry, 4, 101, 30); // QoS 1 retransmission
+    bool after_gap = module_registry_check_sequence(&test_registry, 4, 105, 40);  // 102..104 lost
+    bool restarted = module_registry_check_sequence(&test_registry, 4, 3, 50);    // Slave NVS erased
+    bool after_restart = module_registry_check_sequence(&test_registry, 4, 4, 60);
+    module_info_t *module = module_registry_find(&test_registry, 4);
+
+    if (first && next && !redelivered && after_gap && restarted && after_restart && module != NULL &&
+        module->duplicates == 1 && module->samples_lost == 3) {
+        ESP_LOGI(TAG_TEST_REGISTRY, "Test PASSED: Duplicate dropped, 3 lost samples counted, restart accepted.");
+    } else {
+        ESP_LOGE(TAG_TEST_REGISTRY, "Test FAILED: Sequence tracking incorrect.");
+    }
+}
+
+void run_module_registry_tests() {
+    ESP_LOGI(TAG_TEST_REGISTRY, "--- Starting Module Registry Tests ---");
+    test_registry_first_seen_traffic_and_mdns_merge();
+    test_registry_scales_and_rejects_invalid_ids();
+    test_registry_back_online_clears_alert();
+    test_registry_sequence_drops_redeliveries();
+    ESP_LOGI(TAG_TEST_REGISTRY, "--- Finished Module Registry Tests ---");
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "mqtt5_props.h"
+
+// --- BEGIN NOTE ---
+// mqtt5_props lives in components/hlk_common and has no ESP-IDF dependency, so
+// these tests decode real MQTT 5 property blocks as the embedded broker and the
+// master receive them. The broker's alias handling over sockets is exercised by
+// host_bench/bench_mqtt5_bytes.
+// --- END NOTE ---
+
+static const char *TAG_TEST_MQTT5 = "TEST_MQTT5_PROPS";
+
+// PUBLISH properties as sent by a slave in MQTT 5 mode:
+// topic alias 1, user property m=7, user property s=123456
+static const uint8_t slave_props[] = {
+    0x23, 0x00, 0x01,
+    0x26, 0x00, 0x01, 'm', 0x00, 0x01, '7',
+    0x26, 0x00, 0x01, 's', 0x00, 0x06, '1', '2', '3', '4', '5', '6',
+};
+
+void test_mqtt5_varint_round_trip() {
+    ESP_LOGI(TAG_TEST_MQTT5, "Running test: test_mqtt5_varint_round_trip");
+    static const uint32_t values[] = { 0, 127, 128, 16383, 16384, 2097151, 2097152, 268435455 };
+    static const size_t sizes[] = { 1, 1, 2, 2, 3, 3, 4, 4 };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint8_t buf[4];
+        uint32_t decoded = 0;
+        size_t n = mqtt5_varint_encode(buf, values[i]);
+        ok = ok && n == sizes[i] && mqtt5_varint_decode(buf, n, &decoded) == (int)n && decoded == values[i];
+        ok = ok && (n == 1 || mqtt5_varint_decode(buf, n - 1, &decoded) == 0); // Truncated: need more bytes
+    }
+    const uint8_t too_long[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    uint32_t v;
+    ok = ok && mqtt5_varint_decode(too_long, sizeof(too_long), &v) == -1;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_MQTT5, "Test PASSED: Variable byte integers encode/decode at every size boundary.");
+    } else {
+        ESP_LOGE(TAG_TEST_MQTT5, "Test FAILED: Variable byte integer codec incorrect.");
+    }
+}
+
+void test_mqtt5_radar_user_properties() {
+    ESP_LOGI(TAG_TEST_MQTT5, "Running test: test_mqtt5_radar_user_properties");
+    uint32_t module_id = 0, sequence = 0;
+    bool found = mqtt5_props_find_user_u32(slave_props, sizeof(slave_props), RADAR_PROP_MODULE_ID, &module_id) &&
+                 mqtt5_props_find_user_u32(slave_props, sizeof(slave_props), RADAR_PROP_SEQUENCE, &sequence);
+    uint32_t unused;
+    bool absent = !mqtt5_props_find_user_u32(slave_props, sizeof(slave_props), "x", &unused);
+
+    size_t offset = 0;
+    mqtt5_prop_t prop;
+    bool alias_first = mqtt5_prop_next(slave_props, sizeof(slave_props), &offset, &prop) == 1 &&
+                       prop.id == MQTT5_PROP_TOPIC_ALIAS && prop.value == 1 && offset == 3;
+
+    if (found && module_id == 7 && sequence == 123456 && absent && alias_first &&
+        mqtt5_props_valid(slave_props, sizeof(slave_props))) {
+        ESP_LOGI(TAG_TEST_MQTT5, "Test PASSED: Module id and sequence read from the user properties.");
+    } else {
+        ESP_LOGE(TAG_TEST_MQTT5, "Test FAILED: User properties not decoded (m=%u s=%u).", module_id, sequence);
+    }
+}
+
+void test_mqtt5_malformed_blocks_rejected() {
+    ESP_LOGI(TAG_TEST_MQTT5, "Running test: test_mqtt5_malformed_blocks_rejected");
+    const uint8_t unknown_id[] = { 0x7F, 0x00 };
+    const uint8_t short_value[] = { 0x26, 0x00, 0x05, 'a', 'b' };       // Key claims 5 bytes
+    const uint8_t not_a_number[] = { 0x26, 0x00, 0x01, 's', 0x00, 0x02, '1', 'x' };
+    uint32_t v;
+
+    bool ok = !mqtt5_props_valid(unknown_id, sizeof(unknown_id)) &&
+              !mqtt5_props_valid(short_value, sizeof(short_value)) &&
+              !mqtt5_props_valid(slave_props, sizeof(slave_props) - 1) &&
+              mqtt5_props_valid(NULL, 0) &&
+              mqtt5_props_valid(not_a_number, sizeof(not_a_number)) &&
+              !mqtt5_props_find_user_u32(not_a_number, sizeof(not_a_number), "s", &v);
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_MQTT5, "Test PASSED: Truncated or unknown properties are rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_MQTT5, "Test FAILED: Malformed property block accepted.");
+    }
+}
+
+void run_mqtt5_props_tests() {
+    ESP_LOGI(TAG_TEST_MQTT5, "--- Starting MQTT 5 Property Tests ---");
+    test_mqtt5_varint_round_trip();
+    test_mqtt5_radar_user_properties();
+    test_mqtt5_malformed_blocks_rejected();
+    ESP_LOGI(TAG_TEST_MQTT5, "--- Finished MQTT 5 Property Tests ---");
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "mqtt_broker.h"
+
+// --- BEGIN NOTE ---
+// Only the broker's pure logic is exercised here (topic filter matching). The
+// socket side is measured by host_bench/bench_mqtt_broker, which drives the same
+// mqtt_broker.c with real MQTT clients on the loopback interface.
+// --- END NOTE ---
+
+static const char *TAG_TEST_BROKER = "TEST_MQTT_BROKER";
+
+static bool matches(const char *filter, const char *topic) {
+    return mqtt_topic_matches(filter, topic, strlen(topic));
+}
+
+void test_broker_topic_wildcards() {
+    ESP_LOGI(TAG_TEST_BROKER, "Running test: test_broker_topic_wildcards");
+    bool ok = matches("home/+/+", "home/room1/radar1") &&
+              matches("home/#", "home/room1/alert") &&
+              matches("home/#", "home") &&               // '#' also matches the parent level
+              matches("home/room1/radar1", "home/room1/radar1") &&
+              matches("+/+/alert", "home/room2/alert") &&
+              !matches("home/+", "home/room1/radar1") &&   // '+' is exactly one level
+              !matches("home/room1/radar1", "home/room1/radar12") &&
+              !matches("home/room1/radar12", "home/room1/radar1") &&
+              !matches("#", "$SYS/broker/uptime");        // Wildcards skip system topics
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_BROKER, "Test PASSED: '+' and '#' filters match as specified by MQTT 3.1.1.");
+    } else {
+        ESP_LOGE(TAG_TEST_BROKER, "Test FAILED: Topic filter matching incorrect.");
+    }
+}
+
+void test_broker_topic_not_nul_terminated() {
+    ESP_LOGI(TAG_TEST_BROKER, "Running test: test_broker_topic_not_nul_terminated");
+    // Topics come straight from the receive buffer: only topic_len bytes are valid.
+    const char buffer[] = "home/room1/radar1{\"id_module\":1}";
+    bool ok = mqtt_topic_matches("home/+/radar1", buffer, strlen("home/room1/radar1")) &&
+              !mqtt_topic_matches("home/+/radar1", buffer, strlen("home/room1/radar"));
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_BROKER, "Test PASSED: Matching honours topic_len on raw packet buffers.");
+    } else {
+        ESP_LOGE(TAG_TEST_BROKER, "Test FAILED: Matching read past topic_len.");
+    }
+}
+
+void run_mqtt_broker_tests() {
+    ESP_LOGI(TAG_TEST_BROKER, "--- Starting Embedded MQTT Broker Tests ---");
+    test_broker_topic_wildcards();
+    test_broker_topic_not_nul_terminated();
+    ESP_LOGI(TAG_TEST_BROKER, "--- Finished Embedded MQTT Broker Tests ---");
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "msg_pool.h"
+#include "msg_bus.h"
+#include "pipeline_msgs.h"
+
+// --- BEGIN NOTE ---
+// msg_pool.c and msg_bus.c (master_firmware/main) are plain C11 (stdatomic):
+// these tests publish and consume from one task, which checks the reference
+// counts, the return of the blocks to the pool, the fan-out to several
+// subscriber rings and the wake-up of a parked subscriber. The RAM and CPU
+// comparison with one copying ring per consumer is host_bench/bench_msg_bus.c.
+// --- END NOTE ---
+
+static const char *TAG_TEST_MSG_BUS = "TEST_MSG_BUS";
+
+#define TEST_POOL_BLOCKS 4
+static uint64_t pool_storage[MSG_POOL_STORAGE_LEN(sizeof(FusedData), TEST_POOL_BLOCKS) / sizeof(uint64_t)];
+
+void test_msg_pool_alloc_release() {
+    ESP_LOGI(TAG_TEST_MSG_BUS, "Running test: test_msg_pool_alloc_release");
+    msg_pool_t pool;
+    bool bad_args = !msg_pool_init(&pool, pool_storage, sizeof(pool_storage) - 1, sizeof(FusedData), TEST_POOL_BLOCKS) &&
+                    !msg_pool_init(&pool, (uint8_t *)pool_storage + 4, sizeof(pool_storage) - 8, 8, 1) &&
+                    !msg_pool_init(&pool, pool_storage, sizeof(pool_storage), 0, TEST_POOL_BLOCKS);
+    bool ok = msg_pool_init(&pool, pool_storage, sizeof(pool_storage), sizeof(FusedData), TEST_POOL_BLOCKS);
+
+    void *blocks[TEST_POOL_BLOCKS];
+    int distinct = 0;
+    for (int i = 0; i < TEST_POOL_BLOCKS; i++) {
+        blocks[i] = msg_pool_alloc(&pool);
+        distinct += blocks[i] != NULL && ((uintptr_t)blocks[i] & 7u) == 0 && (i == 0 || blocks[i] != blocks[i - 1]);
+        if (blocks[i] != NULL) {
+            memset(blocks[i], 0xA5, sizeof(FusedData)); // Must not spill into the next header
+        }
+    }
+    bool empty = msg_pool_alloc(&pool) == NULL;
+    bool refs_intact = msg_pool_refs(&pool, blocks[1]) == 1 && msg_pool_refs(&pool, blocks[2]) == 1;
+
+    msg_pool_retain(&pool, blocks[2], 1); // Second holder
+    msg_pool_release(&pool, blocks[2]);
+    bool still_held = msg_pool_alloc(&pool) == NULL && msg_pool_refs(&pool, blocks[2]) == 1;
+    msg_pool_release(&pool, blocks[2]);  // Last reference: back in the pool
+    void *again = msg_pool_alloc(&pool);
+    bool reused = again == blocks[2] && msg_pool_refs(&pool, again) == 1;
+
+    msg_pool_stats_t st;
+    for (int i = 0; i < TEST_POOL_BLOCKS; i++) {
+        msg_pool_release(&pool, blocks[i]); // Includes `again`
+    }
+    msg_pool_get_stats(&pool, &st);
+
+    if (bad_args && ok && distinct == TEST_POOL_BLOCKS && empty && refs_intact && still_held && reused &&
+        st.in_use == 0 && st.peak == TEST_POOL_BLOCKS && st.exhausted == 2 && st.count == TEST_POOL_BLOCKS) {
+        ESP_LOGI(TAG_TEST_MSG_BUS, "Test PASSED: %u blocks handed out, refused when empty, returned at the last release.",
+                 st.count);
+    } else {
+        ESP_LOGE(TAG_TEST_MSG_BUS, "Test FAILED: bad_args %d ok %d distinct %d empty %d refs %d held %d reused %d, "
+                 "stats in_use %u peak %u exhausted %u.", bad_args, ok, distinct, empty, refs_intact, still_held, reused,
+                 st.in_use, st.peak, st.exhausted);
+    }
+}
+
+void test_msg_bus_fan_out() {
+    ESP_LOGI(TAG_TEST_MSG_BUS, "Running test: test_msg_bus_fan_out");
+    msg_pool_t pool;
+    msg_pool_init(&pool, pool_storage, sizeof(pool_storage), sizeof(FusedData), TEST_POOL_BLOCKS);
+    static FusedData *slots_a[4], *slots_b[4], *slots_c[1];
+    static RadarMessage copies[4];
+    spsc_ring_t ring_a, ring_b, ring_c, ring_copy;
+    spsc_ring_init(&ring_a, slots_a, sizeof(FusedData *), 4);
+    spsc_ring_init(&ring_b, slots_b, sizeof(FusedData *), 4);
+    spsc_ring_init(&ring_c, slots_c, sizeof(FusedData *), 1);  // Slow consumer: one slot
+    spsc_ring_init(&ring_copy, copies, sizeof(RadarMessage), 4);
+    msg_bus_t bus;
+    msg_bus_init(&bus, &pool);
+    bool subscribed = msg_bus_subscribe(&bus, &ring_a, NULL, NULL) == 0 &&
+                      msg_bus_subscribe(&bus, &ring_b, NULL, NULL) == 1 &&
+                      msg_bus_subscribe(&bus, &ring_c, NULL, NULL) == 2 &&
+                      msg_bus_subscribe(&bus, &ring_copy, NULL, NULL) == -1; // Not a ring of pointers
+
+    int errors = 0;
+    FusedData *first = NULL;
+    for (uint8_t room = 0; room < 2; room++) {
+        FusedData *msg = (FusedData *)msg_pool_alloc(&pool);
+        memset(msg, 0, sizeof(*msg));
+        msg->room = room;
+        first = first != NULL ? first : msg;
+        errors += msg_bus_publish(&bus, msg) != (room == 0 ? 3u : 2u); // Ring c full for the second
+    }
+    // One block per message, shared: 3 references on the first, 2 on the second
+    FusedData *a[4], *b[4], *c[1];
+    uint32_t na = spsc_ring_pop_batch(&ring_a, a, 4), nb = spsc_ring_pop_batch(&ring_b, b, 4);
+    uint32_t nc = spsc_ring_pop_batch(&ring_c, c, 1);
+    errors += na != 2 || nb != 2 || nc != 1 || a[0] != first || b[0] != first || c[0] != first ||
+              a[1] != b[1] || a[1]->room != 1;
+    errors += msg_pool_refs(&pool, first) != 3 || msg_pool_refs(&pool, a[1]) != 2;
+
+    msg_pool_stats_t during;
+    msg_pool_get_stats(&pool, &during);
+    for (uint32_t i = 0; i < na; i++) {
+        msg_pool_release(&pool, a[i]);
+    }
+    for (uint32_t i = 0; i < nb; i++) {
+        msg_pool_release(&pool, b[i]);
+    }
+    msg_pool_stats_t after_ab;
+    msg_pool_get_stats(&pool, &after_ab);   // c still holds the first message
+    msg_pool_release(&pool, c[0]);
+    msg_pool_stats_t after;
+    msg_pool_get_stats(&pool, &after);
+    spsc_ring_stats_t rc;
+    spsc_ring_get_stats(&ring_c, &rc);
+
+    if (subscribed && errors == 0 && during.in_use == 2 && after_ab.in_use == 1 && after.in_use == 0 &&
+        bus.published == 2 && bus.unread == 0 && rc.dropped == 1) {
+        ESP_LOGI(TAG_TEST_MSG_BUS, "Test PASSED: 2 messages in 2 blocks for 3 subscribers, a full ring skipped.");
+    } else {
+        ESP_LOGE(TAG_TEST_MSG_BUS, "Test FAILED: subscribed %d, %d errors, in use %u/%u/%u, published %u unread %u "
+                 "dropped %u.", subscribed, errors, during.in_use, after_ab.in_use, after.in_use, bus.published,
+                 bus.unread, rc.dropped);
+    }
+}
+
+static int wake_calls;
+static void count_wake(void *ctx) {
+    (void)ctx;
+    wake_calls++;
+}
+
+void test_msg_bus_wake_and_unread() {
+    ESP_LOGI(TAG_TEST_MSG_BUS, "Running test: test_msg_bus_wake_and_unread");
+    msg_pool_t pool;
+    msg_pool_init(&pool, pool_storage, sizeof(pool_storage), sizeof(FusedData), TEST_POOL_BLOCKS);
+    static FusedData *slots[1];
+    spsc_ring_t ring;
+    spsc_ring_init(&ring, slots, sizeof(FusedData *), 1);
+    msg_bus_t bus;
+    msg_bus_init(&bus, &pool);
+
+    // No subscriber: the block goes straight back
+    bool none = msg_bus_publish(&bus, msg_pool_alloc(&pool)) == 0 && bus.unread == 1;
+    msg_bus_subscribe(&bus, &ring, count_wake, NULL);
+    wake_calls = 0;
+    msg_bus_publish(&bus, msg_pool_alloc(&pool));  // Consumer running: no wake-up
+    bool quiet = wake_calls == 0;
+    FusedData *got;
+    spsc_ring_pop_batch(&ring, &got, 1);
+    msg_pool_release(&pool, got);
+    bool parked = spsc_ring_park(&ring);
+    msg_bus_publish(&bus, msg_pool_alloc(&pool));  // Parked: woken once
+    msg_bus_publish(&bus, msg_pool_alloc(&pool));  // Ring full: lost, unread
+    bool woken = wake_calls == 1 && bus.unread == 2;
+    spsc_ring_pop_batch(&ring, &got, 1);
+    msg_pool_release(&pool, got);
+    msg_pool_stats_t st;
+    msg_pool_get_stats(&pool, &st);
+
+    if (none && quiet && parked && woken && st.in_use == 0 && bus.published == 4) {
+        ESP_LOGI(TAG_TEST_MSG_BUS, "Test PASSED: Parked subscriber woken once; unread messages returned to the pool.");
+    } else {
+        ESP_LOGE(TAG_TEST_MSG_BUS, "Test FAILED: none %d quiet %d parked %d woken %d (%d calls, unread %u), in use %u.",
+                 none, quiet, parked, woken, wake_calls, bus.unread, st.in_use);
+    }
+}
+
+void run_msg_bus_tests() {
+    ESP_LOGI(TAG_TEST_MSG_BUS, "--- Starting Message Pool and Bus Tests ---");
+    test_msg_pool_alloc_release();
+    test_msg_bus_fan_out();
+    test_msg_bus_wake_and_unread();
+    ESP_LOGI(TAG_TEST_MSG_BUS, "--- Finished Message Pool and Bus Tests ---");
+}
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "multi_tracker.h"
+
+// --- BEGIN NOTE ---
+// multi_tracker.c (master_firmware/main) is plain C, so these tests run the
+// real people tracker of the FusionEngine task: three calibrated sensors in a
+// 4 x 4 m room, ranges computed from known positions with 5 cm of noise, one
+// fused set every 200 ms. Each sensor reports at most one moving and one
+// static target, as the LD2410 does.
+// --- END NOTE ---
+
+static const char *TAG_TEST_MTT = "TEST_MULTI_TRACKER";
+
+#define STEP_MS 200
+#define SENSORS 3
+
+static const trilat_point_t sensor_pos[SENSORS] = { { 0.0f, 0.0f }, { 4.0f, 0.0f }, { 2.0f, 4.0f } };
+
+static uint32_t rng_state;
+
+static float rng_gauss(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    float u1 = (float)((rng_state >> 8) + 1) / 16777217.0f;
+    rng_state = rng_state * 1664525u + 1013904223u;
+    float u2 = (float)((rng_state >> 8) + 1) / 16777217.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+static void setup(mtt_room_t *room, trilat_geometry_t *g) {
+    static const trilat_bounds_t bounds = { 0.0f, 0.0f, 4.0f, 4.0f };
+    trilat_geometry_init(g, &bounds, TRILAT_DEFAULT_RANGE_SIGMA_M);
+    for (int k = 0; k < SENSORS; k++) {
+        trilat_geometry_set_sensor(g, k, sensor_pos[k].x, sensor_pos[k].y);
+    }
+    mtt_room_init(room, KALMAN_DEFAULT_ACCEL_SIGMA);
+}
+
+// Noisy range in mm from sensor k to (x, y); 0 when `present` is false
+static uint16_t range_mm(int k, float x, float y, bool present) {
+    if (!present) {
+        return 0;
+    }
+    float r = hypotf(x - sensor_pos[k].x, y - sensor_pos[k].y) + 0.05f * rng_gauss();
+    return (uint16_t)(r * 1000.0f + 0.5f);
+}
+
+static const mtt_track_t *closest_track(const mtt_room_t *room, float x, float y, float *distance) {
+    const mtt_track_t *best = NULL;
+    *distance = INFINITY;
+    for (int i = 0; i < MTT_MAX_TRACKS; i++) {
+        const mtt_track_t *t = &room->tracks[i];
+        float d = hypotf(t->kf.s[0] - x, t->kf.s[1] - y);
+        if (t->id != 0 && t->confirmed && d < *distance) {
+            best = t;
+            *distance = d;
+        }
+    }
+    return best;
+}
+
+void test_mtt_single_person_without_targets() {
+    ESP_LOGI(TAG_TEST_MTT, "Running test: test_mtt_single_person_without_targets");
+    mtt_room_t room;
+    trilat_geometry_t g;
+    setup(&room, &g);
+    rng_state = 11;
+
+    // Older slaves: detection distance only. One person walking at 0.5 m/s along x.
+    int confirmed_at = -1, confirmed = 0;
+    float x = 1.0f, y = 2.0f;
+    for (int step = 0; step < 30; step++) {
+        x = 1.0f + 0.5f * step * STEP_MS / 1000.0f;
+        mtt_scan_t scan;
+        mtt_scan_init(&scan);
+        for (int k = 0; k < SENSORS; k++) {
+            mtt_scan_add(&scan, k, range_mm(k, x, y, true), 0, 0, RADAR_POSTURE_MOVING, 80);
+        }
+        confirmed = mtt_room_step(&room, &g, 1000 + step * STEP_MS, &scan);
+        if (confirmed == 1 && confirmed_at < 0) {
+            confirmed_at = step;
+        }
+    }
+    float error;
+    const mtt_track_t *t = closest_track(&room, x, y, &error);
+
+    if (confirmed == 1 && confirmed_at == MTT_CONFIRM_HITS - 1 && t != NULL && error < 0.15f &&
+        t->posture == RADAR_POSTURE_MOVING && room.births == 1 && room.ghosts == 0) {
+        ESP_LOGI(TAG_TEST_MTT, "Test PASSED: One track, confirmed after %d sets, %.0f mm from the person.",
+                 confirmed_at + 1, error * 1000.0f);
+    } else {
+        ESP_LOGE(TAG_TEST_MTT, "Test FAILED: %d tracks (confirmed at set %d), %u births, %u ghosts.",
+                 confirmed, confirmed_at, (unsigned)room.births, (unsigned)room.ghosts);
+    }
+}
+
+void test_mtt_two_people_moving_and_static() {
+    ESP_LOGI(TAG_TEST_MTT, "Running test: test_mtt_two_people_moving_and_static");
+    mtt_room_t room;
+    trilat_geometry_t g;
+    setup(&room, &g);
+    rng_state = 23;
+
+    // A walks along y = 1 (moving target), B sits at (3, 3) (static target).
+    // Sensors 0 and 1 see A as their main target, sensor 2 sees B.
+    float ax = 0.6f, ay = 1.0f;
+    const float bx = 3.0f, by = 3.0f;
+    int confirmed = 0;
+    for (int step = 0; step < 40; step++) {
+        ax = 0.6f + 0.6f * step * STEP_MS / 1000.0f;
+        mtt_scan_t scan;
+        mtt_scan_init(&scan);
+        for (int k = 0; k < SENSORS; k++) {
+            uint16_t moving = range_mm(k, ax, ay, true), still = range_mm(k, bx, by, true);
+            uint16_t main_target = k < 2 ? moving : still;
+            mtt_scan_add(&scan, k, main_target, moving, still, k < 2 ? RADAR_POSTURE_MOVING : RADAR_POSTURE_SITTING, 80);
+        }
+        confirmed = mtt_room_step(&room, &g, 5000 + step * STEP_MS, &scan);
+    }
+    float error_a, error_b;
+    const mtt_track_t *a = closest_track(&room, ax, ay, &error_a);
+    const mtt_track_t *b = closest_track(&room, bx, by, &error_b);
+
+    if (confirmed == 2 && a != NULL && b != NULL && a != b && error_a < 0.2f && error_b < 0.15f &&
+        a->posture == RADAR_POSTURE_MOVING && b->posture == RADAR_POSTURE_SITTING && room.births == 2) {
+        ESP_LOGI(TAG_TEST_MTT, "Test PASSED: Two tracks (ids %u, %u) within %.0f / %.0f mm, postures kept apart.",
+                 a->id, b->id, error_a * 1000.0f, error_b * 1000.0f);
+    } else {
+        ESP_LOGE(TAG_TEST_MTT, "Test FAILED: %d confirmed tracks, errors %.2f / %.2f m, %u births.",
+                 confirmed, error_a, error_b, (unsigned)room.births);
+    }
+}
+
+void test_mtt_ids_survive_close_ranges() {
+    ESP_LOGI(TAG_TEST_MTT, "Running test: test_mtt_ids_survive_close_ranges");
+    mtt_room_t room;
+    trilat_geometry_t g;
+    setup(&room, &g);
+    rng_state = 5;
+
+    // A walks from x = 3.5 to 0.4 along y = 2.2; B stands still at (2, 1.4).
+    // Below x = 1.8 both are within MTT_SAME_TARGET_MM of each other as seen
+    // from sensor 0: its two targets merge into one range, which only one
+    // track can take. Identities must not swap.
+    uint8_t id_a = 0, id_b = 0;
+    bool swapped = false;
+    int shared_sets = 0;
+    float ax = 3.5f;
+    const float ay = 2.2f, bx = 2.0f, by = 1.4f;
+    for (int step = 0; step < 26; step++) {
+        ax = 3.5f - 0.6f * step * STEP_MS / 1000.0f;
+        mtt_scan_t scan;
+        mtt_scan_init(&scan);
+        for (int k = 0; k < SENSORS; k++) {
+            uint16_t moving = range_mm(k, ax, ay, true), still = range_mm(k, bx, by, true);
+            mtt_scan_add(&scan, k, moving, moving, still, RADAR_POSTURE_MOVING, 80);
+        }
+        shared_sets += scan.kind[0][1] == 0;
+        mtt_room_step(&room, &g, step * STEP_MS, &scan);
+        float da, db;
+        const mtt_track_t *a = closest_track(&room, ax, ay, &da);
+        const mtt_track_t *b = closest_track(&room, bx, by, &db);
+        if (a != NULL && b != NULL && a != b) {
+            if (id_a == 0) {
+                id_a = a->id;
+                id_b = b->id;
+            }
+            swapped = swapped || a->id != id_a || b->id != id_b;
+        }
+    }
+
+    if (id_a != 0 && !swapped && shared_sets >= 5 && room.births == 2 && room.merges == 0) {
+        ESP_LOGI(TAG_TEST_MTT, "Test PASSED: Tracks %u and %u kept their person through %d sets of shared range.",
+                 id_a, id_b, shared_sets);
+    } else {
+        ESP_LOGE(TAG_TEST_MTT, "Test FAILED: ids %u/%u, swapped %d, %d shared sets, %u births, %u merges.",
+                 id_a, id_b, swapped, shared_sets, (unsigned)room.births, (unsigned)room.merges);
+    }
+}
+
+void test_mtt_ghost_and_death() {
+    ESP_LOGI(TAG_TEST_MTT, "Running test: test_mtt_ghost_and_death");
+    mtt_room_t room;
+    trilat_geometry_t g;
+    setup(&room, &g);
+    rng_state = 77;
+    uint32_t ms = 0;
+
+    // One set of consistent ranges (multipath burst), then nothing: a tentative track, dropped
+    mtt_scan_t scan;
+    mtt_scan_init(&scan);
+    for (int k = 0; k < SENSORS; k++) {
+        mtt_scan_add(&scan, k, range_mm(k, 1.0f, 3.0f, true), 0, 0, RADAR_POSTURE_STANDING, 80);
+    }
+    int after_burst = mtt_room_step(&room, &g, ms, &scan);
+    mtt_scan_init(&scan);
+    for (int i = 0; i < MTT_TENTATIVE_MAX_MISSES; i++) {
+        ms += STEP_MS;
+        mtt_room_step(&room, &g, ms, &scan);
+    }
+    uint32_t ghosts = room.ghosts;
+
+    // A person stays 2 s, then leaves: the track dies after KALMAN_MAX_COAST_MS without a position
+    for (int i = 0; i < 10; i++) {
+        ms += STEP_MS;
+        mtt_scan_init(&scan);
+        for (int k = 0; k < SENSORS; k++) {
+            mtt_scan_add(&scan, k, range_mm(k, 2.0f, 2.0f, true), 0, 0, RADAR_POSTURE_STANDING, 80);
+        }
+        mtt_room_step(&room, &g, ms, &scan);
+    }
+    mtt_scan_init(&scan);
+    int still_there = mtt_room_step(&room, &g, ms + KALMAN_MAX_COAST_MS, &scan);
+    int gone = mtt_room_step(&room, &g, ms + KALMAN_MAX_COAST_MS + STEP_MS, &scan);
+
+    if (after_burst == 0 && ghosts == 1 && still_there == 1 && gone == 0 && room.deaths == 1) {
+        ESP_LOGI(TAG_TEST_MTT, "Test PASSED: Unconfirmed burst dropped as a ghost, track died %d ms after the last position.",
+                 KALMAN_MAX_COAST_MS);
+    } else {
+        ESP_LOGE(TAG_TEST_MTT, "Test FAILED: burst %d, ghosts %u, coasting %d, after coast %d, deaths %u.",
+                 after_burst, (unsigned)ghosts, still_there, gone, (unsigned)room.deaths);
+    }
+}
+
+void run_multi_tracker_tests() {
+    ESP_LOGI(TAG_TEST_MTT, "--- Starting Multi Tracker Tests ---");
+    test_mtt_single_person_without_targets();
+    test_mtt_two_people_moving_and_static();
+    test_mtt_ids_survive_close_ranges();
+    test_mtt_ghost_and_death();
+    ESP_LOGI(TAG_TEST_MTT, "--- Finished Multi Tracker Tests ---");
+}
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "pipeline_msgs.h"
+#include "sensor_health.h"
+
+// --- BEGIN NOTE ---
+// pipeline_msgs (master_firmware/main) and radar_posture (components/hlk_common)
+// are plain C, so these tests call the real code used by the FusionEngine,
+// FallDetector and AlertManager tasks. The posture fusion is checked against
+// the strcmp() chain it replaced, on every pair of postures.
+// --- END NOTE ---
+
+static const char *TAG_TEST_PIPELINE = "TEST_PIPELINE_MSGS";
+
+// The FusionEngine priority chain before postures became enums.
+static const char *legacy_fuse(const char *p1, const char *p2) {
+    static const char *const order[] = { "LYING", "MOVING", "SITTING", "STANDING" };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        if (strcmp(p1, order[i]) == 0 || strcmp(p2, order[i]) == 0) {
+            return order[i];
+        }
+    }
+    return "STILL";
+}
+
+void test_posture_fuse_matches_legacy_chain() {
+    ESP_LOGI(TAG_TEST_PIPELINE, "Running test: test_posture_fuse_matches_legacy_chain");
+    int mismatches = 0;
+    for (int a = 0; a < RADAR_POSTURE_COUNT; a++) {
+        for (int b = 0; b < RADAR_POSTURE_COUNT; b++) {
+            radar_posture_t fused = radar_posture_fuse((radar_posture_t)a, (radar_posture_t)b);
+            const char *expected = legacy_fuse(radar_posture_name((radar_posture_t)a), radar_posture_name((radar_posture_t)b));
+            if (strcmp(radar_posture_name(fused), expected) != 0) {
+                ESP_LOGE(TAG_TEST_PIPELINE, "%s + %s -> %s, expected %s", radar_posture_name((radar_posture_t)a),
+                         radar_posture_name((radar_posture_t)b), radar_posture_name(fused), expected);
+                mismatches++;
+            }
+        }
+    }
+    bool out_of_range = radar_posture_fuse((radar_posture_t)42, RADAR_POSTURE_UNKNOWN) == RADAR_POSTURE_STILL;
+
+    if (mismatches == 0 && out_of_range) {
+        ESP_LOGI(TAG_TEST_PIPELINE, "Test PASSED: Enum fusion matches the string priority chain on all %d pairs.",
+                 RADAR_POSTURE_COUNT * RADAR_POSTURE_COUNT);
+    } else {
+        ESP_LOGE(TAG_TEST_PIPELINE, "Test FAILED: %d posture pairs fused differently.", mismatches);
+    }
+}
+
+void test_posture_upright_mask() {
+    ESP_LOGI(TAG_TEST_PIPELINE, "Running test: test_posture_upright_mask");
+    bool ok = radar_posture_is_upright_or_moving(RADAR_POSTURE_STANDING) &&
+              radar_posture_is_upright_or_moving(RADAR_POSTURE_SITTING) &&
+              radar_posture_is_upright_or_moving(RADAR_POSTURE_MOVING) &&
+              radar_posture_is_upright_or_moving(RADAR_POSTURE_STILL) &&
+              !radar_posture_is_upright_or_moving(RADAR_POSTURE_LYING) &&
+              !radar_posture_is_upright_or_moving(RADAR_POSTURE_UNKNOWN) &&
+              !radar_posture_is_upright_or_moving((radar_posture_t)200);
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_PIPELINE, "Test PASSED: Fall start postures are STANDING, SITTING, MOVING and STILL.");
+    } else {
+        ESP_LOGE(TAG_TEST_PIPELINE, "Test FAILED: Upright/moving mask incorrect.");
+    }
+}
+
+void test_alert_described_at_the_edge() {
+    ESP_LOGI(TAG_TEST_PIPELINE, "Running test: test_alert_described_at_the_edge");
+    char text[64];
+    AlertMessage fall = { .alert_timestamp = 123456, .x_mm = 1000, .y_mm = -1500, .type = ALERT_TYPE_FALL_DETECTED };
+    alert_describe(&fall, text, sizeof(text));
+    bool ok = strcmp(text, "Chute détectée à 123456 (Pos: 1.00,-1.50)") == 0;
+
+    AlertMessage offline = { .alert_timestamp = 9000, .silent_ms = 5200, .type = ALERT_TYPE_MODULE_OFFLINE, .module_id = 2 };
+    alert_describe(&offline, text, sizeof(text));
+    ok = ok && strcmp(text, "Module 2 offline. Last seen 5200 ms ago.") == 0;
+
+    offline.flags = ALERT_FLAG_NEVER_REPORTED;
+    alert_describe(&offline, text, sizeof(text));
+    ok = ok && strcmp(text, "Module 2 never reported.") == 0 &&
+         strcmp(alert_type_name(ALERT_TYPE_MODULE_OFFLINE), "MODULE_OFFLINE") == 0 &&
+         strcmp(alert_type_name((AlertType)99), "UNKNOWN") == 0;
+
+    AlertMessage degraded = { .silent_ms = 1500, .type = ALERT_TYPE_ROOM_DEGRADED, .module_id = 7, .room = 3 };
+    alert_describe(&degraded, text, sizeof(text));
+    ok = ok && strcmp(text, "Pièce 3 dégradée: module 7 muet depuis 1500 ms") == 0 &&
+         strcmp(alert_type_name(ALERT_TYPE_ROOM_DEGRADED), "ROOM_DEGRADED") == 0;
+    fall.flags = ALERT_FLAG_DEGRADED;
+    alert_describe(&fall, text, sizeof(text));
+    ok = ok && strcmp(text, "Chute détectée à 123456 (Pos: 1.00,-1.50) [dégradé]") == 0;
+
+    AlertMessage dwell = { .inside_ms = 125400, .type = ALERT_TYPE_ZONE_DWELL, .zone = 2, .room = 1 };
+    alert_describe(&dwell, text, sizeof(text));
+    ok = ok && strcmp(text, "Pièce 1: dans la zone 2 depuis 125 s") == 0 &&
+         strcmp(alert_type_name(ALERT_TYPE_ZONE_EXIT), "ZONE_EXIT") == 0;
+    fall.flags = ALERT_FLAG_ESCALATED;
+    alert_describe(&fall, text, sizeof(text));
+    ok = ok && strcmp(text, "Chute détectée à 123456 (Pos: 1.00,-1.50) [zone à risque]") == 0;
+
+    AlertMessage still = { .still_ms = 1830000, .type = ALERT_TYPE_INACTIVITY, .level = 2, .room = 4 };
+    alert_describe(&still, text, sizeof(text));
+    ok = ok && strcmp(text, "Pièce 4: aucun mouvement depuis 30 min (niveau 2)") == 0 &&
+         strcmp(alert_type_name(ALERT_TYPE_INACTIVITY_CLEARED), "INACTIVITY_CLEARED") == 0;
+
+    AlertMessage sensor = { .score = 35, .reasons = SENSOR_HEALTH_STUCK | SENSOR_HEALTH_DROPS,
+                            .type = ALERT_TYPE_SENSOR_DEGRADED, .module_id = 5 };
+    alert_describe(&sensor, text, sizeof(text));
+    ok = ok && strcmp(text, "Module 5 dégradé: score 35/100 (stuck,drops)") == 0 &&
+         strcmp(alert_type_name(ALERT_TYPE_SENSOR_RESTORED), "SENSOR_RESTORED") == 0;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_PIPELINE, "Test PASSED: Alert texts identical to the former queued descriptions.");
+    } else {
+        ESP_LOGE(TAG_TEST_PIPELINE, "Test FAILED: Alert description incorrect: %s", text);
+    }
+}
+
+void test_fixed_point_conversions() {
+    ESP_LOGI(TAG_TEST_PIPELINE, "Running test: test_fixed_point_conversions");
+    bool ok = pipeline_distance_mm(2.5f) == 2500 && pipeline_distance_mm(0.0014f) == 1 &&
+              pipeline_distance_mm(-1.0f) == 0 && pipeline_distance_mm(100.0f) == UINT16_MAX &&
+              pipeline_position_mm(-1.2345f) == -1235 && pipeline_position_mm(40.0f) == INT16_MAX &&
+              pipeline_position_mm(-40.0f) == INT16_MIN &&
+              pipeline_sigma_cm(0.124f) == 12 && pipeline_sigma_cm(9.0f) == FUSED_SIGMA_UNKNOWN - 1;
+    bool sizes = sizeof(RadarMessage) == 20 && sizeof(FusedData) == 28 && sizeof(AlertMessage) == 16;
+
+    if (ok && sizes) {
+        ESP_LOGI(TAG_TEST_PIPELINE, "Test PASSED: Millimetre and sigma conversions round and saturate; items are 20/28/16 bytes.");
+    } else {
+        ESP_LOGE(TAG_TEST_PIPELINE, "Test FAILED: Fixed-point conversion or item size incorrect.");
+    }
+}
+
+void run_pipeline_msgs_tests() {
+    ESP_LOGI(TAG_TEST_PIPELINE, "--- Starting Pipeline Message Tests ---");
+    test_posture_fuse_matches_legacy_chain();
+    test_posture_upright_mask();
+    test_alert_described_at_the_edge();
+    test_fixed_point_conversions();
+    ESP_LOGI(TAG_TEST_PIPELINE, "--- Finished Pipeline Message Tests ---");
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "pipeline_shard.h"
+#include "fusion_engine.h"
+
+// --- BEGIN NOTE ---
+// pipeline_shard.c (master_firmware/main) is plain C: these tests check the
+// placement of the shards on the cores and the room -> shard map, alone and
+// with the rooms of the real fusion engine. The tasks, queues and locks that
+// use them live in main.c and need the ESP-IDF build.
+// --- END NOTE ---
+
+static const char *TAG_TEST_SHARD = "TEST_PIPELINE_SHARD";
+
+void test_shard_placement() {
+    ESP_LOGI(TAG_TEST_SHARD, "Running test: test_shard_placement");
+    pipeline_shards_t single, apart, spread, other_net, none, many;
+    pipeline_shards_init(&single, 2, 1, 0, 2);    // Single-core chip
+    pipeline_shards_init(&apart, 3, 2, 0, 1);     // Every shard off the network core
+    pipeline_shards_init(&spread, 4, 2, 0, 2);    // Both cores in turn, the free one first
+    pipeline_shards_init(&other_net, 2, 2, 1, 1); // Network on core 1
+    pipeline_shards_init(&none, 0, 2, 0, 1);
+    pipeline_shards_init(&many, 9, 8, 0, 8);
+
+    bool ok = single.shard_count == 2 && single.core[0] == 0 && single.core[1] == 0 &&
+              apart.shard_count == 3 && apart.core[0] == 1 && apart.core[1] == 1 && apart.core[2] == 1 &&
+              spread.core[0] == 1 && spread.core[1] == 0 && spread.core[2] == 1 && spread.core[3] == 0 &&
+              other_net.core[0] == 0 && other_net.core[1] == 0 &&
+              none.shard_count == 1 && none.core[0] == 1 &&
+              many.shard_count == PIPELINE_MAX_SHARDS && many.core[0] == 1 && many.core[1] == 0;
+    if (ok) {
+        ESP_LOGI(TAG_TEST_SHARD, "Test PASSED: Shards placed off the network core, in turn when spread, counts clamped.");
+    } else {
+        ESP_LOGE(TAG_TEST_SHARD, "Test FAILED: single %u/%u, apart %u/%u/%u, spread %u/%u/%u/%u, other %u/%u, none %u, many %u.",
+                 single.core[0], single.core[1], apart.core[0], apart.core[1], apart.core[2], spread.core[0],
+                 spread.core[1], spread.core[2], spread.core[3], other_net.core[0], other_net.core[1],
+                 none.shard_count, many.shard_count);
+    }
+}
+
+void test_shard_room_partition() {
+    ESP_LOGI(TAG_TEST_SHARD, "Running test: test_shard_room_partition");
+    int errors = 0;
+    for (int shards = 1; shards <= PIPELINE_MAX_SHARDS; shards++) {
+        pipeline_shards_t ps;
+        pipeline_shards_init(&ps, shards, 2, 0, 1);
+        // Every room in exactly one shard
+        for (int room = 0; room < FUSION_MAX_ROOMS; room++) {
+            int owners = 0;
+            for (int s = 0; s < shards; s++) {
+                owners += pipeline_shard_owns(&ps, s, room);
+            }
+            errors += owners != 1;
+        }
+        // Rooms handed out in turn: shard sizes differ by at most one
+        for (int room_count = 0; room_count <= FUSION_MAX_ROOMS; room_count++) {
+            int total = 0, low = FUSION_MAX_ROOMS, high = 0;
+            for (int s = 0; s < shards; s++) {
+                int n = pipeline_shard_room_count(&ps, s, room_count);
+                total += n;
+                low = n < low ? n : low;
+                high = n > high ? n : high;
+            }
+            errors += total != room_count || high - low > 1;
+        }
+        for (int s = 0; s < shards; s++) {
+            errors += pipeline_shard_owns(&ps, s, -1); // Unassigned module
+        }
+    }
+    if (errors == 0) {
+        ESP_LOGI(TAG_TEST_SHARD, "Test PASSED: Each room in one shard, shards balanced to one room, 1 to %d shards.",
+                 PIPELINE_MAX_SHARDS);
+    } else {
+        ESP_LOGE(TAG_TEST_SHARD, "Test FAILED: %d partition errors.", errors);
+    }
+}
+
+void test_shard_follows_room_moves() {
+    ESP_LOGI(TAG_TEST_SHARD, "Running test: test_shard_follows_room_moves");
+    pipeline_shards_t ps;
+    pipeline_shards_init(&ps, 2, 2, 0, 1);
+    static fusion_engine_t fe;
+    fusion_engine_init(&fe, 500, 2);
+    // Rooms created in the order modules show up: kitchen 0, bedroom 1, hall 2
+    fusion_engine_assign(&fe, 1, "kitchen");
+    fusion_engine_assign(&fe, 2, "bedroom");
+    fusion_engine_assign(&fe, 3, "kitchen");
+    fusion_engine_assign(&fe, 4, "hall");
+    int before[5];
+    for (int id = 1; id <= 4; id++) {
+        before[id] = pipeline_shard_of_room(&ps, fusion_engine_room_of(&fe, id));
+    }
+    // Module 3 moves to the bedroom: its samples now go to the other shard
+    fusion_engine_assign(&fe, 3, "bedroom");
+    int moved = pipeline_shard_of_room(&ps, fusion_engine_room_of(&fe, 3));
+    bool stale = !pipeline_shard_owns(&ps, before[3], fusion_engine_room_of(&fe, 3));
+
+    pipeline_shard_note(&ps, moved, true);
+    pipeline_shard_note(&ps, moved, true);
+    pipeline_shard_note(&ps, moved, false);
+    pipeline_shard_note(&ps, 7, true); // Out of range: ignored
+
+    if (before[1] == 0 && before[3] == 0 && before[2] == 1 && before[4] == 0 && moved == 1 && stale &&
+        ps.routed[1] == 2 && ps.dropped[1] == 1 && ps.routed[0] == 0 && ps.dropped[0] == 0) {
+        ESP_LOGI(TAG_TEST_SHARD, "Test PASSED: Modules of a room share its shard; a move changes the shard of the module.");
+    } else {
+        ESP_LOGE(TAG_TEST_SHARD, "Test FAILED: shards %d/%d/%d/%d, moved %d (stale %d), routed %u/%u, dropped %u/%u.",
+                 before[1], before[2], before[3], before[4], moved, stale, ps.routed[0], ps.routed[1], ps.dropped[0],
+                 ps.dropped[1]);
+    }
+}
+
+void run_pipeline_shard_tests() {
+    ESP_LOGI(TAG_TEST_SHARD, "--- Starting Pipeline Shard Tests ---");
+    test_shard_placement();
+    test_shard_room_partition();
+    test_shard_follows_room_moves();
+    ESP_LOGI(TAG_TEST_SHARD, "--- Finished Pipeline Shard Tests ---");
+}
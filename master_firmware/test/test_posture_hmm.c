@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "posture_hmm.h"
+
+// --- BEGIN NOTE ---
+// posture_hmm.c (master_firmware/main) is plain C, so these tests run the
+// real posture filter of the fusion rooms and people tracks: sequences of
+// votes, one step per fused set, as the FusionEngine task feeds them.
+// --- END NOTE ---
+
+static const char *TAG_TEST_POSTURE = "TEST_POSTURE_HMM";
+
+// One step with up to two sensors; RADAR_POSTURE_UNKNOWN = no report.
+static radar_posture_t step2(posture_hmm_t *hmm, radar_posture_t a, float wa, radar_posture_t b, float wb) {
+    posture_votes_t votes;
+    posture_votes_init(&votes);
+    posture_votes_add(&votes, a, wa);
+    posture_votes_add(&votes, b, wb);
+    return posture_hmm_step(hmm, &votes);
+}
+
+void test_posture_vote_weights() {
+    ESP_LOGI(TAG_TEST_POSTURE, "Running test: test_posture_vote_weights");
+    float full = posture_vote_weight(100, 1500);
+    float half = posture_vote_weight(50, 2000);
+    float mid_range = posture_vote_weight(100, 4500);
+    float far = posture_vote_weight(100, 8000);
+    float silent = posture_vote_weight(0, 1000);
+    float no_range = posture_vote_weight(80, 0);
+    float clamped = posture_vote_weight(250, 1000);
+
+    if (fabsf(full - 1.0f) < 1e-6f && fabsf(half - 0.5f) < 1e-6f && fabsf(mid_range - 0.6f) < 1e-6f &&
+        fabsf(far - POSTURE_FAR_WEIGHT) < 1e-6f && silent == 0.0f && fabsf(no_range - 0.8f) < 1e-6f &&
+        fabsf(clamped - 1.0f) < 1e-6f) {
+        ESP_LOGI(TAG_TEST_POSTURE, "Test PASSED: Weights scale with the signal and fall to %.1f beyond %d mm.",
+                 POSTURE_FAR_WEIGHT, POSTURE_FAR_MM);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE, "Test FAILED: weights %.2f %.2f %.2f %.2f %.2f %.2f %.2f.", full, half, mid_range, far,
+                 silent, no_range, clamped);
+    }
+}
+
+void test_posture_single_sensor_fall() {
+    ESP_LOGI(TAG_TEST_POSTURE, "Running test: test_posture_single_sensor_fall");
+    posture_hmm_t hmm;
+    posture_hmm_init(&hmm);
+    const float w = posture_vote_weight(70, 2000);
+
+    // One sensor (degraded room): standing, one noisy LYING frame, standing
+    // again, then a fall
+    bool flipped_on_noise = false;
+    for (int i = 0; i < 30; i++) {
+        radar_posture_t reported = i == 15 ? RADAR_POSTURE_LYING : RADAR_POSTURE_STANDING;
+        flipped_on_noise = step2(&hmm, reported, w, RADAR_POSTURE_UNKNOWN, 0.0f) != RADAR_POSTURE_STANDING;
+        if (flipped_on_noise) {
+            break;
+        }
+    }
+    int sets_to_lying = 0;
+    while (sets_to_lying < 10 && step2(&hmm, RADAR_POSTURE_LYING, w, RADAR_POSTURE_UNKNOWN, 0.0f) != RADAR_POSTURE_LYING) {
+        sets_to_lying++;
+    }
+    sets_to_lying++;
+
+    if (!flipped_on_noise && sets_to_lying <= 3) {
+        ESP_LOGI(TAG_TEST_POSTURE, "Test PASSED: Single LYING frame ignored, sustained LYING reported after %d sets.",
+                 sets_to_lying);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE, "Test FAILED: flipped on noise %d, LYING after %d sets.", flipped_on_noise, sets_to_lying);
+    }
+}
+
+void test_posture_weak_sensor_overruled() {
+    ESP_LOGI(TAG_TEST_POSTURE, "Running test: test_posture_weak_sensor_overruled");
+    posture_hmm_t hmm;
+    posture_hmm_init(&hmm);
+
+    // A close sensor with a good signal sees a seated person; a distant one
+    // with a weak signal keeps saying LYING (e.g. the person's legs).
+    const float near = posture_vote_weight(80, 1500), weak_far = posture_vote_weight(40, 5500);
+    int sitting = 0;
+    for (int i = 0; i < 50; i++) {
+        sitting += step2(&hmm, RADAR_POSTURE_SITTING, near, RADAR_POSTURE_LYING, weak_far) == RADAR_POSTURE_SITTING;
+    }
+    uint8_t pct[RADAR_POSTURE_COUNT];
+    posture_hmm_percent(&hmm, pct);
+
+    if (sitting == 50 && pct[RADAR_POSTURE_SITTING] > pct[RADAR_POSTURE_LYING]) {
+        ESP_LOGI(TAG_TEST_POSTURE, "Test PASSED: SITTING held on all 50 sets (sitting %u %%, lying %u %%).",
+                 pct[RADAR_POSTURE_SITTING], pct[RADAR_POSTURE_LYING]);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE, "Test FAILED: SITTING on %d of 50 sets (sitting %u %%, lying %u %%).", sitting,
+                 pct[RADAR_POSTURE_SITTING], pct[RADAR_POSTURE_LYING]);
+    }
+}
+
+void test_posture_lying_is_sticky() {
+    ESP_LOGI(TAG_TEST_POSTURE, "Running test: test_posture_lying_is_sticky");
+    posture_hmm_t hmm;
+    posture_hmm_init(&hmm);
+    const float w = posture_vote_weight(70, 2000);
+    for (int i = 0; i < 20; i++) {
+        step2(&hmm, RADAR_POSTURE_LYING, w, RADAR_POSTURE_LYING, w);
+    }
+    float before[RADAR_POSTURE_COUNT];
+    memcpy(before, hmm.p, sizeof(before));
+
+    // No report for 3 s (track coasting) and UNKNOWN reports: nothing changes
+    bool kept = true;
+    for (int i = 0; i < 30; i++) {
+        kept = kept && posture_hmm_step(&hmm, NULL) == RADAR_POSTURE_LYING &&
+               step2(&hmm, RADAR_POSTURE_UNKNOWN, w, RADAR_POSTURE_UNKNOWN, w) == RADAR_POSTURE_LYING;
+    }
+    kept = kept && memcmp(before, hmm.p, sizeof(before)) == 0;
+    // One sensor briefly reports SITTING: still lying. Both standing: up again.
+    bool still_lying = step2(&hmm, RADAR_POSTURE_SITTING, w, RADAR_POSTURE_LYING, w) == RADAR_POSTURE_LYING;
+    int sets_to_standing = 1;
+    while (sets_to_standing < 20 && step2(&hmm, RADAR_POSTURE_STANDING, w, RADAR_POSTURE_STANDING, w) != RADAR_POSTURE_STANDING) {
+        sets_to_standing++;
+    }
+    uint8_t pct[RADAR_POSTURE_COUNT];
+    posture_hmm_percent(&hmm, pct);
+    int total = 0;
+    for (int s = 0; s < RADAR_POSTURE_COUNT; s++) {
+        total += pct[s];
+    }
+
+    if (kept && still_lying && sets_to_standing <= 4 && total >= 98 && total <= 102 && pct[RADAR_POSTURE_UNKNOWN] == 0) {
+        ESP_LOGI(TAG_TEST_POSTURE, "Test PASSED: LYING kept without reports and through one SITTING frame, STANDING after %d sets.",
+                 sets_to_standing);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE, "Test FAILED: kept %d, still lying %d, STANDING after %d sets, %d %% in total.", kept,
+                 still_lying, sets_to_standing, total);
+    }
+}
+
+void run_posture_hmm_tests() {
+    ESP_LOGI(TAG_TEST_POSTURE, "--- Starting Posture HMM Tests ---");
+    test_posture_vote_weights();
+    test_posture_single_sensor_fall();
+    test_posture_weak_sensor_overruled();
+    test_posture_lying_is_sticky();
+    ESP_LOGI(TAG_TEST_POSTURE, "--- Finished Posture HMM Tests ---");
+}
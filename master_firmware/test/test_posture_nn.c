@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "posture_nn.h"
+
+// --- BEGIN NOTE ---
+// posture_nn.c (master_firmware/main) is plain C, so these tests run the
+// real int8 inference engine: a small hand-built blob checked against a
+// plain reference computation, the compiled-in default model, and the
+// checks a blob flashed in the posture_nn partition goes through.
+// --- END NOTE ---
+
+static const char *TAG_TEST_POSTURE_NN = "TEST_POSTURE_NN";
+
+#define HIDDEN 6
+
+// 14-6-5 network with fixed pseudo-random weights, per-channel multipliers
+static int8_t ref_w1[HIDDEN][POSTURE_NN_FEATURES], ref_w2[POSTURE_NN_CLASSES][HIDDEN];
+static int32_t ref_b1[HIDDEN], ref_b2[POSTURE_NN_CLASSES], ref_m1[HIDDEN], ref_m2[POSTURE_NN_CLASSES];
+static int8_t ref_s1[HIDDEN], ref_s2[POSTURE_NN_CLASSES];
+
+static uint32_t test_rng = 41;
+
+static int32_t test_rand(int32_t lo, int32_t hi) {
+    test_rng = test_rng * 1664525u + 1013904223u;
+    return lo + (int32_t)((test_rng >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+static size_t put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return 4;
+}
+
+static size_t put_layer(uint8_t *p, int in, int out, bool relu, const int8_t *w, const int32_t *b, const int32_t *m,
+                        const int8_t *s) {
+    size_t n = 0;
+    p[n++] = (uint8_t)in;
+    p[n++] = (uint8_t)out;
+    p[n++] = relu ? POSTURE_NN_RELU : 0;
+    p[n++] = 0;
+    for (int o = 0; o < out; o++) {
+        n += put32(p + n, (uint32_t)b[o]);
+    }
+    for (int o = 0; o < out; o++) {
+        n += put32(p + n, (uint32_t)m[o]);
+    }
+    memcpy(p + n, s, out);
+    n += (out + 3) & ~3;
+    memcpy(p + n, w, in * out);
+    n += (in * out + 3) & ~3;
+    return n;
+}
+
+// Builds the reference blob into `blob` (zeroed, 4-byte aligned), returns its length
+static size_t build_reference_blob(uint8_t *blob) {
+    test_rng = 41;
+    for (int o = 0; o < HIDDEN; o++) {
+        for (int i = 0; i < POSTURE_NN_FEATURES; i++) {
+            ref_w1[o][i] = (int8_t)test_rand(-127, 127);
+        }
+        ref_b1[o] = test_rand(-3000, 3000);
+        ref_m1[o] = test_rand(1 << 30, INT32_MAX);
+        ref_s1[o] = (int8_t)test_rand(6, 9);
+    }
+    for (int o = 0; o < POSTURE_NN_CLASSES; o++) {
+        for (int i = 0; i < HIDDEN; i++) {
+            ref_w2[o][i] = (int8_t)test_rand(-127, 127);
+        }
+        ref_b2[o] = test_rand(-500, 500);
+        ref_m2[o] = test_rand(1 << 30, INT32_MAX);
+        ref_s2[o] = (int8_t)test_rand(-1, 2);
+    }
+    size_t n = POSTURE_NN_HEADER_LEN;
+    n += put_layer(blob + n, POSTURE_NN_FEATURES, HIDDEN, true, &ref_w1[0][0], ref_b1, ref_m1, ref_s1);
+    n += put_layer(blob + n, HIDDEN, POSTURE_NN_CLASSES, false, &ref_w2[0][0], ref_b2, ref_m2, ref_s2);
+    put32(blob, POSTURE_NN_MAGIC);
+    blob[4] = POSTURE_NN_VERSION;
+    blob[5] = 0;
+    blob[6] = 2;
+    blob[7] = POSTURE_NN_FEATURES;
+    put32(blob + 8, (uint32_t)(n - POSTURE_NN_HEADER_LEN));
+    put32(blob + 12, posture_nn_crc32(blob + POSTURE_NN_HEADER_LEN, n - POSTURE_NN_HEADER_LEN));
+    const float out_scale = 0.01f;
+    memcpy(blob + 16, &out_scale, sizeof(out_scale));
+    return n;
+}
+
+// Plain reference of one requantized output
+static int32_t ref_requantize(int32_t acc, int32_t mult, int shift, int32_t low, int32_t high) {
+    int64_t scaled = (int64_t)acc * mult;
+    int total = 31 + shift;
+    int64_t v = (scaled + ((int64_t)1 << (total - 1))) >> total;
+    return (int32_t)(v < low ? low : v > high ? high : v);
+}
+
+static void ref_infer(const int8_t *x, int16_t *logits) {
+    int8_t h[HIDDEN];
+    for (int o = 0; o < HIDDEN; o++) {
+        int32_t acc = ref_b1[o];
+        for (int i = 0; i < POSTURE_NN_FEATURES; i++) {
+            acc += ref_w1[o][i] * x[i];
+        }
+        h[o] = (int8_t)ref_requantize(acc, ref_m1[o], ref_s1[o], 0, 127);
+    }
+    for (int o = 0; o < POSTURE_NN_CLASSES; o++) {
+        int32_t acc = ref_b2[o];
+        for (int i = 0; i < HIDDEN; i++) {
+            acc += ref_w2[o][i] * h[i];
+        }
+        logits[o] = (int16_t)ref_requantize(acc, ref_m2[o], ref_s2[o], INT16_MIN, INT16_MAX);
+    }
+}
+
+void test_posture_nn_matches_reference() {
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "Running test: test_posture_nn_matches_reference");
+    static uint32_t storage[256];
+    uint8_t *blob = (uint8_t *)storage;
+    memset(storage, 0, sizeof(storage));
+    size_t len = build_reference_blob(blob);
+    posture_nn_t nn;
+    posture_nn_status_t status = posture_nn_load(&nn, blob, sizeof(storage));
+
+    int mismatches = 0, saturated = 0;
+    for (int t = 0; t < 500 && status == POSTURE_NN_OK; t++) {
+        int8_t x[POSTURE_NN_FEATURES];
+        for (int i = 0; i < POSTURE_NN_FEATURES; i++) {
+            x[i] = (int8_t)test_rand(-128, 127);
+        }
+        int16_t expected[POSTURE_NN_CLASSES], logits[POSTURE_NN_CLASSES];
+        ref_infer(x, expected);
+        radar_posture_t posture = posture_nn_infer(&nn, x, logits);
+        int best = 0;
+        for (int c = 0; c < POSTURE_NN_CLASSES; c++) {
+            best = expected[c] > expected[best] ? c : best;
+            saturated += expected[c] == INT16_MIN || expected[c] == INT16_MAX;
+        }
+        mismatches += memcmp(expected, logits, sizeof(logits)) != 0 || (int)posture != RADAR_POSTURE_STANDING + best;
+    }
+
+    if (status == POSTURE_NN_OK && nn.blob_len == len && mismatches == 0 && saturated < 500) {
+        ESP_LOGI(TAG_TEST_POSTURE_NN, "Test PASSED: %u-byte blob, 500 random inputs give the reference logits.",
+                 (unsigned)len);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE_NN, "Test FAILED: load '%s', blob %u/%u B, %d mismatches, %d saturated logits.",
+                 posture_nn_status_name(status), (unsigned)nn.blob_len, (unsigned)len, mismatches, saturated);
+    }
+}
+
+void test_posture_nn_features() {
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "Running test: test_posture_nn_features");
+    RadarMessage msg = { .timestamp = 10100, .distance_mm = 2400, .moving_mm = 2450, .static_mm = 0, .signal = 70,
+                         .flags = RADAR_MSG_HAS_TARGETS };
+    fusion_reading_t prev = { .timestamp = 10000, .distance_mm = 2300, .moving_mm = 2330, .static_mm = 2300,
+                              .signal = 75 };
+    fusion_reading_t oldest = { .timestamp = 9700, .distance_mm = 2000, .moving_mm = 0, .static_mm = 2000, .signal = 60 };
+    int8_t f[POSTURE_NN_FEATURES], alone[POSTURE_NN_FEATURES];
+    posture_nn_features(&msg, &prev, &oldest, f);
+    posture_nn_features(&msg, NULL, NULL, alone);
+    // Walking away: distances, presence, changes (targets only seen on both ends)
+    static const int8_t expected[POSTURE_NN_FEATURES] = { 48, 49, 0, 70, 64, 0, 12, 15, 0, -5, 25, 0, 0, 12 };
+    bool no_history = memcmp(alone, expected, 6) == 0;
+    for (int i = 6; i < POSTURE_NN_FEATURES; i++) {
+        no_history = no_history && alone[i] == 0;
+    }
+
+    if (memcmp(f, expected, sizeof(expected)) == 0 && no_history) {
+        ESP_LOGI(TAG_TEST_POSTURE_NN, "Test PASSED: Features of a sample with and without history.");
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE_NN, "Test FAILED: features %d %d %d %d %d %d %d %d %d %d %d %d %d %d (history %d).", f[0],
+                 f[1], f[2], f[3], f[4], f[5], f[6], f[7], f[8], f[9], f[10], f[11], f[12], f[13], no_history);
+    }
+}
+
+void test_posture_nn_default_model() {
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "Running test: test_posture_nn_default_model");
+    posture_nn_t nn;
+    posture_nn_status_t status = posture_nn_load(&nn, posture_nn_default_model, posture_nn_default_model_len);
+
+    // A person walking away at about 1 m/s, then lying still on the floor
+    RadarMessage walk = { .timestamp = 5100, .distance_mm = 3100, .moving_mm = 3120, .static_mm = 0, .signal = 75,
+                          .flags = RADAR_MSG_HAS_TARGETS };
+    fusion_reading_t walk_prev = { .timestamp = 5000, .distance_mm = 3000, .moving_mm = 2990, .signal = 74 };
+    fusion_reading_t walk_oldest = { .timestamp = 4700, .distance_mm = 2700, .moving_mm = 2700, .signal = 76 };
+    RadarMessage lying = { .timestamp = 5100, .distance_mm = 2000, .moving_mm = 0, .static_mm = 2010, .signal = 30,
+                           .flags = RADAR_MSG_HAS_TARGETS };
+    fusion_reading_t lying_prev = { .timestamp = 5000, .distance_mm = 2005, .static_mm = 2000, .signal = 32 };
+    int8_t f[POSTURE_NN_FEATURES];
+    uint8_t walk_pct[RADAR_POSTURE_COUNT], lying_pct[RADAR_POSTURE_COUNT];
+    posture_nn_features(&walk, &walk_prev, &walk_oldest, f);
+    radar_posture_t walk_posture = posture_nn_classify(&nn, f, walk_pct);
+    posture_nn_features(&lying, &lying_prev, &lying_prev, f);
+    radar_posture_t lying_posture = posture_nn_classify(&nn, f, lying_pct);
+    int total = 0;
+    for (int s = 0; s < RADAR_POSTURE_COUNT; s++) {
+        total += walk_pct[s];
+    }
+
+    if (status == POSTURE_NN_OK && walk_posture == RADAR_POSTURE_MOVING && lying_posture != RADAR_POSTURE_MOVING &&
+        lying_posture != RADAR_POSTURE_STANDING && total >= 98 && total <= 102 && walk_pct[RADAR_POSTURE_UNKNOWN] == 0) {
+        ESP_LOGI(TAG_TEST_POSTURE_NN, "Test PASSED: Default model (%u B): walking is MOVING (%u %%), lying is %s (%u %%).",
+                 (unsigned)nn.blob_len, walk_pct[walk_posture], radar_posture_name(lying_posture),
+                 lying_pct[lying_posture]);
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE_NN, "Test FAILED: load '%s', walking %s, lying %s, %d %% in total.",
+                 posture_nn_status_name(status), radar_posture_name(walk_posture), radar_posture_name(lying_posture),
+                 total);
+    }
+}
+
+void test_posture_nn_rejects_bad_blobs() {
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "Running test: test_posture_nn_rejects_bad_blobs");
+    static uint32_t storage[257];
+    uint8_t *blob = (uint8_t *)storage;
+    memset(storage, 0, sizeof(storage));
+    size_t len = build_reference_blob(blob);
+    posture_nn_t nn;
+    bool crc_ok = posture_nn_crc32((const uint8_t *)"123456789", 9) == 0xCBF43926u;
+
+    posture_nn_status_t truncated = posture_nn_load(&nn, blob, len - 1);
+    blob[POSTURE_NN_HEADER_LEN + 40] ^= 0x10;       // A flipped bit in the weights
+    posture_nn_status_t corrupted = posture_nn_load(&nn, blob, len);
+    bool unusable = nn.layer_count == 0;
+    blob[POSTURE_NN_HEADER_LEN + 40] ^= 0x10;
+    blob[4] = POSTURE_NN_VERSION + 1;
+    posture_nn_status_t version = posture_nn_load(&nn, blob, len);
+    blob[4] = POSTURE_NN_VERSION;
+    memset(blob, 0xFF, 4);                           // Erased partition
+    posture_nn_status_t erased = posture_nn_load(&nn, blob, len);
+    put32(blob, POSTURE_NN_MAGIC);
+    blob[7] = POSTURE_NN_FEATURES + 1;               // Header and layers disagree
+    posture_nn_status_t layout = posture_nn_load(&nn, blob, len);
+    blob[7] = POSTURE_NN_FEATURES;
+    memmove(blob + 1, blob, len);                    // Misaligned
+    posture_nn_status_t misaligned = posture_nn_load(&nn, blob + 1, len);
+    memmove(blob, blob + 1, len);
+    posture_nn_status_t restored = posture_nn_load(&nn, blob, len);
+
+    if (crc_ok && truncated == POSTURE_NN_ERR_LENGTH && corrupted == POSTURE_NN_ERR_CRC && unusable &&
+        version == POSTURE_NN_ERR_VERSION && erased == POSTURE_NN_ERR_MAGIC && layout == POSTURE_NN_ERR_LAYOUT &&
+        misaligned == POSTURE_NN_ERR_LAYOUT && restored == POSTURE_NN_OK) {
+        ESP_LOGI(TAG_TEST_POSTURE_NN, "Test PASSED: Truncated, corrupted, erased, foreign and misaligned blobs rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_POSTURE_NN, "Test FAILED: crc %d, truncated '%s', corrupted '%s', version '%s', erased '%s', "
+                 "layout '%s', misaligned '%s', restored '%s'.", crc_ok, posture_nn_status_name(truncated),
+                 posture_nn_status_name(corrupted), posture_nn_status_name(version), posture_nn_status_name(erased),
+                 posture_nn_status_name(layout), posture_nn_status_name(misaligned), posture_nn_status_name(restored));
+    }
+}
+
+void run_posture_nn_tests() {
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "--- Starting Posture NN Tests ---");
+    test_posture_nn_matches_reference();
+    test_posture_nn_features();
+    test_posture_nn_default_model();
+    test_posture_nn_rejects_bad_blobs();
+    ESP_LOGI(TAG_TEST_POSTURE_NN, "--- Finished Posture NN Tests ---");
+}
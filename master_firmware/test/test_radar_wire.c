@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "radar_wire.h"
+
+// --- BEGIN NOTE ---
+// radar_wire lives in components/hlk_common and has no ESP-IDF dependency, so
+// these tests exercise the real codec and anti-replay window (see the note in
+// test_conn_supervisor.c). Assertions are reported through ESP_LOGI/ESP_LOGE.
+// --- END NOTE ---
+
+static const char *TAG_TEST_WIRE = "TEST_RADAR_WIRE";
+
+static const uint8_t test_key[RADAR_WIRE_KEY_LEN] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+void test_radar_wire_siphash_reference_vectors() {
+    ESP_LOGI(TAG_TEST_WIRE, "Running test: test_radar_wire_siphash_reference_vectors");
+    // Vectors from the SipHash paper (key 00..0f, message 00..len-1).
+    uint8_t msg[15];
+    for (int i = 0; i < 15; i++) msg[i] = (uint8_t)i;
+    uint64_t h0 = hlk_siphash24(test_key, msg, 0);
+    uint64_t h15 = hlk_siphash24(test_key, msg, 15);
+
+    if (h0 == 0x726fdb47dd0e0e31ULL && h15 == 0xa129ca6149be45e5ULL) {
+        ESP_LOGI(TAG_TEST_WIRE, "Test PASSED: SipHash-2-4 matches the reference vectors.");
+    } else {
+        ESP_LOGE(TAG_TEST_WIRE, "Test FAILED: SipHash-2-4 output does not match the reference vectors.");
+    }
+}
+
+void test_radar_wire_roundtrip_and_tamper() {
+    ESP_LOGI(TAG_TEST_WIRE, "Running test: test_radar_wire_roundtrip_and_tamper");
+    radar_wire_sample_t in = {
+        .module_id = 2, .sequence = 123456, .timestamp_ms = 987654,
+        .distance_mm = 2350, .posture = RADAR_POSTURE_LYING, .signal = 77,
+    };
+    uint8_t packet[RADAR_WIRE_PACKET_LEN];
+    size_t len = radar_wire_encode(&in, test_key, packet);
+
+    radar_wire_sample_t out;
+    memset(&out, 0, sizeof(out));
+    radar_wire_status_t ok = radar_wire_decode(packet, len, test_key, &out);
+    bool same = out.module_id == in.module_id && out.sequence == in.sequence &&
+                out.timestamp_ms == in.timestamp_ms && out.distance_mm == in.distance_mm &&
+                out.posture == in.posture && out.signal == in.signal;
+
+    packet[12] ^= 0x01; // Flip one bit of the distance
+    radar_wire_status_t tampered = radar_wire_decode(packet, len, test_key, &out);
+    radar_wire_status_t truncated = radar_wire_decode(packet, len - 1, test_key, &out);
+
+    if (len == RADAR_WIRE_PACKET_LEN && ok == RADAR_WIRE_OK && same &&
+        tampered == RADAR_WIRE_ERR_AUTH && truncated == RADAR_WIRE_ERR_LENGTH) {
+        ESP_LOGI(TAG_TEST_WIRE, "Test PASSED: %u-byte sample round-trips; tampered/truncated packets rejected.",
+                 (unsigned int)len);
+    } else {
+        ESP_LOGE(TAG_TEST_WIRE, "Test FAILED: Codec round-trip or authentication incorrect.");
+    }
+}
+
+void test_radar_wire_replay_window() {
+    ESP_LOGI(TAG_TEST_WIRE, "Running test: test_radar_wire_replay_window");
+    radar_wire_replay_t window = { 0 };
+    uint32_t lost = 0;
+    bool ok = radar_wire_replay_check(&window, 10, &lost) == RADAR_REPLAY_ACCEPT;
+    ok = ok && radar_wire_replay_check(&window, 13, &lost) == RADAR_REPLAY_ACCEPT && lost == 2;
+    ok = ok && radar_wire_replay_check(&window, 12, &lost) == RADAR_REPLAY_ACCEPT;    // Reordered
+    ok = ok && radar_wire_replay_check(&window, 12, &lost) == RADAR_REPLAY_DUPLICATE; // Replayed
+    ok = ok && radar_wire_replay_check(&window, 200, &lost) == RADAR_REPLAY_ACCEPT;
+    ok = ok && radar_wire_replay_check(&window, 11, &lost) == RADAR_REPLAY_TOO_OLD;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_WIRE, "Test PASSED: Replay window accepts reordering, rejects duplicates and stale sequences.");
+    } else {
+        ESP_LOGE(TAG_TEST_WIRE, "Test FAILED: Replay window decisions incorrect.");
+    }
+}
+
+void test_radar_wire_replay_resync_after_restart() {
+    ESP_LOGI(TAG_TEST_WIRE, "Running test: test_radar_wire_replay_resync_after_restart");
+    radar_wire_replay_t window = { 0 };
+    uint32_t lost = 0;
+    bool ok = radar_wire_replay_check_resync(&window, 10000, &lost) == RADAR_REPLAY_ACCEPT;
+    ok = ok && radar_wire_replay_check_resync(&window, 10001, &lost) == RADAR_REPLAY_ACCEPT;
+    ok = ok && radar_wire_replay_check_resync(&window, 10001, &lost) == RADAR_REPLAY_DUPLICATE;
+    ok = ok && radar_wire_replay_check_resync(&window, 9000, &lost) == RADAR_REPLAY_TOO_OLD;  // Within the gap: replay
+    ok = ok && radar_wire_replay_check_resync(&window, 0, &lost) == RADAR_REPLAY_RESYNC;      // Slave NVS erased
+    ok = ok && radar_wire_replay_check_resync(&window, 1, &lost) == RADAR_REPLAY_ACCEPT && lost == 0;
+    ok = ok && radar_wire_replay_check_resync(&window, 0, &lost) == RADAR_REPLAY_DUPLICATE;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_WIRE, "Test PASSED: A restarted sequence resyncs the window, recent replays stay rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_WIRE, "Test FAILED: Replay window resync incorrect.");
+    }
+}
+
+void test_radar_wire_posture_codes() {
+    ESP_LOGI(TAG_TEST_WIRE, "Running test: test_radar_wire_posture_codes");
+    bool ok = radar_posture_from_string("STANDING") == RADAR_POSTURE_STANDING &&
+              radar_posture_from_string("LYING") == RADAR_POSTURE_LYING &&
+              radar_posture_from_string("garbage") == RADAR_POSTURE_UNKNOWN &&
+              strcmp(radar_posture_name(RADAR_POSTURE_SITTING), "SITTING") == 0 &&
+              strcmp(radar_posture_name((radar_posture_t)99), "UNKNOWN") == 0;
+
+    if (ok) {
+        ESP_LOGI(TAG_TEST_WIRE, "Test PASSED: Posture strings map to and from wire codes.");
+    } else {
+        ESP_LOGE(TAG_TEST_WIRE, "Test FAILED: Posture code mapping incorrect.");
+    }
+}
+
+void run_radar_wire_tests() {
+    ESP_LOGI(TAG_TEST_WIRE, "--- Starting Radar Wire Format Tests ---");
+    test_radar_wire_siphash_reference_vectors();
+    test_radar_wire_roundtrip_and_tamper();
+    test_radar_wire_replay_window();
+    test_radar_wire_replay_resync_after_restart();
+    test_radar_wire_posture_codes();
+    ESP_LOGI(TAG_TEST_WIRE, "--- Finished Radar Wire Format Tests ---");
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "sensor_health.h"
+
+// --- BEGIN NOTE ---
+// sensor_health.c (master_firmware/main) is plain C: these tests feed it the
+// samples of one module (a person moving around, a frozen sensor, a sensor
+// whose signal collapses, error frames, sequence gaps) and check the running
+// statistics against their closed form, the score, its reasons, and the
+// degraded/restored hysteresis the watchdog turns into alerts.
+// --- END NOTE ---
+
+static const char *TAG_TEST_SENSOR_HEALTH = "TEST_SENSOR_HEALTH";
+
+static const sensor_health_config_t test_cfg = {
+    .alpha = 0.05f,
+    .warmup_samples = 20,
+    .stuck_samples = 50,
+    .max_error_rate = 0.2f,
+    .max_drop_rate = 0.3f,
+    .min_signal = 10.0f,
+    .max_distance_std_mm = 1500.0f,
+    .degraded_below = 50,
+    .restored_above = 70,
+};
+
+static RadarMessage sample(uint16_t distance_mm, uint8_t signal, uint8_t posture) {
+    RadarMessage msg = { 0 };
+    msg.distance_mm = distance_mm;
+    msg.static_mm = distance_mm;
+    msg.signal = signal;
+    msg.posture = posture;
+    msg.module_id = 3;
+    return msg;
+}
+
+void test_sensor_health_statistics() {
+    ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Running test: test_sensor_health_statistics");
+    sensor_health_t h;
+    sensor_health_init(&h);
+    // Alternating 2000 / 2400 mm: mean 2200, variance 200^2 once settled
+    bool changed = false;
+    for (int i = 0; i < 400; i++) {
+        RadarMessage msg = sample(i % 2 ? 2400 : 2000, (uint8_t)(i % 2 ? 60 : 40), RADAR_POSTURE_STANDING);
+        changed |= sensor_health_update(&test_cfg, &h, &msg, 0);
+    }
+    float std_mm = sqrtf(h.distance_var);
+    bool stats = fabsf(h.distance_mean_mm - 2200.0f) < 15.0f && fabsf(std_mm - 200.0f) < 15.0f &&
+                 fabsf(h.signal_mean - 50.0f) < 2.0f && h.error_rate == 0.0f && h.drop_rate == 0.0f;
+    // Empty room samples leave the target statistics alone and are not stuck
+    for (int i = 0; i < 200; i++) {
+        RadarMessage empty = sample(0, 0, RADAR_POSTURE_STILL);
+        changed |= sensor_health_update(&test_cfg, &h, &empty, 0);
+    }
+    bool empty_ok = fabsf(h.distance_mean_mm - 2200.0f) < 15.0f && h.same_run == 0 && h.score == 100 &&
+                    h.reasons == 0;
+
+    if (stats && empty_ok && !changed && !h.degraded) {
+        ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Test PASSED: Running mean and deviation match, a healthy module scores 100.");
+    } else {
+        ESP_LOGE(TAG_TEST_SENSOR_HEALTH, "Test FAILED: mean %.1f std %.1f signal %.1f, empty %d, score %u, changed %d.",
+                 h.distance_mean_mm, std_mm, h.signal_mean, empty_ok, h.score, changed);
+    }
+}
+
+void test_sensor_health_stuck_and_signal() {
+    ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Running test: test_sensor_health_stuck_and_signal");
+    sensor_health_t h;
+    sensor_health_init(&h);
+    // Frozen sensor: the same frame over and over
+    RadarMessage frozen = sample(1730, 42, RADAR_POSTURE_SITTING);
+    int degraded_at = -1;
+    for (int i = 0; i < 100; i++) {
+        if (sensor_health_update(&test_cfg, &h, &frozen, 0) && degraded_at < 0) {
+            degraded_at = i;
+        }
+    }
+    bool stuck = degraded_at == test_cfg.stuck_samples && h.degraded && (h.reasons & SENSOR_HEALTH_STUCK) &&
+                 h.score == 40;
+    // One different frame ends the run: healthy again
+    RadarMessage moved = sample(1760, 45, RADAR_POSTURE_SITTING);
+    bool restored = sensor_health_update(&test_cfg, &h, &moved, 0) && !h.degraded && h.score == 100;
+
+    // Targets still reported but the signal collapsed (covered or failing antenna)
+    sensor_health_init(&h);
+    for (int i = 0; i < 200; i++) {
+        RadarMessage msg = sample((uint16_t)(2000 + (i % 5) * 10), (uint8_t)(i < 50 ? 55 : i % 3), RADAR_POSTURE_STANDING);
+        sensor_health_update(&test_cfg, &h, &msg, 0);
+    }
+    bool collapsed = h.degraded && h.reasons == SENSOR_HEALTH_SIGNAL && h.signal_mean < test_cfg.min_signal;
+    char reasons[48];
+    sensor_health_describe(SENSOR_HEALTH_STUCK | SENSOR_HEALTH_SIGNAL | SENSOR_HEALTH_NOISY, reasons, sizeof(reasons));
+    bool described = strcmp(reasons, "stuck,signal,noisy") == 0;
+
+    if (stuck && restored && collapsed && described) {
+        ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Test PASSED: Stuck values and a collapsed signal degrade the module.");
+    } else {
+        ESP_LOGE(TAG_TEST_SENSOR_HEALTH, "Test FAILED: degraded at %d (score %u), restored %d, collapsed %d, '%s'.",
+                 degraded_at, h.score, restored, collapsed, reasons);
+    }
+}
+
+void test_sensor_health_rates_and_hysteresis() {
+    ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Running test: test_sensor_health_rates_and_hysteresis");
+    sensor_health_t h;
+    sensor_health_init(&h);
+    // One sample in three lost: the drop rate settles at 1/3 of the samples sent
+    uint32_t lost = 0;
+    for (int i = 0; i < 600; i++) {
+        lost += (i % 2 == 1);
+        RadarMessage msg = sample((uint16_t)(1500 + (i % 7) * 20), 50, RADAR_POSTURE_STANDING);
+        sensor_health_update(&test_cfg, &h, &msg, lost);
+    }
+    bool drops = fabsf(h.drop_rate - 1.0f / 3.0f) < 0.05f && (h.reasons & SENSOR_HEALTH_DROPS) && h.degraded &&
+                 h.score == 40 && !h.alerted;
+
+    // No more losses, every other frame an error: still degraded (errors), then clean frames
+    for (int i = 0; i < 200; i++) {
+        RadarMessage msg = sample((uint16_t)(1500 + (i % 7) * 20), 50,
+                                  i % 2 ? RADAR_POSTURE_UNKNOWN : RADAR_POSTURE_STANDING);
+        sensor_health_update(&test_cfg, &h, &msg, lost);
+    }
+    bool errors = h.degraded && (h.reasons & SENSOR_HEALTH_ERRORS) && !(h.reasons & SENSOR_HEALTH_DROPS) &&
+                  fabsf(h.error_rate - 0.5f) < 0.05f;
+    // The score climbs back through the hysteresis band before the module is restored
+    bool in_band = false;
+    int restored_at = -1;
+    for (int i = 0; i < 400 && restored_at < 0; i++) {
+        RadarMessage msg = sample((uint16_t)(1500 + (i % 7) * 20), 50, RADAR_POSTURE_STANDING);
+        if (sensor_health_update(&test_cfg, &h, &msg, lost)) {
+            restored_at = i;
+        }
+        in_band |= h.degraded && h.score >= test_cfg.degraded_below && h.score < test_cfg.restored_above;
+    }
+    bool restored = restored_at > 0 && !h.degraded && h.score >= test_cfg.restored_above && in_band;
+
+    if (drops && errors && restored) {
+        ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "Test PASSED: Drop and error rates degrade the module, restored past the band.");
+    } else {
+        ESP_LOGE(TAG_TEST_SENSOR_HEALTH, "Test FAILED: drops %d (%.3f), errors %d (%.3f), restored at %d (band %d).",
+                 drops, h.drop_rate, errors, h.error_rate, restored_at, in_band);
+    }
+}
+
+void run_sensor_health_tests() {
+    ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "--- Starting Sensor Health Tests ---");
+    test_sensor_health_statistics();
+    test_sensor_health_stuck_and_signal();
+    test_sensor_health_rates_and_hysteresis();
+    ESP_LOGI(TAG_TEST_SENSOR_HEALTH, "--- Finished Sensor Health Tests ---");
+}
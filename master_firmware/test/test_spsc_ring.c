@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "spsc_ring.h"
+#include "pipeline_msgs.h"
+
+// --- BEGIN NOTE ---
+// spsc_ring.c (master_firmware/main) is plain C11 (stdatomic): these tests run
+// the producer and the consumer side from one task, which checks the order,
+// the wrap-around, the batches, the counters and the park/wake handshake. The
+// two-task case (task notifications, two cores) is the boot self-benchmark of
+// main.c and host_bench/bench_spsc_ring.c.
+// --- END NOTE ---
+
+static const char *TAG_TEST_SPSC = "TEST_SPSC_RING";
+
+static RadarMessage sample(uint32_t sequence) {
+    RadarMessage msg = { 0 };
+    msg.sequence = sequence;
+    msg.module_id = (uint8_t)(sequence % 7 + 1);
+    msg.distance_mm = (uint16_t)(1000 + sequence);
+    return msg;
+}
+
+void test_spsc_ring_init() {
+    ESP_LOGI(TAG_TEST_SPSC, "Running test: test_spsc_ring_init");
+    static RadarMessage slots[8];
+    spsc_ring_t r;
+    bool ok = spsc_ring_init(&r, slots, sizeof(RadarMessage), 8) && r.capacity == 8 && spsc_ring_count(&r) == 0 &&
+              !spsc_ring_init(&r, slots, sizeof(RadarMessage), 6) &&   // Not a power of two
+              !spsc_ring_init(&r, slots, sizeof(RadarMessage), 0) &&
+              !spsc_ring_init(&r, NULL, sizeof(RadarMessage), 8) &&
+              !spsc_ring_init(&r, slots, 0, 8) &&
+              spsc_ring_init(&r, slots, sizeof(RadarMessage), 1);      // A single slot is a valid ring
+    if (ok) {
+        ESP_LOGI(TAG_TEST_SPSC, "Test PASSED: Power-of-two capacities accepted, bad arguments rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_SPSC, "Test FAILED: Ring init accepted a bad argument or refused a good one.");
+    }
+}
+
+void test_spsc_ring_order_and_wrap() {
+    ESP_LOGI(TAG_TEST_SPSC, "Running test: test_spsc_ring_order_and_wrap");
+    static RadarMessage slots[4];
+    spsc_ring_t r;
+    spsc_ring_init(&r, slots, sizeof(RadarMessage), 4);
+    uint32_t next_in = 0, next_out = 0;
+    int errors = 0;
+    // Fill, overflow twice, then drain and refill in uneven steps so that
+    // batches cross the end of the slots
+    for (int i = 0; i < 4; i++) {
+        RadarMessage m = sample(next_in++);
+        errors += !spsc_ring_push(&r, &m);
+    }
+    RadarMessage extra = sample(999);
+    errors += spsc_ring_push(&r, &extra) + spsc_ring_push(&r, &extra);
+    for (int round = 0; round < 50; round++) {
+        RadarMessage out[8];
+        uint32_t n = spsc_ring_pop_batch(&r, out, (uint32_t)(round % 3 + 1));
+        for (uint32_t i = 0; i < n; i++) {
+            errors += out[i].sequence != next_out || out[i].distance_mm != 1000 + next_out;
+            next_out++;
+        }
+        for (int i = 0; i < round % 4; i++) {
+            RadarMessage m = sample(next_in);
+            if (spsc_ring_push(&r, &m)) {
+                next_in++;
+            }
+        }
+        errors += spsc_ring_count(&r) != next_in - next_out;
+    }
+    RadarMessage rest[8];
+    uint32_t n = spsc_ring_pop_batch(&r, rest, 8);
+    for (uint32_t i = 0; i < n; i++) {
+        errors += rest[i].sequence != next_out++;
+    }
+    spsc_ring_stats_t st;
+    spsc_ring_get_stats(&r, &st);
+    if (errors == 0 && next_out == next_in && next_in > 40 && st.count == 0 && st.capacity == 4 && st.high_water == 4 &&
+        st.pushed == next_in && st.dropped >= 2) {
+        ESP_LOGI(TAG_TEST_SPSC, "Test PASSED: %u items in order across the wrap, %u refused when full, peak %u/%u.",
+                 st.pushed, st.dropped, st.high_water, st.capacity);
+    } else {
+        ESP_LOGE(TAG_TEST_SPSC, "Test FAILED: %d errors, %u in / %u out, stats %u pushed %u dropped peak %u count %u.",
+                 errors, next_in, next_out, st.pushed, st.dropped, st.high_water, st.count);
+    }
+}
+
+void test_spsc_ring_park_and_wake() {
+    ESP_LOGI(TAG_TEST_SPSC, "Running test: test_spsc_ring_park_and_wake");
+    static FusedData slots[2];
+    spsc_ring_t r;
+    spsc_ring_init(&r, slots, sizeof(FusedData), 2);
+    FusedData item = { 0 };
+    item.room = 3;
+
+    bool no_sleeper = !spsc_ring_take_sleeper(&r);  // Nobody parked: no wake-up
+    bool parked = spsc_ring_park(&r);               // Empty ring: the consumer may sleep
+    spsc_ring_push(&r, &item);
+    bool woken = spsc_ring_take_sleeper(&r);        // First push after the park wakes it...
+    spsc_ring_push(&r, &item);
+    bool once = !spsc_ring_take_sleeper(&r);        // ...once
+    spsc_ring_unpark(&r);
+    bool refused = !spsc_ring_park(&r);             // Items waiting: pop them first
+    bool not_left_parked = !spsc_ring_take_sleeper(&r);
+    FusedData out[2];
+    uint32_t n = spsc_ring_pop_batch(&r, out, 2);
+    bool parked_again = spsc_ring_park(&r);
+    spsc_ring_unpark(&r);                           // Woken by the timeout instead
+    bool cleared = !spsc_ring_take_sleeper(&r);
+
+    if (no_sleeper && parked && woken && once && refused && not_left_parked && n == 2 && out[1].room == 3 &&
+        parked_again && cleared) {
+        ESP_LOGI(TAG_TEST_SPSC, "Test PASSED: Park refused with items waiting; a parked consumer woken once.");
+    } else {
+        ESP_LOGE(TAG_TEST_SPSC, "Test FAILED: no_sleeper %d parked %d woken %d once %d refused %d not_left %d n %u "
+                 "again %d cleared %d.", no_sleeper, parked, woken, once, refused, not_left_parked, n, parked_again,
+                 cleared);
+    }
+}
+
+void run_spsc_ring_tests() {
+    ESP_LOGI(TAG_TEST_SPSC, "--- Starting SPSC Ring Tests ---");
+    test_spsc_ring_init();
+    test_spsc_ring_order_and_wrap();
+    test_spsc_ring_park_and_wake();
+    ESP_LOGI(TAG_TEST_SPSC, "--- Finished SPSC Ring Tests ---");
+}
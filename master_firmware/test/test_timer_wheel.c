@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "timer_wheel.h"
+
+// --- BEGIN NOTE ---
+// timer_wheel.c (master_firmware/main) is plain C: these tests arm, re-arm
+// and cancel timers the way the watchdog does for the module deadlines, and
+// check that each one fires at the first expiry at or after its deadline,
+// never before, across several turns of the wheel and the wrap-around of the
+// millisecond clock. A random sequence is checked against a plain array of
+// deadlines.
+// --- END NOTE ---
+
+static const char *TAG_TEST_TIMER_WHEEL = "TEST_TIMER_WHEEL";
+
+#define TEST_TIMERS 64
+#define TEST_SHIFT  4 // 16 ms slots, 4096 ms per turn
+
+static timer_wheel_t test_wheel;
+static timer_wheel_entry_t test_timers[TEST_TIMERS];
+
+void test_timer_wheel_fires_at_deadline() {
+    ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Running test: test_timer_wheel_fires_at_deadline");
+    timer_wheel_init(&test_wheel, test_timers, TEST_TIMERS, TEST_SHIFT, 1000);
+    timer_wheel_arm(&test_wheel, 1, 6001);   // Module timeout 5 s after a sample at 1000 ms
+    timer_wheel_arm(&test_wheel, 2, 6005);
+    timer_wheel_arm(&test_wheel, 3, 20000);  // More than three turns away
+    timer_wheel_arm(&test_wheel, 4, 3000);
+    timer_wheel_arm(&test_wheel, 4, 9000);   // New sample: deadline moved
+    timer_wheel_arm(&test_wheel, 5, 7000);
+    timer_wheel_cancel(&test_wheel, 5);      // Module removed
+
+    uint16_t ids[8];
+    uint32_t next = 0;
+    bool early = timer_wheel_expire(&test_wheel, 6000, ids, 8) == 0 &&
+                 timer_wheel_next_deadline(&test_wheel, &next) && next == 6001;
+    size_t n1 = timer_wheel_expire(&test_wheel, 6001, ids, 8);
+    bool first = n1 == 1 && ids[0] == 1 && !timer_wheel_armed(&test_wheel, 1);
+    size_t n2 = timer_wheel_expire(&test_wheel, 8999, ids, 8);
+    bool second = n2 == 1 && ids[0] == 2 && timer_wheel_next_deadline(&test_wheel, &next) && next == 9000;
+    bool moved = timer_wheel_expire(&test_wheel, 9000, ids, 8) == 1 && ids[0] == 4;
+    // Passed by three turns of the slot of 20000 ms without firing
+    bool far = timer_wheel_expire(&test_wheel, 19999, ids, 8) == 0 && timer_wheel_armed(&test_wheel, 3) &&
+               timer_wheel_expire(&test_wheel, 25000, ids, 8) == 1 && ids[0] == 3;
+    bool empty = test_wheel.armed == 0 && !timer_wheel_next_deadline(&test_wheel, &next) &&
+                 !timer_wheel_armed(&test_wheel, 5);
+
+    if (early && first && second && moved && far && empty) {
+        ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Test PASSED: Timers fire at their deadline, re-armed and cancelled in O(1).");
+    } else {
+        ESP_LOGE(TAG_TEST_TIMER_WHEEL, "Test FAILED: early %d, first %d (%u), second %d (%u), moved %d, far %d, empty %d.",
+                 early, first, (unsigned)n1, second, (unsigned)n2, moved, far, empty);
+    }
+}
+
+void test_timer_wheel_clock_wrap() {
+    ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Running test: test_timer_wheel_clock_wrap");
+    // 49.7 days of uptime: esp_log_timestamp() wraps during the timeouts
+    uint32_t now = 0xFFFFF000u;
+    timer_wheel_init(&test_wheel, test_timers, TEST_TIMERS, TEST_SHIFT, now);
+    timer_wheel_arm(&test_wheel, 7, now + 5001);  // After the wrap
+    timer_wheel_arm(&test_wheel, 8, now + 100);   // Before it
+    timer_wheel_arm(&test_wheel, 9, now - 50);    // Already past: next expiry
+    uint16_t ids[8];
+    bool past = timer_wheel_expire(&test_wheel, now, ids, 8) == 1 && ids[0] == 9;
+    bool before = timer_wheel_expire(&test_wheel, now + 99, ids, 8) == 0 &&
+                  timer_wheel_expire(&test_wheel, now + 100, ids, 8) == 1 && ids[0] == 8;
+    uint32_t next = 0;
+    bool after = timer_wheel_next_deadline(&test_wheel, &next) && next == now + 5001 && next < 0x1000u &&
+                 timer_wheel_expire(&test_wheel, now + 5000, ids, 8) == 0 &&
+                 timer_wheel_expire(&test_wheel, now + 5001, ids, 8) == 1 && ids[0] == 7;
+
+    // More due timers than the output: the rest at the next call
+    for (uint16_t i = 0; i < 20; i++) {
+        timer_wheel_arm(&test_wheel, i, 7000 + i % 3);
+    }
+    size_t a = timer_wheel_expire(&test_wheel, 8000, ids, 8);
+    size_t b = timer_wheel_expire(&test_wheel, 8000, ids, 8);
+    size_t c = timer_wheel_expire(&test_wheel, 8000, ids, 8);
+    bool batched = a == 8 && b == 8 && c == 4 && test_wheel.armed == 0;
+
+    if (past && before && after && batched) {
+        ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Test PASSED: Deadlines across the clock wrap, past deadlines, batched expiry.");
+    } else {
+        ESP_LOGE(TAG_TEST_TIMER_WHEEL, "Test FAILED: past %d, before %d, after %d (next %u), batched %u/%u/%u.",
+                 past, before, after, next, (unsigned)a, (unsigned)b, (unsigned)c);
+    }
+}
+
+void test_timer_wheel_matches_reference() {
+    ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Running test: test_timer_wheel_matches_reference");
+    // Reference: a deadline per timer, 0 = disarmed, scanned at every step
+    uint32_t reference[TEST_TIMERS] = { 0 };
+    uint32_t now = 0xFFFE0000u; // The clock wraps a third of the way
+    timer_wheel_init(&test_wheel, test_timers, TEST_TIMERS, TEST_SHIFT, now);
+    srand(49);
+    int mismatches = 0, fired = 0;
+    for (int step = 0; step < 20000 && mismatches == 0; step++) {
+        uint16_t id = (uint16_t)(rand() % TEST_TIMERS);
+        int op = rand() % 10;
+        if (op < 7) {
+            uint32_t deadline = now + (uint32_t)(rand() % 12000); // Up to three turns away
+            timer_wheel_arm(&test_wheel, id, deadline);
+            reference[id] = deadline;
+        } else if (op == 7) {
+            timer_wheel_cancel(&test_wheel, id);
+            reference[id] = 0;
+        }
+        now += (uint32_t)(rand() % 40);
+
+        uint16_t ids[TEST_TIMERS];
+        size_t n = timer_wheel_expire(&test_wheel, now, ids, TEST_TIMERS);
+        bool got[TEST_TIMERS] = { false };
+        for (size_t i = 0; i < n; i++) {
+            got[ids[i]] = true;
+        }
+        uint32_t earliest = 0;
+        bool any = false;
+        for (int i = 0; i < TEST_TIMERS; i++) {
+            bool due = reference[i] != 0 && (int32_t)(now - reference[i]) >= 0;
+            mismatches += due != got[i];
+            if (due) {
+                reference[i] = 0;
+                fired++;
+            } else if (reference[i] != 0 && (!any || (int32_t)(reference[i] - earliest) < 0)) {
+                earliest = reference[i];
+                any = true;
+            }
+        }
+        uint32_t next = 0;
+        bool has_next = timer_wheel_next_deadline(&test_wheel, &next);
+        mismatches += has_next != any || (any && next != earliest);
+    }
+
+    if (mismatches == 0 && fired > 1000) {
+        ESP_LOGI(TAG_TEST_TIMER_WHEEL, "Test PASSED: 20000 random operations, same expiries as a full scan (%d fired).",
+                 fired);
+    } else {
+        ESP_LOGE(TAG_TEST_TIMER_WHEEL, "Test FAILED: %d mismatches, %d fired.", mismatches, fired);
+    }
+}
+
+void run_timer_wheel_tests() {
+    ESP_LOGI(TAG_TEST_TIMER_WHEEL, "--- Starting Timer Wheel Tests ---");
+    test_timer_wheel_fires_at_deadline();
+    test_timer_wheel_clock_wrap();
+    test_timer_wheel_matches_reference();
+    ESP_LOGI(TAG_TEST_TIMER_WHEEL, "--- Finished Timer Wheel Tests ---");
+}
@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "trilateration.h"
+
+// --- BEGIN NOTE ---
+// trilateration.c (master_firmware/main) is plain C, so these tests run the real
+// solver run by mtt_room_step() (multi_tracker.c). Ranges are computed from a known
+// position (synthetic ground truth), with or without Gaussian noise from a
+// fixed-seed generator, and the solution is compared with that position.
+// --- END NOTE ---
+
+static const char *TAG_TEST_TRILAT = "TEST_TRILATERATION";
+
+static const trilat_bounds_t room_4x4 = { 0.0f, 0.0f, 4.0f, 4.0f };
+
+static uint32_t rng_state;
+
+static float rng_uniform(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)((rng_state >> 8) + 1) / 16777217.0f; // (0, 1)
+}
+
+static float rng_gauss(void) {
+    return sqrtf(-2.0f * logf(rng_uniform())) * cosf(6.2831853f * rng_uniform());
+}
+
+static void ranges_from(const trilat_geometry_t *g, trilat_point_t truth, float sigma, float *ranges) {
+    for (int k = 0; k < TRILAT_MAX_SENSORS; k++) {
+        float dx = truth.x - g->pos[k].x, dy = truth.y - g->pos[k].y;
+        ranges[k] = sqrtf(dx * dx + dy * dy) + (sigma > 0.0f ? sigma * rng_gauss() : 0.0f);
+    }
+}
+
+static float error_m(const trilat_result_t *r, trilat_point_t truth) {
+    return hypotf(r->p.x - truth.x, r->p.y - truth.y);
+}
+
+void test_trilat_two_sensors_on_wall() {
+    ESP_LOGI(TAG_TEST_TRILAT, "Running test: test_trilat_two_sensors_on_wall");
+    trilat_geometry_t g;
+    trilat_geometry_init(&g, &room_4x4, 0.0f);
+    trilat_geometry_set_sensor(&g, 0, 0.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 1, 4.0f, 0.0f);
+
+    // Both sensors on the y = 0 wall: the mirror solution is outside the room
+    float worst = 0.0f;
+    bool ok = true;
+    for (float x = 0.25f; x < 4.0f; x += 0.5f) {
+        for (float y = 0.25f; y < 4.0f; y += 0.5f) {
+            trilat_point_t truth = { x, y };
+            float ranges[TRILAT_MAX_SENSORS];
+            trilat_result_t r;
+            ranges_from(&g, truth, 0.0f, ranges);
+            ok = ok && trilat_solve(&g, 0x03, ranges, NULL, &r) && r.used == 2 && r.flags == 0;
+            worst = fmaxf(worst, error_m(&r, truth));
+        }
+    }
+
+    if (ok && worst < 0.001f) {
+        ESP_LOGI(TAG_TEST_TRILAT, "Test PASSED: Two-circle intersection exact on a 8x8 grid (worst %.2f mm).", worst * 1000.0f);
+    } else {
+        ESP_LOGE(TAG_TEST_TRILAT, "Test FAILED: Two-circle intersection wrong (worst %.3f m).", worst);
+    }
+}
+
+void test_trilat_two_sensors_ambiguity() {
+    ESP_LOGI(TAG_TEST_TRILAT, "Running test: test_trilat_two_sensors_ambiguity");
+    trilat_geometry_t g;
+    trilat_geometry_init(&g, &room_4x4, 0.0f);
+    trilat_geometry_set_sensor(&g, 2, 0.0f, 2.0f);
+    trilat_geometry_set_sensor(&g, 5, 4.0f, 2.0f);
+
+    // Sensors across the middle of the room: (1, 3) and (1, 1) give the same ranges
+    float ranges[TRILAT_MAX_SENSORS];
+    trilat_point_t truth = { 1.0f, 3.0f }, near_top = { 1.2f, 3.3f }, near_bottom = { 0.8f, 0.9f };
+    trilat_result_t top, bottom, apart;
+    ranges_from(&g, truth, 0.0f, ranges);
+    bool ok = trilat_solve(&g, 0x24, ranges, &near_top, &top) &&
+              trilat_solve(&g, 0x24, ranges, &near_bottom, &bottom);
+
+    // Circles that do not meet (ranges too short): point on the baseline
+    ranges[2] = 1.5f;
+    ranges[5] = 2.0f;
+    ok = ok && trilat_solve(&g, 0x24, ranges, NULL, &apart);
+
+    if (ok && error_m(&top, truth) < 0.001f && fabsf(bottom.p.y - 1.0f) < 0.001f &&
+        (top.flags & TRILAT_FLAG_AMBIGUOUS) && (apart.flags & TRILAT_FLAG_NO_INTERSECTION) &&
+        fabsf(apart.p.y - 2.0f) < 0.001f && apart.gdop >= TRILAT_GDOP_MAX) {
+        ESP_LOGI(TAG_TEST_TRILAT, "Test PASSED: Mirror solution resolved with the hint, disjoint circles flagged.");
+    } else {
+        ESP_LOGE(TAG_TEST_TRILAT, "Test FAILED: Ambiguity handling (top %.2f,%.2f bottom %.2f,%.2f).",
+                 top.p.x, top.p.y, bottom.p.x, bottom.p.y);
+    }
+}
+
+void test_trilat_least_squares_exact() {
+    ESP_LOGI(TAG_TEST_TRILAT, "Running test: test_trilat_least_squares_exact");
+    trilat_geometry_t g;
+    trilat_geometry_init(&g, &room_4x4, 0.0f);
+    trilat_geometry_set_sensor(&g, 0, 0.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 1, 4.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 2, 4.0f, 4.0f);
+    trilat_geometry_set_sensor(&g, 3, 0.0f, 4.0f);
+
+    rng_state = 7;
+    float worst = 0.0f;
+    int max_iterations = 0;
+    bool ok = true;
+    static const uint8_t masks[] = { 0x0F, 0x07, 0x0B, 0x0D, 0x0E };
+    for (int i = 0; i < 500; i++) {
+        trilat_point_t truth = { 4.0f * rng_uniform(), 4.0f * rng_uniform() };
+        float ranges[TRILAT_MAX_SENSORS];
+        trilat_result_t r;
+        ranges_from(&g, truth, 0.0f, ranges);
+        uint8_t mask = masks[i % 5]; // Changes the cached subset on every call
+        ok = ok && trilat_solve(&g, mask, ranges, NULL, &r) && r.used == __builtin_popcount(mask);
+        worst = fmaxf(worst, error_m(&r, truth));
+        max_iterations = r.iterations > max_iterations ? r.iterations : max_iterations;
+    }
+
+    if (ok && worst < 0.001f && max_iterations <= 2) {
+        ESP_LOGI(TAG_TEST_TRILAT, "Test PASSED: 3-4 sensors exact on 500 points (worst %.2f mm, %d iterations max).",
+                 worst * 1000.0f, max_iterations);
+    } else {
+        ESP_LOGE(TAG_TEST_TRILAT, "Test FAILED: Least squares not exact (worst %.3f m, %d iterations).", worst, max_iterations);
+    }
+}
+
+void test_trilat_noisy_accuracy_matches_covariance() {
+    ESP_LOGI(TAG_TEST_TRILAT, "Running test: test_trilat_noisy_accuracy_matches_covariance");
+    const float sigma = 0.05f;
+    trilat_geometry_t g;
+    trilat_geometry_init(&g, &room_4x4, sigma);
+    trilat_geometry_set_sensor(&g, 0, 0.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 1, 4.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 2, 4.0f, 4.0f);
+    trilat_geometry_set_sensor(&g, 3, 0.0f, 4.0f);
+
+    // Same point many times: the scatter must match the predicted covariance
+    rng_state = 12345;
+    trilat_point_t truth = { 1.3f, 2.6f };
+    double sum_err2 = 0.0, sum_pred = 0.0, sum_gdop = 0.0;
+    const int trials = 4000;
+    bool ok = true;
+    for (int i = 0; i < trials; i++) {
+        float ranges[TRILAT_MAX_SENSORS];
+        trilat_result_t r;
+        ranges_from(&g, truth, sigma, ranges);
+        ok = ok && trilat_solve(&g, 0x0F, ranges, NULL, &r);
+        float e = error_m(&r, truth);
+        sum_err2 += e * e;
+        sum_pred += r.cov_xx + r.cov_yy;
+        sum_gdop += r.gdop;
+    }
+    double rms = sqrt(sum_err2 / trials), predicted = sqrt(sum_pred / trials);
+    double gdop = sum_gdop / trials;
+
+    if (ok && rms < 0.1 && rms / predicted > 0.85 && rms / predicted < 1.15 && gdop > 0.7 && gdop < 1.5) {
+        ESP_LOGI(TAG_TEST_TRILAT, "Test PASSED: RMS error %.1f mm vs predicted %.1f mm (GDOP %.2f) at 5 cm range noise.",
+                 rms * 1000.0, predicted * 1000.0, gdop);
+    } else {
+        ESP_LOGE(TAG_TEST_TRILAT, "Test FAILED: RMS error %.1f mm vs predicted %.1f mm (GDOP %.2f).",
+                 rms * 1000.0, predicted * 1000.0, gdop);
+    }
+}
+
+void test_trilat_collinear_and_missing() {
+    ESP_LOGI(TAG_TEST_TRILAT, "Running test: test_trilat_collinear_and_missing");
+    trilat_geometry_t g;
+    trilat_geometry_init(&g, &room_4x4, 0.0f);
+    trilat_geometry_set_sensor(&g, 0, 0.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 1, 2.0f, 0.0f);
+    trilat_geometry_set_sensor(&g, 2, 4.0f, 0.0f);
+
+    float ranges[TRILAT_MAX_SENSORS];
+    trilat_point_t truth = { 2.7f, 1.9f };
+    trilat_result_t r, single, uncalibrated;
+    ranges_from(&g, truth, 0.0f, ranges);
+    bool solved = trilat_solve(&g, 0x07, ranges, NULL, &r);
+    // One sensor, or a second one without calibrated position: no solution
+    bool one = trilat_solve(&g, 0x01, ranges, NULL, &single);
+    trilat_geometry_clear_sensor(&g, 1);
+    bool missing = trilat_solve(&g, 0x12, ranges, NULL, &uncalibrated);
+
+    if (solved && (r.flags & TRILAT_FLAG_DEGENERATE) && error_m(&r, truth) < 0.001f && r.used == 3 && !one && !missing) {
+        ESP_LOGI(TAG_TEST_TRILAT, "Test PASSED: Collinear sensors solved via bounds, fewer than 2 sensors rejected.");
+    } else {
+        ESP_LOGE(TAG_TEST_TRILAT, "Test FAILED: Collinear/missing sensors (solved %d, error %.3f m).", solved, error_m(&r, truth));
+    }
+}
+
+void run_trilateration_tests() {
+    ESP_LOGI(TAG_TEST_TRILAT, "--- Starting Trilateration Tests ---");
+    test_trilat_two_sensors_on_wall();
+    test_trilat_two_sensors_ambiguity();
+    test_trilat_least_squares_exact();
+    test_trilat_noisy_accuracy_matches_covariance();
+    test_trilat_collinear_and_missing();
+    ESP_LOGI(TAG_TEST_TRILAT, "--- Finished Trilateration Tests ---");
+}
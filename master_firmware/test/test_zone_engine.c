@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "zone_engine.h"
+
+// --- BEGIN NOTE ---
+// zone_engine.c (master_firmware/main) is plain C: these tests compare the
+// grid with a test of every zone on a lattice of positions (a concave zone,
+// overlapping zones, zones past the bounds), replay a walk through the zones
+// for the ENTER / DWELL / EXIT events, and check the binding by room name and
+// the fall policy. The classification rate with hundreds of zones is
+// host_bench/bench_zone_engine.c.
+// --- END NOTE ---
+
+static const char *TAG_TEST_ZONE = "TEST_ZONE_ENGINE";
+
+static const zone_def_t test_zones[] = {
+    // L-shaped (concave), every side off the 250 mm grid
+    { "chambre", "L", ZONE_FALL_NORMAL, 6, 0,
+      { { 130, 170 }, { 2870, 170 }, { 2870, 1240 }, { 1310, 1240 }, { 1310, 3330 }, { 130, 3330 } }, 0 },
+    // Triangle overlapping the L
+    { "chambre", "tri", ZONE_FALL_SUPPRESS, 3, 0, { { 900, 900 }, { 3900, 1600 }, { 1700, 3900 } }, 0 },
+    // Rectangle on grid lines, partly past the bounds
+    { "chambre", "bord", ZONE_FALL_ESCALATE, 4, 0, { { 3500, -500 }, { 5500, -500 }, { 5500, 1000 }, { 3500, 1000 } }, 0 },
+    { "salon", "canape", ZONE_FALL_SUPPRESS, 4, 0, { { 0, 0 }, { 2000, 0 }, { 2000, 900 }, { 0, 900 } }, 0 },
+};
+
+static uint16_t test_arena[1024];
+
+static bool same_hits(const uint16_t *a, int na, const uint16_t *b, int nb) {
+    if (na != nb) {
+        return false;
+    }
+    for (int i = 0; i < na; i++) {
+        bool found = false;
+        for (int j = 0; j < nb && !found; j++) {
+            found = a[i] == b[j];
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_zone_grid_matches_linear() {
+    ESP_LOGI(TAG_TEST_ZONE, "Running test: test_zone_grid_matches_linear");
+    zone_engine_t ze;
+    bool ok = zone_engine_init(&ze, test_zones, 4, test_arena, 1024, 0, 0, 5000, 4000, 250);
+    int bound = zone_engine_bind_room(&ze, 0, "chambre");
+
+    int checked = 0, mismatches = 0, inside_l = 0, notch = 0, overlap = 0;
+    for (int y = -100; y < 4200; y += 37) {
+        for (int x = -100; x < 5200; x += 41) {
+            uint16_t grid[ZONE_MAX_HITS], linear[ZONE_MAX_HITS];
+            int ng = zone_engine_classify(&ze, 0, (int16_t)x, (int16_t)y, grid, ZONE_MAX_HITS);
+            int nl = zone_engine_classify_linear(&ze, 0, (int16_t)x, (int16_t)y, linear, ZONE_MAX_HITS);
+            mismatches += !same_hits(grid, ng, linear, nl);
+            checked++;
+            inside_l += ng > 0 && grid[0] == 0;
+            overlap += ng >= 2;
+        }
+    }
+    // The notch of the L is not in the L
+    uint16_t hits[ZONE_MAX_HITS];
+    int n = zone_engine_classify(&ze, 0, 2500, 2500, hits, ZONE_MAX_HITS);
+    for (int i = 0; i < n; i++) {
+        notch += hits[i] == 0;
+    }
+    bool outside = zone_engine_classify(&ze, 0, 4999, 3999, hits, ZONE_MAX_HITS) == 0 &&
+                   zone_engine_classify(&ze, 0, 6000, 100, hits, ZONE_MAX_HITS) == 0 &&
+                   zone_engine_classify(&ze, 1, 500, 500, hits, ZONE_MAX_HITS) == 0; // Room 1 not bound
+
+    if (ok && bound == 3 && mismatches == 0 && inside_l > 0 && overlap > 0 && notch == 0 && outside) {
+        ESP_LOGI(TAG_TEST_ZONE, "Test PASSED: Grid agrees with every zone tested on %d positions (%u arena words).",
+                 checked, ze.arena_used);
+    } else {
+        ESP_LOGE(TAG_TEST_ZONE, "Test FAILED: init %d bound %d, %d/%d mismatches, in L %d overlap %d notch %d outside %d.",
+                 ok, bound, mismatches, checked, inside_l, overlap, notch, outside);
+    }
+}
+
+void test_zone_events() {
+    ESP_LOGI(TAG_TEST_ZONE, "Running test: test_zone_events");
+    static const zone_def_t zones[] = {
+        { "sdb", "douche", ZONE_FALL_ESCALATE, 4, 0, { { 0, 0 }, { 1000, 0 }, { 1000, 1000 }, { 0, 1000 } }, 0 },
+        { "sdb", "lavabo", ZONE_FALL_NORMAL, 4, 10, { { 500, 0 }, { 1500, 0 }, { 1500, 1000 }, { 500, 1000 } }, 0 },
+    };
+    zone_engine_t ze;
+    zone_engine_init(&ze, zones, 2, test_arena, 1024, 0, 0, 3000, 3000, 250);
+    zone_engine_bind_room(&ze, 2, "sdb");
+    zone_presence_t p;
+    zone_presence_init(&p);
+    zone_event_t ev[ZONE_MAX_EVENTS];
+    int errors = 0;
+
+    int n = zone_engine_update(&ze, &p, 2, 200, 200, 1000, ev);       // Into the shower
+    errors += n != 1 || ev[0].type != ZONE_EVENT_ENTER || ev[0].zone != 0;
+    n = zone_engine_update(&ze, &p, 2, 700, 500, 2000, ev);           // Shower and basin
+    errors += n != 1 || ev[0].type != ZONE_EVENT_ENTER || ev[0].zone != 1;
+    n = zone_engine_tick(&ze, &p, 11000, ev);                         // 9 s at the basin: not yet
+    errors += n != 0;
+    n = zone_engine_update(&ze, &p, 2, 1200, 500, 12500, ev);         // Leaves the shower, 10.5 s at the basin
+    errors += n != 2 || ev[0].type != ZONE_EVENT_EXIT || ev[0].zone != 0 || ev[0].inside_ms != 11500 ||
+              ev[1].type != ZONE_EVENT_DWELL || ev[1].zone != 1 || ev[1].inside_ms != 10500;
+    n = zone_engine_tick(&ze, &p, 30000, ev);                         // DWELL sent once
+    errors += n != 0;
+    n = zone_engine_update(&ze, &p, 2, 2500, 2500, 31000, ev);        // Out of every zone
+    errors += n != 1 || ev[0].type != ZONE_EVENT_EXIT || ev[0].zone != 1 || ev[0].inside_ms != 29000;
+    errors += p.count != 0 || p.dwell_sent != 0;
+    n = zone_engine_update(&ze, &p, 2, 800, 800, 32000, ev);          // Back: both at once
+    errors += n != 2 || ev[0].type != ZONE_EVENT_ENTER || ev[1].type != ZONE_EVENT_ENTER;
+
+    if (errors == 0) {
+        ESP_LOGI(TAG_TEST_ZONE, "Test PASSED: ENTER, DWELL once after the dwell time, EXIT with the time inside.");
+    } else {
+        ESP_LOGE(TAG_TEST_ZONE, "Test FAILED: %d wrong event sequences.", errors);
+    }
+}
+
+void test_zone_binding_and_policy() {
+    ESP_LOGI(TAG_TEST_ZONE, "Running test: test_zone_binding_and_policy");
+    zone_engine_t ze, small, bad;
+    zone_engine_init(&ze, test_zones, 4, test_arena, 1024, 0, 0, 5000, 4000, 250);
+    int salon = zone_engine_bind_room(&ze, 3, "salon");
+    int unknown = zone_engine_bind_room(&ze, 4, "garage");
+    int again = zone_engine_bind_room(&ze, 3, "chambre");             // Bound once: unchanged
+    uint16_t hits[ZONE_MAX_HITS];
+    bool by_room = zone_engine_classify(&ze, 3, 1000, 500, hits, ZONE_MAX_HITS) == 1 && hits[0] == 3 &&
+                   zone_engine_classify(&ze, 4, 1000, 500, hits, ZONE_MAX_HITS) == 0;
+
+    // 20 x 16 cells need 321 words before any entry
+    zone_engine_init(&small, test_zones, 4, test_arena, 300, 0, 0, 5000, 4000, 250);
+    int refused = zone_engine_bind_room(&small, 0, "chambre");
+    bool no_zone = zone_engine_classify(&small, 0, 500, 500, hits, ZONE_MAX_HITS) == 0;
+    bool rejected = !zone_engine_init(&bad, test_zones, 4, test_arena, 1024, 0, 0, 5000, 4000, 0) &&
+                    !zone_engine_init(&bad, test_zones, 4, test_arena, 1024, 0, 0, 30000, 4000, 100);
+
+    // Policy: ESCALATE over SUPPRESS over NORMAL
+    zone_presence_t p;
+    zone_presence_init(&p);
+    uint16_t decided;
+    zone_fall_policy_t none = zone_engine_fall_policy(&ze, &p, &decided);
+    bool policy_ok = none == ZONE_FALL_NORMAL && decided == ZONE_NONE;
+    p.count = 2;
+    p.zone[0] = 0;  // NORMAL
+    p.zone[1] = 1;  // SUPPRESS
+    policy_ok &= zone_engine_fall_policy(&ze, &p, &decided) == ZONE_FALL_SUPPRESS && decided == 1;
+    p.count = 3;
+    p.zone[2] = 2;  // ESCALATE
+    policy_ok &= zone_engine_fall_policy(&ze, &p, &decided) == ZONE_FALL_ESCALATE && decided == 2;
+    p.zone[0] = 2;
+    p.zone[2] = 1;  // Order does not matter
+    policy_ok &= zone_engine_fall_policy(&ze, &p, NULL) == ZONE_FALL_ESCALATE;
+
+    if (salon == 1 && unknown == 0 && again == 1 && by_room && refused == -1 && no_zone && rejected && policy_ok) {
+        ESP_LOGI(TAG_TEST_ZONE, "Test PASSED: Zones bound by room name, full arena refused, ESCALATE over SUPPRESS.");
+    } else {
+        ESP_LOGE(TAG_TEST_ZONE, "Test FAILED: salon %d unknown %d again %d by_room %d refused %d no_zone %d "
+                 "rejected %d policy %d.", salon, unknown, again, by_room, refused, no_zone, rejected, policy_ok);
+    }
+}
+
+void run_zone_engine_tests() {
+    ESP_LOGI(TAG_TEST_ZONE, "--- Starting Zone Engine Tests ---");
+    test_zone_grid_matches_linear();
+    test_zone_events();
+    test_zone_binding_and_policy();
+    ESP_LOGI(TAG_TEST_ZONE, "--- Finished Zone Engine Tests ---");
+}
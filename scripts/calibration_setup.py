@@ -4,7 +4,7 @@
 Script de Calibration Conceptuel pour le Système de Détection de Chute.
 
 Ce script simule un processus de calibration où l'utilisateur peut définir:
-1. Les positions des capteurs radar dans la pièce.
+1. Les positions des capteurs radar et les dimensions de la pièce.
 2. Les seuils pour la détection de chute.
 3. Les seuils pour le mécanisme de watchdog des modules esclaves.
 
@@ -43,20 +43,28 @@ def get_int_input(prompt, default_value):
 
 def configure_sensor_positions():
     """
-    Permet à l'utilisateur de configurer les positions des capteurs.
-    Retourne un dictionnaire avec les positions des capteurs.
+    Permet à l'utilisateur de configurer les positions des capteurs et les
+    dimensions de la pièce (origine dans un coin, axes le long des murs).
+    Retourne un dictionnaire avec les positions des capteurs et la pièce.
     """
     print("\n--- Configuration des Positions des Capteurs ---")
-    print("Veuillez entrer les coordonnées (x, y) en mètres pour chaque capteur.")
-    
-    sensor1_x = get_float_input("Position X du Capteur 1", 0.0)
-    sensor1_y = get_float_input("Position Y du Capteur 1", 0.5)
-    sensor2_x = get_float_input("Position X du Capteur 2", 3.0)
-    sensor2_y = get_float_input("Position Y du Capteur 2", 0.5)
+    room_width = get_float_input("Largeur de la pièce (axe X) en mètres", 4.0)
+    room_depth = get_float_input("Profondeur de la pièce (axe Y) en mètres", 4.0)
+    sensor_count = get_int_input("Nombre de capteurs (2 minimum pour une position, 3+ conseillé)", 2)
+    print("Veuillez entrer l'id_module et les coordonnées (x, y) en mètres pour chaque capteur.")
+
+    defaults = [(0.0, 0.5), (3.0, 0.5), (room_width, room_depth), (0.0, room_depth)]
+    sensors = []
+    for i in range(sensor_count):
+        default_x, default_y = defaults[i] if i < len(defaults) else (0.0, 0.0)
+        module_id = get_int_input(f"id_module du Capteur {i + 1}", i + 1)
+        x = get_float_input(f"Position X du Capteur {i + 1}", default_x)
+        y = get_float_input(f"Position Y du Capteur {i + 1}", default_y)
+        sensors.append({"module_id": module_id, "x": x, "y": y})
 
     return {
-        "sensor1_pos": (sensor1_x, sensor1_y),
-        "sensor2_pos": (sensor2_x, sensor2_y)
+        "room_size": (room_width, room_depth),
+        "sensors": sensors
     }
 
 def configure_fall_detection_thresholds():
@@ -82,14 +90,10 @@ def configure_watchdog_thresholds():
     Retourne un dictionnaire avec les seuils.
     """
     print("\n--- Configuration des Seuils du Watchdog des Modules Esclaves ---")
-    watchdog_check_interval_s = get_int_input(
-        "Intervalle de vérification du watchdog en secondes", 2
-    )
     slave_module_timeout_s = get_int_input(
         "Délai d'attente avant de considérer un module esclave comme hors ligne en secondes", 5
     )
     return {
-        "watchdog_check_interval_s": watchdog_check_interval_s,
         "slave_module_timeout_s": slave_module_timeout_s
     }
 
@@ -98,25 +102,26 @@ def generate_c_code_snippets(sensor_positions, fall_thresholds, watchdog_thresho
     Génère les extraits de code C basés sur les configurations fournies.
     """
     print("\n\n--- Extraits de Code C Générés ---")
-    print("Veuillez copier et coller ces extraits dans `master_firmware/main/main.c` comme indiqué.")
-
-    # Extrait pour les positions des capteurs
-    print("\n// 1. Pour la fonction `calculate_xy_position` dans master_firmware/main/main.c:")
-    print("//    (Remplacez les valeurs existantes ou ajoutez-les si elles n'existent pas)")
-    print(f"// static const float SENSOR1_X = {sensor_positions['sensor1_pos'][0]:.2f}f;")
-    print(f"// static const float SENSOR1_Y = {sensor_positions['sensor1_pos'][1]:.2f}f;")
-    print(f"// static const float SENSOR2_X = {sensor_positions['sensor2_pos'][0]:.2f}f;")
-    print(f"// static const float SENSOR2_Y = {sensor_positions['sensor2_pos'][1]:.2f}f;")
-    print("// Assurez-vous que ces variables sont utilisées dans la logique de triangulation.")
+    print("Veuillez copier et coller ces extraits dans le firmware maître comme indiqué.")
+
+    # Extrait pour les positions des capteurs (utilisées par trilat_geometry_set_sensor, puis mtt_room_step)
+    print("\n// 1. Remplacez la table `sensor_calibration` et les limites de la pièce dans master_firmware/main/main.c:")
+    print("static const SensorCalibration sensor_calibration[] = {")
+    for sensor in sensor_positions['sensors']:
+        print(f"    {{ {sensor['module_id']}, {sensor['x']:.2f}f, {sensor['y']:.2f}f }},")
+    print("};")
+    print("#define ROOM_MIN_X_M 0.0f")
+    print("#define ROOM_MIN_Y_M 0.0f")
+    print(f"#define ROOM_MAX_X_M {sensor_positions['room_size'][0]:.2f}f")
+    print(f"#define ROOM_MAX_Y_M {sensor_positions['room_size'][1]:.2f}f")
 
     # Extrait pour les seuils de détection de chute
-    print("\n// 2. Pour les définitions globales (en haut de master_firmware/main/main.c):")
+    print("\n// 2. Seuils de chute (en haut de master_firmware/main/fall_rules.h):")
     print(f"#define FALL_TRANSITION_MAX_MS {fall_thresholds['fall_transition_max_ms']}")
     print(f"#define LYING_CONFIRMATION_DURATION_S {fall_thresholds['lying_confirmation_duration_s']}")
 
     # Extrait pour les seuils du watchdog
     print("\n// 3. Pour les définitions globales (en haut de master_firmware/main/main.c):")
-    print(f"#define WATCHDOG_CHECK_INTERVAL_S {watchdog_thresholds['watchdog_check_interval_s']}")
     print(f"#define SLAVE_MODULE_TIMEOUT_S {watchdog_thresholds['slave_module_timeout_s']}")
     
     print("\n--- Fin des Extraits de Code ---")
@@ -130,10 +135,8 @@ def generate_json_config(sensor_positions, fall_thresholds, watchdog_thresholds)
     depuis NVS ou SPIFFS, ce qui n'est pas le cas actuellement.
     """
     config = {
-        "sensor_positions": {
-            "sensor1": {"x": sensor_positions['sensor1_pos'][0], "y": sensor_positions['sensor1_pos'][1]},
-            "sensor2": {"x": sensor_positions['sensor2_pos'][0], "y": sensor_positions['sensor2_pos'][1]}
-        },
+        "room_size_m": {"x": sensor_positions['room_size'][0], "y": sensor_positions['room_size'][1]},
+        "sensor_positions": sensor_positions['sensors'],
         "fall_detection_thresholds": fall_thresholds,
         "watchdog_thresholds": watchdog_thresholds
     }
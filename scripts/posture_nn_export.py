@@ -0,0 +1,358 @@
+# scripts/posture_nn_export.py
+
+"""
+Entraînement et export du classifieur de posture du maître (posture_nn.c).
+
+Le script entraîne un petit perceptron multicouche (14 entrées, une couche
+cachée ReLU, 5 sorties STANDING..STILL) sur les caractéristiques calculées
+comme dans posture_nn_features() (master_firmware/main/posture_nn.c), le
+quantifie en int8 (poids et activations symétriques, biais int32,
+requantification par multiplicateur + décalage) et écrit :
+  - un blob binaire (--bin) à flasher dans la partition "posture_nn" du
+    maître, sans reflasher le code :
+        python $IDF_PATH/components/partition_table/parttool.py \\
+            write_partition --partition-name=posture_nn --input posture_nn.bin
+  - optionnellement (--c) le modèle par défaut compilé dans le firmware
+    (master_firmware/main/posture_nn_model.c).
+
+Données :
+  - par défaut, des séquences synthétiques imitant un LD2410 (distances des
+    cibles en mouvement / statique, signal, intervalle d'échantillonnage) ;
+    elles servent à valider la chaîne, pas à remplacer un enregistrement ;
+  - --data fichier.csv : échantillons enregistrés, une ligne par échantillon,
+    dans l'ordre chronologique, colonnes
+        module_id,timestamp_ms,distance_mm,moving_mm,static_mm,signal,posture
+    (posture : STANDING, SITTING, LYING, MOVING ou STILL, la vérité terrain).
+
+Python 3 seul (pas de numpy) : l'entraînement prend de l'ordre d'une minute.
+"""
+
+import argparse
+import csv
+import math
+import random
+import struct
+import zlib
+from collections import deque
+
+CLASSES = ["STANDING", "SITTING", "LYING", "MOVING", "STILL"]
+FEATURES = 14
+HISTORY_LEN = 4          # FUSION_HISTORY_LEN
+INPUT_SCALE = 1.0 / 64   # Valeur réelle d'une unité de caractéristique
+MAGIC = 0x314E4E50       # POSTURE_NN_MAGIC
+VERSION = 1
+RELU = 0x01
+CALIBRATION_PERCENTILE = 0.999
+INT16_MAX = 32767
+
+
+def sat8(v):
+    return max(-128, min(127, v))
+
+
+def tdiv(a, b):
+    """Division entière tronquée vers zéro, comme en C."""
+    q = abs(a) // b
+    return q if a >= 0 else -q
+
+
+def target_delta(now_mm, then_mm):
+    return now_mm - then_mm if now_mm != 0 and then_mm != 0 else 0
+
+
+def features(sample, prev, oldest):
+    """Miroir de posture_nn_features() : sample = (t, dist, mov, stat, signal)."""
+    t, dist, mov, stat, sig = sample
+    f = [0] * FEATURES
+    f[0] = sat8(tdiv(dist, 50))
+    f[1] = sat8(tdiv(mov, 50))
+    f[2] = sat8(tdiv(stat, 50))
+    f[3] = sat8(sig)
+    f[4] = 64 if mov != 0 else 0
+    f[5] = 64 if stat != 0 else 0
+    if prev is not None:
+        f[6] = sat8(tdiv(dist - prev[1], 8))
+        f[7] = sat8(tdiv(target_delta(mov, prev[2]), 8))
+        f[8] = sat8(tdiv(target_delta(stat, prev[3]), 8))
+        f[9] = sat8(sig - prev[4])
+        f[13] = sat8(((t - prev[0]) & 0xFFFFFFFF) // 8)
+    if oldest is not None:
+        f[10] = sat8(tdiv(dist - oldest[1], 16))
+        f[11] = sat8(tdiv(target_delta(mov, oldest[2]), 16))
+        f[12] = sat8(tdiv(target_delta(stat, oldest[3]), 16))
+    return f
+
+
+def features_of_stream(samples):
+    """Caractéristiques d'une suite d'échantillons d'un module, avec l'historique du moteur de fusion."""
+    history = deque(maxlen=HISTORY_LEN)
+    out = []
+    for s in samples:
+        prev = history[-1] if history else None
+        oldest = history[0] if history else None
+        out.append(features(s, prev, oldest))
+        history.append(s)
+    return out
+
+
+def synthetic_sequence(rng, label, length):
+    """Une séquence d'un LD2410 voyant une personne dans une posture donnée."""
+    posture = CLASSES[label]
+    d = rng.uniform(600, 5500)
+    v = rng.choice([-1, 1]) * rng.uniform(400, 1400)  # mm/s, MOVING seulement
+    # (probabilité cible en mouvement, cible statique, signal min, max, bruit distance mm)
+    profile = {
+        "STANDING": (0.50, 0.95, 60, 90, 40),
+        "SITTING":  (0.25, 0.95, 40, 70, 30),
+        "LYING":    (0.08, 0.90, 20, 50, 25),
+        "MOVING":   (0.97, 0.40, 50, 90, 60),
+        "STILL":    (0.02, 0.97, 30, 65, 10),
+    }[posture]
+    p_mov, p_stat, sig_lo, sig_hi, noise = profile
+    sig0 = rng.uniform(sig_lo, sig_hi)
+    t = rng.randrange(0, 1 << 20)
+    samples = []
+    for _ in range(length):
+        dt = rng.randint(80, 125)
+        t += dt
+        if posture == "MOVING":
+            d += v * dt / 1000.0
+            if d < 500 or d > 6000:
+                v = -v
+                d = min(6000, max(500, d))
+        dist = int(max(0, d + rng.gauss(0, noise)))
+        mov = int(max(1, d + rng.gauss(0, noise * 2))) if rng.random() < p_mov else 0
+        stat_at = d - v * 0.5 if posture == "MOVING" else d
+        stat = int(max(1, stat_at + rng.gauss(0, noise * 1.5))) if rng.random() < p_stat else 0
+        sig = int(max(0, min(100, sig0 + rng.gauss(0, 6))))
+        samples.append((t, dist, mov, stat, sig))
+    return samples
+
+
+def synthetic_dataset(rng, sequences, length=30):
+    xs, ys = [], []
+    for i in range(sequences):
+        label = i % len(CLASSES)
+        for f in features_of_stream(synthetic_sequence(rng, label, length)):
+            xs.append(f)
+            ys.append(label)
+    return xs, ys
+
+
+def csv_dataset(path):
+    streams = {}
+    with open(path, newline="") as fh:
+        for row in csv.DictReader(fh):
+            label = CLASSES.index(row["posture"].strip().upper())
+            sample = (int(row["timestamp_ms"]), int(row["distance_mm"]), int(row["moving_mm"]),
+                      int(row["static_mm"]), int(row["signal"]))
+            streams.setdefault(int(row["module_id"]), []).append((sample, label))
+    xs, ys = [], []
+    for rows in streams.values():
+        xs += features_of_stream([s for s, _ in rows])
+        ys += [label for _, label in rows]
+    return xs, ys
+
+
+# --- Réseau flottant (entraînement) ---
+
+def init_layer(rng, n_in, n_out):
+    bound = math.sqrt(6.0 / n_in)
+    return [[rng.uniform(-bound, bound) for _ in range(n_in)] for _ in range(n_out)], [0.0] * n_out
+
+
+def forward(layers, x):
+    acts = [x]
+    for k, (w, b) in enumerate(layers):
+        y = [bi + sum(wi * xi for wi, xi in zip(row, x)) for row, bi in zip(w, b)]
+        if k < len(layers) - 1:
+            y = [v if v > 0 else 0.0 for v in y]
+        acts.append(y)
+        x = y
+    return acts
+
+
+def softmax(z):
+    m = max(z)
+    e = [math.exp(v - m) for v in z]
+    s = sum(e)
+    return [v / s for v in e]
+
+
+def train(rng, xs, ys, hidden, epochs, lr):
+    layers = [init_layer(rng, FEATURES, hidden), init_layer(rng, hidden, len(CLASSES))]
+    data = [([v * INPUT_SCALE for v in x], y) for x, y in zip(xs, ys)]
+    for epoch in range(epochs):
+        rng.shuffle(data)
+        rate = lr * (0.5 ** (epoch // 10))
+        for x, y in data:
+            acts = forward(layers, x)
+            grad = softmax(acts[-1])
+            grad[y] -= 1.0
+            for k in range(len(layers) - 1, -1, -1):
+                w, b = layers[k]
+                x_in = acts[k]
+                back = [0.0] * len(x_in)
+                for o, g in enumerate(grad):
+                    if g == 0.0:
+                        continue
+                    row = w[o]
+                    for i, xi in enumerate(x_in):
+                        back[i] += row[i] * g
+                        row[i] -= rate * g * xi
+                    b[o] -= rate * g
+                if k > 0:
+                    grad = [g if a > 0 else 0.0 for g, a in zip(back, x_in)]
+    return layers
+
+
+def float_predict(layers, x):
+    z = forward(layers, [v * INPUT_SCALE for v in x])[-1]
+    return z.index(max(z))
+
+
+# --- Quantification ---
+
+def multiplier(real):
+    """real = mult * 2^-(31 + shift), mult dans [2^30, 2^31)."""
+    e = math.floor(math.log2(real))
+    mult = int(round(real / 2.0 ** e * (1 << 30)))
+    if mult == 1 << 31:
+        mult, e = 1 << 30, e + 1
+    shift = -1 - e
+    if not -30 <= shift <= 31:
+        raise ValueError("échelle de requantification hors limites: %g" % real)
+    return mult, shift
+
+
+def requantize(acc, mult, shift, low, high):
+    total = 31 + shift
+    v = (acc * mult + (1 << (total - 1))) >> total
+    return max(low, min(high, v))
+
+
+def quantize(layers, xs):
+    """Poids int8 par canal de sortie, biais int32, échelles d'activation calibrées sur xs."""
+    # Plage des activations de chaque couche (calibration) : centile 99.9 des
+    # valeurs absolues plutôt que le maximum, qu'une poignée de valeurs
+    # extrêmes ferait payer en résolution à toutes les autres (saturées)
+    values = [[] for _ in layers]
+    for x in xs:
+        acts = forward(layers, [v * INPUT_SCALE for v in x])
+        for k in range(len(layers)):
+            values[k] += [abs(v) for v in acts[k + 1]]
+    peaks = []
+    for v in values:
+        v.sort()
+        peaks.append(max(1e-6, v[min(len(v) - 1, int(len(v) * CALIBRATION_PERCENTILE))]))
+    qlayers = []
+    s_x = INPUT_SCALE
+    for k, (w, b) in enumerate(layers):
+        last = k == len(layers) - 1
+        s_y = peaks[k] / (INT16_MAX if last else 127.0)  # Logits en int16
+        layer = {"w": [], "b": [], "mult": [], "shift": [], "relu": not last}
+        for row, bo in zip(w, b):
+            s_w = max(1e-12, max(abs(v) for v in row)) / 127.0
+            layer["w"].append([max(-127, min(127, int(round(v / s_w)))) for v in row])
+            layer["b"].append(int(round(bo / (s_x * s_w))))
+            mult, shift = multiplier(s_x * s_w / s_y)
+            layer["mult"].append(mult)
+            layer["shift"].append(shift)
+        qlayers.append(layer)
+        s_x = s_y
+    return qlayers, s_x
+
+
+def int_logits(qlayers, x):
+    """Miroir de posture_nn_infer()."""
+    for k, layer in enumerate(qlayers):
+        last = k == len(qlayers) - 1
+        low, high = (-INT16_MAX - 1, INT16_MAX) if last else (0 if layer["relu"] else -128, 127)
+        x = [requantize(bo + sum(wi * xi for wi, xi in zip(row, x)), mult, shift, low, high)
+             for row, bo, mult, shift in zip(layer["w"], layer["b"], layer["mult"], layer["shift"])]
+    return x
+
+
+def int8_predict(qlayers, x):
+    z = int_logits(qlayers, x)
+    return z.index(max(z))
+
+
+def blob(qlayers, out_scale):
+    payload = b""
+    for layer in qlayers:
+        n_out, n_in = len(layer["w"]), len(layer["w"][0])
+        payload += struct.pack("<BBBB", n_in, n_out, RELU if layer["relu"] else 0, 0)
+        payload += struct.pack("<%di" % n_out, *layer["b"])
+        payload += struct.pack("<%di" % n_out, *layer["mult"])
+        payload += struct.pack("<%db" % n_out, *layer["shift"]) + b"\0" * (-n_out % 4)
+        weights = bytes(v & 0xFF for row in layer["w"] for v in row)
+        payload += weights + b"\0" * (-len(weights) % 4)
+    header = struct.pack("<IHBBIIfI", MAGIC, VERSION, len(qlayers), FEATURES, len(payload),
+                         zlib.crc32(payload) & 0xFFFFFFFF, out_scale, 0)
+    return header + payload
+
+
+def c_source(data, description):
+    lines = ["// Generated by scripts/posture_nn_export.py, do not edit.",
+             "// %s" % description,
+             "// Replaced at run time by a blob flashed in the posture_nn partition.",
+             "",
+             "#include \"posture_nn.h\"",
+             "",
+             "const uint8_t posture_nn_default_model[] __attribute__((aligned(4))) = {"]
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join("0x%02x," % v for v in data[i:i + 16]))
+    lines += ["};",
+              "const size_t posture_nn_default_model_len = sizeof(posture_nn_default_model);",
+              ""]
+    return "\n".join(lines)
+
+
+def accuracy(predict, model, xs, ys):
+    return sum(predict(model, x) == y for x, y in zip(xs, ys)) / max(1, len(xs))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Entraîne, quantifie et exporte le classifieur de posture du maître.")
+    parser.add_argument("--data", help="CSV d'échantillons enregistrés (sinon données synthétiques)")
+    parser.add_argument("--sequences", type=int, default=300, help="séquences synthétiques de 30 échantillons")
+    parser.add_argument("--hidden", type=int, default=16, help="neurones de la couche cachée (32 au plus)")
+    parser.add_argument("--epochs", type=int, default=30)
+    parser.add_argument("--lr", type=float, default=0.05)
+    parser.add_argument("--seed", type=int, default=2410)
+    parser.add_argument("--bin", default="posture_nn.bin", help="blob pour la partition posture_nn")
+    parser.add_argument("--c", help="source C du modèle par défaut (master_firmware/main/posture_nn_model.c)")
+    args = parser.parse_args()
+    if not 1 <= args.hidden <= 32:
+        parser.error("--hidden doit être entre 1 et 32 (POSTURE_NN_MAX_WIDTH)")
+
+    rng = random.Random(args.seed)
+    if args.data:
+        xs, ys = csv_dataset(args.data)
+        source = "trained on %s" % args.data
+    else:
+        xs, ys = synthetic_dataset(rng, args.sequences)
+        source = "trained on synthetic LD2410-like sequences (seed %d), not on recordings" % args.seed
+    order = list(range(len(xs)))
+    rng.shuffle(order)
+    split = len(order) * 4 // 5
+    train_x, train_y = [xs[i] for i in order[:split]], [ys[i] for i in order[:split]]
+    test_x, test_y = [xs[i] for i in order[split:]], [ys[i] for i in order[split:]]
+
+    layers = train(rng, train_x, train_y, args.hidden, args.epochs, args.lr)
+    qlayers, out_scale = quantize(layers, train_x)
+    data = blob(qlayers, out_scale)
+    print("Échantillons: %d d'entraînement, %d de test" % (len(train_x), len(test_x)))
+    print("Précision sur le test: flottant %.1f %%, int8 %.1f %%" %
+          (100 * accuracy(float_predict, layers, test_x, test_y), 100 * accuracy(int8_predict, qlayers, test_x, test_y)))
+    print("Blob: %d octets (%d-%d-%d)" % (len(data), FEATURES, args.hidden, len(CLASSES)))
+
+    with open(args.bin, "wb") as fh:
+        fh.write(data)
+    print("Écrit: %s" % args.bin)
+    if args.c:
+        description = "%d-%d-%d MLP %s." % (FEATURES, args.hidden, len(CLASSES), source)
+        with open(args.c, "w") as fh:
+            fh.write(c_source(data, description))
+        print("Écrit: %s" % args.c)
@@ -6,12 +6,18 @@
 #include "esp_log.h"
 #include "driver/uart.h" // For UART driver
 #include "esp_system.h"  // For esp_log_timestamp
+#include "esp_random.h"  // For esp_random() (backoff jitter seed)
 #include "nvs_flash.h"   // For nvs_flash_init
+#include "nvs.h"         // For the persisted UDP sequence high-water mark
 #include "esp_wifi.h"    // For Wi-Fi
 #include "esp_event.h"   // For event loop
 #include "esp_netif.h"   // For TCP/IP stack
 #include "mqtt_client.h" // For MQTT
 #include "mdns.h"        // For mDNS
+#include "conn_supervisor.h" // Wi-Fi/IP/MQTT connection state machine (hlk_common)
+#include "radar_wire.h"      // Compact authenticated binary sample (hlk_common)
+#include "mqtt5_props.h"     // MQTT 5 user property keys of a radar sample (hlk_common)
+#include "lwip/sockets.h"    // For the direct UDP transport
 
 static const char *TAG_MAIN = "slave_main";
 static const char *TAG_MDNS = "mdns_slave";
@@ -27,25 +33,82 @@ static const char *mqtt_broker_ca_cert_pem_start = "-----BEGIN CERTIFICATE-----\
 // Wi-Fi Configuration
 #define EXAMPLE_ESP_WIFI_SSID      "your_wifi_ssid"
 #define EXAMPLE_ESP_WIFI_PASS      "your_wifi_password"
-#define EXAMPLE_ESP_MAXIMUM_RETRY  5 // Max retries for Wi-Fi connection
 
 // MQTT Configuration
 #define CONFIG_BROKER_URL          "mqtts://192.168.1.100:8883" // Changed to mqtts and port 8883
+#define CONFIG_FALLBACK_BROKER_URL "mqtts://192.168.1.101:8883" // Used when the preferred broker fails
+// When the master runs its embedded broker (MASTER_EMBEDDED_BROKER_ENABLED) use
+// "mqtt://esp32-master-controller.local" instead (plain TCP, no TLS; .local names
+// need CONFIG_LWIP_DNS_SUPPORT_MDNS_QUERIES).
 #define MQTT_TOPIC_RADAR_DATA      "home/room1/radar1"    // Example MQTT topic
 #define MQTT_CLIENT_ID             "esp32c3_slave_radar_1" // Unique client ID
 
+// Ordered broker list: index 0 is preferred (see conn_supervisor.h)
+static const char *const slave_broker_uris[] = {
+    CONFIG_BROKER_URL,
+    CONFIG_FALLBACK_BROKER_URL,
+};
+#define NUM_SLAVE_BROKERS (sizeof(slave_broker_uris) / sizeof(slave_broker_uris[0]))
+#define BROKER_PROBE_TIMEOUT_MS 1500
+#define CONN_EVENT_QUEUE_SIZE 8
+
+// Radar sample transport. MQTT goes through the broker (two TLS hops); UDP sends
+// the compact binary radar_wire packet straight to the master, found via mDNS.
+// MQTT stays connected in both modes for alerts and configuration.
+#define RADAR_TRANSPORT_MQTT 0
+#define RADAR_TRANSPORT_UDP  1
+#define RADAR_TRANSPORT      RADAR_TRANSPORT_MQTT
+
+// MQTT 5 for the MQTT transport (needs CONFIG_MQTT_PROTOCOL_5=y, set in
+// sdkconfig.defaults). The data topic goes out once per connection together with
+// topic alias SLAVE_MQTT_DATA_TOPIC_ALIAS, later samples carry only the alias;
+// module id and sequence travel as user properties and the JSON is compact.
+// Falls back to the MQTT 3.1.1 packets when CONFIG_MQTT_PROTOCOL_5 is off.
+#define SLAVE_MQTT_PROTOCOL_V5      1
+#define SLAVE_MQTT_DATA_TOPIC_ALIAS 1
+#if SLAVE_MQTT_PROTOCOL_V5 && defined(CONFIG_MQTT_PROTOCOL_5)
+#define SLAVE_USE_MQTT5 1
+#else
+#define SLAVE_USE_MQTT5 0
+#endif
+
+// Both the UDP packets and the MQTT 5 user properties carry a per-module sequence
+#define RADAR_SEQUENCE_ENABLED (RADAR_TRANSPORT == RADAR_TRANSPORT_UDP || SLAVE_USE_MQTT5)
+
+#define MASTER_MDNS_HOSTNAME          "esp32-master-controller" // Set by the master's mDNS task
+#define RADAR_UDP_PORT                RADAR_WIRE_DEFAULT_PORT
+#define RADAR_UDP_RESOLVE_INTERVAL_MS 30000 // Re-resolve the master periodically (DHCP changes)
+#define RADAR_SEQ_NVS_NAMESPACE       "radar_udp" // Kept for both transports: devices resume their sequence
+#define RADAR_SEQ_PERSIST_STRIDE      RADAR_WIRE_RESYNC_GAP // Sequences reserved per NVS write (radar_wire.h)
+
+// Shared SipHash key authenticating UDP samples. Must match the master's key.
+// Replace with a per-installation secret (like the Wi-Fi password above).
+static const uint8_t radar_udp_auth_key[RADAR_WIRE_KEY_LEN] = {
+    0x6b, 0x65, 0x79, 0x2d, 0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x2d, 0x6d, 0x65, 0x21, 0x21, 0x21
+};
+
 // Event Group for Wi-Fi connection status
 static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
 
 // MQTT Client Handle
 static esp_mqtt_client_handle_t mqtt_client = NULL;
 static bool mqtt_connected_flag = false;
+#if SLAVE_USE_MQTT5
+static volatile bool mqtt5_topic_alias_set = false;     // Broker knows SLAVE_MQTT_DATA_TOPIC_ALIAS
+static volatile bool mqtt5_topic_alias_refused = false; // Broker's Topic Alias Maximum is too low
+#endif
+static bool mqtt_client_running = false; // esp_mqtt_client_start() called and not stopped since
+
+// Connection supervisor (owned by ConnSupervisor_task) and its event queue
+static conn_supervisor_t conn_supervisor;
+static QueueHandle_t conn_event_queue;
 
 // Structure for radar data queue
 typedef struct {
-    float distance_m;
+    float distance_m;  // Detection distance (main target)
+    float moving_m;    // LD2410 moving target, 0 = none
+    float static_m;    // LD2410 static target, 0 = none
     char posture[16];
     int signal_strength;
     uint32_t timestamp;
@@ -69,11 +132,15 @@ static QueueHandle_t radar_output_queue;
 
 // Module ID for this slave device (already defined)
 #define RADAR_MODULE_ID 1
+// Metadata announced over mDNS; the master's module registry shows it on its status page
+#define RADAR_ROOM             "room1"
+#define SLAVE_FIRMWARE_VERSION "1.2.0" // 1.2.0: moving/static target distances
 
 // Function Declarations (Radar Task - from previous step)
 static void radar_uart_init();
-static bool radar_read_data(float* distance_m, char* posture, int* signal_strength);
-static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, uint32_t timestamp, float distance_m, const char* posture, int signal_strength);
+static bool radar_read_data(ProcessedRadarData* data);
+static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, const ProcessedRadarData* data);
+static void format_radar_json_compact(char* json_buffer, size_t buffer_size, const ProcessedRadarData* data);
 
 // Function Declarations (Wi-Fi and MQTT)
 static void nvs_init();
@@ -82,14 +149,29 @@ static void wifi_init_sta(void);
 static void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data);
 static esp_mqtt_client_handle_t mqtt_app_start(void);
 static void mqtt_publish_data(esp_mqtt_client_handle_t client, const char* topic, const char* data);
+#if SLAVE_USE_MQTT5
+static void mqtt5_publish_sample(esp_mqtt_client_handle_t client, const char* data, uint32_t sequence);
+#endif
+static void post_conn_event(conn_event_id_t id, uint8_t broker_index);
+static void conn_execute_actions(uint32_t actions);
 
 // Task function declarations
 void RadarTask_task(void *pvParameters);
 void WiFiTask_task(void *pvParameters);
+void ConnSupervisor_task(void *pvParameters);
 
 // mDNS Function Declaration
 static void start_mdns_service(void);
 
+#if RADAR_SEQUENCE_ENABLED
+static void radar_sequence_init(void);
+static uint32_t radar_sequence_next(void);
+#endif
+#if RADAR_TRANSPORT == RADAR_TRANSPORT_UDP
+// Direct UDP transport function declarations
+static void udp_publish_sample(const ProcessedRadarData *data);
+#endif
+
 
 void app_main(void)
 {
@@ -98,12 +180,26 @@ void app_main(void)
     // Initialize NVS - required for Wi-Fi
     nvs_init();
 
+    // The connection supervisor must exist before Wi-Fi starts posting events to it
+    conn_event_queue = xQueueCreate(CONN_EVENT_QUEUE_SIZE, sizeof(conn_event_t));
+    if (conn_event_queue == NULL) {
+        ESP_LOGE(TAG_MAIN, "Failed to create conn_event_queue. Halting.");
+        while(1);
+    }
+    conn_supervisor_config_t sup_cfg = CONN_SUPERVISOR_DEFAULT_CONFIG();
+    conn_supervisor_init(&conn_supervisor, &sup_cfg, slave_broker_uris, NUM_SLAVE_BROKERS, esp_random());
+    mqtt_client = mqtt_app_start(); // Created only; the supervisor connects it
+
     // Initialize Wi-Fi (STA mode)
     wifi_init_sta(); // Call this before mDNS starts, as mDNS relies on network interface
 
     // Start mDNS service
     start_mdns_service();
 
+#if RADAR_SEQUENCE_ENABLED
+    radar_sequence_init();
+#endif
+
     // Create the radar data queue
     radar_output_queue = xQueueCreate(RADAR_QUEUE_SIZE, sizeof(ProcessedRadarData));
     if (radar_output_queue == NULL) {
@@ -115,6 +211,7 @@ void app_main(void)
     // Create tasks
     xTaskCreate(&RadarTask_task, "RadarTask_task", 4096, NULL, 5, NULL);
     xTaskCreate(&WiFiTask_task, "WiFiTask_task", 4096*2, NULL, 5, NULL); // Increased stack for WiFi/MQTT
+    xTaskCreate(&ConnSupervisor_task, "ConnSupervisor_task", 4096, NULL, 6, NULL);
 
     ESP_LOGI(TAG_MAIN, "All tasks created.");
 }
@@ -129,45 +226,37 @@ static void nvs_init() {
     ESP_LOGI(TAG_WIFI, "NVS flash initialized successfully.");
 }
 
-static int s_retry_num = 0; // Wi-Fi connection retry counter
+// Forwards a connection event to ConnSupervisor_task without blocking the caller.
+static void post_conn_event(conn_event_id_t id, uint8_t broker_index) {
+    conn_event_t event = { .id = id, .broker_index = broker_index };
+    if (conn_event_queue == NULL || xQueueSend(conn_event_queue, &event, 0) != pdPASS) {
+        ESP_LOGE(TAG_WIFI, "Failed to post connection event %d (queue full or not created).", id);
+    }
+}
 
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                 int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        ESP_LOGI(TAG_WIFI, "Wi-Fi STA Started, attempting to connect...");
-        esp_wifi_connect();
+        ESP_LOGI(TAG_WIFI, "Wi-Fi STA Started.");
+        post_conn_event(CONN_EVT_START, 0);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
         ESP_LOGI(TAG_WIFI, "Wi-Fi STA Connected to AP.");
-        s_retry_num = 0; // Reset retry counter on successful connection
+        post_conn_event(CONN_EVT_WIFI_CONNECTED, 0);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG_WIFI, "Retry Wi-Fi connection (%d/%d)...", s_retry_num, EXAMPLE_ESP_MAXIMUM_RETRY);
-        } else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-            ESP_LOGE(TAG_WIFI, "Failed to connect to Wi-Fi after %d retries.", EXAMPLE_ESP_MAXIMUM_RETRY);
-        }
-        ESP_LOGE(TAG_WIFI,"Connect to the AP fail");
+        ESP_LOGW(TAG_WIFI, "Disconnected from AP.");
         mqtt_connected_flag = false; // MQTT is disconnected if Wi-Fi is
+        xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        post_conn_event(CONN_EVT_WIFI_DISCONNECTED, 0);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP) {
+        ESP_LOGW(TAG_WIFI, "Lost IP address.");
+        xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        post_conn_event(CONN_EVT_LOST_IP, 0);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG_WIFI, "Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-
-        // If MQTT client is initialized and not connected, try to reconnect now that Wi-Fi is up.
-        if (mqtt_client != NULL && !mqtt_connected_flag) {
-            ESP_LOGI(TAG_WIFI, "Wi-Fi (re)connected, attempting to reconnect MQTT client...");
-            esp_err_t err = esp_mqtt_client_reconnect(mqtt_client);
-            if (err == ESP_OK) {
-                ESP_LOGI(TAG_WIFI, "MQTT client reconnect initiated successfully.");
-                // MQTT_EVENT_CONNECTED will set mqtt_connected_flag = true
-            } else {
-                ESP_LOGE(TAG_WIFI, "Failed to initiate MQTT client reconnect: %s. Will retry in WiFiTask.", esp_err_to_name(err));
-            }
-        }
+        post_conn_event(CONN_EVT_GOT_IP, 0);
     }
 }
 
@@ -184,6 +273,7 @@ static void wifi_init_sta(void)
 
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
+    esp_event_handler_instance_t instance_lost_ip;
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                         ESP_EVENT_ANY_ID,
                                                         &wifi_event_handler,
@@ -194,6 +284,11 @@ static void wifi_init_sta(void)
                                                         &wifi_event_handler,
                                                         NULL,
                                                         &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                        IP_EVENT_STA_LOST_IP,
+                                                        &wifi_event_handler,
+                                                        NULL,
+                                                        &instance_lost_ip));
 
     wifi_config_t wifi_config = {
         .sta = {
@@ -228,8 +323,13 @@ static void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_
 
     switch ((esp_mqtt_event_id_t)event_id) {
     case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG_WIFI, "MQTT_EVENT_CONNECTED");
+        ESP_LOGI(TAG_WIFI, "MQTT_EVENT_CONNECTED to broker %s", conn_supervisor_active_uri(&conn_supervisor));
         mqtt_connected_flag = true;
+#if SLAVE_USE_MQTT5
+        mqtt5_topic_alias_set = false;     // Aliases do not survive the network connection
+        mqtt5_topic_alias_refused = false;
+#endif
+        post_conn_event(CONN_EVT_MQTT_CONNECTED, 0);
         // Example: Subscribe to a topic upon connection
         // msg_id = esp_mqtt_client_subscribe(client, "/topic/qos0", 0);
         // ESP_LOGI(TAG_WIFI, "sent subscribe successful, msg_id=%d", msg_id);
@@ -237,6 +337,7 @@ static void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG_WIFI, "MQTT_EVENT_DISCONNECTED");
         mqtt_connected_flag = false;
+        post_conn_event(CONN_EVT_MQTT_DISCONNECTED, 0);
         break;
     case MQTT_EVENT_SUBSCRIBED:
         ESP_LOGI(TAG_WIFI, "MQTT_EVENT_SUBSCRIBED, msg_id=%d", event->msg_id);
@@ -254,6 +355,7 @@ static void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_
         break;
     case MQTT_EVENT_ERROR:
         ESP_LOGE(TAG_WIFI, "MQTT_EVENT_ERROR");
+        post_conn_event(CONN_EVT_MQTT_ERROR, 0);
         if (event->error_handle) { // Check if error_handle is not NULL
             ESP_LOGE(TAG_WIFI, "Last error code reported from esp-tls: 0x%x", event->error_handle->esp_tls_last_esp_err);
             ESP_LOGE(TAG_WIFI, "Last tls stack error number: 0x%x", event->error_handle->esp_tls_stack_err);
@@ -276,39 +378,100 @@ static void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_
     }
 }
 
+// Creates the MQTT client without starting it; ConnSupervisor_task connects it
+// (esp-mqtt auto-reconnect is disabled, retries follow the supervisor's backoff).
 static esp_mqtt_client_handle_t mqtt_app_start(void) {
     esp_mqtt_client_config_t mqtt_cfg = {
-        .broker.address.uri = CONFIG_BROKER_URL,
+        .broker.address.uri = slave_broker_uris[0],
         .broker.verification.certificate = mqtt_broker_ca_cert_pem_start,
         .credentials.client_id = MQTT_CLIENT_ID,
+        .network.disable_auto_reconnect = true,
+#if SLAVE_USE_MQTT5
+        .session.protocol_ver = MQTT_PROTOCOL_V_5,
+#endif
         // .session.last_will.topic = "/topic/will", // Example last will
         // .session.last_will.msg = "I am gone",
         // .session.last_will.qos = 1,
         // .session.last_will.retain = 0,
     };
 
-    ESP_LOGI(TAG_WIFI, "Starting MQTT client, broker URI: %s", mqtt_cfg.broker.address.uri);
+    ESP_LOGI(TAG_WIFI, "Initializing MQTT client, preferred broker URI: %s", mqtt_cfg.broker.address.uri);
     esp_mqtt_client_handle_t client = esp_mqtt_client_init(&mqtt_cfg);
     if (client == NULL) {
         ESP_LOGE(TAG_WIFI, "Failed to initialize MQTT client");
         return NULL;
     }
     ESP_ERROR_CHECK(esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL));
-    ESP_ERROR_CHECK(esp_mqtt_client_start(client));
-    
-    // --- SIMULATION FOR SANDBOX ---
-    // In a real environment, MQTT_EVENT_CONNECTED would set mqtt_connected_flag.
-    // Here, we simulate it because actual connection might fail.
-    #ifdef CONFIG_SIMULATE_MQTT_CONNECTION
-    ESP_LOGW(TAG_WIFI, "SIMULATION: Forcing MQTT connected flag to true after 2 seconds (if not already set by event).");
-    vTaskDelay(pdMS_TO_TICKS(2000)); 
-    if (!mqtt_connected_flag) { // Check if the real event already set it
-         mqtt_connected_flag = true; // Simulate connection
-         ESP_LOGI(TAG_WIFI, "SIMULATION: MQTT client 'connected'.");
+    return client;
+}
+
+// Executes the CONN_ACT_* mask returned by the supervisor, in bit order.
+static void conn_execute_actions(uint32_t actions) {
+    if (actions & CONN_ACT_WIFI_CONNECT) {
+        esp_err_t err = esp_wifi_connect();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG_WIFI, "esp_wifi_connect failed: %s", esp_err_to_name(err));
+        }
     }
-    #endif
+    if ((actions & CONN_ACT_MQTT_STOP) && mqtt_client != NULL && mqtt_client_running) {
+        esp_mqtt_client_stop(mqtt_client);
+        mqtt_client_running = false;
+        mqtt_connected_flag = false;
+    }
+    if ((actions & CONN_ACT_MQTT_START) && mqtt_client != NULL) {
+        const char *uri = conn_supervisor_active_uri(&conn_supervisor);
+        ESP_LOGI(TAG_WIFI, "Connecting MQTT client to broker %s", uri);
+        if (mqtt_client_running) {
+            esp_mqtt_client_stop(mqtt_client);
+            mqtt_client_running = false;
+        }
+        esp_err_t err = esp_mqtt_client_set_uri(mqtt_client, uri);
+        if (err == ESP_OK) {
+            err = esp_mqtt_client_start(mqtt_client);
+        }
+        if (err == ESP_OK) {
+            mqtt_client_running = true;
+        } else {
+            ESP_LOGE(TAG_WIFI, "Failed to start MQTT client: %s", esp_err_to_name(err));
+        }
+    }
+    if (actions & CONN_ACT_PROBE_BROKER) {
+        uint8_t probe_index = conn_supervisor.probe_broker;
+        bool reachable = conn_probe_broker(conn_supervisor_probe_uri(&conn_supervisor), BROKER_PROBE_TIMEOUT_MS);
+        post_conn_event(reachable ? CONN_EVT_PROBE_OK : CONN_EVT_PROBE_FAIL, probe_index);
+    }
+    if (actions & CONN_ACT_NOTIFY_OFFLINE) {
+        ESP_LOGW(TAG_WIFI, "MQTT link down, outage started.");
+    }
+    if (actions & CONN_ACT_NOTIFY_ONLINE) {
+        ESP_LOGI(TAG_WIFI, "MQTT link up via %s (last outage %u ms, %u outages, %u failovers).",
+                 conn_supervisor_active_uri(&conn_supervisor), conn_supervisor.stats.last_outage_ms,
+                 conn_supervisor.stats.outage_count, conn_supervisor.stats.failovers);
+    }
+}
 
-    return client;
+// Owns the connection supervisor: sleeps until a Wi-Fi/IP/MQTT event arrives or
+// the supervisor's next deadline (backoff, connect timeout, probe) expires.
+void ConnSupervisor_task(void *pvParameters) {
+    ESP_LOGI(TAG_WIFI, "ConnSupervisor_task started");
+    conn_event_t event;
+    for(;;) {
+        uint32_t wait_ms = conn_supervisor_ms_until_deadline(&conn_supervisor, esp_log_timestamp());
+        TickType_t wait_ticks = (wait_ms == CONN_NO_DEADLINE) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms) + 1;
+        if (xQueueReceive(conn_event_queue, &event, wait_ticks) != pdPASS) {
+            event.id = CONN_EVT_TIMEOUT;
+            event.broker_index = 0;
+        }
+
+        conn_state_t previous_state = conn_supervisor.state;
+        uint32_t actions = conn_supervisor_handle(&conn_supervisor, &event, esp_log_timestamp());
+        if (conn_supervisor.state != previous_state) {
+            ESP_LOGI(TAG_WIFI, "Connection state %s -> %s (event %d, actions 0x%02x)",
+                     conn_state_name(previous_state), conn_state_name(conn_supervisor.state),
+                     event.id, (unsigned int)actions);
+        }
+        conn_execute_actions(actions);
+    }
 }
 
 static void mqtt_publish_data(esp_mqtt_client_handle_t client, const char* topic, const char* data) {
@@ -333,6 +496,59 @@ static void mqtt_publish_data(esp_mqtt_client_handle_t client, const char* topic
     }
 }
 
+#if SLAVE_USE_MQTT5
+// Publishes one sample on MQTT_TOPIC_RADAR_DATA with MQTT 5 properties. The
+// first publish of a connection sends the topic and the alias, the next ones an
+// empty topic plus the alias. esp-mqtt consumes the publish properties on the
+// next esp_mqtt_client_publish() and rejects an alias above the broker's Topic
+// Alias Maximum; the sample is then resent with the full topic.
+static void mqtt5_publish_sample(esp_mqtt_client_handle_t client, const char* data, uint32_t sequence) {
+    if (client == NULL || !mqtt_connected_flag) {
+        ESP_LOGW(TAG_WIFI, "MQTT client not connected, sample %u dropped.", sequence);
+        return;
+    }
+
+    char module_id_str[4];
+    char sequence_str[11];
+    snprintf(module_id_str, sizeof(module_id_str), "%d", RADAR_MODULE_ID);
+    snprintf(sequence_str, sizeof(sequence_str), "%u", sequence);
+    esp_mqtt5_user_property_item_t user_properties[] = {
+        { RADAR_PROP_MODULE_ID, module_id_str },
+        { RADAR_PROP_SEQUENCE, sequence_str },
+    };
+    esp_mqtt5_publish_property_config_t publish_property = { 0 };
+    esp_err_t err = esp_mqtt5_client_set_user_property(&publish_property.user_property, user_properties,
+                                                       sizeof(user_properties) / sizeof(user_properties[0]));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_WIFI, "Failed to build MQTT 5 user properties: %s", esp_err_to_name(err));
+        return;
+    }
+
+    bool use_alias = !mqtt5_topic_alias_refused;
+    publish_property.topic_alias = use_alias ? SLAVE_MQTT_DATA_TOPIC_ALIAS : 0;
+    esp_mqtt5_client_set_publish_property(client, &publish_property);
+    const char *topic = (use_alias && mqtt5_topic_alias_set) ? "" : MQTT_TOPIC_RADAR_DATA;
+    int msg_id = esp_mqtt_client_publish(client, topic, data, 0, 1, 0); // QoS 1, Retain 0
+    if (msg_id == -1 && use_alias) {
+        ESP_LOGW(TAG_WIFI, "Topic alias %d refused by the broker, sending full topics on this connection.",
+                 SLAVE_MQTT_DATA_TOPIC_ALIAS);
+        mqtt5_topic_alias_refused = true;
+        use_alias = false;
+        publish_property.topic_alias = 0;
+        esp_mqtt5_client_set_publish_property(client, &publish_property);
+        msg_id = esp_mqtt_client_publish(client, MQTT_TOPIC_RADAR_DATA, data, 0, 1, 0);
+    }
+    esp_mqtt5_client_delete_user_property(publish_property.user_property);
+
+    if (msg_id != -1) {
+        mqtt5_topic_alias_set = use_alias;
+        ESP_LOGI(TAG_WIFI, "Sent MQTT 5 publish, msg_id=%d, seq=%u, alias=%s", msg_id, sequence, use_alias ? "yes" : "no");
+    } else {
+        ESP_LOGE(TAG_WIFI, "Failed to publish sample %u on %s", sequence, MQTT_TOPIC_RADAR_DATA);
+    }
+}
+#endif
+
 
 // Radar Task
 static void radar_uart_init() {
@@ -354,49 +570,65 @@ static void radar_uart_init() {
 // Static counter for radar_read_data simulation
 static int radar_read_attempt_counter = 0;
 
-static bool radar_read_data(float* distance_m, char* posture, int* signal_strength) {
+// Fills distance, targets, posture and signal of `data` (not the timestamp).
+// The LD2410 reports a moving and a static target separately; the master
+// tracks several people from them.
+static bool radar_read_data(ProcessedRadarData* data) {
     radar_read_attempt_counter++;
 
     // Simulate an error every 5th attempt
     if (radar_read_attempt_counter % 5 == 0) {
         ESP_LOGW(TAG_RADAR, "Simulated radar read error (attempt %d).", radar_read_attempt_counter);
         // Reset posture to indicate error or unknown state
-        strcpy(posture, "ERROR");
-        *distance_m = 0.0f;
-        *signal_strength = 0;
+        strcpy(data->posture, "ERROR");
+        data->distance_m = data->moving_m = data->static_m = 0.0f;
+        data->signal_strength = 0;
         return false; 
     }
 
     // Simulate successful read
     // For variety, let's make posture change a bit too
     if (radar_read_attempt_counter % 3 == 0) {
-        strcpy(posture, "SITTING");
-        *distance_m = 1.80f;
-        *signal_strength = 65;
+        strcpy(data->posture, "SITTING");
+        data->distance_m = data->static_m = 1.80f;
+        data->moving_m = 0.0f;
+        data->signal_strength = 65;
     } else if (radar_read_attempt_counter % 2 == 0) {
-        strcpy(posture, "MOVING");
-        *distance_m = 3.10f;
-        *signal_strength = 70;
+        strcpy(data->posture, "MOVING");
+        data->distance_m = data->moving_m = 3.10f;
+        data->static_m = 1.80f; // Someone else sitting still
+        data->signal_strength = 70;
     } else {
-        strcpy(posture, "LYING"); // Default successful read
-        *distance_m = 2.25f;
-        *signal_strength = 72;
+        strcpy(data->posture, "LYING"); // Default successful read
+        data->distance_m = data->static_m = 2.25f;
+        data->moving_m = 0.0f;
+        data->signal_strength = 72;
     }
-    ESP_LOGD(TAG_RADAR, "Simulated successful radar read (attempt %d): dist=%.2f, post=%s, sig=%d", 
-             radar_read_attempt_counter, *distance_m, posture, *signal_strength);
+    ESP_LOGD(TAG_RADAR, "Simulated successful radar read (attempt %d): dist=%.2f (moving %.2f, static %.2f), post=%s, sig=%d", 
+             radar_read_attempt_counter, data->distance_m, data->moving_m, data->static_m, data->posture, data->signal_strength);
     return true;
 }
 
-static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, uint32_t timestamp, float distance_m, const char* posture, int signal_strength) {
+static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, const ProcessedRadarData* data) {
     snprintf(json_buffer, buffer_size,
              "{\n"
              "  \"id_module\": %d,\n"
              "  \"timestamp\": %u,\n"
              "  \"distance_m\": %.2f,\n"
+             "  \"moving_m\": %.2f,\n"
+             "  \"static_m\": %.2f,\n"
              "  \"posture\": \"%s\",\n"
              "  \"signal\": %d\n"
              "}",
-             module_id, timestamp, distance_m, posture, signal_strength);
+             module_id, data->timestamp, data->distance_m, data->moving_m, data->static_m, data->posture,
+             data->signal_strength);
+}
+
+// MQTT 5 payload: no whitespace and no "id_module" (it travels as a user property).
+static void format_radar_json_compact(char* json_buffer, size_t buffer_size, const ProcessedRadarData* data) {
+    snprintf(json_buffer, buffer_size,
+             "{\"timestamp\":%u,\"distance_m\":%.2f,\"moving_m\":%.2f,\"static_m\":%.2f,\"posture\":\"%s\",\"signal\":%d}",
+             data->timestamp, data->distance_m, data->moving_m, data->static_m, data->posture, data->signal_strength);
 }
 
 void RadarTask_task(void *pvParameters) {
@@ -412,7 +644,7 @@ void RadarTask_task(void *pvParameters) {
         ESP_LOGD(TAG_RADAR, "Simulating Radar Module ON");
         vTaskDelay(pdMS_TO_TICKS(RADAR_PRE_READ_DELAY_MS));
 
-        if (radar_read_data(&data_to_send.distance_m, data_to_send.posture, &data_to_send.signal_strength)) {
+        if (radar_read_data(&data_to_send)) {
             data_to_send.timestamp = esp_log_timestamp();
             ESP_LOGI(TAG_RADAR, "Read data: dist=%.2f, posture=%s, sig=%d, ts=%u",
                      data_to_send.distance_m, data_to_send.posture, data_to_send.signal_strength, data_to_send.timestamp);
@@ -435,92 +667,167 @@ void RadarTask_task(void *pvParameters) {
 }
 
 // WiFiTask_task Implementation
+// Publishes radar samples as soon as they are produced. Connection management
+// (Wi-Fi retries, MQTT reconnects, broker failover) lives in ConnSupervisor_task;
+// samples produced while the link is down are dropped by mqtt_publish_data().
 void WiFiTask_task(void *pvParameters) {
     ESP_LOGI(TAG_WIFI, "WiFiTask_task started");
 
-    // nvs_init() is called from app_main now.
-    wifi_init_sta();
-
-    ESP_LOGI(TAG_WIFI, "Waiting for Wi-Fi connection...");
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-            pdFALSE, // Don't clear bits on exit
-            pdFALSE, // Don't wait for all bits
-            portMAX_DELAY); // Wait indefinitely (or use a timeout)
-
-    if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG_WIFI, "Wi-Fi Connected. Initializing MQTT client...");
-        mqtt_client = mqtt_app_start();
-        if (mqtt_client == NULL) {
-            ESP_LOGE(TAG_WIFI, "Failed to start MQTT client. Task will not publish.");
-            // Optionally, could try to restart MQTT or handle error differently
+    if (mqtt_client == NULL) {
+        ESP_LOGE(TAG_WIFI, "MQTT client not available (initialization failed). WiFiTask will suspend itself.");
+        vTaskSuspend(NULL); // Suspend itself as it cannot do its job
+    }
+
+    char json_payload_buffer[256]; // Buffer for JSON data
+    ProcessedRadarData received_radar_data;
+    for(;;) {
+        if (xQueueReceive(radar_output_queue, &received_radar_data, portMAX_DELAY) != pdPASS) {
+            continue;
         }
-    } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGE(TAG_WIFI, "Wi-Fi connection failed. Task will not initialize MQTT or publish.");
-        // Task can loop here, or delete itself, or signal error.
-        // For now, it will simply not proceed to MQTT part.
-    } else {
-        ESP_LOGE(TAG_WIFI, "Unexpected event from Wi-Fi event group.");
+        ESP_LOGI(TAG_WIFI, "Received radar data from queue: dist=%.2f, post=%s, sig=%d, ts=%u",
+                 received_radar_data.distance_m, received_radar_data.posture,
+                 received_radar_data.signal_strength, received_radar_data.timestamp);
+
+#if RADAR_TRANSPORT == RADAR_TRANSPORT_UDP
+        udp_publish_sample(&received_radar_data);
+#elif SLAVE_USE_MQTT5
+        format_radar_json_compact(json_payload_buffer, sizeof(json_payload_buffer), &received_radar_data);
+        ESP_LOGD(TAG_WIFI, "WiFiTask: Publishing compact data: %s", json_payload_buffer);
+        mqtt5_publish_sample(mqtt_client, json_payload_buffer, radar_sequence_next());
+#else
+        format_radar_json(json_payload_buffer, sizeof(json_payload_buffer), RADAR_MODULE_ID, &received_radar_data);
+
+        ESP_LOGI(TAG_WIFI, "WiFiTask: Publishing formatted data: %s", json_payload_buffer);
+        mqtt_publish_data(mqtt_client, MQTT_TOPIC_RADAR_DATA, json_payload_buffer);
+#endif
     }
+}
 
-    // Only proceed to publish loop if MQTT client was initialized (which implies Wi-Fi connected)
-    if (mqtt_client) {
-        char json_payload_buffer[256]; // Buffer for JSON data
-        ProcessedRadarData received_radar_data;
-        for(;;) {
-            if (radar_output_queue != NULL) {
-                if (xQueueReceive(radar_output_queue, &received_radar_data, pdMS_TO_TICKS(1000)) == pdPASS) { // Wait up to 1 sec
-                    ESP_LOGI(TAG_WIFI, "Received radar data from queue: dist=%.2f, post=%s, sig=%d, ts=%u",
-                             received_radar_data.distance_m, received_radar_data.posture,
-                             received_radar_data.signal_strength, received_radar_data.timestamp);
-
-                    format_radar_json(json_payload_buffer, sizeof(json_payload_buffer),
-                                      RADAR_MODULE_ID, received_radar_data.timestamp,
-                                      received_radar_data.distance_m, received_radar_data.posture,
-                                      received_radar_data.signal_strength);
-
-                    ESP_LOGI(TAG_WIFI, "WiFiTask: Publishing formatted data: %s", json_payload_buffer);
-                    mqtt_publish_data(mqtt_client, MQTT_TOPIC_RADAR_DATA, json_payload_buffer);
-                } else {
-                    ESP_LOGD(TAG_WIFI, "No data received from radar_output_queue within timeout. Will try again.");
-                    // Optionally, publish a "heartbeat" or "no data" message if needed
-                }
-            } else {
-                ESP_LOGE(TAG_WIFI, "radar_output_queue is NULL. Cannot receive data. Delaying...");
-                vTaskDelay(pdMS_TO_TICKS(5000)); // Delay to avoid spamming logs
-            }
-            
-            // Check MQTT connection status and attempt reconnect if necessary
-            if (!mqtt_connected_flag) {
-                ESP_LOGW(TAG_WIFI, "MQTT not connected. Wi-Fi status: %s",
-                    (xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT) ? "Connected" : "Disconnected");
-                if ((xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT) && mqtt_client != NULL) {
-                    ESP_LOGI(TAG_WIFI, "WiFiTask: Attempting to reconnect MQTT client...");
-                    esp_err_t err = esp_mqtt_client_reconnect(mqtt_client);
-                    // Alternatively, esp_mqtt_client_start(mqtt_client) can be used if reconnect fails.
-                    // start is more robust if the client was stopped for some reason.
-                    if (err != ESP_OK) {
-                         ESP_LOGE(TAG_WIFI, "WiFiTask: Failed to reconnect MQTT client: %s. Retrying start...", esp_err_to_name(err));
-                         err = esp_mqtt_client_start(mqtt_client);
-                         if (err != ESP_OK) {
-                            ESP_LOGE(TAG_WIFI, "WiFiTask: Failed to start MQTT client after reconnect failure: %s.", esp_err_to_name(err));
-                         } else {
-                            ESP_LOGI(TAG_WIFI, "WiFiTask: MQTT client start initiated after reconnect failure.");
-                         }
-                    } else {
-                        ESP_LOGI(TAG_WIFI, "WiFiTask: MQTT client reconnect initiated successfully.");
-                    }
-                }
-            }
-            // Delay before next attempt to receive from queue or check connections.
-            // This also serves as the retry interval for MQTT connection attempts if disconnected.
-            vTaskDelay(pdMS_TO_TICKS(5000)); // Check/Publish/Retry every 5 seconds
+#if RADAR_SEQUENCE_ENABLED
+// The master rejects sequences it has already seen (anti-replay window for UDP,
+// duplicate filter for MQTT 5), so the sequence must keep increasing across reboots. Instead of writing NVS on every
+// packet, blocks of RADAR_SEQ_PERSIST_STRIDE sequences are reserved: NVS holds
+// the end of the current block and a reboot resumes from there. A block is
+// only counted as reserved once written: after a failed write the next
+// sample retries it.
+static uint32_t radar_sequence = 0;
+static uint32_t radar_sequence_reserved = 0;
+static bool radar_sequence_persist_failed = false;
+
+static void radar_sequence_reserve(void) {
+    nvs_handle_t nvs;
+    uint32_t limit = radar_sequence + RADAR_SEQ_PERSIST_STRIDE;
+    esp_err_t err = nvs_open(RADAR_SEQ_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(nvs, "seq_limit", limit);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
         }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        if (!radar_sequence_persist_failed) { // Retried on every sample: log the first failure only
+            ESP_LOGE(TAG_WIFI, "Failed to persist radar sequence block: %s", esp_err_to_name(err));
+        }
+        radar_sequence_persist_failed = true;
+        return;
+    }
+    if (radar_sequence_persist_failed) {
+        ESP_LOGI(TAG_WIFI, "Radar sequence block persisted again (limit %u)", limit);
+        radar_sequence_persist_failed = false;
+    }
+    radar_sequence_reserved = limit;
+}
+
+static void radar_sequence_init(void) {
+    nvs_handle_t nvs;
+    uint32_t stored_limit = 0;
+    if (nvs_open(RADAR_SEQ_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        nvs_get_u32(nvs, "seq_limit", &stored_limit);
+        nvs_close(nvs);
+    }
+    radar_sequence = stored_limit;
+    radar_sequence_reserve();
+    ESP_LOGI(TAG_WIFI, "Radar sample sequence resumes at %u", radar_sequence);
+}
+
+static uint32_t radar_sequence_next(void) {
+    uint32_t sequence = radar_sequence++;
+    if (radar_sequence >= radar_sequence_reserved) {
+        radar_sequence_reserve();
+    }
+    return sequence;
+}
+#endif
+
+#if RADAR_TRANSPORT == RADAR_TRANSPORT_UDP
+
+static int udp_sock = -1;
+static struct sockaddr_in master_addr;
+static bool master_addr_valid = false;
+static uint32_t master_addr_resolved_ms = 0;
+
+static bool udp_resolve_master(void) {
+    esp_ip4_addr_t addr = { 0 };
+    esp_err_t err = mdns_query_a(MASTER_MDNS_HOSTNAME, 2000, &addr);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG_WIFI, "mDNS lookup of %s failed: %s", MASTER_MDNS_HOSTNAME, esp_err_to_name(err));
+        return false;
+    }
+    memset(&master_addr, 0, sizeof(master_addr));
+    master_addr.sin_family = AF_INET;
+    master_addr.sin_port = htons(RADAR_UDP_PORT);
+    master_addr.sin_addr.s_addr = addr.addr;
+    master_addr_valid = true;
+    master_addr_resolved_ms = esp_log_timestamp();
+    ESP_LOGI(TAG_WIFI, "Master %s resolved to " IPSTR, MASTER_MDNS_HOSTNAME, IP2STR(&addr));
+    return true;
+}
+
+static uint16_t wire_distance_mm(float metres) {
+    float mm = metres * 1000.0f;
+    return mm <= 0.0f ? 0 : (mm >= 65535.0f ? 65535 : (uint16_t)(mm + 0.5f));
+}
+
+static void udp_publish_sample(const ProcessedRadarData *data) {
+    if (!(xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT)) {
+        ESP_LOGW(TAG_WIFI, "UDP transport: no IP, sample dropped.");
+        return;
+    }
+    if (!master_addr_valid || esp_log_timestamp() - master_addr_resolved_ms > RADAR_UDP_RESOLVE_INTERVAL_MS) {
+        if (!udp_resolve_master() && !master_addr_valid) {
+            return;
+        }
+    }
+    if (udp_sock < 0) {
+        udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+        if (udp_sock < 0) {
+            ESP_LOGE(TAG_WIFI, "Unable to create UDP socket: errno %d", errno);
+            return;
+        }
+    }
+
+    radar_wire_sample_t sample = {
+        .module_id = RADAR_MODULE_ID,
+        .sequence = radar_sequence_next(),
+        .timestamp_ms = data->timestamp,
+        .distance_mm = wire_distance_mm(data->distance_m),
+        .moving_mm = wire_distance_mm(data->moving_m),
+        .static_mm = wire_distance_mm(data->static_m),
+        .posture = (uint8_t)radar_posture_from_string(data->posture),
+        .signal = data->signal_strength < 0 ? 0 : (data->signal_strength > 100 ? 100 : (uint8_t)data->signal_strength),
+    };
+
+    uint8_t packet[RADAR_WIRE_PACKET_LEN];
+    size_t len = radar_wire_encode(&sample, radar_udp_auth_key, packet);
+    if (sendto(udp_sock, packet, len, 0, (struct sockaddr *)&master_addr, sizeof(master_addr)) < 0) {
+        ESP_LOGE(TAG_WIFI, "UDP send failed: errno %d. Master address will be re-resolved.", errno);
+        master_addr_valid = false;
     } else {
-        ESP_LOGE(TAG_WIFI, "MQTT client not available (initialization failed). WiFiTask will suspend itself.");
-        vTaskSuspend(NULL); // Suspend itself as it cannot do its job
+        ESP_LOGD(TAG_WIFI, "UDP sample seq=%u sent (%u bytes).", sample.sequence, (unsigned int)len);
     }
 }
+#endif
 
 static void start_mdns_service(void) {
     esp_err_t err;
@@ -563,7 +870,8 @@ static void start_mdns_service(void) {
     // Define TXT records
     mdns_txt_item_t service_txt_records[] = {
         {"module_id", module_id_str},
-        {"version", "1.0"} // Example other record
+        {"room", RADAR_ROOM},
+        {"version", SLAVE_FIRMWARE_VERSION}
     };
 
     // Add service
@@ -15,10 +15,20 @@
 // by a proper build system that can substitute or mock these functions.
 // --- END LIMITATION NOTE ---
 
+// Copy of the radar queue item of main.c
+typedef struct {
+    float distance_m;  // Detection distance (main target)
+    float moving_m;    // LD2410 moving target, 0 = none
+    float static_m;    // LD2410 static target, 0 = none
+    char posture[16];
+    int signal_strength;
+    uint32_t timestamp;
+} ProcessedRadarData;
+
 // Re-declaration of static functions from main.c for testing purposes (see LIMITATION NOTE)
 // Ideally, these would be in a "radar_processing.h" or similar
-static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, uint32_t timestamp, float distance_m, const char* posture, int signal_strength);
-static bool radar_read_data(float* distance_m, char* posture, int* signal_strength);
+static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, const ProcessedRadarData* data);
+static bool radar_read_data(ProcessedRadarData* data);
 
 // Dummy implementations or stubs if the original static functions cannot be linked/accessed
 // For this theoretical exercise, we assume the test runner would somehow link or use these.
@@ -29,25 +39,29 @@ static bool radar_read_data(float* distance_m, char* posture, int* signal_streng
 // This is a common unit testing technique if you can't link the original object file.
 
 // Simplified stub for format_radar_json (MUST MATCH SIGNATURE)
-static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, uint32_t timestamp, float distance_m, const char* posture, int signal_strength) {
+static void format_radar_json(char* json_buffer, size_t buffer_size, int module_id, const ProcessedRadarData* data) {
     snprintf(json_buffer, buffer_size,
              "{\n"
              "  \"id_module\": %d,\n"
              "  \"timestamp\": %u,\n"
              "  \"distance_m\": %.2f,\n"
+             "  \"moving_m\": %.2f,\n"
+             "  \"static_m\": %.2f,\n"
              "  \"posture\": \"%s\",\n"
              "  \"signal\": %d\n"
              "}",
-             module_id, timestamp, distance_m, posture, signal_strength);
+             module_id, data->timestamp, data->distance_m, data->moving_m, data->static_m, data->posture,
+             data->signal_strength);
 }
 
 // Simplified stub for radar_read_data (MUST MATCH SIGNATURE)
-static bool radar_read_data(float* distance_m, char* posture_buffer, int* signal_strength) {
+static bool radar_read_data(ProcessedRadarData* data) {
     // Simulate successful data read with predefined values
-    *distance_m = 2.25f;
-    strncpy(posture_buffer, "LYING", 15); // Ensure buffer is not overflowed
-    posture_buffer[15] = '\\0'; // Null-terminate
-    *signal_strength = 72;
+    data->distance_m = data->static_m = 2.25f;
+    data->moving_m = 0.0f;
+    strncpy(data->posture, "LYING", 15); // Ensure buffer is not overflowed
+    data->posture[15] = '\\0'; // Null-terminate
+    data->signal_strength = 72;
     return true;
 }
 
@@ -57,18 +71,19 @@ static const char *TAG_TEST_RADAR = "TEST_RADAR_UTILS";
 void test_format_json_valid_inputs() {
     ESP_LOGI(TAG_TEST_RADAR, "Running test: test_format_json_valid_inputs");
 
-    // Input data
+    // Input data: a moving person at 3.14 m, someone still at 1.20 m
     int module_id = 1;
-    uint32_t timestamp = 1678886400; // Example UNIX timestamp (or uptime)
-    float distance_m = 3.14f;
-    const char* posture = "STANDING";
-    int signal_strength = 85;
+    ProcessedRadarData data = {
+        .distance_m = 3.14f, .moving_m = 3.14f, .static_m = 1.20f,
+        .posture = "STANDING", .signal_strength = 85,
+        .timestamp = 1678886400, // Example UNIX timestamp (or uptime)
+    };
 
     char json_buffer[256];
     char expected_json_buffer[256];
 
     // Call the function (using the re-declared/stubbed version)
-    format_radar_json(json_buffer, sizeof(json_buffer), module_id, timestamp, distance_m, posture, signal_strength);
+    format_radar_json(json_buffer, sizeof(json_buffer), module_id, &data);
 
     // Construct the expected JSON
     snprintf(expected_json_buffer, sizeof(expected_json_buffer),
@@ -76,10 +91,12 @@ void test_format_json_valid_inputs() {
              "  \"id_module\": %d,\n"
              "  \"timestamp\": %u,\n"
              "  \"distance_m\": %.2f,\n"
+             "  \"moving_m\": %.2f,\n"
+             "  \"static_m\": %.2f,\n"
              "  \"posture\": \"%s\",\n"
              "  \"signal\": %d\n"
              "}",
-             module_id, timestamp, distance_m, posture, signal_strength);
+             module_id, 1678886400u, 3.14f, 3.14f, 1.20f, "STANDING", 85);
 
     ESP_LOGI(TAG_TEST_RADAR, "Produced JSON:\n%s", json_buffer);
     ESP_LOGI(TAG_TEST_RADAR, "Expected JSON:\n%s", expected_json_buffer);
@@ -95,20 +112,19 @@ void test_format_json_valid_inputs() {
 void test_radar_read_simulated_data() {
     ESP_LOGI(TAG_TEST_RADAR, "Running test: test_radar_read_simulated_data");
 
-    float distance_m;
-    char posture[16]; // Ensure buffer is large enough
-    int signal_strength;
+    ProcessedRadarData data;
 
     // Call the function (using the re-declared/stubbed version)
-    bool result = radar_read_data(&distance_m, posture, &signal_strength);
+    bool result = radar_read_data(&data);
 
     ESP_LOGI(TAG_TEST_RADAR, "radar_read_data returned: %s", result ? "true" : "false");
-    ESP_LOGI(TAG_TEST_RADAR, "Distance: %.2fm", distance_m);
-    ESP_LOGI(TAG_TEST_RADAR, "Posture: %s", posture);
-    ESP_LOGI(TAG_TEST_RADAR, "Signal Strength: %d", signal_strength);
+    ESP_LOGI(TAG_TEST_RADAR, "Distance: %.2fm (moving %.2fm, static %.2fm)", data.distance_m, data.moving_m, data.static_m);
+    ESP_LOGI(TAG_TEST_RADAR, "Posture: %s", data.posture);
+    ESP_LOGI(TAG_TEST_RADAR, "Signal Strength: %d", data.signal_strength);
 
     // Simulate assertion (based on the known simulated values in the stub)
-    if (result && distance_m == 2.25f && strcmp(posture, "LYING") == 0 && signal_strength == 72) {
+    if (result && data.distance_m == 2.25f && data.static_m == 2.25f && data.moving_m == 0.0f &&
+        strcmp(data.posture, "LYING") == 0 && data.signal_strength == 72) {
         ESP_LOGI(TAG_TEST_RADAR, "Test PASSED: Simulated data read as expected.");
     } else {
         ESP_LOGE(TAG_TEST_RADAR, "Test FAILED: Simulated data does not match expected values.");